@@ -6,9 +6,15 @@ module;
 #include <DxDef.h>
 
 module Brawler.AssetManagement.AssetManager;
+
+#ifdef __linux__
+import Brawler.AssetManagement.IoUringAssetIORequestHandler;
+#else
 import Brawler.AssetManagement.DirectStorageAssetIORequestHandler;
 import Brawler.AssetManagement.Win32AssetIORequestHandler;
 import Util.DirectStorage;
+#endif
+
 import Brawler.JobSystem;
 import Brawler.AssetManagement.EnqueuedAssetDependency;
 
@@ -29,6 +35,11 @@ namespace Brawler
 			mRequestHandlerPtr(nullptr),
 			mCurrLoadingMode(DEFAULT_LOADING_MODE)
 		{
+#ifdef __linux__
+			// Neither DirectStorage nor the Win32 file mapping API exist on Linux. There, we submit
+			// asset reads to an io_uring instead.
+			mRequestHandlerPtr = std::make_unique<IoUringAssetIORequestHandler>();
+#else
 			// Looking at the function signature for DStorageGetFactory(), we find that the function returns
 			// an HRESULT value. This implies that the function can, in fact, fail. However, the documentation
 			// does not state when the function actually fails to create an IDStorageFactory instance.
@@ -48,6 +59,7 @@ namespace Brawler
 			}
 			else
 				mRequestHandlerPtr = std::make_unique<Win32AssetIORequestHandler>();
+#endif
 		}
 
 		AssetManager& AssetManager::GetInstance()
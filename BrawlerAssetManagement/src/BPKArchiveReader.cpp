@@ -1,23 +1,34 @@
 module;
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <array>
-#include <fstream>
+#include <span>
 #include <filesystem>
 #include <stdexcept>
 #include <cassert>
+#include <cstring>
+#include <bit>
+#include <type_traits>
+#include <memory>
 #include <DxDef.h>
 
 module Brawler.AssetManagement.BPKArchiveReader;
 import Brawler.FilePathHash;
 import Brawler.FileAccessMode;
-import Brawler.SerializedStruct;
+import Brawler.MappedFileViewCache;
+import Brawler.MappedFileViewHint;
+import Brawler.CompositeEnum;
+import Brawler.BPKTableOfContentsHash;
+import Brawler.AssetManagement.ZSTDContext;
 
 namespace
 {
-	static constexpr std::wstring_view DATA_SUBDIRECTORY = L"Data\\Data.bpk";
+	// These are joined with std::filesystem::path::operator/(), rather than being written as
+	// a single string with a hard-coded separator, so that the path is also valid on Linux.
+	static constexpr std::string_view DATA_DIRECTORY_NAME = "Data";
+	static constexpr std::string_view BPK_ARCHIVE_FILE_NAME = "Data.bpk";
 	static constexpr std::string_view BPK_MAGIC = "BPK";
-	static constexpr std::uint32_t CURRENT_BPK_VERSION = 1;
+	static constexpr std::uint32_t CURRENT_BPK_VERSION = 3;
 
 	struct CommonBPKFileHeader
 	{
@@ -25,69 +36,75 @@ namespace
 		std::uint32_t Version;
 	};
 
-	std::ifstream& operator>>(std::ifstream& lhs, CommonBPKFileHeader& rhs)
-	{
-		lhs.read(reinterpret_cast<char*>(rhs.Magic.data()), rhs.Magic.size());
-		lhs.read(reinterpret_cast<char*>(&(rhs.Version)), sizeof(rhs.Version));
-
-		return lhs;
-	}
-
 	struct CurrentVersionedBPKFileHeader
 	{
 		/// <summary>
 		/// This is the size, in bytes, of the entire table of contents (ToC) for this
-		/// BPK file.
+		/// BPK file. This includes both the ToC entries and the pilot values which follow
+		/// them, as well as any padding after the pilot values and the compression
+		/// dictionary entries which follow that padding.
 		/// </summary>
-		std::size_t TableOfContentsSizeInBytes;
-	};
+		std::uint64_t TableOfContentsSizeInBytes;
 
-	std::ifstream& operator>>(std::ifstream& lhs, CurrentVersionedBPKFileHeader& rhs)
-	{
-		lhs.read(reinterpret_cast<char*>(&(rhs.TableOfContentsSizeInBytes)), sizeof(rhs.TableOfContentsSizeInBytes));
+		/// <summary>
+		/// This is the seed which was used to hash the FileIdentifierHash of every ToC
+		/// entry. (See Brawler.BPKTableOfContentsHash.)
+		/// </summary>
+		std::uint64_t HashSeed;
 
-		return lhs;
-	}
+		/// <summary>
+		/// This is the number of ToC entries. The ToC entries directly follow this
+		/// header.
+		/// </summary>
+		std::uint32_t TableOfContentsEntryCount;
 
-	struct BPKTableOfContentsEntry
-	{
 		/// <summary>
-		/// This is the hash used to uniquely identify the file.
+		/// This is the number of buckets, and thus of std::uint32_t pilot values, which
+		/// directly follow the ToC entries.
 		/// </summary>
-		std::uint64_t FileIdentifierHash;
+		std::uint32_t BucketCount;
 
 		/// <summary>
-		/// This is the offset, in bytes, from the start of the BPK file to the start
-		/// of the compressed data represented by this ToC entry.
+		/// This is the number of compression dictionary entries, which directly follow the
+		/// padding after the pilot values.
+		/// </summary>
+		std::uint32_t DictionaryCount;
+
+		std::uint32_t Reserved;
+	};
+
+	struct CompressionDictionaryEntry
+	{
+		/// <summary>
+		/// This is the offset, in bytes, from the start of the BPK file to the start of the
+		/// dictionary's data.
 		/// </summary>
 		std::uint64_t FileOffsetInBytes;
 
 		/// <summary>
-		/// This is the size, in bytes, of the compressed data within the BPK file
-		/// archive.
+		/// This is the size, in bytes, of the dictionary's data.
 		/// </summary>
-		std::uint64_t CompressedSizeInBytes;
+		std::uint32_t SizeInBytes;
 
 		/// <summary>
-		/// This is the size, in bytes, of the uncompressed data represented by this
-		/// ToC entry.
+		/// This is the ID which ZSTD writes into the header of every frame compressed with
+		/// this dictionary.
 		/// </summary>
-		std::uint64_t UncompressedSizeInBytes;
+		std::uint32_t DictionaryID;
 	};
 
-	std::ifstream& operator>>(std::ifstream& lhs, BPKTableOfContentsEntry& rhs)
-	{
-		lhs.read(reinterpret_cast<char*>(&(rhs.FileIdentifierHash)), sizeof(rhs.FileIdentifierHash));
-		lhs.read(reinterpret_cast<char*>(&(rhs.FileOffsetInBytes)), sizeof(rhs.FileOffsetInBytes));
-		lhs.read(reinterpret_cast<char*>(&(rhs.CompressedSizeInBytes)), sizeof(rhs.CompressedSizeInBytes));
-		lhs.read(reinterpret_cast<char*>(&(rhs.UncompressedSizeInBytes)), sizeof(rhs.UncompressedSizeInBytes));
-
-		return lhs;
-	}
+	// We read the headers by copying their bytes, and we read the ToC entries in place, so
+	// none of these types may contain any padding. The ToC entries must also be 8-byte
+	// aligned, which they are as long as the headers keep them that way.
+	static_assert(sizeof(CommonBPKFileHeader) == 8 && sizeof(CurrentVersionedBPKFileHeader) == 32 && sizeof(CompressionDictionaryEntry) == 16);
+	static_assert(((sizeof(CommonBPKFileHeader) + sizeof(CurrentVersionedBPKFileHeader)) % alignof(Brawler::AssetManagement::BPKArchiveReader::TOCEntry)) == 0);
+	static_assert(sizeof(Brawler::AssetManagement::BPKArchiveReader::TOCEntry) == (4 * sizeof(std::uint64_t)));
+	static_assert(std::is_trivially_copyable_v<Brawler::AssetManagement::BPKArchiveReader::TOCEntry> && std::is_standard_layout_v<Brawler::AssetManagement::BPKArchiveReader::TOCEntry>);
+	static_assert(std::endian::native == std::endian::little, "ERROR: BPK archives are always written in little-endian byte order!");
 
 	static const std::filesystem::path bpkArchivePath = [] ()
 	{
-		std::filesystem::path bpkPath{ std::filesystem::current_path() / std::filesystem::path{ DATA_SUBDIRECTORY } };
+		std::filesystem::path bpkPath{ std::filesystem::current_path() / DATA_DIRECTORY_NAME / BPK_ARCHIVE_FILE_NAME };
 
 		// Make sure that the data archive exists.
 		if (!std::filesystem::exists(bpkPath))
@@ -95,137 +112,141 @@ namespace
 
 		return bpkPath;
 	}();
+}
 
-	/// <summary>
-	/// Ensures that the application's BPK archive is valid and attempts to the current
-	/// versioned BPK file header.
-	/// </summary>
-	/// <returns>
-	/// If the BPK file is valid, then the std::optional instance returned by this function
-	/// contains its versioned BPK file header. Otherwise, the returned std::optional instance
-	/// is empty.
-	/// </returns>
-	std::optional<CurrentVersionedBPKFileHeader> TryExtractVersionedBPKFileHeader(std::ifstream& bpkFileStream)
+namespace Brawler
+{
+	namespace AssetManagement
 	{
-		// Read the common BPK file header.
+		BPKArchiveReader::BPKArchiveReader() :
+			mBPKViewCachePtr(std::make_unique<MappedFileViewCache>(bpkArchivePath)),
+			mTOCView(),
+			mTOCEntrySpan(),
+			mPilotValueSpan(),
+			mHashSeed(0)
 		{
-			CommonBPKFileHeader commonHeader{};
-			bpkFileStream >> commonHeader;
-
-			for (std::size_t i = 0; i < BPK_MAGIC.size(); ++i)
-			{
-				if (commonHeader.Magic[i] != BPK_MAGIC[i]) [[unlikely]]
-					return std::optional<CurrentVersionedBPKFileHeader>{};
-			}
-
-			if (commonHeader.Version != CURRENT_BPK_VERSION) [[unlikely]]
-				return std::optional<CurrentVersionedBPKFileHeader>{};
+			MapTableOfContents();
 		}
-
-		// Read the current versioned BPK file header.
+		
+		BPKArchiveReader& BPKArchiveReader::GetInstance()
 		{
-			CurrentVersionedBPKFileHeader versionedHeader{};
-			bpkFileStream >> versionedHeader;
-
-			return std::optional<CurrentVersionedBPKFileHeader>{ std::move(versionedHeader) };
+			static BPKArchiveReader instance{};
+			return instance;
 		}
-	}
 
-	std::unordered_map<std::uint64_t, Brawler::AssetManagement::BPKArchiveReader::TOCEntry> CreateTableOfContents()
-	{
-		std::ifstream bpkFileStream{ bpkArchivePath, std::ios_base::in | std::ios_base::binary };
-		std::unordered_map<std::uint64_t, Brawler::AssetManagement::BPKArchiveReader::TOCEntry> tableOfContents{};
-		std::optional<CurrentVersionedBPKFileHeader> versionedHeader{ TryExtractVersionedBPKFileHeader(bpkFileStream) };
+		const BPKArchiveReader::TOCEntry& BPKArchiveReader::GetTableOfContentsEntry(const FilePathHash pathHash) const
+		{
+			// Requesting a file which is not in the archive must be an error in every build
+			// configuration, so these checks must not be asserts. Otherwise, a Release build
+			// would silently hand out the data of whichever file occupies the slot.
+			if (mTOCEntrySpan.empty()) [[unlikely]]
+				throw std::runtime_error{ "ERROR: An attempt was made to get a BPK Table of Contents entry, but the BPK archive does not contain any files!" };
 
-		if (!versionedHeader.has_value()) [[unlikely]]
-			throw std::runtime_error{ "ERROR: The versioned BPK file header could not be extracted from the application's BPK archive!" };
+			// Every FilePathHash maps to exactly one slot of the ToC, so there is no probing
+			// and no comparison loop; we only need to check that the file in that slot is the
+			// one we were looking for.
+			const std::uint64_t keyHash = BPKTableOfContentsHash::GetKeyHash(pathHash.GetHash(), mHashSeed);
+			const std::uint32_t pilotValue = mPilotValueSpan[BPKTableOfContentsHash::GetBucketIndex(keyHash, static_cast<std::uint32_t>(mPilotValueSpan.size()))];
 
-		const std::size_t numTOCEntries = versionedHeader->TableOfContentsSizeInBytes / sizeof(BPKTableOfContentsEntry);
+			const TOCEntry& tocEntry{ mTOCEntrySpan[BPKTableOfContentsHash::GetSlotIndex(keyHash, pilotValue, static_cast<std::uint32_t>(mTOCEntrySpan.size()))] };
 
-		std::vector<BPKTableOfContentsEntry> tocEntryArr{};
+			if (tocEntry.FileIdentifierHash != pathHash.GetHash()) [[unlikely]]
+				throw std::runtime_error{ "ERROR: An attempt was made to get the BPK Table of Contents entry for a file which does not exist within the archive!" };
 
-		if constexpr (Brawler::IsInherentlySerializable<BPKTableOfContentsEntry>)
+			return tocEntry;
+		}
+
+		MappedFileView<FileAccessMode::READ_ONLY> BPKArchiveReader::CreateMappedFileViewForAsset(const FilePathHash pathHash) const
 		{
-			// Rather than sequentially reading each individual ToC entry, we can just read the entire ToC at once.
-			// This can be significantly faster.
+			const TOCEntry& tocEntry{ GetTableOfContentsEntry(pathHash) };
 			
-			tocEntryArr.resize(numTOCEntries);
-			bpkFileStream.read(reinterpret_cast<char*>(tocEntryArr.data()), versionedHeader->TableOfContentsSizeInBytes);
+			MappedFileView<FileAccessMode::READ_ONLY> mappedView{ mBPKViewCachePtr->CreateMappedFileView(MappedFileView<FileAccessMode::READ_ONLY>::ViewParams{
+				.FileOffsetInBytes = tocEntry.FileOffsetInBytes,
+				.ViewSizeInBytes = (tocEntry.IsDataCompressed() ? tocEntry.CompressedSizeInBytes : tocEntry.UncompressedSizeInBytes),
+
+				// The asset is going to be copied or decompressed from front to back as soon as
+				// its request is processed, so we may as well start reading it in now.
+				.Hints{ MappedFileViewHint::SEQUENTIAL_ACCESS | MappedFileViewHint::PREFETCH }
+			}) };
+			assert(mappedView.IsValidView() && "ERROR: Something went wrong when creating a MappedFileView for an asset in a BPK file!");
+
+			return mappedView;
 		}
-		else
+
+		void BPKArchiveReader::MapTableOfContents()
 		{
-			// To ensure correct deserialization, we need to first copy the data into serializable versions of
-			// BPKTableOfContentsEntry.
-			std::vector<Brawler::SerializedStruct<BPKTableOfContentsEntry>> serializedTOCEntryArr{};
-			serializedTOCEntryArr.resize(numTOCEntries);
+			static constexpr std::size_t TOTAL_HEADER_SIZE = (sizeof(CommonBPKFileHeader) + sizeof(CurrentVersionedBPKFileHeader));
 
-			bpkFileStream.read(reinterpret_cast<char*>(serializedTOCEntryArr.data()), versionedHeader->TableOfContentsSizeInBytes);
+			CommonBPKFileHeader commonHeader{};
+			CurrentVersionedBPKFileHeader versionedHeader{};
 
-			// Now, we need to individually de-serialize each entry.
-			tocEntryArr.reserve(numTOCEntries);
+			// The headers and the ToC are at the start of the BPK archive, so unless the ToC
+			// is very large, both of these views share the mapping which is later used for the
+			// first few assets, too.
+			{
+				const MappedFileView<FileAccessMode::READ_ONLY> headerView{ mBPKViewCachePtr->CreateMappedFileView(MappedFileView<FileAccessMode::READ_ONLY>::ViewParams{
+					.FileOffsetInBytes = 0,
+					.ViewSizeInBytes = TOTAL_HEADER_SIZE,
+					.Hints{}
+				}) };
 
-			for (const auto& serializedTOCEntry : serializedTOCEntryArr)
-				tocEntryArr.push_back(Brawler::DeserializeData(serializedTOCEntry));
-		}
+				const std::span<const std::byte> headerDataSpan{ headerView.GetMappedData() };
 
-		for (const auto& tocEntry : tocEntryArr)
-			tableOfContents.try_emplace(
-				tocEntry.FileIdentifierHash,
-				tocEntry.FileOffsetInBytes,
-				tocEntry.CompressedSizeInBytes,
-				tocEntry.UncompressedSizeInBytes
-			);
+				std::memcpy(&commonHeader, headerDataSpan.data(), sizeof(commonHeader));
+				std::memcpy(&versionedHeader, (headerDataSpan.data() + sizeof(commonHeader)), sizeof(versionedHeader));
+			}
 
-		/*
-		for (std::size_t i = 0; i < numTOCEntries; ++i)
-		{
-			BPKTableOfContentsEntry rawTOCEntry{};
-			bpkFileStream >> rawTOCEntry;
-
-			tableOfContents.try_emplace(
-				rawTOCEntry.FileIdentifierHash,
-				rawTOCEntry.FileOffsetInBytes,
-				rawTOCEntry.CompressedSizeInBytes,
-				rawTOCEntry.UncompressedSizeInBytes
-			);
-		}
-		*/
+			if (std::string_view{ commonHeader.Magic.data(), BPK_MAGIC.size() } != BPK_MAGIC || commonHeader.Version != CURRENT_BPK_VERSION) [[unlikely]]
+				throw std::runtime_error{ "ERROR: The versioned BPK file header could not be extracted from the application's BPK archive!" };
 
-		return tableOfContents;
-	}
-}
+			const std::size_t tocEntriesSize = (sizeof(TOCEntry) * versionedHeader.TableOfContentsEntryCount);
+			const std::size_t pilotValuesSize = (sizeof(std::uint32_t) * versionedHeader.BucketCount);
 
-namespace Brawler
-{
-	namespace AssetManagement
-	{
-		BPKArchiveReader::BPKArchiveReader() :
-			mTableOfContents(CreateTableOfContents())
-		{}
-		
-		BPKArchiveReader& BPKArchiveReader::GetInstance()
-		{
-			static BPKArchiveReader instance{};
-			return instance;
-		}
+			// The compression dictionary entries begin at the next 8-byte boundary after the
+			// pilot values.
+			const std::size_t dictionaryEntriesOffset = (((tocEntriesSize + pilotValuesSize) + (alignof(std::uint64_t) - 1)) & ~(alignof(std::uint64_t) - 1));
+			const std::size_t dictionaryEntriesSize = (sizeof(CompressionDictionaryEntry) * versionedHeader.DictionaryCount);
 
-		const BPKArchiveReader::TOCEntry& BPKArchiveReader::GetTableOfContentsEntry(const FilePathHash pathHash) const
-		{
-			assert(mTableOfContents.contains(pathHash.GetHash()) && "ERROR: An attempt was made to get the BPK Table of Contents entry for a file which does not exist within the archive! (Did you remember to call BPKArchiveReader::Initialize()? This isn't done in the constructor because it can/should be done in parallel with other initialization operations.)");
-			return mTableOfContents.at(pathHash.GetHash());
+			if (versionedHeader.BucketCount == 0 || versionedHeader.TableOfContentsSizeInBytes < (dictionaryEntriesOffset + dictionaryEntriesSize)) [[unlikely]]
+				throw std::runtime_error{ "ERROR: The Table of Contents of the application's BPK archive is corrupt!" };
+
+			mTOCView = mBPKViewCachePtr->CreateMappedFileView(MappedFileView<FileAccessMode::READ_ONLY>::ViewParams{
+				.FileOffsetInBytes = TOTAL_HEADER_SIZE,
+				.ViewSizeInBytes = versionedHeader.TableOfContentsSizeInBytes,
+
+				// Lookups into the ToC are essentially random, so neither reading ahead nor
+				// reading the entire ToC right away would help.
+				.Hints{}
+			});
+
+			const std::span<const std::byte> tocDataSpan{ mTOCView.GetMappedData() };
+
+			mTOCEntrySpan = std::span<const TOCEntry>{ reinterpret_cast<const TOCEntry*>(tocDataSpan.data()), versionedHeader.TableOfContentsEntryCount };
+			mPilotValueSpan = std::span<const std::uint32_t>{ reinterpret_cast<const std::uint32_t*>(tocDataSpan.data() + tocEntriesSize), versionedHeader.BucketCount };
+			mHashSeed = versionedHeader.HashSeed;
+
+			LoadCompressionDictionaries(tocDataSpan.subspan(dictionaryEntriesOffset, dictionaryEntriesSize));
 		}
 
-		MappedFileView<FileAccessMode::READ_ONLY> BPKArchiveReader::CreateMappedFileViewForAsset(const FilePathHash pathHash) const
+		void BPKArchiveReader::LoadCompressionDictionaries(const std::span<const std::byte> dictionaryEntryDataSpan)
 		{
-			const TOCEntry& tocEntry{ GetTableOfContentsEntry(pathHash) };
-			
-			MappedFileView<FileAccessMode::READ_ONLY>  mappedView{ bpkArchivePath, MappedFileView<FileAccessMode::READ_ONLY>::ViewParams{
-				.FileOffsetInBytes = tocEntry.FileOffsetInBytes,
-				.ViewSizeInBytes = (tocEntry.IsDataCompressed() ? tocEntry.CompressedSizeInBytes : tocEntry.UncompressedSizeInBytes)
-			} };
-			assert(mappedView.IsViewValid() && "ERROR: Something went wrong when creating a MappedFileView for an asset in a BPK file!");
+			const std::span<const CompressionDictionaryEntry> dictionaryEntrySpan{ reinterpret_cast<const CompressionDictionaryEntry*>(dictionaryEntryDataSpan.data()), (dictionaryEntryDataSpan.size_bytes() / sizeof(CompressionDictionaryEntry)) };
 
-			return mappedView;
+			for (const auto& dictionaryEntry : dictionaryEntrySpan)
+			{
+				// The ZSTDContextQueue creates its own copy of the dictionary, so we only need
+				// this view for as long as it takes to register it.
+				const MappedFileView<FileAccessMode::READ_ONLY> dictionaryView{ mBPKViewCachePtr->CreateMappedFileView(MappedFileView<FileAccessMode::READ_ONLY>::ViewParams{
+					.FileOffsetInBytes = dictionaryEntry.FileOffsetInBytes,
+					.ViewSizeInBytes = dictionaryEntry.SizeInBytes,
+					.Hints{ MappedFileViewHint::SEQUENTIAL_ACCESS | MappedFileViewHint::PREFETCH }
+				}) };
+
+				if (!dictionaryView.IsValidView()) [[unlikely]]
+					throw std::runtime_error{ "ERROR: A compression dictionary could not be read from the application's BPK archive!" };
+
+				ZSTDContextQueue::GetInstance().AddDecompressionDictionary(dictionaryEntry.DictionaryID, dictionaryView.GetMappedData());
+			}
 		}
 
 		const std::filesystem::path& BPKArchiveReader::GetBPKArchiveFilePath()
@@ -1,10 +1,12 @@
 module;
-#include <unordered_map>
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <DxDef.h>
 
 export module Brawler.AssetManagement.BPKArchiveReader;
 import Brawler.MappedFileView;
+import Brawler.MappedFileViewCache;
 import Brawler.FileAccessMode;
 import Brawler.FilePathHash;
 
@@ -15,8 +17,17 @@ export namespace Brawler
 		class BPKArchiveReader final
 		{
 		public:
+			// TOCEntry instances are read directly from a memory-mapped view of the BPK
+			// archive, so the layout of this struct *MUST* match that of the ToC entries
+			// written by the FilePacker.
 			struct TOCEntry
 			{
+				/// <summary>
+				/// This is the hash used to uniquely identify the file. It is the value of
+				/// the FilePathHash which refers to it.
+				/// </summary>
+				std::uint64_t FileIdentifierHash;
+
 				/// <summary>
 				/// This is the offset, in bytes, from the start of the BPK file to the start
 				/// of the compressed data represented by this ToC entry.
@@ -71,12 +82,46 @@ export namespace Brawler
 
 			static const std::filesystem::path& GetBPKArchiveFilePath();
 
+		private:
+			void MapTableOfContents();
+
+			/// <summary>
+			/// Registers every ZSTD dictionary stored within the BPK archive with the
+			/// ZSTDContextQueue, so that the assets which were compressed with them can be
+			/// decompressed. The dictionaries are small and there are only a few of them, so
+			/// this is done once when the BPK archive is opened.
+			/// </summary>
+			void LoadCompressionDictionaries(const std::span<const std::byte> dictionaryEntryDataSpan);
+
 		private:
 			/// <summary>
-			/// This is a map between a file path hash and the remainder of its respective
-			/// Table of Contents (ToC) entry in a BPK file.
+			/// Every asset in the BPK archive is read through a MappedFileView created by this
+			/// MappedFileViewCache. That way, requests for assets which lie close to each other
+			/// in the archive share a single mapping, rather than each of them opening and
+			/// mapping the BPK archive again.
+			/// 
+			/// The MappedFileViewCache is neither copyable nor movable, so we store it in a
+			/// std::unique_ptr.
 			/// </summary>
-			std::unordered_map<std::uint64_t, TOCEntry> mTableOfContents;
+			std::unique_ptr<MappedFileViewCache> mBPKViewCachePtr;
+
+			/// <summary>
+			/// This is a view of the Table of Contents (ToC) of the BPK archive. The ToC
+			/// is never parsed or copied; both mTOCEntrySpan and mPilotValueSpan point
+			/// directly into this view. That way, the cost of creating the BPKArchiveReader
+			/// does not depend on the number of files in the BPK archive, and the pages of
+			/// the ToC are only read once they are actually needed.
+			/// </summary>
+			MappedFileView<FileAccessMode::READ_ONLY> mTOCView;
+
+			/// <summary>
+			/// These are the ToC entries, in the order of their slot indices. (See
+			/// Brawler.BPKTableOfContentsHash.)
+			/// </summary>
+			std::span<const TOCEntry> mTOCEntrySpan;
+
+			std::span<const std::uint32_t> mPilotValueSpan;
+			std::uint64_t mHashSeed;
 		};
 	}
 }
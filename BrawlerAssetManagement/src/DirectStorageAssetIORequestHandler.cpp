@@ -30,42 +30,35 @@ namespace
 		
 		const std::span<std::byte> destDataSpan{ reinterpret_cast<std::byte*>(decompressionRequest.DstBuffer), decompressionRequest.DstSize };
 		const std::span<const std::byte> srcDataSpan{ reinterpret_cast<const std::byte*>(decompressionRequest.SrcBuffer), decompressionRequest.SrcSize };
-		Brawler::AssetManagement::ZSTDDecompressionOperation decompressOperation{};
-
-		HRESULT hr = decompressOperation.BeginDecompressionOperation(srcDataSpan);
 
 		// Pro Tip: Resources created in UPLOAD heaps are located in write-combined memory, which is incredibly
 		// slow to read from. To avoid ZStandard reading from this memory, when the destination buffer is located
 		// within an UPLOAD heap, we will instead decompress the data intoto a temporary array of bytes and
 		// copy that into the UPLOAD heap.
+		//
+		// Either way, ZSTDDecompressionOperation::DecompressData() spreads the chunks of the asset across
+		// CPU jobs, so that a single large asset is not stuck on one decompression thread.
 
 		if ((decompressionRequest.Flags & DSTORAGE_CUSTOM_DECOMPRESSION_FLAGS::DSTORAGE_CUSTOM_DECOMPRESSION_FLAG_DEST_IN_UPLOAD_HEAP) != 0)
 		{
-			// Calling ZSTDDecompressionOperation::FinishDecompressionOperation() without specifying a destination
-			// std::span copies the remaining data into a temporary std::vector of bytes for us. This works great
-			// for when the destination resource is in an UPLOAD heap.
-			Brawler::AssetManagement::ZSTDDecompressionOperation::DecompressionResults zstdDecompressResults{ decompressOperation.FinishDecompressionOperation() };
+			const std::unique_ptr<std::byte[]> decompressedDataPtr{ std::make_unique_for_overwrite<std::byte[]>(destDataSpan.size_bytes()) };
+			const std::span<std::byte> decompressedDataSpan{ decompressedDataPtr.get(), destDataSpan.size_bytes() };
 
-			if (FAILED(zstdDecompressResults.HResult)) [[unlikely]]
-				return DSTORAGE_CUSTOM_DECOMPRESSION_RESULT{
-					.Id = decompressionRequest.Id,
-					.Result = zstdDecompressResults.HResult
-				};
+			const HRESULT hr = Brawler::AssetManagement::ZSTDDecompressionOperation::DecompressData(srcDataSpan, decompressedDataSpan);
 
-			if (decompressionRequest.DstSize < zstdDecompressResults.DecompressedByteArr.size()) [[unlikely]]
+			if (FAILED(hr)) [[unlikely]]
 				return DSTORAGE_CUSTOM_DECOMPRESSION_RESULT{
 					.Id = decompressionRequest.Id,
-					.Result = E_NOT_SUFFICIENT_BUFFER
+					.Result = hr
 				};
 
-			std::ranges::copy(zstdDecompressResults.DecompressedByteArr, destDataSpan.data());
+			std::ranges::copy(decompressedDataSpan, destDataSpan.data());
 		}
 		else
 		{
-			// Calling ZSTDDecompressionOperation::FinishDecompressionOperation() with a destination std::span
-			// attempts to decompress the remaining data into the specified memory location. When not writing
-			// into write-combined memory, this is likely to be the best choice.
-			const HRESULT hr = decompressOperation.FinishDecompressionOperation(destDataSpan);
+			// When not writing into write-combined memory, decompressing directly into the destination is
+			// likely to be the best choice.
+			const HRESULT hr = Brawler::AssetManagement::ZSTDDecompressionOperation::DecompressData(srcDataSpan, destDataSpan);
 
 			if (FAILED(hr)) [[unlikely]]
 				return DSTORAGE_CUSTOM_DECOMPRESSION_RESULT{
@@ -0,0 +1,218 @@
+module;
+#include <cstdint>
+#include <span>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <filesystem>
+#include <format>
+#include <new>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <cassert>
+
+#ifdef __linux__
+#include <cerrno>
+#include <liburing.h>
+#endif
+
+module Brawler.AssetManagement.IoUringAssetIORequest;
+import Brawler.AssetManagement.BPKArchiveReader;
+
+#ifdef __linux__
+
+namespace
+{
+	constexpr std::uint64_t AlignDown(const std::uint64_t value)
+	{
+		return (value & ~(Brawler::AssetManagement::DIRECT_IO_ALIGNMENT - 1));
+	}
+
+	constexpr std::uint64_t AlignUp(const std::uint64_t value)
+	{
+		return AlignDown(value + (Brawler::AssetManagement::DIRECT_IO_ALIGNMENT - 1));
+	}
+}
+
+namespace Brawler
+{
+	namespace AssetManagement
+	{
+		void DirectIOBufferDeleter::operator()(std::byte* bufferPtr) const
+		{
+			::operator delete[](bufferPtr, std::align_val_t{ DIRECT_IO_ALIGNMENT });
+		}
+
+		DirectIOBuffer AllocateDirectIOBuffer(const std::uint64_t sizeInBytes)
+		{
+			return DirectIOBuffer{ static_cast<std::byte*>(::operator new[](sizeInBytes, std::align_val_t{ DIRECT_IO_ALIGNMENT })) };
+		}
+
+		IoUringAssetIORequest::IoUringAssetIORequest(Brawler::FilePathHash pathHash, Win32AssetIORequestTracker& requestTracker) :
+			mWriteDataCallback(),
+			mCustomFilePath(),
+			mFileOffsetInBytes(0),
+			mDataSizeInBytes(0),
+			mFixedFileIndex(BPK_ARCHIVE_FIXED_FILE_INDEX),
+			mRegisteredBufferIndex(),
+			mHeapReadBuffer(),
+			mReadBufferSpan(),
+			mNumBytesRead(0),
+			mPriority(Brawler::JobPriority::NORMAL),
+			mRequestTrackerPtr(&requestTracker)
+		{
+			const BPKArchiveReader::TOCEntry& tocEntry{ BPKArchiveReader::GetInstance().GetTableOfContentsEntry(pathHash) };
+
+			mFileOffsetInBytes = tocEntry.FileOffsetInBytes;
+			mDataSizeInBytes = (tocEntry.IsDataCompressed() ? tocEntry.CompressedSizeInBytes : tocEntry.UncompressedSizeInBytes);
+		}
+
+		IoUringAssetIORequest::IoUringAssetIORequest(const CustomFileAssetIORequest& customFileRequest, Win32AssetIORequestTracker& requestTracker) :
+			mWriteDataCallback(),
+			mCustomFilePath(customFileRequest.FilePath),
+			mFileOffsetInBytes(customFileRequest.FileOffset),
+			mDataSizeInBytes(customFileRequest.DestDataSpan.size_bytes()),
+			mFixedFileIndex(),
+			mRegisteredBufferIndex(),
+			mHeapReadBuffer(),
+			mReadBufferSpan(),
+			mNumBytesRead(0),
+			mPriority(Brawler::JobPriority::NORMAL),
+			mRequestTrackerPtr(&requestTracker)
+		{}
+
+		void IoUringAssetIORequest::SetWriteDataCallback(WriteDataCallback_T&& callback)
+		{
+			mWriteDataCallback = std::move(callback);
+		}
+
+		void IoUringAssetIORequest::SetPriority(const Brawler::JobPriority priority)
+		{
+			mPriority = priority;
+		}
+
+		Brawler::JobPriority IoUringAssetIORequest::GetPriority() const
+		{
+			return mPriority;
+		}
+
+		bool IoUringAssetIORequest::IsCustomFileRequest() const
+		{
+			return !mCustomFilePath.empty();
+		}
+
+		const std::filesystem::path& IoUringAssetIORequest::GetCustomFilePath() const
+		{
+			return mCustomFilePath;
+		}
+
+		void IoUringAssetIORequest::SetFixedFileIndex(const std::uint32_t fixedFileIndex)
+		{
+			mFixedFileIndex = fixedFileIndex;
+		}
+
+		std::optional<std::uint32_t> IoUringAssetIORequest::GetFixedFileIndex() const
+		{
+			return mFixedFileIndex;
+		}
+
+		std::uint64_t IoUringAssetIORequest::GetAlignedReadSizeInBytes() const
+		{
+			return (AlignUp(mFileOffsetInBytes + mDataSizeInBytes) - GetAlignedFileOffset());
+		}
+
+		void IoUringAssetIORequest::SetRegisteredReadBuffer(const std::span<std::byte> registeredBufferSpan, const std::uint32_t registeredBufferIndex)
+		{
+			assert(!HasReadBuffer() && "ERROR: An IoUringAssetIORequest was given a read buffer twice!");
+			assert(registeredBufferSpan.size_bytes() >= GetAlignedReadSizeInBytes() && "ERROR: A registered buffer which was too small was given to an IoUringAssetIORequest!");
+			assert((reinterpret_cast<std::uintptr_t>(registeredBufferSpan.data()) % DIRECT_IO_ALIGNMENT) == 0 && "ERROR: A registered buffer which was not suitably aligned for O_DIRECT was given to an IoUringAssetIORequest!");
+
+			mReadBufferSpan = registeredBufferSpan.subspan(0, GetAlignedReadSizeInBytes());
+			mRegisteredBufferIndex = registeredBufferIndex;
+		}
+
+		void IoUringAssetIORequest::AllocateReadBuffer()
+		{
+			assert(!HasReadBuffer() && "ERROR: An IoUringAssetIORequest was given a read buffer twice!");
+
+			const std::uint64_t bufferSize = GetAlignedReadSizeInBytes();
+
+			mHeapReadBuffer = AllocateDirectIOBuffer(bufferSize);
+			mReadBufferSpan = std::span<std::byte>{ mHeapReadBuffer.get(), bufferSize };
+		}
+
+		bool IoUringAssetIORequest::HasReadBuffer() const
+		{
+			return (mReadBufferSpan.data() != nullptr);
+		}
+
+		std::optional<std::uint32_t> IoUringAssetIORequest::GetRegisteredBufferIndex() const
+		{
+			return mRegisteredBufferIndex;
+		}
+
+		void IoUringAssetIORequest::PrepareReadOperation(io_uring_sqe& submissionQueueEntry)
+		{
+			assert(mFixedFileIndex.has_value() && "ERROR: An IoUringAssetIORequest was submitted before its file was registered with the io_uring!");
+			assert(HasReadBuffer() && "ERROR: An IoUringAssetIORequest was submitted before it was given a read buffer!");
+
+			// If a previous read came up short, then we continue where it left off. With O_DIRECT, the
+			// file offset of the read still has to be aligned, so we might read a few bytes a second
+			// time.
+			mNumBytesRead = AlignDown(mNumBytesRead);
+
+			const std::span<std::byte> remainingReadSpan{ mReadBufferSpan.subspan(mNumBytesRead) };
+			assert(remainingReadSpan.size_bytes() <= std::numeric_limits<std::uint32_t>::max() && "ERROR: io_uring reads cannot be larger than 4 GB!");
+
+			const std::uint64_t readFileOffset = (GetAlignedFileOffset() + mNumBytesRead);
+
+			if (mRegisteredBufferIndex.has_value())
+				io_uring_prep_read_fixed(&submissionQueueEntry, static_cast<int>(*mFixedFileIndex), remainingReadSpan.data(), static_cast<std::uint32_t>(remainingReadSpan.size_bytes()), readFileOffset, static_cast<int>(*mRegisteredBufferIndex));
+			else
+				io_uring_prep_read(&submissionQueueEntry, static_cast<int>(*mFixedFileIndex), remainingReadSpan.data(), static_cast<std::uint32_t>(remainingReadSpan.size_bytes()), readFileOffset);
+
+			io_uring_sqe_set_flags(&submissionQueueEntry, IOSQE_FIXED_FILE);
+			io_uring_sqe_set_data(&submissionQueueEntry, this);
+		}
+
+		bool IoUringAssetIORequest::OnReadCompleted(const std::int32_t readResult)
+		{
+			// The kernel may ask us to try again. This is rare for regular files, but it is
+			// allowed to happen.
+			if (readResult == -EAGAIN || readResult == -EINTR) [[unlikely]]
+				return false;
+
+			if (readResult < 0) [[unlikely]]
+				throw std::runtime_error{ std::format("ERROR: An io_uring read of asset data failed with the following error: {}", std::system_category().message(-readResult)) };
+
+			// The aligned read can run past the end of the file, in which case the kernel just gives
+			// us whatever is left. That is fine, so long as all of the data which we actually asked
+			// for is there.
+			const std::uint64_t requiredReadSize = ((mFileOffsetInBytes - GetAlignedFileOffset()) + mDataSizeInBytes);
+
+			if (readResult == 0 && mNumBytesRead < requiredReadSize) [[unlikely]]
+				throw std::runtime_error{ "ERROR: The end of a file was reached before all of the requested asset data could be read!" };
+
+			mNumBytesRead += static_cast<std::uint64_t>(readResult);
+			return (mNumBytesRead >= requiredReadSize);
+		}
+
+		void IoUringAssetIORequest::WriteAssetData()
+		{
+			const std::span<const std::byte> srcDataSpan{ mReadBufferSpan.subspan((mFileOffsetInBytes - GetAlignedFileOffset()), mDataSizeInBytes) };
+
+			mWriteDataCallback(srcDataSpan);
+
+			assert(mRequestTrackerPtr != nullptr && "ERROR: An IoUringAssetIORequest instance was never given an associated Win32AssetIORequestTracker& before IoUringAssetIORequest::WriteAssetData() was called!");
+			mRequestTrackerPtr->NotifyForAssetIORequestCompletion();
+		}
+
+		std::uint64_t IoUringAssetIORequest::GetAlignedFileOffset() const
+		{
+			return AlignDown(mFileOffsetInBytes);
+		}
+	}
+}
+
+#endif
\ No newline at end of file
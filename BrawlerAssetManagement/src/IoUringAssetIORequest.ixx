@@ -0,0 +1,152 @@
+module;
+#include <cstdint>
+#include <span>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <filesystem>
+
+#ifdef __linux__
+#include <liburing.h>
+#endif
+
+export module Brawler.AssetManagement.IoUringAssetIORequest;
+import Brawler.FilePathHash;
+import Brawler.JobPriority;
+import Brawler.AssetManagement.Win32AssetIORequestTracker;
+import Brawler.AssetManagement.I_AssetIORequestBuilder;
+
+#ifdef __linux__
+
+export namespace Brawler
+{
+	namespace AssetManagement
+	{
+		/// <summary>
+		/// This is the alignment, in bytes, which the file offset, size, and destination address
+		/// of every O_DIRECT read must have. The actual requirement depends on the file system and
+		/// the underlying block device, but no device which we care about needs more than the
+		/// size of a page.
+		/// </summary>
+		constexpr std::uint64_t DIRECT_IO_ALIGNMENT = 4096;
+
+		/// <summary>
+		/// The index within the io_uring's registered file table at which the BPK archive
+		/// is registered.
+		/// </summary>
+		constexpr std::uint32_t BPK_ARCHIVE_FIXED_FILE_INDEX = 0;
+
+		struct DirectIOBufferDeleter
+		{
+			void operator()(std::byte* bufferPtr) const;
+		};
+
+		using DirectIOBuffer = std::unique_ptr<std::byte, DirectIOBufferDeleter>;
+
+		/// <summary>
+		/// Allocates a buffer which is aligned to DIRECT_IO_ALIGNMENT, so that it can be used as
+		/// the destination of an O_DIRECT read.
+		/// </summary>
+		DirectIOBuffer AllocateDirectIOBuffer(const std::uint64_t sizeInBytes);
+
+		class IoUringAssetIORequest
+		{
+		private:
+			using WriteDataCallback_T = std::move_only_function<void(const std::span<const std::byte>)>;
+
+		public:
+			IoUringAssetIORequest() = default;
+			IoUringAssetIORequest(Brawler::FilePathHash pathHash, Win32AssetIORequestTracker& requestTracker);
+			IoUringAssetIORequest(const CustomFileAssetIORequest& customFileRequest, Win32AssetIORequestTracker& requestTracker);
+
+			IoUringAssetIORequest(const IoUringAssetIORequest& rhs) = delete;
+			IoUringAssetIORequest& operator=(const IoUringAssetIORequest& rhs) = delete;
+
+			IoUringAssetIORequest(IoUringAssetIORequest&& rhs) noexcept = default;
+			IoUringAssetIORequest& operator=(IoUringAssetIORequest&& rhs) noexcept = default;
+
+			void SetWriteDataCallback(WriteDataCallback_T&& callback);
+
+			void SetPriority(const Brawler::JobPriority priority);
+			Brawler::JobPriority GetPriority() const;
+
+			/// <summary>
+			/// Requests for the BPK archive read from the file registered at
+			/// BPK_ARCHIVE_FIXED_FILE_INDEX. Requests for custom files need to have their file
+			/// registered by the IoUringAssetIORequestHandler before they can be submitted.
+			/// </summary>
+			bool IsCustomFileRequest() const;
+			const std::filesystem::path& GetCustomFilePath() const;
+
+			void SetFixedFileIndex(const std::uint32_t fixedFileIndex);
+			std::optional<std::uint32_t> GetFixedFileIndex() const;
+
+			/// <summary>
+			/// Gets the size, in bytes, of the read which is needed to get all of the requested data
+			/// with O_DIRECT. This is the requested extent of the file expanded to a multiple of
+			/// DIRECT_IO_ALIGNMENT on both ends, so it can be up to (2 * DIRECT_IO_ALIGNMENT - 2)
+			/// bytes larger than the requested data.
+			/// </summary>
+			std::uint64_t GetAlignedReadSizeInBytes() const;
+
+			/// <summary>
+			/// Tells the IoUringAssetIORequest to read into one of the buffers which were registered
+			/// with the io_uring. The span must be at least IoUringAssetIORequest::GetAlignedReadSizeInBytes()
+			/// bytes large, and it must be aligned to DIRECT_IO_ALIGNMENT.
+			/// </summary>
+			void SetRegisteredReadBuffer(const std::span<std::byte> registeredBufferSpan, const std::uint32_t registeredBufferIndex);
+
+			/// <summary>
+			/// Allocates a buffer for the read from the heap. This is used whenever the data does
+			/// not fit into a registered buffer, or when all of them are in use.
+			/// </summary>
+			void AllocateReadBuffer();
+
+			bool HasReadBuffer() const;
+			std::optional<std::uint32_t> GetRegisteredBufferIndex() const;
+
+			/// <summary>
+			/// Prepares the io_uring_sqe for reading whatever data has not yet been read. If a previous
+			/// read came up short, then this continues where it left off.
+			/// </summary>
+			void PrepareReadOperation(io_uring_sqe& submissionQueueEntry);
+
+			/// <summary>
+			/// Records the result of a completed read.
+			/// </summary>
+			/// <param name="readResult">
+			/// - The res field of the io_uring_cqe which completed the read.
+			/// </param>
+			/// <returns>
+			/// The function returns true if all of the requested data has been read and false if
+			/// the remainder must be submitted again. If the read failed, then an exception is thrown.
+			/// </returns>
+			bool OnReadCompleted(const std::int32_t readResult);
+
+			/// <summary>
+			/// Passes the requested data to the write data callback and notifies the
+			/// Win32AssetIORequestTracker. This is where ZStandard decompression happens, so it
+			/// should be called from a CPU job.
+			/// </summary>
+			void WriteAssetData();
+
+		private:
+			std::uint64_t GetAlignedFileOffset() const;
+
+		private:
+			WriteDataCallback_T mWriteDataCallback;
+			std::filesystem::path mCustomFilePath;
+			std::uint64_t mFileOffsetInBytes;
+			std::uint64_t mDataSizeInBytes;
+			std::optional<std::uint32_t> mFixedFileIndex;
+			std::optional<std::uint32_t> mRegisteredBufferIndex;
+			DirectIOBuffer mHeapReadBuffer;
+			std::span<std::byte> mReadBufferSpan;
+			std::uint64_t mNumBytesRead;
+			Brawler::JobPriority mPriority;
+			Win32AssetIORequestTracker* mRequestTrackerPtr;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
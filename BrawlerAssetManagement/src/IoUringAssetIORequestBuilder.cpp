@@ -0,0 +1,130 @@
+module;
+#include <array>
+#include <vector>
+#include <span>
+#include <memory>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+
+#ifdef __linux__
+// DxDef.h includes <Windows.h>, which does not exist on Linux. The DirectX-Headers package
+// ships a Linux version of the D3D12 headers (the one used by WSL), which only needs
+// <wsl/winadapter.h> to define the Win32 types which it refers to, such as HRESULT. This
+// file only needs D3D12_HEAP_TYPE and HRESULT.
+#include <wsl/winadapter.h>
+#include <directx/d3d12.h>
+#endif
+
+module Brawler.AssetManagement.IoUringAssetIORequestBuilder;
+import Brawler.D3D12.BufferResource;
+import Brawler.AssetManagement.BPKArchiveReader;
+import Brawler.AssetManagement.ZSTDDecompressionOperation;
+import Util.General;
+
+#ifdef __linux__
+
+namespace Brawler
+{
+	namespace AssetManagement
+	{
+		IoUringAssetIORequestBuilder::IoUringAssetIORequestBuilder(AssetRequestEventHandle&& hAssetRequestEvent) :
+			mRequestContainerArr(),
+			mRequestTracker(std::move(hAssetRequestEvent))
+		{}
+
+		void IoUringAssetIORequestBuilder::AddAssetIORequest(const Brawler::FilePathHash pathHash, Brawler::D3D12::I_BufferSubAllocation& bufferSubAllocation)
+		{
+			assert(bufferSubAllocation.GetBufferResource().GetHeapType() == D3D12_HEAP_TYPE::D3D12_HEAP_TYPE_UPLOAD && "ERROR: An attempt was made to write asset data into an I_BufferSubAllocation whose associated BufferResource was not located in an UPLOAD heap!");
+
+			IoUringAssetIORequest assetIORequest{ pathHash, mRequestTracker };
+			assetIORequest.SetWriteDataCallback([pathHash, &bufferSubAllocation] (const std::span<const std::byte> srcDataSpan)
+			{
+				// This is called from the CPU job which the IoUringAssetIORequestHandler creates once the
+				// read has completed, so the decompression happens on the WorkerThreadPool. Just like with
+				// the Win32AssetIORequestBuilder, compressed data is first decompressed into a temporary
+				// byte array, since UPLOAD heaps are located in write-combined memory.
+
+				const BPKArchiveReader::TOCEntry& tocEntry{ BPKArchiveReader::GetInstance().GetTableOfContentsEntry(pathHash) };
+
+				if (tocEntry.IsDataCompressed())
+				{
+					// The ToC tells us exactly how large the decompressed data is, so we can decompress
+					// straight into a single allocation. We don't need it to be zero-initialized, since
+					// every byte of it will be overwritten.
+					const std::size_t uncompressedSize = static_cast<std::size_t>(tocEntry.UncompressedSizeInBytes);
+					const std::unique_ptr<std::byte[]> decompressedDataPtr{ std::make_unique_for_overwrite<std::byte[]>(uncompressedSize) };
+					const std::span<std::byte> decompressedDataSpan{ decompressedDataPtr.get(), uncompressedSize };
+
+					Util::General::CheckHRESULT(ZSTDDecompressionOperation::DecompressData(srcDataSpan, decompressedDataSpan));
+
+					bufferSubAllocation.WriteToBuffer(std::span<const std::byte>{ decompressedDataSpan }, 0);
+				}
+				else
+					bufferSubAllocation.WriteToBuffer(srcDataSpan, 0);
+			});
+
+			EnqueueAssetIORequest(std::move(assetIORequest));
+		}
+
+		void IoUringAssetIORequestBuilder::AddAssetIORequest(const CustomFileAssetIORequest& customFileRequest)
+		{
+			if constexpr (Util::General::IsDebugModeEnabled())
+			{
+				std::error_code errorCode{};
+
+				const auto fileSize = std::filesystem::file_size(customFileRequest.FilePath, errorCode);
+				Util::General::CheckErrorCode(errorCode);
+
+				assert((customFileRequest.FileOffset + customFileRequest.DestDataSpan.size_bytes()) <= fileSize && "ERROR: The size of the provided std::span for an asset I/O request from a custom file was too large compared to the size of the file minus the specified offset from the start of the file!");
+			}
+
+			IoUringAssetIORequest assetIORequest{ customFileRequest, mRequestTracker };
+			assetIORequest.SetWriteDataCallback([destSpan = customFileRequest.DestDataSpan] (const std::span<const std::byte> srcDataSpan)
+			{
+				assert(destSpan.size_bytes() == srcDataSpan.size_bytes());
+				std::memcpy(destSpan.data(), srcDataSpan.data(), srcDataSpan.size_bytes());
+			});
+
+			EnqueueAssetIORequest(std::move(assetIORequest));
+		}
+
+		std::span<IoUringAssetIORequest> IoUringAssetIORequestBuilder::GetAssetIORequestSpan(const Brawler::JobPriority priority)
+		{
+			return std::span<IoUringAssetIORequest>{ mRequestContainerArr[std::to_underlying(priority)] };
+		}
+
+		std::span<const IoUringAssetIORequest> IoUringAssetIORequestBuilder::GetAssetIORequestSpan(const Brawler::JobPriority priority) const
+		{
+			return std::span<const IoUringAssetIORequest>{ mRequestContainerArr[std::to_underlying(priority)] };
+		}
+
+		void IoUringAssetIORequestBuilder::Finalize()
+		{
+			std::size_t numRequests = 0;
+
+			for (const auto& requestContainer : mRequestContainerArr)
+				numRequests += requestContainer.size();
+
+			mRequestTracker.SetActiveRequestCount(static_cast<std::uint32_t>(numRequests));
+		}
+
+		bool IoUringAssetIORequestBuilder::ReadyForDeletion() const
+		{
+			return mRequestTracker.IsAssetRequestEventComplete();
+		}
+
+		void IoUringAssetIORequestBuilder::EnqueueAssetIORequest(IoUringAssetIORequest&& assetIORequest)
+		{
+			// The IoUringAssetIORequestHandler creates the decompression job for a request with the
+			// request's priority, so the request needs to remember it.
+			const Brawler::JobPriority currPriority = GetAssetIORequestPriority();
+			assetIORequest.SetPriority(currPriority);
+
+			mRequestContainerArr[std::to_underlying(currPriority)].push_back(std::move(assetIORequest));
+		}
+	}
+}
+
+#endif
\ No newline at end of file
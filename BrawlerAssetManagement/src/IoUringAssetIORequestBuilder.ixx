@@ -0,0 +1,57 @@
+module;
+#include <array>
+#include <vector>
+#include <span>
+#include <atomic>
+
+export module Brawler.AssetManagement.IoUringAssetIORequestBuilder;
+import Brawler.AssetManagement.I_AssetIORequestBuilder;
+import Brawler.D3D12.I_BufferSubAllocation;
+import Brawler.FilePathHash;
+import Brawler.JobPriority;
+import Brawler.AssetManagement.IoUringAssetIORequest;
+import Brawler.AssetManagement.AssetRequestEventHandle;
+import Brawler.AssetManagement.Win32AssetIORequestTracker;
+
+#ifdef __linux__
+
+export namespace Brawler
+{
+	namespace AssetManagement
+	{
+		class IoUringAssetIORequestBuilder final : public I_AssetIORequestBuilder
+		{
+		private:
+			using RequestContainer = std::vector<IoUringAssetIORequest>;
+
+		public:
+			explicit IoUringAssetIORequestBuilder(AssetRequestEventHandle&& hAssetRequestEvent);
+
+			IoUringAssetIORequestBuilder(const IoUringAssetIORequestBuilder& rhs) = delete;
+			IoUringAssetIORequestBuilder& operator=(const IoUringAssetIORequestBuilder& rhs) = delete;
+
+			IoUringAssetIORequestBuilder(IoUringAssetIORequestBuilder&& rhs) noexcept = default;
+			IoUringAssetIORequestBuilder& operator=(IoUringAssetIORequestBuilder&& rhs) noexcept = default;
+
+			void AddAssetIORequest(const Brawler::FilePathHash pathHash, Brawler::D3D12::I_BufferSubAllocation& bufferSubAllocation) override;
+
+			void AddAssetIORequest(const CustomFileAssetIORequest& customFileRequest) override;
+
+			std::span<IoUringAssetIORequest> GetAssetIORequestSpan(const Brawler::JobPriority priority);
+			std::span<const IoUringAssetIORequest> GetAssetIORequestSpan(const Brawler::JobPriority priority) const;
+
+			void Finalize();
+
+			bool ReadyForDeletion() const;
+
+		private:
+			void EnqueueAssetIORequest(IoUringAssetIORequest&& assetIORequest);
+
+		private:
+			std::array<RequestContainer, std::to_underlying(Brawler::JobPriority::COUNT)> mRequestContainerArr;
+			Win32AssetIORequestTracker mRequestTracker;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
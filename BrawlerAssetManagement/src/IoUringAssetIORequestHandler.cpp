@@ -0,0 +1,424 @@
+module;
+#include <memory>
+#include <array>
+#include <vector>
+#include <span>
+#include <atomic>
+#include <mutex>
+#include <ranges>
+#include <optional>
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+#include <system_error>
+#include <string_view>
+#include <cassert>
+#include <iterator>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <liburing.h>
+#endif
+
+module Brawler.AssetManagement.IoUringAssetIORequestHandler;
+import Brawler.AssetManagement.AssetDependency;
+import Brawler.AssetManagement.BPKArchiveReader;
+import Brawler.JobSystem;
+
+#ifdef __linux__
+
+namespace
+{
+	void CheckIoUringResult(const int result, const std::string_view functionName)
+	{
+		// liburing functions return a negated errno value on failure.
+		if (result < 0) [[unlikely]]
+			throw std::runtime_error{ std::format("ERROR: {} failed with the following error: {}", functionName, std::system_category().message(-result)) };
+	}
+
+	int OpenFileForDirectIO(const std::filesystem::path& filePath)
+	{
+		int fileDescriptor = open(filePath.c_str(), O_RDONLY | O_DIRECT | O_CLOEXEC);
+
+		// Some file systems, such as tmpfs, do not support O_DIRECT at all. The reads still work
+		// without it; they just go through the page cache.
+		if (fileDescriptor < 0 && errno == EINVAL)
+			fileDescriptor = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+
+		if (fileDescriptor < 0) [[unlikely]]
+			throw std::runtime_error{ std::format("ERROR: The file {} could not be opened for asset I/O: {}", filePath.string(), std::system_category().message(errno)) };
+
+		return fileDescriptor;
+	}
+
+	// The first entry of the registered file table belongs to the BPK archive, so custom file
+	// slot i is found at entry (i + 1).
+	constexpr std::uint32_t CUSTOM_FILE_FIXED_FILE_INDEX_OFFSET = (Brawler::AssetManagement::BPK_ARCHIVE_FIXED_FILE_INDEX + 1);
+}
+
+namespace Brawler
+{
+	namespace AssetManagement
+	{
+		IoUringAssetIORequestHandler::IoUringAssetIORequestHandler() :
+			I_AssetIORequestHandler(),
+			mRing(),
+			mRegisteredBufferMemory(),
+			mRegisteredBufferAllocator(),
+			mCustomFileSlotAllocator(),
+			mPendingRequestArr(),
+			mPendingRequestCritSection(),
+			mSubmissionCritSection(),
+			mActiveBuilderArr(),
+			mNumReadsInFlight(0)
+		{
+			// We deliberately do not use IORING_SETUP_COOP_TASKRUN or IORING_SETUP_DEFER_TASKRUN. The
+			// thread which submits the reads never waits on the io_uring, and with either of those flags,
+			// some completions would only be posted once it enters the kernel again.
+			CheckIoUringResult(io_uring_queue_init(MAX_READS_IN_FLIGHT, &mRing, 0), "io_uring_queue_init()");
+
+			RegisterBPKArchive();
+			RegisterReadBuffers();
+
+			CreateDelayedCompletionJobForCurrentThread();
+		}
+
+		IoUringAssetIORequestHandler::~IoUringAssetIORequestHandler()
+		{
+			io_uring_queue_exit(&mRing);
+		}
+
+		void IoUringAssetIORequestHandler::PrepareAssetIORequest(EnqueuedAssetDependency&& enqueuedDependency)
+		{
+			std::unique_ptr<IoUringAssetIORequestBuilder> requestBuilderPtr{ std::make_unique<IoUringAssetIORequestBuilder>(std::move(enqueuedDependency.HRequestEvent)) };
+			enqueuedDependency.Dependency.BuildAssetIORequests(*requestBuilderPtr);
+
+			requestBuilderPtr->Finalize();
+
+			// Exit early if no IoUringAssetIORequests were actually made and the asset event was already
+			// marked as completed.
+			if (requestBuilderPtr->ReadyForDeletion()) [[unlikely]]
+				return;
+
+			// The requests need stable addresses once they are submitted, since the io_uring hands them
+			// back to us as the user data of their completions.
+			{
+				std::scoped_lock<std::mutex> pendingRequestLock{ mPendingRequestCritSection };
+
+				for (std::underlying_type_t<JobPriority> i = 0; i < std::to_underlying(JobPriority::COUNT); ++i)
+				{
+					for (auto&& request : requestBuilderPtr->GetAssetIORequestSpan(static_cast<JobPriority>(i)))
+						mPendingRequestArr[i].push_back(std::make_unique<IoUringAssetIORequest>(std::move(request)));
+				}
+			}
+
+			mActiveBuilderArr.PushBack(std::move(requestBuilderPtr));
+		}
+
+		void IoUringAssetIORequestHandler::SubmitAssetIORequests()
+		{
+			mActiveBuilderArr.EraseIf([] (const std::unique_ptr<IoUringAssetIORequestBuilder>& builderPtr)
+			{
+				return builderPtr->ReadyForDeletion();
+			});
+
+			SubmitPendingRequests();
+		}
+
+		void IoUringAssetIORequestHandler::SubmitPendingRequests()
+		{
+			std::scoped_lock<std::mutex> submissionLock{ mSubmissionCritSection };
+
+			std::array<std::vector<std::unique_ptr<IoUringAssetIORequest>>, std::to_underlying(JobPriority::COUNT)> requestArr{};
+
+			{
+				std::scoped_lock<std::mutex> pendingRequestLock{ mPendingRequestCritSection };
+				std::swap(requestArr, mPendingRequestArr);
+			}
+
+			// Requests which cannot be submitted yet, either because the io_uring already has as many reads
+			// in flight as it can take or because every custom file slot is in use, are put back into the
+			// pending request arrays. Either way, there is at least one read in flight which is holding
+			// the resource which they are waiting for, so they are submitted again once its completion is
+			// reaped in IoUringAssetIORequestHandler::ReapCompletedReads().
+			std::array<std::vector<std::unique_ptr<IoUringAssetIORequest>>, std::to_underlying(JobPriority::COUNT)> deferredRequestArr{};
+
+			const std::uint32_t numReadsInFlight = mNumReadsInFlight.load(std::memory_order::relaxed);
+			std::uint32_t numReadsPrepared = 0;
+
+			for (const auto i : std::views::iota(0u, static_cast<std::uint32_t>(requestArr.size())) | std::views::reverse)
+			{
+				for (auto& requestPtr : requestArr[i])
+				{
+					if ((numReadsInFlight + numReadsPrepared) >= MAX_READS_IN_FLIGHT || !TryAcquireRequestResources(*requestPtr))
+					{
+						deferredRequestArr[i].push_back(std::move(requestPtr));
+						continue;
+					}
+
+					// The submission queue is as large as the maximum number of reads in flight, and all of
+					// its entries are consumed by every io_uring_submit(), so this cannot fail.
+					io_uring_sqe* const sqePtr = io_uring_get_sqe(&mRing);
+					assert(sqePtr != nullptr && "ERROR: The io_uring submission queue of an IoUringAssetIORequestHandler was full!");
+
+					requestPtr->PrepareReadOperation(*sqePtr);
+
+					// The io_uring owns the request until its read completes. It is reclaimed in
+					// IoUringAssetIORequestHandler::ReapCompletedReads().
+					requestPtr.release();
+					++numReadsPrepared;
+				}
+			}
+
+			if (numReadsPrepared > 0)
+			{
+				// Count the reads as in flight before they are submitted. Otherwise, a thread reaping their
+				// completions could decrement the counter first.
+				mNumReadsInFlight.fetch_add(numReadsPrepared, std::memory_order::relaxed);
+
+				// If the kernel is too busy to take the submissions right now, then liburing keeps them in
+				// the submission queue, and they will be submitted along with the next batch.
+				const int submitResult = io_uring_submit(&mRing);
+
+				if (submitResult != -EAGAIN && submitResult != -EBUSY) [[likely]]
+					CheckIoUringResult(submitResult, "io_uring_submit()");
+			}
+
+			bool hasDeferredRequests = false;
+
+			for (const auto& deferredRequestContainer : deferredRequestArr)
+				hasDeferredRequests = (hasDeferredRequests || !deferredRequestContainer.empty());
+
+			if (!hasDeferredRequests)
+				return;
+
+			// Requests which came in while we were submitting are placed after the deferred requests,
+			// so that requests are still submitted in the order in which they were made.
+			std::scoped_lock<std::mutex> pendingRequestLock{ mPendingRequestCritSection };
+
+			for (std::size_t i = 0; i < deferredRequestArr.size(); ++i)
+			{
+				deferredRequestArr[i].insert(deferredRequestArr[i].end(), std::make_move_iterator(mPendingRequestArr[i].begin()), std::make_move_iterator(mPendingRequestArr[i].end()));
+				mPendingRequestArr[i] = std::move(deferredRequestArr[i]);
+			}
+		}
+
+		void IoUringAssetIORequestHandler::RegisterBPKArchive()
+		{
+			// Empty entries of the registered file table are marked with -1. Custom files are registered
+			// into them later with io_uring_register_files_update().
+			std::array<int, FIXED_FILE_TABLE_SIZE> fileDescriptorArr{};
+			fileDescriptorArr.fill(-1);
+
+			const int bpkFileDescriptor = OpenFileForDirectIO(BPKArchiveReader::GetBPKArchiveFilePath());
+			fileDescriptorArr[BPK_ARCHIVE_FIXED_FILE_INDEX] = bpkFileDescriptor;
+
+			const int registerResult = io_uring_register_files(&mRing, fileDescriptorArr.data(), static_cast<std::uint32_t>(fileDescriptorArr.size()));
+
+			// The io_uring holds its own reference to every registered file, so we no longer need the
+			// file descriptor.
+			close(bpkFileDescriptor);
+
+			CheckIoUringResult(registerResult, "io_uring_register_files()");
+		}
+
+		void IoUringAssetIORequestHandler::RegisterReadBuffers()
+		{
+			mRegisteredBufferMemory = AllocateDirectIOBuffer(REGISTERED_BUFFER_COUNT * REGISTERED_BUFFER_SIZE);
+
+			std::array<iovec, REGISTERED_BUFFER_COUNT> bufferIOVecArr{};
+
+			for (const auto i : std::views::iota(0u, REGISTERED_BUFFER_COUNT))
+			{
+				bufferIOVecArr[i] = iovec{
+					.iov_base = (mRegisteredBufferMemory.get() + (i * REGISTERED_BUFFER_SIZE)),
+					.iov_len = REGISTERED_BUFFER_SIZE
+				};
+			}
+
+			const int registerResult = io_uring_register_buffers(&mRing, bufferIOVecArr.data(), static_cast<std::uint32_t>(bufferIOVecArr.size()));
+
+			// If the buffers cannot be pinned because the RLIMIT_MEMLOCK of this process is too low, then
+			// every read simply gets a buffer from the heap instead.
+			if (registerResult == -ENOMEM) [[unlikely]]
+			{
+				mRegisteredBufferMemory.reset();
+				return;
+			}
+
+			CheckIoUringResult(registerResult, "io_uring_register_buffers()");
+		}
+
+		bool IoUringAssetIORequestHandler::TryAcquireRequestResources(IoUringAssetIORequest& request)
+		{
+			// Requests whose reads came up short are submitted again, but they already own everything
+			// which they need.
+			if (!request.GetFixedFileIndex().has_value())
+			{
+				assert(request.IsCustomFileRequest());
+
+				const std::optional<std::uint32_t> customFileSlot{ mCustomFileSlotAllocator.Allocate() };
+
+				if (!customFileSlot.has_value()) [[unlikely]]
+					return false;
+
+				const std::uint32_t fixedFileIndex = (*customFileSlot + CUSTOM_FILE_FIXED_FILE_INDEX_OFFSET);
+				int fileDescriptor = -1;
+
+				try
+				{
+					fileDescriptor = OpenFileForDirectIO(request.GetCustomFilePath());
+				}
+				catch (...)
+				{
+					mCustomFileSlotAllocator.Free(*customFileSlot);
+					throw;
+				}
+
+				// Replacing the entry also drops the reference to whichever file was previously
+				// registered there.
+				const int updateResult = io_uring_register_files_update(&mRing, fixedFileIndex, &fileDescriptor, 1);
+				close(fileDescriptor);
+
+				CheckIoUringResult(updateResult, "io_uring_register_files_update()");
+
+				request.SetFixedFileIndex(fixedFileIndex);
+			}
+
+			if (!request.HasReadBuffer())
+			{
+				std::optional<std::uint32_t> registeredBufferIndex{};
+
+				if (mRegisteredBufferMemory != nullptr && request.GetAlignedReadSizeInBytes() <= REGISTERED_BUFFER_SIZE)
+					registeredBufferIndex = mRegisteredBufferAllocator.Allocate();
+
+				if (registeredBufferIndex.has_value()) [[likely]]
+				{
+					const std::span<std::byte> registeredBufferSpan{ (mRegisteredBufferMemory.get() + (*registeredBufferIndex * REGISTERED_BUFFER_SIZE)), REGISTERED_BUFFER_SIZE };
+					request.SetRegisteredReadBuffer(registeredBufferSpan, *registeredBufferIndex);
+				}
+				else
+					request.AllocateReadBuffer();
+			}
+
+			return true;
+		}
+
+		void IoUringAssetIORequestHandler::ReleaseCustomFileSlot(const IoUringAssetIORequest& request)
+		{
+			// The file stays registered until its slot is handed out again. That is fine, since nothing
+			// can read from a slot which is not in use.
+			if (request.IsCustomFileRequest())
+				mCustomFileSlotAllocator.Free(*(request.GetFixedFileIndex()) - CUSTOM_FILE_FIXED_FILE_INDEX_OFFSET);
+		}
+
+		void IoUringAssetIORequestHandler::ReleaseReadBuffer(const IoUringAssetIORequest& request)
+		{
+			const std::optional<std::uint32_t> registeredBufferIndex{ request.GetRegisteredBufferIndex() };
+
+			if (registeredBufferIndex.has_value())
+				mRegisteredBufferAllocator.Free(*registeredBufferIndex);
+		}
+
+		void IoUringAssetIORequestHandler::ReapCompletedReads()
+		{
+			// Only the thread executing the delayed CPU job ever touches the completion queue, so we can
+			// read it without any synchronization of our own.
+			std::array<std::vector<std::unique_ptr<IoUringAssetIORequest>>, std::to_underlying(JobPriority::COUNT)> completedRequestArr{};
+			std::vector<std::unique_ptr<IoUringAssetIORequest>> shortReadRequestArr{};
+
+			std::uint32_t numCompletionsSeen = 0;
+			std::uint32_t completionQueueHead = 0;
+			io_uring_cqe* cqePtr = nullptr;
+
+			io_uring_for_each_cqe(&mRing, completionQueueHead, cqePtr)
+			{
+				++numCompletionsSeen;
+
+				std::unique_ptr<IoUringAssetIORequest> requestPtr{ static_cast<IoUringAssetIORequest*>(io_uring_cqe_get_data(cqePtr)) };
+
+				if (requestPtr->OnReadCompleted(cqePtr->res)) [[likely]]
+				{
+					// Once the read is done, the file is no longer needed; only the data in the read buffer
+					// is. We give the custom file slot back right away, so that deferred requests waiting for
+					// one can be submitted below.
+					ReleaseCustomFileSlot(*requestPtr);
+
+					const JobPriority requestPriority = requestPtr->GetPriority();
+					completedRequestArr[std::to_underlying(requestPriority)].push_back(std::move(requestPtr));
+				}
+				else [[unlikely]]
+					shortReadRequestArr.push_back(std::move(requestPtr));
+			}
+
+			io_uring_cq_advance(&mRing, numCompletionsSeen);
+			mNumReadsInFlight.fetch_sub(numCompletionsSeen, std::memory_order::relaxed);
+
+			// Reads which came up short go back into the pending request arrays. They keep the resources
+			// which they already own.
+			if (!shortReadRequestArr.empty()) [[unlikely]]
+			{
+				std::scoped_lock<std::mutex> pendingRequestLock{ mPendingRequestCritSection };
+
+				for (auto& requestPtr : shortReadRequestArr)
+				{
+					const JobPriority requestPriority = requestPtr->GetPriority();
+					mPendingRequestArr[std::to_underlying(requestPriority)].push_back(std::move(requestPtr));
+				}
+			}
+
+			// The reads which we just reaped freed up room in the io_uring, and possibly some custom file
+			// slots, so we submit whatever is pending now. Otherwise, deferred requests and short reads
+			// would have to wait for the next call to IoUringAssetIORequestHandler::SubmitAssetIORequests(),
+			// which might never come if no more assets are requested.
+			if (numCompletionsSeen > 0) [[likely]]
+				SubmitPendingRequests();
+
+			// Decompressing the data and writing it to its destination is the expensive part, so every
+			// completed read gets a CPU job of its own.
+			for (const auto i : std::views::iota(0u, static_cast<std::uint32_t>(completedRequestArr.size())))
+			{
+				if (completedRequestArr[i].empty())
+					continue;
+
+				Brawler::JobGroup writeAssetDataGroup{ static_cast<JobPriority>(i) };
+				writeAssetDataGroup.Reserve(completedRequestArr[i].size());
+
+				for (auto& requestPtr : completedRequestArr[i])
+					writeAssetDataGroup.AddJob([this, requestPtr = std::move(requestPtr)] ()
+				{
+					requestPtr->WriteAssetData();
+					ReleaseReadBuffer(*requestPtr);
+				});
+
+				writeAssetDataGroup.ExecuteJobsAsync();
+			}
+
+			CreateDelayedCompletionJobForCurrentThread();
+		}
+
+		void IoUringAssetIORequestHandler::CreateDelayedCompletionJobForCurrentThread()
+		{
+			// Create a delayed CPU job which reaps completions once there are any. There is only ever one
+			// of these in circulation, which is what makes it safe for ReapCompletedReads() to touch the
+			// completion queue without a lock.
+			Brawler::DelayedJobGroup delayedCompletionGroup{};
+			delayedCompletionGroup.Reserve(1);
+
+			delayedCompletionGroup.AddJob([this] ()
+			{
+				ReapCompletedReads();
+			});
+
+			delayedCompletionGroup.SubmitDelayedJobs([this] ()
+			{
+				return (io_uring_cq_ready(&mRing) > 0);
+			});
+		}
+	}
+}
+
+#endif
\ No newline at end of file
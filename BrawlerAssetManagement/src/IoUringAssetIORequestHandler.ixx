@@ -0,0 +1,121 @@
+module;
+#include <memory>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <mutex>
+
+#ifdef __linux__
+#include <liburing.h>
+#endif
+
+export module Brawler.AssetManagement.IoUringAssetIORequestHandler;
+import Brawler.AssetManagement.I_AssetIORequestHandler;
+import Brawler.AssetManagement.EnqueuedAssetDependency;
+import Brawler.ThreadSafeVector;
+import Brawler.AtomicBitmapIndexAllocator;
+import Brawler.AssetManagement.IoUringAssetIORequestBuilder;
+import Brawler.AssetManagement.IoUringAssetIORequest;
+import Brawler.JobPriority;
+
+#ifdef __linux__
+
+namespace Brawler
+{
+	namespace AssetManagement
+	{
+		/// <summary>
+		/// This is the maximum number of reads which can be in flight at once. It is also the size of
+		/// the submission queue, so every call to IoUringAssetIORequestHandler::SubmitAssetIORequests()
+		/// fits into a single io_uring_submit(). (The completion queue is twice as large by default, so
+		/// it can never overflow.)
+		/// </summary>
+		static constexpr std::uint32_t MAX_READS_IN_FLIGHT = 512;
+
+		/// <summary>
+		/// The BPK archive always occupies the first entry of the registered file table. The remaining
+		/// entries are handed out to custom file requests for as long as their reads are in flight.
+		/// </summary>
+		static constexpr std::uint32_t FIXED_FILE_TABLE_SIZE = 64;
+		static constexpr std::uint32_t CUSTOM_FILE_SLOT_COUNT = (FIXED_FILE_TABLE_SIZE - 1);
+
+		/// <summary>
+		/// Most asset extents are small enough to be read into one of these registered buffers. Larger
+		/// ones get a buffer of their own from the heap. Registered buffers are pinned, and older kernels
+		/// count them against RLIMIT_MEMLOCK, so we keep the total at a modest 8 MB.
+		/// </summary>
+		static constexpr std::uint32_t REGISTERED_BUFFER_COUNT = 32;
+		static constexpr std::uint64_t REGISTERED_BUFFER_SIZE = (256 * 1024);
+	}
+}
+
+export namespace Brawler
+{
+	namespace AssetManagement
+	{
+		// The IoUringAssetIORequestHandler is the I_AssetIORequestHandler used on Linux. Rather than
+		// having threads block on one read at a time, every request made since the last call to
+		// IoUringAssetIORequestHandler::SubmitAssetIORequests() is submitted to an io_uring at once, so
+		// the storage device sees as many outstanding reads as we can give it.
+		//
+		// The BPK archive is opened with O_DIRECT and registered with the io_uring once, and reads use
+		// a set of pre-registered buffers whenever the data fits into one. This saves the kernel from
+		// looking up the file and pinning the destination pages for every single read.
+		//
+		// Completions are handled much like the Win32AssetIORequestHandler handles new requests: a single
+		// delayed CPU job waits until the completion queue is not empty. The thread which executes it
+		// creates one CPU job for every completed read, which decompresses the data and writes it to its
+		// destination, and then creates the next delayed CPU job. Like with DirectStorage, the number of
+		// threads doing I/O is thus independent of the AssetLoadingMode.
+
+		class IoUringAssetIORequestHandler final : public I_AssetIORequestHandler
+		{
+		public:
+			IoUringAssetIORequestHandler();
+			~IoUringAssetIORequestHandler();
+
+			IoUringAssetIORequestHandler(const IoUringAssetIORequestHandler& rhs) = delete;
+			IoUringAssetIORequestHandler& operator=(const IoUringAssetIORequestHandler& rhs) = delete;
+
+			IoUringAssetIORequestHandler(IoUringAssetIORequestHandler&& rhs) noexcept = delete;
+			IoUringAssetIORequestHandler& operator=(IoUringAssetIORequestHandler&& rhs) noexcept = delete;
+
+			void PrepareAssetIORequest(EnqueuedAssetDependency&& enqueuedDependency) override;
+			void SubmitAssetIORequests() override;
+
+		private:
+			void RegisterBPKArchive();
+			void RegisterReadBuffers();
+
+			/// <summary>
+			/// Submits as many of the pending requests to the io_uring as it can currently take. Requests
+			/// which do not fit remain pending. This is called both by
+			/// IoUringAssetIORequestHandler::SubmitAssetIORequests() and after completions are reaped,
+			/// since the latter frees up the room which deferred requests are waiting for.
+			/// </summary>
+			void SubmitPendingRequests();
+
+			bool TryAcquireRequestResources(IoUringAssetIORequest& request);
+			void ReleaseCustomFileSlot(const IoUringAssetIORequest& request);
+			void ReleaseReadBuffer(const IoUringAssetIORequest& request);
+
+			void ReapCompletedReads();
+			void CreateDelayedCompletionJobForCurrentThread();
+
+		private:
+			io_uring mRing;
+			DirectIOBuffer mRegisteredBufferMemory;
+			Brawler::AtomicBitmapIndexAllocator<REGISTERED_BUFFER_COUNT> mRegisteredBufferAllocator;
+			Brawler::AtomicBitmapIndexAllocator<CUSTOM_FILE_SLOT_COUNT> mCustomFileSlotAllocator;
+			std::array<std::vector<std::unique_ptr<IoUringAssetIORequest>>, std::to_underlying(JobPriority::COUNT)> mPendingRequestArr;
+			std::mutex mPendingRequestCritSection;
+
+			// Only one thread at a time may touch the submission queue and the registered file table.
+			std::mutex mSubmissionCritSection;
+			Brawler::ThreadSafeVector<std::unique_ptr<IoUringAssetIORequestBuilder>> mActiveBuilderArr;
+			std::atomic<std::uint32_t> mNumReadsInFlight;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -35,6 +35,18 @@ namespace Brawler
 				}
 			}
 		};
+
+		struct DecompressionDictionaryDeleter
+		{
+			void operator()(ZSTD_DDict* dictionaryPtr) const
+			{
+				if (dictionaryPtr != nullptr)
+				{
+					const std::size_t deleteResult = ZSTD_freeDDict(dictionaryPtr);
+					assert(!ZSTD_isError(deleteResult) && "ERROR: ZSTD failed to delete a decompression dictionary (ZSTD_DDict)!");
+				}
+			}
+		};
 	}
 }
 
@@ -44,6 +56,7 @@ export namespace Brawler
 	{
 		using ZSTDCompressionContextIMPL = std::unique_ptr<ZSTD_CCtx, CompressionContextDeleter>;
 		using ZSTDDecompressionContextIMPL = std::unique_ptr<ZSTD_DCtx, DecompressionContextDeleter>;
+		using ZSTDDecompressionDictionaryIMPL = std::unique_ptr<ZSTD_DDict, DecompressionDictionaryDeleter>;
 
 		template <typename T>
 		concept IsZSTDContextType = (std::is_same_v<T, ZSTDCompressionContextIMPL> || std::is_same_v<T, ZSTDDecompressionContextIMPL>);
@@ -2,6 +2,7 @@ module;
 #include <array>
 #include <vector>
 #include <span>
+#include <memory>
 #include <atomic>
 #include <cassert>
 #include <filesystem>
@@ -38,13 +39,16 @@ namespace Brawler
 
 				if (tocEntry.IsDataCompressed())
 				{
-					ZSTDDecompressionOperation decompressionOperation{};
-					Util::General::CheckHRESULT(decompressionOperation.BeginDecompressionOperation(srcDataSpan));
+					// The ToC tells us exactly how large the decompressed data is, so we can decompress
+					// straight into a single allocation. We don't need it to be zero-initialized, since
+					// every byte of it will be overwritten.
+					const std::size_t uncompressedSize = static_cast<std::size_t>(tocEntry.UncompressedSizeInBytes);
+					const std::unique_ptr<std::byte[]> decompressedDataPtr{ std::make_unique_for_overwrite<std::byte[]>(uncompressedSize) };
+					const std::span<std::byte> decompressedDataSpan{ decompressedDataPtr.get(), uncompressedSize };
 
-					const ZSTDDecompressionOperation::DecompressionResults decompressResults{ decompressionOperation.FinishDecompressionOperation() };
-					Util::General::CheckHRESULT(decompressResults.HResult);
+					Util::General::CheckHRESULT(ZSTDDecompressionOperation::DecompressData(srcDataSpan, decompressedDataSpan));
 
-					bufferSubAllocation.WriteToBuffer(std::span<const std::byte>{ decompressResults.DecompressedByteArr }, 0);
+					bufferSubAllocation.WriteToBuffer(std::span<const std::byte>{ decompressedDataSpan }, 0);
 				}
 				else
 				{
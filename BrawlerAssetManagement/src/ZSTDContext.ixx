@@ -3,6 +3,7 @@ module;
 export module Brawler.AssetManagement.ZSTDContext;
 import :UnderlyingZSTDContextTypes;
 import :WrappedZSTDContext;
+export import :ZSTDContextQueue;
 
 export namespace Brawler
 {
@@ -1,6 +1,12 @@
 module;
 #include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <span>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <stdexcept>
 #include <zstd.h>
 
 export module Brawler.AssetManagement.ZSTDContext:ZSTDContextQueue;
@@ -44,6 +50,34 @@ export namespace Brawler
 				requires IsZSTDContextType<ContextType>
 			void ReturnZSTDContext(ContextType&& context);
 
+			/// <summary>
+			/// Creates a ZSTD_DDict from the specified dictionary data and makes it available to
+			/// every subsequent call to ZSTDContextQueue::GetDecompressionDictionary(). The
+			/// dictionary data is copied, so dictionaryDataSpan does not need to remain valid
+			/// after this function returns.
+			/// 
+			/// Creating a ZSTD_DDict means digesting the entire dictionary, so this should only
+			/// happen once per dictionary. If a dictionary with the same ID has already been
+			/// added, then this function does nothing.
+			/// </summary>
+			/// <param name="dictionaryID">
+			/// - The ID of the dictionary. This is the ID which ZSTD writes into the header of
+			///   every frame compressed with it.
+			/// </param>
+			/// <param name="dictionaryDataSpan">
+			/// - The dictionary data, as it was written by the Brawler File Packer.
+			/// </param>
+			void AddDecompressionDictionary(const std::uint32_t dictionaryID, const std::span<const std::byte> dictionaryDataSpan);
+
+			/// <summary>
+			/// Returns the ZSTD_DDict which was created for the dictionary with the specified ID
+			/// in a previous call to ZSTDContextQueue::AddDecompressionDictionary(), or nullptr if
+			/// there is no such dictionary. Dictionaries are never removed, and a ZSTD_DDict is
+			/// read-only, so the returned pointer can be shared between any number of
+			/// decompression contexts on any number of threads.
+			/// </summary>
+			const ZSTD_DDict* GetDecompressionDictionary(const std::uint32_t dictionaryID) const;
+
 		private:
 			ZSTDCompressionContextIMPL GetZSTDCompressionContext();
 			ZSTDDecompressionContextIMPL GetZSTDDecompressionContext();
@@ -51,6 +85,9 @@ export namespace Brawler
 		private:
 			Brawler::ThreadSafeQueue<ZSTDCompressionContextIMPL, COMPRESSION_CONTEXT_QUEUE_SIZE> mCompressionContextQueue;
 			Brawler::ThreadSafeQueue<ZSTDDecompressionContextIMPL, DECOMPRESSION_CONTEXT_QUEUE_SIZE> mDecompressionContextQueue;
+
+			std::unordered_map<std::uint32_t, ZSTDDecompressionDictionaryIMPL> mDecompressionDictionaryMap;
+			mutable std::shared_mutex mDecompressionDictionaryCritSection;
 		};
 	}
 }
@@ -88,6 +125,34 @@ namespace Brawler
 				std::ignore = mDecompressionContextQueue.PushBack(std::move(context));
 		}
 
+		void ZSTDContextQueue::AddDecompressionDictionary(const std::uint32_t dictionaryID, const std::span<const std::byte> dictionaryDataSpan)
+		{
+			{
+				std::shared_lock<std::shared_mutex> readLock{ mDecompressionDictionaryCritSection };
+
+				if (mDecompressionDictionaryMap.contains(dictionaryID))
+					return;
+			}
+
+			// Digest the dictionary before taking the write lock, so that threads which are
+			// looking up other dictionaries are not held up by this.
+			ZSTDDecompressionDictionaryIMPL decompressionDictionary{ ZSTD_createDDict(dictionaryDataSpan.data(), dictionaryDataSpan.size_bytes()) };
+
+			if (decompressionDictionary == nullptr) [[unlikely]]
+				throw std::runtime_error{ "ERROR: ZSTD failed to create a decompression dictionary (ZSTD_DDict)!" };
+
+			std::scoped_lock<std::shared_mutex> writeLock{ mDecompressionDictionaryCritSection };
+			mDecompressionDictionaryMap.try_emplace(dictionaryID, std::move(decompressionDictionary));
+		}
+
+		const ZSTD_DDict* ZSTDContextQueue::GetDecompressionDictionary(const std::uint32_t dictionaryID) const
+		{
+			std::shared_lock<std::shared_mutex> readLock{ mDecompressionDictionaryCritSection };
+
+			const auto itr = mDecompressionDictionaryMap.find(dictionaryID);
+			return (itr != mDecompressionDictionaryMap.end() ? itr->second.get() : nullptr);
+		}
+
 		ZSTDCompressionContextIMPL ZSTDContextQueue::GetZSTDCompressionContext()
 		{
 			std::optional<ZSTDCompressionContextIMPL> optionalContext{ mCompressionContextQueue.TryPop() };
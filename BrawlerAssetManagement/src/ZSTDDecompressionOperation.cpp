@@ -1,12 +1,208 @@
 module;
 #include <span>
 #include <vector>
+#include <memory>
+#include <atomic>
+#include <optional>
+#include <algorithm>
+#include <cstring>
 #include <cassert>
 #include <zstd.h>
 #include <DxDef.h>
 
 module Brawler.AssetManagement.ZSTDDecompressionOperation;
 import Util.ZSTD;
+import Brawler.AssetManagement.ZSTDSeekTable;
+import Brawler.JobSystem;
+import Brawler.AssetManagement.ZSTDContext;
+
+namespace
+{
+	// Decompressing a single chunk of a seekable ZSTD stream is not enough work to justify a
+	// CPU job of its own, so every job decompresses (at least) this many bytes.
+	static constexpr std::size_t MIN_UNCOMPRESSED_BYTES_PER_JOB = (1 << 20);
+
+	struct DictionaryLookupResults
+	{
+		/// <summary>
+		/// This is the ZSTD_DDict which the data needs to be decompressed with, or nullptr if
+		/// the data was compressed without a dictionary.
+		/// </summary>
+		const ZSTD_DDict* DecompressionDictionaryPtr;
+
+		HRESULT HResult;
+	};
+
+	DictionaryLookupResults GetDecompressionDictionaryForData(std::span<const std::byte> srcDataSpan)
+	{
+		// The Brawler File Packer compresses every chunk of an asset with the same dictionary,
+		// so we only need to look at the first frame which actually contains data. Skippable
+		// frames, such as the one containing the seek table, have no dictionary ID.
+		while (srcDataSpan.size_bytes() >= sizeof(std::uint32_t))
+		{
+			std::uint32_t magicNumber = 0;
+			std::memcpy(&magicNumber, srcDataSpan.data(), sizeof(magicNumber));
+
+			if ((magicNumber & ZSTD_MAGIC_SKIPPABLE_MASK) != ZSTD_MAGIC_SKIPPABLE_START)
+				break;
+
+			const std::size_t skippableFrameSize = ZSTD_findFrameCompressedSize(srcDataSpan.data(), srcDataSpan.size_bytes());
+
+			if (ZSTD_isError(skippableFrameSize)) [[unlikely]]
+				return DictionaryLookupResults{
+					.DecompressionDictionaryPtr = nullptr,
+					.HResult = Util::ZSTD::ZSTDErrorToHRESULT(skippableFrameSize)
+				};
+
+			srcDataSpan = srcDataSpan.subspan(skippableFrameSize);
+		}
+
+		const std::uint32_t dictionaryID = ZSTD_getDictID_fromFrame(srcDataSpan.data(), srcDataSpan.size_bytes());
+
+		if (dictionaryID == 0)
+			return DictionaryLookupResults{
+				.DecompressionDictionaryPtr = nullptr,
+				.HResult = S_OK
+			};
+
+		const ZSTD_DDict* const decompressionDictionaryPtr = Brawler::AssetManagement::ZSTDContextQueue::GetInstance().GetDecompressionDictionary(dictionaryID);
+
+		// If the dictionary was never registered, then the data did not come from the BPK
+		// archive which we loaded the dictionaries from. There is no way that we can
+		// decompress it.
+		return DictionaryLookupResults{
+			.DecompressionDictionaryPtr = decompressionDictionaryPtr,
+			.HResult = (decompressionDictionaryPtr != nullptr ? S_OK : E_INVALIDARG)
+		};
+	}
+
+	HRESULT DecompressChunk(ZSTD_DCtx& decompressionContext, const Brawler::AssetManagement::ZSTDSeekTable& seekTable, const ZSTD_DDict* const decompressionDictionaryPtr, const std::uint32_t chunkIndex, const std::span<std::byte> destChunkSpan)
+	{
+		assert(destChunkSpan.size_bytes() == seekTable.GetUncompressedChunkSize(chunkIndex));
+
+		const std::span<const std::byte> compressedChunkSpan{ seekTable.GetCompressedChunkSpan(chunkIndex) };
+
+		// Every chunk is an independent frame whose header contains its decompressed size, so
+		// ZSTD can decompress it in a single pass without any intermediate buffering. A
+		// ZSTD_DDict is already digested, so using one adds no per-chunk cost; if
+		// decompressionDictionaryPtr is nullptr, then no dictionary is used.
+		const std::size_t zstdResult = ZSTD_decompress_usingDDict(&decompressionContext, destChunkSpan.data(), destChunkSpan.size_bytes(), compressedChunkSpan.data(), compressedChunkSpan.size_bytes(), decompressionDictionaryPtr);
+
+		if (ZSTD_isError(zstdResult)) [[unlikely]]
+			return Util::ZSTD::ZSTDErrorToHRESULT(zstdResult);
+
+		// If the chunk decompressed to a different size than what the seek table claims, then
+		// the data is corrupt.
+		return (zstdResult == destChunkSpan.size_bytes() ? S_OK : E_INVALIDARG);
+	}
+
+	HRESULT DecompressSeekableDataRange(const Brawler::AssetManagement::ZSTDSeekTable& seekTable, const ZSTD_DDict* const decompressionDictionaryPtr, const std::size_t uncompressedOffset, const std::span<std::byte> destDataSpan)
+	{
+		if (destDataSpan.empty()) [[unlikely]]
+			return S_OK;
+
+		Brawler::AssetManagement::ZSTDDecompressionContext decompressionContext{};
+
+		// Contexts are shared through the ZSTDContextQueue, so we need to make sure that
+		// nothing from its last use (e.g., a referenced dictionary) carries over.
+		const std::size_t zstdError = ZSTD_DCtx_reset(decompressionContext.Get(), ZSTD_ResetDirective::ZSTD_reset_session_and_parameters);
+
+		if (ZSTD_isError(zstdError)) [[unlikely]]
+			return Util::ZSTD::ZSTDErrorToHRESULT(zstdError);
+
+		const std::size_t rangeEndOffset = (uncompressedOffset + destDataSpan.size_bytes());
+		const std::uint32_t firstChunkIndex = seekTable.GetChunkIndexForUncompressedOffset(uncompressedOffset);
+		const std::uint32_t lastChunkIndex = seekTable.GetChunkIndexForUncompressedOffset(rangeEndOffset - 1);
+
+		for (std::uint32_t currChunkIndex = firstChunkIndex; currChunkIndex <= lastChunkIndex; ++currChunkIndex)
+		{
+			const std::size_t chunkBeginOffset = seekTable.GetUncompressedChunkOffset(currChunkIndex);
+			const std::size_t chunkSize = seekTable.GetUncompressedChunkSize(currChunkIndex);
+
+			const std::size_t copyBeginOffset = std::max(uncompressedOffset, chunkBeginOffset);
+			const std::size_t copyEndOffset = std::min(rangeEndOffset, (chunkBeginOffset + chunkSize));
+			const std::span<std::byte> destCopySpan{ destDataSpan.subspan((copyBeginOffset - uncompressedOffset), (copyEndOffset - copyBeginOffset)) };
+
+			HRESULT hr = S_OK;
+
+			if (destCopySpan.size_bytes() == chunkSize)
+				hr = DecompressChunk(*(decompressionContext.Get()), seekTable, decompressionDictionaryPtr, currChunkIndex, destCopySpan);
+			else
+			{
+				// Only part of this chunk was requested, so we need to decompress it into a
+				// temporary buffer first. This can only happen for the first and last chunks
+				// of the range.
+				const std::unique_ptr<std::byte[]> chunkBuffer{ std::make_unique_for_overwrite<std::byte[]>(chunkSize) };
+				hr = DecompressChunk(*(decompressionContext.Get()), seekTable, decompressionDictionaryPtr, currChunkIndex, std::span<std::byte>{ chunkBuffer.get(), chunkSize });
+
+				if (SUCCEEDED(hr)) [[likely]]
+					std::memcpy(destCopySpan.data(), chunkBuffer.get() + (copyBeginOffset - chunkBeginOffset), destCopySpan.size_bytes());
+			}
+
+			if (FAILED(hr)) [[unlikely]]
+				return hr;
+		}
+
+		return S_OK;
+	}
+
+	HRESULT DecompressSeekableDataRangeInParallel(const Brawler::AssetManagement::ZSTDSeekTable& seekTable, const std::size_t uncompressedOffset, const std::span<std::byte> destDataSpan)
+	{
+		if (destDataSpan.empty()) [[unlikely]]
+			return S_OK;
+
+		// Look up the dictionary once, rather than once for every chunk.
+		const DictionaryLookupResults dictionaryLookupResults{ GetDecompressionDictionaryForData(seekTable.GetCompressedChunkSpan(0)) };
+
+		if (FAILED(dictionaryLookupResults.HResult)) [[unlikely]]
+			return dictionaryLookupResults.HResult;
+
+		const ZSTD_DDict* const decompressionDictionaryPtr = dictionaryLookupResults.DecompressionDictionaryPtr;
+
+		// Every job is assigned a whole number of chunks, so that no chunk ever has to be
+		// decompressed twice.
+		const std::size_t chunkSize = seekTable.GetUncompressedChunkSize(0);
+		const std::size_t bytesPerJob = std::max<std::size_t>(1, (MIN_UNCOMPRESSED_BYTES_PER_JOB / chunkSize)) * chunkSize;
+
+		const std::size_t rangeEndOffset = (uncompressedOffset + destDataSpan.size_bytes());
+		const std::size_t firstJobIndex = (uncompressedOffset / bytesPerJob);
+		const std::size_t lastJobIndex = ((rangeEndOffset - 1) / bytesPerJob);
+
+		// If everything fits into a single job, then there is no point in involving the job
+		// system.
+		if (firstJobIndex == lastJobIndex)
+			return DecompressSeekableDataRange(seekTable, decompressionDictionaryPtr, uncompressedOffset, destDataSpan);
+
+		std::atomic<HRESULT> firstErrorHResult{ S_OK };
+
+		Brawler::JobGroup decompressionJobGroup{};
+		decompressionJobGroup.Reserve(lastJobIndex - firstJobIndex + 1);
+
+		for (std::size_t currJobIndex = firstJobIndex; currJobIndex <= lastJobIndex; ++currJobIndex)
+		{
+			const std::size_t jobBeginOffset = std::max(uncompressedOffset, (currJobIndex * bytesPerJob));
+			const std::size_t jobEndOffset = std::min(rangeEndOffset, ((currJobIndex + 1) * bytesPerJob));
+			const std::span<std::byte> jobDestDataSpan{ destDataSpan.subspan((jobBeginOffset - uncompressedOffset), (jobEndOffset - jobBeginOffset)) };
+
+			decompressionJobGroup.AddJob([&seekTable, &firstErrorHResult, decompressionDictionaryPtr, jobBeginOffset, jobDestDataSpan] ()
+			{
+				const HRESULT hr = DecompressSeekableDataRange(seekTable, decompressionDictionaryPtr, jobBeginOffset, jobDestDataSpan);
+
+				if (FAILED(hr)) [[unlikely]]
+				{
+					HRESULT expectedHResult = S_OK;
+					firstErrorHResult.compare_exchange_strong(expectedHResult, hr, std::memory_order::relaxed);
+				}
+			});
+		}
+
+		// JobGroup::ExecuteJobs() does not return until every job has finished, and the calling
+		// thread executes jobs while it waits.
+		decompressionJobGroup.ExecuteJobs();
+
+		return firstErrorHResult.load(std::memory_order::relaxed);
+	}
+}
 
 namespace Brawler
 {
@@ -23,7 +219,15 @@ namespace Brawler
 			if (ZSTD_isError(zstdError)) [[unlikely]]
 				return Util::ZSTD::ZSTDErrorToHRESULT(zstdError);
 
-			zstdError = ZSTD_DCtx_refDDict(mDecompressionContext.Get(), nullptr);
+			// If the data was compressed with a dictionary, then we need to reference it before
+			// decompressing anything. Otherwise, this removes whichever dictionary the context
+			// referenced the last time it was used.
+			const DictionaryLookupResults dictionaryLookupResults{ GetDecompressionDictionaryForData(srcDataSpan) };
+
+			if (FAILED(dictionaryLookupResults.HResult)) [[unlikely]]
+				return dictionaryLookupResults.HResult;
+
+			zstdError = ZSTD_DCtx_refDDict(mDecompressionContext.Get(), dictionaryLookupResults.DecompressionDictionaryPtr);
 
 			if (ZSTD_isError(zstdError)) [[unlikely]]
 				return Util::ZSTD::ZSTDErrorToHRESULT(zstdError);
@@ -52,15 +256,7 @@ namespace Brawler
 				.pos = 0
 			};
 
-			const std::size_t zstdError = ZSTD_decompressStream(mDecompressionContext.Get(), &outputBuffer, &mInputBuffer);
-
-			if (ZSTD_isError(zstdError)) [[unlikely]]
-				return Util::ZSTD::ZSTDErrorToHRESULT(zstdError);
-
-			if (zstdError == 0)
-				mOperationFinished = true;
-
-			return S_OK;
+			return DecompressIntoOutputBuffer(outputBuffer);
 		}
 
 		ZSTDDecompressionOperation::DecompressionResults ZSTDDecompressionOperation::FinishDecompressionOperation()
@@ -88,19 +284,20 @@ namespace Brawler
 					.pos = 0
 				};
 
-				const std::size_t zstdError = ZSTD_decompressStream(mDecompressionContext.Get(), &outputBuffer, &mInputBuffer);
+				const HRESULT hr = DecompressIntoOutputBuffer(outputBuffer);
 
-				if (ZSTD_isError(zstdError)) [[unlikely]]
+				if (FAILED(hr)) [[unlikely]]
 					return DecompressionResults{
 						.DecompressedByteArr{},
-						.HResult = Util::ZSTD::ZSTDErrorToHRESULT(zstdError)
+						.HResult = hr
 					};
 
-				if (zstdError == 0)
-				{
-					mOperationFinished = true;
-					currBlock.shrink_to_fit();
-				}
+				// Only keep the bytes which were actually written. The last block is usually not
+				// entirely filled.
+				if (outputBuffer.pos == 0)
+					continue;
+
+				currBlock.resize(outputBuffer.pos);
 
 				numBytesDecompressed += currBlock.size();
 				dataBlockArr.push_back(std::move(currBlock));
@@ -143,5 +340,94 @@ namespace Brawler
 		{
 			return ZSTD_DStreamOutSize();
 		}
+
+		HRESULT ZSTDDecompressionOperation::DecompressData(const std::span<const std::byte> srcDataSpan, const std::span<std::byte> destDataSpan)
+		{
+			const std::optional<ZSTDSeekTable> seekTable{ ZSTDSeekTable::TryCreateSeekTable(srcDataSpan) };
+
+			if (!seekTable.has_value()) [[unlikely]]
+			{
+				// The data is a single monolithic frame, so it can only be decompressed sequentially.
+				ZSTDDecompressionOperation decompressionOperation{};
+				const HRESULT hr = decompressionOperation.BeginDecompressionOperation(srcDataSpan);
+
+				if (FAILED(hr)) [[unlikely]]
+					return hr;
+
+				return decompressionOperation.FinishDecompressionOperation(destDataSpan);
+			}
+
+			if (destDataSpan.size_bytes() < seekTable->GetUncompressedSize()) [[unlikely]]
+				return E_NOT_SUFFICIENT_BUFFER;
+
+			return DecompressSeekableDataRangeInParallel(*seekTable, 0, destDataSpan.first(seekTable->GetUncompressedSize()));
+		}
+
+		HRESULT ZSTDDecompressionOperation::DecompressDataRange(const std::span<const std::byte> srcDataSpan, const std::size_t uncompressedOffset, const std::span<std::byte> destDataSpan)
+		{
+			const std::optional<ZSTDSeekTable> seekTable{ ZSTDSeekTable::TryCreateSeekTable(srcDataSpan) };
+
+			if (!seekTable.has_value()) [[unlikely]]
+			{
+				// Without a seek table, we have no idea where the requested range begins within
+				// the compressed data, so we have to decompress all of it.
+				ZSTDDecompressionOperation decompressionOperation{};
+				const HRESULT hr = decompressionOperation.BeginDecompressionOperation(srcDataSpan);
+
+				if (FAILED(hr)) [[unlikely]]
+					return hr;
+
+				const DecompressionResults decompressionResults{ decompressionOperation.FinishDecompressionOperation() };
+
+				if (FAILED(decompressionResults.HResult)) [[unlikely]]
+					return decompressionResults.HResult;
+
+				if (uncompressedOffset > decompressionResults.DecompressedByteArr.size() || destDataSpan.size_bytes() > (decompressionResults.DecompressedByteArr.size() - uncompressedOffset)) [[unlikely]]
+					return E_INVALIDARG;
+
+				std::memcpy(destDataSpan.data(), decompressionResults.DecompressedByteArr.data() + uncompressedOffset, destDataSpan.size_bytes());
+				return S_OK;
+			}
+
+			if (uncompressedOffset > seekTable->GetUncompressedSize() || destDataSpan.size_bytes() > (seekTable->GetUncompressedSize() - uncompressedOffset)) [[unlikely]]
+				return E_INVALIDARG;
+
+			return DecompressSeekableDataRangeInParallel(*seekTable, uncompressedOffset, destDataSpan);
+		}
+
+		HRESULT ZSTDDecompressionOperation::DecompressIntoOutputBuffer(ZSTD_outBuffer& outputBuffer)
+		{
+			// ZSTD_decompressStream() returns zero whenever it finishes a frame, but the data may
+			// consist of multiple frames (e.g., the chunks of a seekable ZSTD stream). We are only
+			// done once all of the input has been consumed, too.
+			//
+			// We keep going even once the output buffer is full, since ZSTD may still need to
+			// consume frame epilogues or skippable frames without producing any more output.
+			while (!IsDecompressionComplete())
+			{
+				const std::size_t prevInputPos = mInputBuffer.pos;
+				const std::size_t prevOutputPos = outputBuffer.pos;
+
+				const std::size_t zstdError = ZSTD_decompressStream(mDecompressionContext.Get(), &outputBuffer, &mInputBuffer);
+
+				if (ZSTD_isError(zstdError)) [[unlikely]]
+					return Util::ZSTD::ZSTDErrorToHRESULT(zstdError);
+
+				if (zstdError == 0 && mInputBuffer.pos == mInputBuffer.size)
+					mOperationFinished = true;
+
+				else if (mInputBuffer.pos == prevInputPos && outputBuffer.pos == prevOutputPos)
+				{
+					// If ZSTD could make no progress at all, then either the output buffer is full
+					// or the input data was truncated.
+					if (outputBuffer.pos == outputBuffer.size)
+						break;
+
+					return E_INVALIDARG;
+				}
+			}
+
+			return S_OK;
+		}
 	}
 }
\ No newline at end of file
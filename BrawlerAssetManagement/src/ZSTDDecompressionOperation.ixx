@@ -39,6 +39,60 @@ export namespace Brawler
 
 			std::size_t GetZSTDBlockSize() const;
 
+			/// <summary>
+			/// Decompresses all of the data in srcDataSpan into destDataSpan.
+			/// 
+			/// If the data was compressed as a seekable ZSTD stream by the Brawler File Packer,
+			/// then its chunks are split across CPU jobs and decompressed in parallel. The calling
+			/// thread helps to execute these jobs, so this function can safely be called from
+			/// within a CPU job. Otherwise, the data is decompressed as a regular ZSTD stream on
+			/// the calling thread.
+			/// </summary>
+			/// <param name="srcDataSpan">
+			/// - The compressed data.
+			/// </param>
+			/// <param name="destDataSpan">
+			/// - The destination of the decompressed data. This must be large enough to hold all
+			///   of the decompressed data.
+			/// </param>
+			/// <returns>
+			/// The function returns S_OK if the data was decompressed successfully and an error
+			/// HRESULT otherwise.
+			/// </returns>
+			static HRESULT DecompressData(const std::span<const std::byte> srcDataSpan, const std::span<std::byte> destDataSpan);
+
+			/// <summary>
+			/// Decompresses destDataSpan.size_bytes() bytes of the data in srcDataSpan, starting at
+			/// uncompressedOffset bytes from the start of the decompressed data, into destDataSpan.
+			/// This is useful for, e.g., loading only some of the mip levels of a texture.
+			/// 
+			/// If the data was compressed as a seekable ZSTD stream by the Brawler File Packer,
+			/// then only the chunks which overlap the requested range are read and decompressed,
+			/// and this is done in parallel in the same manner as with
+			/// ZSTDDecompressionOperation::DecompressData(). Otherwise, all of the data must be
+			/// decompressed in order to extract the requested range.
+			/// </summary>
+			/// <param name="srcDataSpan">
+			/// - The compressed data.
+			/// </param>
+			/// <param name="uncompressedOffset">
+			/// - The offset, in bytes, from the start of the decompressed data at which the range
+			///   of data which is to be decompressed begins.
+			/// </param>
+			/// <param name="destDataSpan">
+			/// - The destination of the decompressed data. The size of this std::span determines
+			///   how many bytes are decompressed.
+			/// </param>
+			/// <returns>
+			/// The function returns S_OK if the data was decompressed successfully and an error
+			/// HRESULT otherwise. In particular, if the requested range extends past the end of
+			/// the decompressed data, then the function returns E_INVALIDARG.
+			/// </returns>
+			static HRESULT DecompressDataRange(const std::span<const std::byte> srcDataSpan, const std::size_t uncompressedOffset, const std::span<std::byte> destDataSpan);
+
+		private:
+			HRESULT DecompressIntoOutputBuffer(ZSTD_outBuffer& outputBuffer);
+
 		private:
 			ZSTDDecompressionContext mDecompressionContext;
 			std::span<const std::byte> mSrcDataSpan;
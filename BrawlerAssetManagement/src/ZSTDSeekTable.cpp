@@ -0,0 +1,143 @@
+module;
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <span>
+#include <optional>
+#include <limits>
+#include <cassert>
+#include <bit>
+#include <type_traits>
+#include <zstd.h>
+
+module Brawler.AssetManagement.ZSTDSeekTable;
+
+namespace
+{
+	// These values must match those used by the Brawler File Packer in ZSTDContext::CompressData(),
+	// which also documents the layout of the seek table.
+	static constexpr std::uint32_t SEEK_TABLE_SKIPPABLE_FRAME_MAGIC = (ZSTD_MAGIC_SKIPPABLE_START | 0xB);
+	static constexpr std::uint32_t SEEK_TABLE_MAGIC = 0x4B535A42;  // "BZSK"
+
+	static constexpr std::size_t SKIPPABLE_FRAME_HEADER_SIZE = (sizeof(std::uint32_t) * 2);
+	static constexpr std::size_t SEEK_TABLE_PAYLOAD_HEADER_SIZE = ((sizeof(std::uint32_t) * 2) + sizeof(std::uint64_t));
+
+	template <typename T>
+		requires std::is_integral_v<T>
+	T ReadLittleEndianValue(const std::span<const std::byte> byteSpan, const std::size_t readOffset)
+	{
+		static_assert(std::endian::native == std::endian::little, "ERROR: The seek table of compressed assets is read assuming a little-endian host!");
+		assert(readOffset + sizeof(T) <= byteSpan.size_bytes());
+
+		T value;
+		std::memcpy(&value, byteSpan.data() + readOffset, sizeof(T));
+
+		return value;
+	}
+}
+
+namespace Brawler
+{
+	namespace AssetManagement
+	{
+		std::optional<ZSTDSeekTable> ZSTDSeekTable::TryCreateSeekTable(const std::span<const std::byte> compressedDataSpan)
+		{
+			if (compressedDataSpan.size_bytes() < (SKIPPABLE_FRAME_HEADER_SIZE + SEEK_TABLE_PAYLOAD_HEADER_SIZE))
+				return std::optional<ZSTDSeekTable>{};
+
+			if (ReadLittleEndianValue<std::uint32_t>(compressedDataSpan, 0) != SEEK_TABLE_SKIPPABLE_FRAME_MAGIC)
+				return std::optional<ZSTDSeekTable>{};
+
+			const std::size_t payloadSize = ReadLittleEndianValue<std::uint32_t>(compressedDataSpan, sizeof(std::uint32_t));
+			const std::span<const std::byte> remainingDataSpan{ compressedDataSpan.subspan(SKIPPABLE_FRAME_HEADER_SIZE) };
+
+			if (payloadSize < SEEK_TABLE_PAYLOAD_HEADER_SIZE || payloadSize > remainingDataSpan.size_bytes()) [[unlikely]]
+				return std::optional<ZSTDSeekTable>{};
+
+			const std::span<const std::byte> payloadSpan{ remainingDataSpan.first(payloadSize) };
+
+			if (ReadLittleEndianValue<std::uint32_t>(payloadSpan, 0) != SEEK_TABLE_MAGIC) [[unlikely]]
+				return std::optional<ZSTDSeekTable>{};
+
+			ZSTDSeekTable seekTable{};
+			seekTable.mUncompressedChunkSize = ReadLittleEndianValue<std::uint32_t>(payloadSpan, sizeof(std::uint32_t));
+			
+			const std::uint64_t uncompressedSize = ReadLittleEndianValue<std::uint64_t>(payloadSpan, (sizeof(std::uint32_t) * 2));
+
+			if (seekTable.mUncompressedChunkSize == 0 || uncompressedSize > (std::numeric_limits<std::size_t>::max() - seekTable.mUncompressedChunkSize)) [[unlikely]]
+				return std::optional<ZSTDSeekTable>{};
+
+			seekTable.mUncompressedSize = static_cast<std::size_t>(uncompressedSize);
+
+			const std::uint64_t chunkCount = ((uncompressedSize + (seekTable.mUncompressedChunkSize - 1)) / seekTable.mUncompressedChunkSize);
+
+			if (chunkCount != ((payloadSize - SEEK_TABLE_PAYLOAD_HEADER_SIZE) / sizeof(std::uint64_t)) || ((payloadSize - SEEK_TABLE_PAYLOAD_HEADER_SIZE) % sizeof(std::uint64_t)) != 0) [[unlikely]]
+				return std::optional<ZSTDSeekTable>{};
+
+			seekTable.mChunkCount = static_cast<std::uint32_t>(chunkCount);
+			seekTable.mChunkEndOffsetByteSpan = payloadSpan.subspan(SEEK_TABLE_PAYLOAD_HEADER_SIZE);
+			seekTable.mChunkDataSpan = remainingDataSpan.subspan(payloadSize);
+
+			// Make sure that every chunk lies within the compressed data. That way, the rest of
+			// the ZSTDSeekTable never has to worry about corrupt offsets. There are only a few
+			// chunks per asset, so this is cheap.
+			std::uint64_t prevChunkEndOffset = 0;
+
+			for (std::uint32_t i = 0; i < seekTable.mChunkCount; ++i)
+			{
+				const std::uint64_t currChunkEndOffset = seekTable.GetChunkEndOffset(i);
+
+				if (currChunkEndOffset <= prevChunkEndOffset || currChunkEndOffset > seekTable.mChunkDataSpan.size_bytes()) [[unlikely]]
+					return std::optional<ZSTDSeekTable>{};
+
+				prevChunkEndOffset = currChunkEndOffset;
+			}
+
+			return std::optional<ZSTDSeekTable>{ std::move(seekTable) };
+		}
+
+		std::uint32_t ZSTDSeekTable::GetChunkCount() const
+		{
+			return mChunkCount;
+		}
+
+		std::size_t ZSTDSeekTable::GetUncompressedSize() const
+		{
+			return mUncompressedSize;
+		}
+
+		std::uint32_t ZSTDSeekTable::GetChunkIndexForUncompressedOffset(const std::size_t uncompressedOffset) const
+		{
+			assert(uncompressedOffset < mUncompressedSize && "ERROR: An out-of-bounds offset was provided to ZSTDSeekTable::GetChunkIndexForUncompressedOffset()!");
+			return static_cast<std::uint32_t>(uncompressedOffset / mUncompressedChunkSize);
+		}
+
+		std::size_t ZSTDSeekTable::GetUncompressedChunkOffset(const std::uint32_t chunkIndex) const
+		{
+			assert(chunkIndex < mChunkCount && "ERROR: An out-of-bounds chunk index was provided to ZSTDSeekTable::GetUncompressedChunkOffset()!");
+			return (static_cast<std::size_t>(chunkIndex) * mUncompressedChunkSize);
+		}
+
+		std::size_t ZSTDSeekTable::GetUncompressedChunkSize(const std::uint32_t chunkIndex) const
+		{
+			// Every chunk except for the last one contains exactly mUncompressedChunkSize bytes.
+			const std::size_t chunkOffset = GetUncompressedChunkOffset(chunkIndex);
+			return std::min<std::size_t>(mUncompressedChunkSize, (mUncompressedSize - chunkOffset));
+		}
+
+		std::span<const std::byte> ZSTDSeekTable::GetCompressedChunkSpan(const std::uint32_t chunkIndex) const
+		{
+			assert(chunkIndex < mChunkCount && "ERROR: An out-of-bounds chunk index was provided to ZSTDSeekTable::GetCompressedChunkSpan()!");
+
+			const std::size_t chunkBeginOffset = (chunkIndex == 0 ? 0 : static_cast<std::size_t>(GetChunkEndOffset(chunkIndex - 1)));
+			const std::size_t chunkEndOffset = static_cast<std::size_t>(GetChunkEndOffset(chunkIndex));
+
+			return mChunkDataSpan.subspan(chunkBeginOffset, (chunkEndOffset - chunkBeginOffset));
+		}
+
+		std::uint64_t ZSTDSeekTable::GetChunkEndOffset(const std::uint32_t chunkIndex) const
+		{
+			return ReadLittleEndianValue<std::uint64_t>(mChunkEndOffsetByteSpan, (static_cast<std::size_t>(chunkIndex) * sizeof(std::uint64_t)));
+		}
+	}
+}
\ No newline at end of file
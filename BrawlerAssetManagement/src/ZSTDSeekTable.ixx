@@ -0,0 +1,82 @@
+module;
+#include <cstdint>
+#include <span>
+#include <optional>
+
+export module Brawler.AssetManagement.ZSTDSeekTable;
+
+export namespace Brawler
+{
+	namespace AssetManagement
+	{
+		/// <summary>
+		/// The Brawler File Packer compresses assets into a seekable ZSTD stream: the data is
+		/// split into fixed-size chunks, each of which is compressed into an independent frame,
+		/// and a seek table describing where each frame ends is placed in a skippable frame in
+		/// front of them. A ZSTDSeekTable parses this table from the compressed data of an
+		/// asset, so that its chunks can be decompressed in parallel or individually.
+		/// 
+		/// A ZSTDSeekTable does not own the compressed data. It refers directly to the
+		/// std::span which it was created from, so that std::span must outlive it.
+		/// </summary>
+		class ZSTDSeekTable
+		{
+		private:
+			ZSTDSeekTable() = default;
+
+		public:
+			ZSTDSeekTable(const ZSTDSeekTable& rhs) = default;
+			ZSTDSeekTable& operator=(const ZSTDSeekTable& rhs) = default;
+
+			ZSTDSeekTable(ZSTDSeekTable&& rhs) noexcept = default;
+			ZSTDSeekTable& operator=(ZSTDSeekTable&& rhs) noexcept = default;
+
+			/// <summary>
+			/// Attempts to parse the seek table at the start of compressedDataSpan.
+			/// </summary>
+			/// <param name="compressedDataSpan">
+			/// - The compressed data of an asset.
+			/// </param>
+			/// <returns>
+			/// If compressedDataSpan begins with a valid seek table, then the function returns a
+			/// ZSTDSeekTable describing it. Otherwise, the data was either written by an older
+			/// version of the Brawler File Packer as a single monolithic frame, or it is corrupt;
+			/// in either case, the function returns an empty std::optional instance, and the data
+			/// has to be decompressed as a regular ZSTD stream.
+			/// </returns>
+			static std::optional<ZSTDSeekTable> TryCreateSeekTable(const std::span<const std::byte> compressedDataSpan);
+
+			std::uint32_t GetChunkCount() const;
+			std::size_t GetUncompressedSize() const;
+
+			/// <summary>
+			/// Returns the index of the chunk which contains the byte at uncompressedOffset in
+			/// the uncompressed data.
+			/// </summary>
+			std::uint32_t GetChunkIndexForUncompressedOffset(const std::size_t uncompressedOffset) const;
+
+			std::size_t GetUncompressedChunkOffset(const std::uint32_t chunkIndex) const;
+			std::size_t GetUncompressedChunkSize(const std::uint32_t chunkIndex) const;
+
+			/// <summary>
+			/// Returns the independent ZSTD frame which contains the compressed data of the
+			/// specified chunk.
+			/// </summary>
+			std::span<const std::byte> GetCompressedChunkSpan(const std::uint32_t chunkIndex) const;
+
+		private:
+			std::uint64_t GetChunkEndOffset(const std::uint32_t chunkIndex) const;
+
+		private:
+			std::span<const std::byte> mChunkDataSpan;
+
+			// The chunk end offsets are generally not aligned within the compressed data, so
+			// we keep them as raw bytes and read them with std::memcpy().
+			std::span<const std::byte> mChunkEndOffsetByteSpan;
+
+			std::size_t mUncompressedSize;
+			std::uint32_t mUncompressedChunkSize;
+			std::uint32_t mChunkCount;
+		};
+	}
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+module;
+#include <cstdint>
+#include <cassert>
+#include <vector>
+#include <span>
+#include <mutex>
+#include <unordered_map>
+#include <filesystem>
+#include <fstream>
+#include <array>
+#include <stdexcept>
+#include <algorithm>
+
+module Brawler.D3D12.AllocatorTrace;
+
+namespace
+{
+	// Trace files begin with this magic number, the version of the file format, the size of the
+	// heap, and the number of events. Each event follows as a packed 25-byte record.
+	static constexpr std::array<char, 4> TRACE_FILE_MAGIC{ 'B', 'A', 'T', 'R' };
+	static constexpr std::uint32_t TRACE_FILE_VERSION = 1;
+
+	template <typename T>
+	void WriteValue(std::ofstream& traceFileStream, const T value)
+	{
+		traceFileStream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	template <typename T>
+	T ReadValue(std::ifstream& traceFileStream)
+	{
+		T value{};
+		traceFileStream.read(reinterpret_cast<char*>(&value), sizeof(value));
+
+		if (!traceFileStream) [[unlikely]]
+			throw std::runtime_error{ "ERROR: An allocator trace file ended unexpectedly!" };
+
+		return value;
+	}
+}
+
+namespace Brawler
+{
+	namespace D3D12
+	{
+		AllocatorTrace::AllocatorTrace(const std::size_t heapSizeInBytes) :
+			mEventArr(),
+			mHeapSizeInBytes(heapSizeInBytes)
+		{}
+
+		void AllocatorTrace::AddEvent(const AllocatorTraceEvent& traceEvent)
+		{
+			mEventArr.push_back(traceEvent);
+		}
+
+		std::span<const AllocatorTraceEvent> AllocatorTrace::GetEvents() const
+		{
+			return std::span<const AllocatorTraceEvent>{ mEventArr };
+		}
+
+		std::size_t AllocatorTrace::GetHeapSize() const
+		{
+			return mHeapSizeInBytes;
+		}
+
+		void AllocatorTrace::SerializeToFile(const std::filesystem::path& traceFilePath) const
+		{
+			std::ofstream traceFileStream{ traceFilePath, std::ios::out | std::ios::binary | std::ios::trunc };
+
+			traceFileStream.write(TRACE_FILE_MAGIC.data(), TRACE_FILE_MAGIC.size());
+			WriteValue(traceFileStream, TRACE_FILE_VERSION);
+			WriteValue(traceFileStream, static_cast<std::uint64_t>(mHeapSizeInBytes));
+			WriteValue(traceFileStream, static_cast<std::uint64_t>(mEventArr.size()));
+
+			for (const auto& traceEvent : mEventArr)
+			{
+				WriteValue(traceFileStream, traceEvent.AllocationID);
+				WriteValue(traceFileStream, traceEvent.SizeInBytes);
+				WriteValue(traceFileStream, traceEvent.Alignment);
+				WriteValue(traceFileStream, static_cast<std::uint8_t>(traceEvent.Type));
+			}
+		}
+
+		AllocatorTrace AllocatorTrace::DeserializeFromFile(const std::filesystem::path& traceFilePath)
+		{
+			std::ifstream traceFileStream{ traceFilePath, std::ios::in | std::ios::binary };
+
+			if (!traceFileStream.is_open()) [[unlikely]]
+				throw std::runtime_error{ "ERROR: An allocator trace file could not be opened!" };
+
+			if (ReadValue<std::array<char, 4>>(traceFileStream) != TRACE_FILE_MAGIC || ReadValue<std::uint32_t>(traceFileStream) != TRACE_FILE_VERSION) [[unlikely]]
+				throw std::runtime_error{ "ERROR: A file which was not a valid allocator trace file was specified!" };
+
+			AllocatorTrace trace{ static_cast<std::size_t>(ReadValue<std::uint64_t>(traceFileStream)) };
+			const std::uint64_t eventCount = ReadValue<std::uint64_t>(traceFileStream);
+
+			// Don't trust eventCount too much when reserving memory; a corrupted file would
+			// otherwise have us allocate an absurd amount of it.
+			trace.mEventArr.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(eventCount, 1 << 20)));
+
+			for (std::uint64_t i = 0; i < eventCount; ++i)
+			{
+				AllocatorTraceEvent traceEvent{};
+				traceEvent.AllocationID = ReadValue<std::uint64_t>(traceFileStream);
+				traceEvent.SizeInBytes = ReadValue<std::uint64_t>(traceFileStream);
+				traceEvent.Alignment = ReadValue<std::uint64_t>(traceFileStream);
+
+				const std::uint8_t eventType = ReadValue<std::uint8_t>(traceFileStream);
+
+				if (eventType > static_cast<std::uint8_t>(AllocatorTraceEventType::DELETION)) [[unlikely]]
+					throw std::runtime_error{ "ERROR: An allocator trace file contained an event of an unknown type!" };
+
+				traceEvent.Type = static_cast<AllocatorTraceEventType>(eventType);
+				trace.mEventArr.push_back(traceEvent);
+			}
+
+			return trace;
+		}
+
+		AllocatorTraceRecorder::AllocatorTraceRecorder(const std::size_t heapSizeInBytes) :
+			mTrace(heapSizeInBytes),
+			mLiveAllocationIDMap(),
+			mNextAllocationID(0),
+			mHeapSizeInBytes(heapSizeInBytes),
+			mCritSection()
+		{}
+
+		void AllocatorTraceRecorder::RecordAllocation(const void* const allocationKey, const TLSFAllocationRequestInfo& requestInfo)
+		{
+			std::scoped_lock<std::mutex> lock{ mCritSection };
+
+			const std::uint64_t allocationID = mNextAllocationID++;
+
+			[[maybe_unused]] const bool wasInserted = mLiveAllocationIDMap.try_emplace(allocationKey, allocationID).second;
+			assert(wasInserted && "ERROR: The same allocation key was recorded for two live allocations in an AllocatorTraceRecorder!");
+
+			mTrace.AddEvent(AllocatorTraceEvent{
+				.AllocationID = allocationID,
+				.SizeInBytes = requestInfo.SizeInBytes,
+				.Alignment = requestInfo.Alignment,
+				.Type = AllocatorTraceEventType::ALLOCATION
+			});
+		}
+
+		void AllocatorTraceRecorder::RecordFailedAllocation(const TLSFAllocationRequestInfo& requestInfo)
+		{
+			std::scoped_lock<std::mutex> lock{ mCritSection };
+
+			mTrace.AddEvent(AllocatorTraceEvent{
+				.AllocationID = 0,
+				.SizeInBytes = requestInfo.SizeInBytes,
+				.Alignment = requestInfo.Alignment,
+				.Type = AllocatorTraceEventType::FAILED_ALLOCATION
+			});
+		}
+
+		void AllocatorTraceRecorder::RecordDeletion(const void* const allocationKey)
+		{
+			std::scoped_lock<std::mutex> lock{ mCritSection };
+
+			const auto itr = mLiveAllocationIDMap.find(allocationKey);
+			assert(itr != mLiveAllocationIDMap.end() && "ERROR: An AllocatorTraceRecorder was told about the deletion of an allocation which it never recorded!");
+
+			mTrace.AddEvent(AllocatorTraceEvent{
+				.AllocationID = itr->second,
+				.SizeInBytes = 0,
+				.Alignment = 0,
+				.Type = AllocatorTraceEventType::DELETION
+			});
+
+			mLiveAllocationIDMap.erase(itr);
+		}
+
+		AllocatorTrace AllocatorTraceRecorder::ExtractTrace()
+		{
+			std::scoped_lock<std::mutex> lock{ mCritSection };
+
+			AllocatorTrace extractedTrace{ std::move(mTrace) };
+			mTrace = AllocatorTrace{ mHeapSizeInBytes };
+
+			return extractedTrace;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+module;
+#include <cstdint>
+#include <vector>
+#include <span>
+#include <mutex>
+#include <unordered_map>
+#include <filesystem>
+
+export module Brawler.D3D12.AllocatorTrace;
+import Brawler.D3D12.TLSFAllocationRequestInfo;
+
+export namespace Brawler
+{
+	namespace D3D12
+	{
+		enum class AllocatorTraceEventType : std::uint8_t
+		{
+			/// <summary>
+			/// An allocation was made. Its AllocationID is unique within the trace, and it is
+			/// used by the DELETION event which frees the allocation.
+			/// </summary>
+			ALLOCATION,
+
+			/// <summary>
+			/// An allocation request could not be satisfied. The AllocationID is unused.
+			/// </summary>
+			FAILED_ALLOCATION,
+
+			/// <summary>
+			/// The allocation with the specified AllocationID was deleted. The SizeInBytes and
+			/// Alignment are unused.
+			/// </summary>
+			DELETION
+		};
+
+		struct AllocatorTraceEvent
+		{
+			std::uint64_t AllocationID;
+			std::uint64_t SizeInBytes;
+			std::uint64_t Alignment;
+			AllocatorTraceEventType Type;
+		};
+
+		// An AllocatorTrace is the sequence of allocation requests and deletions which were made
+		// with an allocator, independent of where the allocations were placed. Recording the traces
+		// of real workloads and replaying them against different allocator configurations offline
+		// (see Tests::ReplayAllocatorTrace()) is the easiest way to decide how to size a heap and
+		// which configuration to use for it.
+
+		class AllocatorTrace
+		{
+		public:
+			AllocatorTrace() = default;
+			explicit AllocatorTrace(const std::size_t heapSizeInBytes);
+
+			AllocatorTrace(const AllocatorTrace& rhs) = default;
+			AllocatorTrace& operator=(const AllocatorTrace& rhs) = default;
+
+			AllocatorTrace(AllocatorTrace&& rhs) noexcept = default;
+			AllocatorTrace& operator=(AllocatorTrace&& rhs) noexcept = default;
+
+			void AddEvent(const AllocatorTraceEvent& traceEvent);
+
+			std::span<const AllocatorTraceEvent> GetEvents() const;
+
+			/// <summary>
+			/// Gets the size, in bytes, of the heap which the trace was recorded from.
+			/// </summary>
+			std::size_t GetHeapSize() const;
+
+			/// <summary>
+			/// Writes the trace to the specified file in a compact binary format. If the file
+			/// already exists, then it is overwritten.
+			/// </summary>
+			void SerializeToFile(const std::filesystem::path& traceFilePath) const;
+
+			/// <summary>
+			/// Reads a trace which was written by AllocatorTrace::SerializeToFile(). If the file
+			/// cannot be read or is not a valid trace file, then a std::runtime_error is thrown.
+			/// </summary>
+			static AllocatorTrace DeserializeFromFile(const std::filesystem::path& traceFilePath);
+
+		private:
+			std::vector<AllocatorTraceEvent> mEventArr;
+			std::size_t mHeapSizeInBytes = 0;
+		};
+
+		class AllocatorTraceRecorder
+		{
+		public:
+			explicit AllocatorTraceRecorder(const std::size_t heapSizeInBytes);
+
+			AllocatorTraceRecorder(const AllocatorTraceRecorder& rhs) = delete;
+			AllocatorTraceRecorder& operator=(const AllocatorTraceRecorder& rhs) = delete;
+
+			AllocatorTraceRecorder(AllocatorTraceRecorder&& rhs) noexcept = delete;
+			AllocatorTraceRecorder& operator=(AllocatorTraceRecorder&& rhs) noexcept = delete;
+
+			/// <summary>
+			/// Records an allocation. The allocator identifies the allocation by allocationKey
+			/// (e.g., the address of its TLSFMemoryBlock), which must be unique among the live
+			/// allocations.
+			/// </summary>
+			void RecordAllocation(const void* const allocationKey, const TLSFAllocationRequestInfo& requestInfo);
+
+			void RecordFailedAllocation(const TLSFAllocationRequestInfo& requestInfo);
+
+			/// <summary>
+			/// Records the deletion of the allocation identified by allocationKey. This must be
+			/// called *before* the allocation is actually deleted; otherwise, another thread might
+			/// be handed the same allocationKey and record its allocation first.
+			/// </summary>
+			void RecordDeletion(const void* const allocationKey);
+
+			/// <summary>
+			/// Returns every event which has been recorded since the last call to this function.
+			/// Allocations which are still alive keep their IDs, so a later trace can still refer
+			/// to them.
+			/// </summary>
+			AllocatorTrace ExtractTrace();
+
+		private:
+			AllocatorTrace mTrace;
+			std::unordered_map<const void*, std::uint64_t> mLiveAllocationIDMap;
+			std::uint64_t mNextAllocationID;
+			const std::size_t mHeapSizeInBytes;
+			mutable std::mutex mCritSection;
+		};
+	}
+}
\ No newline at end of file
@@ -0,0 +1,295 @@
+module;
+#include <cstdint>
+#include <cassert>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <filesystem>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <tuple>
+#include <span>
+#include <utility>
+
+module Tests.AllocatorTraceReplay;
+import Brawler.D3D12.AllocatorTrace;
+import Brawler.D3D12.TLSFAllocator;
+import Brawler.D3D12.TLSFMemoryBlock;
+import Brawler.D3D12.TLSFAllocationRequestInfo;
+import Brawler.OptionalRef;
+import Brawler.Timer;
+
+namespace
+{
+	constexpr std::array<std::uint32_t, 5> SLI_ARR{ 1, 2, 3, 4, 5 };
+	constexpr std::array<Brawler::D3D12::TLSFThreadCacheMode, 2> THREAD_CACHE_MODE_ARR{
+		Brawler::D3D12::TLSFThreadCacheMode::DISABLED,
+		Brawler::D3D12::TLSFThreadCacheMode::ENABLED
+	};
+
+	// The heap size of each replay is this percentage of the heap size of the recorded trace.
+	constexpr std::array<std::uint32_t, 3> HEAP_SIZE_PERCENTAGE_ARR{ 100, 75, 50 };
+
+	// TLSFAllocator::GetStatistics() walks the free lists, so we only sample the statistics
+	// once every this many events.
+	constexpr std::size_t STATISTICS_SAMPLE_INTERVAL = 256;
+
+	struct ReplayConfiguration
+	{
+		std::size_t HeapSizeInBytes;
+		std::uint32_t HeapSizePercentage;
+		std::uint32_t SLI;
+		Brawler::D3D12::TLSFThreadCacheMode ThreadCacheMode;
+	};
+
+	struct ReplayResult
+	{
+		ReplayConfiguration Configuration;
+		std::uint64_t FailedAllocationCount;
+		float PeakExternalFragmentationRatio;
+		float MeanExternalFragmentationRatio;
+
+		// This includes the memory held by the thread caches, since it is not available to
+		// anything else, either.
+		std::size_t PeakUsedBytes;
+
+		std::uint64_t TotalAlignmentPaddingBytes;
+		float NanosecondsPerEvent;
+	};
+
+	class TraceReplayer
+	{
+	public:
+		explicit TraceReplayer(const ReplayConfiguration& configuration) :
+			mAllocator(),
+			mLiveBlockMap()
+		{
+			mAllocator.Initialize(Brawler::D3D12::TLSFAllocatorInitializationInfo{
+				.HeapSizeInBytes = configuration.HeapSizeInBytes,
+				.ThreadCacheMode = configuration.ThreadCacheMode,
+				.SLI = configuration.SLI
+			});
+		}
+
+		void ReplayEvent(const Brawler::D3D12::AllocatorTraceEvent& traceEvent)
+		{
+			switch (traceEvent.Type)
+			{
+			case Brawler::D3D12::AllocatorTraceEventType::ALLOCATION:
+			{
+				Brawler::OptionalRef<Brawler::D3D12::TLSFMemoryBlock> allocatedBlock{ mAllocator.CreateAllocation(CreateRequestInfo(traceEvent)) };
+
+				if (allocatedBlock.HasValue())
+					mLiveBlockMap.try_emplace(traceEvent.AllocationID, &(*allocatedBlock));
+
+				break;
+			}
+
+			case Brawler::D3D12::AllocatorTraceEventType::FAILED_ALLOCATION:
+			{
+				// The allocation failed when the trace was recorded, so whoever requested it never
+				// used it. If this configuration manages to make the allocation, then we can free it
+				// right away.
+				Brawler::OptionalRef<Brawler::D3D12::TLSFMemoryBlock> allocatedBlock{ mAllocator.CreateAllocation(CreateRequestInfo(traceEvent)) };
+
+				if (allocatedBlock.HasValue())
+					mAllocator.DeleteAllocation(*allocatedBlock);
+
+				break;
+			}
+
+			case Brawler::D3D12::AllocatorTraceEventType::DELETION:
+			{
+				// If the allocation failed during the replay, or if it was made before the trace was
+				// extracted from the recording allocator, then there is nothing to delete.
+				const auto itr = mLiveBlockMap.find(traceEvent.AllocationID);
+
+				if (itr != mLiveBlockMap.end())
+				{
+					mAllocator.DeleteAllocation(*(itr->second));
+					mLiveBlockMap.erase(itr);
+				}
+
+				break;
+			}
+
+			default:
+			{
+				assert(false);
+				std::unreachable();
+			}
+			}
+		}
+
+		void DeleteRemainingAllocations()
+		{
+			for (const auto& [allocationID, blockPtr] : mLiveBlockMap)
+				mAllocator.DeleteAllocation(*blockPtr);
+
+			mLiveBlockMap.clear();
+			mAllocator.FlushThreadCaches();
+		}
+
+		Brawler::D3D12::TLSFAllocator::Statistics GetStatistics() const
+		{
+			return mAllocator.GetStatistics();
+		}
+
+	private:
+		static Brawler::D3D12::TLSFAllocationRequestInfo CreateRequestInfo(const Brawler::D3D12::AllocatorTraceEvent& traceEvent)
+		{
+			return Brawler::D3D12::TLSFAllocationRequestInfo{
+				.SizeInBytes = static_cast<std::size_t>(traceEvent.SizeInBytes),
+				.Alignment = static_cast<std::size_t>(traceEvent.Alignment)
+			};
+		}
+
+	private:
+		Brawler::D3D12::TLSFAllocator mAllocator;
+		std::unordered_map<std::uint64_t, Brawler::D3D12::TLSFMemoryBlock*> mLiveBlockMap;
+	};
+
+	ReplayResult ReplayTrace(const Brawler::D3D12::AllocatorTrace& trace, const ReplayConfiguration& configuration)
+	{
+		ReplayResult result{
+			.Configuration{ configuration },
+			.FailedAllocationCount = 0,
+			.PeakExternalFragmentationRatio = 0.0f,
+			.MeanExternalFragmentationRatio = 0.0f,
+			.PeakUsedBytes = 0,
+			.TotalAlignmentPaddingBytes = 0,
+			.NanosecondsPerEvent = 0.0f
+		};
+
+		const std::span<const Brawler::D3D12::AllocatorTraceEvent> traceEventSpan{ trace.GetEvents() };
+
+		// The trace is replayed twice: once without any sampling, so that we only time the
+		// TLSFAllocator, and once more to collect the statistics.
+		{
+			TraceReplayer timedReplayer{ configuration };
+
+			Brawler::Timer t{};
+			t.Start();
+
+			for (const auto& traceEvent : traceEventSpan)
+				timedReplayer.ReplayEvent(traceEvent);
+
+			t.Stop();
+
+			if (!traceEventSpan.empty())
+				result.NanosecondsPerEvent = ((t.GetElapsedTimeInMilliseconds() * 1000000.0f) / static_cast<float>(traceEventSpan.size()));
+
+			timedReplayer.DeleteRemainingAllocations();
+		}
+
+		TraceReplayer sampledReplayer{ configuration };
+
+		double fragmentationRatioSum = 0.0;
+		std::size_t sampleCount = 0;
+
+		const auto sampleStatisticsLambda = [&] ()
+		{
+			const Brawler::D3D12::TLSFAllocator::Statistics statistics{ sampledReplayer.GetStatistics() };
+
+			result.PeakExternalFragmentationRatio = std::max(result.PeakExternalFragmentationRatio, statistics.ExternalFragmentationRatio);
+			result.PeakUsedBytes = std::max(result.PeakUsedBytes, (statistics.AllocatedBytes + statistics.ThreadCachedBytes));
+
+			fragmentationRatioSum += statistics.ExternalFragmentationRatio;
+			++sampleCount;
+
+			return statistics;
+		};
+
+		for (std::size_t i = 0; i < traceEventSpan.size(); ++i)
+		{
+			sampledReplayer.ReplayEvent(traceEventSpan[i]);
+
+			if ((i % STATISTICS_SAMPLE_INTERVAL) == (STATISTICS_SAMPLE_INTERVAL - 1))
+				sampleStatisticsLambda();
+		}
+
+		const Brawler::D3D12::TLSFAllocator::Statistics finalStatistics{ sampleStatisticsLambda() };
+
+		result.MeanExternalFragmentationRatio = static_cast<float>(fragmentationRatioSum / static_cast<double>(sampleCount));
+		result.TotalAlignmentPaddingBytes = finalStatistics.TotalAlignmentPaddingBytes;
+		result.FailedAllocationCount = finalStatistics.FailedAllocationCount;
+
+		sampledReplayer.DeleteRemainingAllocations();
+
+		return result;
+	}
+
+	void PrintReplayResult(const ReplayResult& result)
+	{
+		std::cout << std::setw(5) << result.Configuration.HeapSizePercentage << "% | SLI " << result.Configuration.SLI
+			<< " | Thread Caches " << (result.Configuration.ThreadCacheMode == Brawler::D3D12::TLSFThreadCacheMode::ENABLED ? "On " : "Off")
+			<< " | Failed Allocations: " << result.FailedAllocationCount
+			<< " | Fragmentation (Peak/Mean): " << std::fixed << std::setprecision(3) << result.PeakExternalFragmentationRatio << '/' << result.MeanExternalFragmentationRatio
+			<< " | Peak Usage: " << (result.PeakUsedBytes / 1024) << " KB"
+			<< " | Alignment Padding: " << (result.TotalAlignmentPaddingBytes / 1024) << " KB"
+			<< " | " << std::setprecision(1) << result.NanosecondsPerEvent << " ns per event" << std::defaultfloat << std::endl;
+	}
+}
+
+namespace Tests
+{
+	void ReplayAllocatorTrace(const Brawler::D3D12::AllocatorTrace& trace)
+	{
+		std::cout << "Replaying an allocator trace with " << trace.GetEvents().size() << " events, recorded from a heap of " << (trace.GetHeapSize() / 1024) << " KB..." << std::endl;
+
+		std::vector<ReplayResult> resultArr{};
+		resultArr.reserve(HEAP_SIZE_PERCENTAGE_ARR.size() * SLI_ARR.size() * THREAD_CACHE_MODE_ARR.size());
+
+		for (const auto heapSizePercentage : HEAP_SIZE_PERCENTAGE_ARR)
+		{
+			for (const auto sli : SLI_ARR)
+			{
+				for (const auto threadCacheMode : THREAD_CACHE_MODE_ARR)
+				{
+					resultArr.push_back(ReplayTrace(trace, ReplayConfiguration{
+						.HeapSizeInBytes = ((trace.GetHeapSize() / 100) * heapSizePercentage),
+						.HeapSizePercentage = heapSizePercentage,
+						.SLI = sli,
+						.ThreadCacheMode = threadCacheMode
+					}));
+
+					PrintReplayResult(resultArr.back());
+				}
+			}
+		}
+
+		// The best configuration is the one which fails the fewest allocations at the recorded
+		// heap size. Ties are broken by the mean fragmentation, and then by the speed.
+		const auto bestResultItr = std::ranges::min_element(resultArr, [] (const ReplayResult& lhs, const ReplayResult& rhs)
+		{
+			const auto createSortKeyLambda = [] (const ReplayResult& result)
+			{
+				return std::make_tuple((result.Configuration.HeapSizePercentage != 100), result.FailedAllocationCount, result.MeanExternalFragmentationRatio, result.NanosecondsPerEvent);
+			};
+
+			return (createSortKeyLambda(lhs) < createSortKeyLambda(rhs));
+		});
+
+		std::cout << "Best Configuration: ";
+		PrintReplayResult(*bestResultItr);
+
+		const auto smallestSufficientHeapItr = std::ranges::min_element(resultArr, [] (const ReplayResult& lhs, const ReplayResult& rhs)
+		{
+			return (std::make_tuple((lhs.FailedAllocationCount != 0), lhs.Configuration.HeapSizeInBytes, lhs.MeanExternalFragmentationRatio) < std::make_tuple((rhs.FailedAllocationCount != 0), rhs.Configuration.HeapSizeInBytes, rhs.MeanExternalFragmentationRatio));
+		});
+
+		if (smallestSufficientHeapItr->FailedAllocationCount == 0)
+		{
+			std::cout << "Smallest Heap Without Failed Allocations: ";
+			PrintReplayResult(*smallestSufficientHeapItr);
+		}
+		else
+			std::cout << "Every tested configuration failed at least one allocation. The heap should be larger than it was when the trace was recorded." << std::endl;
+	}
+
+	void ReplayAllocatorTrace(const std::filesystem::path& traceFilePath)
+	{
+		ReplayAllocatorTrace(Brawler::D3D12::AllocatorTrace::DeserializeFromFile(traceFilePath));
+	}
+}
\ No newline at end of file
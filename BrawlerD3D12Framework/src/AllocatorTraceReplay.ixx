@@ -0,0 +1,32 @@
+module;
+#include <filesystem>
+
+export module Tests.AllocatorTraceReplay;
+import Brawler.D3D12.AllocatorTrace;
+
+export namespace Tests
+{
+	/// <summary>
+	/// Replays a recorded Brawler::D3D12::AllocatorTrace against TLSFAllocators with every SLI
+	/// from 1 to 5, both with and without thread caches, and with heaps of 100%, 75% and 50%
+	/// of the size of the heap which the trace was recorded from. For each configuration, the
+	/// number of failed allocations, the peak and mean external fragmentation, the peak memory
+	/// usage, the alignment padding and the time per event are written to std::cout, followed by
+	/// the configuration which handled the trace best and the smallest heap size which never
+	/// failed an allocation.
+	/// 
+	/// Traces are recorded by initializing a TLSFAllocator with
+	/// TLSFAllocatorInitializationInfo::EnableTraceRecording set to true and writing the result of
+	/// TLSFAllocator::ExtractTrace() to a file with AllocatorTrace::SerializeToFile().
+	/// 
+	/// Since the thread caches are indexed by thread, this must be called from the main thread
+	/// after the WorkerThreadPool has been initialized.
+	/// </summary>
+	void ReplayAllocatorTrace(const Brawler::D3D12::AllocatorTrace& trace);
+
+	/// <summary>
+	/// Reads the AllocatorTrace stored at traceFilePath and replays it. See the other overload
+	/// of Tests::ReplayAllocatorTrace() for the details.
+	/// </summary>
+	void ReplayAllocatorTrace(const std::filesystem::path& traceFilePath);
+}
\ No newline at end of file
@@ -0,0 +1,390 @@
+module;
+#include <cstdint>
+#include <atomic>
+#include <array>
+#include <optional>
+#include <bit>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+
+export module Brawler.AtomicBitmapIndexAllocator;
+
+namespace Brawler
+{
+	static constexpr std::uint32_t BITS_PER_BITMAP_WORD = std::numeric_limits<std::uint64_t>::digits;
+	static constexpr std::uint64_t FULL_BITMAP_WORD = std::numeric_limits<std::uint64_t>::max();
+}
+
+export namespace Brawler
+{
+	// The AtomicBitmapIndexAllocator hands out indices in the range [0, IndexCount) without ever
+	// taking a lock. Every index is a single bit in an array of std::atomic<std::uint64_t>s,
+	// which is set while the index is allocated. Allocating an index is a fetch_or() on the word
+	// which contains it, and freeing it is a fetch_and(), so threads only ever contend with each
+	// other if they touch the same 64 indices at the same time.
+	//
+	// On top of that, there is a summary level in which every bit describes one of these words.
+	// A summary bit is set when a search finds its word full, so later searches can skip over
+	// 4,096 allocated indices at a time. Filling up a word does not set its summary bit, and
+	// freeing an index only has to touch the summary if the bit was actually set. Otherwise,
+	// allocating and freeing an index at the edge of the allocated region would flip a summary
+	// bit every time. A summary bit may thus be clear even though its word is full (the search
+	// then just marks it and moves on), but it is never left set while its word has a free
+	// index, so no index is ever lost.
+	//
+	// Allocations first try the word in which an index was most recently freed, and only then
+	// search for the lowest free index. Textures are streamed in and out all the time, so this
+	// usually hands out an index from a word which is already in the cache without searching
+	// at all, and it keeps the search from repeatedly marking and unmarking the words at the
+	// edge of the allocated region.
+	//
+	// Since a cleared bit means a free index, a default-constructed AtomicBitmapIndexAllocator is
+	// ready to use right away; unlike a free list, it does not need to be filled with every index
+	// at start-up.
+
+	template <std::uint32_t IndexCount>
+		requires (IndexCount > 0)
+	class AtomicBitmapIndexAllocator
+	{
+	private:
+		static constexpr std::uint32_t WORD_COUNT = ((IndexCount + (BITS_PER_BITMAP_WORD - 1)) / BITS_PER_BITMAP_WORD);
+		static constexpr std::uint32_t SUMMARY_WORD_COUNT = ((WORD_COUNT + (BITS_PER_BITMAP_WORD - 1)) / BITS_PER_BITMAP_WORD);
+
+	public:
+		AtomicBitmapIndexAllocator();
+
+		AtomicBitmapIndexAllocator(const AtomicBitmapIndexAllocator& rhs) = delete;
+		AtomicBitmapIndexAllocator& operator=(const AtomicBitmapIndexAllocator& rhs) = delete;
+
+		AtomicBitmapIndexAllocator(AtomicBitmapIndexAllocator&& rhs) noexcept = delete;
+		AtomicBitmapIndexAllocator& operator=(AtomicBitmapIndexAllocator&& rhs) noexcept = delete;
+
+		/// <summary>
+		/// Allocates a free index. Indices close to the one which was most recently freed are
+		/// preferred; otherwise, this is the lowest free index which can be found. This is
+		/// lock-free.
+		/// </summary>
+		/// <returns>
+		/// If there is a free index, then the function returns that index. Otherwise, the
+		/// returned std::optional instance has no value.
+		/// </returns>
+		std::optional<std::uint32_t> Allocate();
+
+		/// <summary>
+		/// Allocates indexCount consecutive indices, such as for a descriptor table. This is
+		/// lock-free, but it is a lot more expensive than AtomicBitmapIndexAllocator::Allocate().
+		///
+		/// A range of at most 64 indices is always placed within a single aligned group of 64
+		/// indices. Larger ranges begin at a multiple of 64 and are only placed in groups which
+		/// are entirely free.
+		/// </summary>
+		/// <param name="indexCount">
+		/// - The number of indices to allocate. This must not be zero.
+		/// </param>
+		/// <returns>
+		/// If the range could be allocated, then the function returns the first index of the
+		/// range. Otherwise, the returned std::optional instance has no value.
+		/// </returns>
+		std::optional<std::uint32_t> AllocateRange(const std::uint32_t indexCount);
+
+		void Free(const std::uint32_t index);
+		void FreeRange(const std::uint32_t firstIndex, const std::uint32_t indexCount);
+
+		bool IsIndexAllocated(const std::uint32_t index) const;
+
+	private:
+		std::optional<std::uint32_t> TryAllocateFromWord(const std::uint32_t wordIndex, const bool markIfFull);
+		std::optional<std::uint32_t> TryAllocateRangeFromWord(const std::uint32_t wordIndex, const std::uint32_t indexCount);
+		std::optional<std::uint32_t> TryAllocateWholeWordRange(const std::uint32_t firstWordIndex, const std::uint32_t indexCount);
+
+		void MarkWordAsFull(const std::uint32_t wordIndex);
+		void FreeBits(const std::uint32_t wordIndex, const std::uint64_t bitMask);
+
+	private:
+		std::array<std::atomic<std::uint64_t>, WORD_COUNT> mWordArr;
+		std::array<std::atomic<std::uint64_t>, SUMMARY_WORD_COUNT> mSummaryWordArr;
+		std::atomic<std::uint32_t> mRecentlyFreedWordIndex;
+	};
+}
+
+// -------------------------------------------------------------------------------------------------------------
+
+namespace Brawler
+{
+	template <std::uint32_t IndexCount>
+		requires (IndexCount > 0)
+	AtomicBitmapIndexAllocator<IndexCount>::AtomicBitmapIndexAllocator() :
+		mWordArr(),
+		mSummaryWordArr(),
+		mRecentlyFreedWordIndex(0)
+	{
+		// The bits past the last index are permanently marked as allocated. The same goes for the
+		// summary bits past the last word.
+		if constexpr ((IndexCount % BITS_PER_BITMAP_WORD) != 0)
+			mWordArr.back().store(FULL_BITMAP_WORD << (IndexCount % BITS_PER_BITMAP_WORD), std::memory_order::relaxed);
+
+		if constexpr ((WORD_COUNT % BITS_PER_BITMAP_WORD) != 0)
+			mSummaryWordArr.back().store(FULL_BITMAP_WORD << (WORD_COUNT % BITS_PER_BITMAP_WORD), std::memory_order::relaxed);
+	}
+
+	template <std::uint32_t IndexCount>
+		requires (IndexCount > 0)
+	std::optional<std::uint32_t> AtomicBitmapIndexAllocator<IndexCount>::Allocate()
+	{
+		{
+			// This word was only a hint, so if it is full, then we do not mark it as such. It is
+			// likely that another index in it will be freed soon, anyways.
+			const std::optional<std::uint32_t> allocatedIndex{ TryAllocateFromWord(mRecentlyFreedWordIndex.load(std::memory_order::relaxed), false) };
+
+			if (allocatedIndex.has_value())
+				return allocatedIndex;
+		}
+
+		for (std::uint32_t summaryWordIndex = 0; summaryWordIndex < SUMMARY_WORD_COUNT; ++summaryWordIndex)
+		{
+			std::uint64_t summaryWord = mSummaryWordArr[summaryWordIndex].load(std::memory_order::relaxed);
+
+			while (summaryWord != FULL_BITMAP_WORD)
+			{
+				const std::uint32_t summaryBitIndex = static_cast<std::uint32_t>(std::countr_one(summaryWord));
+				const std::optional<std::uint32_t> allocatedIndex{ TryAllocateFromWord((summaryWordIndex * BITS_PER_BITMAP_WORD) + summaryBitIndex, true) };
+
+				if (allocatedIndex.has_value())
+					return allocatedIndex;
+
+				// The word was filled up by other threads before we could get to it, so move on
+				// to the next one.
+				summaryWord |= (std::uint64_t{ 1 } << summaryBitIndex);
+			}
+		}
+
+		return std::optional<std::uint32_t>{};
+	}
+
+	template <std::uint32_t IndexCount>
+		requires (IndexCount > 0)
+	std::optional<std::uint32_t> AtomicBitmapIndexAllocator<IndexCount>::AllocateRange(const std::uint32_t indexCount)
+	{
+		assert(indexCount > 0 && "ERROR: An attempt was made to allocate an empty range of indices from an AtomicBitmapIndexAllocator!");
+
+		if (indexCount > IndexCount) [[unlikely]]
+			return std::optional<std::uint32_t>{};
+
+		if (indexCount == 1)
+			return Allocate();
+
+		if (indexCount <= BITS_PER_BITMAP_WORD)
+		{
+			for (std::uint32_t wordIndex = 0; wordIndex < WORD_COUNT; ++wordIndex)
+			{
+				// We can skip the words which are known to be full without even looking at them.
+				const std::uint64_t summaryBit = (std::uint64_t{ 1 } << (wordIndex % BITS_PER_BITMAP_WORD));
+
+				if ((mSummaryWordArr[wordIndex / BITS_PER_BITMAP_WORD].load(std::memory_order::relaxed) & summaryBit) != 0)
+					continue;
+
+				const std::optional<std::uint32_t> firstIndex{ TryAllocateRangeFromWord(wordIndex, indexCount) };
+
+				if (firstIndex.has_value())
+					return firstIndex;
+			}
+
+			return std::optional<std::uint32_t>{};
+		}
+
+		const std::uint32_t requiredWordCount = ((indexCount + (BITS_PER_BITMAP_WORD - 1)) / BITS_PER_BITMAP_WORD);
+
+		for (std::uint32_t firstWordIndex = 0; (firstWordIndex + requiredWordCount) <= WORD_COUNT; ++firstWordIndex)
+		{
+			if (mWordArr[firstWordIndex].load(std::memory_order::relaxed) != 0)
+				continue;
+
+			const std::optional<std::uint32_t> firstIndex{ TryAllocateWholeWordRange(firstWordIndex, indexCount) };
+
+			if (firstIndex.has_value())
+				return firstIndex;
+		}
+
+		return std::optional<std::uint32_t>{};
+	}
+
+	template <std::uint32_t IndexCount>
+		requires (IndexCount > 0)
+	void AtomicBitmapIndexAllocator<IndexCount>::Free(const std::uint32_t index)
+	{
+		assert(index < IndexCount);
+		FreeBits(index / BITS_PER_BITMAP_WORD, (std::uint64_t{ 1 } << (index % BITS_PER_BITMAP_WORD)));
+	}
+
+	template <std::uint32_t IndexCount>
+		requires (IndexCount > 0)
+	void AtomicBitmapIndexAllocator<IndexCount>::FreeRange(const std::uint32_t firstIndex, const std::uint32_t indexCount)
+	{
+		assert(indexCount > 0 && (static_cast<std::uint64_t>(firstIndex) + indexCount) <= IndexCount);
+
+		std::uint32_t currIndex = firstIndex;
+		const std::uint32_t endIndex = (firstIndex + indexCount);
+
+		while (currIndex < endIndex)
+		{
+			const std::uint32_t bitIndex = (currIndex % BITS_PER_BITMAP_WORD);
+			const std::uint32_t bitCount = std::min(endIndex - currIndex, BITS_PER_BITMAP_WORD - bitIndex);
+			const std::uint64_t bitMask = ((bitCount == BITS_PER_BITMAP_WORD) ? FULL_BITMAP_WORD : (((std::uint64_t{ 1 } << bitCount) - 1) << bitIndex));
+
+			FreeBits(currIndex / BITS_PER_BITMAP_WORD, bitMask);
+			currIndex += bitCount;
+		}
+	}
+
+	template <std::uint32_t IndexCount>
+		requires (IndexCount > 0)
+	bool AtomicBitmapIndexAllocator<IndexCount>::IsIndexAllocated(const std::uint32_t index) const
+	{
+		assert(index < IndexCount);
+		return ((mWordArr[index / BITS_PER_BITMAP_WORD].load(std::memory_order::acquire) >> (index % BITS_PER_BITMAP_WORD)) & 1);
+	}
+
+	template <std::uint32_t IndexCount>
+		requires (IndexCount > 0)
+	std::optional<std::uint32_t> AtomicBitmapIndexAllocator<IndexCount>::TryAllocateFromWord(const std::uint32_t wordIndex, const bool markIfFull)
+	{
+		std::atomic<std::uint64_t>& word{ mWordArr[wordIndex] };
+		std::uint64_t currWordValue = word.load(std::memory_order::relaxed);
+
+		while (currWordValue != FULL_BITMAP_WORD)
+		{
+			const std::uint32_t bitIndex = static_cast<std::uint32_t>(std::countr_one(currWordValue));
+			const std::uint64_t bitMask = (std::uint64_t{ 1 } << bitIndex);
+
+			// If another thread took the same bit first, then fetch_or() still tells us what the
+			// word looks like now, so we can try again with the next free bit.
+			const std::uint64_t prevWordValue = word.fetch_or(bitMask, std::memory_order::seq_cst);
+
+			if ((prevWordValue & bitMask) == 0)
+				return std::optional<std::uint32_t>{ (wordIndex * BITS_PER_BITMAP_WORD) + bitIndex };
+
+			currWordValue = (prevWordValue | bitMask);
+		}
+
+		if (markIfFull)
+			MarkWordAsFull(wordIndex);
+
+		return std::optional<std::uint32_t>{};
+	}
+
+	template <std::uint32_t IndexCount>
+		requires (IndexCount > 0)
+	std::optional<std::uint32_t> AtomicBitmapIndexAllocator<IndexCount>::TryAllocateRangeFromWord(const std::uint32_t wordIndex, const std::uint32_t indexCount)
+	{
+		std::atomic<std::uint64_t>& word{ mWordArr[wordIndex] };
+		std::uint64_t currWordValue = word.load(std::memory_order::relaxed);
+
+		while (true)
+		{
+			// Find every bit which begins a run of indexCount free bits. Bit i of runStartMask is
+			// set if bits [i, i + runLength) are all free, and we double runLength (without going
+			// past indexCount) until it reaches indexCount. The shifts fill the top of the mask
+			// with zeroes, so runs which would extend past the end of the word are excluded, too.
+			std::uint64_t runStartMask = ~currWordValue;
+			std::uint32_t runLength = 1;
+
+			while (runLength < indexCount && runStartMask != 0)
+			{
+				const std::uint32_t shiftAmount = std::min(runLength, indexCount - runLength);
+
+				runStartMask &= (runStartMask >> shiftAmount);
+				runLength += shiftAmount;
+			}
+
+			if (runStartMask == 0)
+			{
+				if (currWordValue == FULL_BITMAP_WORD)
+					MarkWordAsFull(wordIndex);
+
+				return std::optional<std::uint32_t>{};
+			}
+
+			const std::uint32_t bitIndex = static_cast<std::uint32_t>(std::countr_zero(runStartMask));
+			const std::uint64_t rangeMask = ((indexCount == BITS_PER_BITMAP_WORD) ? FULL_BITMAP_WORD : (((std::uint64_t{ 1 } << indexCount) - 1) << bitIndex));
+
+			// Unlike with a single bit, we cannot just use fetch_or() here, since we need all of the
+			// bits of the range to be free at once.
+			if (word.compare_exchange_weak(currWordValue, (currWordValue | rangeMask), std::memory_order::seq_cst, std::memory_order::relaxed))
+				return std::optional<std::uint32_t>{ (wordIndex * BITS_PER_BITMAP_WORD) + bitIndex };
+		}
+	}
+
+	template <std::uint32_t IndexCount>
+		requires (IndexCount > 0)
+	std::optional<std::uint32_t> AtomicBitmapIndexAllocator<IndexCount>::TryAllocateWholeWordRange(const std::uint32_t firstWordIndex, const std::uint32_t indexCount)
+	{
+		// Claim the words one at a time. If any of them is not entirely free, then we give back
+		// the ones which we already claimed.
+		std::uint32_t remainingIndexCount = indexCount;
+		std::uint32_t currWordIndex = firstWordIndex;
+
+		while (remainingIndexCount > 0)
+		{
+			const std::uint32_t bitCount = std::min(remainingIndexCount, BITS_PER_BITMAP_WORD);
+			const std::uint64_t bitMask = ((bitCount == BITS_PER_BITMAP_WORD) ? FULL_BITMAP_WORD : ((std::uint64_t{ 1 } << bitCount) - 1));
+
+			std::uint64_t expectedWordValue = 0;
+
+			if (!mWordArr[currWordIndex].compare_exchange_strong(expectedWordValue, bitMask, std::memory_order::seq_cst, std::memory_order::relaxed))
+			{
+				const std::uint32_t claimedIndexCount = (indexCount - remainingIndexCount);
+
+				if (claimedIndexCount > 0)
+					FreeRange(firstWordIndex * BITS_PER_BITMAP_WORD, claimedIndexCount);
+
+				return std::optional<std::uint32_t>{};
+			}
+
+			remainingIndexCount -= bitCount;
+			++currWordIndex;
+		}
+
+		return std::optional<std::uint32_t>{ firstWordIndex * BITS_PER_BITMAP_WORD };
+	}
+
+	template <std::uint32_t IndexCount>
+		requires (IndexCount > 0)
+	void AtomicBitmapIndexAllocator<IndexCount>::MarkWordAsFull(const std::uint32_t wordIndex)
+	{
+		std::atomic<std::uint64_t>& summaryWord{ mSummaryWordArr[wordIndex / BITS_PER_BITMAP_WORD] };
+		const std::uint64_t summaryBit = (std::uint64_t{ 1 } << (wordIndex % BITS_PER_BITMAP_WORD));
+
+		summaryWord.fetch_or(summaryBit, std::memory_order::seq_cst);
+
+		// Another thread might have freed an index in this word after we saw that it was full, but
+		// before we set the summary bit. In that case, it might have already checked the summary
+		// bit, so we need to check the word again. Since all of these operations are sequentially
+		// consistent, either we see the freed index here, or the freeing thread sees the summary
+		// bit and clears it.
+		if (mWordArr[wordIndex].load(std::memory_order::seq_cst) != FULL_BITMAP_WORD)
+			summaryWord.fetch_and(~summaryBit, std::memory_order::seq_cst);
+	}
+
+	template <std::uint32_t IndexCount>
+		requires (IndexCount > 0)
+	void AtomicBitmapIndexAllocator<IndexCount>::FreeBits(const std::uint32_t wordIndex, const std::uint64_t bitMask)
+	{
+		const std::uint64_t prevWordValue = mWordArr[wordIndex].fetch_and(~bitMask, std::memory_order::seq_cst);
+		assert((prevWordValue & bitMask) == bitMask && "ERROR: An attempt was made to free an index of an AtomicBitmapIndexAllocator which was not allocated!");
+
+		// Only write to the hint if it actually changes, so that threads which keep freeing
+		// indices in the same word do not keep stealing its cache line from each other.
+		if (mRecentlyFreedWordIndex.load(std::memory_order::relaxed) != wordIndex)
+			mRecentlyFreedWordIndex.store(wordIndex, std::memory_order::relaxed);
+
+		if (prevWordValue != FULL_BITMAP_WORD)
+			return;
+
+		std::atomic<std::uint64_t>& summaryWord{ mSummaryWordArr[wordIndex / BITS_PER_BITMAP_WORD] };
+		const std::uint64_t summaryBit = (std::uint64_t{ 1 } << (wordIndex % BITS_PER_BITMAP_WORD));
+
+		if ((summaryWord.load(std::memory_order::seq_cst) & summaryBit) != 0)
+			summaryWord.fetch_and(~summaryBit, std::memory_order::seq_cst);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,325 @@
+module;
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <array>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <latch>
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <optional>
+#include <queue>
+#include <mutex>
+
+module Tests.AtomicBitmapIndexAllocatorTest;
+import Brawler.AtomicBitmapIndexAllocator;
+import Brawler.Timer;
+
+namespace
+{
+	// This is deliberately not a multiple of 64, so that the padding bits of the last word are
+	// tested, too.
+	constexpr std::uint32_t SMALL_INDEX_COUNT = 1000;
+
+	constexpr std::uint32_t STRESS_INDEX_COUNT = 20000;
+	constexpr std::size_t STRESS_OPERATIONS_PER_THREAD = 200000;
+	constexpr std::uint32_t MAX_STRESS_RANGE_SIZE = 150;
+
+	// This matches BINDLESS_SRVS_PARTITION_SIZE in the GPUResourceDescriptorHeap.
+	constexpr std::uint32_t BENCHMARK_INDEX_COUNT = 500000;
+	constexpr std::size_t BENCHMARK_OPERATIONS_PER_THREAD = (1 << 18);
+	constexpr std::uint32_t BENCHMARK_LIVE_INDICES_PER_THREAD = 256;
+	constexpr std::array<std::uint32_t, 5> BENCHMARK_THREAD_COUNT_ARR{ 1, 2, 4, 8, 16 };
+
+	template <typename Callback>
+	void RunOnThreads(const std::uint32_t numThreads, const Callback& callback)
+	{
+		std::latch startLatch{ static_cast<std::ptrdiff_t>(numThreads) };
+		std::vector<std::jthread> threadArr{};
+
+		for (std::uint32_t i = 0; i < numThreads; ++i)
+		{
+			threadArr.emplace_back([&startLatch, &callback, i] ()
+			{
+				startLatch.arrive_and_wait();
+				callback(i);
+			});
+		}
+	}
+
+	void RunSingleThreadedTest()
+	{
+		const std::unique_ptr<Brawler::AtomicBitmapIndexAllocator<SMALL_INDEX_COUNT>> allocatorPtr{ std::make_unique<Brawler::AtomicBitmapIndexAllocator<SMALL_INDEX_COUNT>>() };
+		Brawler::AtomicBitmapIndexAllocator<SMALL_INDEX_COUNT>& allocator{ *allocatorPtr };
+
+		// Without any frees, the allocator always hands out the lowest free index, so the
+		// indices come out in order.
+		for (std::uint32_t i = 0; i < SMALL_INDEX_COUNT; ++i)
+		{
+			const std::optional<std::uint32_t> index{ allocator.Allocate() };
+			assert(index.has_value() && *index == i);
+		}
+
+		assert(!allocator.Allocate().has_value() && "ERROR: An AtomicBitmapIndexAllocator handed out an index which was out of range!");
+		assert(!allocator.AllocateRange(2).has_value());
+
+		// Free every index in [100, 300), which also empties a few entire words.
+		allocator.FreeRange(100, 200);
+
+		for (std::uint32_t i = 100; i < 300; ++i)
+			assert(!allocator.IsIndexAllocated(i));
+
+		assert(allocator.IsIndexAllocated(99) && allocator.IsIndexAllocated(300));
+
+		// A range of more than 64 indices must begin at a multiple of 64, and all of the words
+		// which it covers must be free, so the only candidate in [100, 300) is [128, 256).
+		{
+			const std::optional<std::uint32_t> firstIndex{ allocator.AllocateRange(100) };
+			assert(firstIndex.has_value() && *firstIndex == 128);
+
+			assert(!allocator.AllocateRange(65).has_value());
+
+			allocator.FreeRange(*firstIndex, 100);
+		}
+
+		// A range of at most 64 indices does not cross a 64-index boundary, so what is left of
+		// [100, 300) fits ranges of exactly 28, 64, 64 and 44 indices.
+		{
+			const std::optional<std::uint32_t> firstIndex{ allocator.AllocateRange(28) };
+			assert(firstIndex.has_value() && *firstIndex == 100);
+
+			const std::optional<std::uint32_t> secondIndex{ allocator.AllocateRange(64) };
+			assert(secondIndex.has_value() && *secondIndex == 128);
+
+			const std::optional<std::uint32_t> thirdIndex{ allocator.AllocateRange(64) };
+			assert(thirdIndex.has_value() && *thirdIndex == 192);
+
+			const std::optional<std::uint32_t> fourthIndex{ allocator.AllocateRange(44) };
+			assert(fourthIndex.has_value() && *fourthIndex == 256);
+
+			assert(!allocator.Allocate().has_value());
+		}
+
+		for (std::uint32_t i = 0; i < SMALL_INDEX_COUNT; ++i)
+			allocator.Free(i);
+
+		// Once everything is free again, the largest possible range must fit.
+		{
+			const std::optional<std::uint32_t> firstIndex{ allocator.AllocateRange(SMALL_INDEX_COUNT - (SMALL_INDEX_COUNT % 64)) };
+			assert(firstIndex.has_value() && *firstIndex == 0);
+		}
+
+		std::cout << "AtomicBitmapIndexAllocator single-threaded test passed." << std::endl;
+	}
+
+	void RunStressTest()
+	{
+		const std::uint32_t numThreads = std::max<std::uint32_t>(std::thread::hardware_concurrency(), 4);
+
+		const std::unique_ptr<Brawler::AtomicBitmapIndexAllocator<STRESS_INDEX_COUNT>> allocatorPtr{ std::make_unique<Brawler::AtomicBitmapIndexAllocator<STRESS_INDEX_COUNT>>() };
+		Brawler::AtomicBitmapIndexAllocator<STRESS_INDEX_COUNT>& allocator{ *allocatorPtr };
+
+		// Every index records which thread owns it. If the allocator ever hands out an index
+		// which is already owned, then claiming it here fails.
+		const std::unique_ptr<std::atomic<std::uint32_t>[]> indexOwnerArr{ std::make_unique<std::atomic<std::uint32_t>[]>(STRESS_INDEX_COUNT) };
+
+		RunOnThreads(numThreads, [&allocator, &indexOwnerArr] (const std::uint32_t threadIndex)
+		{
+			struct OwnedRange
+			{
+				std::uint32_t FirstIndex;
+				std::uint32_t IndexCount;
+			};
+
+			std::mt19937 randomEngine{ threadIndex };
+			std::uniform_int_distribution<std::uint32_t> operationDistribution{ 0, 99 };
+			std::uniform_int_distribution<std::uint32_t> rangeSizeDistribution{ 2, MAX_STRESS_RANGE_SIZE };
+
+			std::vector<OwnedRange> ownedRangeArr{};
+			const std::uint32_t ownerID = (threadIndex + 1);
+
+			const auto claimRange = [&indexOwnerArr, ownerID] (const OwnedRange& range)
+			{
+				for (std::uint32_t i = range.FirstIndex; i < (range.FirstIndex + range.IndexCount); ++i)
+				{
+					std::uint32_t expectedOwnerID = 0;
+					const bool claimed = indexOwnerArr[i].compare_exchange_strong(expectedOwnerID, ownerID, std::memory_order::relaxed);
+
+					assert(claimed && "ERROR: An AtomicBitmapIndexAllocator handed out the same index to two threads at once!");
+				}
+			};
+
+			for (std::size_t i = 0; i < STRESS_OPERATIONS_PER_THREAD; ++i)
+			{
+				const std::uint32_t operation = operationDistribution(randomEngine);
+
+				// Threads hold on to at most a few hundred ranges, so the allocator is often close
+				// to full, but never permanently full.
+				if (!ownedRangeArr.empty() && (operation < 45 || ownedRangeArr.size() > 400))
+				{
+					const std::size_t rangeIndex = (randomEngine() % ownedRangeArr.size());
+					const OwnedRange range{ ownedRangeArr[rangeIndex] };
+
+					ownedRangeArr[rangeIndex] = ownedRangeArr.back();
+					ownedRangeArr.pop_back();
+
+					for (std::uint32_t j = range.FirstIndex; j < (range.FirstIndex + range.IndexCount); ++j)
+						indexOwnerArr[j].store(0, std::memory_order::relaxed);
+
+					if (range.IndexCount == 1)
+						allocator.Free(range.FirstIndex);
+					else
+						allocator.FreeRange(range.FirstIndex, range.IndexCount);
+				}
+				else if (operation < 95)
+				{
+					const std::optional<std::uint32_t> index{ allocator.Allocate() };
+
+					if (index.has_value())
+					{
+						ownedRangeArr.push_back(OwnedRange{ *index, 1 });
+						claimRange(ownedRangeArr.back());
+					}
+				}
+				else
+				{
+					const std::uint32_t rangeSize = rangeSizeDistribution(randomEngine);
+					const std::optional<std::uint32_t> firstIndex{ allocator.AllocateRange(rangeSize) };
+
+					if (firstIndex.has_value())
+					{
+						ownedRangeArr.push_back(OwnedRange{ *firstIndex, rangeSize });
+						claimRange(ownedRangeArr.back());
+					}
+				}
+			}
+
+			for (const auto& range : ownedRangeArr)
+			{
+				for (std::uint32_t j = range.FirstIndex; j < (range.FirstIndex + range.IndexCount); ++j)
+					indexOwnerArr[j].store(0, std::memory_order::relaxed);
+
+				allocator.FreeRange(range.FirstIndex, range.IndexCount);
+			}
+		});
+
+		// If a summary bit had been left set for a word with free indices, then some of the
+		// indices would now be unreachable.
+		for (std::uint32_t i = 0; i < STRESS_INDEX_COUNT; ++i)
+		{
+			const std::optional<std::uint32_t> index{ allocator.Allocate() };
+			assert(index.has_value() && "ERROR: An AtomicBitmapIndexAllocator lost track of some of its free indices!");
+
+			std::uint32_t expectedOwnerID = 0;
+			const bool claimed = indexOwnerArr[*index].compare_exchange_strong(expectedOwnerID, 1, std::memory_order::relaxed);
+
+			assert(claimed && "ERROR: An AtomicBitmapIndexAllocator handed out the same index twice!");
+		}
+
+		assert(!allocator.Allocate().has_value());
+
+		std::cout << "AtomicBitmapIndexAllocator stress test passed (" << numThreads << " threads)." << std::endl;
+	}
+
+	// This is how the GPUResourceDescriptorHeap used to manage its bindless SRV indices.
+	struct MutexIndexQueue
+	{
+		std::queue<std::uint32_t> Queue;
+		std::mutex CritSection;
+	};
+
+	template <typename Callback>
+	float MeasureThroughput(const std::uint32_t numThreads, const Callback& callback)
+	{
+		Brawler::Timer t{};
+		t.Start();
+
+		RunOnThreads(numThreads, callback);
+
+		t.Stop();
+
+		// Report millions of operations per second.
+		return ((static_cast<float>(numThreads) * static_cast<float>(BENCHMARK_OPERATIONS_PER_THREAD)) / (t.GetElapsedTimeInMilliseconds() * 1000.0f));
+	}
+
+	void RunBenchmarks()
+	{
+		MutexIndexQueue indexQueue{};
+
+		{
+			Brawler::Timer t{};
+			t.Start();
+
+			for (std::uint32_t i = 0; i < BENCHMARK_INDEX_COUNT; ++i)
+				indexQueue.Queue.push(i);
+
+			t.Stop();
+
+			std::cout << "Filling a std::queue with " << BENCHMARK_INDEX_COUNT << " indices took " << t.GetElapsedTimeInMilliseconds() << " ms. (The AtomicBitmapIndexAllocator needs no initialization.)" << std::endl;
+		}
+
+		const std::unique_ptr<Brawler::AtomicBitmapIndexAllocator<BENCHMARK_INDEX_COUNT>> allocatorPtr{ std::make_unique<Brawler::AtomicBitmapIndexAllocator<BENCHMARK_INDEX_COUNT>>() };
+
+		for (const auto numThreads : BENCHMARK_THREAD_COUNT_ARR)
+		{
+			// Every thread keeps a small window of live indices and frees the oldest one whenever
+			// it allocates a new one, which is roughly what texture streaming looks like.
+			const float queueThroughput = MeasureThroughput(numThreads, [&indexQueue] (const std::uint32_t threadIndex)
+			{
+				std::array<std::uint32_t, BENCHMARK_LIVE_INDICES_PER_THREAD> liveIndexArr{};
+
+				for (std::size_t i = 0; i < BENCHMARK_OPERATIONS_PER_THREAD; ++i)
+				{
+					std::uint32_t& liveIndex{ liveIndexArr[i % BENCHMARK_LIVE_INDICES_PER_THREAD] };
+					std::scoped_lock<std::mutex> lock{ indexQueue.CritSection };
+
+					if (i >= BENCHMARK_LIVE_INDICES_PER_THREAD)
+						indexQueue.Queue.push(liveIndex);
+
+					liveIndex = indexQueue.Queue.front();
+					indexQueue.Queue.pop();
+				}
+
+				std::scoped_lock<std::mutex> lock{ indexQueue.CritSection };
+
+				for (const auto liveIndex : liveIndexArr)
+					indexQueue.Queue.push(liveIndex);
+			});
+
+			const float bitmapThroughput = MeasureThroughput(numThreads, [&allocatorPtr] (const std::uint32_t threadIndex)
+			{
+				std::array<std::uint32_t, BENCHMARK_LIVE_INDICES_PER_THREAD> liveIndexArr{};
+
+				for (std::size_t i = 0; i < BENCHMARK_OPERATIONS_PER_THREAD; ++i)
+				{
+					std::uint32_t& liveIndex{ liveIndexArr[i % BENCHMARK_LIVE_INDICES_PER_THREAD] };
+
+					if (i >= BENCHMARK_LIVE_INDICES_PER_THREAD)
+						allocatorPtr->Free(liveIndex);
+
+					liveIndex = *(allocatorPtr->Allocate());
+				}
+
+				for (const auto liveIndex : liveIndexArr)
+					allocatorPtr->Free(liveIndex);
+			});
+
+			std::cout << "Allocate + Free (" << numThreads << " Threads):\n"
+				<< "\tstd::mutex + std::queue: " << queueThroughput << " Mops/s\n"
+				<< "\tBrawler::AtomicBitmapIndexAllocator: " << bitmapThroughput << " Mops/s" << std::endl;
+		}
+	}
+}
+
+namespace Tests
+{
+	void RunAtomicBitmapIndexAllocatorTests()
+	{
+		RunSingleThreadedTest();
+		RunStressTest();
+		RunBenchmarks();
+	}
+}
\ No newline at end of file
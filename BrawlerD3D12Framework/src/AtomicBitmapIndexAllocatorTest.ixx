@@ -0,0 +1,15 @@
+module;
+
+export module Tests.AtomicBitmapIndexAllocatorTest;
+
+export namespace Tests
+{
+	/// <summary>
+	/// Checks that a Brawler::AtomicBitmapIndexAllocator hands out every index exactly once,
+	/// both for single indices and for ranges, while many threads allocate and free at once.
+	/// Afterwards, the function compares the start-up cost and the throughput of the allocator
+	/// with that of the std::mutex-protected std::queue which the GPUResourceDescriptorHeap
+	/// used to use for its bindless SRV indices.
+	/// </summary>
+	void RunAtomicBitmapIndexAllocatorTests();
+}
\ No newline at end of file
@@ -75,9 +75,14 @@ namespace Brawler
 	{
 		BufferResource::BufferResource(const BufferResourceInitializationInfo& initInfo) :
 			I_GPUResource(ConvertBufferResourceInitializationInfo(initInfo)),
-			mSubAllocationManager(*this, initInfo.SizeInBytes)
+			mSubAllocationManager(*this, initInfo.SizeInBytes, (initInfo.EnableSubAllocationThreadCaching ? TLSFThreadCacheMode::ENABLED : TLSFThreadCacheMode::DISABLED))
 		{}
 
+		void BufferResource::FlushSubAllocationThreadCaches()
+		{
+			mSubAllocationManager.FlushThreadCaches();
+		}
+
 		void BufferResource::ExecutePostD3D12ResourceInitializationCallback()
 		{
 			mSubAllocationManager.OnD3D12ResourceInitialized();
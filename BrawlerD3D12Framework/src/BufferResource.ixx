@@ -1,5 +1,6 @@
 module;
 #include <optional>
+#include <memory>
 #include <cassert>
 #include <vector>
 #include <mutex>
@@ -13,7 +14,6 @@ import Util.General;
 import Brawler.OptionalRef;
 import Brawler.D3D12.TLSFAllocationRequestInfo;
 import Brawler.D3D12.BufferSubAllocationReservation;
-import Brawler.ThreadSafeVector;
 
 export namespace Brawler
 {
@@ -57,7 +57,7 @@ export namespace Brawler
 			friend class BufferResource;
 
 		public:
-			BufferSubAllocationManager(BufferResource& owningBufferResource, const std::size_t sizeInBytes);
+			BufferSubAllocationManager(BufferResource& owningBufferResource, const std::size_t sizeInBytes, const TLSFThreadCacheMode threadCacheMode);
 
 			BufferSubAllocationManager(const BufferSubAllocationManager& rhs) = delete;
 			BufferSubAllocationManager& operator=(const BufferSubAllocationManager& rhs) = delete;
@@ -77,12 +77,22 @@ export namespace Brawler
 
 			void DeleteSubAllocation(BufferSubAllocationReservation& reservation);
 
+			void FlushThreadCaches();
+
+			/// <summary>
+			/// This is called when the last handle to a BufferSubAllocationReservation is destroyed.
+			/// The reservation's memory is returned to the buffer the next time a sub-allocation is
+			/// created from it.
+			/// </summary>
+			void RetireReservation(BufferSubAllocationReservation& reservation);
+
 			void WriteToBuffer(const std::span<const std::byte> srcDataByteSpan, const std::size_t bufferOffset);
 			void ReadFromBuffer(const std::span<std::byte> destDataByteSpan, const std::size_t bufferOffset);
 
 		private:
 			void OnD3D12ResourceInitialized();
 			bool AssignReservationToSubAllocation(I_BufferSubAllocation& subAllocation);
+			std::vector<std::unique_ptr<BufferSubAllocationReservation>> EraseRetiredReservations();
 
 			void TransferTemporaryCPUDataToGPUBuffer();
 
@@ -90,7 +100,16 @@ export namespace Brawler
 			TLSFAllocator mBufferMemoryAllocator;
 			BufferResource* mOwningBufferResourcePtr;
 			std::vector<DataWriteRequest> mPendingWriteRequestArr;
-			Brawler::ThreadSafeVector<std::unique_ptr<BufferSubAllocationReservation>> mReservationPtrArr;
+
+			// Every live BufferSubAllocationReservation sits at the index of mReservationPtrArr which
+			// it stores itself, so it can be erased in constant time. Reservations whose handles were
+			// destroyed are only collected in mRetiredReservationPtrArr; they are erased the next time
+			// a sub-allocation is created. Both are protected by mReservationCritSection, which is
+			// never held while memory is allocated from or returned to mBufferMemoryAllocator.
+			std::vector<std::unique_ptr<BufferSubAllocationReservation>> mReservationPtrArr;
+			std::vector<BufferSubAllocationReservation*> mRetiredReservationPtrArr;
+			std::mutex mReservationCritSection;
+
 			mutable std::mutex mCritSection;
 		};
 	}
@@ -187,6 +206,17 @@ export namespace Brawler
 				requires std::derived_from<SubAllocationType, I_BufferSubAllocation>
 			[[nodiscard]] std::optional<SubAllocationType> CreateBufferSubAllocation(Args&&... args);
 
+			/// <summary>
+			/// If the BufferResource was created with BufferResourceInitializationInfo::EnableSubAllocationThreadCaching
+			/// set to true, then this returns the memory held in the per-thread sub-allocation caches
+			/// to the buffer's shared heap, where it can be merged back into larger free segments.
+			/// Existing sub-allocations are unaffected. This already happens at the end of every frame,
+			/// so it only needs to be called if the memory is needed back sooner than that.
+			/// 
+			/// If thread caching is disabled for this BufferResource, then this function does nothing.
+			/// </summary>
+			void FlushSubAllocationThreadCaches();
+
 		protected:
 			void ExecutePostD3D12ResourceInitializationCallback() override;
 
@@ -11,6 +11,15 @@ export namespace Brawler
 		{
 			std::size_t SizeInBytes;
 			D3D12_HEAP_TYPE HeapType;
+
+			/// <summary>
+			/// If this is true, then small sub-allocations from the BufferResource are served from
+			/// per-thread caches whenever possible, rather than from the shared TLSF heap. This helps
+			/// buffers which many jobs create small sub-allocations from every frame (e.g., for constant
+			/// buffer data). The caches are flushed automatically at the end of every frame by
+			/// Renderer::AdvanceFrame().
+			/// </summary>
+			bool EnableSubAllocationThreadCaching = false;
 		};
 	}
 }
\ No newline at end of file
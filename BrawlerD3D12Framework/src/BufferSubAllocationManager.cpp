@@ -1,5 +1,6 @@
 module;
 #include <memory>
+#include <vector>
 #include <optional>
 #include <mutex>
 #include <span>
@@ -28,14 +29,19 @@ namespace Brawler
 {
 	namespace D3D12
 	{
-		BufferSubAllocationManager::BufferSubAllocationManager(BufferResource& owningBufferResource, const std::size_t sizeInBytes) :
+		BufferSubAllocationManager::BufferSubAllocationManager(BufferResource& owningBufferResource, const std::size_t sizeInBytes, const TLSFThreadCacheMode threadCacheMode) :
 			mBufferMemoryAllocator(),
 			mOwningBufferResourcePtr(&owningBufferResource),
 			mPendingWriteRequestArr(),
 			mReservationPtrArr(),
+			mRetiredReservationPtrArr(),
+			mReservationCritSection(),
 			mCritSection()
 		{
-			mBufferMemoryAllocator.Initialize(sizeInBytes);
+			mBufferMemoryAllocator.Initialize(TLSFAllocatorInitializationInfo{
+				.HeapSizeInBytes = sizeInBytes,
+				.ThreadCacheMode = threadCacheMode
+			});
 		}
 
 		Brawler::D3D12Resource& BufferSubAllocationManager::GetBufferD3D12Resource() const
@@ -69,6 +75,19 @@ namespace Brawler
 			mBufferMemoryAllocator.DeleteAllocation(reservation.GetTLSFMemoryBlock());
 		}
 
+		void BufferSubAllocationManager::FlushThreadCaches()
+		{
+			mBufferMemoryAllocator.FlushThreadCaches();
+		}
+
+		void BufferSubAllocationManager::RetireReservation(BufferSubAllocationReservation& reservation)
+		{
+			assert(&(reservation.GetBufferSubAllocationManager()) == this);
+
+			std::scoped_lock<std::mutex> lock{ mReservationCritSection };
+			mRetiredReservationPtrArr.push_back(&reservation);
+		}
+
 		void BufferSubAllocationManager::WriteToBuffer(const std::span<const std::byte> srcDataByteSpan, const std::size_t bufferOffset)
 		{
 			{
@@ -169,19 +188,9 @@ namespace Brawler
 
 		bool BufferSubAllocationManager::AssignReservationToSubAllocation(I_BufferSubAllocation& subAllocation)
 		{
-			// First, try to return any BufferSubAllocationReservation instances which are
-			// ready for destruction.
-			mReservationPtrArr.EraseIf([this] (const std::unique_ptr<BufferSubAllocationReservation>& reservationPtr)
-			{
-				if (reservationPtr->ReadyForDestruction()) [[unlikely]]
-				{
-					DeleteSubAllocation(*reservationPtr);
-					return true;
-				}
-
-				return false;
-			});
-			
+			// The allocation itself is made without holding mReservationCritSection. Otherwise,
+			// every sub-allocation would serialize on it, even those which the TLSFAllocator can
+			// serve from a thread cache.
 			const TLSFAllocationRequestInfo allocationRequest{
 				.SizeInBytes = subAllocation.GetSubAllocationSize(),
 				.Alignment = subAllocation.GetRequiredDataPlacementAlignment()
@@ -189,18 +198,83 @@ namespace Brawler
 			Brawler::OptionalRef<TLSFMemoryBlock> subAllocationMemoryBlock{ mBufferMemoryAllocator.CreateAllocation(allocationRequest) };
 
 			if (!subAllocationMemoryBlock.HasValue()) [[unlikely]]
-				return false;
+			{
+				// The memory of the retired reservations might be enough to satisfy the request.
+				{
+					std::vector<std::unique_ptr<BufferSubAllocationReservation>> erasedReservationPtrArr{};
+
+					{
+						std::scoped_lock<std::mutex> lock{ mReservationCritSection };
+						erasedReservationPtrArr = EraseRetiredReservations();
+					}
+				}
+
+				subAllocationMemoryBlock = mBufferMemoryAllocator.CreateAllocation(allocationRequest);
+
+				if (!subAllocationMemoryBlock.HasValue())
+					return false;
+			}
 
 			std::unique_ptr<BufferSubAllocationReservation> reservationPtr{ std::make_unique<BufferSubAllocationReservation>() };
 			reservationPtr->SetOwningManager(*this);
 			reservationPtr->SetTLSFMemoryBlock(*subAllocationMemoryBlock);
 
-			subAllocation.AssignReservation(reservationPtr->CreateHandle());
-			mReservationPtrArr.PushBack(std::move(reservationPtr));
+			BufferSubAllocationReservationHandle hReservation{ reservationPtr->CreateHandle() };
+
+			// Destroying the erased reservations returns their memory to mBufferMemoryAllocator, and
+			// we do not want to hold mReservationCritSection while that happens, either. So, they
+			// are only destroyed once this goes out of scope.
+			std::vector<std::unique_ptr<BufferSubAllocationReservation>> erasedReservationPtrArr{};
+
+			{
+				std::scoped_lock<std::mutex> lock{ mReservationCritSection };
+
+				erasedReservationPtrArr = EraseRetiredReservations();
+
+				reservationPtr->mReservationIndex = mReservationPtrArr.size();
+				mReservationPtrArr.push_back(std::move(reservationPtr));
+			}
+
+			// Assigning the reservation destroys whichever handle subAllocation held before. That
+			// retires its reservation, which takes mReservationCritSection, so we must not be
+			// holding it here.
+			subAllocation.AssignReservation(std::move(hReservation));
 
 			return true;
 		}
 
+		std::vector<std::unique_ptr<BufferSubAllocationReservation>> BufferSubAllocationManager::EraseRetiredReservations()
+		{
+			// The caller must hold mReservationCritSection.
+
+			// Each BufferSubAllocationReservation knows its own index in mReservationPtrArr, so this
+			// only takes time proportional to the number of retired reservations, rather than to
+			// the number of live ones.
+			std::vector<std::unique_ptr<BufferSubAllocationReservation>> erasedReservationPtrArr{};
+			erasedReservationPtrArr.reserve(mRetiredReservationPtrArr.size());
+
+			for (BufferSubAllocationReservation* const retiredReservationPtr : mRetiredReservationPtrArr)
+			{
+				const std::size_t erasedIndex = retiredReservationPtr->mReservationIndex;
+				assert(erasedIndex < mReservationPtrArr.size() && mReservationPtrArr[erasedIndex].get() == retiredReservationPtr);
+
+				// Move the last reservation into the erased one's place.
+				erasedReservationPtrArr.push_back(std::move(mReservationPtrArr[erasedIndex]));
+
+				if (erasedIndex != (mReservationPtrArr.size() - 1))
+				{
+					mReservationPtrArr[erasedIndex] = std::move(mReservationPtrArr.back());
+					mReservationPtrArr[erasedIndex]->mReservationIndex = erasedIndex;
+				}
+
+				mReservationPtrArr.pop_back();
+			}
+
+			mRetiredReservationPtrArr.clear();
+
+			return erasedReservationPtrArr;
+		}
+
 		void BufferSubAllocationManager::TransferTemporaryCPUDataToGPUBuffer()
 		{
 			std::scoped_lock<std::mutex> lock{ mCritSection };
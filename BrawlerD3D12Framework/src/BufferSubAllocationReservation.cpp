@@ -14,7 +14,8 @@ namespace Brawler
 		BufferSubAllocationReservation::BufferSubAllocationReservation() :
 			mOwningManagerPtr(nullptr),
 			mMemoryBlockPtr(nullptr),
-			mIsValidPtr(std::make_shared<std::atomic<bool>>(false))
+			mIsValidPtr(std::make_shared<std::atomic<bool>>(false)),
+			mReservationIndex(0)
 		{}
 		
 		BufferSubAllocationReservation::~BufferSubAllocationReservation()
@@ -25,7 +26,8 @@ namespace Brawler
 		BufferSubAllocationReservation::BufferSubAllocationReservation(BufferSubAllocationReservation&& rhs) noexcept :
 			mOwningManagerPtr(rhs.mOwningManagerPtr),
 			mMemoryBlockPtr(rhs.mMemoryBlockPtr),
-			mIsValidPtr(std::move(rhs.mIsValidPtr))
+			mIsValidPtr(std::move(rhs.mIsValidPtr)),
+			mReservationIndex(rhs.mReservationIndex)
 		{
 			rhs.mOwningManagerPtr = nullptr;
 			rhs.mMemoryBlockPtr = nullptr;
@@ -42,6 +44,7 @@ namespace Brawler
 			rhs.mMemoryBlockPtr = nullptr;
 
 			mIsValidPtr = std::move(rhs.mIsValidPtr);
+			mReservationIndex = rhs.mReservationIndex;
 
 			return *this;
 		}
@@ -80,12 +83,10 @@ namespace Brawler
 
 		void BufferSubAllocationReservation::MarkForDestruction()
 		{
-			mReadyForDestruction.store(true, std::memory_order::relaxed);
-		}
-
-		bool BufferSubAllocationReservation::ReadyForDestruction() const
-		{
-			return mReadyForDestruction.load(std::memory_order::relaxed);
+			// The BufferSubAllocationManager owns this BufferSubAllocationReservation, so it is the
+			// one which destroys it.
+			assert(mOwningManagerPtr != nullptr);
+			mOwningManagerPtr->RetireReservation(*this);
 		}
 
 		void BufferSubAllocationReservation::ReturnReservation()
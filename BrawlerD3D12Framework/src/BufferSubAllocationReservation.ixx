@@ -45,7 +45,6 @@ export namespace Brawler
 			void UpdateValidity();
 
 			void MarkForDestruction();
-			bool ReadyForDestruction() const;
 
 			void ReturnReservation();
 
@@ -57,8 +56,11 @@ export namespace Brawler
 		private:
 			BufferSubAllocationManager* mOwningManagerPtr;
 			TLSFMemoryBlock* mMemoryBlockPtr;
-			std::atomic<bool> mReadyForDestruction;
 			std::shared_ptr<std::atomic<bool>> mIsValidPtr;
+
+			// This is the index of this BufferSubAllocationReservation within the owning
+			// BufferSubAllocationManager's array of reservations.
+			std::size_t mReservationIndex;
 		};
 	}
 }
\ No newline at end of file
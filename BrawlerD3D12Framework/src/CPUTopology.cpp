@@ -0,0 +1,413 @@
+module;
+#include <cstdint>
+#include <cassert>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <tuple>
+#include <thread>
+
+#ifdef _WIN32
+#include "DxDef.h"
+#else
+#include <map>
+#include <utility>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <fstream>
+#include <optional>
+#include <filesystem>
+#endif
+
+module Brawler.CPUTopology;
+
+#ifdef _WIN32
+import Util.General;
+#endif
+
+namespace
+{
+#ifdef _WIN32
+	std::vector<Brawler::LogicalProcessorInfo> QueryLogicalProcessors()
+	{
+		DWORD infoBufferSize = 0;
+
+		if (!GetLogicalProcessorInformationEx(RelationAll, nullptr, &infoBufferSize) && GetLastError() != ERROR_INSUFFICIENT_BUFFER) [[unlikely]]
+			Util::General::CheckHRESULT(HRESULT_FROM_WIN32(GetLastError()));
+
+		std::vector<std::byte> infoBuffer{};
+		infoBuffer.resize(infoBufferSize);
+
+		if (!GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(infoBuffer.data()), &infoBufferSize)) [[unlikely]]
+			Util::General::CheckHRESULT(HRESULT_FROM_WIN32(GetLastError()));
+
+		struct NUMANodeAffinity
+		{
+			GROUP_AFFINITY Affinity;
+			std::uint32_t NodeNumber;
+		};
+
+		std::vector<Brawler::LogicalProcessorInfo> logicalProcessorArr{};
+		std::vector<NUMANodeAffinity> nodeAffinityArr{};
+		std::uint32_t currCoreIndex = 0;
+
+		// The records returned by GetLogicalProcessorInformationEx() have variable sizes, so we
+		// need to use the Size field of each record to find the next one.
+		for (std::size_t currOffset = 0; currOffset < infoBufferSize;)
+		{
+			const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& currInfo{ *reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(infoBuffer.data() + currOffset) };
+
+			switch (currInfo.Relationship)
+			{
+			case RelationProcessorCore:
+			{
+				// Every set bit in the group masks of a processor core record is one of the logical
+				// processors of that core.
+				std::uint32_t currSMTSiblingIndex = 0;
+
+				for (WORD i = 0; i < currInfo.Processor.GroupCount; ++i)
+				{
+					const GROUP_AFFINITY& currGroupAffinity{ currInfo.Processor.GroupMask[i] };
+
+					for (std::uint32_t j = 0; j < (sizeof(KAFFINITY) * 8); ++j)
+					{
+						if ((currGroupAffinity.Mask & (static_cast<KAFFINITY>(1) << j)) == 0)
+							continue;
+
+						logicalProcessorArr.push_back(Brawler::LogicalProcessorInfo{
+							.ProcessorGroup = currGroupAffinity.Group,
+							.ProcessorNumber = j,
+							.PhysicalCoreIndex = currCoreIndex,
+							.NUMANodeIndex = 0,
+							.SMTSiblingIndex = currSMTSiblingIndex++
+						});
+					}
+				}
+
+				++currCoreIndex;
+				break;
+			}
+
+			case RelationNumaNode:
+			{
+				// A NUMA node can span several processor groups on systems with more than 64
+				// logical processors, in which case there is one GROUP_AFFINITY per group in
+				// GroupMasks. Older versions of Windows leave GroupCount at zero and only ever
+				// report a single group in GroupMask (which aliases GroupMasks[0]).
+				const WORD groupCount = std::max<WORD>(currInfo.NumaNode.GroupCount, 1);
+
+				for (WORD i = 0; i < groupCount; ++i)
+				{
+					nodeAffinityArr.push_back(NUMANodeAffinity{
+						.Affinity{ currInfo.NumaNode.GroupMasks[i] },
+						.NodeNumber = currInfo.NumaNode.NodeNumber
+					});
+				}
+
+				break;
+			}
+
+			default:
+				break;
+			}
+
+			currOffset += currInfo.Size;
+		}
+
+		for (auto& logicalProcessorInfo : logicalProcessorArr)
+		{
+			for (const auto& nodeAffinity : nodeAffinityArr)
+			{
+				if (nodeAffinity.Affinity.Group == logicalProcessorInfo.ProcessorGroup && (nodeAffinity.Affinity.Mask & (static_cast<KAFFINITY>(1) << logicalProcessorInfo.ProcessorNumber)) != 0)
+				{
+					logicalProcessorInfo.NUMANodeIndex = nodeAffinity.NodeNumber;
+					break;
+				}
+			}
+		}
+
+		return logicalProcessorArr;
+	}
+#else
+	static constexpr std::string_view SYSFS_CPU_DIRECTORY = "/sys/devices/system/cpu";
+
+	std::optional<std::int64_t> ReadSysfsInteger(const std::filesystem::path& filePath)
+	{
+		std::ifstream fileStream{ filePath };
+		std::int64_t value = 0;
+
+		if (!(fileStream >> value))
+			return std::optional<std::int64_t>{};
+
+		return value;
+	}
+
+	std::vector<std::uint32_t> ParseCPUList(const std::string_view cpuListStr)
+	{
+		// CPU lists in sysfs look like "0-3,8-11,16". (See the "cpu list" format described in
+		// the Linux kernel documentation for cpusets.)
+		std::vector<std::uint32_t> cpuIDArr{};
+		std::size_t currPos = 0;
+
+		while (currPos < cpuListStr.size())
+		{
+			std::size_t rangeEndPos = cpuListStr.find(',', currPos);
+
+			if (rangeEndPos == std::string_view::npos)
+				rangeEndPos = cpuListStr.size();
+
+			const std::string_view rangeStr{ cpuListStr.substr(currPos, (rangeEndPos - currPos)) };
+			const std::size_t dashPos = rangeStr.find('-');
+
+			std::uint32_t firstCPUID = 0;
+			std::uint32_t lastCPUID = 0;
+
+			const std::string_view firstIDStr{ rangeStr.substr(0, dashPos) };
+
+			if (std::from_chars(firstIDStr.data(), firstIDStr.data() + firstIDStr.size(), firstCPUID).ec == std::errc{})
+			{
+				lastCPUID = firstCPUID;
+
+				if (dashPos != std::string_view::npos)
+				{
+					const std::string_view lastIDStr{ rangeStr.substr(dashPos + 1) };
+
+					if (std::from_chars(lastIDStr.data(), lastIDStr.data() + lastIDStr.size(), lastCPUID).ec != std::errc{})
+						lastCPUID = firstCPUID;
+				}
+
+				for (std::uint32_t i = firstCPUID; i <= lastCPUID; ++i)
+					cpuIDArr.push_back(i);
+			}
+
+			currPos = (rangeEndPos + 1);
+		}
+
+		return cpuIDArr;
+	}
+
+	std::vector<Brawler::LogicalProcessorInfo> QueryLogicalProcessors()
+	{
+		const std::filesystem::path cpuDirectory{ SYSFS_CPU_DIRECTORY };
+
+		std::string onlineCPUListStr{};
+
+		{
+			std::ifstream onlineCPUListStream{ cpuDirectory / "online" };
+
+			if (!std::getline(onlineCPUListStream, onlineCPUListStr))
+				return std::vector<Brawler::LogicalProcessorInfo>{};
+		}
+
+		// Logical processors are identified as belonging to the same physical core by their
+		// (package ID, core ID) pair. Core IDs are only unique within a package.
+		std::map<std::pair<std::int64_t, std::int64_t>, std::pair<std::uint32_t, std::uint32_t>> coreKeyMap{};
+		std::vector<Brawler::LogicalProcessorInfo> logicalProcessorArr{};
+
+		for (const auto cpuID : ParseCPUList(onlineCPUListStr))
+		{
+			const std::filesystem::path currCPUDirectory{ cpuDirectory / ("cpu" + std::to_string(cpuID)) };
+
+			const std::int64_t packageID = ReadSysfsInteger(currCPUDirectory / "topology" / "physical_package_id").value_or(0);
+			const std::optional<std::int64_t> coreID{ ReadSysfsInteger(currCPUDirectory / "topology" / "core_id") };
+
+			// Without a core ID, we have to assume that the CPU is its own physical core.
+			const std::pair<std::int64_t, std::int64_t> coreKey{ packageID, coreID.value_or(-1 - static_cast<std::int64_t>(cpuID)) };
+
+			// The first value is the (sparse) core index, and the second value is the number of
+			// logical processors found for that core so far.
+			const auto [itr, wasInserted] = coreKeyMap.try_emplace(coreKey, static_cast<std::uint32_t>(coreKeyMap.size()), 0);
+
+			// The NUMA node of a CPU is given by the name of a "nodeN" link within its directory.
+			// If there is no such link, then the kernel was built without NUMA support.
+			std::uint32_t nodeNumber = 0;
+			std::error_code errorCode{};
+
+			for (const auto& directoryEntry : std::filesystem::directory_iterator{ currCPUDirectory, errorCode })
+			{
+				const std::string entryName{ directoryEntry.path().filename().string() };
+
+				if (entryName.starts_with("node") && std::from_chars(entryName.data() + 4, entryName.data() + entryName.size(), nodeNumber).ec == std::errc{})
+					break;
+
+				nodeNumber = 0;
+			}
+
+			logicalProcessorArr.push_back(Brawler::LogicalProcessorInfo{
+				.ProcessorGroup = 0,
+				.ProcessorNumber = cpuID,
+				.PhysicalCoreIndex = itr->second.first,
+				.NUMANodeIndex = nodeNumber,
+				.SMTSiblingIndex = (itr->second.second)++
+			});
+		}
+
+		return logicalProcessorArr;
+	}
+#endif
+
+	std::vector<Brawler::LogicalProcessorInfo> CreateFallbackLogicalProcessors()
+	{
+		const std::uint32_t logicalProcessorCount = std::max<std::uint32_t>(std::thread::hardware_concurrency(), 1);
+
+		std::vector<Brawler::LogicalProcessorInfo> logicalProcessorArr{};
+		logicalProcessorArr.reserve(logicalProcessorCount);
+
+		for (std::uint32_t i = 0; i < logicalProcessorCount; ++i)
+		{
+#ifdef _WIN32
+			// Windows puts at most 64 logical processors into each processor group.
+			static constexpr std::uint32_t MAX_PROCESSORS_PER_GROUP = (sizeof(KAFFINITY) * 8);
+
+			const std::uint16_t processorGroup = static_cast<std::uint16_t>(i / MAX_PROCESSORS_PER_GROUP);
+			const std::uint32_t processorNumber = (i % MAX_PROCESSORS_PER_GROUP);
+#else
+			const std::uint16_t processorGroup = 0;
+			const std::uint32_t processorNumber = i;
+#endif
+
+			logicalProcessorArr.push_back(Brawler::LogicalProcessorInfo{
+				.ProcessorGroup = processorGroup,
+				.ProcessorNumber = processorNumber,
+				.PhysicalCoreIndex = i,
+				.NUMANodeIndex = 0,
+				.SMTSiblingIndex = 0
+			});
+		}
+
+		return logicalProcessorArr;
+	}
+}
+
+namespace Brawler
+{
+	CPUTopology CPUTopology::QuerySystemTopology()
+	{
+		CPUTopology topology{};
+		topology.mLogicalProcessorArr = QueryLogicalProcessors();
+
+		if (topology.mLogicalProcessorArr.empty()) [[unlikely]]
+			topology.mLogicalProcessorArr = CreateFallbackLogicalProcessors();
+
+		topology.FinalizeTopology();
+
+		return topology;
+	}
+
+	std::span<const LogicalProcessorInfo> CPUTopology::GetLogicalProcessors() const
+	{
+		return std::span<const LogicalProcessorInfo>{ mLogicalProcessorArr };
+	}
+
+	std::uint32_t CPUTopology::GetPhysicalCoreCount() const
+	{
+		return mPhysicalCoreCount;
+	}
+
+	std::uint32_t CPUTopology::GetNUMANodeCount() const
+	{
+		return mNUMANodeCount;
+	}
+
+	std::vector<LogicalProcessorInfo> CPUTopology::CreateThreadPlacement(const ThreadPlacementPolicy policy, const std::size_t threadCount) const
+	{
+		// FinalizeTopology() numbers the physical cores node by node, so the cores of each node
+		// have contiguous indices. We need the index of each core *within* its node in order to
+		// interleave the nodes.
+		std::vector<std::uint32_t> firstCoreIndexArr(mNUMANodeCount, mPhysicalCoreCount);
+
+		for (const auto& logicalProcessorInfo : mLogicalProcessorArr)
+			firstCoreIndexArr[logicalProcessorInfo.NUMANodeIndex] = std::min(firstCoreIndexArr[logicalProcessorInfo.NUMANodeIndex], logicalProcessorInfo.PhysicalCoreIndex);
+
+		const auto getCoreIndexWithinNode = [&firstCoreIndexArr] (const LogicalProcessorInfo& logicalProcessorInfo)
+		{
+			return (logicalProcessorInfo.PhysicalCoreIndex - firstCoreIndexArr[logicalProcessorInfo.NUMANodeIndex]);
+		};
+
+		std::vector<LogicalProcessorInfo> orderedProcessorArr{ mLogicalProcessorArr };
+
+		switch (policy)
+		{
+		case ThreadPlacementPolicy::PHYSICAL_CORES_FIRST:
+		{
+			std::ranges::stable_sort(orderedProcessorArr, [&getCoreIndexWithinNode] (const LogicalProcessorInfo& lhs, const LogicalProcessorInfo& rhs)
+			{
+				return (std::make_tuple(lhs.SMTSiblingIndex, getCoreIndexWithinNode(lhs), lhs.NUMANodeIndex) < std::make_tuple(rhs.SMTSiblingIndex, getCoreIndexWithinNode(rhs), rhs.NUMANodeIndex));
+			});
+
+			break;
+		}
+
+		case ThreadPlacementPolicy::NUMA_LOCAL:
+		{
+			std::ranges::stable_sort(orderedProcessorArr, [&getCoreIndexWithinNode] (const LogicalProcessorInfo& lhs, const LogicalProcessorInfo& rhs)
+			{
+				return (std::make_tuple(lhs.NUMANodeIndex, lhs.SMTSiblingIndex, getCoreIndexWithinNode(lhs)) < std::make_tuple(rhs.NUMANodeIndex, rhs.SMTSiblingIndex, getCoreIndexWithinNode(rhs)));
+			});
+
+			break;
+		}
+
+		case ThreadPlacementPolicy::COMPACT:
+		{
+			// mLogicalProcessorArr is already sorted this way.
+			break;
+		}
+
+		default:
+		{
+			assert(false && "ERROR: An invalid ThreadPlacementPolicy was specified in a call to CPUTopology::CreateThreadPlacement()!");
+			break;
+		}
+		}
+
+		std::vector<LogicalProcessorInfo> threadPlacementArr{};
+		threadPlacementArr.reserve(threadCount);
+
+		for (std::size_t i = 0; i < threadCount; ++i)
+			threadPlacementArr.push_back(orderedProcessorArr[i % orderedProcessorArr.size()]);
+
+		return threadPlacementArr;
+	}
+
+	void CPUTopology::FinalizeTopology()
+	{
+		// The OS is free to number its NUMA nodes and cores however it likes, so we compact
+		// the indices into the ranges [0, mNUMANodeCount) and [0, mPhysicalCoreCount).
+		std::vector<std::uint32_t> nodeNumberArr{};
+
+		for (const auto& logicalProcessorInfo : mLogicalProcessorArr)
+			nodeNumberArr.push_back(logicalProcessorInfo.NUMANodeIndex);
+
+		std::ranges::sort(nodeNumberArr);
+		nodeNumberArr.erase(std::unique(nodeNumberArr.begin(), nodeNumberArr.end()), nodeNumberArr.end());
+
+		for (auto& logicalProcessorInfo : mLogicalProcessorArr)
+			logicalProcessorInfo.NUMANodeIndex = static_cast<std::uint32_t>(std::ranges::lower_bound(nodeNumberArr, logicalProcessorInfo.NUMANodeIndex) - nodeNumberArr.begin());
+
+		std::ranges::sort(mLogicalProcessorArr, [] (const LogicalProcessorInfo& lhs, const LogicalProcessorInfo& rhs)
+		{
+			return (std::make_tuple(lhs.NUMANodeIndex, lhs.PhysicalCoreIndex, lhs.SMTSiblingIndex) < std::make_tuple(rhs.NUMANodeIndex, rhs.PhysicalCoreIndex, rhs.SMTSiblingIndex));
+		});
+
+		// Now that the logical processors are sorted, the logical processors of each core are
+		// adjacent, and the cores of each node are adjacent, too.
+		std::uint32_t currCoreIndex = 0;
+		std::uint32_t prevSparseCoreIndex = 0;
+
+		for (std::size_t i = 0; i < mLogicalProcessorArr.size(); ++i)
+		{
+			const std::uint32_t currSparseCoreIndex = mLogicalProcessorArr[i].PhysicalCoreIndex;
+
+			if (i > 0 && currSparseCoreIndex != prevSparseCoreIndex)
+				++currCoreIndex;
+
+			mLogicalProcessorArr[i].PhysicalCoreIndex = currCoreIndex;
+			prevSparseCoreIndex = currSparseCoreIndex;
+		}
+
+		mPhysicalCoreCount = (mLogicalProcessorArr.empty() ? 0 : (currCoreIndex + 1));
+		mNUMANodeCount = static_cast<std::uint32_t>(nodeNumberArr.size());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+module;
+#include <cstdint>
+#include <vector>
+#include <span>
+
+export module Brawler.CPUTopology;
+
+export namespace Brawler
+{
+	struct LogicalProcessorInfo
+	{
+		/// <summary>
+		/// The processor group which this logical processor belongs to. (See
+		/// https://docs.microsoft.com/en-us/windows/win32/procthread/processor-groups.) On
+		/// systems which do not have processor groups, this is always 0.
+		/// </summary>
+		std::uint16_t ProcessorGroup;
+
+		/// <summary>
+		/// On Windows, this is the index of the logical processor within its processor
+		/// group. Elsewhere, this is the ID which the OS uses for the CPU.
+		/// </summary>
+		std::uint32_t ProcessorNumber;
+
+		/// <summary>
+		/// Identifies the physical core which this logical processor belongs to. Logical
+		/// processors which share a core (i.e., SMT/hyperthread siblings) have the same value.
+		/// The values are in the range [0, CPUTopology::GetPhysicalCoreCount()).
+		/// </summary>
+		std::uint32_t PhysicalCoreIndex;
+
+		/// <summary>
+		/// Identifies the NUMA node which this logical processor belongs to. The values
+		/// are in the range [0, CPUTopology::GetNUMANodeCount()), so they do not necessarily
+		/// match the node numbers used by the OS.
+		/// </summary>
+		std::uint32_t NUMANodeIndex;
+
+		/// <summary>
+		/// This is 0 for the first logical processor of each physical core, 1 for its first
+		/// SMT sibling, and so on.
+		/// </summary>
+		std::uint32_t SMTSiblingIndex;
+	};
+
+	enum class ThreadPlacementPolicy
+	{
+		/// <summary>
+		/// Every thread is first placed on its own physical core, and the NUMA nodes are
+		/// used in a round-robin fashion. Only once every physical core has a thread are
+		/// SMT siblings used. This maximizes the compute resources and memory bandwidth
+		/// available to the threads, and it is usually what we want for the job system.
+		/// </summary>
+		PHYSICAL_CORES_FIRST,
+
+		/// <summary>
+		/// The threads are placed on as few NUMA nodes as possible. Within each node, every
+		/// physical core gets a thread before SMT siblings are used. This keeps the memory
+		/// accessed by the threads local to a single node, which is useful if the working set
+		/// is small or the number of threads is much lower than the number of cores.
+		/// </summary>
+		NUMA_LOCAL,
+
+		/// <summary>
+		/// The threads are placed on consecutive logical processors, so SMT siblings are
+		/// filled before moving on to the next physical core. This is how threads were
+		/// placed before CPUTopology existed. Threads which share a core also share its
+		/// caches, which can help if they mostly work on the same data.
+		/// </summary>
+		COMPACT,
+
+		COUNT
+	};
+
+	// The CPUTopology describes how the logical processors of the system are arranged into
+	// physical cores and NUMA nodes. Simply assigning one thread to each logical processor in
+	// order does not account for this: on a system with SMT, the first threads would all end
+	// up sharing cores with each other while other cores remain idle, and on a multi-socket
+	// system, threads would end up on whichever node happens to come first.
+
+	class CPUTopology
+	{
+	public:
+		CPUTopology() = default;
+
+		CPUTopology(const CPUTopology& rhs) = default;
+		CPUTopology& operator=(const CPUTopology& rhs) = default;
+
+		CPUTopology(CPUTopology&& rhs) noexcept = default;
+		CPUTopology& operator=(CPUTopology&& rhs) noexcept = default;
+
+		/// <summary>
+		/// Queries the OS for the topology of the logical processors which are available on
+		/// this system. On Windows, this uses GetLogicalProcessorInformationEx(); on Linux,
+		/// the information is read from /sys/devices/system/cpu.
+		///
+		/// If the topology cannot be determined, then every logical processor reported by
+		/// std::thread::hardware_concurrency() is treated as its own physical core on a single
+		/// NUMA node.
+		/// </summary>
+		static CPUTopology QuerySystemTopology();
+
+		std::span<const LogicalProcessorInfo> GetLogicalProcessors() const;
+		std::uint32_t GetPhysicalCoreCount() const;
+		std::uint32_t GetNUMANodeCount() const;
+
+		/// <summary>
+		/// Decides which logical processor each of threadCount threads should be locked to,
+		/// according to the specified ThreadPlacementPolicy. If there are more threads than
+		/// logical processors, then the placement wraps around, and multiple threads end up
+		/// sharing a logical processor.
+		/// </summary>
+		/// <param name="policy">
+		/// - The ThreadPlacementPolicy which determines the order in which the logical
+		///   processors are used.
+		/// </param>
+		/// <param name="threadCount">
+		/// - The number of threads which are to be placed.
+		/// </param>
+		/// <returns>
+		/// The function returns an array of threadCount elements, where the i-th element
+		/// describes the logical processor which the i-th thread should be locked to.
+		/// </returns>
+		std::vector<LogicalProcessorInfo> CreateThreadPlacement(const ThreadPlacementPolicy policy, const std::size_t threadCount) const;
+
+	private:
+		/// <summary>
+		/// Sorts mLogicalProcessorArr by NUMA node, physical core, and SMT sibling index
+		/// (in that order), and counts the physical cores and NUMA nodes. This expects
+		/// every field of every LogicalProcessorInfo to already be filled in, and the
+		/// NUMANodeIndex and PhysicalCoreIndex values may still be sparse.
+		/// </summary>
+		void FinalizeTopology();
+
+	private:
+		std::vector<LogicalProcessorInfo> mLogicalProcessorArr;
+		std::uint32_t mPhysicalCoreCount = 0;
+		std::uint32_t mNUMANodeCount = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,771 @@
+module;
+#include <cstdint>
+#include <cassert>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <latch>
+#include <array>
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <ranges>
+
+module Tests.ConcurrencyBenchmarks;
+import Brawler.ThreadSafeQueue;
+import Brawler.SegmentedThreadSafeQueue;
+import Brawler.ThreadSafeMap;
+import Brawler.ThreadSafeVector;
+import Brawler.CopyOnWriteVector;
+import Brawler.FastUnorderedMap;
+import Brawler.SortedVector;
+import Brawler.JobSystem;
+
+namespace
+{
+	// DISCLAIMER: Like the other tests in this project, these are not rigorous benchmarks. They
+	// are meant to catch regressions when the concurrency primitives are reworked, so what
+	// matters is that the numbers are comparable between builds on the same machine.
+
+	using Clock = std::chrono::steady_clock;
+
+	constexpr std::chrono::milliseconds MEASUREMENT_DURATION{ 250 };
+
+	// The thread counts go beyond the number of cores on most machines on purpose: the job
+	// queues are shared by every thread in the WorkerThreadPool, so we want to know how they
+	// behave under oversubscription, too.
+	constexpr std::array<std::uint32_t, 7> THREAD_COUNT_ARR{ 1, 2, 4, 8, 16, 32, 64 };
+
+	constexpr std::size_t QUEUE_SIZE = 1024;
+	constexpr std::size_t MAP_SIZE = (1 << 16);
+	constexpr std::array<float, 4> THREAD_SAFE_MAP_LOAD_FACTOR_ARR{ 0.25f, 0.5f, 0.75f, 0.9f };
+
+	// FastUnorderedMap re-hashes once its load factor exceeds 7/8, so there is no point in
+	// measuring anything higher than that.
+	constexpr std::array<float, 4> FAST_UNORDERED_MAP_LOAD_FACTOR_ARR{ 0.25f, 0.5f, 0.75f, 0.85f };
+
+	// This is roughly the number of I_PageableGPUObjects which the GPUResidencyManager iterates
+	// over every frame in a small scene.
+	constexpr std::size_t ITERATION_BENCHMARK_ELEMENT_COUNT = 512;
+	constexpr std::uint64_t ITERATIONS_PER_MODIFICATION = 64;
+
+	constexpr std::array<std::size_t, 3> SORTED_VECTOR_SIZE_ARR{ 100, 10000, 1000000 };
+	constexpr std::size_t MAX_SORTED_VECTOR_SINGLE_INSERT_SIZE = 10000;
+
+	constexpr std::size_t EMPTY_POP_ITERATION_COUNT = (1 << 22);
+	constexpr std::size_t AWAKE_DISPATCH_LATENCY_SAMPLE_COUNT = 2000;
+	constexpr std::size_t PARKED_DISPATCH_LATENCY_SAMPLE_COUNT = 200;
+	constexpr std::size_t JOB_THROUGHPUT_JOB_COUNT = (1 << 16);
+
+	struct BenchmarkResult
+	{
+		std::string_view Benchmark;
+		std::string_view Primitive;
+		std::string Parameter;
+		double Value;
+		std::string_view Unit;
+	};
+
+	class BenchmarkResultCollection
+	{
+	public:
+		BenchmarkResultCollection() = default;
+
+		void AddResult(BenchmarkResult&& result)
+		{
+			std::cout << result.Benchmark << " | " << result.Primitive << " | " << result.Parameter << ": " << result.Value << ' ' << result.Unit << std::endl;
+			mResultArr.push_back(std::move(result));
+		}
+
+		void WriteCSVFile(const std::filesystem::path& resultsFilePath) const
+		{
+			std::ofstream resultsFileStream{ resultsFilePath, std::ios::out | std::ios::trunc };
+			resultsFileStream << "Benchmark,Primitive,Parameter,Value,Unit\n";
+
+			for (const auto& result : mResultArr)
+				resultsFileStream << result.Benchmark << ',' << result.Primitive << ',' << result.Parameter << ',' << result.Value << ',' << result.Unit << '\n';
+		}
+
+	private:
+		std::vector<BenchmarkResult> mResultArr;
+	};
+
+	std::string CreateThreadCountParameter(const std::uint32_t numThreads)
+	{
+		return ("Threads=" + std::to_string(numThreads));
+	}
+
+	std::string CreateLoadFactorParameter(const float loadFactor)
+	{
+		return ("LoadFactor=" + std::to_string(static_cast<std::uint32_t>(loadFactor * 100.0f)) + "%");
+	}
+
+	std::uint64_t CreateKey(const std::uint64_t index)
+	{
+		// This is the SplitMix64 finalizer. It gives us well-distributed keys, so that the
+		// results do not depend on how good std::hash is for sequential integers.
+		std::uint64_t key = (index + 0x9E3779B97F4A7C15);
+		key = ((key ^ (key >> 30)) * 0xBF58476D1CE4E5B9);
+		key = ((key ^ (key >> 27)) * 0x94D049BB133111EB);
+
+		return (key ^ (key >> 31));
+	}
+
+	double GetElapsedNanoseconds(const Clock::time_point beginTime, const Clock::time_point endTime)
+	{
+		return std::chrono::duration<double, std::nano>{ endTime - beginTime }.count();
+	}
+
+	/// <summary>
+	/// Runs threadCallback on numThreads threads at once for MEASUREMENT_DURATION. Each thread
+	/// is passed its index and a flag which it must poll, and it returns the number of
+	/// operations which it completed.
+	/// </summary>
+	template <typename Callback>
+	std::vector<std::uint64_t> RunThreadsForDuration(const std::uint32_t numThreads, const Callback& threadCallback)
+	{
+		std::latch startLatch{ static_cast<std::ptrdiff_t>(numThreads) + 1 };
+		std::atomic<bool> keepRunning{ true };
+
+		std::vector<std::uint64_t> operationCountArr{};
+		operationCountArr.resize(numThreads);
+
+		{
+			std::vector<std::jthread> threadArr{};
+			threadArr.reserve(numThreads);
+
+			for (std::uint32_t i = 0; i < numThreads; ++i)
+			{
+				threadArr.emplace_back([&, i] ()
+				{
+					startLatch.arrive_and_wait();
+					operationCountArr[i] = threadCallback(i, keepRunning);
+				});
+			}
+
+			startLatch.arrive_and_wait();
+			std::this_thread::sleep_for(MEASUREMENT_DURATION);
+			keepRunning.store(false, std::memory_order::relaxed);
+
+			// The std::jthread instances are joined here.
+		}
+
+		return operationCountArr;
+	}
+
+	double CalculateOperationsPerSecond(const std::vector<std::uint64_t>& operationCountArr)
+	{
+		const std::uint64_t totalOperationCount = std::accumulate(operationCountArr.begin(), operationCountArr.end(), std::uint64_t{ 0 });
+		return (static_cast<double>(totalOperationCount) / std::chrono::duration<double>{ MEASUREMENT_DURATION }.count());
+	}
+
+	double CalculateJainFairnessIndex(const std::vector<std::uint64_t>& operationCountArr)
+	{
+		// Jain's fairness index is 1 if every thread got the same share of the operations, and
+		// it approaches 1/n as a single thread gets all of them.
+		double sum = 0.0;
+		double sumOfSquares = 0.0;
+
+		for (const auto operationCount : operationCountArr)
+		{
+			sum += static_cast<double>(operationCount);
+			sumOfSquares += (static_cast<double>(operationCount) * static_cast<double>(operationCount));
+		}
+
+		if (sumOfSquares == 0.0)
+			return 0.0;
+
+		return ((sum * sum) / (static_cast<double>(operationCountArr.size()) * sumOfSquares));
+	}
+
+	double GetPercentile(std::vector<double>& sampleArr, const double percentile)
+	{
+		assert(!sampleArr.empty());
+
+		const std::size_t sampleIndex = std::min(static_cast<std::size_t>(percentile * static_cast<double>(sampleArr.size())), (sampleArr.size() - 1));
+		std::ranges::nth_element(sampleArr, sampleArr.begin() + static_cast<std::ptrdiff_t>(sampleIndex));
+
+		return sampleArr[sampleIndex];
+	}
+
+	template <typename QueueType>
+	void RunQueueThroughputBenchmark(BenchmarkResultCollection& resultCollection, const std::string_view primitiveName, const auto& pushFunction)
+	{
+		for (const auto numThreads : THREAD_COUNT_ARR)
+		{
+			const std::unique_ptr<QueueType> queuePtr{ std::make_unique<QueueType>() };
+
+			// Start with the queue half full, so that pops usually succeed and pushes usually
+			// have room.
+			for (std::size_t i = 0; i < (QUEUE_SIZE / 2); ++i)
+				pushFunction(*queuePtr, i);
+
+			const std::vector<std::uint64_t> operationCountArr{ RunThreadsForDuration(numThreads, [&queuePtr, &pushFunction] (const std::uint32_t threadIndex, const std::atomic<bool>& keepRunning)
+			{
+				std::uint64_t numOperations = 0;
+
+				while (keepRunning.load(std::memory_order::relaxed))
+				{
+					if (pushFunction(*queuePtr, threadIndex))
+						++numOperations;
+
+					if (queuePtr->TryPop().has_value())
+						++numOperations;
+				}
+
+				return numOperations;
+			}) };
+
+			resultCollection.AddResult(BenchmarkResult{
+				.Benchmark = "Push/Pop Throughput",
+				.Primitive = primitiveName,
+				.Parameter{ CreateThreadCountParameter(numThreads) },
+				.Value = CalculateOperationsPerSecond(operationCountArr),
+				.Unit = "ops/s"
+			});
+		}
+	}
+
+	void RunQueueFairnessBenchmark(BenchmarkResultCollection& resultCollection)
+	{
+		using QueueType = Brawler::ThreadSafeQueue<std::uint64_t, QUEUE_SIZE>;
+
+		for (const auto numThreads : THREAD_COUNT_ARR)
+		{
+			// Half of the threads are producers, and the other half are consumers. A fair queue
+			// gives every producer and every consumer a similar share of the operations, even
+			// though they are all hammering the same indices.
+			if (numThreads < 2)
+				continue;
+
+			const std::unique_ptr<QueueType> queuePtr{ std::make_unique<QueueType>() };
+			const std::uint32_t numProducers = (numThreads / 2);
+
+			const std::vector<std::uint64_t> operationCountArr{ RunThreadsForDuration(numThreads, [&queuePtr, numProducers] (const std::uint32_t threadIndex, const std::atomic<bool>& keepRunning)
+			{
+				std::uint64_t numOperations = 0;
+				const bool isProducer = (threadIndex < numProducers);
+
+				while (keepRunning.load(std::memory_order::relaxed))
+				{
+					if (isProducer ? queuePtr->PushBack(static_cast<std::uint64_t>(threadIndex)) : queuePtr->TryPop().has_value())
+						++numOperations;
+				}
+
+				return numOperations;
+			}) };
+
+			const std::vector<std::uint64_t> producerCountArr{ operationCountArr.begin(), operationCountArr.begin() + numProducers };
+			const std::vector<std::uint64_t> consumerCountArr{ operationCountArr.begin() + numProducers, operationCountArr.end() };
+
+			resultCollection.AddResult(BenchmarkResult{
+				.Benchmark = "MPMC Producer Fairness (Jain Index)",
+				.Primitive = "ThreadSafeQueue",
+				.Parameter{ CreateThreadCountParameter(numThreads) },
+				.Value = CalculateJainFairnessIndex(producerCountArr),
+				.Unit = "index"
+			});
+
+			resultCollection.AddResult(BenchmarkResult{
+				.Benchmark = "MPMC Consumer Fairness (Jain Index)",
+				.Primitive = "ThreadSafeQueue",
+				.Parameter{ CreateThreadCountParameter(numThreads) },
+				.Value = CalculateJainFairnessIndex(consumerCountArr),
+				.Unit = "index"
+			});
+
+			const auto [minItr, maxItr] = std::ranges::minmax_element(operationCountArr);
+
+			resultCollection.AddResult(BenchmarkResult{
+				.Benchmark = "MPMC Min/Max Thread Operation Ratio",
+				.Primitive = "ThreadSafeQueue",
+				.Parameter{ CreateThreadCountParameter(numThreads) },
+				.Value = (*maxItr == 0 ? 0.0 : (static_cast<double>(*minItr) / static_cast<double>(*maxItr))),
+				.Unit = "ratio"
+			});
+		}
+	}
+
+	template <typename QueueType>
+	void RunEmptyQueuePopBenchmark(BenchmarkResultCollection& resultCollection, const std::string_view primitiveName)
+	{
+		const std::unique_ptr<QueueType> queuePtr{ std::make_unique<QueueType>() };
+		std::size_t numSuccessfulPops = 0;
+
+		const Clock::time_point beginTime = Clock::now();
+
+		for (std::size_t i = 0; i < EMPTY_POP_ITERATION_COUNT; ++i)
+		{
+			if (queuePtr->TryPop().has_value()) [[unlikely]]
+				++numSuccessfulPops;
+		}
+
+		const Clock::time_point endTime = Clock::now();
+
+		// Checking the result keeps the compiler from removing the loop.
+		assert(numSuccessfulPops == 0);
+
+		resultCollection.AddResult(BenchmarkResult{
+			.Benchmark = "Empty Queue Pop Cost",
+			.Primitive = primitiveName,
+			.Parameter{ CreateThreadCountParameter(1) },
+			.Value = (GetElapsedNanoseconds(beginTime, endTime) / static_cast<double>(EMPTY_POP_ITERATION_COUNT)),
+			.Unit = "ns/op"
+		});
+	}
+
+	void RunThreadSafeMapBenchmarks(BenchmarkResultCollection& resultCollection)
+	{
+		using MapType = Brawler::ThreadSafeMap<std::uint64_t, std::uint64_t, MAP_SIZE>;
+
+		for (const auto loadFactor : THREAD_SAFE_MAP_LOAD_FACTOR_ARR)
+		{
+			const std::unique_ptr<MapType> mapPtr{ std::make_unique<MapType>() };
+			const std::size_t numElements = static_cast<std::size_t>(loadFactor * static_cast<float>(MAP_SIZE));
+
+			const Clock::time_point insertBeginTime = Clock::now();
+
+			for (std::size_t i = 0; i < numElements; ++i)
+				(*mapPtr)[CreateKey(i)] = i;
+
+			const Clock::time_point insertEndTime = Clock::now();
+
+			resultCollection.AddResult(BenchmarkResult{
+				.Benchmark = "Map Insert Cost",
+				.Primitive = "ThreadSafeMap",
+				.Parameter{ CreateLoadFactorParameter(loadFactor) },
+				.Value = (GetElapsedNanoseconds(insertBeginTime, insertEndTime) / static_cast<double>(numElements)),
+				.Unit = "ns/op"
+			});
+
+			// ThreadSafeMap is meant to be read by many threads at once, so we measure the
+			// lookup throughput against the thread count, too.
+			for (const auto numThreads : THREAD_COUNT_ARR)
+			{
+				const std::vector<std::uint64_t> operationCountArr{ RunThreadsForDuration(numThreads, [&mapPtr, numElements] (const std::uint32_t threadIndex, const std::atomic<bool>& keepRunning)
+				{
+					std::uint64_t numOperations = 0;
+					std::uint64_t checksum = 0;
+					std::size_t currIndex = threadIndex;
+
+					while (keepRunning.load(std::memory_order::relaxed))
+					{
+						checksum += mapPtr->At(CreateKey(currIndex));
+						currIndex = ((currIndex + 1) % numElements);
+
+						++numOperations;
+					}
+
+					assert(checksum != std::numeric_limits<std::uint64_t>::max());
+					return numOperations;
+				}) };
+
+				resultCollection.AddResult(BenchmarkResult{
+					.Benchmark = "Map Lookup Throughput",
+					.Primitive = "ThreadSafeMap",
+					.Parameter{ CreateLoadFactorParameter(loadFactor) + ';' + CreateThreadCountParameter(numThreads) },
+					.Value = CalculateOperationsPerSecond(operationCountArr),
+					.Unit = "ops/s"
+				});
+			}
+		}
+	}
+
+	void RunFastUnorderedMapBenchmarks(BenchmarkResultCollection& resultCollection)
+	{
+		for (const auto loadFactor : FAST_UNORDERED_MAP_LOAD_FACTOR_ARR)
+		{
+			Brawler::FastUnorderedMap<std::uint64_t, std::uint64_t> fastMap{};
+			// FastUnorderedMap::Reserve() takes an element count, so this gives us exactly MAP_SIZE
+			// slots.
+			fastMap.Reserve((MAP_SIZE / 8) * 7);
+
+			const std::size_t numElements = static_cast<std::size_t>(loadFactor * static_cast<float>(MAP_SIZE));
+
+			const Clock::time_point insertBeginTime = Clock::now();
+
+			for (std::size_t i = 0; i < numElements; ++i)
+				fastMap.TryEmplace(CreateKey(i), i);
+
+			const Clock::time_point insertEndTime = Clock::now();
+
+			std::uint64_t checksum = 0;
+			const Clock::time_point lookupBeginTime = Clock::now();
+
+			for (std::size_t i = 0; i < numElements; ++i)
+				checksum += fastMap.At(CreateKey(i));
+
+			const Clock::time_point lookupEndTime = Clock::now();
+
+			// The keys for the misses come from a different part of the SplitMix64 sequence.
+			std::size_t numFoundMissingKeys = 0;
+			const Clock::time_point missBeginTime = Clock::now();
+
+			for (std::size_t i = 0; i < numElements; ++i)
+			{
+				if (fastMap.Contains(CreateKey(i + MAP_SIZE)))
+					++numFoundMissingKeys;
+			}
+
+			const Clock::time_point missEndTime = Clock::now();
+
+			assert(checksum == ((static_cast<std::uint64_t>(numElements) * (numElements - 1)) / 2));
+			assert(numFoundMissingKeys == 0);
+
+			resultCollection.AddResult(BenchmarkResult{
+				.Benchmark = "Map Insert Cost",
+				.Primitive = "FastUnorderedMap",
+				.Parameter{ CreateLoadFactorParameter(loadFactor) },
+				.Value = (GetElapsedNanoseconds(insertBeginTime, insertEndTime) / static_cast<double>(numElements)),
+				.Unit = "ns/op"
+			});
+
+			resultCollection.AddResult(BenchmarkResult{
+				.Benchmark = "Map Lookup Hit Cost",
+				.Primitive = "FastUnorderedMap",
+				.Parameter{ CreateLoadFactorParameter(loadFactor) },
+				.Value = (GetElapsedNanoseconds(lookupBeginTime, lookupEndTime) / static_cast<double>(numElements)),
+				.Unit = "ns/op"
+			});
+
+			resultCollection.AddResult(BenchmarkResult{
+				.Benchmark = "Map Lookup Miss Cost",
+				.Primitive = "FastUnorderedMap",
+				.Parameter{ CreateLoadFactorParameter(loadFactor) },
+				.Value = (GetElapsedNanoseconds(missBeginTime, missEndTime) / static_cast<double>(numElements)),
+				.Unit = "ns/op"
+			});
+		}
+	}
+
+	void RunSortedVectorBenchmarks(BenchmarkResultCollection& resultCollection)
+	{
+		for (const std::size_t numElements : SORTED_VECTOR_SIZE_ARR)
+		{
+			const std::string sizeParameter{ "Size=" + std::to_string(numElements) };
+
+			const auto addResultLambda = [&resultCollection, &sizeParameter] (const std::string_view benchmarkName, const std::string_view primitiveName, const Clock::time_point beginTime, const Clock::time_point endTime, const std::size_t numOperations)
+			{
+				resultCollection.AddResult(BenchmarkResult{
+					.Benchmark = benchmarkName,
+					.Primitive = primitiveName,
+					.Parameter{ sizeParameter },
+					.Value = (GetElapsedNanoseconds(beginTime, endTime) / static_cast<double>(numOperations)),
+					.Unit = "ns/op"
+				});
+			};
+
+			std::vector<std::uint64_t> keyArr{};
+			keyArr.reserve(numElements);
+
+			for (std::size_t i = 0; i < numElements; ++i)
+				keyArr.push_back(CreateKey(i));
+
+			// Inserting random keys one at a time is O(N^2), so we only do this for the smaller
+			// sizes. Otherwise, this one benchmark would take longer than all of the others
+			// combined.
+			if (numElements <= MAX_SORTED_VECTOR_SINGLE_INSERT_SIZE)
+			{
+				Brawler::SortedVector<std::uint64_t> singleInsertVector{};
+				singleInsertVector.Reserve(numElements);
+
+				const Clock::time_point insertBeginTime = Clock::now();
+
+				for (const auto key : keyArr)
+					singleInsertVector.Insert(key);
+
+				const Clock::time_point insertEndTime = Clock::now();
+				assert(singleInsertVector.GetSize() == numElements);
+
+				addResultLambda("Insert Cost", "SortedVector::Insert()", insertBeginTime, insertEndTime, numElements);
+			}
+
+			Brawler::SortedVector<std::uint64_t> sortedVector{};
+
+			{
+				const Clock::time_point insertBeginTime = Clock::now();
+				sortedVector.InsertRange(keyArr);
+				const Clock::time_point insertEndTime = Clock::now();
+
+				assert(sortedVector.GetSize() == numElements);
+				assert(std::ranges::is_sorted(sortedVector.CreateSpan()));
+
+				addResultLambda("Insert Cost", "SortedVector::InsertRange()", insertBeginTime, insertEndTime, numElements);
+			}
+
+			{
+				std::size_t numFoundKeys = 0;
+				const Clock::time_point lookupBeginTime = Clock::now();
+
+				for (const auto key : keyArr)
+				{
+					if (sortedVector.Contains(key))
+						++numFoundKeys;
+				}
+
+				const Clock::time_point lookupEndTime = Clock::now();
+				assert(numFoundKeys == numElements);
+
+				addResultLambda("Lookup Hit Cost", "SortedVector", lookupBeginTime, lookupEndTime, numElements);
+			}
+
+			{
+				// This is what SortedVector::Contains() used to do, so that we can see what the
+				// branchless search buys us.
+				const std::span<const std::uint64_t> sortedKeySpan{ sortedVector.CreateSpan() };
+				std::size_t numFoundKeys = 0;
+				const Clock::time_point lookupBeginTime = Clock::now();
+
+				for (const auto key : keyArr)
+				{
+					if (std::ranges::binary_search(sortedKeySpan, key))
+						++numFoundKeys;
+				}
+
+				const Clock::time_point lookupEndTime = Clock::now();
+				assert(numFoundKeys == numElements);
+
+				addResultLambda("Lookup Hit Cost", "std::ranges::binary_search()", lookupBeginTime, lookupEndTime, numElements);
+			}
+
+			// The second set shares half of its keys with the first one.
+			Brawler::SortedVector<std::uint64_t> otherSortedVector{};
+			otherSortedVector.InsertRange(std::views::iota(numElements / 2, numElements + (numElements / 2)) | std::views::transform([] (const std::size_t index) { return CreateKey(index); }));
+
+			const std::size_t numSharedKeys = (numElements - (numElements / 2));
+
+			{
+				const Clock::time_point unionBeginTime = Clock::now();
+				const Brawler::SortedVector<std::uint64_t> unionSet{ sortedVector.Union(otherSortedVector) };
+				const Clock::time_point unionEndTime = Clock::now();
+
+				assert(unionSet.GetSize() == ((numElements * 2) - numSharedKeys));
+				addResultLambda("Union Cost", "SortedVector", unionBeginTime, unionEndTime, (numElements * 2));
+			}
+
+			{
+				const Clock::time_point intersectionBeginTime = Clock::now();
+				const Brawler::SortedVector<std::uint64_t> intersectionSet{ sortedVector.Intersection(otherSortedVector) };
+				const Clock::time_point intersectionEndTime = Clock::now();
+
+				assert(intersectionSet.GetSize() == numSharedKeys);
+				addResultLambda("Intersection Cost", "SortedVector", intersectionBeginTime, intersectionEndTime, (numElements * 2));
+			}
+
+			{
+				const Clock::time_point differenceBeginTime = Clock::now();
+				const Brawler::SortedVector<std::uint64_t> differenceSet{ sortedVector.Difference(otherSortedVector) };
+				const Clock::time_point differenceEndTime = Clock::now();
+
+				assert(differenceSet.GetSize() == (numElements - numSharedKeys));
+				addResultLambda("Difference Cost", "SortedVector", differenceBeginTime, differenceEndTime, (numElements * 2));
+			}
+		}
+	}
+
+	void RunThreadSafeVectorBenchmarks(BenchmarkResultCollection& resultCollection)
+	{
+		for (const auto numThreads : THREAD_COUNT_ARR)
+		{
+			// Every thread appends elements, and every 16th operation is a read of an earlier
+			// element. This roughly matches how ThreadSafeVector is used to collect results
+			// from multiple jobs.
+			Brawler::ThreadSafeVector<std::uint64_t> threadSafeVector{};
+
+			const std::vector<std::uint64_t> operationCountArr{ RunThreadsForDuration(numThreads, [&threadSafeVector] (const std::uint32_t threadIndex, const std::atomic<bool>& keepRunning)
+			{
+				std::uint64_t numOperations = 0;
+				std::uint64_t checksum = 0;
+
+				while (keepRunning.load(std::memory_order::relaxed))
+				{
+					if ((numOperations % 16) == 15)
+						threadSafeVector.AccessData(0, [&checksum] (const std::uint64_t value) { checksum += value; });
+					else
+						threadSafeVector.PushBack(static_cast<std::uint64_t>(threadIndex));
+
+					++numOperations;
+				}
+
+				assert(checksum != std::numeric_limits<std::uint64_t>::max());
+				return numOperations;
+			}) };
+
+			resultCollection.AddResult(BenchmarkResult{
+				.Benchmark = "Append/Read Throughput",
+				.Primitive = "ThreadSafeVector",
+				.Parameter{ CreateThreadCountParameter(numThreads) },
+				.Value = CalculateOperationsPerSecond(operationCountArr),
+				.Unit = "ops/s"
+			});
+		}
+	}
+
+	template <typename VectorType>
+	void RunVectorIterationBenchmark(BenchmarkResultCollection& resultCollection, const std::string_view primitiveName)
+	{
+		for (const auto numThreads : THREAD_COUNT_ARR)
+		{
+			VectorType vector{};
+
+			for (std::size_t i = 0; i < ITERATION_BENCHMARK_ELEMENT_COUNT; ++i)
+				vector.PushBack(static_cast<std::uint64_t>(i));
+
+			// Every thread iterates over the whole vector, and the first thread also adds and
+			// removes an element once every ITERATIONS_PER_MODIFICATION iterations. This is how
+			// the registries which are iterated over every frame are used.
+			const std::vector<std::uint64_t> operationCountArr{ RunThreadsForDuration(numThreads, [&vector] (const std::uint32_t threadIndex, const std::atomic<bool>& keepRunning)
+			{
+				std::uint64_t numIterations = 0;
+				std::uint64_t checksum = 0;
+
+				while (keepRunning.load(std::memory_order::relaxed))
+				{
+					if (threadIndex == 0 && (numIterations % ITERATIONS_PER_MODIFICATION) == 0)
+					{
+						const std::uint64_t addedValue = (ITERATION_BENCHMARK_ELEMENT_COUNT + numIterations);
+
+						vector.PushBack(addedValue);
+						vector.EraseIf([addedValue] (const std::uint64_t value) { return (value == addedValue); });
+					}
+
+					vector.ForEach([&checksum] (const std::uint64_t value) { checksum += value; });
+					++numIterations;
+				}
+
+				assert(checksum != std::numeric_limits<std::uint64_t>::max());
+				return numIterations;
+			}) };
+
+			resultCollection.AddResult(BenchmarkResult{
+				.Benchmark = "Iteration Throughput",
+				.Primitive = primitiveName,
+				.Parameter{ CreateThreadCountParameter(numThreads) },
+				.Value = CalculateOperationsPerSecond(operationCountArr),
+				.Unit = "iterations/s"
+			});
+		}
+	}
+
+	void RunJobDispatchLatencyBenchmark(BenchmarkResultCollection& resultCollection, const std::string_view modeName, const std::size_t numSamples, const std::chrono::microseconds delayBetweenSamples)
+	{
+		std::vector<double> latencySampleArr{};
+		latencySampleArr.reserve(numSamples);
+
+		for (std::size_t i = 0; i < numSamples; ++i)
+		{
+			// If we wait long enough between samples, then the worker threads will have parked
+			// themselves, and we measure how long it takes to wake one up.
+			if (delayBetweenSamples.count() > 0)
+				std::this_thread::sleep_for(delayBetweenSamples);
+
+			std::atomic<bool> hasJobStarted{ false };
+			Clock::time_point jobStartTime{};
+
+			Brawler::JobGroup latencyGroup{};
+			latencyGroup.AddJob([&hasJobStarted, &jobStartTime] ()
+			{
+				jobStartTime = Clock::now();
+				hasJobStarted.store(true, std::memory_order::release);
+			});
+
+			const Clock::time_point dispatchTime = Clock::now();
+			latencyGroup.ExecuteJobsAsync();
+
+			// We deliberately do *NOT* help execute jobs here. The job was pushed into this thread's
+			// local deque, and we want to measure how long it takes for a worker thread to pick it
+			// up.
+			while (!hasJobStarted.load(std::memory_order::acquire))
+				std::this_thread::yield();
+
+			latencySampleArr.push_back(GetElapsedNanoseconds(dispatchTime, jobStartTime) / 1000.0);
+		}
+
+		const std::string modeParameter{ "Mode=" + std::string{ modeName } };
+
+		resultCollection.AddResult(BenchmarkResult{
+			.Benchmark = "Job Dispatch Latency (Median)",
+			.Primitive = "WorkerThreadPool",
+			.Parameter{ modeParameter },
+			.Value = GetPercentile(latencySampleArr, 0.5),
+			.Unit = "us"
+		});
+
+		resultCollection.AddResult(BenchmarkResult{
+			.Benchmark = "Job Dispatch Latency (P99)",
+			.Primitive = "WorkerThreadPool",
+			.Parameter{ modeParameter },
+			.Value = GetPercentile(latencySampleArr, 0.99),
+			.Unit = "us"
+		});
+	}
+
+	void RunJobThroughputBenchmark(BenchmarkResultCollection& resultCollection)
+	{
+		std::atomic<std::uint64_t> numExecutedJobs{ 0 };
+
+		Brawler::JobGroup throughputGroup{};
+		throughputGroup.Reserve(JOB_THROUGHPUT_JOB_COUNT);
+
+		for (std::size_t i = 0; i < JOB_THROUGHPUT_JOB_COUNT; ++i)
+			throughputGroup.AddJob([&numExecutedJobs] () { numExecutedJobs.fetch_add(1, std::memory_order::relaxed); });
+
+		const Clock::time_point beginTime = Clock::now();
+		throughputGroup.ExecuteJobs();
+		const Clock::time_point endTime = Clock::now();
+
+		assert(numExecutedJobs.load() == JOB_THROUGHPUT_JOB_COUNT);
+
+		resultCollection.AddResult(BenchmarkResult{
+			.Benchmark = "Empty Job Throughput",
+			.Primitive = "WorkerThreadPool",
+			.Parameter{ "Jobs=" + std::to_string(JOB_THROUGHPUT_JOB_COUNT) },
+			.Value = (static_cast<double>(JOB_THROUGHPUT_JOB_COUNT) / (GetElapsedNanoseconds(beginTime, endTime) / 1e9)),
+			.Unit = "jobs/s"
+		});
+	}
+}
+
+namespace Tests
+{
+	void RunConcurrencyBenchmarks(const std::filesystem::path& resultsFilePath)
+	{
+		std::cout << "Beginning concurrency benchmarks...\n" << std::endl;
+
+		BenchmarkResultCollection resultCollection{};
+
+		using JobQueueType = Brawler::ThreadSafeQueue<std::uint64_t, QUEUE_SIZE>;
+		using OverflowQueueType = Brawler::SegmentedThreadSafeQueue<std::uint64_t, QUEUE_SIZE>;
+
+		RunQueueThroughputBenchmark<JobQueueType>(resultCollection, "ThreadSafeQueue", [] (JobQueueType& queue, const std::uint64_t value) { return queue.PushBack(value); });
+		RunQueueThroughputBenchmark<OverflowQueueType>(resultCollection, "SegmentedThreadSafeQueue", [] (OverflowQueueType& queue, const std::uint64_t value) { queue.PushBack(value); return true; });
+		RunQueueFairnessBenchmark(resultCollection);
+
+		RunEmptyQueuePopBenchmark<JobQueueType>(resultCollection, "ThreadSafeQueue");
+		RunEmptyQueuePopBenchmark<OverflowQueueType>(resultCollection, "SegmentedThreadSafeQueue");
+
+		RunThreadSafeMapBenchmarks(resultCollection);
+		RunFastUnorderedMapBenchmarks(resultCollection);
+		RunSortedVectorBenchmarks(resultCollection);
+		RunThreadSafeVectorBenchmarks(resultCollection);
+		RunVectorIterationBenchmark<Brawler::ThreadSafeVector<std::uint64_t, std::shared_mutex>>(resultCollection, "ThreadSafeVector (std::shared_mutex)");
+		RunVectorIterationBenchmark<Brawler::CopyOnWriteVector<std::uint64_t>>(resultCollection, "CopyOnWriteVector");
+
+		RunJobDispatchLatencyBenchmark(resultCollection, "Awake", AWAKE_DISPATCH_LATENCY_SAMPLE_COUNT, std::chrono::microseconds{ 0 });
+		RunJobDispatchLatencyBenchmark(resultCollection, "Parked", PARKED_DISPATCH_LATENCY_SAMPLE_COUNT, std::chrono::microseconds{ 10000 });
+		RunJobThroughputBenchmark(resultCollection);
+
+		resultCollection.WriteCSVFile(resultsFilePath);
+
+		std::cout << "\nConcurrency benchmarks completed. Results were written to " << resultsFilePath.string() << '.' << std::endl;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+module;
+#include <filesystem>
+
+export module Tests.ConcurrencyBenchmarks;
+
+export namespace Tests
+{
+	/// <summary>
+	/// Runs the microbenchmarks for the concurrency primitives (ThreadSafeQueue,
+	/// SegmentedThreadSafeQueue, ThreadSafeMap, ThreadSafeVector, CopyOnWriteVector, FastUnorderedMap,
+	/// SortedVector) and for the WorkerThreadPool. The results are written to std::cout, and they are
+	/// also written to resultsFilePath as CSV with the columns Benchmark, Primitive, Parameter,
+	/// Value and Unit, so that results from different builds can be compared by a script.
+	/// 
+	/// The WorkerThreadPool benchmarks must be run from the main thread after the
+	/// WorkerThreadPool has been initialized.
+	/// </summary>
+	/// <param name="resultsFilePath">
+	/// - The path of the CSV file which the results are to be written to. If the file
+	///   already exists, then it is overwritten.
+	/// </param>
+	void RunConcurrencyBenchmarks(const std::filesystem::path& resultsFilePath);
+}
\ No newline at end of file
@@ -0,0 +1,694 @@
+module;
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <bit>
+#include <limits>
+#include <thread>
+#include <algorithm>
+#include <concepts>
+
+export module Brawler.ConcurrentHashMap;
+import Brawler.EpochReclamation;
+import Brawler.Functional;
+
+namespace Brawler
+{
+	namespace IMPL
+	{
+		static constexpr std::size_t CONCURRENT_HASH_MAP_MIN_CAPACITY = 16;
+
+		// When a ConcurrentHashMap grows, its slots are moved to the new table in chunks of this
+		// many slots. Every thread which wants to modify the map while this is happening claims
+		// chunks until none are left, so the work is spread across every writer.
+		static constexpr std::size_t CONCURRENT_HASH_MAP_MIGRATION_CHUNK_SIZE = 256;
+
+		// A table is replaced once 3/4 of its slots have been claimed. Slots are claimed by keys
+		// permanently (see below), so this includes the slots of erased keys.
+		static constexpr std::size_t CONCURRENT_HASH_MAP_MAX_LOAD_NUMERATOR = 3;
+		static constexpr std::size_t CONCURRENT_HASH_MAP_MAX_LOAD_DENOMINATOR = 4;
+
+		// Each slot contains a pointer to a node, with two flags stored in the lower bits:
+		//
+		//   - SLOT_FLAG_DELETED: The key in the node was erased. The node stays in the slot, since
+		//     the slot still belongs to this key; if the key is inserted again, then the new node
+		//     replaces this one.
+		//
+		//   - SLOT_FLAG_FROZEN: The table is being migrated, and the slot has already been copied
+		//     to the new table. Nobody may modify the slot anymore, and readers which need this
+		//     slot must continue their search in the new table.
+		static constexpr std::uintptr_t SLOT_FLAG_DELETED = 0x1;
+		static constexpr std::uintptr_t SLOT_FLAG_FROZEN = 0x2;
+		static constexpr std::uintptr_t SLOT_POINTER_MASK = ~(SLOT_FLAG_DELETED | SLOT_FLAG_FROZEN);
+
+		inline std::uint64_t MixKeyHash(std::uint64_t hashValue)
+		{
+			// std::hash is allowed to be the identity function for integers and pointers, which
+			// would be terrible for linear probing with a power-of-two table size.
+			hashValue ^= (hashValue >> 33);
+			hashValue *= 0xFF51AFD7ED558CCD;
+			hashValue ^= (hashValue >> 33);
+
+			return hashValue;
+		}
+	}
+}
+
+export namespace Brawler
+{
+	// Brawler::ConcurrentHashMap is a hash map which can be read and modified by any number of
+	// threads at once. Unlike Brawler::ThreadSafeMap, it grows as needed, and erased elements
+	// are actually destroyed.
+	//
+	//   - Lookups are lock-free. They never write to shared memory, and they never wait for
+	//     other threads, even while the map is growing.
+	//
+	//   - Insertions, assignments and erasures are lock-free, too, except while the map is
+	//     growing. When a thread finds that the map needs to grow, it allocates a new table, and
+	//     from then on, every thread which wants to modify the map helps move the slots of the
+	//     old table over before it continues. It only waits if the remaining slots are already
+	//     being moved by other threads.
+	//
+	//   - Elements are stored in immutable nodes. Assigning a new value replaces the node, and
+	//     erasing a key only marks its node as deleted. Replaced nodes, nodes of erased keys
+	//     and old tables are deleted through epoch-based reclamation (see EpochReclamation.ixx),
+	//     so a thread reading an element can never have it deleted from under it. For the same
+	//     reason, the map never hands out references to its values; they can only be accessed
+	//     through a copy or within a callback.
+	//
+	// Erased keys keep their slot until the next time the table is replaced, at which point
+	// they are dropped. If a map sees lots of keys which are inserted and erased again, then it
+	// will periodically be re-built at the same size.
+
+	template <typename Key, typename Value, typename Hasher = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	class ConcurrentHashMap
+	{
+	private:
+		struct MapNode
+		{
+			template <typename... Args>
+			MapNode(const std::uint64_t keyHash, const Key& key, Args&&... args) :
+				KeyHash(keyHash),
+				NodeKey(key),
+				NodeValue{ std::forward<Args>(args)... }
+			{}
+
+			const std::uint64_t KeyHash;
+			const Key NodeKey;
+			const Value NodeValue;
+		};
+
+		// The lower two bits of a node's address are used for the slot flags.
+		static_assert(alignof(MapNode) >= 4);
+
+		struct HashTable
+		{
+			explicit HashTable(const std::size_t capacity) :
+				Capacity(capacity),
+				SlotArr(std::make_unique<std::atomic<std::uintptr_t>[]>(capacity)),
+				ClaimedSlotCount(0),
+				NextTablePtr(nullptr),
+				NextMigrationChunkIndex(0),
+				MigratedChunkCount(0)
+			{}
+
+			const std::size_t Capacity;
+			std::unique_ptr<std::atomic<std::uintptr_t>[]> SlotArr;
+			std::atomic<std::size_t> ClaimedSlotCount;
+
+			std::atomic<HashTable*> NextTablePtr;
+			std::atomic<std::size_t> NextMigrationChunkIndex;
+			std::atomic<std::size_t> MigratedChunkCount;
+		};
+
+		enum class WriteOperation
+		{
+			TRY_EMPLACE,
+			INSERT_OR_ASSIGN,
+			ERASE
+		};
+
+	public:
+		explicit ConcurrentHashMap(const std::size_t expectedSize = 0);
+		~ConcurrentHashMap();
+
+		ConcurrentHashMap(const ConcurrentHashMap& rhs) = delete;
+		ConcurrentHashMap& operator=(const ConcurrentHashMap& rhs) = delete;
+
+		ConcurrentHashMap(ConcurrentHashMap&& rhs) noexcept = delete;
+		ConcurrentHashMap& operator=(ConcurrentHashMap&& rhs) noexcept = delete;
+
+		/// <summary>
+		/// Inserts an element constructed from args for key, but only if key is not already
+		/// in the map.
+		/// </summary>
+		/// <returns>
+		/// The function returns true if the element was inserted and false otherwise.
+		/// </returns>
+		template <typename... Args>
+			requires requires (Args&&... args)
+		{
+			Value{ std::forward<Args>(args)... };
+		}
+		bool TryEmplace(const Key& key, Args&&... args);
+
+		/// <summary>
+		/// Associates value with key, replacing the existing value if there is one. Threads
+		/// which are currently reading the old value can continue to do so safely.
+		/// </summary>
+		/// <returns>
+		/// The function returns true if key was not previously in the map and false if an
+		/// existing value was replaced.
+		/// </returns>
+		template <typename U>
+			requires std::constructible_from<Value, U&&>
+		bool InsertOrAssign(const Key& key, U&& value);
+
+		/// <summary>
+		/// Removes key from the map. The value is destroyed once either the key is inserted
+		/// again or the table is re-built, and no thread can be reading it anymore.
+		/// </summary>
+		/// <returns>
+		/// The function returns true if key was in the map and false otherwise.
+		/// </returns>
+		bool Erase(const Key& key);
+
+		/// <summary>
+		/// Returns a copy of the value associated with key, or an empty std::optional if key
+		/// is not in the map.
+		/// </summary>
+		std::optional<Value> TryGet(const Key& key) const requires std::copy_constructible<Value>;
+
+		/// <summary>
+		/// If key is in the map, then callback is called with a const reference to its value,
+		/// and the function returns true. The reference must not be used after callback
+		/// returns. The callback should be short, since it delays the reclamation of memory
+		/// for every lock-free data structure in the program.
+		/// </summary>
+		template <Brawler::Function<void, const Value&> Callback>
+		bool Visit(const Key& key, const Callback& callback) const;
+
+		bool Contains(const Key& key) const;
+
+		/// <summary>
+		/// Calls callback once for every value in the map. Elements which are inserted, assigned
+		/// or erased by other threads during the call may or may not be visited.
+		/// </summary>
+		template <Brawler::Function<void, const Value&> Callback>
+		void ForEach(const Callback& callback) const;
+
+		/// <summary>
+		/// Gets the number of elements in the map. If other threads are modifying the map at
+		/// the same time, then the returned value is only approximate.
+		/// </summary>
+		std::size_t GetSize() const;
+
+	private:
+		static std::uint64_t HashKey(const Key& key);
+		static MapNode* GetNodePointer(const std::uintptr_t slotValue);
+
+		static constexpr std::size_t GetMaxClaimedSlotCount(const std::size_t capacity);
+		static constexpr std::size_t GetRequiredCapacity(const std::size_t elementCount);
+
+		/// <summary>
+		/// Finds the node for key. The caller must have an active Brawler::EpochGuard, and the
+		/// returned node is only valid until that guard is destroyed.
+		/// </summary>
+		const MapNode* FindNode(const Key& key, const std::uint64_t keyHash) const;
+
+		template <WriteOperation Operation>
+		bool WriteElement(const Key& key, const std::uint64_t keyHash, MapNode* const newNodePtr);
+
+		void BeginMigration(HashTable& oldTable);
+
+		/// <summary>
+		/// Moves slots from oldTable to its next table until none are left and then waits
+		/// for every other thread migrating slots to finish. Afterwards, the next table is made
+		/// the current table.
+		/// </summary>
+		/// <returns>
+		/// The function returns a pointer to the table which replaced oldTable.
+		/// </returns>
+		HashTable* HelpMigration(HashTable& oldTable);
+
+		static void MigrateSlot(HashTable& oldTable, HashTable& newTable, const std::size_t slotIndex);
+		static std::size_t PlaceMigratedNode(HashTable& newTable, MapNode* const nodePtr);
+
+	private:
+		std::atomic<HashTable*> mCurrTablePtr;
+		std::atomic<std::size_t> mNumExistingElements;
+
+		inline static Hasher mHasher = Hasher{};
+		inline static KeyEqual mKeyEqual = KeyEqual{};
+	};
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+
+namespace Brawler
+{
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::ConcurrentHashMap(const std::size_t expectedSize) :
+		mCurrTablePtr(new HashTable{ GetRequiredCapacity(expectedSize) }),
+		mNumExistingElements(0)
+	{}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::~ConcurrentHashMap()
+	{
+		// No other thread may be using the map at this point. A table can still have a
+		// finished migration which nobody got around to making current, though. In that case,
+		// every node which is still in use can be found in the last table of the chain, and the
+		// earlier tables only contain pointers to those same nodes.
+		HashTable* currTablePtr = mCurrTablePtr.load(std::memory_order::acquire);
+		HashTable* lastTablePtr = currTablePtr;
+
+		while (lastTablePtr->NextTablePtr.load(std::memory_order::acquire) != nullptr)
+			lastTablePtr = lastTablePtr->NextTablePtr.load(std::memory_order::acquire);
+
+		for (std::size_t i = 0; i < lastTablePtr->Capacity; ++i)
+			delete GetNodePointer(lastTablePtr->SlotArr[i].load(std::memory_order::relaxed));
+
+		while (currTablePtr != nullptr)
+		{
+			HashTable* const nextTablePtr = currTablePtr->NextTablePtr.load(std::memory_order::relaxed);
+			delete currTablePtr;
+
+			currTablePtr = nextTablePtr;
+		}
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	template <typename... Args>
+		requires requires (Args&&... args)
+	{
+		Value{ std::forward<Args>(args)... };
+	}
+	bool ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::TryEmplace(const Key& key, Args&&... args)
+	{
+		const std::uint64_t keyHash = HashKey(key);
+
+		// Don't bother allocating a node if the key is already present.
+		{
+			const EpochGuard guard{};
+
+			if (FindNode(key, keyHash) != nullptr)
+				return false;
+		}
+
+		return WriteElement<WriteOperation::TRY_EMPLACE>(key, keyHash, new MapNode{ keyHash, key, std::forward<Args>(args)... });
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	template <typename U>
+		requires std::constructible_from<Value, U&&>
+	bool ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::InsertOrAssign(const Key& key, U&& value)
+	{
+		const std::uint64_t keyHash = HashKey(key);
+		return WriteElement<WriteOperation::INSERT_OR_ASSIGN>(key, keyHash, new MapNode{ keyHash, key, std::forward<U>(value) });
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	bool ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::Erase(const Key& key)
+	{
+		return WriteElement<WriteOperation::ERASE>(key, HashKey(key), nullptr);
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	std::optional<Value> ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::TryGet(const Key& key) const requires std::copy_constructible<Value>
+	{
+		const EpochGuard guard{};
+		const MapNode* const nodePtr = FindNode(key, HashKey(key));
+
+		if (nodePtr == nullptr)
+			return std::optional<Value>{};
+
+		return std::optional<Value>{ nodePtr->NodeValue };
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	template <Brawler::Function<void, const Value&> Callback>
+	bool ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::Visit(const Key& key, const Callback& callback) const
+	{
+		const EpochGuard guard{};
+		const MapNode* const nodePtr = FindNode(key, HashKey(key));
+
+		if (nodePtr == nullptr)
+			return false;
+
+		callback(nodePtr->NodeValue);
+		return true;
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	bool ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::Contains(const Key& key) const
+	{
+		const EpochGuard guard{};
+		return (FindNode(key, HashKey(key)) != nullptr);
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	template <Brawler::Function<void, const Value&> Callback>
+	void ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::ForEach(const Callback& callback) const
+	{
+		const EpochGuard guard{};
+		const HashTable& currTable{ *(mCurrTablePtr.load(std::memory_order::acquire)) };
+
+		// If the table is being migrated, then its frozen slots still contain the same nodes as
+		// the new table, since nobody can modify the new table until the migration is finished.
+		for (std::size_t i = 0; i < currTable.Capacity; ++i)
+		{
+			const std::uintptr_t slotValue = currTable.SlotArr[i].load(std::memory_order::acquire);
+			const MapNode* const nodePtr = GetNodePointer(slotValue);
+
+			if (nodePtr != nullptr && (slotValue & IMPL::SLOT_FLAG_DELETED) == 0)
+				callback(nodePtr->NodeValue);
+		}
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	std::size_t ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::GetSize() const
+	{
+		return mNumExistingElements.load(std::memory_order::relaxed);
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	std::uint64_t ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::HashKey(const Key& key)
+	{
+		return IMPL::MixKeyHash(static_cast<std::uint64_t>(mHasher(key)));
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	typename ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::MapNode* ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::GetNodePointer(const std::uintptr_t slotValue)
+	{
+		return reinterpret_cast<MapNode*>(slotValue & IMPL::SLOT_POINTER_MASK);
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	constexpr std::size_t ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::GetMaxClaimedSlotCount(const std::size_t capacity)
+	{
+		return ((capacity / IMPL::CONCURRENT_HASH_MAP_MAX_LOAD_DENOMINATOR) * IMPL::CONCURRENT_HASH_MAP_MAX_LOAD_NUMERATOR);
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	constexpr std::size_t ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::GetRequiredCapacity(const std::size_t elementCount)
+	{
+		const std::size_t minimumCapacity = (((elementCount * IMPL::CONCURRENT_HASH_MAP_MAX_LOAD_DENOMINATOR) + IMPL::CONCURRENT_HASH_MAP_MAX_LOAD_NUMERATOR - 1) / IMPL::CONCURRENT_HASH_MAP_MAX_LOAD_NUMERATOR);
+		return std::bit_ceil(std::max(minimumCapacity, IMPL::CONCURRENT_HASH_MAP_MIN_CAPACITY));
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	const typename ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::MapNode* ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::FindNode(const Key& key, const std::uint64_t keyHash) const
+	{
+		const HashTable* currTablePtr = mCurrTablePtr.load(std::memory_order::acquire);
+
+		while (true)
+		{
+			const std::size_t slotIndexMask = (currTablePtr->Capacity - 1);
+			std::size_t currSlotIndex = (keyHash & slotIndexMask);
+			bool checkNextTable = true;
+
+			for (std::size_t numSlotsChecked = 0; numSlotsChecked < currTablePtr->Capacity; ++numSlotsChecked)
+			{
+				const std::uintptr_t slotValue = currTablePtr->SlotArr[currSlotIndex].load(std::memory_order::acquire);
+				const MapNode* const nodePtr = GetNodePointer(slotValue);
+
+				// Keys never move within a table, so if we reach an empty slot, then the key
+				// is not in this table. If that slot has been frozen, though, then the key
+				// might have been inserted into the next table since.
+				if (nodePtr == nullptr)
+				{
+					checkNextTable = ((slotValue & IMPL::SLOT_FLAG_FROZEN) != 0);
+					break;
+				}
+
+				if (nodePtr->KeyHash == keyHash && mKeyEqual(nodePtr->NodeKey, key))
+				{
+					// If this slot is frozen, then the next table has the most recent version
+					// of the element.
+					if ((slotValue & IMPL::SLOT_FLAG_FROZEN) != 0)
+						break;
+
+					return ((slotValue & IMPL::SLOT_FLAG_DELETED) == 0 ? nodePtr : nullptr);
+				}
+
+				currSlotIndex = ((currSlotIndex + 1) & slotIndexMask);
+			}
+
+			const HashTable* const nextTablePtr = currTablePtr->NextTablePtr.load(std::memory_order::acquire);
+
+			if (!checkNextTable || nextTablePtr == nullptr)
+				return nullptr;
+
+			currTablePtr = nextTablePtr;
+		}
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	template <typename ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::WriteOperation Operation>
+	bool ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::WriteElement(const Key& key, const std::uint64_t keyHash, MapNode* const newNodePtr)
+	{
+		const EpochGuard guard{};
+		HashTable* currTablePtr = mCurrTablePtr.load(std::memory_order::acquire);
+
+		while (true)
+		{
+			// We are not allowed to modify a table which is being migrated, so we have to help
+			// out until the migration is done.
+			if (currTablePtr->NextTablePtr.load(std::memory_order::acquire) != nullptr) [[unlikely]]
+			{
+				currTablePtr = HelpMigration(*currTablePtr);
+				continue;
+			}
+
+			const std::size_t slotIndexMask = (currTablePtr->Capacity - 1);
+			std::size_t currSlotIndex = (keyHash & slotIndexMask);
+			bool isTableFull = true;
+
+			for (std::size_t numSlotsChecked = 0; numSlotsChecked < currTablePtr->Capacity && isTableFull; ++numSlotsChecked)
+			{
+				std::atomic<std::uintptr_t>& currSlot{ currTablePtr->SlotArr[currSlotIndex] };
+				std::uintptr_t slotValue = currSlot.load(std::memory_order::acquire);
+
+				// We keep trying the same slot until we either succeed, or we find out that it
+				// belongs to a different key. Every failed compare_exchange_strong() means that
+				// some other thread made progress.
+				while (true)
+				{
+					if ((slotValue & IMPL::SLOT_FLAG_FROZEN) != 0) [[unlikely]]
+					{
+						isTableFull = false;
+						break;
+					}
+
+					MapNode* const nodePtr = GetNodePointer(slotValue);
+
+					if (nodePtr == nullptr)
+					{
+						if constexpr (Operation == WriteOperation::ERASE)
+							return false;
+						else
+						{
+							// Claiming a new slot might mean that the table needs to grow.
+							if (currTablePtr->ClaimedSlotCount.load(std::memory_order::relaxed) >= GetMaxClaimedSlotCount(currTablePtr->Capacity)) [[unlikely]]
+							{
+								BeginMigration(*currTablePtr);
+
+								isTableFull = false;
+								break;
+							}
+
+							if (currSlot.compare_exchange_strong(slotValue, reinterpret_cast<std::uintptr_t>(newNodePtr), std::memory_order::acq_rel, std::memory_order::acquire))
+							{
+								currTablePtr->ClaimedSlotCount.fetch_add(1, std::memory_order::relaxed);
+								mNumExistingElements.fetch_add(1, std::memory_order::relaxed);
+
+								return true;
+							}
+
+							continue;
+						}
+					}
+
+					if (nodePtr->KeyHash != keyHash || !mKeyEqual(nodePtr->NodeKey, key))
+						break;
+
+					const bool isNodeDeleted = ((slotValue & IMPL::SLOT_FLAG_DELETED) != 0);
+
+					if constexpr (Operation == WriteOperation::ERASE)
+					{
+						if (isNodeDeleted)
+							return false;
+
+						if (currSlot.compare_exchange_strong(slotValue, (slotValue | IMPL::SLOT_FLAG_DELETED), std::memory_order::acq_rel, std::memory_order::acquire))
+						{
+							mNumExistingElements.fetch_sub(1, std::memory_order::relaxed);
+							return true;
+						}
+					}
+					else
+					{
+						if (Operation == WriteOperation::TRY_EMPLACE && !isNodeDeleted)
+						{
+							// Nobody has seen newNodePtr yet, so we can delete it right away.
+							delete newNodePtr;
+							return false;
+						}
+
+						if (currSlot.compare_exchange_strong(slotValue, reinterpret_cast<std::uintptr_t>(newNodePtr), std::memory_order::acq_rel, std::memory_order::acquire))
+						{
+							Util::EpochReclamation::RetireObject(nodePtr);
+
+							if (isNodeDeleted)
+								mNumExistingElements.fetch_add(1, std::memory_order::relaxed);
+
+							return isNodeDeleted;
+						}
+					}
+				}
+
+				currSlotIndex = ((currSlotIndex + 1) & slotIndexMask);
+			}
+
+			// If we checked every slot without finding either the key or an empty slot, then
+			// the table is full. This can only happen if many threads claimed slots at once
+			// right before the table reached its maximum load.
+			if (isTableFull) [[unlikely]]
+				BeginMigration(*currTablePtr);
+		}
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	void ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::BeginMigration(HashTable& oldTable)
+	{
+		if (oldTable.NextTablePtr.load(std::memory_order::acquire) != nullptr)
+			return;
+
+		// If most of the claimed slots belong to erased keys, then we re-build the table at the
+		// same size, which gets rid of them. Either way, the new table has at least as many slots
+		// as the old one, so every node which we move over is guaranteed to fit.
+		const std::size_t numExistingElements = mNumExistingElements.load(std::memory_order::relaxed);
+		const std::size_t newCapacity = ((numExistingElements * 2) > GetMaxClaimedSlotCount(oldTable.Capacity) ? (oldTable.Capacity * 2) : oldTable.Capacity);
+
+		HashTable* const newTablePtr = new HashTable{ newCapacity };
+		HashTable* expectedTablePtr = nullptr;
+
+		// Some other thread might have beaten us to it.
+		if (!oldTable.NextTablePtr.compare_exchange_strong(expectedTablePtr, newTablePtr, std::memory_order::acq_rel, std::memory_order::acquire))
+			delete newTablePtr;
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	typename ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::HashTable* ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::HelpMigration(HashTable& oldTable)
+	{
+		HashTable* const newTablePtr = oldTable.NextTablePtr.load(std::memory_order::acquire);
+		assert(newTablePtr != nullptr);
+
+		const std::size_t numChunks = ((oldTable.Capacity + IMPL::CONCURRENT_HASH_MAP_MIGRATION_CHUNK_SIZE - 1) / IMPL::CONCURRENT_HASH_MAP_MIGRATION_CHUNK_SIZE);
+
+		while (true)
+		{
+			const std::size_t chunkIndex = oldTable.NextMigrationChunkIndex.fetch_add(1, std::memory_order::relaxed);
+
+			if (chunkIndex >= numChunks)
+				break;
+
+			const std::size_t beginSlotIndex = (chunkIndex * IMPL::CONCURRENT_HASH_MAP_MIGRATION_CHUNK_SIZE);
+			const std::size_t endSlotIndex = std::min(beginSlotIndex + IMPL::CONCURRENT_HASH_MAP_MIGRATION_CHUNK_SIZE, oldTable.Capacity);
+
+			for (std::size_t i = beginSlotIndex; i < endSlotIndex; ++i)
+				MigrateSlot(oldTable, *newTablePtr, i);
+
+			oldTable.MigratedChunkCount.fetch_add(1, std::memory_order::acq_rel);
+		}
+
+		// Every chunk has been claimed, but other threads might still be working on theirs.
+		while (oldTable.MigratedChunkCount.load(std::memory_order::acquire) < numChunks)
+			std::this_thread::yield();
+
+		// Only one thread gets to make the new table current, and that thread is responsible for
+		// deleting the old one. The table nodes were either moved to the new table or retired
+		// by MigrateSlot(), so deleting the table itself only frees its slot array.
+		HashTable* expectedTablePtr = &oldTable;
+
+		if (mCurrTablePtr.compare_exchange_strong(expectedTablePtr, newTablePtr, std::memory_order::acq_rel, std::memory_order::acquire))
+			Util::EpochReclamation::RetireObject(&oldTable);
+
+		return newTablePtr;
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	void ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::MigrateSlot(HashTable& oldTable, HashTable& newTable, const std::size_t slotIndex)
+	{
+		static constexpr std::size_t NOT_PLACED = std::numeric_limits<std::size_t>::max();
+
+		// We copy the slot into the new table *before* we freeze it. That way, readers which
+		// see the frozen slot and continue in the new table are guaranteed to find the element
+		// there. If another thread modifies the slot before we manage to freeze it, then we
+		// just update our copy and try again. (No other thread can modify the new table until
+		// the migration is finished, so only we can be writing to that slot.)
+		std::atomic<std::uintptr_t>& oldSlot{ oldTable.SlotArr[slotIndex] };
+		std::uintptr_t slotValue = oldSlot.load(std::memory_order::acquire);
+		std::size_t placedSlotIndex = NOT_PLACED;
+
+		while (true)
+		{
+			assert((slotValue & IMPL::SLOT_FLAG_FROZEN) == 0);
+
+			MapNode* const nodePtr = GetNodePointer(slotValue);
+			const bool isNodeDeleted = ((slotValue & IMPL::SLOT_FLAG_DELETED) != 0);
+
+			if (nodePtr != nullptr && !isNodeDeleted)
+			{
+				if (placedSlotIndex == NOT_PLACED)
+					placedSlotIndex = PlaceMigratedNode(newTable, nodePtr);
+				else
+					newTable.SlotArr[placedSlotIndex].store(reinterpret_cast<std::uintptr_t>(nodePtr), std::memory_order::release);
+			}
+			else if (placedSlotIndex != NOT_PLACED)
+			{
+				// The key was erased after we copied it. We cannot simply clear the slot in the
+				// new table, since other nodes might have been placed after it in the same probe
+				// sequence, so we mark it as deleted instead.
+				newTable.SlotArr[placedSlotIndex].store(slotValue, std::memory_order::release);
+			}
+
+			if (oldSlot.compare_exchange_weak(slotValue, (slotValue | IMPL::SLOT_FLAG_FROZEN), std::memory_order::acq_rel, std::memory_order::acquire))
+			{
+				// If the slot contained an erased key which never made it to the new table, then
+				// this table was the last place referencing its node.
+				if (isNodeDeleted && placedSlotIndex == NOT_PLACED)
+					Util::EpochReclamation::RetireObject(nodePtr);
+
+				return;
+			}
+		}
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	std::size_t ConcurrentHashMap<Key, Value, Hasher, KeyEqual>::PlaceMigratedNode(HashTable& newTable, MapNode* const nodePtr)
+	{
+		// Every key is in exactly one slot of the old table, so no two threads will ever place
+		// the same key. We still need to use compare_exchange_strong(), since other threads are
+		// placing other keys at the same time.
+		const std::size_t slotIndexMask = (newTable.Capacity - 1);
+		std::size_t currSlotIndex = (nodePtr->KeyHash & slotIndexMask);
+
+		while (true)
+		{
+			std::uintptr_t expectedSlotValue = 0;
+
+			if (newTable.SlotArr[currSlotIndex].compare_exchange_strong(expectedSlotValue, reinterpret_cast<std::uintptr_t>(nodePtr), std::memory_order::acq_rel, std::memory_order::relaxed))
+			{
+				newTable.ClaimedSlotCount.fetch_add(1, std::memory_order::relaxed);
+				return currSlotIndex;
+			}
+
+			currSlotIndex = ((currSlotIndex + 1) & slotIndexMask);
+		}
+	}
+}
\ No newline at end of file
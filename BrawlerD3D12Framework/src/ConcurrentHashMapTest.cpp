@@ -0,0 +1,264 @@
+module;
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <array>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <latch>
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <optional>
+#include <limits>
+#include <utility>
+
+module Tests.ConcurrentHashMapTest;
+import Brawler.ConcurrentHashMap;
+import Brawler.ThreadSafeMap;
+import Brawler.EpochReclamation;
+import Brawler.Timer;
+
+namespace
+{
+	constexpr std::uint64_t KEYS_PER_THREAD = 20000;
+	constexpr std::uint64_t SHARED_KEY_COUNT = 1024;
+	constexpr std::size_t SHARED_KEY_OPERATION_COUNT = 200000;
+
+	// The shared keys come after every thread's own keys.
+	constexpr std::uint64_t SHARED_KEY_BEGIN = (std::uint64_t{ 1 } << 40);
+
+	constexpr std::size_t BENCHMARK_KEY_COUNT = (1 << 14);
+	constexpr std::size_t BENCHMARK_OPERATIONS_PER_THREAD = (1 << 20);
+	constexpr std::array<std::uint32_t, 5> BENCHMARK_THREAD_COUNT_ARR{ 1, 2, 4, 8, 16 };
+
+	// Every value remembers the key which it was created for, so that a lookup which returns
+	// the value of some other key (or a destroyed value) is caught.
+	struct TrackedValue
+	{
+		explicit TrackedValue(const std::uint64_t key, const std::uint64_t writerIndex) :
+			Key(key),
+			WriterIndex(writerIndex)
+		{
+			mLiveValueCount.fetch_add(1, std::memory_order::relaxed);
+		}
+
+		TrackedValue(const TrackedValue& rhs) :
+			Key(rhs.Key),
+			WriterIndex(rhs.WriterIndex)
+		{
+			mLiveValueCount.fetch_add(1, std::memory_order::relaxed);
+		}
+
+		~TrackedValue()
+		{
+			Key = 0xDEADDEADDEADDEAD;
+			mLiveValueCount.fetch_sub(1, std::memory_order::relaxed);
+		}
+
+		TrackedValue& operator=(const TrackedValue& rhs) = delete;
+
+		std::uint64_t Key;
+		std::uint64_t WriterIndex;
+
+		inline static std::atomic<std::int64_t> mLiveValueCount{ 0 };
+	};
+
+	template <typename Callback>
+	void RunOnThreads(const std::uint32_t numThreads, const Callback& callback)
+	{
+		std::latch startLatch{ static_cast<std::ptrdiff_t>(numThreads) };
+		std::vector<std::jthread> threadArr{};
+
+		for (std::uint32_t i = 0; i < numThreads; ++i)
+		{
+			threadArr.emplace_back([&startLatch, &callback, i] ()
+			{
+				startLatch.arrive_and_wait();
+				callback(i);
+			});
+		}
+	}
+
+	void RunStressTest()
+	{
+		const std::uint32_t numThreads = std::max<std::uint32_t>(std::thread::hardware_concurrency(), 4);
+
+		{
+			Brawler::ConcurrentHashMap<std::uint64_t, TrackedValue> stressMap{};
+
+			RunOnThreads(numThreads, [&stressMap] (const std::uint32_t threadIndex)
+			{
+				std::mt19937_64 randomEngine{ threadIndex };
+				std::uniform_int_distribution<std::uint64_t> sharedKeyDistribution{ SHARED_KEY_BEGIN, (SHARED_KEY_BEGIN + SHARED_KEY_COUNT - 1) };
+				std::uniform_int_distribution<std::uint32_t> operationDistribution{ 0, 3 };
+
+				const std::uint64_t ownKeyBegin = (threadIndex * KEYS_PER_THREAD);
+				std::uint64_t nextOwnKey = ownKeyBegin;
+
+				// Every thread keeps adding its own keys, which forces the map to keep growing,
+				// while it also fights with the other threads over the shared keys.
+				for (std::size_t i = 0; i < SHARED_KEY_OPERATION_COUNT; ++i)
+				{
+					if (nextOwnKey < (ownKeyBegin + KEYS_PER_THREAD) && (i % 8) == 0)
+					{
+						const bool wasInserted = stressMap.TryEmplace(nextOwnKey, nextOwnKey, threadIndex);
+						assert(wasInserted && "ERROR: ConcurrentHashMap::TryEmplace() failed for a key which only one thread ever inserts!");
+
+						++nextOwnKey;
+					}
+
+					const std::uint64_t sharedKey = sharedKeyDistribution(randomEngine);
+
+					switch (operationDistribution(randomEngine))
+					{
+					case 0:
+						stressMap.TryEmplace(sharedKey, sharedKey, threadIndex);
+						break;
+
+					case 1:
+						stressMap.InsertOrAssign(sharedKey, TrackedValue{ sharedKey, threadIndex });
+						break;
+
+					case 2:
+						stressMap.Erase(sharedKey);
+						break;
+
+					case 3:
+					{
+						stressMap.Visit(sharedKey, [sharedKey] (const TrackedValue& value)
+						{
+							assert(value.Key == sharedKey && "ERROR: ConcurrentHashMap::Visit() returned the value of a different key!");
+						});
+
+						break;
+					}
+
+					default:
+						assert(false);
+						std::unreachable();
+					}
+				}
+
+				// Make sure that every one of this thread's keys is still there, no matter how
+				// often the map was migrated since they were inserted.
+				for (std::uint64_t key = ownKeyBegin; key < nextOwnKey; ++key)
+				{
+					const std::optional<TrackedValue> value{ stressMap.TryGet(key) };
+					assert(value.has_value() && value->Key == key && value->WriterIndex == threadIndex && "ERROR: A key inserted into a ConcurrentHashMap was lost!");
+				}
+
+				// Now, erase them all again. The map should then only contain shared keys.
+				for (std::uint64_t key = ownKeyBegin; key < nextOwnKey; ++key)
+				{
+					const bool wasErased = stressMap.Erase(key);
+					assert(wasErased && "ERROR: ConcurrentHashMap::Erase() failed for a key which was in the map!");
+				}
+			});
+
+			std::size_t numVisitedValues = 0;
+			stressMap.ForEach([&numVisitedValues] (const TrackedValue& value)
+			{
+				assert(value.Key >= SHARED_KEY_BEGIN && "ERROR: An erased key was still in a ConcurrentHashMap!");
+				++numVisitedValues;
+			});
+
+			assert(numVisitedValues == stressMap.GetSize() && numVisitedValues <= SHARED_KEY_COUNT);
+		}
+
+		// Once the map is destroyed, and the global epoch has moved on far enough, every value
+		// should have been destroyed. The values retired by threads which have since exited are
+		// collected by whichever thread collects its own retired values next.
+		for (std::uint32_t i = 0; i < 4; ++i)
+			Util::EpochReclamation::CollectRetiredObjects();
+
+		assert(TrackedValue::mLiveValueCount.load() == 0 && "ERROR: Some values of a ConcurrentHashMap were never destroyed!");
+
+		std::cout << "ConcurrentHashMap stress test passed (" << numThreads << " threads)." << std::endl;
+	}
+
+	template <typename Callback>
+	float MeasureThroughput(const std::uint32_t numThreads, const Callback& callback)
+	{
+		Brawler::Timer t{};
+		t.Start();
+
+		RunOnThreads(numThreads, callback);
+
+		t.Stop();
+
+		// Report millions of operations per second.
+		return ((static_cast<float>(numThreads) * static_cast<float>(BENCHMARK_OPERATIONS_PER_THREAD)) / (t.GetElapsedTimeInMilliseconds() * 1000.0f));
+	}
+
+	void RunBenchmarks()
+	{
+		// Brawler::ThreadSafeMap hands out references to its values, so we need atomic values
+		// in order to update them while other threads are reading them.
+		using ThreadSafeMapType = Brawler::ThreadSafeMap<std::uint64_t, std::atomic<std::uint64_t>, (BENCHMARK_KEY_COUNT * 2)>;
+
+		const std::unique_ptr<ThreadSafeMapType> threadSafeMapPtr{ std::make_unique<ThreadSafeMapType>() };
+		Brawler::ConcurrentHashMap<std::uint64_t, std::uint64_t> concurrentMap{};
+
+		for (std::uint64_t i = 0; i < BENCHMARK_KEY_COUNT; ++i)
+		{
+			(*threadSafeMapPtr)[i].store(i, std::memory_order::relaxed);
+			concurrentMap.TryEmplace(i, i);
+		}
+
+		for (const auto numThreads : BENCHMARK_THREAD_COUNT_ARR)
+		{
+			// Nine out of every ten operations are lookups, and the rest are updates of existing
+			// keys. That is roughly what a registry like WorkerThreadPool::mThreadMap sees.
+			const float threadSafeMapThroughput = MeasureThroughput(numThreads, [&threadSafeMapPtr] (const std::uint32_t threadIndex)
+			{
+				std::uint64_t checksum = 0;
+				std::uint64_t currKey = (threadIndex * 7919);
+
+				for (std::size_t i = 0; i < BENCHMARK_OPERATIONS_PER_THREAD; ++i)
+				{
+					currKey = ((currKey + 40503) % BENCHMARK_KEY_COUNT);
+
+					if ((i % 10) == 0)
+						threadSafeMapPtr->At(currKey).store(i, std::memory_order::relaxed);
+					else
+						checksum += threadSafeMapPtr->At(currKey).load(std::memory_order::relaxed);
+				}
+
+				assert(checksum != std::numeric_limits<std::uint64_t>::max());
+			});
+
+			const float concurrentMapThroughput = MeasureThroughput(numThreads, [&concurrentMap] (const std::uint32_t threadIndex)
+			{
+				std::uint64_t checksum = 0;
+				std::uint64_t currKey = (threadIndex * 7919);
+
+				for (std::size_t i = 0; i < BENCHMARK_OPERATIONS_PER_THREAD; ++i)
+				{
+					currKey = ((currKey + 40503) % BENCHMARK_KEY_COUNT);
+
+					if ((i % 10) == 0)
+						concurrentMap.InsertOrAssign(currKey, static_cast<std::uint64_t>(i));
+					else
+						checksum += *(concurrentMap.TryGet(currKey));
+				}
+
+				assert(checksum != std::numeric_limits<std::uint64_t>::max());
+			});
+
+			std::cout << "90% Lookups, 10% Updates (" << numThreads << " Threads):\n"
+				<< "\tBrawler::ThreadSafeMap: " << threadSafeMapThroughput << " Mops/s\n"
+				<< "\tBrawler::ConcurrentHashMap: " << concurrentMapThroughput << " Mops/s" << std::endl;
+		}
+	}
+}
+
+namespace Tests
+{
+	void RunConcurrentHashMapTests()
+	{
+		RunStressTest();
+		RunBenchmarks();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+module;
+
+export module Tests.ConcurrentHashMapTest;
+
+export namespace Tests
+{
+	/// <summary>
+	/// Has many threads insert, assign, erase and look up keys in a Brawler::ConcurrentHashMap
+	/// at once, starting from the smallest possible table so that it grows repeatedly while
+	/// this happens. Afterwards, the function checks that every erased and replaced value was
+	/// eventually destroyed, and it compares the lookup and update throughput of the map with
+	/// that of Brawler::ThreadSafeMap.
+	/// </summary>
+	void RunConcurrentHashMapTests();
+}
\ No newline at end of file
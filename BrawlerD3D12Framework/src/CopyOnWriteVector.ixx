@@ -0,0 +1,332 @@
+module;
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <ranges>
+#include <cassert>
+#include <iterator>
+#include <utility>
+#include <concepts>
+
+export module Brawler.CopyOnWriteVector;
+import Brawler.EpochReclamation;
+import Brawler.Functional;
+
+export namespace Brawler
+{
+	// The CopyOnWriteVector is meant for lists which are iterated over far more often than they
+	// are modified. A ThreadSafeVector has to take its lock for every call to ThreadSafeVector::ForEach(), and
+	// even with a std::shared_mutex, every reader still writes to the same cache line.
+	//
+	// Instead, the CopyOnWriteVector publishes immutable snapshots of its elements through an
+	// atomic pointer. Readers only need to enter an EpochGuard and load that pointer, so they
+	// never block, and they never write to memory shared with other threads. Writers are
+	// serialized by a std::mutex; each one copies the current snapshot, modifies the copy,
+	// publishes it, and retires the old snapshot. The old snapshot is only deleted once every
+	// reader which might still be looking at it has left its EpochGuard.
+	//
+	// This makes every modification O(N), so if many elements are to be added or removed at
+	// once, then they should be batched together with CopyOnWriteVector::Modify().
+	//
+	// Removing an element does *NOT* wait for readers which are still iterating over an older
+	// snapshot. So, if the elements are raw pointers to objects which unregister themselves in
+	// their destructor, then the object must call Util::EpochReclamation::WaitForReaders() after
+	// removing itself; otherwise, a reader might still call into it after it is destroyed.
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	class CopyOnWriteVector
+	{
+	private:
+		struct Snapshot
+		{
+			std::vector<T> DataArr;
+		};
+
+	public:
+		CopyOnWriteVector() = default;
+		~CopyOnWriteVector();
+
+		CopyOnWriteVector(const CopyOnWriteVector& rhs) = delete;
+		CopyOnWriteVector& operator=(const CopyOnWriteVector& rhs) = delete;
+
+		CopyOnWriteVector(CopyOnWriteVector&& rhs) noexcept;
+		CopyOnWriteVector& operator=(CopyOnWriteVector&& rhs) noexcept;
+
+		template <typename U>
+			requires std::is_same_v<std::decay_t<T>, std::decay_t<U>>
+		void PushBack(U&& val);
+
+		template <typename... Args>
+			requires requires (Args... args)
+		{
+			T{ args... };
+		}
+		void EmplaceBack(Args&&... args);
+
+		/// <summary>
+		/// Removes the element at the specified index from the CopyOnWriteVector. Since other
+		/// threads might be modifying the CopyOnWriteVector at the same time, the caller should
+		/// usually prefer CopyOnWriteVector::EraseIf().
+		/// </summary>
+		/// <param name="index">
+		/// - The index of the element which is to be removed.
+		/// </param>
+		void Erase(const std::size_t index);
+
+		/// <summary>
+		/// Removes every element for which predicate returns true. The current snapshot is
+		/// checked first, and if no element needs to be removed, then no copy is made. This
+		/// makes it cheap to call this function every frame to clean up elements which are
+		/// rarely ready to be removed.
+		/// </summary>
+		/// <param name="predicate">
+		/// - The predicate which decides whether or not an element is to be removed.
+		/// </param>
+		template <typename Callback>
+		void EraseIf(const Callback& predicate);
+
+		void Clear();
+
+		/// <summary>
+		/// Applies any number of modifications to the CopyOnWriteVector at once. The callback is
+		/// passed a copy of the current elements as a std::vector, and once it returns, that
+		/// std::vector is published as the new snapshot. Readers thus see either all of the
+		/// modifications or none of them, and the elements are only copied once.
+		/// 
+		/// The callback is executed while the CopyOnWriteVector's write lock is held, so it
+		/// must not modify the CopyOnWriteVector itself.
+		/// </summary>
+		/// <param name="callback">
+		/// - The callback which modifies the elements.
+		/// </param>
+		template <Brawler::Function<void, std::vector<T>&> Callback>
+		void Modify(const Callback& callback);
+
+		std::size_t GetSize() const;
+		bool Empty() const;
+
+		template <typename Callback>
+		void AccessData(const std::size_t index, const Callback& callback) const;
+
+		/// <summary>
+		/// Calls callback for every element of the current snapshot. This never blocks, and it
+		/// does not see any modifications made while it is running. The elements are passed as
+		/// const references, since other threads might be reading the same snapshot.
+		/// 
+		/// Snapshots cannot be deleted while any thread is still iterating over one, so callback
+		/// should not block for long periods of time.
+		/// </summary>
+		/// <param name="callback">
+		/// - The callback which is to be called for every element.
+		/// </param>
+		template <typename Callback>
+		void ForEach(const Callback& callback) const;
+
+		/// <summary>
+		/// Reading from a CopyOnWriteVector is lock-free. Writing to it is not.
+		/// </summary>
+		constexpr static bool IsLockFree();
+
+	private:
+		void PublishSnapshot(Snapshot* const newSnapshotPtr);
+
+	private:
+		// A nullptr refers to an empty CopyOnWriteVector. That way, neither the default
+		// constructor nor the move constructor needs to allocate anything.
+		std::atomic<Snapshot*> mCurrSnapshotPtr{ nullptr };
+		std::mutex mWriteCritSection{};
+	};
+}
+
+// --------------------------------------------------------------------------------------------------------
+
+namespace Brawler
+{
+	template <typename T>
+		requires std::copy_constructible<T>
+	CopyOnWriteVector<T>::~CopyOnWriteVector()
+	{
+		// Nobody should be reading from a CopyOnWriteVector while it is being destroyed, so the
+		// current snapshot can be deleted right away.
+		delete mCurrSnapshotPtr.load(std::memory_order::acquire);
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	CopyOnWriteVector<T>::CopyOnWriteVector(CopyOnWriteVector&& rhs) noexcept :
+		mCurrSnapshotPtr(nullptr),
+		mWriteCritSection()
+	{
+		std::scoped_lock<std::mutex> rhsWriteLock{ rhs.mWriteCritSection };
+
+		mCurrSnapshotPtr.store(rhs.mCurrSnapshotPtr.exchange(nullptr, std::memory_order::acq_rel), std::memory_order::release);
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	CopyOnWriteVector<T>& CopyOnWriteVector<T>::operator=(CopyOnWriteVector&& rhs) noexcept
+	{
+		if (this == &rhs) [[unlikely]]
+			return *this;
+
+		std::scoped_lock<std::mutex, std::mutex> writeLock{ mWriteCritSection, rhs.mWriteCritSection };
+
+		PublishSnapshot(rhs.mCurrSnapshotPtr.exchange(nullptr, std::memory_order::acq_rel));
+
+		return *this;
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	template <typename U>
+		requires std::is_same_v<std::decay_t<T>, std::decay_t<U>>
+	void CopyOnWriteVector<T>::PushBack(U&& val)
+	{
+		Modify([&val] (std::vector<T>& dataArr)
+		{
+			dataArr.push_back(std::forward<U>(val));
+		});
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	template <typename... Args>
+		requires requires (Args... args)
+	{
+		T{ args... };
+	}
+	void CopyOnWriteVector<T>::EmplaceBack(Args&&... args)
+	{
+		Modify([&] (std::vector<T>& dataArr)
+		{
+			dataArr.emplace_back(std::forward<Args>(args)...);
+		});
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	void CopyOnWriteVector<T>::Erase(const std::size_t index)
+	{
+		Modify([index] (std::vector<T>& dataArr)
+		{
+			assert(index < dataArr.size() && "ERROR: An out-of-bounds index was provided to CopyOnWriteVector::Erase()!");
+			dataArr.erase(dataArr.begin() + index);
+		});
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	template <typename Callback>
+	void CopyOnWriteVector<T>::EraseIf(const Callback& predicate)
+	{
+		std::scoped_lock<std::mutex> writeLock{ mWriteCritSection };
+
+		// Only writers can retire snapshots, and we are holding the write lock, so the current
+		// snapshot cannot be deleted while we look at it.
+		const Snapshot* const currSnapshotPtr = mCurrSnapshotPtr.load(std::memory_order::relaxed);
+
+		if (currSnapshotPtr == nullptr || std::ranges::none_of(currSnapshotPtr->DataArr, predicate))
+			return;
+
+		Snapshot* const newSnapshotPtr = new Snapshot{};
+		newSnapshotPtr->DataArr.reserve(currSnapshotPtr->DataArr.size());
+
+		std::ranges::copy_if(currSnapshotPtr->DataArr, std::back_inserter(newSnapshotPtr->DataArr), [&predicate] (const T& element) { return !predicate(element); });
+
+		PublishSnapshot(newSnapshotPtr);
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	void CopyOnWriteVector<T>::Clear()
+	{
+		std::scoped_lock<std::mutex> writeLock{ mWriteCritSection };
+
+		PublishSnapshot(nullptr);
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	template <Brawler::Function<void, std::vector<T>&> Callback>
+	void CopyOnWriteVector<T>::Modify(const Callback& callback)
+	{
+		std::scoped_lock<std::mutex> writeLock{ mWriteCritSection };
+
+		const Snapshot* const currSnapshotPtr = mCurrSnapshotPtr.load(std::memory_order::relaxed);
+		Snapshot* const newSnapshotPtr = (currSnapshotPtr == nullptr ? new Snapshot{} : new Snapshot{ *currSnapshotPtr });
+
+		try
+		{
+			callback(newSnapshotPtr->DataArr);
+		}
+		catch (...)
+		{
+			// If the callback throws, then the CopyOnWriteVector is left unchanged.
+			delete newSnapshotPtr;
+			throw;
+		}
+
+		PublishSnapshot(newSnapshotPtr);
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	std::size_t CopyOnWriteVector<T>::GetSize() const
+	{
+		const EpochGuard guard{};
+		const Snapshot* const currSnapshotPtr = mCurrSnapshotPtr.load(std::memory_order::acquire);
+
+		return (currSnapshotPtr == nullptr ? 0 : currSnapshotPtr->DataArr.size());
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	bool CopyOnWriteVector<T>::Empty() const
+	{
+		return (GetSize() == 0);
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	template <typename Callback>
+	void CopyOnWriteVector<T>::AccessData(const std::size_t index, const Callback& callback) const
+	{
+		const EpochGuard guard{};
+		const Snapshot* const currSnapshotPtr = mCurrSnapshotPtr.load(std::memory_order::acquire);
+
+		assert(currSnapshotPtr != nullptr && index < currSnapshotPtr->DataArr.size() && "ERROR: An out-of-bounds index was provided to CopyOnWriteVector::AccessData()!");
+		callback(currSnapshotPtr->DataArr[index]);
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	template <typename Callback>
+	void CopyOnWriteVector<T>::ForEach(const Callback& callback) const
+	{
+		const EpochGuard guard{};
+		const Snapshot* const currSnapshotPtr = mCurrSnapshotPtr.load(std::memory_order::acquire);
+
+		if (currSnapshotPtr != nullptr)
+			std::ranges::for_each(std::as_const(currSnapshotPtr->DataArr), callback);
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	constexpr bool CopyOnWriteVector<T>::IsLockFree()
+	{
+		return false;
+	}
+
+	template <typename T>
+		requires std::copy_constructible<T>
+	void CopyOnWriteVector<T>::PublishSnapshot(Snapshot* const newSnapshotPtr)
+	{
+		// The caller must hold the write lock.
+		Snapshot* const oldSnapshotPtr = mCurrSnapshotPtr.exchange(newSnapshotPtr, std::memory_order::acq_rel);
+
+		if (oldSnapshotPtr != nullptr)
+			Util::EpochReclamation::RetireObject(oldSnapshotPtr);
+	}
+}
\ No newline at end of file
@@ -1,6 +1,5 @@
 module;
 #include <vector>
-#include <functional>
 
 module Brawler.DelayedJobGroup;
 
@@ -11,7 +10,7 @@ namespace Brawler
 		mPriority(priority)
 	{}
 
-	void DelayedJobGroup::AddJob(std::move_only_function<void()>&& callback)
+	void DelayedJobGroup::AddJob(JobCallback&& callback)
 	{
 		mJobArr.push_back(Job{ std::move(callback), nullptr, mPriority });
 	}
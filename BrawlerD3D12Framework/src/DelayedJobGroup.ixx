@@ -6,6 +6,7 @@ module;
 
 export module Brawler.DelayedJobGroup;
 import Brawler.Job;
+import Brawler.JobCallback;
 import Brawler.JobPriority;
 import Brawler.I_EventHandle;
 import Brawler.ThreadLocalResources;
@@ -39,7 +40,7 @@ export namespace Brawler
 		DelayedJobGroup(DelayedJobGroup&& rhs) noexcept = default;
 		DelayedJobGroup& operator=(DelayedJobGroup&& rhs) noexcept = default;
 
-		void AddJob(std::move_only_function<void()>&& callback);
+		void AddJob(JobCallback&& callback);
 		void Reserve(const std::size_t jobCount);
 
 		template <typename T>
@@ -1,5 +1,6 @@
 module;
 #include <vector>
+#include <span>
 #include "DxDef.h"
 
 module Brawler.DelayedJobSubmitter;
@@ -21,8 +22,7 @@ namespace Brawler
 
 			if (submissionInfo.HEventPtr->IsEventCompleted())
 			{
-				for (auto&& job : submissionInfo.DelayedJobArr)
-					Brawler::GetWorkerThreadPool().DispatchJob(std::move(job));
+				Brawler::GetWorkerThreadPool().DispatchJobs(std::span<Job>{ submissionInfo.DelayedJobArr });
 
 				return true;
 			}
@@ -0,0 +1,348 @@
+module;
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <new>
+#include <algorithm>
+#include <thread>
+
+module Brawler.EpochReclamation;
+
+namespace
+{
+	// Every thread tries to delete its retired objects once it has retired this many of them.
+	// Doing it on every call would mean scanning every thread's announced epoch far too often.
+	constexpr std::size_t RETIRED_OBJECT_COLLECTION_THRESHOLD = 64;
+
+	// An announced epoch of zero means that the thread has no active EpochGuard. The global
+	// epoch thus starts at one.
+	constexpr std::uint64_t INACTIVE_EPOCH = 0;
+
+	consteval bool IsX86Architecture()
+	{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	struct RetiredObject
+	{
+		void* ObjectPtr;
+		void(*DeleteFunction)(void*);
+		std::uint64_t RetireEpoch;
+	};
+
+	struct alignas(std::hardware_destructive_interference_size) ThreadRecord
+	{
+		std::atomic<std::uint64_t> AnnouncedEpoch{ INACTIVE_EPOCH };
+		std::atomic<bool> IsInUse{ true };
+
+		// This never changes once the record has been added to the list, so it need not be
+		// atomic.
+		ThreadRecord* NextRecordPtr = nullptr;
+
+		// These are only ever accessed by the thread which owns the record.
+		std::uint32_t GuardDepth = 0;
+		std::vector<RetiredObject> RetiredObjectArr{};
+
+		// If some other thread stays inside of an EpochGuard for a long time, then the epoch
+		// cannot advance, and none of our retired objects can be deleted. Scanning them again
+		// after every RETIRED_OBJECT_COLLECTION_THRESHOLD retirements would then take quadratic
+		// time, so we instead wait until the array has doubled in size since the last scan.
+		std::size_t NextCollectionSize = RETIRED_OBJECT_COLLECTION_THRESHOLD;
+	};
+
+	class EpochReclamationState
+	{
+	public:
+		EpochReclamationState() = default;
+
+		~EpochReclamationState()
+		{
+			// By the time static objects are destroyed, every other thread should have exited,
+			// so nobody can be reading the retired objects anymore.
+			for (const auto& retiredObject : mOrphanedObjectArr)
+				retiredObject.DeleteFunction(retiredObject.ObjectPtr);
+
+			ThreadRecord* currRecordPtr = mRecordListHead.load(std::memory_order::acquire);
+
+			while (currRecordPtr != nullptr)
+			{
+				ThreadRecord* const nextRecordPtr = currRecordPtr->NextRecordPtr;
+
+				for (const auto& retiredObject : currRecordPtr->RetiredObjectArr)
+					retiredObject.DeleteFunction(retiredObject.ObjectPtr);
+
+				delete currRecordPtr;
+				currRecordPtr = nextRecordPtr;
+			}
+		}
+
+		EpochReclamationState(const EpochReclamationState& rhs) = delete;
+		EpochReclamationState& operator=(const EpochReclamationState& rhs) = delete;
+
+		EpochReclamationState(EpochReclamationState&& rhs) noexcept = delete;
+		EpochReclamationState& operator=(EpochReclamationState&& rhs) noexcept = delete;
+
+		ThreadRecord& AcquireThreadRecord()
+		{
+			// Threads come and go (e.g., threads created by std::async()), so we re-use the
+			// records of threads which have exited before allocating new ones. Records are never
+			// removed from the list, which is what lets us iterate over it without locking.
+			for (ThreadRecord* currRecordPtr = mRecordListHead.load(std::memory_order::acquire); currRecordPtr != nullptr; currRecordPtr = currRecordPtr->NextRecordPtr)
+			{
+				bool expectedValue = false;
+
+				if (!currRecordPtr->IsInUse.load(std::memory_order::relaxed) && currRecordPtr->IsInUse.compare_exchange_strong(expectedValue, true, std::memory_order::acquire))
+					return *currRecordPtr;
+			}
+
+			ThreadRecord* const newRecordPtr = new ThreadRecord{};
+			newRecordPtr->NextRecordPtr = mRecordListHead.load(std::memory_order::relaxed);
+
+			while (!mRecordListHead.compare_exchange_weak(newRecordPtr->NextRecordPtr, newRecordPtr, std::memory_order::release, std::memory_order::relaxed));
+
+			return *newRecordPtr;
+		}
+
+		void ReleaseThreadRecord(ThreadRecord& record)
+		{
+			assert(record.GuardDepth == 0 && "ERROR: A thread exited while it still had an active Brawler::EpochGuard!");
+
+			// We cannot delete the exiting thread's retired objects yet, since other threads might
+			// still be reading them. Instead, we hand them over to whichever thread next collects
+			// its own retired objects.
+			if (!record.RetiredObjectArr.empty())
+			{
+				std::scoped_lock<std::mutex> lock{ mOrphanCritSection };
+
+				mOrphanedObjectArr.insert(mOrphanedObjectArr.end(), record.RetiredObjectArr.begin(), record.RetiredObjectArr.end());
+				mHasOrphanedObjects.store(true, std::memory_order::relaxed);
+			}
+
+			record.RetiredObjectArr.clear();
+			record.NextCollectionSize = RETIRED_OBJECT_COLLECTION_THRESHOLD;
+			record.IsInUse.store(false, std::memory_order::release);
+		}
+
+		void EnterCriticalSection(ThreadRecord& record)
+		{
+			if (record.GuardDepth++ > 0)
+				return;
+
+			// If the global epoch advances between our reading it and our announcing it, then we
+			// would be announcing an old epoch. That would be safe, since it only prevents the
+			// epoch from advancing further, but it would delay reclamation for no reason.
+			std::uint64_t currEpoch = mGlobalEpoch.load(std::memory_order::relaxed);
+
+			while (true)
+			{
+				// Our announcement must be visible to every thread which tries to advance the epoch
+				// *before* we read any pointer to a shared object. This pairs with the fence in
+				// EpochReclamationState::TryAdvanceEpoch(). Every reader pays for this, and on x86,
+				// a locked exchange does the job noticeably faster than a store followed by a full
+				// fence.
+				if constexpr (IsX86Architecture())
+					record.AnnouncedEpoch.exchange(currEpoch, std::memory_order::seq_cst);
+				else
+				{
+					record.AnnouncedEpoch.store(currEpoch, std::memory_order::relaxed);
+					std::atomic_thread_fence(std::memory_order::seq_cst);
+				}
+
+				const std::uint64_t latestEpoch = mGlobalEpoch.load(std::memory_order::relaxed);
+
+				if (latestEpoch == currEpoch) [[likely]]
+					return;
+
+				currEpoch = latestEpoch;
+			}
+		}
+
+		void ExitCriticalSection(ThreadRecord& record)
+		{
+			assert(record.GuardDepth > 0);
+
+			if (--record.GuardDepth == 0)
+				record.AnnouncedEpoch.store(INACTIVE_EPOCH, std::memory_order::release);
+		}
+
+		void RetireObject(ThreadRecord& record, void* const objectPtr, void(*deleteFunction)(void*))
+		{
+			record.RetiredObjectArr.push_back(RetiredObject{
+				.ObjectPtr = objectPtr,
+				.DeleteFunction = deleteFunction,
+				.RetireEpoch = mGlobalEpoch.load(std::memory_order::seq_cst)
+			});
+
+			if (record.RetiredObjectArr.size() >= record.NextCollectionSize)
+				CollectRetiredObjects(record);
+		}
+
+		void CollectRetiredObjects(ThreadRecord& record)
+		{
+			TryAdvanceEpoch();
+
+			const std::uint64_t currEpoch = mGlobalEpoch.load(std::memory_order::acquire);
+			const auto isObjectReclaimable = [currEpoch] (const RetiredObject& retiredObject) { return ((retiredObject.RetireEpoch + 2) <= currEpoch); };
+
+			// Move the reclaimable objects to the back, and delete them from there. We delete them
+			// only after they have been removed from the array, since a deleter might itself retire
+			// more objects.
+			const auto reclaimableRange = std::ranges::partition(record.RetiredObjectArr, [&isObjectReclaimable] (const RetiredObject& retiredObject) { return !isObjectReclaimable(retiredObject); });
+			std::vector<RetiredObject> reclaimableObjectArr{ reclaimableRange.begin(), reclaimableRange.end() };
+			record.RetiredObjectArr.erase(reclaimableRange.begin(), reclaimableRange.end());
+			record.NextCollectionSize = std::max(RETIRED_OBJECT_COLLECTION_THRESHOLD, (record.RetiredObjectArr.size() * 2));
+
+			if (mHasOrphanedObjects.load(std::memory_order::relaxed)) [[unlikely]]
+			{
+				std::scoped_lock<std::mutex> lock{ mOrphanCritSection };
+
+				const auto orphanedRange = std::ranges::partition(mOrphanedObjectArr, [&isObjectReclaimable] (const RetiredObject& retiredObject) { return !isObjectReclaimable(retiredObject); });
+				reclaimableObjectArr.insert(reclaimableObjectArr.end(), orphanedRange.begin(), orphanedRange.end());
+				mOrphanedObjectArr.erase(orphanedRange.begin(), orphanedRange.end());
+
+				mHasOrphanedObjects.store(!mOrphanedObjectArr.empty(), std::memory_order::relaxed);
+			}
+
+			for (const auto& retiredObject : reclaimableObjectArr)
+				retiredObject.DeleteFunction(retiredObject.ObjectPtr);
+		}
+
+		void WaitForReaders(const ThreadRecord& record)
+		{
+			assert(record.GuardDepth == 0 && "ERROR: Util::EpochReclamation::WaitForReaders() was called while the calling thread had an active Brawler::EpochGuard!");
+
+			// Every thread which is currently inside of its critical section has announced an
+			// epoch no later than the current one. The epoch cannot advance twice without all of
+			// those threads leaving their critical sections; this is the same reasoning which
+			// lets us delete retired objects two epochs later.
+			const std::uint64_t targetEpoch = (mGlobalEpoch.load(std::memory_order::seq_cst) + 2);
+
+			while (true)
+			{
+				TryAdvanceEpoch();
+
+				if (mGlobalEpoch.load(std::memory_order::acquire) >= targetEpoch)
+					return;
+
+				std::this_thread::yield();
+			}
+		}
+
+	private:
+		void TryAdvanceEpoch()
+		{
+			const std::uint64_t currEpoch = mGlobalEpoch.load(std::memory_order::relaxed);
+
+			// This pairs with the fence in EpochReclamationState::EnterCriticalSection(). Either
+			// we see a thread's announcement below, or that thread sees the epoch which we are
+			// about to write (or a later one) after it announces itself, and it can therefore no
+			// longer obtain pointers to objects which were retired before then.
+			std::atomic_thread_fence(std::memory_order::seq_cst);
+
+			for (ThreadRecord* currRecordPtr = mRecordListHead.load(std::memory_order::acquire); currRecordPtr != nullptr; currRecordPtr = currRecordPtr->NextRecordPtr)
+			{
+				// The acquire here pairs with the release in EpochReclamationState::ExitCriticalSection(),
+				// so that everything which a thread read inside of its critical section happens
+				// before the objects retired during it are deleted.
+				const std::uint64_t announcedEpoch = currRecordPtr->AnnouncedEpoch.load(std::memory_order::acquire);
+
+				if (announcedEpoch != INACTIVE_EPOCH && announcedEpoch != currEpoch)
+					return;
+			}
+
+			std::uint64_t expectedEpoch = currEpoch;
+			mGlobalEpoch.compare_exchange_strong(expectedEpoch, (currEpoch + 1), std::memory_order::acq_rel, std::memory_order::relaxed);
+		}
+
+	private:
+		alignas(std::hardware_destructive_interference_size) std::atomic<std::uint64_t> mGlobalEpoch{ 1 };
+		alignas(std::hardware_destructive_interference_size) std::atomic<ThreadRecord*> mRecordListHead{ nullptr };
+
+		std::mutex mOrphanCritSection{};
+		std::vector<RetiredObject> mOrphanedObjectArr{};
+		std::atomic<bool> mHasOrphanedObjects{ false };
+	};
+
+	EpochReclamationState& GetEpochReclamationState()
+	{
+		static EpochReclamationState reclamationState{};
+		return reclamationState;
+	}
+
+	class ThreadRecordOwner
+	{
+	public:
+		ThreadRecordOwner() :
+			mRecord(GetEpochReclamationState().AcquireThreadRecord())
+		{}
+
+		~ThreadRecordOwner()
+		{
+			GetEpochReclamationState().ReleaseThreadRecord(mRecord);
+		}
+
+		ThreadRecordOwner(const ThreadRecordOwner& rhs) = delete;
+		ThreadRecordOwner& operator=(const ThreadRecordOwner& rhs) = delete;
+
+		ThreadRecordOwner(ThreadRecordOwner&& rhs) noexcept = delete;
+		ThreadRecordOwner& operator=(ThreadRecordOwner&& rhs) noexcept = delete;
+
+		ThreadRecord& GetRecord() const
+		{
+			return mRecord;
+		}
+
+	private:
+		ThreadRecord& mRecord;
+	};
+
+	ThreadRecord& GetCurrentThreadRecord()
+	{
+		// Make sure that the EpochReclamationState is constructed before the thread_local
+		// ThreadRecordOwner, so that it is destroyed after it.
+		GetEpochReclamationState();
+
+		thread_local ThreadRecordOwner recordOwner{};
+		return recordOwner.GetRecord();
+	}
+}
+
+namespace Brawler
+{
+	EpochGuard::EpochGuard()
+	{
+		GetEpochReclamationState().EnterCriticalSection(GetCurrentThreadRecord());
+	}
+
+	EpochGuard::~EpochGuard()
+	{
+		GetEpochReclamationState().ExitCriticalSection(GetCurrentThreadRecord());
+	}
+}
+
+namespace Util
+{
+	namespace EpochReclamation
+	{
+		void RetireObject(void* const objectPtr, void(*deleteFunction)(void*))
+		{
+			GetEpochReclamationState().RetireObject(GetCurrentThreadRecord(), objectPtr, deleteFunction);
+		}
+
+		void CollectRetiredObjects()
+		{
+			GetEpochReclamationState().CollectRetiredObjects(GetCurrentThreadRecord());
+		}
+
+		void WaitForReaders()
+		{
+			GetEpochReclamationState().WaitForReaders(GetCurrentThreadRecord());
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+module;
+#include <cstdint>
+
+export module Brawler.EpochReclamation;
+
+export namespace Brawler
+{
+	// Epoch-based reclamation lets lock-free data structures delete objects which other
+	// threads might still be reading. A thread which wants to read such objects creates an
+	// EpochGuard first. When an object is removed from a data structure, it is not deleted
+	// immediately; instead, it is passed to Util::EpochReclamation::RetireObject(). It is only
+	// deleted once every thread which could have still seen it has destroyed its EpochGuard.
+	//
+	// To make this cheap, we keep a global epoch counter. Creating an EpochGuard announces the
+	// current epoch, and the epoch can only advance once every thread with an active EpochGuard
+	// has announced it. Objects retired during epoch N can thus be deleted safely once the
+	// global epoch has reached N + 2. Creating and destroying an EpochGuard only ever writes to
+	// memory owned by the calling thread.
+	//
+	// NOTE: Holding an EpochGuard for a long time prevents *every* retired object from being
+	// deleted, so keep them short. In particular, do not hold one across a co_await or while
+	// waiting for jobs.
+
+	class EpochGuard
+	{
+	public:
+		EpochGuard();
+		~EpochGuard();
+
+		EpochGuard(const EpochGuard& rhs) = delete;
+		EpochGuard& operator=(const EpochGuard& rhs) = delete;
+
+		EpochGuard(EpochGuard&& rhs) noexcept = delete;
+		EpochGuard& operator=(EpochGuard&& rhs) noexcept = delete;
+	};
+}
+
+export namespace Util
+{
+	namespace EpochReclamation
+	{
+		/// <summary>
+		/// Schedules objectPtr to be deleted by calling deleteFunction(objectPtr) once no thread
+		/// which might still be accessing it has an active Brawler::EpochGuard. The object must
+		/// already be unreachable for threads which create an EpochGuard after this call.
+		///
+		/// This function may be called regardless of whether or not the calling thread has an
+		/// active Brawler::EpochGuard.
+		/// </summary>
+		void RetireObject(void* const objectPtr, void(*deleteFunction)(void*));
+
+		template <typename T>
+		void RetireObject(T* const objectPtr);
+
+		/// <summary>
+		/// Tries to advance the global epoch and deletes the objects retired by the calling
+		/// thread which are no longer accessible. This happens automatically every so often
+		/// when objects are retired, so calling it manually is only useful if a thread wants
+		/// to get rid of its retired objects before it goes idle.
+		/// </summary>
+		void CollectRetiredObjects();
+
+		/// <summary>
+		/// Blocks until every thread which had an active Brawler::EpochGuard when this function
+		/// was called has destroyed it. Once this returns, no thread can still be accessing an
+		/// object which was made unreachable before the call, even if that object was never
+		/// passed to RetireObject(). This is useful if such an object is owned by somebody else
+		/// who is about to destroy it.
+		///
+		/// The calling thread must *NOT* have an active Brawler::EpochGuard, or else it would
+		/// wait for itself forever.
+		/// </summary>
+		void WaitForReaders();
+	}
+}
+
+// -------------------------------------------------------------------------------------------------
+
+namespace Util
+{
+	namespace EpochReclamation
+	{
+		template <typename T>
+		void RetireObject(T* const objectPtr)
+		{
+			RetireObject(static_cast<void*>(objectPtr), [] (void* const retiredObjectPtr)
+			{
+				delete static_cast<T*>(retiredObjectPtr);
+			});
+		}
+	}
+}
\ No newline at end of file
@@ -1,26 +1,250 @@
 module;
-#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <algorithm>
+#include <bit>
 #include <limits>
-#include <optional>
+#include <functional>
+#include <utility>
 #include <cassert>
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define BRAWLER_FAST_UNORDERED_MAP_USE_SSE2
+#elif defined(_M_ARM64) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BRAWLER_FAST_UNORDERED_MAP_USE_NEON
+#endif
+
 export module Brawler.FastUnorderedMap;
 import Brawler.Functional;
 
+namespace Brawler
+{
+	namespace IMPL
+	{
+		// Every slot in a FastUnorderedMap has a corresponding control byte. If the slot contains
+		// an element, then its control byte holds the lower 7 bits of the element's (mixed) hash
+		// value, and its sign bit is cleared. Otherwise, the sign bit is set, and the byte tells
+		// us whether the slot has always been empty or whether it once held an element which was
+		// erased. We need to tell these apart because a lookup can only stop probing once it finds
+		// a slot which has always been empty.
+		using ControlByte = std::int8_t;
+
+		static constexpr ControlByte CONTROL_BYTE_EMPTY = static_cast<ControlByte>(-128);
+		static constexpr ControlByte CONTROL_BYTE_DELETED = static_cast<ControlByte>(-2);
+
+		static constexpr std::size_t CONTROL_GROUP_WIDTH = 16;
+
+		// The map is re-hashed once more than 7/8 of its slots are in use (including deleted
+		// slots). This is much higher than what a map with linear probing can tolerate, since
+		// probing sixteen slots at once costs about as much as probing one.
+		static constexpr std::size_t MAX_LOAD_FACTOR_NUMERATOR = 7;
+		static constexpr std::size_t MAX_LOAD_FACTOR_DENOMINATOR = 8;
+
+#if defined(BRAWLER_FAST_UNORDERED_MAP_USE_NEON)
+		// NEON has no equivalent of _mm_movemask_epi8(), so we narrow each byte of a comparison
+		// result down to four bits instead. We only keep the highest bit of each nibble so that
+		// every matching slot still corresponds to exactly one set bit.
+		static constexpr std::uint32_t CONTROL_MASK_BITS_PER_SLOT_SHIFT = 2;
+		static constexpr std::uint64_t CONTROL_MASK_VALID_BITS = 0x8888888888888888;
+#else
+		static constexpr std::uint32_t CONTROL_MASK_BITS_PER_SLOT_SHIFT = 0;
+		static constexpr std::uint64_t CONTROL_MASK_VALID_BITS = 0xFFFF;
+#endif
+
+		/// <summary>
+		/// A set of slots within a ControlGroup, with one bit per slot (or four bits per slot,
+		/// of which only one is ever set, on ARM). Iterating over a ControlMask yields the
+		/// offsets of the slots in the set, relative to the start of the group.
+		/// </summary>
+		class ControlMask
+		{
+		public:
+			explicit ControlMask(const std::uint64_t mask) :
+				mMask(mask)
+			{}
+
+			explicit operator bool() const
+			{
+				return (mMask != 0);
+			}
+
+			std::size_t GetLowestSlotOffset() const
+			{
+				return static_cast<std::size_t>(std::countr_zero(mMask) >> CONTROL_MASK_BITS_PER_SLOT_SHIFT);
+			}
+
+			void RemoveLowestSlot()
+			{
+				mMask &= (mMask - 1);
+			}
+
+			std::size_t GetLeadingSlotCount() const
+			{
+				// We need to ignore the bits past the end of the mask.
+				constexpr std::uint32_t UNUSED_BIT_COUNT = static_cast<std::uint32_t>(std::countl_zero(CONTROL_MASK_VALID_BITS));
+				return static_cast<std::size_t>((static_cast<std::uint32_t>(std::countl_zero(mMask)) - UNUSED_BIT_COUNT) >> CONTROL_MASK_BITS_PER_SLOT_SHIFT);
+			}
+
+			std::size_t GetTrailingSlotCount() const
+			{
+				return GetLowestSlotOffset();
+			}
+
+		private:
+			std::uint64_t mMask;
+		};
+
+		/// <summary>
+		/// A view of CONTROL_GROUP_WIDTH consecutive control bytes, which can be searched all at
+		/// once. On x86/x64, this uses SSE2; on ARM, it uses NEON. Elsewhere, we fall back to
+		/// checking each byte individually.
+		/// </summary>
+		class ControlGroup
+		{
+		public:
+			explicit ControlGroup(const ControlByte* const controlBytePtr) :
+#if defined(BRAWLER_FAST_UNORDERED_MAP_USE_SSE2)
+				mControlBytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(controlBytePtr)))
+#elif defined(BRAWLER_FAST_UNORDERED_MAP_USE_NEON)
+				mControlBytes(vld1q_s8(controlBytePtr))
+#else
+				mControlBytePtr(controlBytePtr)
+#endif
+			{}
+
+			/// <summary>
+			/// Returns the slots whose control byte matches hashTag. These are the only slots in
+			/// the group which can possibly contain the key we are looking for, but the keys still
+			/// need to be compared, since two different hash values can have the same tag.
+			/// </summary>
+			ControlMask Match(const ControlByte hashTag) const
+			{
+#if defined(BRAWLER_FAST_UNORDERED_MAP_USE_SSE2)
+				return ControlMask{ static_cast<std::uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(mControlBytes, _mm_set1_epi8(hashTag)))) };
+#elif defined(BRAWLER_FAST_UNORDERED_MAP_USE_NEON)
+				return CreateControlMask(vceqq_s8(mControlBytes, vdupq_n_s8(hashTag)));
+#else
+				return MatchIf([hashTag] (const ControlByte controlByte) { return (controlByte == hashTag); });
+#endif
+			}
+
+			ControlMask MatchEmpty() const
+			{
+				return Match(CONTROL_BYTE_EMPTY);
+			}
+
+			ControlMask MatchEmptyOrDeleted() const
+			{
+				// Both CONTROL_BYTE_EMPTY and CONTROL_BYTE_DELETED have their sign bit set, and no
+				// other control byte does.
+#if defined(BRAWLER_FAST_UNORDERED_MAP_USE_SSE2)
+				return ControlMask{ static_cast<std::uint64_t>(_mm_movemask_epi8(mControlBytes)) };
+#elif defined(BRAWLER_FAST_UNORDERED_MAP_USE_NEON)
+				return CreateControlMask(vcltzq_s8(mControlBytes));
+#else
+				return MatchIf([] (const ControlByte controlByte) { return (controlByte < 0); });
+#endif
+			}
+
+		private:
+#if defined(BRAWLER_FAST_UNORDERED_MAP_USE_NEON)
+			static ControlMask CreateControlMask(const uint8x16_t comparisonResult)
+			{
+				const uint8x8_t narrowedResult = vshrn_n_u16(vreinterpretq_u16_u8(comparisonResult), 4);
+				return ControlMask{ vget_lane_u64(vreinterpret_u64_u8(narrowedResult), 0) & CONTROL_MASK_VALID_BITS };
+			}
+#elif !defined(BRAWLER_FAST_UNORDERED_MAP_USE_SSE2)
+			template <typename Predicate>
+			ControlMask MatchIf(const Predicate& predicate) const
+			{
+				std::uint64_t mask = 0;
+
+				for (std::size_t i = 0; i < CONTROL_GROUP_WIDTH; ++i)
+				{
+					if (predicate(mControlBytePtr[i]))
+						mask |= (std::uint64_t{ 1 } << i);
+				}
+
+				return ControlMask{ mask };
+			}
+#endif
+
+		private:
+#if defined(BRAWLER_FAST_UNORDERED_MAP_USE_SSE2)
+			__m128i mControlBytes;
+#elif defined(BRAWLER_FAST_UNORDERED_MAP_USE_NEON)
+			int8x16_t mControlBytes;
+#else
+			const ControlByte* mControlBytePtr;
+#endif
+		};
+
+		struct HashInfo
+		{
+			/// <summary>
+			/// The index of the first slot whose group is searched for the key.
+			/// </summary>
+			std::size_t ProbeStartIndex;
+
+			/// <summary>
+			/// The value stored in the control byte of the slot which contains the key.
+			/// </summary>
+			ControlByte HashTag;
+		};
+
+		/// <summary>
+		/// Mixes the bits of the value returned by the Hasher before we split it into the probe
+		/// start index and the hash tag. We need this because std::hash is allowed to be the
+		/// identity function for integers and pointers, and pointers to heap-allocated objects
+		/// would then all have the same upper (and lower) bits.
+		/// </summary>
+		inline std::uint64_t MixHashValue(std::uint64_t hashValue)
+		{
+			hashValue ^= (hashValue >> 33);
+			hashValue *= 0xFF51AFD7ED558CCD;
+			hashValue ^= (hashValue >> 33);
+
+			return hashValue;
+		}
+	}
+}
+
 export namespace Brawler
 {
-	template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+	// Brawler::FastUnorderedMap is an open-addressing hash map in the style of Abseil's
+	// "Swiss tables." Alongside the array of slots, we keep an array with one control byte per
+	// slot, and a lookup checks the control bytes of sixteen slots at once with a single SIMD
+	// comparison. Only the slots whose control byte matches the key's 7-bit hash tag have their
+	// keys compared, so even a long probe sequence rarely touches more than one slot.
+	//
+	// The slots store the key and the value directly, so unlike a std::unordered_map, inserting
+	// an element never allocates memory unless the map needs to grow. Note, however, that this
+	// means that pointers and references to elements are invalidated whenever the map is
+	// re-hashed.
+
+	template <typename Key, typename Value, typename Hasher = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
 	class FastUnorderedMap
 	{
 	private:
-		struct MapElement
+		struct MapSlot
 		{
-			std::optional<Value> Data;
-			std::size_t KeyHash;
+			template <typename... Args>
+			MapSlot(const Key& key, Args&&... args) :
+				SlotKey(key),
+				SlotValue{ std::forward<Args>(args)... }
+			{}
+
+			Key SlotKey;
+			Value SlotValue;
 		};
 
 	public:
-		explicit constexpr FastUnorderedMap(const std::size_t expectedSize = 0);
+		explicit FastUnorderedMap(const std::size_t expectedSize = 0);
+
+		~FastUnorderedMap();
 
 		// Although there is technically nothing wrong with allowing copying of
 		// FastUnorderedMap instances, we want this class to be *fast*, and copying is
@@ -29,62 +253,113 @@ export namespace Brawler
 		FastUnorderedMap(const FastUnorderedMap& rhs) = delete;
 		FastUnorderedMap& operator=(const FastUnorderedMap& rhs) = delete;
 
-		constexpr FastUnorderedMap(FastUnorderedMap&& rhs) noexcept = default;
-		constexpr FastUnorderedMap& operator=(FastUnorderedMap&& rhs) noexcept = default;
+		FastUnorderedMap(FastUnorderedMap&& rhs) noexcept;
+		FastUnorderedMap& operator=(FastUnorderedMap&& rhs) noexcept;
 
 		template <typename... Args>
 			requires requires (Args&&... args)
 		{
 			Value{ std::forward<Args>(args)... };
 		}
-		constexpr bool TryEmplace(const Key& key, Args&&... args);
+		bool TryEmplace(const Key& key, Args&&... args);
+
+		Value& operator[](const Key& key) requires std::is_default_constructible_v<Value>;
+
+		Value& At(const Key& key);
+		const Value& At(const Key& key) const;
 
-		constexpr Value& operator[](const Key& key) requires std::is_default_constructible_v<Value>;
+		bool Contains(const Key& key) const;
+
+		/// <summary>
+		/// Removes the element associated with key from the map, if it exists. The slot which
+		/// contained the element is marked as deleted, rather than empty, unless we can prove
+		/// that no probe sequence has ever continued past it. Deleted slots are re-used by later
+		/// insertions, and they are removed entirely the next time the map is re-hashed.
+		/// </summary>
+		/// <returns>
+		/// The function returns true if an element was removed and false otherwise.
+		/// </returns>
+		bool Erase(const Key& key);
 
-		constexpr Value& At(const Key& key);
-		constexpr const Value& At(const Key& key) const;
+		/// <summary>
+		/// Destroys every element in the map. The map keeps its capacity.
+		/// </summary>
+		void Clear();
 
-		constexpr bool Contains(const Key& key) const;
+		std::size_t GetSize() const;
+		bool Empty() const;
 
 		/// <summary>
-		/// Reserves exactly newCapacity slots in the underlying bucket array, but only if
-		/// newCapacity is greater than the size of said bucket array.
-		/// 
-		/// Since this reservation is exact, you might benefit from increasing it slightly
-		/// past what you might expect. For instance, if you are expecting the map to contain
-		/// X elements created from pointer hashes, you might want to specify (X * 2) as the
-		/// value for newCapacity. Doing this can help reduce the load factor and thus reduce
-		/// the chances of a re-hash occurring.
-		/// 
+		/// Ensures that the map can hold at least newCapacity elements without being re-hashed.
+		/// The underlying slot array always has a power-of-two size, and no more than 7/8 of its
+		/// slots are ever used, so the actual capacity might be higher than requested.
+		///
 		/// *NOTE*: This function can trigger a re-hash. After calling it, all cached pointers
 		/// to elements in the FastUnorderedMap instance should be considered invalid.
 		/// </summary>
 		/// <param name="newCapacity">
-		/// - The size, in elements, of the underlying bucket array.
+		/// - The number of elements which the map should be able to hold.
 		/// </param>
-		constexpr void Reserve(const std::size_t newCapacity);
+		void Reserve(const std::size_t newCapacity);
 
 		template <Brawler::Function<void, Value&> Callback>
-		constexpr void ForEach(const Callback& callback);
+		void ForEach(const Callback& callback);
 
 		template <Brawler::Function<void, const Value&> Callback>
-		constexpr void ForEach(const Callback& callback) const;
+		void ForEach(const Callback& callback) const;
 
 	private:
+		static IMPL::HashInfo HashKey(const Key& key);
+
+		static constexpr std::size_t GetMaxElementCount(const std::size_t slotCount);
+		static constexpr std::size_t GetRequiredSlotCount(const std::size_t elementCount);
+
 		/// <summary>
-		/// Doubles the size of the underlying array to allow for additional entries. Doing
-		/// this will likely result in shifting element locations.
+		/// Returns the index of the slot containing key, or INVALID_SLOT_INDEX if the map does not
+		/// contain key.
 		/// </summary>
-		constexpr void ReHash();
+		std::size_t FindSlotIndex(const Key& key, const IMPL::HashInfo& hashInfo) const;
 
-		constexpr void ReHash(const std::size_t newSize);
+		/// <summary>
+		/// Returns the index of the first slot in the probe sequence described by hashInfo
+		/// which is either empty or deleted. There must be at least one such slot.
+		/// </summary>
+		std::size_t FindInsertionSlotIndex(const IMPL::HashInfo& hashInfo) const;
 
-		constexpr float CalculateLoadFactor() const;
+		template <typename... Args>
+		MapSlot& EmplaceNewSlot(const Key& key, const IMPL::HashInfo& hashInfo, Args&&... args);
+
+		void SetControlByte(const std::size_t slotIndex, const IMPL::ControlByte controlByte);
+
+		/// <summary>
+		/// Called when an insertion finds that the map has no room left. If enough of the used
+		/// slots are deleted slots, then the map is re-hashed with the same capacity, which
+		/// removes them. Otherwise, the slot count is doubled.
+		/// </summary>
+		void ReHashForInsertion();
+
+		void ReHash(const std::size_t newSlotCount);
+
+		void DestroyAllElements();
+		void ReleaseMemory();
 
 	private:
-		std::vector<MapElement> mElementArr;
+		static constexpr std::size_t INVALID_SLOT_INDEX = std::numeric_limits<std::size_t>::max();
+
+		// The control byte array contains (mSlotCount + IMPL::CONTROL_GROUP_WIDTH) bytes. The last
+		// IMPL::CONTROL_GROUP_WIDTH bytes mirror the first ones, so that we can load a full
+		// ControlGroup starting at any slot without having to worry about wrapping around.
+		std::unique_ptr<IMPL::ControlByte[]> mControlByteArr;
+		MapSlot* mSlotArr;
+		std::size_t mSlotCount;
 		std::size_t mNumExistingElements;
+
+		// This is the number of elements which can be inserted before the map needs to be
+		// re-hashed. Inserting into a deleted slot does not decrease it.
+		std::size_t mRemainingGrowthCount;
+
 		inline static Hasher mHasher = Hasher{};
+		inline static KeyEqual mKeyEqual = KeyEqual{};
 	};
 }
 
@@ -92,259 +367,391 @@ export namespace Brawler
 
 namespace Brawler
 {
-	static constexpr float LOAD_FACTOR_REHASH_THRESHOLD = 0.7f;
-}
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	FastUnorderedMap<Key, Value, Hasher, KeyEqual>::FastUnorderedMap(const std::size_t expectedSize) :
+		mControlByteArr(),
+		mSlotArr(nullptr),
+		mSlotCount(0),
+		mNumExistingElements(0),
+		mRemainingGrowthCount(0)
+	{
+		// An empty FastUnorderedMap does not allocate any memory until the first element is
+		// inserted.
+		if (expectedSize > 0)
+			Reserve(expectedSize);
+	}
 
-namespace Brawler
-{
-	template <typename Key, typename Value, typename Hasher>
-	constexpr FastUnorderedMap<Key, Value, Hasher>::FastUnorderedMap(const std::size_t expectedSize) :
-		mElementArr(),
-		mNumExistingElements(0)
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	FastUnorderedMap<Key, Value, Hasher, KeyEqual>::~FastUnorderedMap()
 	{
-		mElementArr.resize(std::max<std::size_t>(expectedSize, 1));
+		ReleaseMemory();
 	}
 
-	template <typename Key, typename Value, typename Hasher>
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	FastUnorderedMap<Key, Value, Hasher, KeyEqual>::FastUnorderedMap(FastUnorderedMap&& rhs) noexcept :
+		mControlByteArr(std::move(rhs.mControlByteArr)),
+		mSlotArr(std::exchange(rhs.mSlotArr, nullptr)),
+		mSlotCount(std::exchange(rhs.mSlotCount, 0)),
+		mNumExistingElements(std::exchange(rhs.mNumExistingElements, 0)),
+		mRemainingGrowthCount(std::exchange(rhs.mRemainingGrowthCount, 0))
+	{}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	FastUnorderedMap<Key, Value, Hasher, KeyEqual>& FastUnorderedMap<Key, Value, Hasher, KeyEqual>::operator=(FastUnorderedMap&& rhs) noexcept
+	{
+		if (this == &rhs) [[unlikely]]
+			return *this;
+
+		ReleaseMemory();
+
+		mControlByteArr = std::move(rhs.mControlByteArr);
+		mSlotArr = std::exchange(rhs.mSlotArr, nullptr);
+		mSlotCount = std::exchange(rhs.mSlotCount, 0);
+		mNumExistingElements = std::exchange(rhs.mNumExistingElements, 0);
+		mRemainingGrowthCount = std::exchange(rhs.mRemainingGrowthCount, 0);
+
+		return *this;
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
 	template <typename... Args>
 		requires requires (Args&&... args)
 	{
 		Value{ std::forward<Args>(args)... };
 	}
-	constexpr bool FastUnorderedMap<Key, Value, Hasher>::TryEmplace(const Key& key, Args&&... args)
+	bool FastUnorderedMap<Key, Value, Hasher, KeyEqual>::TryEmplace(const Key& key, Args&&... args)
 	{
-		const std::size_t keyHash = mHasher(key);
+		const IMPL::HashInfo hashInfo{ HashKey(key) };
 
-		if (CalculateLoadFactor() >= LOAD_FACTOR_REHASH_THRESHOLD) [[unlikely]]
-			ReHash();
-		
-		while (true)
-		{
-			std::size_t currIndex = (keyHash % mElementArr.size());
+		if (FindSlotIndex(key, hashInfo) != INVALID_SLOT_INDEX)
+			return false;
 
-			for (std::size_t numIterations = 0; numIterations < mElementArr.size(); ++numIterations)
-			{
-				MapElement& currElement{ mElementArr[currIndex] };
+		EmplaceNewSlot(key, hashInfo, std::forward<Args>(args)...);
+		return true;
+	}
 
-				if (!currElement.Data.has_value())
-				{
-					currElement.Data.emplace(std::forward<Args>(args)...);
-					currElement.KeyHash = keyHash;
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	Value& FastUnorderedMap<Key, Value, Hasher, KeyEqual>::operator[](const Key& key) requires std::is_default_constructible_v<Value>
+	{
+		const IMPL::HashInfo hashInfo{ HashKey(key) };
 
-					++mNumExistingElements;
+		// First, try finding an existing value in the map.
+		const std::size_t slotIndex = FindSlotIndex(key, hashInfo);
 
-					return true;
-				}
+		if (slotIndex != INVALID_SLOT_INDEX)
+			return mSlotArr[slotIndex].SlotValue;
 
-				else if (currElement.KeyHash == keyHash)
-					return false;
+		// If that failed, then we construct the element.
+		return EmplaceNewSlot(key, hashInfo).SlotValue;
+	}
 
-				currIndex = ((currIndex + 1) % mElementArr.size());
-			}
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	Value& FastUnorderedMap<Key, Value, Hasher, KeyEqual>::At(const Key& key)
+	{
+		const std::size_t slotIndex = FindSlotIndex(key, HashKey(key));
+		assert(slotIndex != INVALID_SLOT_INDEX && "ERROR: FastUnorderedMap::At() was called to retrieve an existing element associated with a given key, but no such element exists!");
 
-			ReHash();
-		}
+		return mSlotArr[slotIndex].SlotValue;
 	}
 
-	template <typename Key, typename Value, typename Hasher>
-	constexpr Value& FastUnorderedMap<Key, Value, Hasher>::operator[](const Key& key) requires std::is_default_constructible_v<Value>
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	const Value& FastUnorderedMap<Key, Value, Hasher, KeyEqual>::At(const Key& key) const
 	{
-		const std::size_t keyHash = mHasher(key);
-		std::size_t currIndex = (keyHash % mElementArr.size());
+		const std::size_t slotIndex = FindSlotIndex(key, HashKey(key));
+		assert(slotIndex != INVALID_SLOT_INDEX && "ERROR: FastUnorderedMap::At() was called to retrieve an existing element associated with a given key, but no such element exists!");
 
-		// First, try finding an existing value in the map.
-		for (std::size_t numIterations = 0; numIterations < mElementArr.size(); ++numIterations)
-		{
-			MapElement& currElement{ mElementArr[currIndex] };
+		return mSlotArr[slotIndex].SlotValue;
+	}
 
-			if (currElement.Data.has_value() && currElement.KeyHash == keyHash)
-				return *(currElement.Data);
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	bool FastUnorderedMap<Key, Value, Hasher, KeyEqual>::Contains(const Key& key) const
+	{
+		return (FindSlotIndex(key, HashKey(key)) != INVALID_SLOT_INDEX);
+	}
 
-			else if (!currElement.Data.has_value())
-				break;
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	bool FastUnorderedMap<Key, Value, Hasher, KeyEqual>::Erase(const Key& key)
+	{
+		const std::size_t slotIndex = FindSlotIndex(key, HashKey(key));
 
-			currIndex = ((currIndex + 1) % mElementArr.size());
-		}
+		if (slotIndex == INVALID_SLOT_INDEX)
+			return false;
 
-		// If that failed, then we construct the element.
-		{
-			const bool tryEmplaceResult = TryEmplace(key);
-			assert(tryEmplaceResult);
-		}
+		std::destroy_at(mSlotArr + slotIndex);
+		--mNumExistingElements;
 
-		// At this point, the element should definitely be constructed.
-		return At(key);
-	}
+		// If there is an empty slot within IMPL::CONTROL_GROUP_WIDTH slots both before and after
+		// this one, then every window of IMPL::CONTROL_GROUP_WIDTH slots containing this slot also
+		// contains an empty slot. In that case, no lookup could have ever probed past this slot's
+		// group because of it, so we can mark it as empty again and get its slot back for free.
+		const std::size_t slotIndexMask = (mSlotCount - 1);
+		const std::size_t precedingGroupIndex = ((slotIndex - IMPL::CONTROL_GROUP_WIDTH) & slotIndexMask);
 
-	template <typename Key, typename Value, typename Hasher>
-	constexpr Value& FastUnorderedMap<Key, Value, Hasher>::At(const Key& key)
-	{
-		assert(Contains(key) && "ERROR: FastUnorderedMap::At() was called to retrieve an existing element associated with a given key, but no such element exists!");
-		
-		const std::size_t keyHash = mHasher(key);
-		std::size_t currIndex = (keyHash % mElementArr.size());
+		const IMPL::ControlMask precedingEmptyMask{ IMPL::ControlGroup{ mControlByteArr.get() + precedingGroupIndex }.MatchEmpty() };
+		const IMPL::ControlMask followingEmptyMask{ IMPL::ControlGroup{ mControlByteArr.get() + slotIndex }.MatchEmpty() };
 
-		for (std::size_t numIterations = 0; numIterations < mElementArr.size(); ++numIterations)
+		const bool wasNeverFull = (precedingEmptyMask && followingEmptyMask && (precedingEmptyMask.GetLeadingSlotCount() + followingEmptyMask.GetTrailingSlotCount()) < IMPL::CONTROL_GROUP_WIDTH);
+
+		if (wasNeverFull)
 		{
-			MapElement& currElement{ mElementArr[currIndex] };
+			SetControlByte(slotIndex, IMPL::CONTROL_BYTE_EMPTY);
+			++mRemainingGrowthCount;
+		}
+		else
+			SetControlByte(slotIndex, IMPL::CONTROL_BYTE_DELETED);
 
-			// We add [[likely]] here because average lookup time is O(1), and because when we
-			// call FastUnorderedMap::At(), we expect the element to exist.
-			if (currElement.Data.has_value() && currElement.KeyHash == keyHash) [[likely]]
-				return *(currElement.Data);
+		return true;
+	}
 
-			else if (!currElement.Data.has_value())
-				break;
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	void FastUnorderedMap<Key, Value, Hasher, KeyEqual>::Clear()
+	{
+		if (mSlotCount == 0)
+			return;
 
-			currIndex = ((currIndex + 1) % mElementArr.size());
-		}
+		DestroyAllElements();
 
-		// Since we assert that the map contains the specified key, this should be unreachable.
-		std::unreachable();
+		std::fill_n(mControlByteArr.get(), (mSlotCount + IMPL::CONTROL_GROUP_WIDTH), IMPL::CONTROL_BYTE_EMPTY);
+		mNumExistingElements = 0;
+		mRemainingGrowthCount = GetMaxElementCount(mSlotCount);
+	}
 
-		// Well, we've already invoked undefined behavior by calling std::unreachable(), so...
-		return reinterpret_cast<Value&>(*this);
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	std::size_t FastUnorderedMap<Key, Value, Hasher, KeyEqual>::GetSize() const
+	{
+		return mNumExistingElements;
 	}
 
-	template <typename Key, typename Value, typename Hasher>
-	constexpr const Value& FastUnorderedMap<Key, Value, Hasher>::At(const Key& key) const
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	bool FastUnorderedMap<Key, Value, Hasher, KeyEqual>::Empty() const
 	{
-		assert(Contains(key) && "ERROR: FastUnorderedMap::At() was called to retrieve an existing element associated with a given key, but no such element exists!");
+		return (mNumExistingElements == 0);
+	}
 
-		const std::size_t keyHash = mHasher(key);
-		std::size_t currIndex = (keyHash % mElementArr.size());
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	void FastUnorderedMap<Key, Value, Hasher, KeyEqual>::Reserve(const std::size_t newCapacity)
+	{
+		const std::size_t requiredSlotCount = GetRequiredSlotCount(newCapacity);
 
-		for (std::size_t numIterations = 0; numIterations < mElementArr.size(); ++numIterations)
-		{
-			MapElement& currElement{ mElementArr[currIndex] };
+		if (requiredSlotCount <= mSlotCount)
+			return;
 
-			// We add [[likely]] here because average lookup time is O(1), and because when we
-			// call FastUnorderedMap::At(), we expect the element to exist.
-			if (currElement.Data.has_value() && currElement.KeyHash == keyHash) [[likely]]
-				return *(currElement.Data);
+		ReHash(requiredSlotCount);
+	}
 
-			else if (!currElement.Data.has_value())
-				break;
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	template <Brawler::Function<void, Value&> Callback>
+	void FastUnorderedMap<Key, Value, Hasher, KeyEqual>::ForEach(const Callback& callback)
+	{
+		for (std::size_t i = 0; i < mSlotCount; ++i)
+		{
+			if (mControlByteArr[i] >= 0)
+				callback(mSlotArr[i].SlotValue);
+		}
+	}
 
-			currIndex = ((currIndex + 1) % mElementArr.size());
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	template <Brawler::Function<void, const Value&> Callback>
+	void FastUnorderedMap<Key, Value, Hasher, KeyEqual>::ForEach(const Callback& callback) const
+	{
+		for (std::size_t i = 0; i < mSlotCount; ++i)
+		{
+			if (mControlByteArr[i] >= 0)
+				callback(mSlotArr[i].SlotValue);
 		}
+	}
 
-		// Since we assert that the map contains the specified key, this should be unreachable.
-		std::unreachable();
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	IMPL::HashInfo FastUnorderedMap<Key, Value, Hasher, KeyEqual>::HashKey(const Key& key)
+	{
+		const std::uint64_t mixedHashValue = IMPL::MixHashValue(static_cast<std::uint64_t>(mHasher(key)));
+
+		// The lower 7 bits become the hash tag, and the remaining bits decide where the probe
+		// sequence starts. Using separate bits for these means that keys which start probing in
+		// the same group are still unlikely to have the same tag.
+		return IMPL::HashInfo{
+			.ProbeStartIndex = static_cast<std::size_t>(mixedHashValue >> 7),
+			.HashTag = static_cast<IMPL::ControlByte>(mixedHashValue & 0x7F)
+		};
+	}
 
-		// Well, we've already invoked undefined behavior by calling std::unreachable(), so...
-		return reinterpret_cast<const Value&>(*this);
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	constexpr std::size_t FastUnorderedMap<Key, Value, Hasher, KeyEqual>::GetMaxElementCount(const std::size_t slotCount)
+	{
+		return ((slotCount / IMPL::MAX_LOAD_FACTOR_DENOMINATOR) * IMPL::MAX_LOAD_FACTOR_NUMERATOR);
 	}
 
-	template <typename Key, typename Value, typename Hasher>
-	constexpr bool FastUnorderedMap<Key, Value, Hasher>::Contains(const Key& key) const
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	constexpr std::size_t FastUnorderedMap<Key, Value, Hasher, KeyEqual>::GetRequiredSlotCount(const std::size_t elementCount)
 	{
-		const std::size_t keyHash = mHasher(key);
-		std::size_t currIndex = (keyHash % mElementArr.size());
+		// We never use fewer slots than fit into a single ControlGroup. This way, the mirrored
+		// control bytes at the end of the control byte array never overlap with each other.
+		const std::size_t minimumSlotCount = (((elementCount * IMPL::MAX_LOAD_FACTOR_DENOMINATOR) + IMPL::MAX_LOAD_FACTOR_NUMERATOR - 1) / IMPL::MAX_LOAD_FACTOR_NUMERATOR);
+		return std::bit_ceil(std::max(minimumSlotCount, IMPL::CONTROL_GROUP_WIDTH));
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	std::size_t FastUnorderedMap<Key, Value, Hasher, KeyEqual>::FindSlotIndex(const Key& key, const IMPL::HashInfo& hashInfo) const
+	{
+		if (mNumExistingElements == 0)
+			return INVALID_SLOT_INDEX;
 
-		for (std::size_t numIterations = 0; numIterations < mElementArr.size(); ++numIterations)
+		// We probe one group at a time, jumping ahead by one more group each time. Since
+		// mSlotCount is a power of two, this triangular sequence visits every group exactly once
+		// before it repeats itself. We are guaranteed to find an empty slot before that happens,
+		// since the map is never completely full.
+		const std::size_t slotIndexMask = (mSlotCount - 1);
+		std::size_t currGroupIndex = (hashInfo.ProbeStartIndex & slotIndexMask);
+
+		for (std::size_t probeDistance = IMPL::CONTROL_GROUP_WIDTH; true; probeDistance += IMPL::CONTROL_GROUP_WIDTH)
 		{
-			const MapElement& currElement{ mElementArr[currIndex] };
+			const IMPL::ControlGroup currGroup{ mControlByteArr.get() + currGroupIndex };
+
+			for (IMPL::ControlMask matchMask{ currGroup.Match(hashInfo.HashTag) }; matchMask; matchMask.RemoveLowestSlot())
+			{
+				const std::size_t currSlotIndex = ((currGroupIndex + matchMask.GetLowestSlotOffset()) & slotIndexMask);
 
-			if (currElement.Data.has_value() && currElement.KeyHash == keyHash)
-				return true;
+				if (mKeyEqual(mSlotArr[currSlotIndex].SlotKey, key)) [[likely]]
+					return currSlotIndex;
+			}
 
-			else if (!currElement.Data.has_value())
-				return false;
+			if (currGroup.MatchEmpty()) [[likely]]
+				return INVALID_SLOT_INDEX;
 
-			currIndex = ((currIndex + 1) % mElementArr.size());
+			currGroupIndex = ((currGroupIndex + probeDistance) & slotIndexMask);
 		}
-
-		return false;
 	}
 
-	template <typename Key, typename Value, typename Hasher>
-	constexpr void FastUnorderedMap<Key, Value, Hasher>::Reserve(const std::size_t newCapacity)
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	std::size_t FastUnorderedMap<Key, Value, Hasher, KeyEqual>::FindInsertionSlotIndex(const IMPL::HashInfo& hashInfo) const
 	{
-		if (newCapacity <= mElementArr.size())
-			return;
+		assert(mSlotCount > 0);
 
-		ReHash(newCapacity);
-	}
+		const std::size_t slotIndexMask = (mSlotCount - 1);
+		std::size_t currGroupIndex = (hashInfo.ProbeStartIndex & slotIndexMask);
 
-	template <typename Key, typename Value, typename Hasher>
-	template <Brawler::Function<void, Value&> Callback>
-	constexpr void FastUnorderedMap<Key, Value, Hasher>::ForEach(const Callback& callback)
-	{
-		for (auto& element : mElementArr)
+		for (std::size_t probeDistance = IMPL::CONTROL_GROUP_WIDTH; true; probeDistance += IMPL::CONTROL_GROUP_WIDTH)
 		{
-			if (element.Data.has_value())
-				callback(*(element.Data));
+			const IMPL::ControlMask availableSlotMask{ IMPL::ControlGroup{ mControlByteArr.get() + currGroupIndex }.MatchEmptyOrDeleted() };
+
+			if (availableSlotMask) [[likely]]
+				return ((currGroupIndex + availableSlotMask.GetLowestSlotOffset()) & slotIndexMask);
+
+			currGroupIndex = ((currGroupIndex + probeDistance) & slotIndexMask);
 		}
 	}
 
-	template <typename Key, typename Value, typename Hasher>
-	template <Brawler::Function<void, const Value&> Callback>
-	constexpr void FastUnorderedMap<Key, Value, Hasher>::ForEach(const Callback& callback) const
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	template <typename... Args>
+	typename FastUnorderedMap<Key, Value, Hasher, KeyEqual>::MapSlot& FastUnorderedMap<Key, Value, Hasher, KeyEqual>::EmplaceNewSlot(const Key& key, const IMPL::HashInfo& hashInfo, Args&&... args)
 	{
-		for (const auto& element : mElementArr)
+		std::size_t slotIndex = (mSlotCount > 0 ? FindInsertionSlotIndex(hashInfo) : INVALID_SLOT_INDEX);
+
+		// Re-using a deleted slot does not bring us any closer to needing a re-hash, so we can
+		// only run out of room if we are about to use an empty slot.
+		if (slotIndex == INVALID_SLOT_INDEX || (mControlByteArr[slotIndex] == IMPL::CONTROL_BYTE_EMPTY && mRemainingGrowthCount == 0)) [[unlikely]]
 		{
-			if (element.Data.has_value())
-				callback(*(element.Data));
+			ReHashForInsertion();
+			slotIndex = FindInsertionSlotIndex(hashInfo);
 		}
+
+		MapSlot* const slotPtr = std::construct_at(mSlotArr + slotIndex, key, std::forward<Args>(args)...);
+
+		if (mControlByteArr[slotIndex] == IMPL::CONTROL_BYTE_EMPTY)
+			--mRemainingGrowthCount;
+
+		SetControlByte(slotIndex, hashInfo.HashTag);
+		++mNumExistingElements;
+
+		return *slotPtr;
+	}
+
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	void FastUnorderedMap<Key, Value, Hasher, KeyEqual>::SetControlByte(const std::size_t slotIndex, const IMPL::ControlByte controlByte)
+	{
+		mControlByteArr[slotIndex] = controlByte;
+
+		// Keep the mirrored control bytes at the end of the array up to date.
+		if (slotIndex < IMPL::CONTROL_GROUP_WIDTH)
+			mControlByteArr[mSlotCount + slotIndex] = controlByte;
 	}
 
-	template <typename Key, typename Value, typename Hasher>
-	constexpr void FastUnorderedMap<Key, Value, Hasher>::ReHash()
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	void FastUnorderedMap<Key, Value, Hasher, KeyEqual>::ReHashForInsertion()
 	{
-		ReHash(mElementArr.size() * 2);
+		// If fewer than half of the slots we are allowed to use hold elements, then most of the
+		// used slots must be deleted slots. Re-hashing with the same number of slots gets rid of
+		// them, and it does not grow the map just because elements are frequently inserted and
+		// erased.
+		if (mSlotCount > 0 && (mNumExistingElements * 2) < GetMaxElementCount(mSlotCount))
+			ReHash(mSlotCount);
+		else
+			ReHash(std::max(mSlotCount * 2, IMPL::CONTROL_GROUP_WIDTH));
 	}
 
-	template <typename Key, typename Value, typename Hasher>
-	constexpr void FastUnorderedMap<Key, Value, Hasher>::ReHash(const std::size_t newSize)
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	void FastUnorderedMap<Key, Value, Hasher, KeyEqual>::ReHash(const std::size_t newSlotCount)
 	{
-		assert(newSize > mElementArr.size());
-		std::size_t currExpandedSize = newSize;
-		bool executeReHash = true;
+		assert(std::has_single_bit(newSlotCount) && newSlotCount >= IMPL::CONTROL_GROUP_WIDTH);
+		assert(GetMaxElementCount(newSlotCount) >= mNumExistingElements);
+
+		std::unique_ptr<IMPL::ControlByte[]> oldControlByteArr{ std::move(mControlByteArr) };
+		MapSlot* const oldSlotArr = mSlotArr;
+		const std::size_t oldSlotCount = mSlotCount;
 
-		while (executeReHash)
+		mControlByteArr = std::make_unique_for_overwrite<IMPL::ControlByte[]>(newSlotCount + IMPL::CONTROL_GROUP_WIDTH);
+		std::fill_n(mControlByteArr.get(), (newSlotCount + IMPL::CONTROL_GROUP_WIDTH), IMPL::CONTROL_BYTE_EMPTY);
+
+		mSlotArr = std::allocator<MapSlot>{}.allocate(newSlotCount);
+		mSlotCount = newSlotCount;
+
+		for (std::size_t i = 0; i < oldSlotCount; ++i)
 		{
-			executeReHash = false;
-			
-			std::vector<MapElement> newElementArr{};
-			newElementArr.resize(currExpandedSize);
+			if (oldControlByteArr[i] < 0)
+				continue;
 
-			for (auto&& element : mElementArr)
-			{
-				if (!element.Data.has_value())
-					continue;
+			MapSlot& oldSlot{ oldSlotArr[i] };
+			const IMPL::HashInfo hashInfo{ HashKey(oldSlot.SlotKey) };
+			const std::size_t newSlotIndex = FindInsertionSlotIndex(hashInfo);
 
-				std::size_t currIndex = (element.KeyHash % newElementArr.size());
-				std::size_t numIterations = 0;
+			std::construct_at(mSlotArr + newSlotIndex, std::move(oldSlot));
+			std::destroy_at(&oldSlot);
 
-				while (newElementArr[currIndex].Data.has_value() && numIterations < newElementArr.size())
-				{
-					currIndex = ((currIndex + 1) % newElementArr.size());
-					++numIterations;
-				}
+			SetControlByte(newSlotIndex, hashInfo.HashTag);
+		}
 
-				if (numIterations == newElementArr.size()) [[unlikely]]
-				{
-					executeReHash = true;
-					break;
-				}
-				else [[likely]]
-				{
-					assert(!(newElementArr[currIndex].Data.has_value()));
-					newElementArr[currIndex] = std::move(element);
-				}
-			}
+		mRemainingGrowthCount = (GetMaxElementCount(newSlotCount) - mNumExistingElements);
+
+		if (oldSlotArr != nullptr)
+			std::allocator<MapSlot>{}.deallocate(oldSlotArr, oldSlotCount);
+	}
 
-			if (executeReHash)
-				currExpandedSize *= 2;
-			else
-				mElementArr = std::move(newElementArr);
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	void FastUnorderedMap<Key, Value, Hasher, KeyEqual>::DestroyAllElements()
+	{
+		if constexpr (!std::is_trivially_destructible_v<MapSlot>)
+		{
+			for (std::size_t i = 0; i < mSlotCount; ++i)
+			{
+				if (mControlByteArr[i] >= 0)
+					std::destroy_at(mSlotArr + i);
+			}
 		}
 	}
 
-	template <typename Key, typename Value, typename Hasher>
-	constexpr float FastUnorderedMap<Key, Value, Hasher>::CalculateLoadFactor() const
+	template <typename Key, typename Value, typename Hasher, typename KeyEqual>
+	void FastUnorderedMap<Key, Value, Hasher, KeyEqual>::ReleaseMemory()
 	{
-		return (static_cast<float>(mNumExistingElements) / static_cast<float>(mElementArr.size()));
+		if (mSlotArr == nullptr)
+			return;
+
+		DestroyAllElements();
+		std::allocator<MapSlot>{}.deallocate(mSlotArr, mSlotCount);
+
+		mControlByteArr.reset();
+		mSlotArr = nullptr;
+		mSlotCount = 0;
+		mNumExistingElements = 0;
+		mRemainingGrowthCount = 0;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,384 @@
+module;
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <optional>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <functional>
+#include <array>
+#include <utility>
+
+module Tests.FastUnorderedMapTest;
+import Brawler.FastUnorderedMap;
+import Brawler.Timer;
+
+namespace
+{
+	// DISCLAIMER: Just like the job system tests in the Brawler Engine, the timings here are not
+	// rigorous benchmarks. They are meant to give a rough idea of how the different maps compare
+	// for the access patterns which we actually have.
+
+	constexpr std::size_t RANDOM_OPERATION_COUNT = (1 << 18);
+	constexpr std::size_t RANDOM_KEY_RANGE = 4096;
+	constexpr std::size_t COLLIDING_KEY_COUNT = 256;
+
+	// TransientGPUResourceAliasTracker::mResourceLifetimeMap is filled from scratch every frame,
+	// and every transient resource is typically used by a handful of render pass bundles. The
+	// resource counts are chosen so that, once every resource has been added, a FastUnorderedMap
+	// with 1,024 slots is filled to roughly 45%, 65% and 85%, which covers the range of load
+	// factors which the map can end up with after growing.
+	constexpr std::array<std::size_t, 3> RESOURCE_COUNT_ARR{ 460, 670, 870 };
+	constexpr std::size_t BUNDLE_USAGES_PER_RESOURCE = 4;
+	constexpr std::size_t FRAME_COUNT = 200;
+
+	// This is the struct stored in TransientGPUResourceAliasTracker::mResourceLifetimeMap.
+	struct TransientResourceInfo
+	{
+		const void* ResourcePtr;
+		std::size_t ResourceSize;
+		std::uint32_t FirstBundleUsage;
+		std::uint32_t LastBundleUsage;
+	};
+
+	// This is the linear-probing implementation of Brawler::FastUnorderedMap which the current
+	// one replaced. It is kept here only so that we can compare the two. Note that, just like the
+	// original, it only compares hash values, so two keys with the same hash alias each other.
+	template <typename Key, typename Value>
+	class LegacyFastUnorderedMap
+	{
+	private:
+		struct MapElement
+		{
+			std::optional<Value> Data;
+			std::size_t KeyHash;
+		};
+
+	public:
+		LegacyFastUnorderedMap() :
+			mElementArr(1),
+			mNumExistingElements(0)
+		{}
+
+		Value& operator[](const Key& key)
+		{
+			const std::size_t keyHash = std::hash<Key>{}(key);
+			const std::optional<std::size_t> existingIndex{ FindIndex(keyHash) };
+
+			if (existingIndex.has_value())
+				return *(mElementArr[*existingIndex].Data);
+
+			if ((static_cast<float>(mNumExistingElements) / static_cast<float>(mElementArr.size())) >= 0.7f)
+				ReHash(mElementArr.size() * 2);
+
+			std::size_t currIndex = (keyHash % mElementArr.size());
+
+			while (mElementArr[currIndex].Data.has_value())
+				currIndex = ((currIndex + 1) % mElementArr.size());
+
+			mElementArr[currIndex].Data.emplace();
+			mElementArr[currIndex].KeyHash = keyHash;
+			++mNumExistingElements;
+
+			return *(mElementArr[currIndex].Data);
+		}
+
+		bool Contains(const Key& key) const
+		{
+			return FindIndex(std::hash<Key>{}(key)).has_value();
+		}
+
+		template <typename Callback>
+		void ForEach(const Callback& callback) const
+		{
+			for (const auto& element : mElementArr)
+			{
+				if (element.Data.has_value())
+					callback(*(element.Data));
+			}
+		}
+
+	private:
+		std::optional<std::size_t> FindIndex(const std::size_t keyHash) const
+		{
+			std::size_t currIndex = (keyHash % mElementArr.size());
+
+			for (std::size_t numIterations = 0; numIterations < mElementArr.size(); ++numIterations)
+			{
+				const MapElement& currElement{ mElementArr[currIndex] };
+
+				if (!currElement.Data.has_value())
+					return std::optional<std::size_t>{};
+
+				if (currElement.KeyHash == keyHash)
+					return currIndex;
+
+				currIndex = ((currIndex + 1) % mElementArr.size());
+			}
+
+			return std::optional<std::size_t>{};
+		}
+
+		void ReHash(const std::size_t newSize)
+		{
+			std::vector<MapElement> newElementArr{};
+			newElementArr.resize(newSize);
+
+			for (auto&& element : mElementArr)
+			{
+				if (!element.Data.has_value())
+					continue;
+
+				std::size_t currIndex = (element.KeyHash % newElementArr.size());
+
+				while (newElementArr[currIndex].Data.has_value())
+					currIndex = ((currIndex + 1) % newElementArr.size());
+
+				newElementArr[currIndex] = std::move(element);
+			}
+
+			mElementArr = std::move(newElementArr);
+		}
+
+	private:
+		std::vector<MapElement> mElementArr;
+		std::size_t mNumExistingElements;
+	};
+
+	// This gives std::unordered_map the same interface as the other two maps, so that the
+	// benchmarks can be written once.
+	template <typename Key, typename Value>
+	class StandardUnorderedMapAdapter
+	{
+	public:
+		StandardUnorderedMapAdapter() = default;
+
+		Value& operator[](const Key& key)
+		{
+			return mMap[key];
+		}
+
+		bool Contains(const Key& key) const
+		{
+			return mMap.contains(key);
+		}
+
+		template <typename Callback>
+		void ForEach(const Callback& callback) const
+		{
+			for (const auto& [key, value] : mMap)
+				callback(value);
+		}
+
+	private:
+		std::unordered_map<Key, Value> mMap;
+	};
+
+	struct CollidingHasher
+	{
+		std::size_t operator()(const std::uint64_t) const
+		{
+			return 0;
+		}
+	};
+
+	template <typename Callback>
+	float MeasureTimeInMilliseconds(Callback&& callback)
+	{
+		Brawler::Timer t{};
+		t.Start();
+
+		callback();
+
+		t.Stop();
+		return t.GetElapsedTimeInMilliseconds();
+	}
+
+	template <typename MapType>
+	void VerifyAgainstStandardUnorderedMap(MapType& testMap, const std::size_t keyRange)
+	{
+		std::unordered_map<std::uint64_t, std::uint64_t> referenceMap{};
+
+		std::mt19937_64 randomEngine{ 0xB4A771E4 };
+		std::uniform_int_distribution<std::uint64_t> keyDistribution{ 0, (keyRange - 1) };
+		std::uniform_int_distribution<std::uint32_t> operationDistribution{ 0, 3 };
+
+		for (std::size_t i = 0; i < RANDOM_OPERATION_COUNT; ++i)
+		{
+			const std::uint64_t currKey = keyDistribution(randomEngine);
+
+			switch (operationDistribution(randomEngine))
+			{
+			case 0:
+			{
+				const bool wasInserted = testMap.TryEmplace(currKey, i);
+				assert(wasInserted == referenceMap.try_emplace(currKey, i).second && "ERROR: FastUnorderedMap::TryEmplace() did not match std::unordered_map::try_emplace()!");
+
+				break;
+			}
+
+			case 1:
+			{
+				testMap[currKey] = i;
+				referenceMap[currKey] = i;
+
+				break;
+			}
+
+			case 2:
+			{
+				const bool wasErased = testMap.Erase(currKey);
+				assert(wasErased == (referenceMap.erase(currKey) == 1) && "ERROR: FastUnorderedMap::Erase() did not match std::unordered_map::erase()!");
+
+				break;
+			}
+
+			case 3:
+			{
+				const bool isKeyPresent = testMap.Contains(currKey);
+				assert(isKeyPresent == referenceMap.contains(currKey) && "ERROR: FastUnorderedMap::Contains() did not match std::unordered_map::contains()!");
+
+				if (isKeyPresent)
+					assert(testMap.At(currKey) == referenceMap.at(currKey) && "ERROR: FastUnorderedMap::At() returned the wrong value!");
+
+				break;
+			}
+
+			default:
+				assert(false);
+				std::unreachable();
+			}
+
+			assert(testMap.GetSize() == referenceMap.size());
+		}
+
+		std::size_t numVisitedElements = 0;
+		testMap.ForEach([&numVisitedElements] (const std::uint64_t&) { ++numVisitedElements; });
+
+		assert(numVisitedElements == referenceMap.size() && "ERROR: FastUnorderedMap::ForEach() did not visit every element exactly once!");
+	}
+
+	void RunCorrectnessTests()
+	{
+		{
+			Brawler::FastUnorderedMap<std::uint64_t, std::uint64_t> testMap{};
+			VerifyAgainstStandardUnorderedMap(testMap, RANDOM_KEY_RANGE);
+
+			testMap.Clear();
+			assert(testMap.Empty() && !testMap.Contains(0));
+		}
+
+		{
+			// With every key having the same hash value, every key has the same hash tag, too. The
+			// old FastUnorderedMap would have treated all of these keys as the same key.
+			Brawler::FastUnorderedMap<std::uint64_t, std::uint64_t, CollidingHasher> collidingMap{};
+			VerifyAgainstStandardUnorderedMap(collidingMap, COLLIDING_KEY_COUNT);
+		}
+
+		{
+			// Make sure that move-only values work, and that they survive re-hashes.
+			Brawler::FastUnorderedMap<std::uint64_t, std::unique_ptr<std::uint64_t>> uniquePtrMap{};
+
+			for (std::uint64_t i = 0; i < RANDOM_KEY_RANGE; ++i)
+				uniquePtrMap.TryEmplace(i, std::make_unique<std::uint64_t>(i));
+
+			Brawler::FastUnorderedMap<std::uint64_t, std::unique_ptr<std::uint64_t>> movedMap{ std::move(uniquePtrMap) };
+
+			for (std::uint64_t i = 0; i < RANDOM_KEY_RANGE; ++i)
+				assert(*(movedMap.At(i)) == i);
+		}
+
+		std::cout << "FastUnorderedMap correctness tests passed." << std::endl;
+	}
+
+	template <typename MapType>
+	void RunFrameWorkload(const std::vector<const void*>& resourcePtrArr, const std::vector<std::uint32_t>& bundleUsageArr, std::size_t& checksum)
+	{
+		// This is what TransientGPUResourceAliasTracker::AddTransientResourceDependencyForBundle()
+		// does for every transient resource used by a bundle, followed by the iteration in
+		// TransientGPUResourceAliasTracker::CalculateAliasableResources().
+		MapType resourceLifetimeMap{};
+
+		for (std::size_t bundleID = 0; bundleID < bundleUsageArr.size(); ++bundleID)
+		{
+			const void* const resourcePtr = resourcePtrArr[bundleUsageArr[bundleID]];
+
+			if (resourceLifetimeMap.Contains(resourcePtr))
+				resourceLifetimeMap[resourcePtr].LastBundleUsage = static_cast<std::uint32_t>(bundleID);
+			else
+				resourceLifetimeMap[resourcePtr] = TransientResourceInfo{
+					.ResourcePtr = resourcePtr,
+					.ResourceSize = bundleID,
+					.FirstBundleUsage = static_cast<std::uint32_t>(bundleID),
+					.LastBundleUsage = static_cast<std::uint32_t>(bundleID)
+				};
+		}
+
+		resourceLifetimeMap.ForEach([&checksum] (const TransientResourceInfo& resourceInfo) { checksum += (resourceInfo.LastBundleUsage - resourceInfo.FirstBundleUsage); });
+	}
+
+	template <typename MapType>
+	float MeasureFrameWorkload(const std::vector<const void*>& resourcePtrArr, const std::vector<std::uint32_t>& bundleUsageArr, std::size_t& checksum)
+	{
+		return MeasureTimeInMilliseconds([&] ()
+		{
+			for (std::size_t i = 0; i < FRAME_COUNT; ++i)
+				RunFrameWorkload<MapType>(resourcePtrArr, bundleUsageArr, checksum);
+		});
+	}
+
+	void RunBenchmarks()
+	{
+		std::mt19937_64 randomEngine{ 0x5EED };
+
+		for (const auto resourceCount : RESOURCE_COUNT_ARR)
+		{
+			// Use real heap addresses as keys, since that is what the resource lifetime map uses.
+			std::vector<std::unique_ptr<TransientResourceInfo>> resourceArr{};
+			std::vector<const void*> resourcePtrArr{};
+
+			for (std::size_t i = 0; i < resourceCount; ++i)
+			{
+				resourceArr.push_back(std::make_unique<TransientResourceInfo>());
+				resourcePtrArr.push_back(resourceArr.back().get());
+			}
+
+			std::vector<std::uint32_t> bundleUsageArr{};
+
+			for (std::size_t i = 0; i < BUNDLE_USAGES_PER_RESOURCE; ++i)
+			{
+				for (std::size_t j = 0; j < resourceCount; ++j)
+					bundleUsageArr.push_back(static_cast<std::uint32_t>(j));
+			}
+
+			std::ranges::shuffle(bundleUsageArr, randomEngine);
+
+			std::size_t fastChecksum = 0;
+			std::size_t legacyChecksum = 0;
+			std::size_t standardChecksum = 0;
+
+			const float fastMapTime = MeasureFrameWorkload<Brawler::FastUnorderedMap<const void*, TransientResourceInfo>>(resourcePtrArr, bundleUsageArr, fastChecksum);
+			const float legacyMapTime = MeasureFrameWorkload<LegacyFastUnorderedMap<const void*, TransientResourceInfo>>(resourcePtrArr, bundleUsageArr, legacyChecksum);
+			const float standardMapTime = MeasureFrameWorkload<StandardUnorderedMapAdapter<const void*, TransientResourceInfo>>(resourcePtrArr, bundleUsageArr, standardChecksum);
+
+			assert(fastChecksum == standardChecksum && legacyChecksum == standardChecksum);
+
+			std::cout << "Resource Lifetime Map (" << resourceCount << " Resources, " << bundleUsageArr.size() << " Bundle Usages, " << FRAME_COUNT << " Frames):\n"
+				<< "\tBrawler::FastUnorderedMap: " << fastMapTime << "ms\n"
+				<< "\tLinear-Probing FastUnorderedMap: " << legacyMapTime << "ms\n"
+				<< "\tstd::unordered_map: " << standardMapTime << "ms" << std::endl;
+		}
+	}
+}
+
+namespace Tests
+{
+	void RunFastUnorderedMapTests()
+	{
+		RunCorrectnessTests();
+		RunBenchmarks();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+module;
+
+export module Tests.FastUnorderedMapTest;
+
+export namespace Tests
+{
+	/// <summary>
+	/// Checks Brawler::FastUnorderedMap against std::unordered_map under random insertions,
+	/// lookups and erasures, including with a Hasher which maps every key to the same value.
+	/// Afterwards, the function compares the performance of Brawler::FastUnorderedMap with that
+	/// of std::unordered_map and of the linear-probing implementation which it replaced. The
+	/// workload mirrors how TransientGPUResourceAliasTracker fills its resource lifetime map
+	/// every frame.
+	/// </summary>
+	void RunFastUnorderedMapTests();
+}
\ No newline at end of file
@@ -6,6 +6,7 @@ module;
 #include <ranges>
 #include <atomic>
 #include <span>
+#include <memory_resource>
 #include "DxDef.h"
 
 module Brawler.D3D12.FrameGraph;
@@ -21,6 +22,7 @@ import Brawler.D3D12.PersistentGPUResourceManager;
 import Brawler.D3D12.GPUResidencyManager;
 import Brawler.D3D12.GPUFence;
 import Brawler.D3D12.GPUResourceDescriptorHeap;
+import Brawler.FrameLinearAllocator;
 
 namespace
 {
@@ -36,8 +38,10 @@ namespace
 		// allocated, but allocate all placed resources on this thread. Of course, this assumes that the
 		// driver doesn't use a lot of locks itself for committed allocations.
 
-		std::vector<I_GPUResource*> committedResourceArr{};
-		std::vector<I_GPUResource*> placedResourceArr{};
+		// These lists only live until this function returns, so we can take their memory from
+		// the FrameLinearAllocator.
+		std::pmr::vector<I_GPUResource*> committedResourceArr{ &(Util::Engine::GetFrameLinearMemoryResource()) };
+		std::pmr::vector<I_GPUResource*> placedResourceArr{ &(Util::Engine::GetFrameLinearMemoryResource()) };
 
 		for (const auto resourcePtr : resourceDependencySpan | std::views::filter([] (const I_GPUResource* const resourcePtr) { return (resourcePtr->GetGPUResourceLifetimeType() == GPUResourceLifetimeType::PERSISTENT && !resourcePtr->IsD3D12ResourceCreated()); }))
 		{
@@ -273,13 +277,7 @@ namespace Brawler
 			// FrameGraph.
 			Brawler::SortedVector<I_GPUResource*> resourceDependencySet{};
 			for (auto& builder : builderSpan)
-			{
-				Brawler::SortedVector<I_GPUResource*> builderResourceDependencies{ builder.ExtractResourceDependencyCache() };
-				builderResourceDependencies.ForEach([&resourceDependencySet] (I_GPUResource* const resourcePtr)
-				{
-					resourceDependencySet.Insert(resourcePtr);
-				});
-			}
+				resourceDependencySet = resourceDependencySet.Union(builder.ExtractResourceDependencyCache());
 
 			const std::span<const std::vector<I_GPUResource*>> aliasableResourceGroupSpan{ aliasTracker.GetAliasableResources() };
 			std::atomic<bool> resourceAllocationFinished{ false };
@@ -287,9 +285,6 @@ namespace Brawler
 			HRESULT hAllocationResult = S_OK;
 			std::optional<GPUFence> gpuResidencyFence{};
 
-			Brawler::JobGroup resourceCompilationGroup{};
-			resourceCompilationGroup.Reserve(1);
-
 			struct ResourceCompilationJobInfo
 			{
 				const std::span<I_GPUResource* const> ResourceDependencySpan;
@@ -299,39 +294,42 @@ namespace Brawler
 				std::atomic<bool>& ResourceAllocationFinished;
 				std::optional<GPUFence>& GPUResidencyFence;
 				HRESULT& HAllocationResult;
-			};
-			ResourceCompilationJobInfo jobInfo{ resourceDependencySet.CreateSpan(), mTransientResourceManager, aliasableResourceGroupSpan, resourceAllocationFinished, gpuResidencyFence, hAllocationResult };
 
-			resourceCompilationGroup.AddJob([this, &jobInfo]()
+				HRESULT HPersistentAllocationsResult;
+				HRESULT HTransientAllocationsResult;
+			};
+			ResourceCompilationJobInfo jobInfo{ resourceDependencySet.CreateSpan(), mTransientResourceManager, aliasableResourceGroupSpan, resourceAllocationFinished, gpuResidencyFence, hAllocationResult, S_OK, S_OK };
+
+			// Since there are no shared locks between persistent and transient GPU resource
+			// memory allocation, we might see a performance gain by doing these concurrently.
+			// The residency pass needs to wait for both of them, so we express this as a
+			// TaskGraph. That way, whichever thread finishes the last allocation task simply
+			// continues with the residency pass, and no thread needs to sit around waiting
+			// for the allocations to finish.
+			Brawler::TaskGraph resourceCompilationGraph{};
+			resourceCompilationGraph.Reserve(3);
+
+			const Brawler::TaskGraph::TaskID persistentAllocationTaskID = resourceCompilationGraph.AddTask([&jobInfo] ()
 			{
-				// Since there are no shared locks between persistent and transient GPU resource
-				// memory allocation, we might see a performance gain by doing these concurrently.
-				Brawler::JobGroup memoryAllocationGroup{};
-				memoryAllocationGroup.Reserve(2);
-
-				HRESULT hPersistentAllocationsResult = S_OK;
-				memoryAllocationGroup.AddJob([&hPersistentAllocationsResult, &jobInfo] ()
-				{
-					hPersistentAllocationsResult = AllocatePersistentGPUResources(jobInfo.ResourceDependencySpan);
-				});
-
-				HRESULT hTransientAllocationsResult = S_OK;
-				memoryAllocationGroup.AddJob([&hTransientAllocationsResult, &jobInfo] ()
-				{
-					hTransientAllocationsResult = AllocateTransientGPUResources(jobInfo.TransientResourceManager, jobInfo.AliasableResourceGroupSpan);
-				});
+				jobInfo.HPersistentAllocationsResult = AllocatePersistentGPUResources(jobInfo.ResourceDependencySpan);
+			});
 
-				memoryAllocationGroup.ExecuteJobs();
+			const Brawler::TaskGraph::TaskID transientAllocationTaskID = resourceCompilationGraph.AddTask([&jobInfo] ()
+			{
+				jobInfo.HTransientAllocationsResult = AllocateTransientGPUResources(jobInfo.TransientResourceManager, jobInfo.AliasableResourceGroupSpan);
+			});
 
+			resourceCompilationGraph.AddTask([&jobInfo] ()
+			{
 				// Check for errors with the allocations.
 				{
 					HRESULT hTotalAllocationsResult = S_OK;
 
-					if (FAILED(hPersistentAllocationsResult)) [[unlikely]]
-						hTotalAllocationsResult = hPersistentAllocationsResult;
+					if (FAILED(jobInfo.HPersistentAllocationsResult)) [[unlikely]]
+						hTotalAllocationsResult = jobInfo.HPersistentAllocationsResult;
 
-					else if (FAILED(hTransientAllocationsResult)) [[unlikely]]
-						hTotalAllocationsResult = hTransientAllocationsResult;
+					else if (FAILED(jobInfo.HTransientAllocationsResult)) [[unlikely]]
+						hTotalAllocationsResult = jobInfo.HTransientAllocationsResult;
 
 					if (FAILED(hTotalAllocationsResult)) [[unlikely]]
 					{
@@ -349,11 +347,11 @@ namespace Brawler
 				jobInfo.HAllocationResult = residencyResults.HResult;
 
 				jobInfo.ResourceAllocationFinished.store(true, std::memory_order::release);
-			});
+			}, { persistentAllocationTaskID, transientAllocationTaskID });
 
 			// Begin creating the resources on the GPU. We do this asynchronously so as to not block
 			// the current thread.
-			resourceCompilationGroup.ExecuteJobsAsync();
+			resourceCompilationGraph.ExecuteAsync();
 
 			// In the meantime, we can go ahead and compile the FrameGraph, since doing so does not
 			// require the GPU memory to actually be allocated.
@@ -4,6 +4,7 @@ module;
 #include <cassert>
 #include <optional>
 #include <unordered_map>
+#include <span>
 #include "DxDef.h"
 
 module Brawler.D3D12.FrameGraphBuilder;
@@ -160,11 +161,12 @@ namespace Brawler
 		{
 			for (const auto& bundle : mRenderPassBundleArr)
 			{
-				for (const auto resourcePtr : bundle.GetResourceDependencies())
-				{
+				const std::span<I_GPUResource* const> bundleResourceDependencySpan{ bundle.GetResourceDependencies() };
+
+				for (const auto resourcePtr : bundleResourceDependencySpan)
 					resourcePtr->MarkAsUsedForCurrentFrame();
-					mResourceDependencyCache.Insert(resourcePtr);
-				}					
+
+				mResourceDependencyCache.InsertRange(bundleResourceDependencySpan);
 			}
 		}
 
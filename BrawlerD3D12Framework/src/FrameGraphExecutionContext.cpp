@@ -202,35 +202,28 @@ namespace Brawler
 
 			// Resource tracking can be a long-running task, especially since the algorithm currently
 			// does it on a per-resource basis. We want to multithread this as much as possible.
-			const std::uint32_t numJobsToCreate = std::thread::hardware_concurrency();
-			const std::size_t numResourcesPerJob = static_cast<std::size_t>(std::ceilf(static_cast<float>(resourceEventManagerMap.size()) / static_cast<float>(numJobsToCreate)));
-
-			Brawler::JobGroup resourceTrackingJobGroup{};
-			resourceTrackingJobGroup.Reserve(numJobsToCreate);
+			//
+			// The time it takes to analyze a resource varies wildly, so we let Brawler::ParallelFor()
+			// balance the load between threads, rather than splitting the resources evenly ourselves.
+			// The map itself cannot be indexed, so we gather pointers to its entries first.
+			std::vector<decltype(resourceEventManagerMap)::value_type*> resourceEntryPtrArr{};
+			resourceEntryPtrArr.reserve(resourceEventManagerMap.size());
 
-			std::size_t numResourcesAdded = 0;
+			for (auto& resourceEntry : resourceEventManagerMap)
+				resourceEntryPtrArr.push_back(&resourceEntry);
 
-			while (numResourcesAdded < resourceEventManagerMap.size())
 			{
-				const std::size_t numResourcesThisJob = std::min(numResourcesPerJob, (resourceEventManagerMap.size() - numResourcesAdded));
-
-				resourceTrackingJobGroup.AddJob([this, &resourceEventManagerMap, numResourcesThisJob, startIndex = numResourcesAdded] ()
+				ScopedCPUPIXEvent resourceTrackingPIXEvent{ L"Brawler Engine - GPU Resource State Analysis" };
+				
+				Brawler::ParallelFor(resourceEntryPtrArr, 1, [this] (decltype(resourceEventManagerMap)::value_type* const resourceEntryPtr)
 				{
-					for (auto& [resourcePtr, resourceEventCollection] : resourceEventManagerMap | std::views::drop(startIndex) | std::views::take(numResourcesThisJob))
-					{
-						GPUResourceUsageAnalyzer resourceAnalyzer{ *resourcePtr };
-						resourceAnalyzer.TraverseFrameGraph(std::span<const GPUExecutionModule>{ mExecutionModuleArr });
+					auto& [resourcePtr, resourceEventCollection] = *resourceEntryPtr;
 
-						resourceEventCollection = resourceAnalyzer.ExtractGPUResourceEventCollection();
-					}
-				});
-
-				numResourcesAdded += numResourcesThisJob;
-			}
+					GPUResourceUsageAnalyzer resourceAnalyzer{ *resourcePtr };
+					resourceAnalyzer.TraverseFrameGraph(std::span<const GPUExecutionModule>{ mExecutionModuleArr });
 
-			{
-				ScopedCPUPIXEvent resourceTrackingPIXEvent{ L"Brawler Engine - GPU Resource State Analysis" };
-				resourceTrackingJobGroup.ExecuteJobs();
+					resourceEventCollection = resourceAnalyzer.ExtractGPUResourceEventCollection();
+				});
 			}
 
 			// Before we begin merging GPUResourceEvent instances, we can allocate all of the
@@ -0,0 +1,207 @@
+module;
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include <array>
+#include <mutex>
+#include <thread>
+#include <optional>
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+module Brawler.FrameLinearAllocator;
+import Util.Engine;
+import Util.Threading;
+import Brawler.ThreadLocalResources;
+
+namespace
+{
+	std::optional<std::uint32_t> GetCurrentThreadIndex()
+	{
+		// Just like the TLSFAllocator's thread caches, we only look up the thread index once per
+		// thread, since doing so is more expensive than the allocation itself.
+		thread_local const std::optional<std::uint32_t> currThreadIndex{ [] ()
+		{
+			if (!Util::Threading::IsMainThread() && Util::Threading::GetCurrentWorkerThread() == nullptr)
+				return std::optional<std::uint32_t>{};
+
+			return std::optional<std::uint32_t>{ Util::Threading::GetThreadLocalResources().GetThreadIndex() };
+		}() };
+
+		return currThreadIndex;
+	}
+}
+
+namespace Brawler
+{
+	FrameLinearArena::FrameLinearArena() :
+		FrameLinearArena(DEFAULT_CHUNK_SIZE)
+	{}
+
+	FrameLinearArena::FrameLinearArena(const std::size_t chunkSizeInBytes) :
+		mChunkArr(),
+		mNextChunkIndex(0),
+		mCurrAddress(0),
+		mCurrEndAddress(0),
+		mChunkSizeInBytes(chunkSizeInBytes)
+	{
+		assert(chunkSizeInBytes > 0 && "ERROR: A FrameLinearArena was given a chunk size of zero!");
+	}
+
+	void* FrameLinearArena::Allocate(const std::size_t sizeInBytes, const std::size_t alignment)
+	{
+		assert(std::has_single_bit(alignment) && "ERROR: A non-power-of-two alignment was provided to FrameLinearArena::Allocate()!");
+
+		// Zero-sized allocations still need to return unique pointers.
+		const std::size_t adjustedSizeInBytes = std::max<std::size_t>(sizeInBytes, 1);
+		const std::uintptr_t alignedAddress = ((mCurrAddress + (alignment - 1)) & ~(static_cast<std::uintptr_t>(alignment) - 1));
+
+		// Before the first allocation and after every reset, both mCurrAddress and mCurrEndAddress
+		// are zero, so we always end up in FrameLinearArena::AllocateFromNextChunk() in that case.
+		if ((alignedAddress + adjustedSizeInBytes) <= mCurrEndAddress) [[likely]]
+		{
+			mCurrAddress = (alignedAddress + adjustedSizeInBytes);
+			return reinterpret_cast<void*>(alignedAddress);
+		}
+
+		return AllocateFromNextChunk(adjustedSizeInBytes, alignment);
+	}
+
+	void FrameLinearArena::Reset()
+	{
+		mNextChunkIndex = 0;
+		mCurrAddress = 0;
+		mCurrEndAddress = 0;
+	}
+
+	std::size_t FrameLinearArena::GetReservedSizeInBytes() const
+	{
+		std::size_t reservedSize = 0;
+
+		for (const auto& chunk : mChunkArr)
+			reservedSize += chunk.SizeInBytes;
+
+		return reservedSize;
+	}
+
+	void* FrameLinearArena::AllocateFromNextChunk(const std::size_t sizeInBytes, const std::size_t alignment)
+	{
+		// Chunks are only aligned to __STDCPP_DEFAULT_NEW_ALIGNMENT__, so we might need to skip up to
+		// (alignment - 1) bytes at the start of the chunk.
+		const std::size_t requiredChunkSize = (sizeInBytes + (alignment - 1));
+
+		// If we have run out of chunks, or if the next chunk is too small for this allocation (which
+		// can only happen if it was created for a smaller oversized allocation in an earlier frame),
+		// then we create a new chunk. It is swapped into place, rather than inserted, so that this
+		// stays O(1); the smaller chunk simply moves to the end of the list, where it will be used
+		// again once the arena needs that many chunks.
+		if (mNextChunkIndex == mChunkArr.size() || mChunkArr[mNextChunkIndex].SizeInBytes < requiredChunkSize) [[unlikely]]
+		{
+			const std::size_t newChunkSize = std::max(mChunkSizeInBytes, requiredChunkSize);
+			mChunkArr.push_back(Chunk{
+				.DataPtr{ std::make_unique_for_overwrite<std::byte[]>(newChunkSize) },
+				.SizeInBytes = newChunkSize
+			});
+
+			std::swap(mChunkArr[mNextChunkIndex], mChunkArr.back());
+		}
+
+		const Chunk& nextChunk{ mChunkArr[mNextChunkIndex++] };
+		mCurrAddress = reinterpret_cast<std::uintptr_t>(nextChunk.DataPtr.get());
+		mCurrEndAddress = (mCurrAddress + nextChunk.SizeInBytes);
+
+		const std::uintptr_t alignedAddress = ((mCurrAddress + (alignment - 1)) & ~(static_cast<std::uintptr_t>(alignment) - 1));
+		assert(alignedAddress + sizeInBytes <= mCurrEndAddress);
+
+		mCurrAddress = (alignedAddress + sizeInBytes);
+		return reinterpret_cast<void*>(alignedAddress);
+	}
+
+	FrameLinearAllocator::FrameLinearAllocator() :
+		mThreadArenaSetArr(),
+		mThreadArenaSetCount(std::thread::hardware_concurrency()),
+		mSharedArenaSet(),
+		mSharedArenaCritSection()
+	{
+		// Like the CommandAllocatorStorage, we create one set of arenas for every thread which could
+		// possibly be a part of the WorkerThreadPool. The arenas do not allocate any chunks until
+		// they are first used, so threads which never allocate frame-linear memory cost us almost
+		// nothing.
+		mThreadArenaSetArr = std::make_unique<ThreadArenaSet[]>(mThreadArenaSetCount);
+	}
+
+	void* FrameLinearAllocator::Allocate(const std::size_t sizeInBytes, const std::size_t alignment)
+	{
+		const std::optional<std::uint32_t> currThreadIndex{ GetCurrentThreadIndex() };
+
+		if (currThreadIndex.has_value()) [[likely]]
+		{
+			assert(*currThreadIndex < mThreadArenaSetCount);
+			return AllocateFromArenaSet(mThreadArenaSetArr[*currThreadIndex], sizeInBytes, alignment);
+		}
+
+		std::scoped_lock<std::mutex> lock{ mSharedArenaCritSection };
+		return AllocateFromArenaSet(mSharedArenaSet, sizeInBytes, alignment);
+	}
+
+	void* FrameLinearAllocator::AllocateFromArenaSet(ThreadArenaSet& arenaSet, const std::size_t sizeInBytes, const std::size_t alignment)
+	{
+		const std::uint64_t currFrameNumber = Util::Engine::GetCurrentFrameNumber();
+		const std::size_t arenaIndex = (currFrameNumber % Util::Engine::MAX_FRAMES_IN_FLIGHT);
+
+		// If the arena was last used for an earlier frame, then that frame has retired, and we can
+		// release everything which was allocated for it.
+		//
+		// The arena can only have been used for a *later* frame if a CPU job created during this
+		// frame is still running MAX_FRAMES_IN_FLIGHT frames after the fact, which means that the
+		// memory it allocated earlier has already been reclaimed. We cannot do anything about that
+		// anymore, but we can at least avoid resetting the arena for the later frame; the memory
+		// returned here will simply live for longer than it needs to.
+		assert(arenaSet.FrameNumberArr[arenaIndex] <= currFrameNumber && "ERROR: Frame-linear memory was allocated for a frame which has already retired!");
+
+		if (arenaSet.FrameNumberArr[arenaIndex] < currFrameNumber)
+		{
+			arenaSet.ArenaArr[arenaIndex].Reset();
+			arenaSet.FrameNumberArr[arenaIndex] = currFrameNumber;
+		}
+
+		return arenaSet.ArenaArr[arenaIndex].Allocate(sizeInBytes, alignment);
+	}
+
+	FrameLinearMemoryResource::FrameLinearMemoryResource(FrameLinearAllocator& allocator) :
+		std::pmr::memory_resource(),
+		mAllocatorPtr(&allocator)
+	{}
+
+	void* FrameLinearMemoryResource::do_allocate(const std::size_t sizeInBytes, const std::size_t alignment)
+	{
+		return mAllocatorPtr->Allocate(sizeInBytes, alignment);
+	}
+
+	void FrameLinearMemoryResource::do_deallocate(void* const ptr, const std::size_t sizeInBytes, const std::size_t alignment)
+	{
+		// Frame-linear memory is only ever released all at once, when its frame retires.
+	}
+
+	bool FrameLinearMemoryResource::do_is_equal(const std::pmr::memory_resource& otherResource) const noexcept
+	{
+		return (this == &otherResource);
+	}
+}
+
+namespace Util
+{
+	namespace Engine
+	{
+		std::pmr::memory_resource& GetFrameLinearMemoryResource()
+		{
+			static Brawler::FrameLinearAllocator frameLinearAllocator{};
+			static Brawler::FrameLinearMemoryResource frameLinearMemoryResource{ frameLinearAllocator };
+
+			return frameLinearMemoryResource;
+		}
+	}
+}
\ No newline at end of file
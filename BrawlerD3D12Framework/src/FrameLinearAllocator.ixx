@@ -0,0 +1,190 @@
+module;
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include <array>
+#include <mutex>
+#include <new>
+
+export module Brawler.FrameLinearAllocator;
+import Util.Engine;
+
+export namespace Brawler
+{
+	// A FrameLinearArena hands out memory by bumping a pointer through a list of chunks. Individual
+	// allocations are never freed; instead, FrameLinearArena::Reset() releases everything at once by
+	// rewinding to the first chunk. The chunks themselves are kept, so once an arena has grown to
+	// the high-water mark of the frames which use it, it never calls into the heap again.
+	//
+	// A FrameLinearArena is *NOT* thread safe. The FrameLinearAllocator gives each thread its own.
+
+	class FrameLinearArena
+	{
+	private:
+		struct Chunk
+		{
+			std::unique_ptr<std::byte[]> DataPtr;
+			std::size_t SizeInBytes;
+		};
+
+	public:
+		static constexpr std::size_t DEFAULT_CHUNK_SIZE = (static_cast<std::size_t>(1) << 16);
+
+	public:
+		FrameLinearArena();
+		explicit FrameLinearArena(const std::size_t chunkSizeInBytes);
+
+		FrameLinearArena(const FrameLinearArena& rhs) = delete;
+		FrameLinearArena& operator=(const FrameLinearArena& rhs) = delete;
+
+		FrameLinearArena(FrameLinearArena&& rhs) noexcept = default;
+		FrameLinearArena& operator=(FrameLinearArena&& rhs) noexcept = default;
+
+		/// <summary>
+		/// Allocates sizeInBytes bytes of memory aligned to alignment bytes from the current chunk.
+		/// If the current chunk does not have enough space left, then the arena moves on to its next
+		/// chunk, creating a new one if it has to. Allocations which are larger than the arena's
+		/// chunk size get a chunk of their own.
+		/// </summary>
+		/// <param name="sizeInBytes">
+		/// - The size, in bytes, of the allocation.
+		/// </param>
+		/// <param name="alignment">
+		/// - The required alignment of the allocation. This must be a power of two.
+		/// </param>
+		/// <returns>
+		/// The function returns a pointer to the allocated memory. This memory remains valid until
+		/// the next call to FrameLinearArena::Reset().
+		/// </returns>
+		void* Allocate(const std::size_t sizeInBytes, const std::size_t alignment);
+
+		/// <summary>
+		/// Releases every allocation made from this FrameLinearArena in O(1) time. No destructors
+		/// are called, and none of the arena's chunks are freed.
+		/// </summary>
+		void Reset();
+
+		std::size_t GetReservedSizeInBytes() const;
+
+	private:
+		void* AllocateFromNextChunk(const std::size_t sizeInBytes, const std::size_t alignment);
+
+	private:
+		std::vector<Chunk> mChunkArr;
+		std::size_t mNextChunkIndex;
+		std::uintptr_t mCurrAddress;
+		std::uintptr_t mCurrEndAddress;
+		std::size_t mChunkSizeInBytes;
+	};
+
+	// The FrameLinearAllocator is meant for CPU scratch memory which only needs to live until the
+	// end of the frame which allocated it, such as the temporary containers created while the
+	// FrameGraph is being compiled. Every thread gets Util::Engine::MAX_FRAMES_IN_FLIGHT
+	// FrameLinearArenas, and allocations go into the arena of the calling thread which belongs
+	// to Util::Engine::GetCurrentFrameNumber().
+	//
+	// Arenas are reset lazily: the first time that a thread allocates memory for frame N, the arena
+	// which it used for frame (N - Util::Engine::MAX_FRAMES_IN_FLIGHT) is reset. This means that
+	// memory allocated for a frame must not be accessed once MAX_FRAMES_IN_FLIGHT more frames have
+	// begun, but it also means that retiring a frame costs nothing more than a frame number
+	// comparison, and that no thread ever has to touch another thread's arenas.
+	//
+	// Threads which are not a part of the WorkerThreadPool do not have a thread index. These share
+	// a single set of arenas, which is protected by a std::mutex.
+
+	class FrameLinearAllocator
+	{
+	private:
+		struct alignas(std::hardware_destructive_interference_size) ThreadArenaSet
+		{
+			std::array<FrameLinearArena, Util::Engine::MAX_FRAMES_IN_FLIGHT> ArenaArr{};
+			std::array<std::uint64_t, Util::Engine::MAX_FRAMES_IN_FLIGHT> FrameNumberArr{};
+		};
+
+	public:
+		FrameLinearAllocator();
+
+		FrameLinearAllocator(const FrameLinearAllocator& rhs) = delete;
+		FrameLinearAllocator& operator=(const FrameLinearAllocator& rhs) = delete;
+
+		FrameLinearAllocator(FrameLinearAllocator&& rhs) noexcept = delete;
+		FrameLinearAllocator& operator=(FrameLinearAllocator&& rhs) noexcept = delete;
+
+		/// <summary>
+		/// Allocates sizeInBytes bytes of memory aligned to alignment bytes for the frame returned by
+		/// Util::Engine::GetCurrentFrameNumber(). The memory does not need to be freed; it is
+		/// released automatically once Util::Engine::MAX_FRAMES_IN_FLIGHT more frames have begun.
+		/// 
+		/// *NOTE*: This function *IS* thread safe.
+		/// </summary>
+		/// <param name="sizeInBytes">
+		/// - The size, in bytes, of the allocation.
+		/// </param>
+		/// <param name="alignment">
+		/// - The required alignment of the allocation. This must be a power of two.
+		/// </param>
+		/// <returns>
+		/// The function returns a pointer to the allocated memory.
+		/// </returns>
+		void* Allocate(const std::size_t sizeInBytes, const std::size_t alignment);
+
+	private:
+		static void* AllocateFromArenaSet(ThreadArenaSet& arenaSet, const std::size_t sizeInBytes, const std::size_t alignment);
+
+	private:
+		std::unique_ptr<ThreadArenaSet[]> mThreadArenaSetArr;
+		std::uint32_t mThreadArenaSetCount;
+		ThreadArenaSet mSharedArenaSet;
+		std::mutex mSharedArenaCritSection;
+	};
+
+	// The FrameLinearMemoryResource lets standard library containers opt into frame-linear
+	// allocation through std::pmr::polymorphic_allocator. Deallocation does nothing, so a
+	// container which grows leaves its old buffers behind until the frame retires; if the final
+	// size of a container is known, reserving it up front avoids this.
+	//
+	// Destructors of objects stored in such containers still run as usual. However, since the
+	// memory is reclaimed without any of them being called, a container must be destroyed before
+	// its frame retires.
+
+	class FrameLinearMemoryResource final : public std::pmr::memory_resource
+	{
+	public:
+		explicit FrameLinearMemoryResource(FrameLinearAllocator& allocator);
+
+		FrameLinearMemoryResource(const FrameLinearMemoryResource& rhs) = delete;
+		FrameLinearMemoryResource& operator=(const FrameLinearMemoryResource& rhs) = delete;
+
+		FrameLinearMemoryResource(FrameLinearMemoryResource&& rhs) noexcept = delete;
+		FrameLinearMemoryResource& operator=(FrameLinearMemoryResource&& rhs) noexcept = delete;
+
+	private:
+		void* do_allocate(const std::size_t sizeInBytes, const std::size_t alignment) override;
+		void do_deallocate(void* const ptr, const std::size_t sizeInBytes, const std::size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& otherResource) const noexcept override;
+
+	private:
+		FrameLinearAllocator* mAllocatorPtr;
+	};
+}
+
+export namespace Util
+{
+	namespace Engine
+	{
+		/// <summary>
+		/// Gets the std::pmr::memory_resource which allocates memory from the engine's
+		/// FrameLinearAllocator. Use this for temporary containers which are created and
+		/// destroyed within a single frame, e.g., std::pmr::vector<T>{ &Util::Engine::GetFrameLinearMemoryResource() }.
+		/// 
+		/// *NOTE*: This function *IS* thread safe.
+		/// </summary>
+		/// <returns>
+		/// The function returns the std::pmr::memory_resource which allocates memory from the
+		/// engine's FrameLinearAllocator.
+		/// </returns>
+		std::pmr::memory_resource& GetFrameLinearMemoryResource();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,219 @@
+module;
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <set>
+#include <memory_resource>
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+module Tests.FrameLinearAllocatorTest;
+import Brawler.FrameLinearAllocator;
+import Brawler.Timer;
+
+namespace
+{
+	constexpr std::size_t TEST_CHUNK_SIZE = 4096;
+	constexpr std::size_t TEST_FRAME_COUNT = 16;
+	constexpr std::size_t TEST_ALLOCATIONS_PER_FRAME = 2000;
+
+	constexpr std::size_t BENCHMARK_FRAME_COUNT = 200;
+	constexpr std::size_t BENCHMARK_ELEMENT_COUNT = 4096;
+
+	// The FrameLinearMemoryResource needs the Renderer to know the current frame number, so we
+	// wrap a FrameLinearArena directly and reset it ourselves at the end of every "frame."
+	class ArenaMemoryResource final : public std::pmr::memory_resource
+	{
+	public:
+		explicit ArenaMemoryResource(Brawler::FrameLinearArena& arena) :
+			mArenaPtr(&arena)
+		{}
+
+	private:
+		void* do_allocate(const std::size_t sizeInBytes, const std::size_t alignment) override
+		{
+			return mArenaPtr->Allocate(sizeInBytes, alignment);
+		}
+
+		void do_deallocate(void* const ptr, const std::size_t sizeInBytes, const std::size_t alignment) override
+		{}
+
+		bool do_is_equal(const std::pmr::memory_resource& otherResource) const noexcept override
+		{
+			return (this == &otherResource);
+		}
+
+	private:
+		Brawler::FrameLinearArena* mArenaPtr;
+	};
+
+	struct AllocationRecord
+	{
+		std::byte* DataPtr;
+		std::size_t SizeInBytes;
+		std::uint8_t FillValue;
+	};
+
+	void RunArenaTest()
+	{
+		Brawler::FrameLinearArena arena{ TEST_CHUNK_SIZE };
+		std::mt19937 randomEngine{ 0 };
+		std::uniform_int_distribution<std::size_t> sizeDistribution{ 0, 300 };
+		std::uniform_int_distribution<std::uint32_t> alignmentShiftDistribution{ 0, 7 };
+
+		for (std::size_t frame = 0; frame < TEST_FRAME_COUNT; ++frame)
+		{
+			std::vector<AllocationRecord> allocationArr{};
+			allocationArr.reserve(TEST_ALLOCATIONS_PER_FRAME + 1);
+
+			for (std::size_t i = 0; i < TEST_ALLOCATIONS_PER_FRAME; ++i)
+			{
+				const std::size_t sizeInBytes = sizeDistribution(randomEngine);
+				const std::size_t alignment = (static_cast<std::size_t>(1) << alignmentShiftDistribution(randomEngine));
+
+				std::byte* const dataPtr = static_cast<std::byte*>(arena.Allocate(sizeInBytes, alignment));
+				assert(dataPtr != nullptr && (reinterpret_cast<std::uintptr_t>(dataPtr) % alignment) == 0 && "ERROR: FrameLinearArena::Allocate() returned a misaligned allocation!");
+
+				// Fill every allocation with a value unique to it. If any two allocations overlap,
+				// then one of them will have been overwritten by the time we check.
+				const std::uint8_t fillValue = static_cast<std::uint8_t>((i * 131) + frame);
+				std::memset(dataPtr, fillValue, sizeInBytes);
+
+				allocationArr.push_back(AllocationRecord{
+					.DataPtr = dataPtr,
+					.SizeInBytes = sizeInBytes,
+					.FillValue = fillValue
+				});
+			}
+
+			// Every few frames, make one allocation which is larger than a chunk. Allocations like
+			// this get their own chunk, which then has to survive being swapped around in later
+			// frames.
+			if ((frame % 4) == 1)
+			{
+				const std::size_t oversizedAllocationSize = (TEST_CHUNK_SIZE * (2 + (frame % 3)));
+				std::byte* const dataPtr = static_cast<std::byte*>(arena.Allocate(oversizedAllocationSize, 256));
+				assert((reinterpret_cast<std::uintptr_t>(dataPtr) % 256) == 0);
+
+				std::memset(dataPtr, 0xAB, oversizedAllocationSize);
+				allocationArr.push_back(AllocationRecord{
+					.DataPtr = dataPtr,
+					.SizeInBytes = oversizedAllocationSize,
+					.FillValue = 0xAB
+				});
+			}
+
+			for (const auto& allocation : allocationArr)
+			{
+				const bool isAllocationIntact = std::ranges::all_of(allocation.DataPtr, allocation.DataPtr + allocation.SizeInBytes, [&allocation] (const std::byte value) { return (value == static_cast<std::byte>(allocation.FillValue)); });
+				assert(isAllocationIntact && "ERROR: Two allocations made by a FrameLinearArena overlapped!");
+			}
+
+			arena.Reset();
+		}
+
+		// Repeating the same allocations after a reset must reuse the arena's chunks, rather than
+		// creating new ones.
+		const auto allocateSequenceLambda = [&arena] ()
+		{
+			std::mt19937 sequenceEngine{ 1 };
+			std::uniform_int_distribution<std::size_t> sequenceSizeDistribution{ 1, 1000 };
+
+			void* const firstAllocationPtr = arena.Allocate(sequenceSizeDistribution(sequenceEngine), 16);
+
+			for (std::size_t i = 1; i < TEST_ALLOCATIONS_PER_FRAME; ++i)
+				arena.Allocate(sequenceSizeDistribution(sequenceEngine), 16);
+
+			arena.Allocate(TEST_CHUNK_SIZE * 3, 256);
+
+			return firstAllocationPtr;
+		};
+
+		void* const firstRunPtr = allocateSequenceLambda();
+		const std::size_t reservedSizeAfterFirstRun = arena.GetReservedSizeInBytes();
+		arena.Reset();
+
+		void* const secondRunPtr = allocateSequenceLambda();
+		arena.Reset();
+
+		assert(firstRunPtr == secondRunPtr && arena.GetReservedSizeInBytes() == reservedSizeAfterFirstRun && "ERROR: A FrameLinearArena did not reuse its chunks after being reset!");
+
+		std::cout << "FrameLinearArena test passed." << std::endl;
+	}
+
+	template <typename Callback>
+	float MeasureFrames(const Callback& callback)
+	{
+		Brawler::Timer t{};
+		t.Start();
+
+		for (std::size_t frame = 0; frame < BENCHMARK_FRAME_COUNT; ++frame)
+			callback();
+
+		t.Stop();
+
+		// Report the average time per frame in microseconds.
+		return ((t.GetElapsedTimeInMilliseconds() * 1000.0f) / static_cast<float>(BENCHMARK_FRAME_COUNT));
+	}
+
+	template <typename Set, typename Vector>
+	std::size_t BuildTemporaryContainers(Set& sortedSet, Vector& pointerArr)
+	{
+		// This mimics TransientGPUResourceAliasTracker::CalculateAliasableResources(): a sorted
+		// std::set of pointers, plus a vector which is filled without knowing its final size.
+		for (std::size_t i = 0; i < BENCHMARK_ELEMENT_COUNT; ++i)
+		{
+			const std::uintptr_t fakePointer = ((i * 2654435761u) % (BENCHMARK_ELEMENT_COUNT * 64));
+			sortedSet.insert(fakePointer);
+			pointerArr.push_back(fakePointer);
+		}
+
+		return (sortedSet.size() + pointerArr.size());
+	}
+
+	void RunBenchmarks()
+	{
+		std::size_t checksum = 0;
+
+		const float defaultAllocatorTime = MeasureFrames([&checksum] ()
+		{
+			std::set<std::uintptr_t> sortedSet{};
+			std::vector<std::uintptr_t> pointerArr{};
+
+			checksum += BuildTemporaryContainers(sortedSet, pointerArr);
+		});
+
+		Brawler::FrameLinearArena arena{};
+		ArenaMemoryResource arenaResource{ arena };
+
+		const float frameLinearTime = MeasureFrames([&checksum, &arena, &arenaResource] ()
+		{
+			{
+				std::pmr::set<std::uintptr_t> sortedSet{ &arenaResource };
+				std::pmr::vector<std::uintptr_t> pointerArr{ &arenaResource };
+
+				checksum += BuildTemporaryContainers(sortedSet, pointerArr);
+			}
+
+			arena.Reset();
+		});
+
+		assert(checksum == (BENCHMARK_FRAME_COUNT * BENCHMARK_ELEMENT_COUNT * 2 * 2));
+
+		std::cout << "Temporary std::set + std::vector (" << BENCHMARK_ELEMENT_COUNT << " Elements, Average per Frame):\n"
+			<< "\tDefault Allocator: " << defaultAllocatorTime << " us\n"
+			<< "\tFrameLinearArena: " << frameLinearTime << " us" << std::endl;
+	}
+}
+
+namespace Tests
+{
+	void RunFrameLinearAllocatorTests()
+	{
+		RunArenaTest();
+		RunBenchmarks();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+module;
+
+export module Tests.FrameLinearAllocatorTest;
+
+export namespace Tests
+{
+	/// <summary>
+	/// Checks that a Brawler::FrameLinearArena returns aligned, non-overlapping allocations, that
+	/// resetting it reuses its chunks rather than allocating new ones, and that oversized
+	/// allocations get chunks of their own. Afterwards, the function compares the cost of building
+	/// the kind of temporary containers which the FrameGraph creates every frame with the default
+	/// allocator and with frame-linear memory.
+	/// </summary>
+	void RunFrameLinearAllocatorTests();
+}
\ No newline at end of file
@@ -1,7 +1,7 @@
 module;
 
 export module Brawler.D3D12.FreeGPUResidencyInfo;
-import Brawler.ThreadSafeVector;
+import Brawler.CopyOnWriteVector;
 import Brawler.D3D12.GPUMemoryBudgetInfo;
 
 export namespace Brawler
@@ -24,7 +24,7 @@ export namespace Brawler
 
 		struct FreeGPUResidencyInfo
 		{
-			const Brawler::ThreadSafeVector<I_PageableGPUObject*>& PageableObjectArr;
+			const Brawler::CopyOnWriteVector<I_PageableGPUObject*>& PageableObjectArr;
 			GPUMemoryBudgetInfo BudgetInfo;
 		};
 	}
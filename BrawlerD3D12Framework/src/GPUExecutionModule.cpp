@@ -171,20 +171,26 @@ namespace Brawler
 
 		Brawler::SortedVector<I_GPUResource*> GPUExecutionModule::GetResourceDependencies() const
 		{
-			Brawler::SortedVector<I_GPUResource*> resourceDependencySet{};
+			// Gather every dependency first and add them all at once. Many render passes share
+			// the same resources, so SortedVector::InsertRange() sorting out the duplicates in
+			// one go is much cheaper than calling SortedVector::Insert() for each of them.
+			std::vector<I_GPUResource*> resourceDependencyArr{};
 
-			const auto addResourceDependenciesLambda = []<GPUCommandQueueType QueueType>(Brawler::SortedVector<I_GPUResource*>&dependencySet, const std::span<const std::unique_ptr<I_RenderPass<QueueType>>> renderPassSpan)
+			const auto addResourceDependenciesLambda = []<GPUCommandQueueType QueueType>(std::vector<I_GPUResource*>& dependencyArr, const std::span<const std::unique_ptr<I_RenderPass<QueueType>>> renderPassSpan)
 			{
 				for (const auto& renderPass : renderPassSpan)
 				{
 					for (const auto& dependency : renderPass->GetResourceDependencies())
-						dependencySet.Insert(dependency.ResourcePtr);
+						dependencyArr.push_back(dependency.ResourcePtr);
 				}
 			};
 			
-			addResourceDependenciesLambda(resourceDependencySet, std::span<const std::unique_ptr<I_RenderPass<GPUCommandQueueType::DIRECT>>>{ mDirectPassContainer.RenderPassArr });
-			addResourceDependenciesLambda(resourceDependencySet, std::span<const std::unique_ptr<I_RenderPass<GPUCommandQueueType::COMPUTE>>>{ mComputePassContainer.RenderPassArr });
-			addResourceDependenciesLambda(resourceDependencySet, std::span<const std::unique_ptr<I_RenderPass<GPUCommandQueueType::COPY>>>{ mCopyPassContainer.RenderPassArr });
+			addResourceDependenciesLambda(resourceDependencyArr, std::span<const std::unique_ptr<I_RenderPass<GPUCommandQueueType::DIRECT>>>{ mDirectPassContainer.RenderPassArr });
+			addResourceDependenciesLambda(resourceDependencyArr, std::span<const std::unique_ptr<I_RenderPass<GPUCommandQueueType::COMPUTE>>>{ mComputePassContainer.RenderPassArr });
+			addResourceDependenciesLambda(resourceDependencyArr, std::span<const std::unique_ptr<I_RenderPass<GPUCommandQueueType::COPY>>>{ mCopyPassContainer.RenderPassArr });
+
+			Brawler::SortedVector<I_GPUResource*> resourceDependencySet{};
+			resourceDependencySet.InsertRange(resourceDependencyArr);
 
 			return resourceDependencySet;
 		}
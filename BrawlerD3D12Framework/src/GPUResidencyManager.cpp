@@ -19,6 +19,7 @@ import Brawler.FreeGPUResidencyStateTraits;
 import Brawler.D3D12.I_FreeGPUResidencyState;
 import Brawler.D3D12.EvictPageableGPUObjectState;
 import Brawler.D3D12.DeletePageableGPUObjectState;
+import Brawler.EpochReclamation;
 
 namespace
 {
@@ -57,6 +58,11 @@ namespace Brawler
 		void GPUResidencyManager::UnregisterPageableGPUObject(I_PageableGPUObject& object)
 		{
 			mPageableObjArr.EraseIf([&object] (I_PageableGPUObject* const objPtr) { return (objPtr == &object); });
+
+			// This is called from the destructor of the I_PageableGPUObject, so we need to make sure
+			// that a residency pass which is still iterating over an older snapshot of mPageableObjArr
+			// is done with the object before we return.
+			Util::EpochReclamation::WaitForReaders();
 		}
 
 		GPUResidencyManager::ResidencyPassResults GPUResidencyManager::ExecuteResidencyPass() const
@@ -4,7 +4,7 @@ module;
 #include <span>
 
 export module Brawler.D3D12.GPUResidencyManager;
-import Brawler.ThreadSafeVector;
+import Brawler.CopyOnWriteVector;
 import Brawler.D3D12.GPUFence;
 
 export namespace Brawler
@@ -51,7 +51,9 @@ export namespace Brawler
 			MakeResidentResults TryMakeResident(std::span<I_PageableGPUObject* const>& evictedObjectSpan) const;
 
 		private:
-			Brawler::ThreadSafeVector<I_PageableGPUObject*> mPageableObjArr;
+			// This is iterated over at least once every frame, but objects are only rarely
+			// registered or unregistered.
+			Brawler::CopyOnWriteVector<I_PageableGPUObject*> mPageableObjArr;
 		};
 	}
 }
\ No newline at end of file
@@ -1,7 +1,6 @@
 module;
 #include <cassert>
 #include <optional>
-#include <mutex>
 #include <memory>
 #include <array>
 #include <atomic>
@@ -38,24 +37,6 @@ namespace Brawler
 {
 	namespace D3D12
 	{
-		void GPUResourceDescriptorHeap::InitializeBindlessSRVQueue()
-		{
-			// Create a separate index for every available bindless SRV index. This is done
-			// separately from initializing the ID3D12DescriptorHeap because it is a long-running
-			// process.
-			//
-			// Although this involves a lot of heap allocations, the process is done concurrently
-			// with D3D12 device creation. Since that process is unavoidable and takes a long-ass
-			// time anyways, doing this in parallel allows the queue initialization to essentially
-			// become "free."
-			{
-				std::scoped_lock<std::mutex> lock{ mBindlessIndexQueue.CritSection };
-
-				for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(BINDLESS_SRVS_PARTITION_SIZE); ++i)
-					mBindlessIndexQueue.Queue.push(i);
-			}
-		}
-
 		void GPUResourceDescriptorHeap::InitializeD3D12DescriptorHeap()
 		{
 			// Create the shader-visible resource descriptor heap.
@@ -76,26 +57,16 @@ namespace Brawler
 
 		std::unique_ptr<BindlessSRVSentinel> GPUResourceDescriptorHeap::AllocateBindlessSRV()
 		{
-			std::uint32_t extractedIndex = 0;
+			const std::optional<std::uint32_t> allocatedIndex{ mBindlessIndexAllocator.Allocate() };
+			assert(allocatedIndex.has_value() && "ERROR: The limit of 500,000 bindless SRVs has been exceeded!");
 
-			{
-				std::scoped_lock<std::mutex> lock{ mBindlessIndexQueue.CritSection };
-
-				assert(!mBindlessIndexQueue.Queue.empty() && "ERROR: The limit of 500,000 bindless SRVs has been exceeded!");
-
-				extractedIndex = mBindlessIndexQueue.Queue.front();
-				mBindlessIndexQueue.Queue.pop();
-			}
-
-			BindlessSRVSentinel bindlessSentinel{ extractedIndex };
+			BindlessSRVSentinel bindlessSentinel{ *allocatedIndex };
 			return std::make_unique<BindlessSRVSentinel>(std::move(bindlessSentinel));
 		}
 
 		void GPUResourceDescriptorHeap::ReClaimBindlessSRV(BindlessSRVSentinel& srvAllocation)
 		{
-			std::scoped_lock<std::mutex> lock{ mBindlessIndexQueue.CritSection };
-
-			mBindlessIndexQueue.Queue.push(srvAllocation.GetBindlessSRVIndex());
+			mBindlessIndexAllocator.Free(srvAllocation.GetBindlessSRVIndex());
 		}
 
 		PerFrameDescriptorTable GPUResourceDescriptorHeap::CreatePerFrameDescriptorTable(const DescriptorTableBuilder& tableBuilder)
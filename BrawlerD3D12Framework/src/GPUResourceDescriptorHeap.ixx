@@ -1,7 +1,5 @@
 module;
 #include <cstddef>
-#include <queue>
-#include <mutex>
 #include <cassert>
 #include <memory>
 #include <array>
@@ -11,6 +9,7 @@ export module Brawler.D3D12.GPUResourceDescriptorHeap;
 import Brawler.D3D12.PerFrameDescriptorTable;
 import Brawler.D3D12.DescriptorHandleInfo;
 import Brawler.D3D12.BindlessSRVSentinel;
+import Brawler.AtomicBitmapIndexAllocator;
 import Util.Engine;
 
 export namespace Brawler
@@ -43,17 +42,6 @@ export namespace Brawler
 	{
 		class GPUResourceDescriptorHeap
 		{
-		private:
-			struct BindlessIndexInfo
-			{
-				// There's 500,000 bindless SRV indices. If we use a Brawler::ThreadSafeQueue, then
-				// we get 500,000 unsigned 32-bit integers allocated on the stack. I'm embarrassed to
-				// say that I only realized how bad of an idea this is after I got a stack overflow.
-				std::queue<std::uint32_t> Queue;
-
-				mutable std::mutex CritSection;
-			};
-
 		public:
 			GPUResourceDescriptorHeap() = default;
 
@@ -63,7 +51,6 @@ export namespace Brawler
 			GPUResourceDescriptorHeap(GPUResourceDescriptorHeap&& rhs) noexcept = default;
 			GPUResourceDescriptorHeap& operator=(GPUResourceDescriptorHeap&& rhs) noexcept = default;
 
-			void InitializeBindlessSRVQueue();
 			void InitializeD3D12DescriptorHeap();
 
 			std::unique_ptr<BindlessSRVSentinel> AllocateBindlessSRV();
@@ -85,7 +72,7 @@ export namespace Brawler
 
 		private:
 			Microsoft::WRL::ComPtr<Brawler::D3D12DescriptorHeap> mHeap;
-			BindlessIndexInfo mBindlessIndexQueue;
+			AtomicBitmapIndexAllocator<static_cast<std::uint32_t>(BINDLESS_SRVS_PARTITION_SIZE)> mBindlessIndexAllocator;
 			std::array<std::atomic<std::uint32_t>, Util::Engine::MAX_FRAMES_IN_FLIGHT> mPerFrameIndexArr;
 			std::uint32_t mDescriptorHandleIncrementSize;
 		};
@@ -1,13 +1,21 @@
 module;
 #include <vector>
 #include <span>
+#include <memory_resource>
 
 module Brawler.D3D12.GPUResourceEventCollection;
+import Brawler.FrameLinearAllocator;
 
 namespace Brawler
 {
 	namespace D3D12
 	{
+		GPUResourceEventCollection::GPUResourceEventCollection() :
+			mDirectEventArr(&(Util::Engine::GetFrameLinearMemoryResource())),
+			mComputeEventArr(&(Util::Engine::GetFrameLinearMemoryResource())),
+			mCopyEventArr(&(Util::Engine::GetFrameLinearMemoryResource()))
+		{}
+
 		void GPUResourceEventCollection::MergeGPUResourceEventCollection(GPUResourceEventCollection&& mergedCollection)
 		{
 			mDirectEventArr.reserve(mDirectEventArr.size() + mergedCollection.mDirectEventArr.size());
@@ -1,6 +1,7 @@
 module;
 #include <vector>
 #include <span>
+#include <memory_resource>
 
 export module Brawler.D3D12.GPUResourceEventCollection;
 import Brawler.D3D12.GPUCommandQueueType;
@@ -30,7 +31,7 @@ export namespace Brawler
 			};
 
 		public:
-			GPUResourceEventCollection() = default;
+			GPUResourceEventCollection();
 
 			GPUResourceEventCollection(const GPUResourceEventCollection& rhs) = delete;
 			GPUResourceEventCollection& operator=(const GPUResourceEventCollection& rhs) = delete;
@@ -50,9 +51,11 @@ export namespace Brawler
 			void MergeGPUResourceEventCollection(GPUResourceEventCollection&& mergedCollection);
 
 		private:
-			std::vector<EventContainer<GPUCommandQueueType::DIRECT>> mDirectEventArr;
-			std::vector<EventContainer<GPUCommandQueueType::COMPUTE>> mComputeEventArr;
-			std::vector<EventContainer<GPUCommandQueueType::COPY>> mCopyEventArr;
+			// GPUResourceEventCollection instances only live for as long as it takes to compile
+			// the FrameGraph, so their events are stored in frame-linear memory.
+			std::pmr::vector<EventContainer<GPUCommandQueueType::DIRECT>> mDirectEventArr;
+			std::pmr::vector<EventContainer<GPUCommandQueueType::COMPUTE>> mComputeEventArr;
+			std::pmr::vector<EventContainer<GPUCommandQueueType::COPY>> mCopyEventArr;
 		};
 	}
 }
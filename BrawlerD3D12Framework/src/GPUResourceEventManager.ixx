@@ -105,12 +105,9 @@ namespace Brawler
 		void GPUResourceEventManager::SetRenderPassCount(const std::size_t numRenderPasses)
 		{
 			// We don't actually need to set anything here. This is just an optimization to try to
-			// reserve memory for the maps up front.
-			//
-			// We specify (1.25 * numRenderPasses) in order to try to reduce the chances of a
-			// re-hash occurring, since these can be expensive.
-			const float reservationInElements = (1.25f * static_cast<float>(numRenderPasses));
-			GetRenderPassEventQueueMap<QueueType>().Reserve(static_cast<std::size_t>(reservationInElements));
+			// reserve memory for the maps up front. FastUnorderedMap::Reserve() already accounts
+			// for the map's maximum load factor, so this guarantees that no re-hash occurs.
+			GetRenderPassEventQueueMap<QueueType>().Reserve(numRenderPasses);
 		}
 
 		template <GPUCommandQueueType QueueType>
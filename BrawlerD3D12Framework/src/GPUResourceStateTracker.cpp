@@ -3,11 +3,13 @@ module;
 #include <cassert>
 #include <span>
 #include <ranges>
+#include <memory_resource>
 #include "DxDef.h"
 
 module Brawler.D3D12.GPUResourceStateTracker;
 import Brawler.CompositeEnum;
 import Util.General;
+import Brawler.FrameLinearAllocator;
 
 namespace
 {
@@ -23,7 +25,7 @@ namespace Brawler
 	namespace D3D12
 	{
 		GPUResourceStateTracker::GPUResourceStateTracker(I_GPUResource& trackedResource) :
-			mBarrierMergerArr(),
+			mBarrierMergerArr(&(Util::Engine::GetFrameLinearMemoryResource())),
 			mResourceAlwaysDecays(DoesResourceAlwaysDecay(trackedResource))
 		{
 			const std::size_t subResourceCount = trackedResource.GetSubResourceCount();
@@ -1,4 +1,6 @@
 module;
+#include <vector>
+#include <memory_resource>
 #include "DxDef.h"
 
 export module Brawler.D3D12.GPUResourceStateTracker;
@@ -32,7 +34,7 @@ export namespace Brawler
 			void CheckForResourceStateDecay(const GPUExecutionModule& executionModule);
 
 		private:
-			std::vector<GPUSubResourceStateBarrierMerger> mBarrierMergerArr;
+			std::pmr::vector<GPUSubResourceStateBarrierMerger> mBarrierMergerArr;
 			bool mResourceAlwaysDecays;
 		};
 	}
@@ -1,7 +1,8 @@
 module;
-#include <memory>
 #include <cassert>
-#include <functional>
+#include <exception>
+#include <utility>
+#include <cstdint>
 
 module Brawler.Job;
 import Brawler.JobCounter;
@@ -10,12 +11,13 @@ import Util.Engine;
 import Util.Threading;
 import Brawler.ThreadLocalResources;
 import Brawler.DelayedJobSubmitter;
+import Brawler.JobTrace;
 
 namespace Brawler
 {
-	Job::Job(std::move_only_function<void()>&& callback, std::shared_ptr<JobCounter> counterPtr, JobPriority priority) :
+	Job::Job(JobCallback&& callback, JobCounterHandle hCounter, JobPriority priority) :
 		mCallback(std::move(callback)),
-		mCounterPtr(counterPtr),
+		mHCounter(std::move(hCounter)),
 		mPriority(priority),
 
 		// Yes, we want to store it on CPU job *creation*, and *NOT* on CPU job execution. If
@@ -35,29 +37,43 @@ namespace Brawler
 
 		// Try to submit any delayed CPU jobs belonging to this thread.
 		Util::Threading::GetThreadLocalResources().GetDelayedJobSubmitter().CheckForDelayedJobSubmissions();
+
+		// The JobCounter address is what lets the trace tie this job back to the JobGroup which
+		// dispatched it. We need to grab it now, since the counter may be re-used as soon as we
+		// decrement it.
+		const std::uint64_t traceCounterAddress = reinterpret_cast<std::uintptr_t>(mHCounter.Get());
+
+		if constexpr (Util::JobTrace::IsJobTracingEnabled())
+			Util::JobTrace::RecordEvent(JobTraceEventType::JOB_BEGIN, traceCounterAddress);
 		
 		try
 		{
 			mCallback();
 
+			if constexpr (Util::JobTrace::IsJobTracingEnabled())
+				Util::JobTrace::RecordEvent(JobTraceEventType::JOB_END, traceCounterAddress);
+
 			threadLocalResources.ResetCachedFrameNumber();
 
-			if (mCounterPtr != nullptr)
-				mCounterPtr->DecrementCounter();
+			if (mHCounter != nullptr)
+				mHCounter->DecrementCounter();
 		}
 		catch (...)
 		{
+			if constexpr (Util::JobTrace::IsJobTracingEnabled())
+				Util::JobTrace::RecordEvent(JobTraceEventType::JOB_END, traceCounterAddress);
+
 			threadLocalResources.ResetCachedFrameNumber();
 			
-			if (mCounterPtr != nullptr)
+			if (mHCounter != nullptr)
 			{
-				mCounterPtr->DecrementCounter();
+				mHCounter->DecrementCounter();
 
 				// We don't want this thread to exit until all of the other CPU jobs associated
 				// with this counter have completed; otherwise, we risk stack unwinding wreaking
 				// havoc on the memory accessed by other threads. So, we wait here until the
 				// counter reaches zero to leave.
-				while (!mCounterPtr->IsFinished());
+				while (!mHCounter->IsFinished());
 			}
 
 			std::rethrow_exception(std::current_exception());
@@ -1,9 +1,10 @@
 module;
-#include <functional>
+#include <cstdint>
 
 export module Brawler.Job;
 import Brawler.JobCounter;
 import Brawler.JobPriority;
+import Brawler.JobCallback;
 
 export namespace Brawler
 {
@@ -11,7 +12,7 @@ export namespace Brawler
 	{
 	public:
 		Job() = default;
-		Job(std::move_only_function<void()>&& callback, std::shared_ptr<JobCounter> counterPtr, JobPriority priority = JobPriority::NORMAL);
+		Job(JobCallback&& callback, JobCounterHandle hCounter, JobPriority priority = JobPriority::NORMAL);
 
 		Job(const Job& rhs) = delete;
 		Job& operator=(const Job& rhs) = delete;
@@ -23,8 +24,8 @@ export namespace Brawler
 		JobPriority GetPriority() const;
 
 	private:
-		std::move_only_function<void()> mCallback;
-		std::shared_ptr<JobCounter> mCounterPtr;
+		JobCallback mCallback;
+		JobCounterHandle mHCounter;
 		JobPriority mPriority;
 		std::uint64_t mCachedFrameNumber;
 	};
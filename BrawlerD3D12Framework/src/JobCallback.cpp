@@ -0,0 +1,62 @@
+module;
+#include <cassert>
+#include <utility>
+
+module Brawler.JobCallback;
+
+namespace Brawler
+{
+	JobCallback::~JobCallback()
+	{
+		Reset();
+	}
+
+	JobCallback::JobCallback(JobCallback&& rhs) noexcept :
+		mStorageArr(),
+		mOperationsPtr(rhs.mOperationsPtr)
+	{
+		if (mOperationsPtr != nullptr)
+		{
+			mOperationsPtr->MoveFunction(mStorageArr, rhs.mStorageArr);
+			rhs.mOperationsPtr = nullptr;
+		}
+	}
+
+	JobCallback& JobCallback::operator=(JobCallback&& rhs) noexcept
+	{
+		if (this != &rhs)
+		{
+			Reset();
+
+			mOperationsPtr = rhs.mOperationsPtr;
+
+			if (mOperationsPtr != nullptr)
+			{
+				mOperationsPtr->MoveFunction(mStorageArr, rhs.mStorageArr);
+				rhs.mOperationsPtr = nullptr;
+			}
+		}
+
+		return *this;
+	}
+
+	void JobCallback::operator()()
+	{
+		assert(mOperationsPtr != nullptr && "ERROR: An attempt was made to call an empty Brawler::JobCallback!");
+		mOperationsPtr->InvokeFunction(mStorageArr);
+	}
+
+	JobCallback::operator bool() const
+	{
+		return (mOperationsPtr != nullptr);
+	}
+
+	void JobCallback::Reset()
+	{
+		if (mOperationsPtr != nullptr)
+		{
+			mOperationsPtr->DestroyFunction(mStorageArr);
+			mOperationsPtr = nullptr;
+		}
+	}
+}
\ No newline at end of file
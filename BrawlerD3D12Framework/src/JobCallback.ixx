@@ -0,0 +1,170 @@
+module;
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <type_traits>
+#include <concepts>
+#include <functional>
+#include <utility>
+
+export module Brawler.JobCallback;
+
+namespace Brawler
+{
+	namespace IMPL
+	{
+		static constexpr std::size_t JOB_CALLBACK_INLINE_STORAGE_SIZE = 48;
+
+		// Callbacks whose captures do not fit into the inline storage of a JobCallback are
+		// moved into a heap allocation, just like with std::move_only_function. This is correct,
+		// but it defeats the purpose of JobCallback. Setting this to true turns every such
+		// callback into a compiler error, which makes it easy to find the offending call sites.
+		// (JobGroup::AddJob() always requires inline callbacks, regardless of this setting.)
+		static constexpr bool REQUIRE_INLINE_JOB_CALLBACKS = false;
+	}
+}
+
+export namespace Brawler
+{
+	/// <summary>
+	/// This concept is satisfied if a callback of type Callback can be stored within the
+	/// inline storage of a Brawler::JobCallback; that is, if creating a JobCallback from it
+	/// does not require a heap allocation. Use this with static_assert() in performance-critical
+	/// code to make sure that a lambda function does not capture too much.
+	/// </summary>
+	template <typename Callback>
+	concept InlineJobCallback = (sizeof(Callback) <= IMPL::JOB_CALLBACK_INLINE_STORAGE_SIZE && alignof(Callback) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Callback>);
+
+	// Brawler::JobCallback is the type-erased callable stored within a Brawler::Job. It behaves
+	// like a std::move_only_function<void()>, but callables of up to 48 bytes are always stored
+	// inline. (The size of the small buffer of std::move_only_function is implementation-defined,
+	// and MSVC's is smaller than what a typical job lambda captures.) Since every job used to
+	// require a heap allocation for its callback, this makes a noticeable difference for
+	// fine-grained jobs.
+	//
+	// If the callable returns a value, then it is discarded.
+
+	class JobCallback
+	{
+	private:
+		struct CallbackOperations
+		{
+			void(*InvokeFunction)(void* storagePtr);
+			void(*MoveFunction)(void* destStoragePtr, void* srcStoragePtr) noexcept;
+			void(*DestroyFunction)(void* storagePtr) noexcept;
+		};
+
+	public:
+		JobCallback() = default;
+
+		template <typename Callback>
+			requires (!std::same_as<std::decay_t<Callback>, JobCallback> && std::invocable<std::decay_t<Callback>&> && std::move_constructible<std::decay_t<Callback>>)
+		JobCallback(Callback&& callback);
+
+		~JobCallback();
+
+		JobCallback(const JobCallback& rhs) = delete;
+		JobCallback& operator=(const JobCallback& rhs) = delete;
+
+		JobCallback(JobCallback&& rhs) noexcept;
+		JobCallback& operator=(JobCallback&& rhs) noexcept;
+
+		void operator()();
+
+		explicit operator bool() const;
+
+	private:
+		void Reset();
+
+		template <typename Callback>
+		static const CallbackOperations& GetInlineCallbackOperations();
+
+		template <typename Callback>
+		static const CallbackOperations& GetHeapCallbackOperations();
+
+	private:
+		alignas(std::max_align_t) std::byte mStorageArr[IMPL::JOB_CALLBACK_INLINE_STORAGE_SIZE];
+		const CallbackOperations* mOperationsPtr = nullptr;
+	};
+}
+
+// --------------------------------------------------------------------------------------------------
+
+namespace Brawler
+{
+	template <typename Callback>
+		requires (!std::same_as<std::decay_t<Callback>, JobCallback> && std::invocable<std::decay_t<Callback>&> && std::move_constructible<std::decay_t<Callback>>)
+	JobCallback::JobCallback(Callback&& callback) :
+		mStorageArr(),
+		mOperationsPtr(nullptr)
+	{
+		using StoredCallback = std::decay_t<Callback>;
+
+		static_assert(!IMPL::REQUIRE_INLINE_JOB_CALLBACKS || InlineJobCallback<StoredCallback>, "ERROR: The captures of a job callback are too large to be stored inline within a Brawler::JobCallback! Either capture less (e.g., capture a pointer to a struct rather than its members), or set IMPL::REQUIRE_INLINE_JOB_CALLBACKS to false. (See JobCallback.ixx.)");
+
+		if constexpr (InlineJobCallback<StoredCallback>)
+		{
+			std::construct_at(reinterpret_cast<StoredCallback*>(mStorageArr), std::forward<Callback>(callback));
+			mOperationsPtr = &(GetInlineCallbackOperations<StoredCallback>());
+		}
+		else
+		{
+			StoredCallback* const heapCallbackPtr = new StoredCallback(std::forward<Callback>(callback));
+			std::construct_at(reinterpret_cast<StoredCallback**>(mStorageArr), heapCallbackPtr);
+
+			mOperationsPtr = &(GetHeapCallbackOperations<StoredCallback>());
+		}
+	}
+
+	template <typename Callback>
+	const JobCallback::CallbackOperations& JobCallback::GetInlineCallbackOperations()
+	{
+		static constexpr CallbackOperations INLINE_OPERATIONS{
+			.InvokeFunction = [] (void* storagePtr)
+			{
+				std::invoke(*std::launder(reinterpret_cast<Callback*>(storagePtr)));
+			},
+
+			.MoveFunction = [] (void* destStoragePtr, void* srcStoragePtr) noexcept
+			{
+				Callback& srcCallback{ *std::launder(reinterpret_cast<Callback*>(srcStoragePtr)) };
+
+				std::construct_at(reinterpret_cast<Callback*>(destStoragePtr), std::move(srcCallback));
+				std::destroy_at(&srcCallback);
+			},
+
+			.DestroyFunction = [] (void* storagePtr) noexcept
+			{
+				std::destroy_at(std::launder(reinterpret_cast<Callback*>(storagePtr)));
+			}
+		};
+
+		return INLINE_OPERATIONS;
+	}
+
+	template <typename Callback>
+	const JobCallback::CallbackOperations& JobCallback::GetHeapCallbackOperations()
+	{
+		// For callbacks stored on the heap, the inline storage only contains a pointer to
+		// the callback. Moving the JobCallback just moves this pointer.
+
+		static constexpr CallbackOperations HEAP_OPERATIONS{
+			.InvokeFunction = [] (void* storagePtr)
+			{
+				std::invoke(**std::launder(reinterpret_cast<Callback**>(storagePtr)));
+			},
+
+			.MoveFunction = [] (void* destStoragePtr, void* srcStoragePtr) noexcept
+			{
+				std::construct_at(reinterpret_cast<Callback**>(destStoragePtr), *std::launder(reinterpret_cast<Callback**>(srcStoragePtr)));
+			},
+
+			.DestroyFunction = [] (void* storagePtr) noexcept
+			{
+				delete *std::launder(reinterpret_cast<Callback**>(storagePtr));
+			}
+		};
+
+		return HEAP_OPERATIONS;
+	}
+}
\ No newline at end of file
@@ -1,12 +1,257 @@
 module;
 #include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <cassert>
+#include <utility>
 
 module Brawler.JobCounter;
 
+namespace
+{
+	// This is the number of JobCounters which are allocated from the heap at once when a
+	// thread runs out of free JobCounters.
+	static constexpr std::size_t JOB_COUNTER_BLOCK_SIZE = 64;
+
+	// JobCounters are returned to the free list of whichever thread releases the last
+	// reference to them, which is not necessarily the thread which created them. If we did
+	// nothing about this, then a thread which only ever creates JobGroups would keep
+	// allocating new JobCounters, while the free lists of the threads which execute the jobs
+	// would grow indefinitely. So, once a thread has more than MAX_LOCAL_FREE_JOB_COUNTERS
+	// free JobCounters, it moves a batch of JOB_COUNTER_BATCH_SIZE of them to a shared pool,
+	// from which other threads can take them.
+	static constexpr std::size_t JOB_COUNTER_BATCH_SIZE = 64;
+	static constexpr std::size_t MAX_LOCAL_FREE_JOB_COUNTERS = (JOB_COUNTER_BATCH_SIZE * 4);
+
+	// This is set once the JobCounterPool of the calling thread has been destroyed. It is
+	// constinit and trivially destructible, so it remains valid for the entire lifetime of the
+	// thread, including while its thread_local objects are being destroyed.
+	constinit thread_local bool isThreadLocalPoolDestroyed = false;
+}
+
+namespace Brawler
+{
+	class JobCounterPool
+	{
+	private:
+		struct JobCounterBatch
+		{
+			JobCounter* HeadCounterPtr;
+			std::size_t CounterCount;
+		};
+
+		struct SharedJobCounterStorage
+		{
+			std::mutex CritSection;
+
+			// The memory for JobCounters is never freed until the program exits. This ensures
+			// that a JobCounter which is still referenced by a Job is never deleted just
+			// because the thread which allocated it has exited.
+			std::vector<std::unique_ptr<JobCounter[]>> CounterBlockArr;
+
+			std::vector<JobCounterBatch> FreeBatchArr;
+		};
+
+	public:
+		JobCounterPool() = default;
+		~JobCounterPool();
+
+		JobCounterPool(const JobCounterPool& rhs) = delete;
+		JobCounterPool& operator=(const JobCounterPool& rhs) = delete;
+
+		JobCounterPool(JobCounterPool&& rhs) noexcept = delete;
+		JobCounterPool& operator=(JobCounterPool&& rhs) noexcept = delete;
+
+		JobCounter& AcquireJobCounter();
+		void ReturnJobCounter(JobCounter& counter);
+
+		static JobCounter& AcquireJobCounterForCurrentThread();
+		static void ReturnJobCounterForCurrentThread(JobCounter& counter);
+
+	private:
+		void RefillFreeList();
+		JobCounterBatch ExtractBatch(const std::size_t numCounters);
+
+		static JobCounterPool* TryGetThreadLocalPool();
+
+		static SharedJobCounterStorage& GetSharedStorage();
+
+	private:
+		JobCounter* mFreeCounterHeadPtr = nullptr;
+		std::size_t mFreeCounterCount = 0;
+	};
+
+	JobCounterPool::~JobCounterPool()
+	{
+		// From now on, this thread uses the fallback paths of AcquireJobCounterForCurrentThread()
+		// and ReturnJobCounterForCurrentThread(). (The temporary JobCounterPool instances which
+		// those create are never the thread_local one.)
+		if (this == TryGetThreadLocalPool())
+			isThreadLocalPoolDestroyed = true;
+
+		// Give the remaining free JobCounters to the shared pool so that other threads can
+		// use them.
+		if (mFreeCounterCount == 0)
+			return;
+
+		const JobCounterBatch remainingBatch{ ExtractBatch(mFreeCounterCount) };
+
+		SharedJobCounterStorage& sharedStorage{ GetSharedStorage() };
+		std::scoped_lock<std::mutex> lock{ sharedStorage.CritSection };
+
+		sharedStorage.FreeBatchArr.push_back(remainingBatch);
+	}
+
+	JobCounter& JobCounterPool::AcquireJobCounter()
+	{
+		if (mFreeCounterHeadPtr == nullptr) [[unlikely]]
+			RefillFreeList();
+
+		JobCounter& acquiredCounter{ *mFreeCounterHeadPtr };
+		mFreeCounterHeadPtr = acquiredCounter.mNextFreeCounterPtr;
+		--mFreeCounterCount;
+
+		acquiredCounter.mNextFreeCounterPtr = nullptr;
+		acquiredCounter.mCounter.store(0, std::memory_order::relaxed);
+		acquiredCounter.mReferenceCount.store(1, std::memory_order::relaxed);
+
+		return acquiredCounter;
+	}
+
+	void JobCounterPool::ReturnJobCounter(JobCounter& counter)
+	{
+		counter.mNextFreeCounterPtr = mFreeCounterHeadPtr;
+		mFreeCounterHeadPtr = &counter;
+		++mFreeCounterCount;
+
+		if (mFreeCounterCount > MAX_LOCAL_FREE_JOB_COUNTERS) [[unlikely]]
+		{
+			const JobCounterBatch excessBatch{ ExtractBatch(JOB_COUNTER_BATCH_SIZE) };
+
+			SharedJobCounterStorage& sharedStorage{ GetSharedStorage() };
+			std::scoped_lock<std::mutex> lock{ sharedStorage.CritSection };
+
+			sharedStorage.FreeBatchArr.push_back(excessBatch);
+		}
+	}
+
+	JobCounter& JobCounterPool::AcquireJobCounterForCurrentThread()
+	{
+		JobCounterPool* const threadLocalPoolPtr = TryGetThreadLocalPool();
+
+		if (threadLocalPoolPtr != nullptr) [[likely]]
+			return threadLocalPoolPtr->AcquireJobCounter();
+
+		// The thread_local JobCounterPool has already been destroyed. This happens if a
+		// JobGroup is created by the destructor of another thread_local object, or by that of
+		// an object with static storage duration on the main thread. In that case, we use a
+		// temporary JobCounterPool. It takes a batch from the shared pool (or allocates a new
+		// block), and its destructor gives back whatever we did not use.
+		JobCounterPool fallbackPool{};
+		return fallbackPool.AcquireJobCounter();
+	}
+
+	void JobCounterPool::ReturnJobCounterForCurrentThread(JobCounter& counter)
+	{
+		JobCounterPool* const threadLocalPoolPtr = TryGetThreadLocalPool();
+
+		if (threadLocalPoolPtr != nullptr) [[likely]]
+		{
+			threadLocalPoolPtr->ReturnJobCounter(counter);
+			return;
+		}
+
+		// See JobCounterPool::AcquireJobCounterForCurrentThread(). The destructor of the
+		// temporary JobCounterPool moves the JobCounter straight to the shared pool.
+		JobCounterPool fallbackPool{};
+		fallbackPool.ReturnJobCounter(counter);
+	}
+
+	JobCounterPool* JobCounterPool::TryGetThreadLocalPool()
+	{
+		// The order in which thread_local objects are destroyed depends on the order in which
+		// they were constructed, so a JobCounterHandle which is owned by another thread_local
+		// object can outlive this JobCounterPool. Accessing the JobCounterPool after it has
+		// been destroyed would be undefined behavior, so we return nullptr instead.
+		if (isThreadLocalPoolDestroyed) [[unlikely]]
+			return nullptr;
+
+		thread_local JobCounterPool threadLocalPool{};
+		return &threadLocalPool;
+	}
+
+	void JobCounterPool::RefillFreeList()
+	{
+		assert(mFreeCounterHeadPtr == nullptr && mFreeCounterCount == 0);
+
+		SharedJobCounterStorage& sharedStorage{ GetSharedStorage() };
+
+		{
+			std::scoped_lock<std::mutex> lock{ sharedStorage.CritSection };
+
+			// Prefer taking JobCounters which other threads have given up over allocating
+			// new ones.
+			if (!sharedStorage.FreeBatchArr.empty())
+			{
+				const JobCounterBatch freeBatch{ sharedStorage.FreeBatchArr.back() };
+				sharedStorage.FreeBatchArr.pop_back();
+
+				mFreeCounterHeadPtr = freeBatch.HeadCounterPtr;
+				mFreeCounterCount = freeBatch.CounterCount;
+
+				return;
+			}
+		}
+
+		std::unique_ptr<JobCounter[]> counterBlock{ std::make_unique<JobCounter[]>(JOB_COUNTER_BLOCK_SIZE) };
+
+		for (std::size_t i = 0; i < JOB_COUNTER_BLOCK_SIZE; ++i)
+			counterBlock[i].mNextFreeCounterPtr = (i + 1 < JOB_COUNTER_BLOCK_SIZE ? &(counterBlock[i + 1]) : nullptr);
+
+		mFreeCounterHeadPtr = &(counterBlock[0]);
+		mFreeCounterCount = JOB_COUNTER_BLOCK_SIZE;
+
+		std::scoped_lock<std::mutex> lock{ sharedStorage.CritSection };
+		sharedStorage.CounterBlockArr.push_back(std::move(counterBlock));
+	}
+
+	JobCounterPool::JobCounterBatch JobCounterPool::ExtractBatch(const std::size_t numCounters)
+	{
+		assert(numCounters > 0 && numCounters <= mFreeCounterCount);
+
+		JobCounter* const batchHeadPtr = mFreeCounterHeadPtr;
+		JobCounter* batchTailPtr = batchHeadPtr;
+
+		for (std::size_t i = 1; i < numCounters; ++i)
+			batchTailPtr = batchTailPtr->mNextFreeCounterPtr;
+
+		mFreeCounterHeadPtr = batchTailPtr->mNextFreeCounterPtr;
+		mFreeCounterCount -= numCounters;
+
+		batchTailPtr->mNextFreeCounterPtr = nullptr;
+
+		return JobCounterBatch{
+			.HeadCounterPtr = batchHeadPtr,
+			.CounterCount = numCounters
+		};
+	}
+
+	JobCounterPool::SharedJobCounterStorage& JobCounterPool::GetSharedStorage()
+	{
+		static SharedJobCounterStorage sharedStorage{};
+		return sharedStorage;
+	}
+}
+
 namespace Brawler
 {
 	JobCounter::JobCounter() :
-		mCounter()
+		mCounter(),
+		mReferenceCount(),
+		mNextFreeCounterPtr(nullptr)
 	{}
 
 	void JobCounter::DecrementCounter()
@@ -23,4 +268,96 @@ namespace Brawler
 	{
 		mCounter.store(jobCount);
 	}
+}
+
+namespace Brawler
+{
+	JobCounterHandle::JobCounterHandle(std::nullptr_t) :
+		mCounterPtr(nullptr)
+	{}
+
+	JobCounterHandle::JobCounterHandle(JobCounter& counter) :
+		mCounterPtr(&counter)
+	{}
+
+	JobCounterHandle::~JobCounterHandle()
+	{
+		ReleaseReference();
+	}
+
+	JobCounterHandle::JobCounterHandle(const JobCounterHandle& rhs) :
+		mCounterPtr(rhs.mCounterPtr)
+	{
+		if (mCounterPtr != nullptr)
+			mCounterPtr->mReferenceCount.fetch_add(1, std::memory_order::relaxed);
+	}
+
+	JobCounterHandle& JobCounterHandle::operator=(const JobCounterHandle& rhs)
+	{
+		if (mCounterPtr != rhs.mCounterPtr)
+		{
+			if (rhs.mCounterPtr != nullptr)
+				rhs.mCounterPtr->mReferenceCount.fetch_add(1, std::memory_order::relaxed);
+
+			ReleaseReference();
+			mCounterPtr = rhs.mCounterPtr;
+		}
+
+		return *this;
+	}
+
+	JobCounterHandle::JobCounterHandle(JobCounterHandle&& rhs) noexcept :
+		mCounterPtr(std::exchange(rhs.mCounterPtr, nullptr))
+	{}
+
+	JobCounterHandle& JobCounterHandle::operator=(JobCounterHandle&& rhs) noexcept
+	{
+		if (this != &rhs)
+		{
+			ReleaseReference();
+			mCounterPtr = std::exchange(rhs.mCounterPtr, nullptr);
+		}
+
+		return *this;
+	}
+
+	JobCounterHandle JobCounterHandle::Create()
+	{
+		return JobCounterHandle{ JobCounterPool::AcquireJobCounterForCurrentThread() };
+	}
+
+	JobCounter* JobCounterHandle::Get() const
+	{
+		return mCounterPtr;
+	}
+
+	JobCounter* JobCounterHandle::operator->() const
+	{
+		assert(mCounterPtr != nullptr);
+		return mCounterPtr;
+	}
+
+	JobCounter& JobCounterHandle::operator*() const
+	{
+		assert(mCounterPtr != nullptr);
+		return *mCounterPtr;
+	}
+
+	bool JobCounterHandle::operator==(std::nullptr_t) const
+	{
+		return (mCounterPtr == nullptr);
+	}
+
+	void JobCounterHandle::ReleaseReference()
+	{
+		if (mCounterPtr == nullptr)
+			return;
+
+		// The acquire-release ordering makes sure that every access to the JobCounter made
+		// through other JobCounterHandles happens before it is re-used.
+		if (mCounterPtr->mReferenceCount.fetch_sub(1, std::memory_order::acq_rel) == 1)
+			JobCounterPool::ReturnJobCounterForCurrentThread(*mCounterPtr);
+
+		mCounterPtr = nullptr;
+	}
 }
\ No newline at end of file
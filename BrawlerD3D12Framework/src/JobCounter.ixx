@@ -1,11 +1,19 @@
 module;
 #include <atomic>
+#include <cstdint>
+#include <cstddef>
 
 export module Brawler.JobCounter;
 
 export namespace Brawler
 {
 	class JobGroup;
+	class JobCounterHandle;
+}
+
+namespace Brawler
+{
+	class JobCounterPool;
 }
 
 export namespace Brawler
@@ -14,10 +22,18 @@ export namespace Brawler
 	{
 	private:
 		friend class JobGroup;
+		friend class JobCounterHandle;
+		friend class JobCounterPool;
 
 	public:
 		JobCounter();
 
+		JobCounter(const JobCounter& rhs) = delete;
+		JobCounter& operator=(const JobCounter& rhs) = delete;
+
+		JobCounter(JobCounter&& rhs) noexcept = delete;
+		JobCounter& operator=(JobCounter&& rhs) noexcept = delete;
+
 		void DecrementCounter();
 		bool IsFinished() const;
 
@@ -26,5 +42,62 @@ export namespace Brawler
 
 	private:
 		std::atomic<std::uint32_t> mCounter;
+
+		// JobCounters are intrusively reference counted. This saves us from having to
+		// allocate a separate control block for every JobGroup, as std::make_shared() did.
+		std::atomic<std::uint32_t> mReferenceCount;
+
+		// While a JobCounter is not in use, it is stored in the free list of a
+		// JobCounterPool. This is the next JobCounter in that list.
+		JobCounter* mNextFreeCounterPtr;
+	};
+
+	/// <summary>
+	/// A JobCounterHandle is a reference-counted pointer to a JobCounter, similar to a
+	/// std::shared_ptr&lt;JobCounter&gt;. The reference count is stored within the JobCounter
+	/// itself, and once the last JobCounterHandle referring to a JobCounter is destroyed, the
+	/// JobCounter is returned to the free list of the destroying thread, rather than being
+	/// deleted.
+	/// 
+	/// Use JobCounterHandle::Create() to create a new JobCounter.
+	/// </summary>
+	class JobCounterHandle
+	{
+	public:
+		JobCounterHandle() = default;
+		JobCounterHandle(std::nullptr_t);
+
+		~JobCounterHandle();
+
+		JobCounterHandle(const JobCounterHandle& rhs);
+		JobCounterHandle& operator=(const JobCounterHandle& rhs);
+
+		JobCounterHandle(JobCounterHandle&& rhs) noexcept;
+		JobCounterHandle& operator=(JobCounterHandle&& rhs) noexcept;
+
+		/// <summary>
+		/// Retrieves a JobCounter from the calling thread's JobCounterPool and returns a
+		/// JobCounterHandle referring to it. This only allocates memory if neither the calling
+		/// thread's pool nor the shared pool of JobCounters has any free JobCounters left.
+		/// </summary>
+		/// <returns>
+		/// The function returns a JobCounterHandle referring to an unused JobCounter.
+		/// </returns>
+		static JobCounterHandle Create();
+
+		JobCounter* Get() const;
+
+		JobCounter* operator->() const;
+		JobCounter& operator*() const;
+
+		bool operator==(std::nullptr_t) const;
+
+	private:
+		explicit JobCounterHandle(JobCounter& counter);
+
+		void ReleaseReference();
+
+	private:
+		JobCounter* mCounterPtr = nullptr;
 	};
 }
\ No newline at end of file
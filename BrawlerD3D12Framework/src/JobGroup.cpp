@@ -1,13 +1,14 @@
 module;
 #include <cstdint>
-#include <memory>
 #include <coroutine>
-#include <functional>
+#include <span>
+#include <source_location>
 
 module Brawler.JobGroup;
 import Brawler.JobPriority;
 import Brawler.JobCounter;
 import Brawler.WorkerThreadPool;
+import Brawler.JobTrace;
 
 namespace Brawler
 {
@@ -16,17 +17,18 @@ namespace Brawler
 
 namespace Brawler
 {
-	JobGroup::JobGroup(JobPriority priority, std::size_t initialReservedCount) :
-		mCounter(std::make_shared<JobCounter>()),
+	JobGroup::JobGroup(JobPriority priority, std::size_t initialReservedCount, const std::source_location srcLocation) :
+		mHCounter(JobCounterHandle::Create()),
 		mJobArr(),
-		mPriority(priority)
+		mPriority(priority),
+		mOriginName(srcLocation)
 	{
 		mJobArr.reserve(initialReservedCount);
 	}
 
-	void JobGroup::AddJob(std::move_only_function<void()>&& job)
+	void JobGroup::AddJobCallback(JobCallback&& job)
 	{
-		mJobArr.push_back(Job{ std::move(job), mCounter, mPriority });
+		mJobArr.push_back(Job{ std::move(job), mHCounter, mPriority });
 	}
 
 	void JobGroup::Reserve(std::size_t jobCount)
@@ -48,9 +50,10 @@ namespace Brawler
 		// Synchronous execution only happens when co_await is used. Thus, we can simply
 		// send the jobs to the queues without worry.
 
-		for (auto&& job : mJobArr)
-			Brawler::GetWorkerThreadPool().DispatchJob(std::move(job));
+		if constexpr (Util::JobTrace::IsJobTracingEnabled())
+			Util::JobTrace::RecordEvent(JobTraceEventType::JOB_GROUP_DISPATCHED, reinterpret_cast<std::uintptr_t>(mHCounter.Get()), mOriginName.Get());
 
+		Brawler::GetWorkerThreadPool().DispatchJobs(std::span<Job>{ mJobArr });
 		mJobArr.clear();
 	}
 
@@ -59,11 +62,12 @@ namespace Brawler
 		// Since this is for synchronous execution of jobs, we need to make sure that
 		// the counter is up-to-date *before* adding the jobs to the worker thread queues.
 
-		mCounter->SetCounterValue(static_cast<std::uint32_t>(mJobArr.size()));
+		mHCounter->SetCounterValue(static_cast<std::uint32_t>(mJobArr.size()));
 
-		for (auto&& job : mJobArr)
-			Brawler::GetWorkerThreadPool().DispatchJob(std::move(job));
+		if constexpr (Util::JobTrace::IsJobTracingEnabled())
+			Util::JobTrace::RecordEvent(JobTraceEventType::JOB_GROUP_DISPATCHED, reinterpret_cast<std::uintptr_t>(mHCounter.Get()), mOriginName.Get());
 
+		Brawler::GetWorkerThreadPool().DispatchJobs(std::span<Job>{ mJobArr });
 		mJobArr.clear();
 	}
 }
\ No newline at end of file
@@ -1,13 +1,56 @@
 module;
 #include <vector>
-#include <functional>
 #include <coroutine>
+#include <source_location>
+#include <concepts>
+#include <type_traits>
+#include <utility>
 
 export module Brawler.JobGroup;
 import Brawler.Job;
 import Brawler.JobRunner;
 import Brawler.JobPriority;
 import Brawler.JobCounter;
+import Brawler.JobCallback;
+import Brawler.JobTrace;
+
+namespace Brawler
+{
+	namespace IMPL
+	{
+		// JobGroups only need to remember where they were created if job tracing is enabled. If
+		// it is not, then this is an empty type, and JobGroup::mOriginName takes up no space.
+		template <bool IsJobTracingEnabled>
+		class JobGroupOriginName
+		{
+		public:
+			explicit JobGroupOriginName(const std::source_location& srcLocation) :
+				mFunctionName(srcLocation.function_name())
+			{}
+
+			const char* Get() const
+			{
+				return mFunctionName;
+			}
+
+		private:
+			const char* mFunctionName;
+		};
+
+		template <>
+		class JobGroupOriginName<false>
+		{
+		public:
+			explicit JobGroupOriginName(const std::source_location&)
+			{}
+
+			const char* Get() const
+			{
+				return nullptr;
+			}
+		};
+	}
+}
 
 export namespace Brawler
 {
@@ -17,11 +60,21 @@ export namespace Brawler
 		friend struct JobRunner;
 
 	public:
-		JobGroup(JobPriority priority = JobPriority::NORMAL, std::size_t initialReservedCount = 1);
+		// The source location is only used to name the jobs of this JobGroup in job traces.
+		// (See Util::JobTrace::FlushToChromeTraceFile().) If job tracing is disabled, then it
+		// is not stored at all.
+		JobGroup(JobPriority priority = JobPriority::NORMAL, std::size_t initialReservedCount = 1, const std::source_location srcLocation = std::source_location::current());
 
 		// Adds a job to the JobGroup. The job will not be executed until either
 		// JobGroup::ExecuteJobs() or JobGroup::ExecuteJobsAsync() is called.
-		void AddJob(std::move_only_function<void()>&& job);
+		//
+		// The callback must fit into the inline storage of a Brawler::JobCallback; that is, the
+		// captures of a lambda must not exceed 48 bytes. This ensures that adding a job never
+		// requires a heap allocation. If a call site fails to compile, then capture a pointer to
+		// a struct rather than its members.
+		template <typename Callback>
+			requires std::constructible_from<JobCallback, Callback>
+		void AddJob(Callback&& callback);
 
 		// Allocates memory for the specified number of jobs.
 		void Reserve(std::size_t jobCount);
@@ -37,11 +90,31 @@ export namespace Brawler
 		void ExecuteJobsAsync();
 
 	private:
+		void AddJobCallback(JobCallback&& job);
 		void DispatchJobs();
 
 	private:
-		std::shared_ptr<JobCounter> mCounter;
+		JobCounterHandle mHCounter;
 		std::vector<Job> mJobArr;
 		const JobPriority mPriority;
+
+		// MSVC ignores the standard [[no_unique_address]] attribute, so we need to use its own
+		// version of it.
+		[[msvc::no_unique_address]] IMPL::JobGroupOriginName<Util::JobTrace::IsJobTracingEnabled()> mOriginName;
 	};
+}
+
+// --------------------------------------------------------------------------------------------------
+
+namespace Brawler
+{
+	template <typename Callback>
+		requires std::constructible_from<JobCallback, Callback>
+	void JobGroup::AddJob(Callback&& callback)
+	{
+		using StoredCallback = std::decay_t<Callback>;
+		static_assert(std::same_as<StoredCallback, JobCallback> || InlineJobCallback<StoredCallback>, "ERROR: The captures of a callback passed to JobGroup::AddJob() are too large to be stored inline within a Brawler::JobCallback! Capture less (e.g., capture a pointer to a struct rather than its members).");
+
+		AddJobCallback(JobCallback{ std::forward<Callback>(callback) });
+	}
 }
\ No newline at end of file
@@ -1,6 +1,5 @@
 module;
 #include <stdexcept>
-#include <memory>
 #include <optional>
 #include <thread>
 
@@ -16,20 +15,20 @@ namespace Brawler
 {
 	bool JobRunner::Awaiter::await_ready() const
 	{
-		return (Counter != nullptr ? Counter->IsFinished() : true);
+		return (HCounter != nullptr ? HCounter->IsFinished() : true);
 	}
 
 	std::coroutine_handle<> JobRunner::Awaiter::await_suspend(std::coroutine_handle<> hCoroutine)
 	{
 		// At this point, the current thread will be waiting for the execution of all of the
 		// jobs within a JobGroup. We will not be transferring this std::coroutine_handle to
-		// a different thread, so we can safely access the Counter member of *this.
+		// a different thread, so we can safely access the HCounter member of *this.
 
 		// A naive implementation would simply wait for the relevant jobs to finish execution,
 		// but we can do better than that. Instead, we will try to steal jobs from worker
 		// threads.
 
-		while (!Counter->IsFinished())
+		while (!HCounter->IsFinished())
 			Util::Coroutine::TryExecuteJob();
 
 		// When we are finished, resume the coroutine, since the co_await may not be the
@@ -51,7 +50,7 @@ namespace Brawler
 		// on a JobGroup instance will still send jobs to the queues.
 		rhs.DispatchJobs();
 		
-		return Awaiter{ rhs.mCounter };
+		return Awaiter{ rhs.mHCounter };
 	}
 
 	std::suspend_never JobRunner::promise_type::initial_suspend() const
@@ -1,6 +1,5 @@
 module;
 #include <coroutine>
-#include <memory>
 
 export module Brawler.JobRunner;
 import Brawler.JobCounter;
@@ -16,7 +15,7 @@ export namespace Brawler
 	{
 		struct Awaiter
 		{
-			std::shared_ptr<JobCounter> Counter;
+			JobCounterHandle HCounter;
 
 			bool await_ready() const;
 			std::coroutine_handle<> await_suspend(std::coroutine_handle<> hCoroutine);
@@ -3,7 +3,10 @@ module;
 export module Brawler.JobSystem;
 
 export import Brawler.Job;
+export import Brawler.JobCallback;
 export import Brawler.JobGroup;
 export import Brawler.JobPriority;
 export import Brawler.JobRunner;
-export import Brawler.DelayedJobGroup;
\ No newline at end of file
+export import Brawler.DelayedJobGroup;
+export import Brawler.ParallelAlgorithms;
+export import Brawler.TaskGraph;
\ No newline at end of file
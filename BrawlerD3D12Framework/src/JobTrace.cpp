@@ -0,0 +1,357 @@
+module;
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <string_view>
+#include <string>
+#include <iterator>
+#include <iomanip>
+#include <intrin.h>
+
+module Brawler.JobTrace;
+import Util.Threading;
+import Brawler.ThreadLocalResources;
+
+namespace
+{
+	struct TraceEventSlot
+	{
+		// Every field is atomic so that FlushToChromeTraceFile() can read the slots while the
+		// owning thread is still writing to them. Relaxed atomic loads and stores compile to
+		// plain moves on x86/x64.
+		std::atomic<std::uint64_t> Timestamp;
+		std::atomic<std::uint64_t> Argument;
+		std::atomic<const char*> Name;
+		std::atomic<Brawler::JobTraceEventType> Type;
+	};
+
+	struct TraceEvent
+	{
+		std::uint64_t Timestamp;
+		std::uint64_t Argument;
+		const char* Name;
+		Brawler::JobTraceEventType Type;
+	};
+
+	struct ThreadTraceBuffer
+	{
+		std::uint32_t ThreadIndex;
+		std::unique_ptr<TraceEventSlot[]> SlotArr;
+
+		// This is the total number of events which were ever written to this buffer. It is only
+		// ever written to by the thread which owns the buffer.
+		std::atomic<std::uint64_t> WriteIndex;
+
+		// Every event with an index lower than this has already been flushed. This is only
+		// accessed while the mutex of the JobTraceRegistry is held.
+		std::uint64_t FlushedIndex;
+	};
+
+	struct JobTraceRegistry
+	{
+		std::mutex CritSection;
+
+		// The buffers are never destroyed, since a thread might still be recording events
+		// into its buffer while another thread is flushing.
+		std::vector<std::unique_ptr<ThreadTraceBuffer>> BufferArr;
+
+		// This holds the most recent JOB_GROUP_DISPATCHED event for each JobCounter address
+		// from previous flushes, since the jobs of a JobGroup might not begin until after
+		// its dispatch event was already flushed.
+		std::vector<TraceEvent> PreviousDispatchEventArr;
+
+		// These are used to convert the timestamps returned by __rdtsc() into microseconds.
+		std::uint64_t BaseTimestamp;
+		std::chrono::steady_clock::time_point BaseTime;
+
+		JobTraceRegistry() :
+			CritSection(),
+			BufferArr(),
+			PreviousDispatchEventArr(),
+			BaseTimestamp(__rdtsc()),
+			BaseTime(std::chrono::steady_clock::now())
+		{}
+	};
+
+	JobTraceRegistry& GetJobTraceRegistry()
+	{
+		static JobTraceRegistry traceRegistry{};
+		return traceRegistry;
+	}
+
+	ThreadTraceBuffer& RegisterCurrentThread()
+	{
+		std::unique_ptr<ThreadTraceBuffer> traceBufferPtr{ std::make_unique<ThreadTraceBuffer>() };
+		traceBufferPtr->ThreadIndex = Util::Threading::GetThreadLocalResources().GetThreadIndex();
+		traceBufferPtr->SlotArr = std::make_unique<TraceEventSlot[]>(Brawler::IMPL::JOB_TRACE_BUFFER_EVENT_COUNT);
+		traceBufferPtr->WriteIndex.store(0, std::memory_order::relaxed);
+		traceBufferPtr->FlushedIndex = 0;
+
+		ThreadTraceBuffer& traceBuffer{ *traceBufferPtr };
+
+		JobTraceRegistry& traceRegistry{ GetJobTraceRegistry() };
+		std::scoped_lock<std::mutex> lock{ traceRegistry.CritSection };
+
+		traceRegistry.BufferArr.push_back(std::move(traceBufferPtr));
+
+		return traceBuffer;
+	}
+
+	std::vector<TraceEvent> ExtractUnflushedEvents(ThreadTraceBuffer& traceBuffer)
+	{
+		static constexpr std::uint64_t BUFFER_EVENT_COUNT = Brawler::IMPL::JOB_TRACE_BUFFER_EVENT_COUNT;
+
+		const std::uint64_t writeIndex = traceBuffer.WriteIndex.load(std::memory_order::acquire);
+		const std::uint64_t beginIndex = std::max(traceBuffer.FlushedIndex, (writeIndex > BUFFER_EVENT_COUNT ? (writeIndex - BUFFER_EVENT_COUNT) : 0));
+
+		std::vector<TraceEvent> traceEventArr{};
+		traceEventArr.reserve(static_cast<std::size_t>(writeIndex - beginIndex));
+
+		for (std::uint64_t i = beginIndex; i < writeIndex; ++i)
+		{
+			const TraceEventSlot& currSlot{ traceBuffer.SlotArr[static_cast<std::size_t>(i % BUFFER_EVENT_COUNT)] };
+
+			traceEventArr.push_back(TraceEvent{
+				.Timestamp = currSlot.Timestamp.load(std::memory_order::relaxed),
+				.Argument = currSlot.Argument.load(std::memory_order::relaxed),
+				.Name = currSlot.Name.load(std::memory_order::relaxed),
+				.Type = currSlot.Type.load(std::memory_order::relaxed)
+			});
+		}
+
+		// The owning thread might have lapped us while we were reading. This works like a
+		// seqlock: if we read any data written for event index N, then this load sees a
+		// write index of at least N, and the slot for event index (N - BUFFER_EVENT_COUNT) can
+		// no longer be trusted. (See Util::JobTrace::RecordEvent() for the matching fence.)
+		std::atomic_thread_fence(std::memory_order::acquire);
+		const std::uint64_t latestWriteIndex = traceBuffer.WriteIndex.load(std::memory_order::relaxed);
+
+		const std::uint64_t firstValidIndex = (latestWriteIndex >= BUFFER_EVENT_COUNT ? (latestWriteIndex - BUFFER_EVENT_COUNT + 1) : 0);
+
+		if (firstValidIndex > beginIndex) [[unlikely]]
+			traceEventArr.erase(traceEventArr.begin(), traceEventArr.begin() + static_cast<std::ptrdiff_t>(std::min(firstValidIndex - beginIndex, static_cast<std::uint64_t>(traceEventArr.size()))));
+
+		traceBuffer.FlushedIndex = writeIndex;
+
+		return traceEventArr;
+	}
+
+	void WriteJSONString(std::ofstream& traceFileStream, const std::string_view str)
+	{
+		traceFileStream << '"';
+
+		for (const char c : str)
+		{
+			if (c == '"' || c == '\\')
+				traceFileStream << '\\';
+
+			traceFileStream << c;
+		}
+
+		traceFileStream << '"';
+	}
+}
+
+namespace Util
+{
+	namespace JobTrace
+	{
+		void RecordEvent(const Brawler::JobTraceEventType type, const std::uint64_t argument, const char* const name)
+		{
+			thread_local ThreadTraceBuffer& traceBuffer{ RegisterCurrentThread() };
+
+			const std::uint64_t writeIndex = traceBuffer.WriteIndex.load(std::memory_order::relaxed);
+			TraceEventSlot& currSlot{ traceBuffer.SlotArr[static_cast<std::size_t>(writeIndex % Brawler::IMPL::JOB_TRACE_BUFFER_EVENT_COUNT)] };
+
+			// This fence makes sure that a flushing thread which reads any of the stores below
+			// also sees the write index which we published before them. (See ExtractUnflushedEvents().)
+			std::atomic_thread_fence(std::memory_order::release);
+
+			currSlot.Timestamp.store(__rdtsc(), std::memory_order::relaxed);
+			currSlot.Argument.store(argument, std::memory_order::relaxed);
+			currSlot.Name.store(name, std::memory_order::relaxed);
+			currSlot.Type.store(type, std::memory_order::relaxed);
+
+			traceBuffer.WriteIndex.store(writeIndex + 1, std::memory_order::release);
+		}
+
+		void FlushToChromeTraceFile(const std::filesystem::path& traceFilePath)
+		{
+			JobTraceRegistry& traceRegistry{ GetJobTraceRegistry() };
+			std::scoped_lock<std::mutex> lock{ traceRegistry.CritSection };
+
+			struct ThreadTraceEvents
+			{
+				std::uint32_t ThreadIndex;
+				std::vector<TraceEvent> TraceEventArr;
+			};
+
+			std::vector<ThreadTraceEvents> threadEventsArr{};
+			threadEventsArr.reserve(traceRegistry.BufferArr.size());
+
+			for (const auto& traceBufferPtr : traceRegistry.BufferArr)
+			{
+				threadEventsArr.push_back(ThreadTraceEvents{
+					.ThreadIndex = traceBufferPtr->ThreadIndex,
+					.TraceEventArr{ ExtractUnflushedEvents(*traceBufferPtr) }
+				});
+			}
+
+			// Calibrate the timestamp counter against std::chrono::steady_clock. The TSC runs at
+			// a constant rate on every CPU we care about, so measuring it over the entire lifetime
+			// of the trace is accurate enough.
+			const std::uint64_t currTimestamp = __rdtsc();
+			const std::chrono::steady_clock::time_point currTime = std::chrono::steady_clock::now();
+
+			const double elapsedMicroseconds = std::chrono::duration<double, std::micro>{ currTime - traceRegistry.BaseTime }.count();
+			const double ticksPerMicrosecond = (elapsedMicroseconds > 0.0 ? (static_cast<double>(currTimestamp - traceRegistry.BaseTimestamp) / elapsedMicroseconds) : 1.0);
+
+			const auto convertTimestamp = [&traceRegistry, ticksPerMicrosecond] (const std::uint64_t timestamp)
+			{
+				return (static_cast<double>(static_cast<std::int64_t>(timestamp - traceRegistry.BaseTimestamp)) / ticksPerMicrosecond);
+			};
+
+			// Jobs only know the address of their JobCounter. To find out which JobGroup a job came
+			// from, we look for the most recent JOB_GROUP_DISPATCHED event with the same JobCounter
+			// address. (JobCounters are pooled, so the same address is re-used by many JobGroups.)
+			std::vector<TraceEvent> dispatchEventArr{ std::move(traceRegistry.PreviousDispatchEventArr) };
+
+			for (const auto& threadEvents : threadEventsArr)
+				std::ranges::copy_if(threadEvents.TraceEventArr, std::back_inserter(dispatchEventArr), [] (const TraceEvent& traceEvent) { return (traceEvent.Type == Brawler::JobTraceEventType::JOB_GROUP_DISPATCHED); });
+
+			std::ranges::sort(dispatchEventArr, [] (const TraceEvent& lhs, const TraceEvent& rhs)
+			{
+				return (lhs.Argument < rhs.Argument || (lhs.Argument == rhs.Argument && lhs.Timestamp < rhs.Timestamp));
+			});
+
+			// Keep only the most recent dispatch event for each JobCounter address around for
+			// the next flush.
+			for (std::size_t i = 0; i < dispatchEventArr.size(); ++i)
+			{
+				if (i + 1 == dispatchEventArr.size() || dispatchEventArr[i + 1].Argument != dispatchEventArr[i].Argument)
+					traceRegistry.PreviousDispatchEventArr.push_back(dispatchEventArr[i]);
+			}
+
+			const auto findJobOrigin = [&dispatchEventArr] (const TraceEvent& jobBeginEvent) -> const char*
+			{
+				if (jobBeginEvent.Argument == 0)
+					return nullptr;
+
+				// Find the first dispatch event which is either for a different JobCounter or
+				// happened after the job began. The event before it, if any, is the origin.
+				const auto itr = std::ranges::upper_bound(dispatchEventArr, jobBeginEvent, [] (const TraceEvent& lhs, const TraceEvent& rhs)
+				{
+					return (lhs.Argument < rhs.Argument || (lhs.Argument == rhs.Argument && lhs.Timestamp < rhs.Timestamp));
+				});
+
+				if (itr == dispatchEventArr.begin() || std::prev(itr)->Argument != jobBeginEvent.Argument)
+					return nullptr;
+
+				return std::prev(itr)->Name;
+			};
+
+			std::ofstream traceFileStream{ traceFilePath, std::ios::out | std::ios::trunc };
+			traceFileStream << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+
+			bool isFirstEvent = true;
+
+			const auto beginEvent = [&traceFileStream, &isFirstEvent] (const std::string_view eventName, const std::string_view phase, const std::uint32_t threadIndex)
+			{
+				if (!isFirstEvent)
+					traceFileStream << ",\n";
+
+				isFirstEvent = false;
+
+				traceFileStream << "{\"name\":";
+				WriteJSONString(traceFileStream, eventName);
+				traceFileStream << ",\"ph\":\"" << phase << "\",\"pid\":0,\"tid\":" << threadIndex;
+			};
+
+			for (const auto& threadEvents : threadEventsArr)
+			{
+				beginEvent("thread_name", "M", threadEvents.ThreadIndex);
+				traceFileStream << ",\"args\":{\"name\":\"" << (threadEvents.ThreadIndex == 0 ? "Main Thread" : "Worker Thread ") << (threadEvents.ThreadIndex == 0 ? "" : std::to_string(threadEvents.ThreadIndex)) << "\"}}";
+
+				for (const auto& traceEvent : threadEvents.TraceEventArr)
+				{
+					const double timestamp = convertTimestamp(traceEvent.Timestamp);
+
+					switch (traceEvent.Type)
+					{
+					case Brawler::JobTraceEventType::JOB_BEGIN:
+					{
+						const char* const originName = findJobOrigin(traceEvent);
+
+						beginEvent((originName != nullptr ? originName : "Job"), "B", threadEvents.ThreadIndex);
+						traceFileStream << ",\"cat\":\"job\",\"ts\":" << timestamp << '}';
+
+						break;
+					}
+
+					case Brawler::JobTraceEventType::JOB_END:
+					{
+						beginEvent("Job", "E", threadEvents.ThreadIndex);
+						traceFileStream << ",\"cat\":\"job\",\"ts\":" << timestamp << '}';
+
+						break;
+					}
+
+					case Brawler::JobTraceEventType::JOB_STOLEN:
+					{
+						beginEvent("Steal", "i", threadEvents.ThreadIndex);
+						traceFileStream << ",\"cat\":\"scheduler\",\"s\":\"t\",\"ts\":" << timestamp << ",\"args\":{\"victim\":" << traceEvent.Argument << "}}";
+
+						break;
+					}
+
+					case Brawler::JobTraceEventType::THREAD_PARKED:
+					{
+						beginEvent("Parked", "B", threadEvents.ThreadIndex);
+						traceFileStream << ",\"cat\":\"scheduler\",\"ts\":" << timestamp << '}';
+
+						break;
+					}
+
+					case Brawler::JobTraceEventType::THREAD_UNPARKED:
+					{
+						beginEvent("Parked", "E", threadEvents.ThreadIndex);
+						traceFileStream << ",\"cat\":\"scheduler\",\"ts\":" << timestamp << '}';
+
+						break;
+					}
+
+					case Brawler::JobTraceEventType::QUEUE_DEPTH:
+					{
+						// Counter events are grouped by name, so every thread needs its own name.
+						beginEvent("Local Job Deque Depth (Thread " + std::to_string(threadEvents.ThreadIndex) + ")", "C", threadEvents.ThreadIndex);
+						traceFileStream << ",\"ts\":" << timestamp << ",\"args\":{\"depth\":" << traceEvent.Argument << "}}";
+
+						break;
+					}
+
+					case Brawler::JobTraceEventType::JOB_GROUP_DISPATCHED:
+					{
+						beginEvent("Dispatch", "i", threadEvents.ThreadIndex);
+						traceFileStream << ",\"cat\":\"scheduler\",\"s\":\"t\",\"ts\":" << timestamp << ",\"args\":{\"origin\":";
+						WriteJSONString(traceFileStream, (traceEvent.Name != nullptr ? traceEvent.Name : ""));
+						traceFileStream << "}}";
+
+						break;
+					}
+
+					default:
+						break;
+					}
+				}
+			}
+
+			traceFileStream << "\n]}\n";
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+module;
+#include <cstdint>
+#include <filesystem>
+
+export module Brawler.JobTrace;
+
+namespace Brawler
+{
+	namespace IMPL
+	{
+		// Set this to true to have the job system record its events. If this is false, then
+		// every call to Util::JobTrace::RecordEvent() is compiled out, since each call site is
+		// guarded by if constexpr (Util::JobTrace::IsJobTracingEnabled()).
+		static constexpr bool ENABLE_JOB_TRACING = false;
+
+		// This is the number of events which each thread's ring buffer can hold. Once a buffer
+		// is full, the oldest events are overwritten. Each event takes up 32 bytes.
+		static constexpr std::size_t JOB_TRACE_BUFFER_EVENT_COUNT = 32768;
+	}
+}
+
+export namespace Brawler
+{
+	enum class JobTraceEventType : std::uint8_t
+	{
+		/// <summary>
+		/// A thread began executing a job. The argument is the address of the job's
+		/// JobCounter, or 0 if it has none.
+		/// </summary>
+		JOB_BEGIN,
+
+		/// <summary>
+		/// A thread finished executing a job. The argument is the same as that of the
+		/// corresponding JOB_BEGIN event.
+		/// </summary>
+		JOB_END,
+
+		/// <summary>
+		/// A thread stole a job from the local deque of another thread. The argument is the
+		/// thread index of the victim.
+		/// </summary>
+		JOB_STOLEN,
+
+		/// <summary>
+		/// A thread was parked in the ThreadParkingLot. The argument is unused.
+		/// </summary>
+		THREAD_PARKED,
+
+		/// <summary>
+		/// A parked thread was woken up. The argument is unused.
+		/// </summary>
+		THREAD_UNPARKED,
+
+		/// <summary>
+		/// Jobs were pushed into a thread's local deque. The argument is the number of jobs in
+		/// that deque afterwards.
+		/// </summary>
+		QUEUE_DEPTH,
+
+		/// <summary>
+		/// The jobs of a JobGroup were dispatched. The argument is the address of the JobGroup's
+		/// JobCounter, and the name is the function which created the JobGroup. This is how
+		/// JOB_BEGIN events are traced back to their origin.
+		/// </summary>
+		JOB_GROUP_DISPATCHED,
+
+		COUNT
+	};
+}
+
+export namespace Util
+{
+	namespace JobTrace
+	{
+		consteval bool IsJobTracingEnabled()
+		{
+			return Brawler::IMPL::ENABLE_JOB_TRACING;
+		}
+
+		/// <summary>
+		/// Records an event in the calling thread's trace buffer. This only takes a timestamp
+		/// and a few relaxed atomic stores, but it should still only ever be called within an
+		/// if constexpr (Util::JobTrace::IsJobTracingEnabled()) block, so that it costs nothing
+		/// when tracing is disabled.
+		/// </summary>
+		/// <param name="type">
+		/// - The type of the event.
+		/// </param>
+		/// <param name="argument">
+		/// - The argument of the event. Its meaning depends on type. (See Brawler::JobTraceEventType.)
+		/// </param>
+		/// <param name="name">
+		/// - An optional name for the event. This must point to a string with static storage
+		///   duration, such as a string literal or the value returned by
+		///   std::source_location::function_name().
+		/// </param>
+		void RecordEvent(const Brawler::JobTraceEventType type, const std::uint64_t argument = 0, const char* const name = nullptr);
+
+		/// <summary>
+		/// Writes every event which was recorded since the last call to this function to the
+		/// specified file in the Chrome trace event JSON format. The file can be opened with
+		/// chrome://tracing or https://ui.perfetto.dev. Afterwards, these events are discarded.
+		///
+		/// This can be called while other threads are still recording events. Events which
+		/// are overwritten while the function is reading them are skipped.
+		/// </summary>
+		/// <param name="traceFilePath">
+		/// - The path of the JSON file which is to be written. If the file already exists,
+		///   then it is overwritten.
+		/// </param>
+		void FlushToChromeTraceFile(const std::filesystem::path& traceFilePath);
+	}
+}
\ No newline at end of file
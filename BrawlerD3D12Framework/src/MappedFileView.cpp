@@ -1,10 +1,33 @@
 module;
+#include <cstdint>
+#include <cassert>
+#include <span>
+#include <memory>
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
 #include "DxDef.h"
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 
 module Brawler.MappedFileView;
+import Brawler.FileAccessMode;
+import Brawler.MappedFileViewHint;
+import Brawler.CompositeEnum;
+import Util.General;
+
+#ifdef _WIN32
+import Brawler.Win32.SafeHandle;
+#endif
 
 namespace
 {
+#ifdef _WIN32
 	// I initially tried defining this directly in MappedFileView.ixx, but that was causing the
 	// value to always be initialized to zero. So, we put it here as a work-around.
 	static const std::uint32_t allocationGranularity = [] ()
@@ -14,10 +37,273 @@ namespace
 
 		return sysInfo.dwAllocationGranularity;
 	}();
+
+	using MappedAddress_T = LPVOID;
+
+	struct MappedAddressDeleter
+	{
+		void operator()(MappedAddress_T mappedAddress) const
+		{
+			if (mappedAddress != nullptr)
+			{
+				const bool unmapResult = UnmapViewOfFileEx(mappedAddress, 0);
+				assert(unmapResult && "ERROR: UnmapViewOfFileEx() failed to unmap an address!");
+			}
+		}
+	};
+
+	using SafeAddressMapping = std::unique_ptr<std::remove_pointer_t<MappedAddress_T>, MappedAddressDeleter>;
+
+	void PrefetchMappedData(const std::span<std::byte> mappedDataSpan)
+	{
+		WIN32_MEMORY_RANGE_ENTRY prefetchRange{
+			.VirtualAddress = mappedDataSpan.data(),
+			.NumberOfBytes = mappedDataSpan.size_bytes()
+		};
+
+		// PrefetchVirtualMemory() is only a hint, so if it fails, then the pages will simply be
+		// read in when they are first accessed, just as if we had never called it.
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &prefetchRange, 0);
+	}
+#else
+	static const std::uint32_t allocationGranularity = static_cast<std::uint32_t>(sysconf(_SC_PAGESIZE));
+
+	void CheckErrno()
+	{
+		Util::General::CheckErrorCode(std::error_code{ errno, std::system_category() });
+	}
+
+	void AdviseMappedData(const std::span<std::byte> mappedDataSpan, const std::int32_t advice)
+	{
+		if (mappedDataSpan.empty()) [[unlikely]]
+			return;
+
+		// madvise() requires a page-aligned address, but sub-views can begin anywhere within
+		// a page.
+		const std::uintptr_t dataStartAddress = reinterpret_cast<std::uintptr_t>(mappedDataSpan.data());
+		const std::uintptr_t alignedStartAddress = (dataStartAddress - (dataStartAddress % allocationGranularity));
+
+		// Like PrefetchVirtualMemory() on Windows, madvise() is only a hint, so we do not
+		// care if it fails.
+		madvise(reinterpret_cast<void*>(alignedStartAddress), (mappedDataSpan.size_bytes() + (dataStartAddress - alignedStartAddress)), advice);
+	}
+#endif
 }
 
 namespace Brawler
 {
+	namespace IMPL
+	{
+#ifdef _WIN32
+		class MappedFileRegion
+		{
+		public:
+			MappedFileRegion(Win32::SafeHandle&& hFileMappingObject, SafeAddressMapping&& mapping, const std::size_t regionSizeInBytes) :
+				mHFileMappingObject(std::move(hFileMappingObject)),
+				mMapping(std::move(mapping)),
+				mRegionSizeInBytes(regionSizeInBytes)
+			{}
+
+			MappedFileRegion(const MappedFileRegion& rhs) = delete;
+			MappedFileRegion& operator=(const MappedFileRegion& rhs) = delete;
+
+			MappedFileRegion(MappedFileRegion&& rhs) noexcept = delete;
+			MappedFileRegion& operator=(MappedFileRegion&& rhs) noexcept = delete;
+
+			std::span<std::byte> GetMappedData() const
+			{
+				return std::span<std::byte>{ reinterpret_cast<std::byte*>(mMapping.get()), mRegionSizeInBytes };
+			}
+
+		private:
+			Win32::SafeHandle mHFileMappingObject;
+			SafeAddressMapping mMapping;
+			std::size_t mRegionSizeInBytes;
+		};
+
+		std::shared_ptr<MappedFileRegion> CreateMappedFileRegion(const std::filesystem::path& filePath, const FileAccessMode accessMode, const std::uint64_t alignedFileOffsetInBytes, const std::uint64_t regionSizeInBytes, const Brawler::CompositeEnum<MappedFileViewHint> hints)
+		{
+			const std::uint32_t fileAccess = (accessMode == FileAccessMode::READ_ONLY ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE);
+			const std::uint32_t fileFlags = (hints.ContainsAnyFlag(MappedFileViewHint::SEQUENTIAL_ACCESS) ? (FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN) : FILE_ATTRIBUTE_NORMAL);
+
+			Win32::SafeHandle hFile{ CreateFile(
+				filePath.c_str(),
+				fileAccess,
+
+				// Allow only reading for now. According to the MSDN, this prevents other accesses
+				// until the HANDLE to the created file is destroyed. This will happen once we exit
+				// this function. In theory, then, we should still be able to open HANDLEs with
+				// write access after leaving this function.
+				FILE_SHARE_READ,
+
+				nullptr,
+
+				// Only allow opening existing files, regardless of what AccessMode is set to. If
+				// the user wants to create a new file, they can call the constructor of
+				// std::ofstream with the ios flag std::ios::out; this will destroy the contents
+				// of the original file and create a new one if it does not already exist. For
+				// more information, refer to https://en.cppreference.com/w/cpp/io/basic_filebuf/open.
+				OPEN_EXISTING,
+
+				fileFlags,
+
+				nullptr
+			) };
+
+			if (hFile.get() == INVALID_HANDLE_VALUE) [[unlikely]]
+				Util::General::CheckHRESULT(HRESULT_FROM_WIN32(GetLastError()));
+
+			if constexpr (Util::General::IsDebugModeEnabled())
+			{
+				// According to the MSDN, file mapping fails if the size of the file is 0.
+				std::error_code errorCode{};
+
+				const std::size_t fileSize = std::filesystem::file_size(filePath, errorCode);
+				Util::General::CheckErrorCode(errorCode);
+
+				assert(fileSize != 0 && "ERROR: File mappings cannot be created if the size of the file is 0 bytes! (To efficiently change the size of a file, use std::filesystem::resize_file().)");
+			}
+
+			Win32::SafeHandle hFileMappingObject{ CreateFileMapping(
+				hFile.get(),
+				nullptr,
+				(accessMode == FileAccessMode::READ_ONLY ? PAGE_READONLY : PAGE_READWRITE),
+				0,
+				0,
+				nullptr
+			) };
+
+			if (hFileMappingObject == nullptr) [[unlikely]]
+				Util::General::CheckHRESULT(HRESULT_FROM_WIN32(GetLastError()));
+
+			SafeAddressMapping mapping{ MapViewOfFileEx(
+				hFileMappingObject.get(),
+				(accessMode == FileAccessMode::READ_ONLY ? FILE_MAP_READ : FILE_MAP_WRITE),
+				static_cast<std::uint32_t>(alignedFileOffsetInBytes >> 32),
+				static_cast<std::uint32_t>(alignedFileOffsetInBytes & 0xFFFFFFFF),
+				regionSizeInBytes,
+				nullptr
+			) };
+
+			if (mapping == nullptr) [[unlikely]]
+				Util::General::CheckHRESULT(HRESULT_FROM_WIN32(GetLastError()));
+
+			std::shared_ptr<MappedFileRegion> mappedRegionPtr{ std::make_shared<MappedFileRegion>(std::move(hFileMappingObject), std::move(mapping), regionSizeInBytes) };
+
+			// Windows has no equivalent to MAP_POPULATE, so POPULATE is treated like PREFETCH.
+			if (hints.ContainsAnyFlag(MappedFileViewHint::PREFETCH | MappedFileViewHint::POPULATE))
+				PrefetchMappedData(mappedRegionPtr->GetMappedData());
+
+			return mappedRegionPtr;
+		}
+
+		void ApplyMappedFileViewHints(const std::span<std::byte> mappedDataSpan, const Brawler::CompositeEnum<MappedFileViewHint> hints)
+		{
+			// FILE_FLAG_SEQUENTIAL_SCAN can only be specified when a file is opened, so
+			// MappedFileViewHint::SEQUENTIAL_ACCESS has no effect on an existing mapping.
+			if (hints.ContainsAnyFlag(MappedFileViewHint::PREFETCH | MappedFileViewHint::POPULATE))
+				PrefetchMappedData(mappedDataSpan);
+		}
+#else
+		class MappedFileRegion
+		{
+		public:
+			MappedFileRegion(void* const mappedAddress, const std::size_t regionSizeInBytes) :
+				mMappedAddress(mappedAddress),
+				mRegionSizeInBytes(regionSizeInBytes)
+			{}
+
+			~MappedFileRegion()
+			{
+				if (mMappedAddress != MAP_FAILED)
+				{
+					[[maybe_unused]] const std::int32_t unmapResult = munmap(mMappedAddress, mRegionSizeInBytes);
+					assert(unmapResult == 0 && "ERROR: munmap() failed to unmap an address!");
+				}
+			}
+
+			MappedFileRegion(const MappedFileRegion& rhs) = delete;
+			MappedFileRegion& operator=(const MappedFileRegion& rhs) = delete;
+
+			MappedFileRegion(MappedFileRegion&& rhs) noexcept = delete;
+			MappedFileRegion& operator=(MappedFileRegion&& rhs) noexcept = delete;
+
+			std::span<std::byte> GetMappedData() const
+			{
+				return std::span<std::byte>{ reinterpret_cast<std::byte*>(mMappedAddress), mRegionSizeInBytes };
+			}
+
+		private:
+			void* mMappedAddress;
+			std::size_t mRegionSizeInBytes;
+		};
+
+		std::shared_ptr<MappedFileRegion> CreateMappedFileRegion(const std::filesystem::path& filePath, const FileAccessMode accessMode, const std::uint64_t alignedFileOffsetInBytes, const std::uint64_t regionSizeInBytes, const Brawler::CompositeEnum<MappedFileViewHint> hints)
+		{
+			assert(regionSizeInBytes != 0 && "ERROR: A MappedFileView cannot be created for 0 bytes of a file!");
+
+			// Just like on Windows, we only ever open existing files.
+			const std::int32_t fileDescriptor = open(filePath.c_str(), ((accessMode == FileAccessMode::READ_ONLY ? O_RDONLY : O_RDWR) | O_CLOEXEC));
+
+			if (fileDescriptor == -1) [[unlikely]]
+				CheckErrno();
+
+			std::int32_t mapFlags = MAP_SHARED;
+			CompositeEnum<MappedFileViewHint> remainingHints{ hints };
+
+#ifdef MAP_POPULATE
+			// MAP_POPULATE reads every page before mmap() returns, so MADV_WILLNEED would be
+			// redundant afterwards.
+			if (hints.ContainsAnyFlag(MappedFileViewHint::POPULATE))
+			{
+				mapFlags |= MAP_POPULATE;
+				remainingHints &= ~CompositeEnum<MappedFileViewHint>{ MappedFileViewHint::POPULATE | MappedFileViewHint::PREFETCH };
+			}
+#endif
+
+			void* const mappedAddress = mmap(
+				nullptr,
+				regionSizeInBytes,
+				(accessMode == FileAccessMode::READ_ONLY ? PROT_READ : (PROT_READ | PROT_WRITE)),
+				mapFlags,
+				fileDescriptor,
+				static_cast<off_t>(alignedFileOffsetInBytes)
+			);
+
+			// The mapping keeps its own reference to the file, so we can close the file
+			// descriptor right away. We need to save errno first, though, since close() might
+			// overwrite it.
+			const std::int32_t mapErrorValue = errno;
+			close(fileDescriptor);
+
+			if (mappedAddress == MAP_FAILED) [[unlikely]]
+				Util::General::CheckErrorCode(std::error_code{ mapErrorValue, std::system_category() });
+
+			std::shared_ptr<MappedFileRegion> mappedRegionPtr{ std::make_shared<MappedFileRegion>(mappedAddress, regionSizeInBytes) };
+
+			ApplyMappedFileViewHints(mappedRegionPtr->GetMappedData(), remainingHints);
+
+			return mappedRegionPtr;
+		}
+
+		void ApplyMappedFileViewHints(const std::span<std::byte> mappedDataSpan, const Brawler::CompositeEnum<MappedFileViewHint> hints)
+		{
+			if (hints.ContainsAnyFlag(MappedFileViewHint::SEQUENTIAL_ACCESS))
+				AdviseMappedData(mappedDataSpan, MADV_SEQUENTIAL);
+
+			// An existing mapping cannot be populated after the fact, so POPULATE is treated
+			// like PREFETCH here.
+			if (hints.ContainsAnyFlag(MappedFileViewHint::PREFETCH | MappedFileViewHint::POPULATE))
+				AdviseMappedData(mappedDataSpan, MADV_WILLNEED);
+		}
+#endif
+
+		std::span<std::byte> GetMappedFileRegionData(const MappedFileRegion& mappedRegion)
+		{
+			return mappedRegion.GetMappedData();
+		}
+	}
+
 	std::uint32_t GetAllocationGranularity()
 	{
 		return allocationGranularity;
@@ -3,34 +3,30 @@ module;
 #include <filesystem>
 #include <memory>
 #include <cassert>
-#include "DxDef.h"
 
 export module Brawler.MappedFileView;
 import Brawler.FileAccessMode;
-import Brawler.Win32.SafeHandle;
-import Util.General;
-import Util.Win32;
+import Brawler.MappedFileViewHint;
+import Brawler.CompositeEnum;
 
 namespace Brawler
 {
-	using MappedAddress_T = LPVOID;
+	template <FileAccessMode AccessMode>
+	concept IsValidAccessMode = (AccessMode != FileAccessMode::COUNT_OR_ERROR);
 
-	struct MappedAddressDeleter
+	namespace IMPL
 	{
-		void operator()(MappedAddress_T mappedAddress) const
-		{
-			if (mappedAddress != nullptr)
-			{
-				const bool unmapResult = UnmapViewOfFileEx(mappedAddress, 0);
-				assert(unmapResult && "ERROR: UnmapViewOfFileEx() failed to unmap an address!");
-			}
-		}
-	};
+		// A MappedFileRegion is a single mapping of (part of) a file into the address space of the
+		// process. It is defined separately for every platform in MappedFileView.cpp. MappedFileView
+		// instances created with MappedFileView::CreateSubView() share the MappedFileRegion of the
+		// view which they were created from, and it is unmapped once the last of them is destroyed.
+		class MappedFileRegion;
 
-	using SafeAddressMapping = std::unique_ptr<std::remove_pointer_t<MappedAddress_T>, MappedAddressDeleter>;
+		std::shared_ptr<MappedFileRegion> CreateMappedFileRegion(const std::filesystem::path& filePath, const FileAccessMode accessMode, const std::uint64_t alignedFileOffsetInBytes, const std::uint64_t regionSizeInBytes, const Brawler::CompositeEnum<MappedFileViewHint> hints);
+		std::span<std::byte> GetMappedFileRegionData(const MappedFileRegion& mappedRegion);
 
-	template <FileAccessMode AccessMode>
-	concept IsValidAccessMode = (AccessMode != FileAccessMode::COUNT_OR_ERROR);
+		void ApplyMappedFileViewHints(const std::span<std::byte> mappedDataSpan, const Brawler::CompositeEnum<MappedFileViewHint> hints);
+	}
 }
 
 export namespace Brawler
@@ -44,6 +40,12 @@ export namespace Brawler
 		{
 			std::uint64_t FileOffsetInBytes;
 			std::uint64_t ViewSizeInBytes;
+
+			/// <summary>
+			/// We expect memory-mapped I/O access to be largely sequential, so this is the
+			/// default. (See Brawler::MappedFileViewHint.)
+			/// </summary>
+			Brawler::CompositeEnum<MappedFileViewHint> Hints{ MappedFileViewHint::SEQUENTIAL_ACCESS };
 		};
 
 	public:
@@ -59,23 +61,45 @@ export namespace Brawler
 		std::span<std::byte> GetMappedData() requires (AccessMode == FileAccessMode::READ_WRITE);
 		std::span<const std::byte> GetMappedData() const;
 
-		bool IsValidView() const;
+		/// <summary>
+		/// Creates a MappedFileView for a part of this view without mapping the file again.
+		/// Both views share the same mapping, so it stays valid for as long as either of them
+		/// exists. This makes creating a sub-view considerably cheaper than creating a new
+		/// MappedFileView.
+		/// </summary>
+		/// <param name="offsetFromViewStartInBytes">
+		/// - The offset, in bytes, from the start of this view to the start of the sub-view.
+		/// </param>
+		/// <param name="subViewSizeInBytes">
+		/// - The size, in bytes, of the sub-view. The sub-view must lie entirely within this
+		///   view.
+		/// </param>
+		/// <param name="hints">
+		/// - The hints which are to be applied to the pages of the sub-view. Since the mapping
+		///   already exists, MappedFileViewHint::POPULATE is treated like MappedFileViewHint::PREFETCH.
+		/// </param>
+		/// <returns>
+		/// The function returns a MappedFileView which refers to the specified part of this
+		/// view.
+		/// </returns>
+		MappedFileView CreateSubView(const std::uint64_t offsetFromViewStartInBytes, const std::uint64_t subViewSizeInBytes, const Brawler::CompositeEnum<MappedFileViewHint> hints = Brawler::CompositeEnum<MappedFileViewHint>{}) const;
 
-	private:
-		void CreateFileMappingObject(const std::filesystem::path& filePath, const ViewParams& params);
-		void MapFileView(const ViewParams& params);
+		bool IsValidView() const;
 
 	private:
-		Win32::SafeHandle mHFileMappingObject;
-		SafeAddressMapping mMapping;
+		std::shared_ptr<IMPL::MappedFileRegion> mMappedRegionPtr;
 		std::span<std::byte> mMappedSpan;
 	};
 }
 
 // ----------------------------------------------------------------------------------------------------------------
 
-namespace Brawler
+export namespace Brawler
 {
+	/// <summary>
+	/// Gets the granularity to which the file offset of a mapping must be aligned. This is the
+	/// allocation granularity on Windows (usually 64 KB) and the page size on POSIX systems.
+	/// </summary>
 	std::uint32_t GetAllocationGranularity();
 }
 
@@ -84,12 +108,23 @@ namespace Brawler
 	template <FileAccessMode AccessMode>
 		requires IsValidAccessMode<AccessMode>
 	MappedFileView<AccessMode>::MappedFileView(const std::filesystem::path& filePath, const ViewParams& params) :
-		mHFileMappingObject(nullptr),
-		mMapping(nullptr),
+		mMappedRegionPtr(nullptr),
 		mMappedSpan()
 	{
-		CreateFileMappingObject(filePath, params);
-		MapFileView(params);
+		// We want the returned std::span to reflect the user's desired view of the file. However,
+		// both the Win32 API and mmap() require that our offset be a multiple of the allocation
+		// granularity. Therefore, we need to offset our start address by moving it backwards. To
+		// make sure that we are reading all of the data, however, we also need to increase the size
+		// of the mapped view.
+		const std::size_t fileOffsetDelta = (params.FileOffsetInBytes % GetAllocationGranularity());
+
+		const std::size_t adjustedFileOffset = (params.FileOffsetInBytes - fileOffsetDelta);
+		const std::size_t numBytesToView = (params.ViewSizeInBytes + fileOffsetDelta);
+
+		mMappedRegionPtr = IMPL::CreateMappedFileRegion(filePath, AccessMode, adjustedFileOffset, numBytesToView, params.Hints);
+
+		// Adjust the mapped std::span to be equivalent to the user's desired view.
+		mMappedSpan = IMPL::GetMappedFileRegionData(*mMappedRegionPtr).subspan(fileOffsetDelta, params.ViewSizeInBytes);
 	}
 
 	template <FileAccessMode AccessMode>
@@ -108,102 +143,24 @@ namespace Brawler
 
 	template <FileAccessMode AccessMode>
 		requires IsValidAccessMode<AccessMode>
-	bool MappedFileView<AccessMode>::IsValidView() const
-	{
-		return (Util::Win32::IsHandleValid(mHFileMappingObject) && mMapping != nullptr);
-	}
-
-	template <FileAccessMode AccessMode>
-		requires IsValidAccessMode<AccessMode>
-	void MappedFileView<AccessMode>::CreateFileMappingObject(const std::filesystem::path& filePath, const ViewParams& params)
+	MappedFileView<AccessMode> MappedFileView<AccessMode>::CreateSubView(const std::uint64_t offsetFromViewStartInBytes, const std::uint64_t subViewSizeInBytes, const Brawler::CompositeEnum<MappedFileViewHint> hints) const
 	{
-		static constexpr std::uint32_t DW_DESIRED_ACCESS = (AccessMode == FileAccessMode::READ_ONLY ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE);
-		
-		Win32::SafeHandle hFile{ CreateFile(
-			filePath.c_str(),
-			DW_DESIRED_ACCESS,
-
-			// Allow only reading for now. According to the MSDN, this prevents other accesses
-			// until the HANDLE to the created file is destroyed. This will happen once we exit
-			// this function. In theory, then, we should still be able to open HANDLEs with
-			// write access after leaving this function.
-			FILE_SHARE_READ,
+		assert(IsValidView() && "ERROR: An attempt was made to create a sub-view of an invalid MappedFileView!");
+		assert((offsetFromViewStartInBytes + subViewSizeInBytes) <= mMappedSpan.size_bytes() && "ERROR: An attempt was made to create a sub-view which does not lie entirely within its MappedFileView!");
 
-			nullptr,
+		MappedFileView subView{};
+		subView.mMappedRegionPtr = mMappedRegionPtr;
+		subView.mMappedSpan = mMappedSpan.subspan(offsetFromViewStartInBytes, subViewSizeInBytes);
 
-			// Only allow opening existing files, regardless of what AccessMode is set to. If
-			// the user wants to create a new file, they can call the constructor of
-			// std::ofstream with the ios flag std::ios::out; this will destroy the contents
-			// of the original file and create a new one if it does not already exist. For
-			// more information, refer to https://en.cppreference.com/w/cpp/io/basic_filebuf/open.
-			OPEN_EXISTING,
+		IMPL::ApplyMappedFileViewHints(subView.mMappedSpan, hints);
 
-			// We expect memory-mapped I/O access to be largely sequential. If this needs to
-			// change in the future, then we can add the caching behavior as a parameter to
-			// the constructor of MappedFileView.
-			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
-
-			nullptr
-		) };
-
-		if (hFile.get() == INVALID_HANDLE_VALUE) [[unlikely]]
-			Util::General::CheckHRESULT(HRESULT_FROM_WIN32(GetLastError()));
-
-		static constexpr std::uint32_t FL_PROTECT = (AccessMode == FileAccessMode::READ_ONLY ? PAGE_READONLY : PAGE_READWRITE);
-
-		if constexpr (Util::General::IsDebugModeEnabled()) 
-		{
-			// According to the MSDN, file mapping fails if the size of the file is 0.
-			std::error_code errorCode{};
-
-			const std::size_t fileSize = std::filesystem::file_size(filePath, errorCode);
-			Util::General::CheckErrorCode(errorCode);
-
-			assert(fileSize != 0 && "ERROR: File mappings cannot be created if the size of the file is 0 bytes! (To efficiently change the size of a file, use std::filesystem::resize_file().)");
-		}
-
-		mHFileMappingObject.reset(CreateFileMapping(
-			hFile.get(),
-			nullptr,
-			FL_PROTECT,
-			0,
-			0,
-			nullptr
-		));
-
-		if (mHFileMappingObject == nullptr) [[unlikely]]
-			Util::General::CheckHRESULT(HRESULT_FROM_WIN32(GetLastError()));
+		return subView;
 	}
 
 	template <FileAccessMode AccessMode>
 		requires IsValidAccessMode<AccessMode>
-	void MappedFileView<AccessMode>::MapFileView(const ViewParams& params)
+	bool MappedFileView<AccessMode>::IsValidView() const
 	{
-		static constexpr std::uint32_t DW_DESIRED_ACCESS = (AccessMode == FileAccessMode::READ_ONLY ? FILE_MAP_READ : FILE_MAP_WRITE);
-
-		// We want the returned std::span to reflect the user's desired view of the file. However,
-		// the Win32 API requires that our offset be a multiple of the system allocation granularity.
-		// Therefore, we need to offset our start address by moving it backwards. To make sure that
-		// we are reading all of the data, however, we also need to increase the size of the mapped
-		// view.
-		const std::size_t fileOffsetDelta = (params.FileOffsetInBytes % GetAllocationGranularity());
-
-		const std::size_t adjustedFileOffset = (params.FileOffsetInBytes - fileOffsetDelta);
-		const std::size_t numBytesToView = (params.ViewSizeInBytes + fileOffsetDelta);
-
-		mMapping.reset(MapViewOfFileEx(
-			mHFileMappingObject.get(),
-			DW_DESIRED_ACCESS,
-			(adjustedFileOffset >> 32),
-			(adjustedFileOffset & 0xFFFFFFFF),
-			numBytesToView,
-			nullptr
-		));
-
-		if (mMapping == nullptr) [[unlikely]]
-			Util::General::CheckHRESULT(HRESULT_FROM_WIN32(GetLastError()));
-
-		// Adjust the mapped std::span to be equivalent to the user's desired view.
-		mMappedSpan = std::span<std::byte>{ (reinterpret_cast<std::byte*>(mMapping.get()) + fileOffsetDelta), params.ViewSizeInBytes };
+		return (mMappedRegionPtr != nullptr);
 	}
 }
\ No newline at end of file
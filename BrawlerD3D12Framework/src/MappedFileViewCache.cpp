@@ -0,0 +1,116 @@
+module;
+#include <vector>
+#include <mutex>
+#include <filesystem>
+#include <optional>
+#include <algorithm>
+#include <cassert>
+#include <system_error>
+
+module Brawler.MappedFileViewCache;
+import Brawler.MappedFileView;
+import Brawler.MappedFileViewHint;
+import Brawler.FileAccessMode;
+import Brawler.CompositeEnum;
+import Util.General;
+
+namespace Brawler
+{
+	MappedFileViewCache::MappedFileViewCache(std::filesystem::path filePath) :
+		mFilePath(std::move(filePath)),
+		mFileSizeInBytes(),
+		mCachedWindowArr(),
+		mCurrUseID(0),
+		mCritSection()
+	{
+		// The window size must be a multiple of the allocation granularity, or else windows
+		// could not begin exactly where the previous window ends.
+		assert(WINDOW_SIZE_IN_BYTES % GetAllocationGranularity() == 0);
+
+		mCachedWindowArr.reserve(MAX_CACHED_WINDOW_COUNT);
+	}
+
+	MappedFileView<FileAccessMode::READ_ONLY> MappedFileViewCache::CreateMappedFileView(const MappedFileView<FileAccessMode::READ_ONLY>::ViewParams& params)
+	{
+		assert(params.ViewSizeInBytes != 0 && "ERROR: An attempt was made to create a MappedFileView for 0 bytes of a file!");
+
+		const std::uint64_t firstWindowIndex = (params.FileOffsetInBytes / WINDOW_SIZE_IN_BYTES);
+		const std::uint64_t lastWindowIndex = ((params.FileOffsetInBytes + params.ViewSizeInBytes - 1) / WINDOW_SIZE_IN_BYTES);
+
+		// If the view would span more than one window, then we give it a mapping of its own.
+		// Mapping a larger window instead would only work for this one request, so there is
+		// no point in caching it.
+		if (firstWindowIndex != lastWindowIndex) [[unlikely]]
+			return MappedFileView<FileAccessMode::READ_ONLY>{ mFilePath, params };
+
+		std::scoped_lock<std::mutex> lock{ mCritSection };
+
+		CachedWindow& cachedWindow{ GetCachedWindow(firstWindowIndex) };
+		return cachedWindow.WindowView.CreateSubView((params.FileOffsetInBytes - (firstWindowIndex * WINDOW_SIZE_IN_BYTES)), params.ViewSizeInBytes, params.Hints);
+	}
+
+	const std::filesystem::path& MappedFileViewCache::GetFilePath() const
+	{
+		return mFilePath;
+	}
+
+	MappedFileViewCache::CachedWindow& MappedFileViewCache::GetCachedWindow(const std::uint64_t windowIndex)
+	{
+		// The caller must hold mCritSection.
+		++mCurrUseID;
+
+		// There are never more than MAX_CACHED_WINDOW_COUNT windows, so a linear search is
+		// plenty fast.
+		const auto itr = std::ranges::find_if(mCachedWindowArr, [windowIndex] (const CachedWindow& window) { return (window.WindowIndex == windowIndex); });
+
+		if (itr != mCachedWindowArr.end())
+		{
+			itr->LastUseID = mCurrUseID;
+			return *itr;
+		}
+
+		const std::uint64_t windowStartOffset = (windowIndex * WINDOW_SIZE_IN_BYTES);
+		const std::uint64_t fileSize = GetFileSize();
+
+		assert(windowStartOffset < fileSize && "ERROR: An attempt was made to create a MappedFileView past the end of a file!");
+
+		// The last window of the file is usually smaller than WINDOW_SIZE_IN_BYTES. We do not
+		// apply any hints to the window itself; those are applied to the sub-views created
+		// from it, since the window as a whole is not accessed in any particular pattern.
+		CachedWindow newWindow{
+			.WindowIndex = windowIndex,
+			.WindowView{ mFilePath, MappedFileView<FileAccessMode::READ_ONLY>::ViewParams{
+				.FileOffsetInBytes = windowStartOffset,
+				.ViewSizeInBytes = std::min(WINDOW_SIZE_IN_BYTES, (fileSize - windowStartOffset)),
+				.Hints{}
+			} },
+			.LastUseID = mCurrUseID
+		};
+
+		if (mCachedWindowArr.size() < MAX_CACHED_WINDOW_COUNT)
+			return mCachedWindowArr.emplace_back(std::move(newWindow));
+
+		// Replace the least recently used window. Any MappedFileView still referring to it
+		// keeps it mapped until that view is destroyed.
+		CachedWindow& evictedWindow{ *std::ranges::min_element(mCachedWindowArr, {}, &CachedWindow::LastUseID) };
+		evictedWindow = std::move(newWindow);
+
+		return evictedWindow;
+	}
+
+	std::uint64_t MappedFileViewCache::GetFileSize()
+	{
+		// The caller must hold mCritSection.
+		if (!mFileSizeInBytes.has_value()) [[unlikely]]
+		{
+			std::error_code errorCode{};
+
+			const std::uint64_t fileSize = std::filesystem::file_size(mFilePath, errorCode);
+			Util::General::CheckErrorCode(errorCode);
+
+			mFileSizeInBytes = fileSize;
+		}
+
+		return *mFileSizeInBytes;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+module;
+#include <vector>
+#include <mutex>
+#include <filesystem>
+#include <optional>
+
+export module Brawler.MappedFileViewCache;
+import Brawler.MappedFileView;
+import Brawler.MappedFileViewHint;
+import Brawler.FileAccessMode;
+import Brawler.CompositeEnum;
+
+export namespace Brawler
+{
+	/// <summary>
+	/// The MappedFileViewCache hands out read-only MappedFileView instances for a single file,
+	/// such as the BPK archive. Creating a MappedFileView from scratch means opening the file,
+	/// creating a mapping, and eventually unmapping it again, and doing that for every asset
+	/// request quickly adds up when thousands of small assets are being loaded.
+	/// 
+	/// Instead, the MappedFileViewCache maps the file in large, aligned windows, and every
+	/// MappedFileView which it returns is a sub-view of one of these windows. Requests into the
+	/// same region of the file thus share a single mapping. Only the most recently used windows
+	/// are kept; a MappedFileView keeps its window mapped even after it was evicted from the
+	/// cache, so evicting a window never invalidates a view.
+	/// 
+	/// Requests which do not fit into a single window are given a mapping of their own.
+	/// </summary>
+	class MappedFileViewCache
+	{
+	private:
+		struct CachedWindow
+		{
+			std::uint64_t WindowIndex;
+			MappedFileView<FileAccessMode::READ_ONLY> WindowView;
+			std::uint64_t LastUseID;
+		};
+
+	public:
+		static constexpr std::uint64_t WINDOW_SIZE_IN_BYTES = (static_cast<std::uint64_t>(1) << 26);
+		static constexpr std::size_t MAX_CACHED_WINDOW_COUNT = 16;
+
+	public:
+		explicit MappedFileViewCache(std::filesystem::path filePath);
+
+		MappedFileViewCache(const MappedFileViewCache& rhs) = delete;
+		MappedFileViewCache& operator=(const MappedFileViewCache& rhs) = delete;
+
+		MappedFileViewCache(MappedFileViewCache&& rhs) noexcept = delete;
+		MappedFileViewCache& operator=(MappedFileViewCache&& rhs) noexcept = delete;
+
+		/// <summary>
+		/// Creates a MappedFileView for the specified part of the file. If that part lies
+		/// within a window which is already mapped, then no new mapping is created.
+		/// 
+		/// This function is thread safe.
+		/// </summary>
+		/// <param name="params">
+		/// - Describes the part of the file which is to be viewed, along with the hints which
+		///   are to be applied to it. Since cached windows already exist,
+		///   MappedFileViewHint::POPULATE is treated like MappedFileViewHint::PREFETCH for
+		///   views which share them.
+		/// </param>
+		/// <returns>
+		/// The function returns a MappedFileView for the specified part of the file.
+		/// </returns>
+		MappedFileView<FileAccessMode::READ_ONLY> CreateMappedFileView(const MappedFileView<FileAccessMode::READ_ONLY>::ViewParams& params);
+
+		const std::filesystem::path& GetFilePath() const;
+
+	private:
+		CachedWindow& GetCachedWindow(const std::uint64_t windowIndex);
+		std::uint64_t GetFileSize();
+
+	private:
+		std::filesystem::path mFilePath;
+
+		/// <summary>
+		/// The size of the file is only queried once the first view is created. That way,
+		/// a MappedFileViewCache can be created for a file which does not exist yet.
+		/// </summary>
+		std::optional<std::uint64_t> mFileSizeInBytes;
+
+		std::vector<CachedWindow> mCachedWindowArr;
+		std::uint64_t mCurrUseID;
+		mutable std::mutex mCritSection;
+	};
+}
\ No newline at end of file
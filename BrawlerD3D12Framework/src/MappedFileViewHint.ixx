@@ -0,0 +1,40 @@
+module;
+
+export module Brawler.MappedFileViewHint;
+
+export namespace Brawler
+{
+	/// <summary>
+	/// These hints tell the OS how a MappedFileView is going to be accessed. They are combined
+	/// into a Brawler::CompositeEnum&lt;MappedFileViewHint&gt;, and every MappedFileView can be
+	/// given a different set of them. None of the hints change what the view contains; they only
+	/// affect when its pages are read from the disk.
+	/// </summary>
+	enum class MappedFileViewHint
+	{
+		/// <summary>
+		/// The view will mostly be read from front to back, so the OS should read ahead
+		/// aggressively and drop pages soon after they have been read. On Windows, this is
+		/// FILE_FLAG_SEQUENTIAL_SCAN, which only applies to views which create their own
+		/// mapping. On POSIX systems, this is madvise(MADV_SEQUENTIAL).
+		/// </summary>
+		SEQUENTIAL_ACCESS,
+
+		/// <summary>
+		/// The view will be needed soon, so the OS should start reading its pages in the
+		/// background. This is PrefetchVirtualMemory() on Windows and madvise(MADV_WILLNEED)
+		/// on POSIX systems.
+		/// </summary>
+		PREFETCH,
+
+		/// <summary>
+		/// Every page of the view should be read before the MappedFileView is returned, so
+		/// that accessing it never causes a page fault. On POSIX systems, this is MAP_POPULATE.
+		/// Windows has no equivalent, so there, as well as for views which share an existing
+		/// mapping, this falls back to PREFETCH.
+		/// </summary>
+		POPULATE,
+
+		COUNT_OR_ERROR
+	};
+}
\ No newline at end of file
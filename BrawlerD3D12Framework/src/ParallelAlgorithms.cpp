@@ -0,0 +1,91 @@
+module;
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+module Brawler.ParallelAlgorithms;
+import Brawler.Job;
+import Brawler.WorkerThreadPool;
+import Util.Coroutine;
+
+namespace Brawler
+{
+	extern WorkerThreadPool& GetWorkerThreadPool();
+}
+
+namespace Brawler
+{
+	namespace IMPL
+	{
+		ParallelTaskTracker::ParallelTaskTracker(const JobPriority priority) :
+			mPendingTaskCount(1),
+			mHasException(false),
+			mExceptionCritSection(),
+			mExceptionPtr(),
+			mPriority(priority)
+		{}
+
+		void ParallelTaskTracker::AddPendingTask()
+		{
+			mPendingTaskCount.fetch_add(1, std::memory_order::relaxed);
+		}
+
+		void ParallelTaskTracker::OnTaskCompleted()
+		{
+			// The release ordering makes sure that everything the task wrote is visible to the
+			// waiting thread once it sees the count reach zero.
+			mPendingTaskCount.fetch_sub(1, std::memory_order::acq_rel);
+		}
+
+		void ParallelTaskTracker::StoreException(std::exception_ptr exceptionPtr)
+		{
+			std::scoped_lock<std::mutex> lock{ mExceptionCritSection };
+
+			// Only the first exception is kept. The others were most likely caused by the same
+			// problem, anyways.
+			if (mExceptionPtr == nullptr)
+			{
+				mExceptionPtr = std::move(exceptionPtr);
+				mHasException.store(true, std::memory_order::relaxed);
+			}
+		}
+
+		bool ParallelTaskTracker::HasException() const
+		{
+			return mHasException.load(std::memory_order::relaxed);
+		}
+
+		JobPriority ParallelTaskTracker::GetPriority() const
+		{
+			return mPriority;
+		}
+
+		void ParallelTaskTracker::WaitForCompletion()
+		{
+			// Help out by executing jobs until every task has completed. The job which we are
+			// waiting on is probably in our own deque, so it is likely that we end up executing
+			// it ourselves if no other thread stole it.
+			while (mPendingTaskCount.load(std::memory_order::acquire) != 0)
+			{
+				if (!Util::Coroutine::TryExecuteJob())
+					std::this_thread::yield();
+			}
+
+			if (mExceptionPtr != nullptr) [[unlikely]]
+				std::rethrow_exception(mExceptionPtr);
+		}
+
+		bool ShouldSplitRange(const JobPriority priority)
+		{
+			WorkerThreadPool& threadPool{ GetWorkerThreadPool() };
+
+			return (threadPool.GetWorkerThreadCount() > 0 && threadPool.IsCurrentThreadJobDequeEmpty(priority));
+		}
+
+		void DispatchRangeJob(JobCallback&& callback, const JobPriority priority)
+		{
+			GetWorkerThreadPool().DispatchJob(Job{ std::move(callback), nullptr, priority });
+		}
+	}
+}
\ No newline at end of file
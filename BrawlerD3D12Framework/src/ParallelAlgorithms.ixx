@@ -0,0 +1,440 @@
+module;
+#include <cstddef>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include <ranges>
+#include <iterator>
+#include <algorithm>
+#include <concepts>
+#include <type_traits>
+
+export module Brawler.ParallelAlgorithms;
+import Brawler.JobPriority;
+import Brawler.JobCallback;
+
+// The functions in this module split an index range across the WorkerThreadPool without
+// the caller having to decide how many jobs to create. Previously, every call site would
+// create either one job per element (which is terrible for small elements) or a fixed
+// number of jobs based on std::thread::hardware_concurrency() (which is terrible if one of
+// the chunks takes much longer than the others).
+//
+// Instead, we use lazy binary splitting. A task which is processing the range [begin, end)
+// only splits off the upper half of its range into a new job if the local job deque of the
+// thread executing it is empty; that is, if there is a good chance that another thread is
+// looking for work and would steal the new job. Otherwise, the task just processes the next
+// grainSize elements itself. This means that we create roughly as many jobs as there are
+// idle threads, and each thread works on contiguous memory for as long as possible.
+//
+// The calling thread always processes part of the range itself, and while it waits for the
+// remaining jobs to finish, it executes other jobs via Util::Coroutine::TryExecuteJob().
+// As such, these functions are safe to call from within jobs.
+
+namespace Brawler
+{
+	namespace IMPL
+	{
+		class ParallelTaskTracker
+		{
+		public:
+			explicit ParallelTaskTracker(const JobPriority priority);
+
+			ParallelTaskTracker(const ParallelTaskTracker& rhs) = delete;
+			ParallelTaskTracker& operator=(const ParallelTaskTracker& rhs) = delete;
+
+			ParallelTaskTracker(ParallelTaskTracker&& rhs) noexcept = delete;
+			ParallelTaskTracker& operator=(ParallelTaskTracker&& rhs) noexcept = delete;
+
+			void AddPendingTask();
+
+			/// <summary>
+			/// Marks one of the tasks tracked by this ParallelTaskTracker as completed. After
+			/// calling this function, a task must *NOT* access any memory owned by the thread
+			/// which is waiting for the tasks to complete, since that thread is free to return
+			/// as soon as the last task calls this function.
+			/// </summary>
+			void OnTaskCompleted();
+
+			void StoreException(std::exception_ptr exceptionPtr);
+			bool HasException() const;
+
+			JobPriority GetPriority() const;
+
+			/// <summary>
+			/// Executes jobs from the WorkerThreadPool until every task tracked by this
+			/// ParallelTaskTracker has completed. If any of these tasks threw an exception,
+			/// then the first such exception is re-thrown on the calling thread.
+			/// </summary>
+			void WaitForCompletion();
+
+		private:
+			// This starts at 1 to account for the task executed on the calling thread.
+			std::atomic<std::size_t> mPendingTaskCount;
+			std::atomic<bool> mHasException;
+			std::mutex mExceptionCritSection;
+			std::exception_ptr mExceptionPtr;
+			JobPriority mPriority;
+		};
+
+		/// <summary>
+		/// Determines whether or not a task should split its remaining range in half and
+		/// dispatch the upper half as a new job.
+		/// </summary>
+		/// <returns>
+		/// The function returns true if there are worker threads which could steal the new
+		/// job and the calling thread's local job deque for the specified priority is empty.
+		/// Otherwise, it returns false.
+		/// </returns>
+		bool ShouldSplitRange(const JobPriority priority);
+
+		void DispatchRangeJob(JobCallback&& callback, const JobPriority priority);
+
+		template <typename RangeFunction>
+		void ExecuteRange(ParallelTaskTracker& tracker, std::size_t beginIndex, std::size_t endIndex, const std::size_t grainSize, const RangeFunction& rangeFn);
+
+		template <typename RangeFunction>
+		void ExecuteParallelRange(const std::size_t beginIndex, const std::size_t endIndex, const std::size_t grainSize, const RangeFunction& rangeFn, const JobPriority priority);
+	}
+}
+
+export namespace Brawler
+{
+	/// <summary>
+	/// Calls callback once for every index in the range [beginIndex, endIndex), splitting
+	/// the range across the WorkerThreadPool. The function does not return until callback has
+	/// been called for every index. callback will be called concurrently from multiple threads,
+	/// and the order in which the indices are visited is unspecified.
+	///
+	/// If callback throws an exception, then the remaining indices may or may not be visited,
+	/// and the first exception which was thrown is re-thrown on the calling thread.
+	/// </summary>
+	/// <param name="beginIndex">
+	/// - The first index in the range.
+	/// </param>
+	/// <param name="endIndex">
+	/// - One past the last index in the range.
+	/// </param>
+	/// <param name="grainSize">
+	/// - The number of consecutive indices which a single thread processes before it checks
+	///   whether or not it should split its remaining range. The range is never split into
+	///   pieces smaller than this. Use larger values for cheap callbacks and smaller values
+	///   (down to 1) for expensive ones.
+	/// </param>
+	/// <param name="callback">
+	/// - The function which is to be called for every index. It must be invocable with a
+	///   std::size_t.
+	/// </param>
+	/// <param name="priority">
+	/// - The priority of the jobs which are created to process the range.
+	/// </param>
+	template <typename Callback>
+		requires std::invocable<Callback&, std::size_t>
+	void ParallelFor(const std::size_t beginIndex, const std::size_t endIndex, const std::size_t grainSize, Callback&& callback, const JobPriority priority = JobPriority::NORMAL);
+
+	/// <summary>
+	/// Calls callback once for every element in range, splitting the range across the
+	/// WorkerThreadPool. This is equivalent to calling ParallelFor() with the indices
+	/// [0, std::ranges::size(range)) and passing each element to callback.
+	/// </summary>
+	template <std::ranges::random_access_range RangeType, typename Callback>
+		requires std::ranges::sized_range<RangeType> && std::invocable<Callback&, std::ranges::range_reference_t<RangeType>>
+	void ParallelFor(RangeType&& range, const std::size_t grainSize, Callback&& callback, const JobPriority priority = JobPriority::NORMAL);
+
+	/// <summary>
+	/// Computes reduceFn(...reduceFn(reduceFn(identity, mapFn(beginIndex)), mapFn(beginIndex + 1))..., mapFn(endIndex - 1)),
+	/// splitting the range [beginIndex, endIndex) across the WorkerThreadPool.
+	///
+	/// Every thread reduces the indices which it processes into a partial result, starting
+	/// from identity. The partial results are then combined on the calling thread in the
+	/// order of their indices. Thus, reduceFn must be associative, but it need *NOT* be
+	/// commutative, and the result is the same regardless of how the range was split.
+	/// </summary>
+	/// <param name="beginIndex">
+	/// - The first index in the range.
+	/// </param>
+	/// <param name="endIndex">
+	/// - One past the last index in the range.
+	/// </param>
+	/// <param name="grainSize">
+	/// - The minimum number of consecutive indices which are reduced into a single partial
+	///   result. See ParallelFor() for more details.
+	/// </param>
+	/// <param name="identity">
+	/// - The identity value of reduceFn. This value is copied once for every partial result.
+	/// </param>
+	/// <param name="mapFn">
+	/// - The function which maps an index to a value which is to be reduced.
+	/// </param>
+	/// <param name="reduceFn">
+	/// - The function which combines two values into one.
+	/// </param>
+	/// <param name="priority">
+	/// - The priority of the jobs which are created to process the range.
+	/// </param>
+	/// <returns>
+	/// The function returns the reduction of every mapped value in the range. If the range
+	/// is empty, then identity is returned.
+	/// </returns>
+	template <std::copy_constructible T, typename MapFunction, typename ReduceFunction>
+		requires std::invocable<MapFunction&, std::size_t> && std::is_convertible_v<std::invoke_result_t<ReduceFunction&, T, std::invoke_result_t<MapFunction&, std::size_t>>, T> && std::is_convertible_v<std::invoke_result_t<ReduceFunction&, T, T>, T>
+	T ParallelReduce(const std::size_t beginIndex, const std::size_t endIndex, const std::size_t grainSize, T identity, MapFunction&& mapFn, ReduceFunction&& reduceFn, const JobPriority priority = JobPriority::NORMAL);
+
+	/// <summary>
+	/// Reduces every element in range via ParallelReduce(). mapFn is called with each element
+	/// in range, rather than with its index.
+	/// </summary>
+	template <std::ranges::random_access_range RangeType, std::copy_constructible T, typename MapFunction, typename ReduceFunction>
+		requires std::ranges::sized_range<RangeType> && std::invocable<MapFunction&, std::ranges::range_reference_t<RangeType>> && std::is_convertible_v<std::invoke_result_t<ReduceFunction&, T, std::invoke_result_t<MapFunction&, std::ranges::range_reference_t<RangeType>>>, T> && std::is_convertible_v<std::invoke_result_t<ReduceFunction&, T, T>, T>
+	T ParallelReduce(RangeType&& range, const std::size_t grainSize, T identity, MapFunction&& mapFn, ReduceFunction&& reduceFn, const JobPriority priority = JobPriority::NORMAL);
+
+	/// <summary>
+	/// Sorts the elements in the range [begin, end) according to comp, using the
+	/// WorkerThreadPool. The range is first split into chunks of grainSize elements, which are
+	/// sorted in parallel with std::sort(). Adjacent sorted chunks are then merged in parallel
+	/// with std::inplace_merge() until the entire range is sorted.
+	///
+	/// Like std::sort(), the sort is *NOT* stable.
+	///
+	/// Note that the final merge passes have less parallelism than the earlier ones, so this
+	/// is really only worth it for large ranges. If the range has no more than grainSize
+	/// elements, then it is just sorted on the calling thread.
+	/// </summary>
+	/// <param name="begin">
+	/// - An iterator to the first element in the range.
+	/// </param>
+	/// <param name="end">
+	/// - An iterator one past the last element in the range.
+	/// </param>
+	/// <param name="grainSize">
+	/// - The number of elements in each chunk which is sorted by a single thread.
+	/// </param>
+	/// <param name="comp">
+	/// - The comparison function used to order the elements. It must satisfy the same
+	///   requirements as the comparison function passed to std::sort().
+	/// </param>
+	/// <param name="priority">
+	/// - The priority of the jobs which are created to sort the range.
+	/// </param>
+	template <std::random_access_iterator Iterator, typename Comparator = std::ranges::less>
+		requires std::sortable<Iterator, Comparator>
+	void ParallelSort(const Iterator begin, const Iterator end, const std::size_t grainSize, Comparator comp = Comparator{}, const JobPriority priority = JobPriority::NORMAL);
+
+	template <std::ranges::random_access_range RangeType, typename Comparator = std::ranges::less>
+		requires std::sortable<std::ranges::iterator_t<RangeType>, Comparator>
+	void ParallelSort(RangeType&& range, const std::size_t grainSize, Comparator comp = Comparator{}, const JobPriority priority = JobPriority::NORMAL);
+}
+
+// --------------------------------------------------------------------------------------------------
+
+namespace Brawler
+{
+	namespace IMPL
+	{
+		template <typename RangeFunction>
+		void ExecuteRange(ParallelTaskTracker& tracker, std::size_t beginIndex, std::size_t endIndex, const std::size_t grainSize, const RangeFunction& rangeFn)
+		{
+			try
+			{
+				while ((endIndex - beginIndex) > grainSize)
+				{
+					// If some other task already failed, then there is no point in continuing.
+					if (tracker.HasException()) [[unlikely]]
+						break;
+
+					if (ShouldSplitRange(tracker.GetPriority()))
+					{
+						// Our local deque is empty, so any other thread looking for work would
+						// have nothing to steal from us. Give it the upper half of our range.
+						//
+						// We need to increment the pending task count *before* the job is dispatched.
+						// Otherwise, the new job could finish and decrement the count first, and the
+						// waiting thread might then think that all of the tasks have completed.
+						const std::size_t splitIndex = beginIndex + ((endIndex - beginIndex) / 2);
+						tracker.AddPendingTask();
+
+						DispatchRangeJob([&tracker, splitIndex, endIndex, grainSize, &rangeFn] ()
+						{
+							ExecuteRange(tracker, splitIndex, endIndex, grainSize, rangeFn);
+						}, tracker.GetPriority());
+
+						endIndex = splitIndex;
+					}
+					else
+					{
+						// The job which we split off last time has not yet been stolen, so there
+						// is no point in creating another one. Process the next chunk ourselves.
+						rangeFn(beginIndex, beginIndex + grainSize);
+						beginIndex += grainSize;
+					}
+				}
+
+				if (beginIndex != endIndex && !tracker.HasException())
+					rangeFn(beginIndex, endIndex);
+			}
+			catch (...)
+			{
+				tracker.StoreException(std::current_exception());
+			}
+
+			tracker.OnTaskCompleted();
+		}
+
+		template <typename RangeFunction>
+		void ExecuteParallelRange(const std::size_t beginIndex, const std::size_t endIndex, const std::size_t grainSize, const RangeFunction& rangeFn, const JobPriority priority)
+		{
+			if (beginIndex >= endIndex)
+				return;
+
+			ParallelTaskTracker tracker{ priority };
+			ExecuteRange(tracker, beginIndex, endIndex, std::max<std::size_t>(grainSize, 1), rangeFn);
+
+			tracker.WaitForCompletion();
+		}
+	}
+}
+
+namespace Brawler
+{
+	template <typename Callback>
+		requires std::invocable<Callback&, std::size_t>
+	void ParallelFor(const std::size_t beginIndex, const std::size_t endIndex, const std::size_t grainSize, Callback&& callback, const JobPriority priority)
+	{
+		const auto rangeFn = [&callback] (const std::size_t chunkBeginIndex, const std::size_t chunkEndIndex)
+		{
+			for (std::size_t i = chunkBeginIndex; i < chunkEndIndex; ++i)
+				std::invoke(callback, i);
+		};
+
+		IMPL::ExecuteParallelRange(beginIndex, endIndex, grainSize, rangeFn, priority);
+	}
+
+	template <std::ranges::random_access_range RangeType, typename Callback>
+		requires std::ranges::sized_range<RangeType> && std::invocable<Callback&, std::ranges::range_reference_t<RangeType>>
+	void ParallelFor(RangeType&& range, const std::size_t grainSize, Callback&& callback, const JobPriority priority)
+	{
+		const auto rangeBegin = std::ranges::begin(range);
+
+		const auto rangeFn = [&callback, rangeBegin] (const std::size_t chunkBeginIndex, const std::size_t chunkEndIndex)
+		{
+			const auto chunkBegin = rangeBegin + static_cast<std::ranges::range_difference_t<RangeType>>(chunkBeginIndex);
+			const auto chunkEnd = rangeBegin + static_cast<std::ranges::range_difference_t<RangeType>>(chunkEndIndex);
+
+			for (auto itr = chunkBegin; itr != chunkEnd; ++itr)
+				std::invoke(callback, *itr);
+		};
+
+		IMPL::ExecuteParallelRange(0, static_cast<std::size_t>(std::ranges::size(range)), grainSize, rangeFn, priority);
+	}
+
+	template <std::copy_constructible T, typename MapFunction, typename ReduceFunction>
+		requires std::invocable<MapFunction&, std::size_t> && std::is_convertible_v<std::invoke_result_t<ReduceFunction&, T, std::invoke_result_t<MapFunction&, std::size_t>>, T> && std::is_convertible_v<std::invoke_result_t<ReduceFunction&, T, T>, T>
+	T ParallelReduce(const std::size_t beginIndex, const std::size_t endIndex, const std::size_t grainSize, T identity, MapFunction&& mapFn, ReduceFunction&& reduceFn, const JobPriority priority)
+	{
+		struct PartialResult
+		{
+			std::size_t BeginIndex;
+			T Value;
+		};
+
+		// Every chunk of the range produces exactly one partial result. Since chunks are at
+		// least grainSize elements long, contention on this lock should be negligible.
+		std::vector<PartialResult> partialResultArr{};
+		std::mutex partialResultCritSection{};
+
+		const auto rangeFn = [&] (const std::size_t chunkBeginIndex, const std::size_t chunkEndIndex)
+		{
+			T partialValue = identity;
+
+			for (std::size_t i = chunkBeginIndex; i < chunkEndIndex; ++i)
+				partialValue = std::invoke(reduceFn, std::move(partialValue), std::invoke(mapFn, i));
+
+			std::scoped_lock<std::mutex> lock{ partialResultCritSection };
+			partialResultArr.push_back(PartialResult{
+				.BeginIndex = chunkBeginIndex,
+				.Value = std::move(partialValue)
+			});
+		};
+
+		IMPL::ExecuteParallelRange(beginIndex, endIndex, grainSize, rangeFn, priority);
+
+		// Combine the partial results in order. That way, reduceFn does not need to be
+		// commutative.
+		std::ranges::sort(partialResultArr, [] (const PartialResult& lhs, const PartialResult& rhs) { return (lhs.BeginIndex < rhs.BeginIndex); });
+
+		T result = std::move(identity);
+
+		for (auto& partialResult : partialResultArr)
+			result = std::invoke(reduceFn, std::move(result), std::move(partialResult.Value));
+
+		return result;
+	}
+
+	template <std::ranges::random_access_range RangeType, std::copy_constructible T, typename MapFunction, typename ReduceFunction>
+		requires std::ranges::sized_range<RangeType> && std::invocable<MapFunction&, std::ranges::range_reference_t<RangeType>> && std::is_convertible_v<std::invoke_result_t<ReduceFunction&, T, std::invoke_result_t<MapFunction&, std::ranges::range_reference_t<RangeType>>>, T> && std::is_convertible_v<std::invoke_result_t<ReduceFunction&, T, T>, T>
+	T ParallelReduce(RangeType&& range, const std::size_t grainSize, T identity, MapFunction&& mapFn, ReduceFunction&& reduceFn, const JobPriority priority)
+	{
+		const auto rangeBegin = std::ranges::begin(range);
+
+		return ParallelReduce(0, static_cast<std::size_t>(std::ranges::size(range)), grainSize, std::move(identity), [&mapFn, rangeBegin] (const std::size_t index) -> decltype(auto)
+		{
+			return std::invoke(mapFn, rangeBegin[static_cast<std::ranges::range_difference_t<RangeType>>(index)]);
+		}, std::forward<ReduceFunction>(reduceFn), priority);
+	}
+
+	template <std::random_access_iterator Iterator, typename Comparator>
+		requires std::sortable<Iterator, Comparator>
+	void ParallelSort(const Iterator begin, const Iterator end, const std::size_t grainSize, Comparator comp, const JobPriority priority)
+	{
+		const std::size_t numElements = static_cast<std::size_t>(end - begin);
+		const std::size_t chunkSize = std::max<std::size_t>(grainSize, 1);
+
+		if (numElements <= chunkSize)
+		{
+			std::sort(begin, end, std::ref(comp));
+			return;
+		}
+
+		const auto getChunkIterator = [begin, numElements] (const std::size_t elementIndex)
+		{
+			return begin + static_cast<std::iter_difference_t<Iterator>>(std::min(elementIndex, numElements));
+		};
+
+		// Sort each chunk individually.
+		const std::size_t numChunks = ((numElements + chunkSize - 1) / chunkSize);
+
+		ParallelFor(0, numChunks, 1, [&] (const std::size_t chunkIndex)
+		{
+			std::sort(getChunkIterator(chunkIndex * chunkSize), getChunkIterator((chunkIndex + 1) * chunkSize), std::ref(comp));
+		}, priority);
+
+		// Now, merge adjacent sorted runs until only one run remains. Each merge pass
+		// doubles the length of the sorted runs.
+		for (std::size_t runLength = chunkSize; runLength < numElements; runLength *= 2)
+		{
+			const std::size_t numMerges = ((numElements + (2 * runLength) - 1) / (2 * runLength));
+
+			ParallelFor(0, numMerges, 1, [&] (const std::size_t mergeIndex)
+			{
+				const std::size_t mergeBeginIndex = (mergeIndex * 2 * runLength);
+				const std::size_t mergeMiddleIndex = mergeBeginIndex + runLength;
+
+				// The last run in a pass might not have a partner to merge with.
+				if (mergeMiddleIndex >= numElements)
+					return;
+
+				std::inplace_merge(getChunkIterator(mergeBeginIndex), getChunkIterator(mergeMiddleIndex), getChunkIterator(mergeMiddleIndex + runLength), std::ref(comp));
+			}, priority);
+		}
+	}
+
+	template <std::ranges::random_access_range RangeType, typename Comparator>
+		requires std::sortable<std::ranges::iterator_t<RangeType>, Comparator>
+	void ParallelSort(RangeType&& range, const std::size_t grainSize, Comparator comp, const JobPriority priority)
+	{
+		const auto rangeBegin = std::ranges::begin(range);
+		ParallelSort(rangeBegin, rangeBegin + std::ranges::distance(range), grainSize, std::move(comp), priority);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,189 @@
+module;
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <iostream>
+#include <numeric>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <cmath>
+
+module Tests.ParallelAlgorithmsTest;
+import Brawler.JobSystem;
+import Brawler.Timer;
+
+namespace
+{
+	// DISCLAIMER: Just like the job system tests in the Brawler Engine, these are not rigorous
+	// benchmarks. They are meant to give a rough idea of how Brawler::ParallelFor() and friends
+	// compare to the pattern used throughout the code base of creating one job per item (or one
+	// job per evenly-sized chunk of items) in a Brawler::JobGroup.
+
+	constexpr std::size_t ELEMENT_COUNT = (1 << 18);
+	constexpr std::size_t SORT_ELEMENT_COUNT = (1 << 20);
+
+	// Each element in the unbalanced workload test requires an amount of work proportional
+	// to its index. Splitting such a range into evenly-sized chunks leaves the thread with the
+	// last chunk doing most of the work.
+	constexpr std::uint32_t MAX_UNBALANCED_ITERATIONS = 2048;
+
+	float PerformCheapWork(const std::size_t index)
+	{
+		return std::sqrtf(static_cast<float>(index));
+	}
+
+	float PerformUnbalancedWork(const std::size_t index)
+	{
+		const std::uint32_t numIterations = static_cast<std::uint32_t>((index * MAX_UNBALANCED_ITERATIONS) / ELEMENT_COUNT);
+		float result = 0.0f;
+
+		for (std::uint32_t i = 0; i < numIterations; ++i)
+			result += std::sqrtf(static_cast<float>(index + i));
+
+		return result;
+	}
+
+	template <typename Callback>
+	float MeasureTimeInMilliseconds(Callback&& callback)
+	{
+		Brawler::Timer t{};
+		t.Start();
+
+		callback();
+
+		t.Stop();
+		return t.GetElapsedTimeInMilliseconds();
+	}
+
+	void ReportResult(const char* const testName, const float perItemJobTime, const float chunkedJobTime, const float parallelAlgorithmTime)
+	{
+		std::cout << testName << ":\n"
+			<< "\tOne Job per Item: " << perItemJobTime << "ms\n"
+			<< "\tEvenly-Sized Chunks: " << chunkedJobTime << "ms\n"
+			<< "\tParallel Algorithm: " << parallelAlgorithmTime << "ms" << std::endl;
+	}
+
+	template <typename Callback>
+	void ExecuteEvenlyChunkedJobGroup(const std::size_t numElements, Callback&& callback)
+	{
+		// This mirrors how FrameGraphExecutionContext used to split its resource tracking work.
+		const std::size_t numJobs = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+		const std::size_t numElementsPerJob = ((numElements + numJobs - 1) / numJobs);
+
+		Brawler::JobGroup chunkedGroup{};
+		chunkedGroup.Reserve(numJobs);
+
+		for (std::size_t beginIndex = 0; beginIndex < numElements; beginIndex += numElementsPerJob)
+		{
+			const std::size_t endIndex = std::min(beginIndex + numElementsPerJob, numElements);
+
+			chunkedGroup.AddJob([&callback, beginIndex, endIndex] ()
+			{
+				for (std::size_t i = beginIndex; i < endIndex; ++i)
+					callback(i);
+			});
+		}
+
+		chunkedGroup.ExecuteJobs();
+	}
+
+	template <typename Callback>
+	void ExecutePerItemJobGroup(const std::size_t numElements, Callback&& callback)
+	{
+		Brawler::JobGroup perItemGroup{};
+		perItemGroup.Reserve(numElements);
+
+		for (std::size_t i = 0; i < numElements; ++i)
+			perItemGroup.AddJob([&callback, i] () { callback(i); });
+
+		perItemGroup.ExecuteJobs();
+	}
+
+	void RunForEachTest(const char* const testName, float(*workFunction)(const std::size_t), const std::size_t grainSize)
+	{
+		std::vector<float> resultArr{};
+		resultArr.resize(ELEMENT_COUNT);
+
+		const auto writeResultLambda = [&resultArr, workFunction] (const std::size_t index) { resultArr[index] = workFunction(index); };
+
+		const float perItemJobTime = MeasureTimeInMilliseconds([&] () { ExecutePerItemJobGroup(ELEMENT_COUNT, writeResultLambda); });
+		const float chunkedJobTime = MeasureTimeInMilliseconds([&] () { ExecuteEvenlyChunkedJobGroup(ELEMENT_COUNT, writeResultLambda); });
+
+		std::ranges::fill(resultArr, -1.0f);
+		const float parallelForTime = MeasureTimeInMilliseconds([&] () { Brawler::ParallelFor(0, ELEMENT_COUNT, grainSize, writeResultLambda); });
+
+		for (std::size_t i = 0; i < ELEMENT_COUNT; ++i)
+			assert(resultArr[i] == workFunction(i) && "ERROR: Brawler::ParallelFor() did not visit every index exactly once!");
+
+		ReportResult(testName, perItemJobTime, chunkedJobTime, parallelForTime);
+	}
+
+	void RunReduceTest()
+	{
+		std::vector<std::uint64_t> valueArr{};
+		valueArr.resize(ELEMENT_COUNT);
+		std::iota(valueArr.begin(), valueArr.end(), 0);
+
+		const std::uint64_t expectedSum = std::accumulate(valueArr.begin(), valueArr.end(), std::uint64_t{ 0 });
+
+		std::atomic<std::uint64_t> atomicSum{ 0 };
+		const auto atomicAddLambda = [&atomicSum, &valueArr] (const std::size_t index) { atomicSum.fetch_add(valueArr[index], std::memory_order::relaxed); };
+
+		const float perItemJobTime = MeasureTimeInMilliseconds([&] () { ExecutePerItemJobGroup(ELEMENT_COUNT, atomicAddLambda); });
+		assert(atomicSum.load() == expectedSum);
+
+		atomicSum.store(0);
+		const float chunkedJobTime = MeasureTimeInMilliseconds([&] () { ExecuteEvenlyChunkedJobGroup(ELEMENT_COUNT, atomicAddLambda); });
+		assert(atomicSum.load() == expectedSum);
+
+		std::uint64_t reducedSum = 0;
+		const float parallelReduceTime = MeasureTimeInMilliseconds([&] ()
+		{
+			reducedSum = Brawler::ParallelReduce(valueArr, 4096, std::uint64_t{ 0 }, [] (const std::uint64_t value) { return value; }, [] (const std::uint64_t lhs, const std::uint64_t rhs) { return (lhs + rhs); });
+		});
+
+		assert(reducedSum == expectedSum && "ERROR: Brawler::ParallelReduce() returned an incorrect sum!");
+
+		ReportResult("Sum Reduction", perItemJobTime, chunkedJobTime, parallelReduceTime);
+	}
+
+	void RunSortTest()
+	{
+		std::vector<std::uint32_t> valueArr{};
+		valueArr.resize(SORT_ELEMENT_COUNT);
+
+		// We use a simple LCG so that the test does not depend on <random>'s implementation.
+		std::uint32_t currValue = 1;
+		for (auto& value : valueArr)
+		{
+			currValue = (currValue * 1664525) + 1013904223;
+			value = currValue;
+		}
+
+		std::vector<std::uint32_t> sortedValueArr{ valueArr };
+		const float stdSortTime = MeasureTimeInMilliseconds([&] () { std::ranges::sort(sortedValueArr); });
+
+		const float parallelSortTime = MeasureTimeInMilliseconds([&] () { Brawler::ParallelSort(valueArr, 16384); });
+		assert(valueArr == sortedValueArr && "ERROR: Brawler::ParallelSort() did not sort the range correctly!");
+
+		std::cout << "Sort (" << SORT_ELEMENT_COUNT << " Elements):\n"
+			<< "\tstd::sort(): " << stdSortTime << "ms\n"
+			<< "\tBrawler::ParallelSort(): " << parallelSortTime << "ms" << std::endl;
+	}
+}
+
+namespace Tests
+{
+	void RunParallelAlgorithmsTests()
+	{
+		std::cout << "Beginning parallel algorithm tests...\n" << std::endl;
+
+		RunForEachTest("Cheap Per-Item Work", PerformCheapWork, 4096);
+		RunForEachTest("Unbalanced Per-Item Work", PerformUnbalancedWork, 64);
+		RunReduceTest();
+		RunSortTest();
+
+		std::cout << "\nParallel algorithm tests completed." << std::endl;
+	}
+}
\ No newline at end of file
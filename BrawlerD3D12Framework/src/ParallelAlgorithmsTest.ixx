@@ -0,0 +1,8 @@
+module;
+
+export module Tests.ParallelAlgorithmsTest;
+
+export namespace Tests
+{
+	void RunParallelAlgorithmsTests();
+}
\ No newline at end of file
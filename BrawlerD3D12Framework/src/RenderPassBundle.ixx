@@ -2,6 +2,7 @@ module;
 #include <vector>
 #include <memory>
 #include <span>
+#include <ranges>
 
 export module Brawler.D3D12.RenderPassBundle;
 import Brawler.D3D12.RenderPass;
@@ -208,10 +209,7 @@ namespace Brawler
 		void RenderPassBundle::AddResourceDependenciesForRenderPass(const RenderPass<PassQueueType, InputDataType>& renderPass)
 		{
 			const std::span<const FrameGraphResourceDependency> resourceDependencySpan{ renderPass.GetResourceDependencies() };
-			mResourceDependencyArr.Reserve(mResourceDependencyArr.GetSize() + resourceDependencySpan.size());
-
-			for (const auto& dependency : resourceDependencySpan)
-				mResourceDependencyArr.Insert(dependency.ResourcePtr);
+			mResourceDependencyArr.InsertRange(resourceDependencySpan | std::views::transform([] (const FrameGraphResourceDependency& dependency) { return dependency.ResourcePtr; }));
 		}
 	}
 }
\ No newline at end of file
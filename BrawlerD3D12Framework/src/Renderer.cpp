@@ -1,9 +1,8 @@
 module;
-#include <atomic>
 
 module Brawler.D3D12.Renderer;
 import Brawler.JobGroup;
-import Util.Coroutine;
+import Brawler.D3D12.TLSFAllocator;
 
 namespace Brawler
 {
@@ -11,27 +10,6 @@ namespace Brawler
 	{
 		void Renderer::Initialize()
 		{
-			// On a separate thread, asynchronously create the bindless SRV index queue. This
-			// is a long-running process which involves a lot of heap allocations, but so is
-			// initializing the D3D12 device. In fact, the latter takes so long that by doing these
-			// two concurrently, creating the bindless SRV index queue should be "free."
-			std::atomic<bool> bindlessSRVQueueInitialized{ false };
-
-			{
-				Brawler::JobGroup bindlessSRVQueueInitializationGroup{};
-
-				bindlessSRVQueueInitializationGroup.AddJob([this, &bindlessSRVQueueInitialized] ()
-				{
-					mDevice.GetGPUResourceDescriptorHeap().InitializeBindlessSRVQueue();
-
-					// We can use std::memory_order::relaxed, because the bindless SRV queue itself
-					// is protected by a std::mutex.
-					bindlessSRVQueueInitialized.store(true, std::memory_order::relaxed);
-				});
-
-				bindlessSRVQueueInitializationGroup.ExecuteJobsAsync();
-			}
-			
 			// Initialize the GPUDevice.
 			mDevice.Initialize();
 
@@ -77,10 +55,6 @@ namespace Brawler
 			// compilation relies on compiled root signatures. It also must be done after the PSO
 			// library has been loaded from the disk.
 			PSODatabase::GetInstance().LoadPSOs();
-
-			// Wait for the bindless SRV queue to be initialized.
-			while (!bindlessSRVQueueInitialized.load(std::memory_order::relaxed))
-				Util::Coroutine::TryExecuteJob();
 		}
 		
 		GPUCommandManager& Renderer::GetGPUCommandManager()
@@ -139,6 +113,11 @@ namespace Brawler
 			// then it might be best to instead add it to FrameGraph::ResetFrameGraph(), after
 			// FrameGraph::WaitForPreviousFrameGraphExecution() is called.)
 
+			// Hand the blocks held in the TLSFAllocator thread caches back to their heaps, so that
+			// they can be merged again. Otherwise, the caches would keep the buffers fragmented
+			// with whatever the threads happened to allocate and free during the frame.
+			TLSFAllocator::FlushAllThreadCaches();
+
 			++mCurrFrameNum;
 		}
 
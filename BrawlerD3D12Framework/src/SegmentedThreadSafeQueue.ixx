@@ -0,0 +1,265 @@
+module;
+#include <cstddef>
+#include <atomic>
+#include <array>
+#include <algorithm>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+export module Brawler.SegmentedThreadSafeQueue;
+import Brawler.EpochReclamation;
+
+// Brawler::SegmentedThreadSafeQueue is a lock-free, multi-producer/multi-consumer FIFO queue
+// with no fixed capacity. Unlike Brawler::ThreadSafeQueue, SegmentedThreadSafeQueue::PushBack()
+// can never fail.
+//
+// Internally, the queue is a singly-linked list of segments, each of which holds a fixed-size
+// array of elements. Producers claim slots in the tail segment with a single fetch_add(); when
+// a segment runs out of slots, a new one is allocated and linked in. Consumers claim slots in
+// the head segment with a compare/exchange, and the head segment is retired once every slot in
+// it has been consumed.
+//
+// Retired segments cannot be deleted right away, since another thread may have read a pointer
+// to one just before it was unlinked. Instead, every queue operation runs inside of an
+// EpochGuard, and retired segments are passed to Util::EpochReclamation::RetireObject(). Each
+// segment is thus deleted as soon as the threads which could have seen it have left the queue,
+// regardless of how many other threads have entered it since then.
+//
+// This queue is meant to be used as an overflow path for the fixed-capacity queues. Allocations
+// only happen when a new segment is needed, and a segment holds NumElementsPerSegment elements,
+// so the cost of the allocation is amortized over all of them.
+
+export namespace Brawler
+{
+	template <typename T, std::size_t NumElementsPerSegment>
+	class SegmentedThreadSafeQueue
+	{
+	private:
+		static_assert(NumElementsPerSegment > 0, "ERROR: An attempt was made to create a SegmentedThreadSafeQueue with empty segments!");
+
+	private:
+		struct Slot
+		{
+			T Value;
+
+			// Like in Brawler::ThreadSafeQueue, this is used to prevent a consumer from reading
+			// the value in a slot before the producer which claimed it has finished writing it.
+			std::atomic<bool> IsReady;
+		};
+
+		struct Segment
+		{
+			std::array<Slot, NumElementsPerSegment> SlotArr;
+			std::atomic<std::size_t> EnqueueIndex;
+			std::atomic<std::size_t> DequeueIndex;
+			std::atomic<Segment*> NextSegmentPtr;
+
+			Segment() :
+				SlotArr(),
+				EnqueueIndex(0),
+				DequeueIndex(0),
+				NextSegmentPtr(nullptr)
+			{}
+		};
+
+	public:
+		SegmentedThreadSafeQueue();
+		~SegmentedThreadSafeQueue();
+
+		SegmentedThreadSafeQueue(const SegmentedThreadSafeQueue& rhs) = delete;
+		SegmentedThreadSafeQueue& operator=(const SegmentedThreadSafeQueue& rhs) = delete;
+
+		SegmentedThreadSafeQueue(SegmentedThreadSafeQueue&& rhs) noexcept = delete;
+		SegmentedThreadSafeQueue& operator=(SegmentedThreadSafeQueue&& rhs) noexcept = delete;
+
+		/// <summary>
+		/// Inserts the element val into the back of the queue. Unlike ThreadSafeQueue::PushBack(),
+		/// this function always succeeds.
+		/// </summary>
+		/// <param name="val">
+		/// - The value to be inserted to the back of the queue.
+		/// </param>
+		template <typename U = T>
+			requires std::is_same_v<std::decay_t<U>, std::decay_t<T>>
+		void PushBack(U&& val);
+
+		/// <summary>
+		/// Attempts to remove the element at the front of the queue. If the function succeeds, then the returned
+		/// std::optional instance contains the element which was claimed from the queue. Otherwise, the returned
+		/// std::optional instance has no valid value.
+		/// </summary>
+		/// <returns>
+		/// If the function succeeds, then the returned std::optional instance contains the element which was
+		/// claimed from the queue. Otherwise, the std::optional instance has no valid value. Specifically, if
+		/// the queue is empty, then this function will fail.
+		/// </returns>
+		std::optional<T> TryPop();
+
+		/// <summary>
+		/// Checks to see whether the queue is empty or not. This only reads a single atomic counter,
+		/// so it is cheap enough to call before every TryPop().
+		/// </summary>
+		/// <returns>
+		/// This function returns true if the queue is empty at the time of calling this and false otherwise.
+		/// Keep in mind that due to race conditions, it is entirely possible that an empty queue can become
+		/// filled immediately after this is called, or vice versa.
+		/// </returns>
+		bool IsEmpty() const;
+
+	private:
+		std::atomic<Segment*> mHeadSegmentPtr;
+		std::atomic<Segment*> mTailSegmentPtr;
+
+		// This is incremented after an element is fully written and decremented after an element
+		// is claimed. It lets TryPop() bail out early on an empty queue without touching the
+		// segments at all.
+		std::atomic<std::size_t> mApproximateSize;
+	};
+}
+
+// --------------------------------------------------------------------------------------------------
+
+namespace Brawler
+{
+	template <typename T, std::size_t NumElementsPerSegment>
+	SegmentedThreadSafeQueue<T, NumElementsPerSegment>::SegmentedThreadSafeQueue() :
+		mHeadSegmentPtr(nullptr),
+		mTailSegmentPtr(nullptr),
+		mApproximateSize(0)
+	{
+		Segment* const initialSegmentPtr = new Segment{};
+
+		mHeadSegmentPtr.store(initialSegmentPtr, std::memory_order::relaxed);
+		mTailSegmentPtr.store(initialSegmentPtr, std::memory_order::relaxed);
+	}
+
+	template <typename T, std::size_t NumElementsPerSegment>
+	SegmentedThreadSafeQueue<T, NumElementsPerSegment>::~SegmentedThreadSafeQueue()
+	{
+		// By the time the destructor is called, no other thread should be accessing the queue,
+		// so we can delete every segment which is still linked in directly. Retired segments
+		// are owned by the epoch reclamation system, which deletes them on its own.
+		Segment* currSegmentPtr = mHeadSegmentPtr.load(std::memory_order::acquire);
+
+		while (currSegmentPtr != nullptr)
+		{
+			Segment* const nextSegmentPtr = currSegmentPtr->NextSegmentPtr.load(std::memory_order::acquire);
+			delete currSegmentPtr;
+
+			currSegmentPtr = nextSegmentPtr;
+		}
+	}
+
+	template <typename T, std::size_t NumElementsPerSegment>
+	template <typename U>
+		requires std::is_same_v<std::decay_t<U>, std::decay_t<T>>
+	void SegmentedThreadSafeQueue<T, NumElementsPerSegment>::PushBack(U&& val)
+	{
+		const EpochGuard guard{};
+
+		while (true)
+		{
+			Segment* const tailSegmentPtr = mTailSegmentPtr.load(std::memory_order::acquire);
+			const std::size_t claimedIndex = tailSegmentPtr->EnqueueIndex.fetch_add(1, std::memory_order::acq_rel);
+
+			if (claimedIndex < NumElementsPerSegment) [[likely]]
+			{
+				Slot& claimedSlot{ tailSegmentPtr->SlotArr[claimedIndex] };
+
+				claimedSlot.Value = std::forward<U>(val);
+				claimedSlot.IsReady.store(true, std::memory_order::release);
+
+				mApproximateSize.fetch_add(1, std::memory_order::release);
+				return;
+			}
+
+			// The tail segment is full, so we need to move on to the next one. If nobody has
+			// created it yet, then we try to do so ourselves.
+			Segment* nextSegmentPtr = tailSegmentPtr->NextSegmentPtr.load(std::memory_order::acquire);
+
+			if (nextSegmentPtr == nullptr)
+			{
+				Segment* const newSegmentPtr = new Segment{};
+
+				if (tailSegmentPtr->NextSegmentPtr.compare_exchange_strong(nextSegmentPtr, newSegmentPtr, std::memory_order::acq_rel, std::memory_order::acquire))
+					nextSegmentPtr = newSegmentPtr;
+
+				// If another thread beat us to it, then nextSegmentPtr now refers to their segment,
+				// and we can get rid of ours. No other thread has ever seen it.
+				else
+					delete newSegmentPtr;
+			}
+
+			// Try to advance the tail. It doesn't matter if we fail, since that just means that
+			// another thread has already done it for us.
+			Segment* expectedTailSegmentPtr = tailSegmentPtr;
+			mTailSegmentPtr.compare_exchange_strong(expectedTailSegmentPtr, nextSegmentPtr, std::memory_order::acq_rel, std::memory_order::relaxed);
+		}
+	}
+
+	template <typename T, std::size_t NumElementsPerSegment>
+	std::optional<T> SegmentedThreadSafeQueue<T, NumElementsPerSegment>::TryPop()
+	{
+		if (IsEmpty())
+			return std::optional<T>{};
+
+		const EpochGuard guard{};
+		std::optional<T> poppedValue{};
+
+		while (true)
+		{
+			Segment* const headSegmentPtr = mHeadSegmentPtr.load(std::memory_order::acquire);
+			std::size_t dequeueIndex = headSegmentPtr->DequeueIndex.load(std::memory_order::acquire);
+
+			if (dequeueIndex >= NumElementsPerSegment)
+			{
+				// Every slot in this segment has been claimed by a consumer. If there is no next
+				// segment, then the queue is empty.
+				Segment* const nextSegmentPtr = headSegmentPtr->NextSegmentPtr.load(std::memory_order::acquire);
+
+				if (nextSegmentPtr == nullptr)
+					break;
+
+				// Before we can retire the head segment, we need to make sure that the tail no
+				// longer refers to it. Otherwise, a producer could start using it after it
+				// has been retired.
+				Segment* expectedTailSegmentPtr = headSegmentPtr;
+				mTailSegmentPtr.compare_exchange_strong(expectedTailSegmentPtr, nextSegmentPtr, std::memory_order::acq_rel, std::memory_order::relaxed);
+
+				// Only the thread which successfully advances the head gets to retire the old one.
+				Segment* expectedHeadSegmentPtr = headSegmentPtr;
+				if (mHeadSegmentPtr.compare_exchange_strong(expectedHeadSegmentPtr, nextSegmentPtr, std::memory_order::acq_rel, std::memory_order::relaxed))
+					Util::EpochReclamation::RetireObject(headSegmentPtr);
+
+				continue;
+			}
+
+			// Producers can increment EnqueueIndex past the end of the segment, so we clamp it.
+			const std::size_t enqueueIndex = std::min(headSegmentPtr->EnqueueIndex.load(std::memory_order::acquire), NumElementsPerSegment);
+
+			if (dequeueIndex >= enqueueIndex)
+				break;
+
+			if (!headSegmentPtr->DequeueIndex.compare_exchange_weak(dequeueIndex, dequeueIndex + 1, std::memory_order::acq_rel, std::memory_order::relaxed))
+				continue;
+
+			// Wait for the element to be filled.
+			Slot& claimedSlot{ headSegmentPtr->SlotArr[dequeueIndex] };
+			while (!claimedSlot.IsReady.load(std::memory_order::acquire));
+
+			poppedValue = std::move(claimedSlot.Value);
+			mApproximateSize.fetch_sub(1, std::memory_order::relaxed);
+
+			break;
+		}
+
+		return poppedValue;
+	}
+
+	template <typename T, std::size_t NumElementsPerSegment>
+	bool SegmentedThreadSafeQueue<T, NumElementsPerSegment>::IsEmpty() const
+	{
+		return (mApproximateSize.load(std::memory_order::acquire) == 0);
+	}
+}
\ No newline at end of file
@@ -3,6 +3,13 @@ module;
 #include <algorithm>
 #include <functional>
 #include <span>
+#include <ranges>
+#include <iterator>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define BRAWLER_SORTED_VECTOR_USE_PREFETCH
+#endif
 
 export module Brawler.SortedVector;
 import Brawler.Functional;
@@ -25,6 +32,14 @@ export namespace Brawler
 	/// a better choice than std::set. However, if they do not need to be
 	/// sorted, then you should profile the difference between SortedVector
 	/// and std::unordered_set.
+	/// 
+	/// Inserting elements one at a time with SortedVector::Insert() has to move
+	/// every element after the insertion point, so building a SortedVector out of
+	/// N elements in this way takes O(N^2) time. If many elements are to be added
+	/// at once, then SortedVector::InsertRange() should be used instead. Likewise,
+	/// combining two SortedVector instances should be done with
+	/// SortedVector::Union(), SortedVector::Intersection(), or
+	/// SortedVector::Difference(), all of which run in linear time.
 	/// </summary>
 	/// <typeparam name="T">
 	/// - The type of the keys which are to be stored in the SortedVector instance.
@@ -63,6 +78,21 @@ export namespace Brawler
 			requires std::is_same_v<std::decay_t<T>, std::decay_t<U>>
 		void Insert(U&& key);
 
+		/// <summary>
+		/// Adds every value in range which does not already exist in the SortedVector
+		/// instance. The values are appended to the underlying array, sorted, and then
+		/// merged with the existing values, so this takes O(N + M log M) time, where N
+		/// is the current size of the SortedVector and M is the number of values in
+		/// range. Duplicate values within range are only added once.
+		/// </summary>
+		/// <param name="range">
+		/// - The range of values which are to be inserted into the SortedVector
+		///   instance. These need not be sorted.
+		/// </param>
+		template <std::ranges::input_range Range>
+			requires std::is_convertible_v<std::ranges::range_reference_t<Range>, T>
+		void InsertRange(Range&& range);
+
 		void Remove(const T& key);
 
 		/// <summary>
@@ -109,6 +139,50 @@ export namespace Brawler
 
 		std::span<const T> CreateSpan() const;
 
+		/// <summary>
+		/// Creates a SortedVector which contains every value found in either this
+		/// SortedVector instance or rhs. This takes O(N + M) time.
+		/// </summary>
+		/// <param name="rhs">
+		/// - The SortedVector whose values are to be combined with those of this
+		///   SortedVector instance.
+		/// </param>
+		/// <returns>
+		/// The function returns a SortedVector containing the union of the values in
+		/// this SortedVector instance and rhs.
+		/// </returns>
+		SortedVector Union(const SortedVector& rhs) const;
+
+		/// <summary>
+		/// Creates a SortedVector which contains every value found in both this
+		/// SortedVector instance and rhs. This takes O(N + M) time.
+		/// </summary>
+		/// <param name="rhs">
+		/// - The SortedVector whose values are to be intersected with those of this
+		///   SortedVector instance.
+		/// </param>
+		/// <returns>
+		/// The function returns a SortedVector containing the intersection of the
+		/// values in this SortedVector instance and rhs.
+		/// </returns>
+		SortedVector Intersection(const SortedVector& rhs) const;
+
+		/// <summary>
+		/// Creates a SortedVector which contains every value found in this SortedVector
+		/// instance, but not in rhs. This takes O(N + M) time.
+		/// </summary>
+		/// <param name="rhs">
+		/// - The SortedVector whose values are to be excluded from the result.
+		/// </param>
+		/// <returns>
+		/// The function returns a SortedVector containing the values in this
+		/// SortedVector instance which are not in rhs.
+		/// </returns>
+		SortedVector Difference(const SortedVector& rhs) const;
+
+	private:
+		std::size_t GetLowerBoundIndex(const T& key) const;
+
 	private:
 		std::vector<T> mDataArr;
 	};
@@ -123,7 +197,7 @@ namespace Brawler
 		requires std::is_same_v<std::decay_t<T>, std::decay_t<U>>
 	void SortedVector<T, ComparisonOp>::Insert(U&& key)
 	{
-		const auto itr = std::ranges::lower_bound(mDataArr, key, ComparisonOp{});
+		const auto itr = (mDataArr.begin() + GetLowerBoundIndex(key));
 
 		// If the element does not already exist, then add it at the specified
 		// position.
@@ -131,10 +205,38 @@ namespace Brawler
 			mDataArr.insert(itr, std::forward<U>(key));
 	}
 
+	template <typename T, typename ComparisonOp>
+	template <std::ranges::input_range Range>
+		requires std::is_convertible_v<std::ranges::range_reference_t<Range>, T>
+	void SortedVector<T, ComparisonOp>::InsertRange(Range&& range)
+	{
+		const std::size_t oldSize = mDataArr.size();
+
+		if constexpr (std::ranges::sized_range<Range>)
+			mDataArr.reserve(oldSize + std::ranges::size(range));
+
+		for (auto&& value : range)
+			mDataArr.push_back(std::forward<decltype(value)>(value));
+
+		const auto newValuesBegin = (mDataArr.begin() + oldSize);
+
+		if (newValuesBegin == mDataArr.end())
+			return;
+
+		// std::ranges::inplace_merge() is stable, so if a value was already in the
+		// SortedVector, then the existing copy comes first and is the one which is kept
+		// by std::ranges::unique(). That matches the behavior of SortedVector::Insert().
+		std::ranges::sort(newValuesBegin, mDataArr.end(), ComparisonOp{});
+		std::ranges::inplace_merge(mDataArr, newValuesBegin, ComparisonOp{});
+
+		const auto duplicateValuesSubRange = std::ranges::unique(mDataArr);
+		mDataArr.erase(duplicateValuesSubRange.begin(), duplicateValuesSubRange.end());
+	}
+
 	template <typename T, typename ComparisonOp>
 	void SortedVector<T, ComparisonOp>::Remove(const T& key)
 	{
-		const auto itr = std::ranges::lower_bound(mDataArr, key, ComparisonOp{});
+		const auto itr = (mDataArr.begin() + GetLowerBoundIndex(key));
 
 		if (itr != mDataArr.end() && *itr == key) [[likely]]
 			mDataArr.erase(itr);
@@ -143,7 +245,7 @@ namespace Brawler
 	template <typename T, typename ComparisonOp>
 	bool SortedVector<T, ComparisonOp>::Contains(const T& key) const
 	{
-		const auto itr = std::ranges::lower_bound(mDataArr, key, ComparisonOp{});
+		const auto itr = (mDataArr.begin() + GetLowerBoundIndex(key));
 		return (itr != mDataArr.end() && *itr == key);
 	}
 
@@ -178,4 +280,94 @@ namespace Brawler
 	{
 		return std::span<const T>{ mDataArr };
 	}
+
+	template <typename T, typename ComparisonOp>
+	SortedVector<T, ComparisonOp> SortedVector<T, ComparisonOp>::Union(const SortedVector& rhs) const
+	{
+		SortedVector unionSet{};
+		unionSet.mDataArr.reserve(mDataArr.size() + rhs.mDataArr.size());
+
+		std::ranges::set_union(mDataArr, rhs.mDataArr, std::back_inserter(unionSet.mDataArr), ComparisonOp{});
+
+		return unionSet;
+	}
+
+	template <typename T, typename ComparisonOp>
+	SortedVector<T, ComparisonOp> SortedVector<T, ComparisonOp>::Intersection(const SortedVector& rhs) const
+	{
+		SortedVector intersectionSet{};
+		intersectionSet.mDataArr.reserve(std::min(mDataArr.size(), rhs.mDataArr.size()));
+
+		std::ranges::set_intersection(mDataArr, rhs.mDataArr, std::back_inserter(intersectionSet.mDataArr), ComparisonOp{});
+
+		return intersectionSet;
+	}
+
+	template <typename T, typename ComparisonOp>
+	SortedVector<T, ComparisonOp> SortedVector<T, ComparisonOp>::Difference(const SortedVector& rhs) const
+	{
+		SortedVector differenceSet{};
+		differenceSet.mDataArr.reserve(mDataArr.size());
+
+		std::ranges::set_difference(mDataArr, rhs.mDataArr, std::back_inserter(differenceSet.mDataArr), ComparisonOp{});
+
+		return differenceSet;
+	}
+
+	template <typename T, typename ComparisonOp>
+	std::size_t SortedVector<T, ComparisonOp>::GetLowerBoundIndex(const T& key) const
+	{
+		// std::ranges::lower_bound() branches on the result of every comparison. The keys
+		// stored in a SortedVector are usually pointers, which are effectively random, so
+		// the CPU mispredicts about half of these branches. Instead, we always halve the
+		// remaining range and only select which half to keep based on the comparison. The
+		// compiler can turn this into a conditional move, so the loop has no unpredictable
+		// branches, and it always runs for exactly ceil(log2(N)) iterations.
+		//
+		// We could go further and store the elements in an Eytzinger layout, which also
+		// makes the search far friendlier to the cache for very large sets. However,
+		// SortedVector::CreateSpan() hands out the elements in sorted order, and keeping
+		// two copies of every element would cost more than it saves for the sizes which we
+		// deal with.
+#ifdef BRAWLER_SORTED_VECTOR_USE_PREFETCH
+		static constexpr std::size_t PREFETCH_RANGE_SIZE_THRESHOLD = 1024;
+#endif
+
+		std::size_t remainingCount = mDataArr.size();
+
+		if (remainingCount == 0) [[unlikely]]
+			return 0;
+
+		const ComparisonOp comparisonOp{};
+		const T* basePtr = mDataArr.data();
+
+#ifdef BRAWLER_SORTED_VECTOR_USE_PREFETCH
+		// As long as the remaining range does not fit into the L1 cache, every iteration is a
+		// cache miss, and since the next element which we read depends on this comparison, the
+		// CPU cannot start loading it early on its own. We can, however, fetch both of the
+		// candidates for the next iteration while we wait for this one. For smaller ranges, the
+		// prefetches only get in the way, so we switch to the plain loop below once we get
+		// there.
+		while (remainingCount > 1 && (remainingCount * sizeof(T)) > PREFETCH_RANGE_SIZE_THRESHOLD)
+		{
+			const std::size_t halfCount = (remainingCount / 2);
+			const std::size_t nextHalfCount = ((remainingCount - halfCount) / 2);
+
+			_mm_prefetch(reinterpret_cast<const char*>(basePtr + nextHalfCount), _MM_HINT_T0);
+			_mm_prefetch(reinterpret_cast<const char*>(basePtr + halfCount + nextHalfCount), _MM_HINT_T0);
+
+			basePtr = (comparisonOp(basePtr[halfCount], key) ? (basePtr + halfCount) : basePtr);
+			remainingCount -= halfCount;
+		}
+#endif
+
+		while (remainingCount > 1)
+		{
+			const std::size_t halfCount = (remainingCount / 2);
+			basePtr = (comparisonOp(basePtr[halfCount], key) ? (basePtr + halfCount) : basePtr);
+			remainingCount -= halfCount;
+		}
+
+		return (static_cast<std::size_t>(basePtr - mDataArr.data()) + (comparisonOp(*basePtr, key) ? 1 : 0));
+	}
 }
\ No newline at end of file
@@ -4,10 +4,20 @@ module;
 #include <mutex>
 #include <cassert>
 #include <optional>
-#include <ranges>
+#include <memory>
+#include <thread>
+#include <bit>
+#include <algorithm>
+#include <span>
 #include "DxDef.h"
 
 module Brawler.D3D12.TLSFAllocator;
+import Util.General;
+import Util.Threading;
+import Brawler.ThreadLocalResources;
+import Brawler.D3D12.AllocatorTrace;
+import Brawler.CopyOnWriteVector;
+import Brawler.EpochReclamation;
 
 namespace
 {
@@ -40,13 +50,49 @@ namespace
 
 		return std::optional<std::uint32_t>{ (attemptedIndex + newIndex) };
 	}
+
+	std::optional<std::uint32_t> GetThreadCacheSizeClassIndex(const Brawler::D3D12::TLSFAllocationRequestInfo& allocationInfo)
+	{
+		if (allocationInfo.SizeInBytes > Brawler::D3D12::MAX_THREAD_CACHE_SIZE_CLASS || allocationInfo.Alignment > Brawler::D3D12::MAX_THREAD_CACHE_SIZE_CLASS)
+			return std::optional<std::uint32_t>{};
+
+		// Cached blocks are aligned to their own size, so a request with a larger alignment than
+		// size just goes into a larger size class.
+		const std::size_t sizeClass = std::max({ std::bit_ceil(allocationInfo.SizeInBytes), allocationInfo.Alignment, Brawler::D3D12::MIN_THREAD_CACHE_SIZE_CLASS });
+		return static_cast<std::uint32_t>(std::countr_zero(sizeClass) - std::countr_zero(Brawler::D3D12::MIN_THREAD_CACHE_SIZE_CLASS));
+	}
+
+	std::optional<std::uint32_t> GetCurrentThreadIndex()
+	{
+		// Util::Threading::GetThreadLocalResources() has to look the current WorkerThread up in the
+		// WorkerThreadPool, which would cost more than taking a block from a thread cache. A thread's
+		// index never changes, so we only do this once per thread. Threads which are not part of the
+		// WorkerThreadPool do not have an index, and they always go straight to the TLSF heap.
+		thread_local const std::optional<std::uint32_t> currThreadIndex{ [] ()
+		{
+			if (!Util::Threading::IsMainThread() && Util::Threading::GetCurrentWorkerThread() == nullptr)
+				return std::optional<std::uint32_t>{};
+
+			return std::optional<std::uint32_t>{ Util::Threading::GetThreadLocalResources().GetThreadIndex() };
+		}() };
+
+		return currThreadIndex;
+	}
+
+	Brawler::CopyOnWriteVector<Brawler::D3D12::TLSFAllocator*>& GetThreadCachedAllocatorRegistry()
+	{
+		// Allocators are only added to or removed from this when a TLSFAllocator with thread
+		// caching enabled is created or destroyed, but it is iterated over every frame.
+		static Brawler::CopyOnWriteVector<Brawler::D3D12::TLSFAllocator*> allocatorRegistry{};
+		return allocatorRegistry;
+	}
 }
 
 namespace Brawler
 {
 	namespace D3D12
 	{
-		PoolSearchInfo::PoolSearchInfo(const std::size_t sizeInBytes) :
+		PoolSearchInfo::PoolSearchInfo(const std::size_t sizeInBytes, const std::uint32_t sli) :
 			FirstLevelIndex(),
 			SecondLevelIndex()
 		{
@@ -61,9 +107,16 @@ namespace Brawler
 			const std::uint8_t firstLevelIndexResult = _BitScanReverse64(&(reinterpret_cast<unsigned long&>(FirstLevelIndex)), sizeInBytes);
 			assert(firstLevelIndexResult != 0);
 
-			static constexpr std::size_t SLI_MASK = ((static_cast<std::size_t>(1) << SLI) - 1);
-			
-			SecondLevelIndex = static_cast<std::uint32_t>((sizeInBytes >> (static_cast<std::size_t>(FirstLevelIndex) - SLI)) & SLI_MASK);
+			const std::size_t sliMask = ((static_cast<std::size_t>(1) << sli) - 1);
+
+			// Sizes smaller than 2^SLI have fewer than SLI bits after their most significant one,
+			// so we have to shift them to the left, instead. (Shifting to the right by a negative
+			// amount is undefined behavior, and small sub-allocations in a BufferResource are
+			// common.)
+			if (FirstLevelIndex < sli) [[unlikely]]
+				SecondLevelIndex = static_cast<std::uint32_t>((sizeInBytes << (sli - FirstLevelIndex)) & sliMask);
+			else
+				SecondLevelIndex = static_cast<std::uint32_t>((sizeInBytes >> (FirstLevelIndex - sli)) & sliMask);
 		}
 
 		void TLSFAllocatorLevelTwoList::InsertBlock(const PoolSearchInfo searchInfo, TLSFMemoryBlock& block)
@@ -71,10 +124,10 @@ namespace Brawler
 			assert(searchInfo.SecondLevelIndex < mFreeBlockListArr.size());
 			
 			if (mFreeBlockListArr[searchInfo.SecondLevelIndex] != nullptr)
-			{
 				mFreeBlockListArr[searchInfo.SecondLevelIndex]->SetPreviousFreeBlock(&block);
-				block.SetNextFreeBlock(mFreeBlockListArr[searchInfo.SecondLevelIndex]);
-			}
+
+			block.SetPreviousFreeBlock(nullptr);
+			block.SetNextFreeBlock(mFreeBlockListArr[searchInfo.SecondLevelIndex]);
 
 			mFreeBlockListArr[searchInfo.SecondLevelIndex] = &block;
 
@@ -99,6 +152,8 @@ namespace Brawler
 							mFreeBlockListArr[secondLevelIndex]->SetPreviousFreeBlock(nullptr);
 						else
 							mFreePoolBitMask &= ~(static_cast<std::uint32_t>(1) << secondLevelIndex);
+
+						extractedBlockPtr->SetNextFreeBlock(nullptr);
 					}
 					else
 						extractedBlockPtr = nullptr;
@@ -127,17 +182,27 @@ namespace Brawler
 			return extractFreeBlockLambda(*newSecondLevelIndex, allocationInfo);
 		}
 
-		void TLSFAllocatorLevelTwoList::RemoveMergedBlock(const std::uint32_t secondLevelIndex, TLSFMemoryBlock& block)
+		void TLSFAllocatorLevelTwoList::RemoveFreeBlock(const std::uint32_t secondLevelIndex, TLSFMemoryBlock& block)
 		{
-			if (mFreeBlockListArr[secondLevelIndex] == &block)
-			{
-				mFreeBlockListArr[secondLevelIndex] = block.GetNextFreeBlock();
+			TLSFMemoryBlock* const prevFreeBlockPtr = block.GetPreviousFreeBlock();
+			TLSFMemoryBlock* const nextFreeBlockPtr = block.GetNextFreeBlock();
 
-				if (mFreeBlockListArr[secondLevelIndex] != nullptr)
-					mFreeBlockListArr[secondLevelIndex]->SetPreviousFreeBlock(nullptr);
-				else
-					mFreePoolBitMask &= ~(static_cast<std::uint32_t>(1) << secondLevelIndex);
+			if (prevFreeBlockPtr != nullptr)
+				prevFreeBlockPtr->SetNextFreeBlock(nextFreeBlockPtr);
+			else
+			{
+				assert(mFreeBlockListArr[secondLevelIndex] == &block && "ERROR: A TLSFMemoryBlock was removed from a free list which it was not a part of!");
+				mFreeBlockListArr[secondLevelIndex] = nextFreeBlockPtr;
 			}
+
+			if (nextFreeBlockPtr != nullptr)
+				nextFreeBlockPtr->SetPreviousFreeBlock(prevFreeBlockPtr);
+
+			if (mFreeBlockListArr[secondLevelIndex] == nullptr)
+				mFreePoolBitMask &= ~(static_cast<std::uint32_t>(1) << secondLevelIndex);
+
+			block.SetPreviousFreeBlock(nullptr);
+			block.SetNextFreeBlock(nullptr);
 		}
 
 		bool TLSFAllocatorLevelTwoList::HasFreeBlocks() const
@@ -145,8 +210,11 @@ namespace Brawler
 			return (mFreePoolBitMask != 0);
 		}
 
-		void TLSFAllocatorLevelOneList::Initialize(const std::size_t heapSizeInBytes)
+		void TLSFAllocatorLevelOneList::Initialize(const std::size_t heapSizeInBytes, const std::uint32_t sli)
 		{
+			assert(sli >= 1 && sli <= MAX_SLI && "ERROR: An invalid SLI was specified for a TLSFAllocator!");
+			mSLI = sli;
+
 			// From the TLSF whitepaper: FLI = min(log_2(heapSizeInBytes), 32).
 			//
 			// The paper's equation says that 31 is actually the limit, but other parts of
@@ -156,11 +224,12 @@ namespace Brawler
 			const std::uint8_t fliResult = _BitScanReverse64(&(reinterpret_cast<unsigned long&>(fli)), heapSizeInBytes);
 			assert(fliResult != 0);
 
-			mLevelTwoListArr.resize(std::min<std::uint32_t>(fli + 1, 32));
+			mLevelTwoListArr.resize(std::min<std::size_t>(fli + 1, MAX_FIRST_LEVEL_CLASS_COUNT));
 		}
 
-		void TLSFAllocatorLevelOneList::InsertBlock(const PoolSearchInfo searchInfo, TLSFMemoryBlock& block)
+		void TLSFAllocatorLevelOneList::InsertBlock(TLSFMemoryBlock& block)
 		{
+			const PoolSearchInfo searchInfo{ block.GetBlockSize(), mSLI };
 			assert(searchInfo.FirstLevelIndex < mLevelTwoListArr.size());
 
 			mLevelTwoListArr[searchInfo.FirstLevelIndex].InsertBlock(searchInfo, block);
@@ -186,7 +255,7 @@ namespace Brawler
 
 			// First, we try to get a block from the same storage class as is specified by
 			// the required allocation size.
-			PoolSearchInfo searchInfo{ allocationInfo.SizeInBytes };
+			PoolSearchInfo searchInfo{ allocationInfo.SizeInBytes, mSLI };
 			TLSFMemoryBlock* freeBlockPtr = extractFromLevelTwoListLambda(searchInfo, allocationInfo);
 
 			if (freeBlockPtr != nullptr)
@@ -227,11 +296,13 @@ namespace Brawler
 			}
 		}
 
-		void TLSFAllocatorLevelOneList::RemoveMergedBlock(const PoolSearchInfo searchInfo, TLSFMemoryBlock& block)
+		void TLSFAllocatorLevelOneList::RemoveFreeBlock(TLSFMemoryBlock& block)
 		{
-			mLevelTwoListArr[searchInfo.FirstLevelIndex].RemoveMergedBlock(searchInfo.SecondLevelIndex, block);
+			const PoolSearchInfo searchInfo{ block.GetBlockSize(), mSLI };
+
+			mLevelTwoListArr[searchInfo.FirstLevelIndex].RemoveFreeBlock(searchInfo.SecondLevelIndex, block);
 
-			// If necessary, update the bitmask to account for the list which we just extracted a block
+			// If necessary, update the bitmask to account for the list which we just removed a block
 			// from now being empty.
 			if (!mLevelTwoListArr[searchInfo.FirstLevelIndex].HasFreeBlocks())
 				mFreePoolBitMask &= ~(static_cast<std::uint32_t>(1) << searchInfo.FirstLevelIndex);
@@ -242,89 +313,386 @@ namespace Brawler
 			return (mFreePoolBitMask != 0);
 		}
 
-		void TLSFAllocator::Initialize(const std::size_t heapSizeInBytes)
+		TLSFAllocator::TLSFAllocator()
+		{
+			// Make sure that the registry is constructed before this TLSFAllocator, so that it is
+			// destroyed after it.
+			GetThreadCachedAllocatorRegistry();
+		}
+
+		TLSFAllocator::~TLSFAllocator()
 		{
-			mLevelOneList.Initialize(heapSizeInBytes);
+			if (mThreadCacheArr == nullptr)
+				return;
+
+			GetThreadCachedAllocatorRegistry().EraseIf([this] (const TLSFAllocator* const allocatorPtr) { return (allocatorPtr == this); });
+
+			// TLSFAllocator::FlushAllThreadCaches() might still be flushing this TLSFAllocator from
+			// an older snapshot of the registry.
+			Util::EpochReclamation::WaitForReaders();
+		}
+
+		void TLSFAllocator::Initialize(const TLSFAllocatorInitializationInfo& initInfo)
+		{
+			mLevelOneList.Initialize(initInfo.HeapSizeInBytes, initInfo.SLI);
+			mHeapSizeInBytes = initInfo.HeapSizeInBytes;
 
 			// The first block in the heap represents the entire allocated memory range.
-			std::unique_ptr<TLSFMemoryBlock> initialBlock{ std::make_unique<TLSFMemoryBlock>() };
-			initialBlock->SetBlockSize(heapSizeInBytes);
+			TLSFMemoryBlock& initialBlock{ mBlockPool.AcquireBlock() };
+			initialBlock.SetBlockSize(initInfo.HeapSizeInBytes);
+
+			InsertFreeBlock(initialBlock);
+
+			if (initInfo.EnableTraceRecording)
+				mTraceRecorderPtr = std::make_unique<AllocatorTraceRecorder>(initInfo.HeapSizeInBytes);
+
+			if (initInfo.ThreadCacheMode == TLSFThreadCacheMode::ENABLED)
+			{
+				// Like the CommandAllocatorStorage, we create one cache for every thread which could
+				// possibly be a part of the WorkerThreadPool.
+				mThreadCacheCount = std::thread::hardware_concurrency();
+				mThreadCacheArr = std::make_unique<ThreadCache[]>(mThreadCacheCount);
 
-			InsertBlock(*initialBlock);
-			mBlockArr.push_back(std::move(initialBlock));
+				GetThreadCachedAllocatorRegistry().PushBack(this);
+			}
 		}
 
 		Brawler::OptionalRef<TLSFMemoryBlock> TLSFAllocator::CreateAllocation(const TLSFAllocationRequestInfo& allocationInfo)
 		{
-			TLSFMemoryBlock* freeBlockPtr = nullptr;
-			
+			Brawler::OptionalRef<TLSFMemoryBlock> allocatedBlock{};
+
+			if (mThreadCacheArr != nullptr)
+			{
+				const std::optional<std::uint32_t> sizeClassIndex{ GetThreadCacheSizeClassIndex(allocationInfo) };
+				ThreadCache* const threadCachePtr = (sizeClassIndex.has_value() ? GetCurrentThreadCache() : nullptr);
+
+				if (threadCachePtr != nullptr)
+					allocatedBlock = CreateCachedAllocation(*threadCachePtr, *sizeClassIndex, allocationInfo);
+			}
+
+			// If the heap did not have any suitably aligned blocks of the size class left, then
+			// we might still be able to fit an allocation of the exact requested size.
+			if (!allocatedBlock.HasValue())
 			{
 				std::scoped_lock<std::mutex> lock{ mCritSection };
+				allocatedBlock = CreateHeapAllocation(allocationInfo);
 
-				if (!mLevelOneList.HasFreeBlocks())
-					return Brawler::OptionalRef<TLSFMemoryBlock>{};
+				if (!allocatedBlock.HasValue()) [[unlikely]]
+					++mFailedAllocationCount;
 
-				// Try to extract an unused block from the pool. If we get back nullptr, then
-				// this heap is incapable of allocating the resource.
-				freeBlockPtr = mLevelOneList.TryExtractFreeBlock(allocationInfo);
+				// Trace events are recorded while the lock which serialized the operation is still
+				// held. Otherwise, two threads could record their events in the opposite order in
+				// which the heap actually processed them, and a replay of the trace would diverge.
+				if (mTraceRecorderPtr != nullptr) [[unlikely]]
+				{
+					if (allocatedBlock.HasValue())
+						mTraceRecorderPtr->RecordAllocation(&(*allocatedBlock), allocationInfo);
+					else
+						mTraceRecorderPtr->RecordFailedAllocation(allocationInfo);
+				}
+			}
 
-				if (freeBlockPtr == nullptr)
-					return Brawler::OptionalRef<TLSFMemoryBlock>{};
+			return allocatedBlock;
+		}
 
-				// We were able to find a block which can hold this resource. Now, we want to use it as an
-				// allocation. In doing so, we might create up to two additional blocks: possibly one to
-				// the immediate left of freeBlockPtr (for the sake of alignment) and possibly one to its
-				// immediate right (in the event of any free space left in the block).
-				std::vector<std::unique_ptr<TLSFMemoryBlock>> splitBlockArr{ freeBlockPtr->AllocateBlock(allocationInfo) };
+		void TLSFAllocator::DeleteAllocation(TLSFMemoryBlock& memoryBlock)
+		{
+			if (memoryBlock.IsBlockThreadCached())
+			{
+				// The block does not need to go back into the cache of the thread which allocated it.
+				// Any thread's cache will do.
+				ThreadCache* const threadCachePtr = GetCurrentThreadCache();
 
-				for (auto& createdBlock : splitBlockArr)
+				if (threadCachePtr != nullptr)
 				{
-					InsertBlock(*createdBlock);
-					mBlockArr.push_back(std::move(createdBlock));
+					DeleteCachedAllocation(*threadCachePtr, memoryBlock);
+					return;
 				}
 			}
 
-			return Brawler::OptionalRef<TLSFMemoryBlock>{ *freeBlockPtr };
+			std::scoped_lock<std::mutex> lock{ mCritSection };
+
+			// See TLSFAllocator::CreateAllocation(). The deletion also has to be recorded before the
+			// block can be handed out again.
+			if (mTraceRecorderPtr != nullptr) [[unlikely]]
+				mTraceRecorderPtr->RecordDeletion(&memoryBlock);
+
+			DeleteHeapAllocation(memoryBlock);
 		}
 
-		void TLSFAllocator::DeleteAllocation(TLSFMemoryBlock& memoryBlock)
+		void TLSFAllocator::FlushThreadCaches()
 		{
+			for (std::size_t i = 0; i < mThreadCacheCount; ++i)
 			{
-				std::scoped_lock<std::mutex> lock{ mCritSection };
+				ThreadCache& currThreadCache{ mThreadCacheArr[i] };
+
+				// Locks are always taken in this order: first the thread cache's, and then the heap's.
+				std::scoped_lock<std::mutex> threadCacheLock{ currThreadCache.CritSection };
+				std::scoped_lock<std::mutex> heapLock{ mCritSection };
 
-				assert(std::ranges::find_if(mBlockArr, [blockPtr = &memoryBlock] (const std::unique_ptr<TLSFMemoryBlock>& block) { return blockPtr == block.get(); }) != mBlockArr.end() && "ERROR: An attempt was made to return a TLSFMemoryBlock to a TLSFAllocator which did not own it!");
+				for (auto& sizeClass : currThreadCache.SizeClassArr)
+				{
+					for (std::size_t j = 0; j < sizeClass.CachedBlockCount; ++j)
+						DeleteHeapAllocation(*(sizeClass.CachedBlockPtrArr[j]));
 
-				// When we proceed to free the block, we are given a list of up to two blocks which
-				// we can delete from mBlockArr. This is because these blocks were merged into a
-				// different block. Specifically, the two blocks which may be included in the returned
-				// std::vector are the block itself (having been merged into its left neighbor) and
-				// the block's right neighbor (having been merged into either the original block or its
-				// left neighbor).
-				std::vector<TLSFMemoryBlock*> deleteableBlockArr{ memoryBlock.FreeBlock() };
+					sizeClass.CachedBlockCount = 0;
+				}
+			}
+		}
 
-				const bool wasAllocationBlockMerged = (std::ranges::find(deleteableBlockArr, &memoryBlock) != deleteableBlockArr.end());
+		void TLSFAllocator::FlushAllThreadCaches()
+		{
+			GetThreadCachedAllocatorRegistry().ForEach([] (TLSFAllocator* const allocatorPtr)
+			{
+				allocatorPtr->FlushThreadCaches();
+			});
+		}
 
-				for (const auto deleteableBlockPtr : deleteableBlockArr)
+		TLSFAllocator::Statistics TLSFAllocator::GetStatistics() const
+		{
+			// We need to lock every thread cache, and then the heap, to get a consistent view of
+			// the TLSFAllocator. This is the same order in which the locks are taken everywhere else.
+			std::vector<std::unique_lock<std::mutex>> threadCacheLockArr{};
+			threadCacheLockArr.reserve(mThreadCacheCount);
+
+			std::size_t threadCachedBytes = 0;
+			std::size_t threadCachedBlockCount = 0;
+
+			for (std::size_t i = 0; i < mThreadCacheCount; ++i)
+			{
+				ThreadCache& currThreadCache{ mThreadCacheArr[i] };
+				threadCacheLockArr.emplace_back(currThreadCache.CritSection);
+
+				for (std::size_t j = 0; j < currThreadCache.SizeClassArr.size(); ++j)
 				{
-					RemoveMergedBlock(*deleteableBlockPtr);
-					std::erase_if(mBlockArr, [deleteableBlockPtr] (const std::unique_ptr<TLSFMemoryBlock>& block) { return (deleteableBlockPtr == block.get()); });
+					threadCachedBytes += (currThreadCache.SizeClassArr[j].CachedBlockCount * (MIN_THREAD_CACHE_SIZE_CLASS << j));
+					threadCachedBlockCount += currThreadCache.SizeClassArr[j].CachedBlockCount;
 				}
+			}
+
+			std::scoped_lock<std::mutex> heapLock{ mCritSection };
+
+			Statistics statistics{
+				.HeapSizeInBytes = mHeapSizeInBytes,
+				.AllocatedBytes = (mHeapAllocatedBytes - threadCachedBytes),
+				.AllocationCount = (mHeapAllocationCount - threadCachedBlockCount),
+				.ThreadCachedBytes = threadCachedBytes,
+				.FreeBytes = 0,
+				.FreeBlockCount = 0,
+				.FreeBytesPerFirstLevelClass{},
+				.LargestFreeBlockSizeInBytes = 0,
+				.ExternalFragmentationRatio = 0.0f,
+				.TotalAlignmentPaddingBytes = mTotalAlignmentPaddingBytes,
+				.FailedAllocationCount = mFailedAllocationCount
+			};
+
+			mLevelOneList.ForEachFreeBlock([&statistics] (const std::uint32_t firstLevelIndex, const TLSFMemoryBlock& block)
+			{
+				statistics.FreeBytes += block.GetBlockSize();
+				++(statistics.FreeBlockCount);
 
-				// If the original allocation was never merged into an adjacent block, then we add it
-				// to the list.
-				if (!wasAllocationBlockMerged)
-					InsertBlock(memoryBlock);
+				statistics.FreeBytesPerFirstLevelClass[firstLevelIndex] += block.GetBlockSize();
+				statistics.LargestFreeBlockSizeInBytes = std::max(statistics.LargestFreeBlockSizeInBytes, block.GetBlockSize());
+			});
+
+			if (statistics.FreeBytes != 0)
+				statistics.ExternalFragmentationRatio = (1.0f - (static_cast<float>(statistics.LargestFreeBlockSizeInBytes) / static_cast<float>(statistics.FreeBytes)));
+
+			return statistics;
+		}
+
+		AllocatorTrace TLSFAllocator::ExtractTrace()
+		{
+			assert(mTraceRecorderPtr != nullptr && "ERROR: TLSFAllocator::ExtractTrace() was called for a TLSFAllocator which was not recording a trace!");
+			return mTraceRecorderPtr->ExtractTrace();
+		}
+
+		Brawler::OptionalRef<TLSFMemoryBlock> TLSFAllocator::CreateHeapAllocation(const TLSFAllocationRequestInfo& allocationInfo)
+		{
+			// The caller must hold mCritSection.
+
+			if (!mLevelOneList.HasFreeBlocks())
+				return Brawler::OptionalRef<TLSFMemoryBlock>{};
+
+			// Try to extract an unused block from the pool. If we get back nullptr, then
+			// this heap is incapable of allocating the resource.
+			TLSFMemoryBlock* const freeBlockPtr = mLevelOneList.TryExtractFreeBlock(allocationInfo);
+
+			if (freeBlockPtr == nullptr)
+				return Brawler::OptionalRef<TLSFMemoryBlock>{};
+
+			// We were able to find a block which can hold this resource. Now, we want to use it as an
+			// allocation. In doing so, we might split off up to two additional free blocks: possibly
+			// one to the immediate left of the allocation (for the sake of alignment) and possibly one
+			// to its immediate right (in the event of any free space left in the block). The blocks
+			// come from mBlockPool, so this does not touch the heap.
+			TLSFMemoryBlock* allocatedBlockPtr = freeBlockPtr;
+			const std::size_t alignmentAdjustment = freeBlockPtr->CalculateAlignmentAdjustment(allocationInfo);
+
+			if (alignmentAdjustment != 0)
+			{
+				// freeBlockPtr keeps the padding and goes back into the free lists, and the
+				// allocation begins at the aligned offset.
+				TLSFMemoryBlock& alignedBlock{ mBlockPool.AcquireBlock() };
+				freeBlockPtr->SplitBlock(alignedBlock, alignmentAdjustment);
+
+				InsertFreeBlock(*freeBlockPtr);
+				allocatedBlockPtr = &alignedBlock;
+			}
+
+			assert(allocatedBlockPtr->CanBlockAllocateResource(allocationInfo));
+
+			if (allocatedBlockPtr->GetBlockSize() > allocationInfo.SizeInBytes) [[likely]]
+			{
+				TLSFMemoryBlock& remainingSpaceBlock{ mBlockPool.AcquireBlock() };
+				allocatedBlockPtr->SplitBlock(remainingSpaceBlock, allocationInfo.SizeInBytes);
+
+				InsertFreeBlock(remainingSpaceBlock);
+			}
+
+			allocatedBlockPtr->SetFreeStatus(false);
+
+			mHeapAllocatedBytes += allocatedBlockPtr->GetBlockSize();
+			++mHeapAllocationCount;
+			mTotalAlignmentPaddingBytes += alignmentAdjustment;
+
+			return Brawler::OptionalRef<TLSFMemoryBlock>{ *allocatedBlockPtr };
+		}
+
+		void TLSFAllocator::DeleteHeapAllocation(TLSFMemoryBlock& memoryBlock)
+		{
+			// The caller must hold mCritSection.
+
+			if constexpr (Util::General::IsDebugModeEnabled())
+				assert(mBlockPool.IsBlockFromPool(memoryBlock) && "ERROR: An attempt was made to return a TLSFMemoryBlock to a TLSFAllocator which did not own it!");
+
+			assert(!memoryBlock.IsBlockFree() && "ERROR: An attempt was made to free a TLSFMemoryBlock which was not allocated!");
+
+			// Only allocated blocks can be thread cached, and this one is about to become free.
+			memoryBlock.SetThreadCacheStatus(false);
+
+			mHeapAllocatedBytes -= memoryBlock.GetBlockSize();
+			--mHeapAllocationCount;
+
+			// Free blocks are always merged with their free neighbors, so there can be at most one
+			// free block on either side of memoryBlock. Each of them is removed from its free list
+			// and merged with memoryBlock, and the TLSFMemoryBlock which is no longer needed is
+			// returned to the pool. All of this takes constant time.
+			TLSFMemoryBlock* coalescedBlockPtr = &memoryBlock;
+
+			if (TLSFMemoryBlock* const nextBlockPtr = memoryBlock.GetNextPhysicalBlock(); nextBlockPtr != nullptr && nextBlockPtr->IsBlockFree())
+			{
+				RemoveFreeBlock(*nextBlockPtr);
+				memoryBlock.MergeNextPhysicalBlock();
+
+				mBlockPool.ReturnBlock(*nextBlockPtr);
+			}
+
+			if (TLSFMemoryBlock* const prevBlockPtr = memoryBlock.GetPreviousPhysicalBlock(); prevBlockPtr != nullptr && prevBlockPtr->IsBlockFree())
+			{
+				// The previous block's size is about to change, so it has to be removed from the
+				// free list for its current size first.
+				RemoveFreeBlock(*prevBlockPtr);
+				prevBlockPtr->MergeNextPhysicalBlock();
+
+				mBlockPool.ReturnBlock(memoryBlock);
+				coalescedBlockPtr = prevBlockPtr;
 			}
+
+			coalescedBlockPtr->SetFreeStatus(true);
+			InsertFreeBlock(*coalescedBlockPtr);
+		}
+
+		TLSFAllocator::ThreadCache* TLSFAllocator::GetCurrentThreadCache()
+		{
+			const std::optional<std::uint32_t> currThreadIndex{ GetCurrentThreadIndex() };
+
+			if (!currThreadIndex.has_value() || *currThreadIndex >= mThreadCacheCount) [[unlikely]]
+				return nullptr;
+
+			return &(mThreadCacheArr[*currThreadIndex]);
+		}
+
+		Brawler::OptionalRef<TLSFMemoryBlock> TLSFAllocator::CreateCachedAllocation(ThreadCache& threadCache, const std::uint32_t sizeClassIndex, const TLSFAllocationRequestInfo& allocationInfo)
+		{
+			std::scoped_lock<std::mutex> threadCacheLock{ threadCache.CritSection };
+			ThreadCacheSizeClass& sizeClass{ threadCache.SizeClassArr[sizeClassIndex] };
+
+			if (sizeClass.CachedBlockCount == 0)
+			{
+				// Refill the size class with a batch of blocks, so that we only need to take the
+				// heap's lock once for every THREAD_CACHE_BATCH_SIZE allocations.
+				const std::size_t sizeClassSize = (MIN_THREAD_CACHE_SIZE_CLASS << sizeClassIndex);
+				const TLSFAllocationRequestInfo sizeClassRequestInfo{
+					.SizeInBytes = sizeClassSize,
+					.Alignment = sizeClassSize
+				};
+
+				std::scoped_lock<std::mutex> heapLock{ mCritSection };
+
+				while (sizeClass.CachedBlockCount < THREAD_CACHE_BATCH_SIZE)
+				{
+					const Brawler::OptionalRef<TLSFMemoryBlock> refillBlock{ CreateHeapAllocation(sizeClassRequestInfo) };
+
+					if (!refillBlock.HasValue()) [[unlikely]]
+						break;
+
+					refillBlock->SetThreadCacheStatus(true);
+					sizeClass.CachedBlockPtrArr[sizeClass.CachedBlockCount++] = &(*refillBlock);
+				}
+
+				if (sizeClass.CachedBlockCount == 0) [[unlikely]]
+					return Brawler::OptionalRef<TLSFMemoryBlock>{};
+			}
+
+			TLSFMemoryBlock& cachedBlock{ *(sizeClass.CachedBlockPtrArr[--sizeClass.CachedBlockCount]) };
+
+			// Allocations served from a thread cache are recorded under the lock of that cache. (See
+			// TLSFAllocator::CreateAllocation().)
+			if (mTraceRecorderPtr != nullptr) [[unlikely]]
+				mTraceRecorderPtr->RecordAllocation(&cachedBlock, allocationInfo);
+
+			return Brawler::OptionalRef<TLSFMemoryBlock>{ cachedBlock };
+		}
+
+		void TLSFAllocator::DeleteCachedAllocation(ThreadCache& threadCache, TLSFMemoryBlock& memoryBlock)
+		{
+			assert(std::has_single_bit(memoryBlock.GetBlockSize()) && memoryBlock.GetBlockSize() >= MIN_THREAD_CACHE_SIZE_CLASS && memoryBlock.GetBlockSize() <= MAX_THREAD_CACHE_SIZE_CLASS);
+
+			const std::uint32_t sizeClassIndex = static_cast<std::uint32_t>(std::countr_zero(memoryBlock.GetBlockSize()) - std::countr_zero(MIN_THREAD_CACHE_SIZE_CLASS));
+
+			std::scoped_lock<std::mutex> threadCacheLock{ threadCache.CritSection };
+			ThreadCacheSizeClass& sizeClass{ threadCache.SizeClassArr[sizeClassIndex] };
+
+			if (sizeClass.CachedBlockCount == THREAD_CACHE_MAX_BLOCKS_PER_SIZE_CLASS)
+			{
+				// The size class is full, so we return a batch of blocks to the heap. We give back the
+				// ones which have been sitting in the cache the longest and keep the recently freed ones.
+				{
+					std::scoped_lock<std::mutex> heapLock{ mCritSection };
+
+					for (std::size_t i = 0; i < THREAD_CACHE_BATCH_SIZE; ++i)
+						DeleteHeapAllocation(*(sizeClass.CachedBlockPtrArr[i]));
+				}
+
+				std::ranges::copy(std::span<TLSFMemoryBlock* const>{ sizeClass.CachedBlockPtrArr }.subspan(THREAD_CACHE_BATCH_SIZE), sizeClass.CachedBlockPtrArr.begin());
+				sizeClass.CachedBlockCount -= THREAD_CACHE_BATCH_SIZE;
+			}
+
+			if (mTraceRecorderPtr != nullptr) [[unlikely]]
+				mTraceRecorderPtr->RecordDeletion(&memoryBlock);
+
+			sizeClass.CachedBlockPtrArr[sizeClass.CachedBlockCount++] = &memoryBlock;
 		}
 
-		void TLSFAllocator::InsertBlock(TLSFMemoryBlock& block)
+		void TLSFAllocator::InsertFreeBlock(TLSFMemoryBlock& block)
 		{
-			mLevelOneList.InsertBlock(PoolSearchInfo{ block.GetBlockSize() }, block);
+			mLevelOneList.InsertBlock(block);
 		}
 
-		void TLSFAllocator::RemoveMergedBlock(TLSFMemoryBlock& block)
+		void TLSFAllocator::RemoveFreeBlock(TLSFMemoryBlock& block)
 		{
-			mLevelOneList.RemoveMergedBlock(PoolSearchInfo{ block.GetBlockSize() }, block);
+			mLevelOneList.RemoveFreeBlock(block);
 		}
 	}
 }
\ No newline at end of file
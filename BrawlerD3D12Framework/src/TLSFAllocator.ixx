@@ -3,11 +3,16 @@ module;
 #include <array>
 #include <mutex>
 #include <optional>
+#include <memory>
+#include <new>
+#include <cstdint>
 
 export module Brawler.D3D12.TLSFAllocator;
 import Brawler.D3D12.TLSFMemoryBlock;
+import Brawler.D3D12.TLSFMemoryBlockPool;
 import Brawler.OptionalRef;
 import Brawler.D3D12.TLSFAllocationRequestInfo;
+import Brawler.D3D12.AllocatorTrace;
 
 // This is an allocator based off the whitepaper TLSF: A New Dynamic Memory Allocator
 // for Real-Time Systems.
@@ -16,15 +21,41 @@ namespace Brawler
 {
 	namespace D3D12
 	{
-		static constexpr std::size_t SLI = 5; 
-		static constexpr std::size_t SECOND_LEVEL_SUBDIVISIONS = (1 << SLI);
+		// The second-level index (SLI) is the base-2 logarithm of the number of storage classes which
+		// every first-level class is split into. It is chosen at runtime (see
+		// TLSFAllocatorInitializationInfo::SLI), but the free pools of a first-level class are tracked with
+		// a 32-bit mask, so it cannot exceed MAX_SLI. Larger values mean less wasted space in exchange for
+		// more free lists.
+		static constexpr std::uint32_t MAX_SLI = 5;
+		static constexpr std::uint32_t DEFAULT_SLI = 5;
+		static constexpr std::size_t MAX_SECOND_LEVEL_SUBDIVISIONS = (static_cast<std::size_t>(1) << MAX_SLI);
+
+		// The first-level free pools are also tracked with a 32-bit mask, so there are never more
+		// first-level classes than this.
+		static constexpr std::size_t MAX_FIRST_LEVEL_CLASS_COUNT = 32;
+
+		// The thread caches hold blocks for power-of-two size classes in the range
+		// [MIN_THREAD_CACHE_SIZE_CLASS, MAX_THREAD_CACHE_SIZE_CLASS]. Every cached block is aligned
+		// to its own size, so the smallest class already satisfies the 256-byte alignment of constant
+		// buffers, and the largest one covers the 4,096-byte alignment of UAV counters.
+		static constexpr std::size_t MIN_THREAD_CACHE_SIZE_CLASS = 256;
+		static constexpr std::size_t MAX_THREAD_CACHE_SIZE_CLASS = 4096;
+		static constexpr std::size_t THREAD_CACHE_SIZE_CLASS_COUNT = 5;
+
+		static_assert((MIN_THREAD_CACHE_SIZE_CLASS << (THREAD_CACHE_SIZE_CLASS_COUNT - 1)) == MAX_THREAD_CACHE_SIZE_CLASS);
+
+		// A thread cache refills an empty size class with this many blocks at once, and once it holds
+		// THREAD_CACHE_MAX_BLOCKS_PER_SIZE_CLASS blocks of a size class, it returns this many of them to
+		// the heap at once. Either way, the TLSFAllocator's lock is only taken once per batch.
+		static constexpr std::size_t THREAD_CACHE_BATCH_SIZE = 8;
+		static constexpr std::size_t THREAD_CACHE_MAX_BLOCKS_PER_SIZE_CLASS = (THREAD_CACHE_BATCH_SIZE * 2);
 
 		struct PoolSearchInfo
 		{
 			std::uint32_t FirstLevelIndex;
 			std::uint32_t SecondLevelIndex;
 
-			explicit PoolSearchInfo(const std::size_t sizeInBytes);
+			PoolSearchInfo(const std::size_t sizeInBytes, const std::uint32_t sli);
 		};
 
 		class TLSFAllocatorLevelTwoList
@@ -41,13 +72,16 @@ namespace Brawler
 			void InsertBlock(const PoolSearchInfo searchInfo, TLSFMemoryBlock& block);
 			TLSFMemoryBlock* TryExtractFreeBlock(const std::uint32_t secondLevelIndex, const TLSFAllocationRequestInfo& allocationInfo);
 
-			void RemoveMergedBlock(const std::uint32_t secondLevelIndex, TLSFMemoryBlock& block);
+			void RemoveFreeBlock(const std::uint32_t secondLevelIndex, TLSFMemoryBlock& block);
 
 			bool HasFreeBlocks() const;
 
+			template <typename Callback>
+			void ForEachFreeBlock(const Callback& callback) const;
+
 		private:
-			std::array<TLSFMemoryBlock*, SECOND_LEVEL_SUBDIVISIONS> mFreeBlockListArr;
-			std::uint32_t mFreePoolBitMask;
+			std::array<TLSFMemoryBlock*, MAX_SECOND_LEVEL_SUBDIVISIONS> mFreeBlockListArr{};
+			std::uint32_t mFreePoolBitMask = 0;
 		};
 
 		class TLSFAllocatorLevelOneList
@@ -61,18 +95,26 @@ namespace Brawler
 			TLSFAllocatorLevelOneList(TLSFAllocatorLevelOneList&& rhs) noexcept = default;
 			TLSFAllocatorLevelOneList& operator=(TLSFAllocatorLevelOneList&& rhs) noexcept = default;
 
-			void Initialize(const std::size_t heapSizeInBytes);
+			void Initialize(const std::size_t heapSizeInBytes, const std::uint32_t sli);
 			
-			void InsertBlock(const PoolSearchInfo searchInfo, TLSFMemoryBlock& block);
+			void InsertBlock(TLSFMemoryBlock& block);
 			TLSFMemoryBlock* TryExtractFreeBlock(const TLSFAllocationRequestInfo& allocationInfo);
 
-			void RemoveMergedBlock(const PoolSearchInfo searchInfo, TLSFMemoryBlock& block);
+			void RemoveFreeBlock(TLSFMemoryBlock& block);
 
 			bool HasFreeBlocks() const;
 
+			/// <summary>
+			/// Calls callback(firstLevelIndex, block) for every block in the free lists. This takes
+			/// time proportional to the number of free blocks, so it is only meant for diagnostics.
+			/// </summary>
+			template <typename Callback>
+			void ForEachFreeBlock(const Callback& callback) const;
+
 		private:
 			std::vector<TLSFAllocatorLevelTwoList> mLevelTwoListArr;
-			std::uint32_t mFreePoolBitMask;
+			std::uint32_t mFreePoolBitMask = 0;
+			std::uint32_t mSLI = DEFAULT_SLI;
 		};
 	}
 }
@@ -81,30 +123,217 @@ export namespace Brawler
 {
 	namespace D3D12
 	{
+		enum class TLSFThreadCacheMode
+		{
+			DISABLED,
+			ENABLED
+		};
+
+		struct TLSFAllocatorInitializationInfo
+		{
+			std::size_t HeapSizeInBytes;
+			TLSFThreadCacheMode ThreadCacheMode = TLSFThreadCacheMode::DISABLED;
+
+			/// <summary>
+			/// The base-2 logarithm of the number of storage classes which every power-of-two size
+			/// range is split into. This must be in the range [1, 5].
+			/// </summary>
+			std::uint32_t SLI = DEFAULT_SLI;
+
+			/// <summary>
+			/// If this is true, then every allocation request and deletion is recorded, and the
+			/// recorded AllocatorTrace can be retrieved with TLSFAllocator::ExtractTrace(). Such a trace
+			/// can be replayed offline against different configurations (see Tests::ReplayAllocatorTrace()).
+			/// </summary>
+			bool EnableTraceRecording = false;
+		};
+
 		class TLSFAllocator
 		{
 		public:
-			TLSFAllocator() = default;
+			struct Statistics
+			{
+				std::size_t HeapSizeInBytes;
+
+				/// <summary>
+				/// The number of bytes which are in use by allocations. Blocks held by the thread
+				/// caches are not counted here.
+				/// </summary>
+				std::size_t AllocatedBytes;
+				std::size_t AllocationCount;
+
+				/// <summary>
+				/// The number of bytes in blocks which the thread caches have taken from the heap,
+				/// but which are not currently in use.
+				/// </summary>
+				std::size_t ThreadCachedBytes;
+
+				std::size_t FreeBytes;
+				std::size_t FreeBlockCount;
+
+				/// <summary>
+				/// The number of free bytes in blocks of each first-level class. The blocks in
+				/// FreeBytesPerFirstLevelClass[i] are in the size range [2^i, 2^(i + 1)).
+				/// </summary>
+				std::array<std::size_t, MAX_FIRST_LEVEL_CLASS_COUNT> FreeBytesPerFirstLevelClass;
+
+				std::size_t LargestFreeBlockSizeInBytes;
+
+				/// <summary>
+				/// This is 1 - (LargestFreeBlockSizeInBytes / FreeBytes), or 0 if there are no free
+				/// bytes. It is 0 if all of the free memory is in one contiguous block, and it
+				/// approaches 1 as the free memory is split into more and more small blocks.
+				/// </summary>
+				float ExternalFragmentationRatio;
+
+				/// <summary>
+				/// The total number of bytes which allocations have skipped over to satisfy their
+				/// alignment requirements since the TLSFAllocator was initialized. These bytes are left
+				/// in the free lists, but they are often too small to be used by anything else. With the
+				/// 4,096-byte alignment of UAV counters, this is a major source of fragmentation.
+				/// </summary>
+				std::uint64_t TotalAlignmentPaddingBytes;
+
+				/// <summary>
+				/// The number of calls to TLSFAllocator::CreateAllocation() which failed.
+				/// </summary>
+				std::uint64_t FailedAllocationCount;
+			};
+
+		private:
+			struct ThreadCacheSizeClass
+			{
+				std::array<TLSFMemoryBlock*, THREAD_CACHE_MAX_BLOCKS_PER_SIZE_CLASS> CachedBlockPtrArr;
+				std::size_t CachedBlockCount;
+			};
+
+			struct alignas(std::hardware_destructive_interference_size) ThreadCache
+			{
+				std::array<ThreadCacheSizeClass, THREAD_CACHE_SIZE_CLASS_COUNT> SizeClassArr{};
+
+				// This is only ever contended when some other thread calls TLSFAllocator::FlushThreadCaches().
+				std::mutex CritSection;
+			};
+
+		public:
+			TLSFAllocator();
+			~TLSFAllocator();
 
 			TLSFAllocator(const TLSFAllocator& rhs) = delete;
 			TLSFAllocator& operator=(const TLSFAllocator& rhs) = delete;
 
-			TLSFAllocator(TLSFAllocator&& rhs) noexcept = default;
-			TLSFAllocator& operator=(TLSFAllocator&& rhs) noexcept = default;
+			// TLSFAllocators with thread caching enabled are registered by their address, so that
+			// their caches can be flushed at the end of every frame.
+			TLSFAllocator(TLSFAllocator&& rhs) noexcept = delete;
+			TLSFAllocator& operator=(TLSFAllocator&& rhs) noexcept = delete;
 
-			void Initialize(const std::size_t heapSizeInBytes);
+			/// <summary>
+			/// Initializes the TLSFAllocator so that it manages a heap of initInfo.HeapSizeInBytes bytes.
+			/// 
+			/// If initInfo.ThreadCacheMode is TLSFThreadCacheMode::ENABLED, then every thread of the
+			/// WorkerThreadPool (including the main thread) gets its own cache of small blocks in front
+			/// of the TLSF heap. Small allocations whose alignment does not exceed MAX_THREAD_CACHE_SIZE_CLASS
+			/// are then served from, and returned to, the calling thread's cache without taking the lock
+			/// which protects the heap. The cost is that such allocations are rounded up to a power of two,
+			/// and that blocks sitting in a thread cache cannot be used by other threads or merged with their
+			/// neighbors until TLSFAllocator::FlushThreadCaches() is called. Such a TLSFAllocator is flushed
+			/// automatically at the end of every frame by TLSFAllocator::FlushAllThreadCaches().
+			/// </summary>
+			void Initialize(const TLSFAllocatorInitializationInfo& initInfo);
 
 			Brawler::OptionalRef<TLSFMemoryBlock> CreateAllocation(const TLSFAllocationRequestInfo& allocationInfo);
 			void DeleteAllocation(TLSFMemoryBlock& memoryBlock);
 
+			/// <summary>
+			/// Returns every block held in the thread caches to the TLSF heap, where it can be merged
+			/// with its neighbors. This should be done periodically (e.g., at the end of every frame) if
+			/// thread caching is enabled, since the caches otherwise keep the heap fragmented. Blocks
+			/// which are in use by sub-allocations are unaffected.
+			/// 
+			/// It is safe to call this function while other threads are allocating from or returning
+			/// blocks to this TLSFAllocator. If thread caching is disabled, then this does nothing.
+			/// </summary>
+			void FlushThreadCaches();
+
+			/// <summary>
+			/// Calls TLSFAllocator::FlushThreadCaches() for every TLSFAllocator which has thread caching
+			/// enabled. The Renderer calls this at the end of every frame, which keeps the fragmentation
+			/// caused by the thread caches bounded to what a single frame's worth of allocations can
+			/// leave behind.
+			/// </summary>
+			static void FlushAllThreadCaches();
+
+			/// <summary>
+			/// Describes how much of the heap is in use and how fragmented its free space is. This
+			/// has to walk the free lists, so it is meant for diagnostics and heap sizing, rather
+			/// than for being called every frame.
+			/// </summary>
+			Statistics GetStatistics() const;
+
+			/// <summary>
+			/// Returns every event which was recorded since the TLSFAllocator was initialized or
+			/// since the last call to this function. Recording continues afterwards. This can only
+			/// be called if the TLSFAllocator was initialized with
+			/// TLSFAllocatorInitializationInfo::EnableTraceRecording set to true.
+			/// </summary>
+			AllocatorTrace ExtractTrace();
+
 		private:
-			void InsertBlock(TLSFMemoryBlock& block);
-			void RemoveMergedBlock(TLSFMemoryBlock& block);
+			Brawler::OptionalRef<TLSFMemoryBlock> CreateHeapAllocation(const TLSFAllocationRequestInfo& allocationInfo);
+			void DeleteHeapAllocation(TLSFMemoryBlock& memoryBlock);
+
+			ThreadCache* GetCurrentThreadCache();
+			Brawler::OptionalRef<TLSFMemoryBlock> CreateCachedAllocation(ThreadCache& threadCache, const std::uint32_t sizeClassIndex, const TLSFAllocationRequestInfo& allocationInfo);
+			void DeleteCachedAllocation(ThreadCache& threadCache, TLSFMemoryBlock& memoryBlock);
+
+			void InsertFreeBlock(TLSFMemoryBlock& block);
+			void RemoveFreeBlock(TLSFMemoryBlock& block);
 
 		private:
-			std::vector<std::unique_ptr<TLSFMemoryBlock>> mBlockArr;
+			TLSFMemoryBlockPool mBlockPool;
 			TLSFAllocatorLevelOneList mLevelOneList;
+
+			// This is nullptr if thread caching is disabled. Otherwise, it has mThreadCacheCount
+			// elements, and it is indexed by ThreadLocalResources::GetThreadIndex().
+			std::unique_ptr<ThreadCache[]> mThreadCacheArr;
+			std::size_t mThreadCacheCount = 0;
+
+			// This is nullptr unless trace recording is enabled.
+			std::unique_ptr<AllocatorTraceRecorder> mTraceRecorderPtr;
+
+			// These are protected by mCritSection.
+			std::size_t mHeapSizeInBytes = 0;
+			std::size_t mHeapAllocatedBytes = 0;
+			std::size_t mHeapAllocationCount = 0;
+			std::uint64_t mTotalAlignmentPaddingBytes = 0;
+			std::uint64_t mFailedAllocationCount = 0;
+
 			mutable std::mutex mCritSection;
 		};
 	}
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+namespace Brawler
+{
+	namespace D3D12
+	{
+		template <typename Callback>
+		void TLSFAllocatorLevelTwoList::ForEachFreeBlock(const Callback& callback) const
+		{
+			for (const TLSFMemoryBlock* currBlockPtr : mFreeBlockListArr)
+			{
+				for (; currBlockPtr != nullptr; currBlockPtr = currBlockPtr->GetNextFreeBlock())
+					callback(*currBlockPtr);
+			}
+		}
+
+		template <typename Callback>
+		void TLSFAllocatorLevelOneList::ForEachFreeBlock(const Callback& callback) const
+		{
+			for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(mLevelTwoListArr.size()); ++i)
+				mLevelTwoListArr[i].ForEachFreeBlock([&callback, i] (const TLSFMemoryBlock& block) { callback(i, block); });
+		}
+	}
 }
\ No newline at end of file
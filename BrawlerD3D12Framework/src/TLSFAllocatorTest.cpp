@@ -0,0 +1,407 @@
+module;
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <array>
+#include <iostream>
+#include <random>
+#include <iterator>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <numeric>
+#include <filesystem>
+#include <span>
+
+module Tests.TLSFAllocatorTest;
+import Brawler.D3D12.TLSFAllocator;
+import Brawler.D3D12.TLSFMemoryBlock;
+import Brawler.D3D12.TLSFAllocationRequestInfo;
+import Brawler.D3D12.AllocatorTrace;
+import Brawler.OptionalRef;
+import Brawler.Timer;
+import Brawler.JobSystem;
+
+namespace
+{
+	// DISCLAIMER: Just like the job system tests in the Brawler Engine, the timings here are not
+	// rigorous benchmarks. They are meant to catch regressions in the TLSFAllocator.
+
+	constexpr std::size_t HEAP_SIZE = (static_cast<std::size_t>(1) << 30);
+	constexpr std::size_t VALIDATION_OPERATION_COUNT = 200000;
+	constexpr std::size_t VALIDATION_MAX_LIVE_ALLOCATION_COUNT = 4096;
+	constexpr std::array<std::uint32_t, 2> VALIDATION_SLI_ARR{ 2, 5 };
+
+	constexpr std::array<std::size_t, 3> LIVE_ALLOCATION_COUNT_ARR{ 1000, 10000, 50000 };
+	constexpr std::size_t CHURN_OPERATION_COUNT = 500000;
+
+	// Constant buffer views need 256-byte alignment, and UAV counters need 4,096-byte alignment.
+	// Everything else which we put into buffers is only aligned to the size of its elements.
+	constexpr std::array<std::size_t, 4> ALIGNMENT_ARR{ 4, 16, 256, 4096 };
+
+	// The thread cache tests run one job per thread, and each of these jobs churns through
+	// constant buffer-sized allocations on its own. This is the workload which the thread caches
+	// were made for.
+	constexpr std::size_t THREAD_CACHE_HEAP_SIZE = (static_cast<std::size_t>(1) << 26);
+	constexpr std::size_t THREAD_CACHE_OPERATION_COUNT_PER_JOB = 100000;
+	constexpr std::size_t THREAD_CACHE_LIVE_ALLOCATION_COUNT_PER_JOB = 256;
+
+	// Every allocation made in the thread cache tests has this alignment, so we can track which
+	// job owns which part of the heap in units of this size.
+	constexpr std::size_t CONSTANT_BUFFER_ALIGNMENT = 256;
+
+	class RandomAllocationRequestGenerator
+	{
+	public:
+		explicit RandomAllocationRequestGenerator(const std::uint32_t seed) :
+			mRandomEngine(seed),
+			mSizeExponentDistribution(2, 16),
+			mAlignmentIndexDistribution(0, ALIGNMENT_ARR.size() - 1)
+		{}
+
+		Brawler::D3D12::TLSFAllocationRequestInfo CreateRequest()
+		{
+			// Most sub-allocations are small, so we pick the size from a log-uniform distribution
+			// between 4 bytes and 64KB.
+			const std::size_t sizeExponent = mSizeExponentDistribution(mRandomEngine);
+			const std::size_t sizeInBytes = std::uniform_int_distribution<std::size_t>{ (static_cast<std::size_t>(1) << sizeExponent), (static_cast<std::size_t>(1) << (sizeExponent + 1)) }(mRandomEngine);
+
+			return Brawler::D3D12::TLSFAllocationRequestInfo{
+				.SizeInBytes = sizeInBytes,
+				.Alignment = ALIGNMENT_ARR[mAlignmentIndexDistribution(mRandomEngine)]
+			};
+		}
+
+		Brawler::D3D12::TLSFAllocationRequestInfo CreateConstantBufferRequest()
+		{
+			return Brawler::D3D12::TLSFAllocationRequestInfo{
+				.SizeInBytes = std::uniform_int_distribution<std::size_t>{ 16, 2048 }(mRandomEngine),
+				.Alignment = CONSTANT_BUFFER_ALIGNMENT
+			};
+		}
+
+		std::size_t GetRandomIndex(const std::size_t maxIndex)
+		{
+			return std::uniform_int_distribution<std::size_t>{ 0, maxIndex }(mRandomEngine);
+		}
+
+	private:
+		std::mt19937 mRandomEngine;
+		std::uniform_int_distribution<std::size_t> mSizeExponentDistribution;
+		std::uniform_int_distribution<std::size_t> mAlignmentIndexDistribution;
+	};
+
+	void VerifyHeapIsCoalesced(Brawler::D3D12::TLSFAllocator& allocator, const std::size_t heapSizeInBytes)
+	{
+		// If every free block was merged with its neighbors, then the heap consists of a single
+		// block again, and we can allocate all of it at once.
+		Brawler::OptionalRef<Brawler::D3D12::TLSFMemoryBlock> entireHeapBlock{ allocator.CreateAllocation(Brawler::D3D12::TLSFAllocationRequestInfo{
+			.SizeInBytes = heapSizeInBytes,
+			.Alignment = 1
+		}) };
+
+		assert(entireHeapBlock.HasValue() && entireHeapBlock->GetHeapOffset() == 0 && "ERROR: The TLSFAllocator did not merge all of its free blocks after every allocation was deleted!");
+		allocator.DeleteAllocation(*entireHeapBlock);
+	}
+
+	void VerifyStatistics(const Brawler::D3D12::TLSFAllocator& allocator, const std::span<Brawler::D3D12::TLSFMemoryBlock* const> liveBlockPtrSpan)
+	{
+		const Brawler::D3D12::TLSFAllocator::Statistics statistics{ allocator.GetStatistics() };
+
+		[[maybe_unused]] std::size_t liveBytes = 0;
+
+		for (const auto blockPtr : liveBlockPtrSpan)
+			liveBytes += blockPtr->GetBlockSize();
+
+		assert(statistics.AllocatedBytes == liveBytes && statistics.AllocationCount == liveBlockPtrSpan.size() && "ERROR: The TLSFAllocator::Statistics did not match the live allocations!");
+		assert((statistics.AllocatedBytes + statistics.ThreadCachedBytes + statistics.FreeBytes) == statistics.HeapSizeInBytes && "ERROR: The TLSFAllocator::Statistics did not account for every byte of the heap!");
+		assert(std::accumulate(statistics.FreeBytesPerFirstLevelClass.begin(), statistics.FreeBytesPerFirstLevelClass.end(), static_cast<std::size_t>(0)) == statistics.FreeBytes);
+		assert(statistics.LargestFreeBlockSizeInBytes <= statistics.FreeBytes && statistics.ExternalFragmentationRatio >= 0.0f && statistics.ExternalFragmentationRatio < 1.0f);
+	}
+
+	void VerifyTraceSerialization(const Brawler::D3D12::AllocatorTrace& trace)
+	{
+		const std::filesystem::path traceFilePath{ std::filesystem::temp_directory_path() / "TLSFAllocatorTest.trace" };
+		trace.SerializeToFile(traceFilePath);
+
+		const Brawler::D3D12::AllocatorTrace deserializedTrace{ Brawler::D3D12::AllocatorTrace::DeserializeFromFile(traceFilePath) };
+		std::filesystem::remove(traceFilePath);
+
+		assert(deserializedTrace.GetHeapSize() == trace.GetHeapSize() && deserializedTrace.GetEvents().size() == trace.GetEvents().size());
+		assert(std::ranges::equal(deserializedTrace.GetEvents(), trace.GetEvents(), [] (const Brawler::D3D12::AllocatorTraceEvent& lhs, const Brawler::D3D12::AllocatorTraceEvent& rhs)
+		{
+			return (lhs.AllocationID == rhs.AllocationID && lhs.SizeInBytes == rhs.SizeInBytes && lhs.Alignment == rhs.Alignment && lhs.Type == rhs.Type);
+		}) && "ERROR: An AllocatorTrace was changed by serializing and deserializing it!");
+	}
+
+	void RunValidationTest(const std::uint32_t sli)
+	{
+		Brawler::D3D12::TLSFAllocator allocator{};
+		allocator.Initialize(Brawler::D3D12::TLSFAllocatorInitializationInfo{
+			.HeapSizeInBytes = HEAP_SIZE,
+			.SLI = sli,
+			.EnableTraceRecording = true
+		});
+
+		RandomAllocationRequestGenerator requestGenerator{ 1 };
+		std::vector<Brawler::D3D12::TLSFMemoryBlock*> liveBlockPtrArr{};
+
+		// This maps the offset of every live allocation to the offset of its end.
+		std::map<std::size_t, std::size_t> allocatedRangeMap{};
+
+		const auto freeRandomAllocationLambda = [&] ()
+		{
+			const std::size_t freedIndex = requestGenerator.GetRandomIndex(liveBlockPtrArr.size() - 1);
+			Brawler::D3D12::TLSFMemoryBlock* const freedBlockPtr = liveBlockPtrArr[freedIndex];
+
+			allocatedRangeMap.erase(freedBlockPtr->GetHeapOffset());
+			allocator.DeleteAllocation(*freedBlockPtr);
+
+			liveBlockPtrArr[freedIndex] = liveBlockPtrArr.back();
+			liveBlockPtrArr.pop_back();
+		};
+
+		for (std::size_t i = 0; i < VALIDATION_OPERATION_COUNT; ++i)
+		{
+			if (!liveBlockPtrArr.empty() && (liveBlockPtrArr.size() == VALIDATION_MAX_LIVE_ALLOCATION_COUNT || requestGenerator.GetRandomIndex(1) == 0))
+			{
+				freeRandomAllocationLambda();
+				continue;
+			}
+
+			const Brawler::D3D12::TLSFAllocationRequestInfo requestInfo{ requestGenerator.CreateRequest() };
+			Brawler::OptionalRef<Brawler::D3D12::TLSFMemoryBlock> allocatedBlock{ allocator.CreateAllocation(requestInfo) };
+
+			assert(allocatedBlock.HasValue() && "ERROR: The TLSFAllocator failed to allocate a block from a heap which was nowhere near full!");
+
+			const std::size_t heapOffset = allocatedBlock->GetHeapOffset();
+			const std::size_t endOffset = (heapOffset + allocatedBlock->GetBlockSize());
+
+			assert((heapOffset % requestInfo.Alignment) == 0 && "ERROR: The TLSFAllocator returned a block which was not properly aligned!");
+			assert(allocatedBlock->GetBlockSize() >= requestInfo.SizeInBytes && endOffset <= HEAP_SIZE);
+
+			// Make sure that the new allocation does not overlap with its neighbors.
+			const auto nextRangeItr = allocatedRangeMap.lower_bound(heapOffset);
+			assert((nextRangeItr == allocatedRangeMap.end() || nextRangeItr->first >= endOffset) && "ERROR: The TLSFAllocator returned a block which overlapped with another live allocation!");
+			assert((nextRangeItr == allocatedRangeMap.begin() || std::prev(nextRangeItr)->second <= heapOffset) && "ERROR: The TLSFAllocator returned a block which overlapped with another live allocation!");
+
+			allocatedRangeMap.emplace(heapOffset, endOffset);
+			liveBlockPtrArr.push_back(&(*allocatedBlock));
+
+			if ((i % 8192) == 0)
+				VerifyStatistics(allocator, std::span<Brawler::D3D12::TLSFMemoryBlock* const>{ liveBlockPtrArr });
+		}
+
+		while (!liveBlockPtrArr.empty())
+			freeRandomAllocationLambda();
+
+		VerifyStatistics(allocator, std::span<Brawler::D3D12::TLSFMemoryBlock* const>{});
+		VerifyHeapIsCoalesced(allocator, HEAP_SIZE);
+
+		// Every allocation has a matching deletion in the trace, including the one made by
+		// VerifyHeapIsCoalesced().
+		const Brawler::D3D12::AllocatorTrace trace{ allocator.ExtractTrace() };
+
+		[[maybe_unused]] const std::size_t allocationEventCount = static_cast<std::size_t>(std::ranges::count(trace.GetEvents(), Brawler::D3D12::AllocatorTraceEventType::ALLOCATION, &Brawler::D3D12::AllocatorTraceEvent::Type));
+		assert((allocationEventCount * 2) == trace.GetEvents().size() && "ERROR: The TLSFAllocator did not record every allocation and deletion in its AllocatorTrace!");
+
+		VerifyTraceSerialization(trace);
+
+		std::cout << "TLSFAllocator validation test passed (SLI " << sli << ")." << std::endl;
+	}
+
+	void RunThreadCacheChurnJob(Brawler::D3D12::TLSFAllocator& allocator, const std::uint32_t jobIndex, std::atomic<std::uint32_t>* const granuleOwnerArr)
+	{
+		RandomAllocationRequestGenerator requestGenerator{ jobIndex + 3 };
+		std::vector<Brawler::D3D12::TLSFMemoryBlock*> liveBlockPtrArr{};
+		liveBlockPtrArr.reserve(THREAD_CACHE_LIVE_ALLOCATION_COUNT_PER_JOB);
+
+		// If granuleOwnerArr is not nullptr, then we record which job owns every
+		// CONSTANT_BUFFER_ALIGNMENT-sized granule of the heap. Finding a granule which is already
+		// owned by somebody else means that the TLSFAllocator handed the same memory out twice.
+		const auto claimBlockLambda = [granuleOwnerArr, jobIndex] (const Brawler::D3D12::TLSFMemoryBlock& block, const bool isClaiming)
+		{
+			if (granuleOwnerArr == nullptr)
+				return;
+
+			const std::size_t beginGranule = (block.GetHeapOffset() / CONSTANT_BUFFER_ALIGNMENT);
+			const std::size_t endGranule = ((block.GetHeapOffset() + block.GetBlockSize() + CONSTANT_BUFFER_ALIGNMENT - 1) / CONSTANT_BUFFER_ALIGNMENT);
+
+			for (std::size_t i = beginGranule; i < endGranule; ++i)
+			{
+				std::uint32_t expectedOwner = (isClaiming ? 0 : (jobIndex + 1));
+				[[maybe_unused]] const bool ownershipChanged = granuleOwnerArr[i].compare_exchange_strong(expectedOwner, (isClaiming ? (jobIndex + 1) : 0), std::memory_order::relaxed);
+
+				assert(ownershipChanged && "ERROR: The TLSFAllocator returned a block which overlapped with another live allocation!");
+			}
+		};
+
+		const auto createAllocationLambda = [&] ()
+		{
+			const Brawler::D3D12::TLSFAllocationRequestInfo requestInfo{ requestGenerator.CreateConstantBufferRequest() };
+			Brawler::OptionalRef<Brawler::D3D12::TLSFMemoryBlock> allocatedBlock{ allocator.CreateAllocation(requestInfo) };
+
+			assert(allocatedBlock.HasValue());
+			assert((allocatedBlock->GetHeapOffset() % requestInfo.Alignment) == 0 && "ERROR: The TLSFAllocator returned a block which was not properly aligned!");
+			assert(allocatedBlock->GetBlockSize() >= requestInfo.SizeInBytes);
+
+			claimBlockLambda(*allocatedBlock, true);
+			return &(*allocatedBlock);
+		};
+
+		const auto deleteAllocationLambda = [&] (Brawler::D3D12::TLSFMemoryBlock& block)
+		{
+			claimBlockLambda(block, false);
+			allocator.DeleteAllocation(block);
+		};
+
+		for (std::size_t i = 0; i < THREAD_CACHE_LIVE_ALLOCATION_COUNT_PER_JOB; ++i)
+			liveBlockPtrArr.push_back(createAllocationLambda());
+
+		for (std::size_t i = 0; i < THREAD_CACHE_OPERATION_COUNT_PER_JOB; ++i)
+		{
+			Brawler::D3D12::TLSFMemoryBlock*& replacedBlockPtr{ liveBlockPtrArr[requestGenerator.GetRandomIndex(THREAD_CACHE_LIVE_ALLOCATION_COUNT_PER_JOB - 1)] };
+			deleteAllocationLambda(*replacedBlockPtr);
+
+			replacedBlockPtr = createAllocationLambda();
+
+			// While validating, the first job also flushes the thread caches every now and then, so
+			// that flushes happen while the other jobs are still allocating. This goes through the
+			// same path as the flush at the end of every frame.
+			if (granuleOwnerArr != nullptr && jobIndex == 0 && (i % 4096) == 0)
+				Brawler::D3D12::TLSFAllocator::FlushAllThreadCaches();
+		}
+
+		for (const auto blockPtr : liveBlockPtrArr)
+			deleteAllocationLambda(*blockPtr);
+	}
+
+	void RunThreadCacheChurnJobs(Brawler::D3D12::TLSFAllocator& allocator, const std::uint32_t jobCount, std::atomic<std::uint32_t>* const granuleOwnerArr)
+	{
+		Brawler::JobGroup churnGroup{};
+		churnGroup.Reserve(jobCount);
+
+		for (std::uint32_t i = 0; i < jobCount; ++i)
+			churnGroup.AddJob([&allocator, i, granuleOwnerArr] () { RunThreadCacheChurnJob(allocator, i, granuleOwnerArr); });
+
+		churnGroup.ExecuteJobs();
+	}
+
+	void RunThreadCacheValidationTest()
+	{
+		Brawler::D3D12::TLSFAllocator allocator{};
+		allocator.Initialize(Brawler::D3D12::TLSFAllocatorInitializationInfo{
+			.HeapSizeInBytes = THREAD_CACHE_HEAP_SIZE,
+			.ThreadCacheMode = Brawler::D3D12::TLSFThreadCacheMode::ENABLED
+		});
+
+		const std::unique_ptr<std::atomic<std::uint32_t>[]> granuleOwnerArr{ std::make_unique<std::atomic<std::uint32_t>[]>(THREAD_CACHE_HEAP_SIZE / CONSTANT_BUFFER_ALIGNMENT) };
+		RunThreadCacheChurnJobs(allocator, std::max(std::thread::hardware_concurrency(), 1u), granuleOwnerArr.get());
+
+		// Every allocation has been deleted, but the thread caches still hold on to some of the
+		// memory until they are flushed.
+		allocator.FlushThreadCaches();
+
+		VerifyStatistics(allocator, std::span<Brawler::D3D12::TLSFMemoryBlock* const>{});
+		VerifyHeapIsCoalesced(allocator, THREAD_CACHE_HEAP_SIZE);
+
+		std::cout << "TLSFAllocator thread cache validation test passed." << std::endl;
+	}
+
+	void RunThreadCacheBenchmark(const Brawler::D3D12::TLSFThreadCacheMode threadCacheMode)
+	{
+		Brawler::D3D12::TLSFAllocator allocator{};
+		allocator.Initialize(Brawler::D3D12::TLSFAllocatorInitializationInfo{
+			.HeapSizeInBytes = THREAD_CACHE_HEAP_SIZE,
+			.ThreadCacheMode = threadCacheMode
+		});
+
+		const std::uint32_t jobCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+		Brawler::Timer t{};
+		t.Start();
+
+		RunThreadCacheChurnJobs(allocator, jobCount, nullptr);
+
+		t.Stop();
+
+		const float nanosecondsPerOperation = ((t.GetElapsedTimeInMilliseconds() * 1000000.0f) / static_cast<float>(THREAD_CACHE_OPERATION_COUNT_PER_JOB * 2));
+		std::cout << "TLSFAllocator Parallel Churn (" << jobCount << " Jobs, Thread Caches " << (threadCacheMode == Brawler::D3D12::TLSFThreadCacheMode::ENABLED ? "Enabled" : "Disabled") << "): " << nanosecondsPerOperation << " ns of wall time per allocation or deletion in each job" << std::endl;
+
+		allocator.FlushThreadCaches();
+	}
+
+	void RunChurnBenchmark(const std::size_t liveAllocationCount)
+	{
+		Brawler::D3D12::TLSFAllocator allocator{};
+		allocator.Initialize(Brawler::D3D12::TLSFAllocatorInitializationInfo{
+			.HeapSizeInBytes = HEAP_SIZE
+		});
+
+		RandomAllocationRequestGenerator requestGenerator{ 2 };
+		std::vector<Brawler::D3D12::TLSFMemoryBlock*> liveBlockPtrArr{};
+		liveBlockPtrArr.reserve(liveAllocationCount);
+
+		for (std::size_t i = 0; i < liveAllocationCount; ++i)
+		{
+			Brawler::OptionalRef<Brawler::D3D12::TLSFMemoryBlock> allocatedBlock{ allocator.CreateAllocation(requestGenerator.CreateRequest()) };
+			assert(allocatedBlock.HasValue());
+
+			liveBlockPtrArr.push_back(&(*allocatedBlock));
+		}
+
+		// The requests are generated up front so that we only time the TLSFAllocator.
+		std::vector<Brawler::D3D12::TLSFAllocationRequestInfo> requestInfoArr{};
+		std::vector<std::size_t> freedIndexArr{};
+		requestInfoArr.reserve(CHURN_OPERATION_COUNT);
+		freedIndexArr.reserve(CHURN_OPERATION_COUNT);
+
+		for (std::size_t i = 0; i < CHURN_OPERATION_COUNT; ++i)
+		{
+			requestInfoArr.push_back(requestGenerator.CreateRequest());
+			freedIndexArr.push_back(requestGenerator.GetRandomIndex(liveAllocationCount - 1));
+		}
+
+		Brawler::Timer t{};
+		t.Start();
+
+		// Every iteration frees a random live allocation and replaces it with a new one, just
+		// like per-frame constant buffer sub-allocations do.
+		for (std::size_t i = 0; i < CHURN_OPERATION_COUNT; ++i)
+		{
+			Brawler::D3D12::TLSFMemoryBlock*& replacedBlockPtr{ liveBlockPtrArr[freedIndexArr[i]] };
+			allocator.DeleteAllocation(*replacedBlockPtr);
+
+			Brawler::OptionalRef<Brawler::D3D12::TLSFMemoryBlock> allocatedBlock{ allocator.CreateAllocation(requestInfoArr[i]) };
+			assert(allocatedBlock.HasValue());
+
+			replacedBlockPtr = &(*allocatedBlock);
+		}
+
+		t.Stop();
+
+		const float nanosecondsPerOperation = ((t.GetElapsedTimeInMilliseconds() * 1000000.0f) / static_cast<float>(CHURN_OPERATION_COUNT * 2));
+		std::cout << "TLSFAllocator Churn (" << liveAllocationCount << " Live Allocations): " << nanosecondsPerOperation << " ns per allocation or deletion" << std::endl;
+
+		for (const auto blockPtr : liveBlockPtrArr)
+			allocator.DeleteAllocation(*blockPtr);
+	}
+}
+
+namespace Tests
+{
+	void RunTLSFAllocatorTests()
+	{
+		for (const auto sli : VALIDATION_SLI_ARR)
+			RunValidationTest(sli);
+
+		for (const auto liveAllocationCount : LIVE_ALLOCATION_COUNT_ARR)
+			RunChurnBenchmark(liveAllocationCount);
+
+		RunThreadCacheValidationTest();
+		RunThreadCacheBenchmark(Brawler::D3D12::TLSFThreadCacheMode::DISABLED);
+		RunThreadCacheBenchmark(Brawler::D3D12::TLSFThreadCacheMode::ENABLED);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+module;
+
+export module Tests.TLSFAllocatorTest;
+
+export namespace Tests
+{
+	/// <summary>
+	/// Allocates and frees blocks of random sizes and alignments with a Brawler::D3D12::TLSFAllocator.
+	/// The function checks that no two live allocations ever overlap, that the free blocks are
+	/// coalesced back into a single block once everything has been freed, that the
+	/// TLSFAllocator::Statistics account for every byte of the heap, and that the recorded
+	/// AllocatorTrace survives a round trip through a file. It then measures how
+	/// long allocations and deletions take with tens of thousands of live allocations, which is
+	/// what a BufferSubAllocationManager for a large upload or constant buffer has to deal with.
+	/// 
+	/// Afterwards, the same checks are made while one job per thread allocates and frees
+	/// constant buffer-sized blocks concurrently, with and without the TLSFAllocator's thread
+	/// caches. This part dispatches jobs, so the WorkerThreadPool must already be running.
+	/// </summary>
+	void RunTLSFAllocatorTests();
+}
\ No newline at end of file
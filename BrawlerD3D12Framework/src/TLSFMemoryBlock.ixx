@@ -1,6 +1,6 @@
 module;
-#include <vector>
-#include <memory>
+#include <cstddef>
+#include <limits>
 #include <cassert>
 
 export module Brawler.D3D12.TLSFMemoryBlock;
@@ -16,9 +16,45 @@ export namespace Brawler
 			TLSFMemoryBlock();
 
 			bool CanBlockAllocateResource(const TLSFAllocationRequestInfo& allocationInfo) const;
-			std::vector<std::unique_ptr<TLSFMemoryBlock>> AllocateBlock(const TLSFAllocationRequestInfo& allocationInfo);
+			std::size_t CalculateAlignmentAdjustment(const TLSFAllocationRequestInfo& allocationInfo) const;
+
+			/// <summary>
+			/// Shrinks this block down to its first sizeInBytes bytes and hands the rest of its
+			/// memory over to remainderBlock, which becomes this block's right physical neighbor.
+			/// The TLSFMemoryBlock instances are owned by the TLSFAllocator's TLSFMemoryBlockPool,
+			/// so remainderBlock must be acquired from there.
+			/// </summary>
+			/// <param name="remainderBlock">
+			/// - A free TLSFMemoryBlock which is not yet part of the heap. After this function
+			///   returns, it describes the memory following the first sizeInBytes bytes of this
+			///   block, and it has the same free status as this block.
+			/// </param>
+			/// <param name="sizeInBytes">
+			/// - The size, in bytes, which this block should have after it is split. This must
+			///   be less than the current size of the block.
+			/// </param>
+			void SplitBlock(TLSFMemoryBlock& remainderBlock, const std::size_t sizeInBytes);
+
+			/// <summary>
+			/// Merges this block's right physical neighbor into this block. Afterwards, the
+			/// neighbor is no longer part of the heap, and the caller is responsible for
+			/// returning it to the TLSFMemoryBlockPool.
+			/// </summary>
+			void MergeNextPhysicalBlock();
+
+			__forceinline TLSFMemoryBlock* GetPreviousPhysicalBlock() const;
+			__forceinline TLSFMemoryBlock* GetNextPhysicalBlock() const;
 
-			std::vector<TLSFMemoryBlock*> FreeBlock();
+			__forceinline void SetFreeStatus(const bool isBlockFree);
+			__forceinline bool IsBlockFree() const;
+
+			/// <summary>
+			/// Marks this block as belonging to one of the TLSFAllocator's thread caches. Such a
+			/// block is allocated as far as the TLSF heap is concerned, but it is not (or no longer)
+			/// in use by a sub-allocation. See TLSFAllocator::FlushThreadCaches().
+			/// </summary>
+			__forceinline void SetThreadCacheStatus(const bool isBlockThreadCached);
+			__forceinline bool IsBlockThreadCached() const;
 
 			__forceinline void SetBlockSize(const std::size_t sizeInBytes);
 			__forceinline std::size_t GetBlockSize() const;
@@ -33,16 +69,16 @@ export namespace Brawler
 			__forceinline TLSFMemoryBlock* GetNextFreeBlock() const;
 
 		private:
-			__forceinline void SetFreeStatus(const bool isBlockFree);
-			__forceinline bool IsBlockFree() const;
-
-			__forceinline std::size_t CalculateAlignmentAdjustment(const TLSFAllocationRequestInfo& allocationInfo) const;
-
-		private:
+			// Bit 0 is the free status, bit 1 is the thread cache status, and the remaining
+			// 62 bits are the size of the block.
 			std::size_t mSizeAndFreeStatus;
 			std::size_t mHeapOffset;
 			TLSFMemoryBlock* mPrevPhysicalBlockPtr;
 			TLSFMemoryBlock* mNextPhysicalBlockPtr;
+
+			// While a block is free, these link it into the free list of its storage class in
+			// the TLSFAllocator. While it is sitting unused in the TLSFMemoryBlockPool,
+			// mNextFreeBlockPtr links it into the pool's list of unused blocks instead.
 			TLSFMemoryBlock* mPrevFreeBlockPtr;
 			TLSFMemoryBlock* mNextFreeBlockPtr;
 		};
@@ -55,16 +91,46 @@ namespace Brawler
 {
 	namespace D3D12
 	{
+		__forceinline TLSFMemoryBlock* TLSFMemoryBlock::GetPreviousPhysicalBlock() const
+		{
+			return mPrevPhysicalBlockPtr;
+		}
+
+		__forceinline TLSFMemoryBlock* TLSFMemoryBlock::GetNextPhysicalBlock() const
+		{
+			return mNextPhysicalBlockPtr;
+		}
+
+		__forceinline void TLSFMemoryBlock::SetFreeStatus(const bool isBlockFree)
+		{
+			mSizeAndFreeStatus = ((mSizeAndFreeStatus & ~static_cast<std::size_t>(0x1)) | (isBlockFree ? 0x1 : 0));
+		}
+
+		__forceinline bool TLSFMemoryBlock::IsBlockFree() const
+		{
+			return ((mSizeAndFreeStatus & 0x1) != 0);
+		}
+
+		__forceinline void TLSFMemoryBlock::SetThreadCacheStatus(const bool isBlockThreadCached)
+		{
+			mSizeAndFreeStatus = ((mSizeAndFreeStatus & ~static_cast<std::size_t>(0x2)) | (isBlockThreadCached ? 0x2 : 0));
+		}
+
+		__forceinline bool TLSFMemoryBlock::IsBlockThreadCached() const
+		{
+			return ((mSizeAndFreeStatus & 0x2) != 0);
+		}
+
 		__forceinline void TLSFMemoryBlock::SetBlockSize(const std::size_t sizeInBytes)
 		{
-			assert((std::numeric_limits<decltype(mSizeAndFreeStatus)>::max() >> 1) >= sizeInBytes && "ERROR: An allocation size so large was provided to a TLSFMemoryBlock that it couldn't fit in 63 bits!");
+			assert((std::numeric_limits<decltype(mSizeAndFreeStatus)>::max() >> 2) >= sizeInBytes && "ERROR: An allocation size so large was provided to a TLSFMemoryBlock that it couldn't fit in 62 bits!");
 
-			mSizeAndFreeStatus = ((sizeInBytes << 1) | (mSizeAndFreeStatus & 0x1));
+			mSizeAndFreeStatus = ((sizeInBytes << 2) | (mSizeAndFreeStatus & 0x3));
 		}
 
 		__forceinline std::size_t TLSFMemoryBlock::GetBlockSize() const
 		{
-			return (mSizeAndFreeStatus >> 1);
+			return (mSizeAndFreeStatus >> 2);
 		}
 
 		__forceinline void TLSFMemoryBlock::SetHeapOffset(const std::size_t heapOffset)
@@ -0,0 +1,55 @@
+module;
+#include <array>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <cassert>
+
+module Brawler.D3D12.TLSFMemoryBlockPool;
+
+namespace Brawler
+{
+	namespace D3D12
+	{
+		TLSFMemoryBlock& TLSFMemoryBlockPool::AcquireBlock()
+		{
+			if (mUnusedBlockListHead != nullptr)
+			{
+				TLSFMemoryBlock& acquiredBlock{ *mUnusedBlockListHead };
+				mUnusedBlockListHead = acquiredBlock.GetNextFreeBlock();
+
+				acquiredBlock = TLSFMemoryBlock{};
+				return acquiredBlock;
+			}
+
+			if (mNextSlabBlockIndex == TLSF_MEMORY_BLOCKS_PER_SLAB) [[unlikely]]
+			{
+				mSlabPtrArr.push_back(std::make_unique<BlockSlab>());
+				mNextSlabBlockIndex = 0;
+			}
+
+			return (*(mSlabPtrArr.back()))[mNextSlabBlockIndex++];
+		}
+
+		void TLSFMemoryBlockPool::ReturnBlock(TLSFMemoryBlock& block)
+		{
+			assert(IsBlockFromPool(block) && "ERROR: A TLSFMemoryBlock was returned to a TLSFMemoryBlockPool which did not create it!");
+			assert(block.GetPreviousPhysicalBlock() == nullptr && block.GetNextPhysicalBlock() == nullptr && "ERROR: A TLSFMemoryBlock was returned to its TLSFMemoryBlockPool while it was still part of a heap!");
+
+			block.SetNextFreeBlock(mUnusedBlockListHead);
+			mUnusedBlockListHead = &block;
+		}
+
+		bool TLSFMemoryBlockPool::IsBlockFromPool(const TLSFMemoryBlock& block) const
+		{
+			return std::ranges::any_of(mSlabPtrArr, [blockPtr = &block] (const std::unique_ptr<BlockSlab>& slabPtr)
+			{
+				// Comparing pointers into different arrays with the built-in operators is
+				// unspecified, but std::less is guaranteed to give us a total order.
+				const std::less<const TLSFMemoryBlock*> lessThan{};
+				return (!lessThan(blockPtr, slabPtr->data()) && lessThan(blockPtr, slabPtr->data() + slabPtr->size()));
+			});
+		}
+	}
+}
\ No newline at end of file
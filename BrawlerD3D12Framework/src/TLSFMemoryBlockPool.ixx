@@ -0,0 +1,72 @@
+module;
+#include <array>
+#include <vector>
+#include <memory>
+
+export module Brawler.D3D12.TLSFMemoryBlockPool;
+import Brawler.D3D12.TLSFMemoryBlock;
+
+namespace Brawler
+{
+	namespace D3D12
+	{
+		// Each slab holds this many TLSFMemoryBlock instances. At 48 bytes per block, a slab
+		// is a bit larger than 12KB.
+		static constexpr std::size_t TLSF_MEMORY_BLOCKS_PER_SLAB = 256;
+	}
+}
+
+export namespace Brawler
+{
+	namespace D3D12
+	{
+		// Previously, the TLSFAllocator created every TLSFMemoryBlock with std::make_unique() and
+		// tracked them all in a std::vector, so every allocation hit the heap up to twice, and
+		// every deletion had to search through that std::vector. Instead, the TLSFMemoryBlocks
+		// now live in slabs owned by a TLSFMemoryBlockPool, and unused blocks are kept in an
+		// intrusive free list. Once the pool has grown to the peak number of blocks, acquiring
+		// and returning blocks never touches the heap.
+
+		class TLSFMemoryBlockPool
+		{
+		private:
+			using BlockSlab = std::array<TLSFMemoryBlock, TLSF_MEMORY_BLOCKS_PER_SLAB>;
+
+		public:
+			TLSFMemoryBlockPool() = default;
+
+			TLSFMemoryBlockPool(const TLSFMemoryBlockPool& rhs) = delete;
+			TLSFMemoryBlockPool& operator=(const TLSFMemoryBlockPool& rhs) = delete;
+
+			TLSFMemoryBlockPool(TLSFMemoryBlockPool&& rhs) noexcept = default;
+			TLSFMemoryBlockPool& operator=(TLSFMemoryBlockPool&& rhs) noexcept = default;
+
+			/// <summary>
+			/// Gets a TLSFMemoryBlock from the pool. The returned block is in the same state as a
+			/// default-constructed TLSFMemoryBlock.
+			/// </summary>
+			TLSFMemoryBlock& AcquireBlock();
+
+			/// <summary>
+			/// Returns a TLSFMemoryBlock which was previously acquired from this pool by calling
+			/// TLSFMemoryBlockPool::AcquireBlock(). The block must no longer be part of a heap.
+			/// </summary>
+			void ReturnBlock(TLSFMemoryBlock& block);
+
+			/// <summary>
+			/// Determines whether or not block was allocated by this TLSFMemoryBlockPool. This
+			/// takes time linear in the number of slabs, so it is meant for use in assertions.
+			/// </summary>
+			bool IsBlockFromPool(const TLSFMemoryBlock& block) const;
+
+		private:
+			std::vector<std::unique_ptr<BlockSlab>> mSlabPtrArr;
+			TLSFMemoryBlock* mUnusedBlockListHead = nullptr;
+
+			// The blocks of the most recently created slab are handed out in order before they
+			// are ever added to the list of unused blocks. That way, creating a slab does not
+			// require us to walk through all of its blocks.
+			std::size_t mNextSlabBlockIndex = TLSF_MEMORY_BLOCKS_PER_SLAB;
+		};
+	}
+}
\ No newline at end of file
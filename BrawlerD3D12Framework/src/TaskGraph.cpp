@@ -0,0 +1,285 @@
+module;
+#include <cstdint>
+#include <cassert>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <optional>
+#include <thread>
+#include <span>
+#include <initializer_list>
+
+module Brawler.TaskGraph;
+import Brawler.Job;
+import Brawler.WorkerThreadPool;
+import Util.Coroutine;
+import Util.General;
+
+namespace Brawler
+{
+	extern WorkerThreadPool& GetWorkerThreadPool();
+}
+
+namespace Brawler
+{
+	struct TaskGraph::ExecutionState
+	{
+		std::vector<TaskNode> TaskNodeArr;
+
+		// This is the number of predecessors of each task which have not yet finished. A
+		// task is dispatched by the thread which decrements its value to zero.
+		std::unique_ptr<std::atomic<std::uint32_t>[]> RemainingPredecessorCountArr;
+
+		std::atomic<std::uint32_t> RemainingTaskCount;
+
+		std::atomic<bool> HasException;
+		std::mutex ExceptionCritSection;
+		std::exception_ptr ExceptionPtr;
+
+		JobPriority Priority;
+
+		// If this is true, then the ExecutionState is owned by the tasks themselves, and it
+		// is deleted by the last task to finish.
+		bool IsAsynchronous;
+	};
+
+	TaskGraph::TaskGraph(const JobPriority priority) :
+		mTaskNodeArr(),
+		mPriority(priority)
+	{}
+
+	TaskGraph::TaskID TaskGraph::AddTask(JobCallback&& callback, const std::initializer_list<TaskID> predecessorIDs)
+	{
+		const TaskID addedTaskID = static_cast<TaskID>(mTaskNodeArr.size());
+
+		mTaskNodeArr.push_back(TaskNode{
+			.Callback{ std::move(callback) },
+			.SuccessorIDArr{},
+			.PredecessorCount = 0
+		});
+
+		for (const auto predecessorID : predecessorIDs)
+			AddDependency(predecessorID, addedTaskID);
+
+		return addedTaskID;
+	}
+
+	void TaskGraph::AddDependency(const TaskID predecessorID, const TaskID successorID)
+	{
+		assert(predecessorID < mTaskNodeArr.size() && successorID < mTaskNodeArr.size() && "ERROR: An invalid TaskID was specified in a call to TaskGraph::AddDependency()!");
+		assert(predecessorID != successorID && "ERROR: A task in a TaskGraph cannot depend on itself!");
+
+		mTaskNodeArr[predecessorID].SuccessorIDArr.push_back(successorID);
+		++(mTaskNodeArr[successorID].PredecessorCount);
+	}
+
+	void TaskGraph::Reserve(const std::size_t taskCount)
+	{
+		mTaskNodeArr.reserve(taskCount);
+	}
+
+	std::size_t TaskGraph::GetTaskCount() const
+	{
+		return mTaskNodeArr.size();
+	}
+
+	void TaskGraph::Execute()
+	{
+		if (mTaskNodeArr.empty())
+			return;
+
+		std::vector<TaskID> rootTaskIDArr{};
+		const std::unique_ptr<ExecutionState> executionStatePtr{ BeginExecution(false, rootTaskIDArr) };
+
+		// Dispatch all but one of the root tasks, and execute the remaining one on this thread.
+		// There is no point in having this thread wait for a worker thread to pick it up.
+		if (rootTaskIDArr.size() > 1)
+			DispatchTasks(*executionStatePtr, std::span<const TaskID>{ rootTaskIDArr }.subspan(1));
+
+		ExecuteTask(*executionStatePtr, rootTaskIDArr.front());
+
+		while (executionStatePtr->RemainingTaskCount.load(std::memory_order::acquire) != 0)
+		{
+			if (!Util::Coroutine::TryExecuteJob())
+				std::this_thread::yield();
+		}
+
+		if (executionStatePtr->ExceptionPtr != nullptr) [[unlikely]]
+			std::rethrow_exception(executionStatePtr->ExceptionPtr);
+	}
+
+	void TaskGraph::ExecuteAsync()
+	{
+		if (mTaskNodeArr.empty())
+			return;
+
+		std::vector<TaskID> rootTaskIDArr{};
+		std::unique_ptr<ExecutionState> executionStatePtr{ BeginExecution(true, rootTaskIDArr) };
+
+		// From this point on, the ExecutionState belongs to the tasks. The last task to finish
+		// deletes it, which might happen before DispatchTasks() even returns.
+		DispatchTasks(*(executionStatePtr.release()), std::span<const TaskID>{ rootTaskIDArr });
+	}
+
+	std::unique_ptr<TaskGraph::ExecutionState> TaskGraph::BeginExecution(const bool isAsynchronous, std::vector<TaskID>& rootTaskIDArr)
+	{
+		if constexpr (Util::General::IsDebugModeEnabled())
+			assert(IsAcyclic() && "ERROR: The dependencies in a TaskGraph formed a cycle!");
+
+		const std::size_t taskCount = mTaskNodeArr.size();
+
+		std::unique_ptr<ExecutionState> executionStatePtr{ std::make_unique<ExecutionState>() };
+		executionStatePtr->RemainingPredecessorCountArr = std::make_unique<std::atomic<std::uint32_t>[]>(taskCount);
+		executionStatePtr->RemainingTaskCount.store(static_cast<std::uint32_t>(taskCount), std::memory_order::relaxed);
+		executionStatePtr->HasException.store(false, std::memory_order::relaxed);
+		executionStatePtr->Priority = mPriority;
+		executionStatePtr->IsAsynchronous = isAsynchronous;
+
+		for (std::size_t i = 0; i < taskCount; ++i)
+		{
+			const std::uint32_t predecessorCount = mTaskNodeArr[i].PredecessorCount;
+			executionStatePtr->RemainingPredecessorCountArr[i].store(predecessorCount, std::memory_order::relaxed);
+
+			if (predecessorCount == 0)
+				rootTaskIDArr.push_back(static_cast<TaskID>(i));
+		}
+
+		assert(!rootTaskIDArr.empty());
+
+		// The release semantics of dispatching the root tasks to the WorkerThreadPool make all
+		// of the writes above visible to the threads which execute them.
+		executionStatePtr->TaskNodeArr = std::move(mTaskNodeArr);
+		mTaskNodeArr.clear();
+
+		return executionStatePtr;
+	}
+
+	bool TaskGraph::IsAcyclic() const
+	{
+		// This is just Kahn's algorithm: if we can remove every task from the graph by
+		// repeatedly removing tasks with no remaining predecessors, then there is no cycle.
+		std::vector<std::uint32_t> remainingPredecessorCountArr{};
+		remainingPredecessorCountArr.reserve(mTaskNodeArr.size());
+
+		std::vector<TaskID> readyTaskIDArr{};
+
+		for (std::size_t i = 0; i < mTaskNodeArr.size(); ++i)
+		{
+			remainingPredecessorCountArr.push_back(mTaskNodeArr[i].PredecessorCount);
+
+			if (mTaskNodeArr[i].PredecessorCount == 0)
+				readyTaskIDArr.push_back(static_cast<TaskID>(i));
+		}
+
+		std::size_t numVisitedTasks = 0;
+
+		while (!readyTaskIDArr.empty())
+		{
+			const TaskID currTaskID = readyTaskIDArr.back();
+			readyTaskIDArr.pop_back();
+
+			++numVisitedTasks;
+
+			for (const auto successorID : mTaskNodeArr[currTaskID].SuccessorIDArr)
+			{
+				if (--remainingPredecessorCountArr[successorID] == 0)
+					readyTaskIDArr.push_back(successorID);
+			}
+		}
+
+		return (numVisitedTasks == mTaskNodeArr.size());
+	}
+
+	void TaskGraph::ExecuteTask(ExecutionState& executionState, TaskID taskID)
+	{
+		while (true)
+		{
+			TaskNode& currTaskNode{ executionState.TaskNodeArr[taskID] };
+
+			// If a task has already failed, then we skip the remaining tasks, but we still need
+			// to go through the graph so that the waiting thread knows when we are done.
+			if (!executionState.HasException.load(std::memory_order::relaxed)) [[likely]]
+			{
+				try
+				{
+					currTaskNode.Callback();
+				}
+				catch (...)
+				{
+					std::scoped_lock<std::mutex> lock{ executionState.ExceptionCritSection };
+
+					if (executionState.ExceptionPtr == nullptr)
+					{
+						executionState.ExceptionPtr = std::current_exception();
+						executionState.HasException.store(true, std::memory_order::relaxed);
+					}
+				}
+			}
+
+			// Find the successors for which this was the last remaining predecessor. We continue
+			// with the first of these on this thread, which saves a round trip through the job
+			// queues. The others are sent to this thread's local job deque, where they will either
+			// be picked up by this thread once it is done or stolen by an idle thread.
+			std::optional<TaskID> nextTaskID{};
+			std::vector<TaskID> readySuccessorIDArr{};
+
+			for (const auto successorID : currTaskNode.SuccessorIDArr)
+			{
+				if (executionState.RemainingPredecessorCountArr[successorID].fetch_sub(1, std::memory_order::acq_rel) == 1)
+				{
+					if (!nextTaskID.has_value())
+						nextTaskID = successorID;
+					else
+						readySuccessorIDArr.push_back(successorID);
+				}
+			}
+
+			if (!readySuccessorIDArr.empty())
+				DispatchTasks(executionState, std::span<const TaskID>{ readySuccessorIDArr });
+
+			// This must be the last access to executionState for this task. Once the remaining
+			// task count reaches zero, the thread waiting in TaskGraph::Execute() is free to
+			// destroy it. (If we have a next task, then the count cannot reach zero here, since
+			// that task has not yet finished.)
+			if (executionState.RemainingTaskCount.fetch_sub(1, std::memory_order::acq_rel) == 1)
+			{
+				assert(!nextTaskID.has_value());
+
+				if (executionState.IsAsynchronous)
+				{
+					const std::exception_ptr exceptionPtr{ std::move(executionState.ExceptionPtr) };
+					delete &executionState;
+
+					if (exceptionPtr != nullptr) [[unlikely]]
+						std::rethrow_exception(exceptionPtr);
+				}
+
+				return;
+			}
+
+			if (!nextTaskID.has_value())
+				return;
+
+			taskID = *nextTaskID;
+		}
+	}
+
+	void TaskGraph::DispatchTasks(ExecutionState& executionState, const std::span<const TaskID> taskIDSpan)
+	{
+		std::vector<Job> taskJobArr{};
+		taskJobArr.reserve(taskIDSpan.size());
+
+		for (const auto taskID : taskIDSpan)
+		{
+			taskJobArr.push_back(Job{ [executionStatePtr = &executionState, taskID] ()
+			{
+				ExecuteTask(*executionStatePtr, taskID);
+			}, nullptr, executionState.Priority });
+		}
+
+		// Do *NOT* access executionState after this point. (See TaskGraph::ExecuteAsync().)
+		Brawler::GetWorkerThreadPool().DispatchJobs(std::span<Job>{ taskJobArr });
+	}
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+module;
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <span>
+#include <initializer_list>
+
+export module Brawler.TaskGraph;
+import Brawler.JobPriority;
+import Brawler.JobCallback;
+
+export namespace Brawler
+{
+	// A TaskGraph is a set of CPU jobs (tasks) with dependencies between them. Each task
+	// declares the tasks which must finish before it may begin (its predecessors), and it is
+	// dispatched to the WorkerThreadPool as soon as the last of these has finished.
+	//
+	// Compare this to using a JobGroup for each "stage" of a pipeline: with JobGroups, the thread
+	// which called JobGroup::ExecuteJobs() is stuck in a help-loop until *every* job in the stage
+	// has finished, and a job which depends on only one job from the previous stage still has to
+	// wait for all of them. With a TaskGraph, the thread which finishes the last predecessor of a
+	// task immediately continues with that task (or pushes it to its own local job deque, if more
+	// than one task became ready), and no thread ever waits for a task which it does not depend on.
+
+	class TaskGraph
+	{
+	public:
+		using TaskID = std::uint32_t;
+
+	private:
+		struct TaskNode
+		{
+			JobCallback Callback;
+			std::vector<TaskID> SuccessorIDArr;
+			std::uint32_t PredecessorCount;
+		};
+
+		struct ExecutionState;
+
+	public:
+		explicit TaskGraph(const JobPriority priority = JobPriority::NORMAL);
+
+		TaskGraph(const TaskGraph& rhs) = delete;
+		TaskGraph& operator=(const TaskGraph& rhs) = delete;
+
+		TaskGraph(TaskGraph&& rhs) noexcept = default;
+		TaskGraph& operator=(TaskGraph&& rhs) noexcept = default;
+
+		/// <summary>
+		/// Adds a task to the TaskGraph. The task will not be executed until either
+		/// TaskGraph::Execute() or TaskGraph::ExecuteAsync() is called, and even then, it will
+		/// only be executed once every task specified in predecessorIDs has finished.
+		/// </summary>
+		/// <param name="callback">
+		/// - The function which is to be executed by the task.
+		/// </param>
+		/// <param name="predecessorIDs">
+		/// - The TaskIDs of the tasks which must finish before this task can begin. Every
+		///   TaskID must have been returned by a previous call to TaskGraph::AddTask() on
+		///   this TaskGraph instance.
+		/// </param>
+		/// <returns>
+		/// The function returns the TaskID of the added task. This can be used to make other
+		/// tasks depend on it.
+		/// </returns>
+		TaskID AddTask(JobCallback&& callback, const std::initializer_list<TaskID> predecessorIDs = {});
+
+		/// <summary>
+		/// Specifies that the task identified by successorID may not begin until the task
+		/// identified by predecessorID has finished. This is useful if the dependencies of a
+		/// task are not known at the time it is added.
+		///
+		/// The dependencies in a TaskGraph must not form a cycle. In Debug builds, this is
+		/// checked for when the TaskGraph is executed.
+		/// </summary>
+		void AddDependency(const TaskID predecessorID, const TaskID successorID);
+
+		// Allocates memory for the specified number of tasks.
+		void Reserve(const std::size_t taskCount);
+
+		std::size_t GetTaskCount() const;
+
+		/// <summary>
+		/// Executes every task in the TaskGraph. The calling thread executes other jobs
+		/// while it waits, and the return from this call synchronizes-with (i.e., happens
+		/// after) the completion of every task.
+		///
+		/// If any task throws an exception, then the tasks which have not yet begun are
+		/// skipped, and the first exception which was thrown is re-thrown on the calling
+		/// thread once every other running task has finished.
+		///
+		/// After this function returns, the TaskGraph is empty and can be re-used.
+		/// </summary>
+		void Execute();
+
+		/// <summary>
+		/// Executes every task in the TaskGraph asynchronously. The function returns
+		/// immediately, and the TaskGraph is empty afterwards.
+		///
+		/// It is the caller's responsibility to ensure that any memory referenced by the
+		/// tasks remains valid until they have finished executing. Typically, the last task
+		/// in the graph signals the completion of the entire graph.
+		///
+		/// If any task throws an exception, then it is re-thrown by the last task to finish,
+		/// where it is handled like any other exception thrown by a job.
+		/// </summary>
+		void ExecuteAsync();
+
+	private:
+		std::unique_ptr<ExecutionState> BeginExecution(const bool isAsynchronous, std::vector<TaskID>& rootTaskIDArr);
+		bool IsAcyclic() const;
+
+		static void ExecuteTask(ExecutionState& executionState, TaskID taskID);
+		static void DispatchTasks(ExecutionState& executionState, const std::span<const TaskID> taskIDSpan);
+
+	private:
+		std::vector<TaskNode> mTaskNodeArr;
+		JobPriority mPriority;
+	};
+}
\ No newline at end of file
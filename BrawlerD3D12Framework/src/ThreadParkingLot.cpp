@@ -0,0 +1,159 @@
+module;
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+
+module Brawler.ThreadParkingLot;
+import Brawler.JobTrace;
+
+namespace Brawler
+{
+	ThreadParkingLot::ThreadParkingLot(const std::uint32_t numThreads) :
+		mParkingSpaceArr(std::make_unique<ParkingSpace[]>(numThreads)),
+		mParkedThreadIndexArr(),
+		mCritSection(),
+		mIsClosed(false),
+		mWakeUpEpoch(0),
+		mParkedThreadCount(0),
+		mParkCount(0),
+		mWakeUpCount(0),
+		mSpuriousWakeUpCount(0),
+		mParkedTimeInMicroseconds(0)
+	{
+		mParkedThreadIndexArr.reserve(numThreads);
+	}
+
+	std::uint32_t ThreadParkingLot::GetWakeUpEpoch() const
+	{
+		return mWakeUpEpoch.load(std::memory_order::acquire);
+	}
+
+	bool ThreadParkingLot::ParkCurrentThread(const std::uint32_t parkingSpaceIndex, const std::uint32_t previousWakeUpEpoch)
+	{
+		ParkingSpace& parkingSpace{ mParkingSpaceArr[parkingSpaceIndex] };
+
+		{
+			std::scoped_lock<std::mutex> lock{ mCritSection };
+
+			if (mIsClosed) [[unlikely]]
+				return false;
+
+			assert(!parkingSpace.IsOccupied);
+
+			parkingSpace.IsOccupied = true;
+			mParkedThreadIndexArr.push_back(parkingSpaceIndex);
+
+			mParkedThreadCount.fetch_add(1, std::memory_order::seq_cst);
+		}
+
+		// We need to check the epoch *after* announcing that we are parked. ThreadParkingLot::UnparkThreads()
+		// increments the epoch *before* checking mParkedThreadCount, and since both of these
+		// are sequentially consistent operations, either we see the new epoch here, or the
+		// dispatching thread sees that we are parked and wakes us up.
+		if (mWakeUpEpoch.load(std::memory_order::seq_cst) != previousWakeUpEpoch)
+		{
+			std::unique_lock<std::mutex> lock{ mCritSection };
+
+			if (parkingSpace.IsOccupied)
+			{
+				parkingSpace.IsOccupied = false;
+				std::erase(mParkedThreadIndexArr, parkingSpaceIndex);
+
+				mParkedThreadCount.fetch_sub(1, std::memory_order::relaxed);
+
+				return false;
+			}
+
+			// Some other thread already decided to wake us up and released our semaphore, so
+			// we need to consume that release. Otherwise, the next time we park, we would wake
+			// up immediately. This does not block.
+			lock.unlock();
+			parkingSpace.WakeUpSemaphore.acquire();
+
+			return false;
+		}
+
+		mParkCount.fetch_add(1, std::memory_order::relaxed);
+
+		if constexpr (Util::JobTrace::IsJobTracingEnabled())
+			Util::JobTrace::RecordEvent(JobTraceEventType::THREAD_PARKED);
+
+		const auto parkBeginTime = std::chrono::steady_clock::now();
+		parkingSpace.WakeUpSemaphore.acquire();
+		const auto parkEndTime = std::chrono::steady_clock::now();
+
+		if constexpr (Util::JobTrace::IsJobTracingEnabled())
+			Util::JobTrace::RecordEvent(JobTraceEventType::THREAD_UNPARKED);
+
+		mParkedTimeInMicroseconds.fetch_add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(parkEndTime - parkBeginTime).count()), std::memory_order::relaxed);
+
+		return true;
+	}
+
+	void ThreadParkingLot::UnparkThreads(const std::size_t maxThreadCount)
+	{
+		mWakeUpEpoch.fetch_add(1, std::memory_order::seq_cst);
+
+		// If nobody is parked, then we can skip taking the lock entirely. This is the common
+		// case when the WorkerThreadPool is busy. (See ThreadParkingLot::ParkCurrentThread() for
+		// why this is safe.)
+		if (mParkedThreadCount.load(std::memory_order::seq_cst) == 0)
+			return;
+
+		std::scoped_lock<std::mutex> lock{ mCritSection };
+
+		const std::size_t numThreadsToWake = std::min(maxThreadCount, mParkedThreadIndexArr.size());
+
+		for (std::size_t i = 0; i < numThreadsToWake; ++i)
+		{
+			// Wake up the most recently parked thread first.
+			ParkingSpace& parkingSpace{ mParkingSpaceArr[mParkedThreadIndexArr.back()] };
+			mParkedThreadIndexArr.pop_back();
+
+			parkingSpace.IsOccupied = false;
+			parkingSpace.WakeUpSemaphore.release();
+		}
+
+		mParkedThreadCount.fetch_sub(static_cast<std::uint32_t>(numThreadsToWake), std::memory_order::relaxed);
+		mWakeUpCount.fetch_add(numThreadsToWake, std::memory_order::relaxed);
+	}
+
+	void ThreadParkingLot::UnparkAllThreads()
+	{
+		std::scoped_lock<std::mutex> lock{ mCritSection };
+
+		mIsClosed = true;
+		mWakeUpEpoch.fetch_add(1, std::memory_order::seq_cst);
+
+		for (const auto parkedThreadIndex : mParkedThreadIndexArr)
+		{
+			ParkingSpace& parkingSpace{ mParkingSpaceArr[parkedThreadIndex] };
+
+			parkingSpace.IsOccupied = false;
+			parkingSpace.WakeUpSemaphore.release();
+		}
+
+		mParkedThreadIndexArr.clear();
+		mParkedThreadCount.store(0, std::memory_order::relaxed);
+	}
+
+	void ThreadParkingLot::RecordSpuriousWakeUp()
+	{
+		mSpuriousWakeUpCount.fetch_add(1, std::memory_order::relaxed);
+	}
+
+	ThreadParkingLot::Statistics ThreadParkingLot::GetStatistics() const
+	{
+		return Statistics{
+			.ParkCount = mParkCount.load(std::memory_order::relaxed),
+			.WakeUpCount = mWakeUpCount.load(std::memory_order::relaxed),
+			.SpuriousWakeUpCount = mSpuriousWakeUpCount.load(std::memory_order::relaxed),
+			.ParkedTimeInMicroseconds = mParkedTimeInMicroseconds.load(std::memory_order::relaxed)
+		};
+	}
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+module;
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <semaphore>
+#include <new>
+
+export module Brawler.ThreadParkingLot;
+
+export namespace Brawler
+{
+	/// <summary>
+	/// Describes how long an idle WorkerThread keeps looking for jobs before it is parked
+	/// in the ThreadParkingLot. Parking and unparking a thread both involve a trip through
+	/// the OS scheduler, so if jobs tend to arrive in short bursts, it is cheaper to keep
+	/// looking for a little while.
+	/// </summary>
+	struct WorkerThreadIdlePolicy
+	{
+		/// <summary>
+		/// The number of failed attempts to acquire a job after which an idle thread starts
+		/// yielding its time slice between attempts. Before that, the thread only executes a
+		/// pause instruction between attempts.
+		/// </summary>
+		std::uint32_t SpinIterationCount = 64;
+
+		/// <summary>
+		/// The number of additional failed attempts, each followed by a call to
+		/// std::this_thread::yield(), after which an idle thread is parked.
+		/// </summary>
+		std::uint32_t YieldIterationCount = 8;
+	};
+
+	// The ThreadParkingLot is where idle WorkerThreads go to sleep. Previously, every idle
+	// thread waited on the same std::atomic, so every call to notify_one() had to go through
+	// the same OS wait queue, and we had no control over which thread was woken up. Instead,
+	// every thread now has its own semaphore, and when jobs are dispatched, the threads which
+	// were parked most recently are woken up first. Such a thread is the most likely to still
+	// have its data in the cache, and if fewer jobs are dispatched than there are parked
+	// threads, then the threads which have been parked the longest can stay parked.
+
+	class ThreadParkingLot
+	{
+	public:
+		struct Statistics
+		{
+			/// <summary>
+			/// The number of times which a thread was parked.
+			/// </summary>
+			std::uint64_t ParkCount;
+
+			/// <summary>
+			/// The number of times which a parked thread was woken up by ThreadParkingLot::UnparkThreads().
+			/// </summary>
+			std::uint64_t WakeUpCount;
+
+			/// <summary>
+			/// The number of times which a woken up thread was parked again without having
+			/// executed a job in between. A high number of these relative to WakeUpCount
+			/// suggests that too many threads are being woken up.
+			/// </summary>
+			std::uint64_t SpuriousWakeUpCount;
+
+			/// <summary>
+			/// The total amount of time, in microseconds, which threads have spent parked.
+			/// </summary>
+			std::uint64_t ParkedTimeInMicroseconds;
+		};
+
+	private:
+		struct alignas(std::hardware_destructive_interference_size) ParkingSpace
+		{
+			std::binary_semaphore WakeUpSemaphore{ 0 };
+
+			// This is only accessed while the ThreadParkingLot's mutex is held.
+			bool IsOccupied = false;
+		};
+
+	public:
+		explicit ThreadParkingLot(const std::uint32_t numThreads);
+
+		ThreadParkingLot(const ThreadParkingLot& rhs) = delete;
+		ThreadParkingLot& operator=(const ThreadParkingLot& rhs) = delete;
+
+		ThreadParkingLot(ThreadParkingLot&& rhs) noexcept = delete;
+		ThreadParkingLot& operator=(ThreadParkingLot&& rhs) noexcept = delete;
+
+		/// <summary>
+		/// Gets the current wake-up epoch. The epoch is incremented every time
+		/// ThreadParkingLot::UnparkThreads() is called. A thread should read the epoch *before*
+		/// it begins looking for jobs and pass it to ThreadParkingLot::ParkCurrentThread() if it
+		/// fails to find any. This way, the thread will not be parked if new jobs were
+		/// dispatched while it was looking.
+		/// </summary>
+		std::uint32_t GetWakeUpEpoch() const;
+
+		/// <summary>
+		/// Parks the calling thread until it is woken up by a call to either
+		/// ThreadParkingLot::UnparkThreads() or ThreadParkingLot::UnparkAllThreads(). If the
+		/// wake-up epoch no longer matches previousWakeUpEpoch, then the function returns
+		/// immediately.
+		/// </summary>
+		/// <param name="parkingSpaceIndex">
+		/// - The index of the calling thread's parking space. Every thread which uses this
+		///   ThreadParkingLot must have its own index in the range [0, numThreads).
+		/// </param>
+		/// <param name="previousWakeUpEpoch">
+		/// - The value returned by ThreadParkingLot::GetWakeUpEpoch() before the calling thread
+		///   last looked for jobs.
+		/// </param>
+		/// <returns>
+		/// The function returns true if the calling thread was parked and then woken up, and
+		/// false if it was never put to sleep.
+		/// </returns>
+		bool ParkCurrentThread(const std::uint32_t parkingSpaceIndex, const std::uint32_t previousWakeUpEpoch);
+
+		/// <summary>
+		/// Increments the wake-up epoch and wakes up at most maxThreadCount of the parked
+		/// threads, starting with the one which was parked most recently.
+		/// </summary>
+		/// <param name="maxThreadCount">
+		/// - The maximum number of threads to wake up. This is typically the number of jobs
+		///   which were just dispatched.
+		/// </param>
+		void UnparkThreads(const std::size_t maxThreadCount);
+
+		/// <summary>
+		/// Wakes up every parked thread. After this function is called, threads are never
+		/// parked again; ThreadParkingLot::ParkCurrentThread() returns immediately. This is
+		/// meant to be used when shutting down the WorkerThreadPool.
+		/// </summary>
+		void UnparkAllThreads();
+
+		void RecordSpuriousWakeUp();
+
+		Statistics GetStatistics() const;
+
+	private:
+		std::unique_ptr<ParkingSpace[]> mParkingSpaceArr;
+
+		// This is a stack of the indices of the parked threads. The thread at the back was
+		// parked most recently.
+		std::vector<std::uint32_t> mParkedThreadIndexArr;
+		std::mutex mCritSection;
+		bool mIsClosed;
+
+		alignas(std::hardware_destructive_interference_size) std::atomic<std::uint32_t> mWakeUpEpoch;
+		alignas(std::hardware_destructive_interference_size) std::atomic<std::uint32_t> mParkedThreadCount;
+
+		std::atomic<std::uint64_t> mParkCount;
+		std::atomic<std::uint64_t> mWakeUpCount;
+		std::atomic<std::uint64_t> mSpuriousWakeUpCount;
+		std::atomic<std::uint64_t> mParkedTimeInMicroseconds;
+	};
+}
\ No newline at end of file
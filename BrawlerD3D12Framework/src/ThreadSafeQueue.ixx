@@ -4,6 +4,8 @@ module;
 #include <array>
 #include <optional>
 #include <memory>
+#include <span>
+#include <algorithm>
 
 export module Brawler.ThreadSafeQueue;
 
@@ -38,7 +40,27 @@ export namespace Brawler
 		//     is invalid, because Thread A has not actually stored any value yet.
 		//
 		//   - Thread A stores the element in the array.
-		using QueueElementPtr = std::atomic<T*>;
+		//
+		// It also prevents the opposite race condition, which can happen once the queue wraps
+		// around:
+		//
+		//   - Thread B claims the element at index i, but has not yet moved it out of the array.
+		//
+		//   - Thread A claims index i for a new element, since mPackedOffsets says that it is free.
+		//
+		//   - Thread A overwrites the element which Thread B is still moving out of the array.
+		//
+		// To handle both cases, every slot has an atomic state. Producers only write to EMPTY
+		// slots, and consumers only read from FILLED slots. A consumer marks the slot as
+		// CONSUMING while it moves the element out, and only marks it as EMPTY afterwards.
+		enum class SlotState : std::uint8_t
+		{
+			EMPTY,
+			FILLED,
+			CONSUMING
+		};
+
+		using QueueSlotState = std::atomic<SlotState>;
 
 		struct QueueInfo
 		{
@@ -48,8 +70,8 @@ export namespace Brawler
 
 		// tl;dr: Ensure that we have no more than UINT32_MAX elements in the queue.
 		// 
-		// Internally, we will use two arrays to represent the queue. The first array, mArr, stores atomic
-		// T* values which reference values in the second array, mBackingMemory. Each mArr entry has a
+		// Internally, we will use two arrays to represent the queue. The first array, mArr, stores the
+		// atomic SlotState of each value in the second array, mBackingMemory. Each mArr entry has a
 		// corresponding mBackingMemory entry with the same index.
 		// 
 		// To make insertion and removal operations atomic, we need to make sure that both the beginning
@@ -90,6 +112,24 @@ export namespace Brawler
 		[[nodiscard("ERROR: ThreadSafeQueue::PushBack() can fail if the queue is full. A failed insertion is almost certainly not acceptable behavior.")]]
 		bool PushBack(U&& val);
 
+		/// <summary>
+		/// Attempts to insert as many elements from valueSpan into the queue as possible. Space for
+		/// all of the inserted elements is claimed with a single compare/exchange operation, so this
+		/// is considerably cheaper than calling ThreadSafeQueue::PushBack() once for each element.
+		/// 
+		/// Elements are inserted in order, starting from the front of valueSpan. Every element which
+		/// was inserted is moved from; the remaining elements are left untouched.
+		/// </summary>
+		/// <param name="valueSpan">
+		/// - The elements which are to be inserted to the back of the queue.
+		/// </param>
+		/// <returns>
+		/// The function returns the number of elements which were inserted into the queue. This can
+		/// be less than valueSpan.size() if the queue does not have enough free space.
+		/// </returns>
+		[[nodiscard("ERROR: ThreadSafeQueue::PushBackRange() can fail to insert some elements if the queue is full. A failed insertion is almost certainly not acceptable behavior.")]]
+		std::size_t PushBackRange(const std::span<T> valueSpan);
+
 		/// <summary>
 		/// Attempts to remove the element at the front of the queue. If the function succeeds, then the returned
 		/// std::optional instance contains the element which was claimed from the queue. Otherwise, the returned
@@ -121,6 +161,11 @@ export namespace Brawler
 		bool IsEmpty() const;
 
 	private:
+		template <typename U>
+		void WriteClaimedElement(const std::size_t claimedIndex, U&& val);
+
+		T ReadClaimedElement(const std::size_t claimedIndex);
+
 		std::uint64_t PackOffsets(const QueueInfo& queueInfo) const;
 		QueueInfo UnpackOffsets(const std::uint64_t packedOffsets) const;
 
@@ -143,7 +188,7 @@ export namespace Brawler
 		// but then we would need to make heap allocations. Trust me: From a pure efficiency
 		// point of view, this is better.
 
-		std::array<QueueElementPtr, (NumElements + 1)> mArr;
+		std::array<QueueSlotState, (NumElements + 1)> mArr;
 		std::array<T, (NumElements + 1)> mBackingMemory;
 		std::atomic<std::uint64_t> mPackedOffsets;
 	};
@@ -187,17 +232,56 @@ namespace Brawler
 			newCurrOffsets = PackOffsets(desiredClaim);
 		} while (!mPackedOffsets.compare_exchange_weak(currOffsets, newCurrOffsets));
 
-		mBackingMemory[claimedIndex] = std::forward<U>(val);
-		mArr[claimedIndex].store(&(mBackingMemory[claimedIndex]));
+		WriteClaimedElement(claimedIndex, std::forward<U>(val));
 
 		return true;
 	}
 
+	template <typename T, std::size_t NumElements>
+	std::size_t ThreadSafeQueue<T, NumElements>::PushBackRange(const std::span<T> valueSpan)
+	{
+		if (valueSpan.empty()) [[unlikely]]
+			return 0;
+		
+		std::uint64_t currOffsets = mPackedOffsets.load();
+		std::size_t firstClaimedIndex = 0;
+		std::size_t numClaimedElements = 0;
+		std::uint64_t newCurrOffsets = 0;
+
+		// This works just like ThreadSafeQueue::PushBack(), except that we move EndIndex forward
+		// by as many elements as will fit in the queue, rather than just one.
+		do
+		{
+			QueueInfo desiredClaim{ UnpackOffsets(currOffsets) };
+
+			const std::size_t numUsedElements = ((desiredClaim.EndIndex + mArr.size() - desiredClaim.BeginIndex) % mArr.size());
+			const std::size_t numFreeElements = (NumElements - numUsedElements);
+
+			// If the queue is full, then we cannot insert anything.
+			if (numFreeElements == 0)
+				return 0;
+
+			firstClaimedIndex = static_cast<std::size_t>(desiredClaim.EndIndex);
+			numClaimedElements = std::min(numFreeElements, valueSpan.size());
+			desiredClaim.EndIndex = static_cast<std::uint32_t>((desiredClaim.EndIndex + numClaimedElements) % mArr.size());
+
+			newCurrOffsets = PackOffsets(desiredClaim);
+		} while (!mPackedOffsets.compare_exchange_weak(currOffsets, newCurrOffsets));
+
+		for (std::size_t i = 0; i < numClaimedElements; ++i)
+		{
+			const std::size_t claimedIndex = ((firstClaimedIndex + i) % mArr.size());
+			WriteClaimedElement(claimedIndex, std::move(valueSpan[i]));
+		}
+
+		return numClaimedElements;
+	}
+
 	template <typename T, std::size_t NumElements>
 	std::optional<T> ThreadSafeQueue<T, NumElements>::TryPop()
 	{
 		std::uint64_t currOffsets = mPackedOffsets.load();
-		QueueElementPtr* claimedPtr = nullptr;
+		std::size_t claimedIndex = 0;
 		std::uint64_t newCurrOffsets = 0;
 
 		do
@@ -208,26 +292,22 @@ namespace Brawler
 			if (queueInfo.BeginIndex == queueInfo.EndIndex)
 				return std::optional<T>{};
 
-			claimedPtr = &(mArr[queueInfo.BeginIndex]);
+			claimedIndex = static_cast<std::size_t>(queueInfo.BeginIndex);
 			queueInfo.BeginIndex = ((queueInfo.BeginIndex + 1) % mArr.size());
 
 			newCurrOffsets = PackOffsets(queueInfo);
 		} while (!mPackedOffsets.compare_exchange_weak(currOffsets, newCurrOffsets));
 
-		// Wait for the element to be filled.
-		T* claimedElement = nullptr;
-		while (!claimedPtr->compare_exchange_weak(claimedElement, nullptr) || claimedElement == nullptr);
-
-		return std::optional<T>{std::move(*claimedElement)};
+		return std::optional<T>{ ReadClaimedElement(claimedIndex) };
 	}
 
 	template <typename T, std::size_t NumElements>
 	bool ThreadSafeQueue<T, NumElements>::IsLockFree()
 	{
 		static std::atomic<std::uint64_t> atomicIntTest{};
-		static std::atomic<T*> atomicPtrTest{};
+		static QueueSlotState atomicSlotStateTest{};
 
-		return atomicIntTest.is_lock_free() && atomicPtrTest.is_lock_free();
+		return atomicIntTest.is_lock_free() && atomicSlotStateTest.is_lock_free();
 	}
 
 	template <typename T, std::size_t NumElements>
@@ -237,6 +317,36 @@ namespace Brawler
 		return (queueInfo.BeginIndex == queueInfo.EndIndex);
 	}
 
+	template <typename T, std::size_t NumElements>
+	template <typename U>
+	void ThreadSafeQueue<T, NumElements>::WriteClaimedElement(const std::size_t claimedIndex, U&& val)
+	{
+		QueueSlotState& slotState{ mArr[claimedIndex] };
+
+		// Wait for any consumer which claimed the previous element in this slot to finish
+		// moving it out.
+		while (slotState.load(std::memory_order::acquire) != SlotState::EMPTY);
+
+		mBackingMemory[claimedIndex] = std::forward<U>(val);
+		slotState.store(SlotState::FILLED, std::memory_order::release);
+	}
+
+	template <typename T, std::size_t NumElements>
+	T ThreadSafeQueue<T, NumElements>::ReadClaimedElement(const std::size_t claimedIndex)
+	{
+		QueueSlotState& slotState{ mArr[claimedIndex] };
+
+		// Wait for the element to be filled.
+		SlotState expectedState = SlotState::FILLED;
+		while (!slotState.compare_exchange_weak(expectedState, SlotState::CONSUMING, std::memory_order::acquire, std::memory_order::relaxed))
+			expectedState = SlotState::FILLED;
+
+		T claimedElement{ std::move(mBackingMemory[claimedIndex]) };
+		slotState.store(SlotState::EMPTY, std::memory_order::release);
+
+		return claimedElement;
+	}
+
 	template <typename T, std::size_t NumElements>
 	std::uint64_t ThreadSafeQueue<T, NumElements>::PackOffsets(const QueueInfo& queueInfo) const
 	{
@@ -1,23 +1,16 @@
 module;
-#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
 #include "DxDef.h"
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 module Util.Threading;
 import Brawler.WorkerThreadPool;
-
-namespace
-{
-	struct ThreadAffinityInfo
-	{
-		KAFFINITY CurrentMask;
-		WORD CurrentProcessorGroup;
-
-		ThreadAffinityInfo() :
-			CurrentMask(1),
-			CurrentProcessorGroup(0)
-		{}
-	};
-}
+import Brawler.CPUTopology;
 
 namespace Brawler
 {
@@ -28,34 +21,21 @@ namespace Util
 {
 	namespace Threading
 	{
-		void LockCurrentThreadToUnassignedCore()
+		void LockCurrentThreadToLogicalProcessor(const Brawler::LogicalProcessorInfo& logicalProcessorInfo)
 		{
-			static std::mutex currAffinityCritSection{};
-			static ThreadAffinityInfo currAffinityInfo{};
-
-			ThreadAffinityInfo unassignedInfo{};
-
-			{
-				std::scoped_lock<std::mutex> lk{ currAffinityCritSection };
-
-				unassignedInfo = currAffinityInfo;
-
-				currAffinityInfo.CurrentMask <<= 1;
-
-				// If we have shifted left too many times, then there are no more free cores in the
-				// current processor group.
-				if (!currAffinityInfo.CurrentMask)
-				{
-					++currAffinityInfo.CurrentProcessorGroup;
-					currAffinityInfo.CurrentMask = 1;
-				}
-			}
-
+#ifdef _WIN32
 			GROUP_AFFINITY groupAffinity{};
-			groupAffinity.Group = unassignedInfo.CurrentProcessorGroup;
-			groupAffinity.Mask = unassignedInfo.CurrentMask;
+			groupAffinity.Group = logicalProcessorInfo.ProcessorGroup;
+			groupAffinity.Mask = (static_cast<KAFFINITY>(1) << logicalProcessorInfo.ProcessorNumber);
 
 			SetThreadGroupAffinity(GetCurrentThread(), &groupAffinity, nullptr);
+#else
+			cpu_set_t cpuSet{};
+			CPU_ZERO(&cpuSet);
+			CPU_SET(logicalProcessorInfo.ProcessorNumber, &cpuSet);
+
+			pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#endif
 		}
 
 		bool IsMainThread()
@@ -2,6 +2,7 @@ module;
 
 export module Util.Threading;
 import Brawler.ThreadLocalResources;
+import Brawler.CPUTopology;
 
 export namespace Brawler
 {
@@ -12,13 +13,13 @@ export namespace Util
 {
 	namespace Threading
 	{
-		// Sets the affinity of the current thread to a unique logical CPU core. The function
-		// assumes that it will only be called at most once for each core, and does no error
-		// checking to verify this.
+		// Sets the affinity of the current thread to the specified logical processor. Use
+		// Brawler::CPUTopology::CreateThreadPlacement() to decide which logical processor each
+		// thread should be locked to.
 		//
 		// NOTE: This function is processor group-aware (see 
 		// https://docs.microsoft.com/en-us/windows/win32/procthread/processor-groups).
-		void LockCurrentThreadToUnassignedCore();
+		void LockCurrentThreadToLogicalProcessor(const Brawler::LogicalProcessorInfo& logicalProcessorInfo);
 
 		// Returns true if the calling thread is the main thread (i.e., not a WorkerThread)
 		// and false otherwise.
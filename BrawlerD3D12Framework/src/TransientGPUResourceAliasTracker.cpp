@@ -5,12 +5,15 @@ module;
 #include <algorithm>
 #include <cassert>
 #include <array>
+#include <vector>
+#include <memory_resource>
 #include "DxDef.h"
 
 module Brawler.D3D12.TransientGPUResourceAliasTracker;
 import Brawler.D3D12.I_GPUResource;
 import Brawler.SortedVector;
 import Util.Engine;
+import Brawler.FrameLinearAllocator;
 
 namespace
 {
@@ -84,15 +87,19 @@ namespace Brawler
 				return (reinterpret_cast<std::size_t>(lhs) < reinterpret_cast<std::size_t>(rhs));
 			};
 
-			std::set<const TransientGPUResourceInfo*, decltype(SORT_TRANSIENT_GPU_RESOURCE_INFO_LAMBDA)> sortedResourceInfoSet{};
+			// All of the containers in here are thrown away once this function returns, and they see
+			// a lot of small allocations (especially the std::set), so they all take their memory from
+			// the FrameLinearAllocator.
+			std::pmr::memory_resource& frameLinearMemoryResource{ Util::Engine::GetFrameLinearMemoryResource() };
+			std::pmr::set<const TransientGPUResourceInfo*, decltype(SORT_TRANSIENT_GPU_RESOURCE_INFO_LAMBDA)> sortedResourceInfoSet{ &frameLinearMemoryResource };
 
 			for (const auto& [resourcePtr, resourceInfo] : mResourceLifetimeMap)
 				sortedResourceInfoSet.insert(&resourceInfo);
 
 			while (!sortedResourceInfoSet.empty())
 			{
-				std::vector<const TransientGPUResourceInfo*> aliasableResourceInfoArr{};
-				std::ranges::for_each(sortedResourceInfoSet, [this, &aliasableResourceInfoArr] (const TransientGPUResourceInfo* const& currInfo)
+				std::pmr::vector<const TransientGPUResourceInfo*> aliasableResourceInfoArr{ &frameLinearMemoryResource };
+				std::ranges::for_each(sortedResourceInfoSet, [this, &aliasableResourceInfoArr, &frameLinearMemoryResource] (const TransientGPUResourceInfo* const& currInfo)
 				{
 					// We can skip all of this logic if aliasableResourceInfoArr is currently empty.
 					if (aliasableResourceInfoArr.empty())
@@ -132,7 +139,7 @@ namespace Brawler
 					//
 					// So, before we can assume that the resources are perfectly aliasable with each
 					// other, we need to verify that the hardware supports it.
-					std::vector<I_GPUResource*> resourcesToAlias{};
+					std::pmr::vector<I_GPUResource*> resourcesToAlias{ &frameLinearMemoryResource };
 					resourcesToAlias.reserve(aliasableResourceInfoArr.size() + 1);
 
 					for (const auto aliasableResourceInfoPtr : aliasableResourceInfoArr)
@@ -0,0 +1,302 @@
+module;
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <array>
+#include <optional>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <span>
+#include <algorithm>
+
+export module Brawler.WorkStealingDeque;
+
+// Brawler::WorkStealingDeque is a fixed-capacity implementation of the Chase-Lev work-stealing
+// deque. Every deque has exactly one owner thread, which is allowed to push elements to and pop
+// elements from the bottom of the deque. Any other thread may "steal" elements from the top of
+// the deque.
+//
+// The nice thing about this is that the owner thread almost never has to perform a compare/exchange
+// operation: it only needs to do so when it is racing with thieves for the very last element in the
+// deque. Contrast this with Brawler::ThreadSafeQueue, in which *every* PushBack() and TryPop() call
+// from *every* thread needs to perform a compare/exchange on the same atomic value. Since we give each
+// thread its own deque, threads will only ever touch each other's cache lines when they run out of
+// work of their own.
+//
+// Like Brawler::ThreadSafeQueue, the deque does not make any heap allocations, and its capacity is
+// fixed. If the deque is full, then WorkStealingDeque::PushBottom() fails, and it is the caller's
+// responsibility to put the element somewhere else.
+
+export namespace Brawler
+{
+	template <typename T, std::size_t NumElements>
+	class WorkStealingDeque
+	{
+	private:
+		static_assert(NumElements > 0, "ERROR: An attempt was made to create a WorkStealingDeque with no elements!");
+		static_assert(NumElements <= static_cast<std::size_t>(std::numeric_limits<std::int64_t>::max()), "ERROR: An attempt was made to create a WorkStealingDeque whose capacity cannot be represented by a std::int64_t!");
+
+	private:
+		// A thief only takes ownership of an element *after* it successfully increments mTop. At that
+		// point, the owner thread is free to push a new element into the same slot of the ring buffer
+		// if the deque wraps around. To prevent the owner from overwriting an element which is still
+		// being moved out of the deque, we use the same trick as Brawler::ThreadSafeQueue: each slot
+		// holds an atomic pointer into the backing memory, and this pointer is only reset to nullptr
+		// after the element has been moved out. The owner thread will never write to a slot whose
+		// pointer is not nullptr.
+		using DequeElementPtr = std::atomic<T*>;
+
+	public:
+		WorkStealingDeque();
+
+		WorkStealingDeque(const WorkStealingDeque& rhs) = delete;
+		WorkStealingDeque& operator=(const WorkStealingDeque& rhs) = delete;
+
+		WorkStealingDeque(WorkStealingDeque&& rhs) noexcept = delete;
+		WorkStealingDeque& operator=(WorkStealingDeque&& rhs) noexcept = delete;
+
+		/// <summary>
+		/// Attempts to insert the element val into the bottom of the deque. This function
+		/// must *ONLY* be called by the thread which owns this WorkStealingDeque instance.
+		/// </summary>
+		/// <param name="val">
+		/// - The value to be inserted to the bottom of the deque.
+		/// </param>
+		/// <returns>
+		/// This function returns true if the insertion succeeded and false otherwise. Specifically,
+		/// if the deque is full, then this function returns false.
+		/// </returns>
+		template <typename U = T>
+			requires std::is_same_v<std::decay_t<U>, std::decay_t<T>>
+		[[nodiscard("ERROR: WorkStealingDeque::PushBottom() can fail if the deque is full. The element must be stored elsewhere in that case.")]]
+		bool PushBottom(U&& val);
+
+		/// <summary>
+		/// Attempts to insert as many elements from valueSpan into the bottom of the deque as
+		/// possible. The inserted elements only become visible to thieves once all of them
+		/// have been written, and they are published with a single atomic store. This function
+		/// must *ONLY* be called by the thread which owns this WorkStealingDeque instance.
+		/// 
+		/// Elements are inserted in order, starting from the front of valueSpan. Every element
+		/// which was inserted is moved from; the remaining elements are left untouched.
+		/// </summary>
+		/// <param name="valueSpan">
+		/// - The elements which are to be inserted to the bottom of the deque.
+		/// </param>
+		/// <returns>
+		/// The function returns the number of elements which were inserted into the deque. This
+		/// can be less than valueSpan.size() if the deque does not have enough free space.
+		/// </returns>
+		[[nodiscard("ERROR: WorkStealingDeque::PushBottomRange() can fail to insert some elements if the deque is full. These elements must be stored elsewhere in that case.")]]
+		std::size_t PushBottomRange(const std::span<T> valueSpan);
+
+		/// <summary>
+		/// Attempts to remove the element at the bottom of the deque; that is, the element
+		/// which was most recently pushed. This function must *ONLY* be called by the thread
+		/// which owns this WorkStealingDeque instance.
+		/// </summary>
+		/// <returns>
+		/// If the function succeeds, then the returned std::optional instance contains the
+		/// element which was claimed from the deque. Otherwise, the returned std::optional
+		/// instance has no valid value.
+		/// </returns>
+		std::optional<T> TryPopBottom();
+
+		/// <summary>
+		/// Attempts to remove the element at the top of the deque; that is, the oldest element
+		/// in the deque. This function can be called by any thread.
+		///
+		/// The function will fail if either the deque is empty or another thread claimed
+		/// the element at the top of the deque first. In the latter case, it is generally
+		/// better to go look at a different deque than to try again.
+		/// </summary>
+		/// <returns>
+		/// If the function succeeds, then the returned std::optional instance contains the
+		/// element which was stolen from the deque. Otherwise, the returned std::optional
+		/// instance has no valid value.
+		/// </returns>
+		std::optional<T> TrySteal();
+
+		/// <summary>
+		/// Checks to see whether the deque is empty or not. Like ThreadSafeQueue::IsEmpty(),
+		/// the returned value is only a snapshot, and it may be outdated by the time the
+		/// caller receives it.
+		/// </summary>
+		/// <returns>
+		/// This function returns true if the deque is empty at the time of calling this and
+		/// false otherwise.
+		/// </returns>
+		bool IsEmpty() const;
+
+		/// <summary>
+		/// Gets the number of elements in the deque. Like WorkStealingDeque::IsEmpty(), the
+		/// returned value is only a snapshot.
+		/// </summary>
+		std::size_t GetSize() const;
+
+	private:
+		std::optional<T> ExtractElement(const std::int64_t index);
+
+	private:
+		// mTop is written to by thieves, while mBottom is only ever written to by the owner thread.
+		// Keeping them on separate cache lines prevents every push and pop from the owner thread
+		// from invalidating the cache line which the thieves are spinning on.
+		alignas(std::hardware_destructive_interference_size) std::atomic<std::int64_t> mTop;
+		alignas(std::hardware_destructive_interference_size) std::atomic<std::int64_t> mBottom;
+		alignas(std::hardware_destructive_interference_size) std::array<DequeElementPtr, NumElements> mArr;
+		std::array<T, NumElements> mBackingMemory;
+	};
+}
+
+// --------------------------------------------------------------------------------------------------
+
+namespace Brawler
+{
+	template <typename T, std::size_t NumElements>
+	WorkStealingDeque<T, NumElements>::WorkStealingDeque() :
+		mTop(0),
+		mBottom(0),
+		mArr(),
+		mBackingMemory()
+	{}
+
+	template <typename T, std::size_t NumElements>
+	template <typename U>
+		requires std::is_same_v<std::decay_t<U>, std::decay_t<T>>
+	bool WorkStealingDeque<T, NumElements>::PushBottom(U&& val)
+	{
+		const std::int64_t bottom = mBottom.load(std::memory_order::relaxed);
+		const std::int64_t top = mTop.load(std::memory_order::acquire);
+
+		if ((bottom - top) >= static_cast<std::int64_t>(NumElements))
+			return false;
+
+		const std::size_t slotIndex = static_cast<std::size_t>(bottom % static_cast<std::int64_t>(NumElements));
+		DequeElementPtr& slotPtr{ mArr[slotIndex] };
+
+		// Wait for any thief which claimed the previous element in this slot to finish moving
+		// it out. This will almost never actually spin.
+		while (slotPtr.load(std::memory_order::acquire) != nullptr);
+
+		mBackingMemory[slotIndex] = std::forward<U>(val);
+		slotPtr.store(&(mBackingMemory[slotIndex]), std::memory_order::release);
+
+		mBottom.store(bottom + 1, std::memory_order::release);
+		return true;
+	}
+
+	template <typename T, std::size_t NumElements>
+	std::size_t WorkStealingDeque<T, NumElements>::PushBottomRange(const std::span<T> valueSpan)
+	{
+		const std::int64_t bottom = mBottom.load(std::memory_order::relaxed);
+		const std::int64_t top = mTop.load(std::memory_order::acquire);
+
+		const std::size_t numFreeElements = (NumElements - static_cast<std::size_t>(bottom - top));
+		const std::size_t numInsertedElements = std::min(numFreeElements, valueSpan.size());
+
+		for (std::size_t i = 0; i < numInsertedElements; ++i)
+		{
+			const std::size_t slotIndex = static_cast<std::size_t>((bottom + static_cast<std::int64_t>(i)) % static_cast<std::int64_t>(NumElements));
+			DequeElementPtr& slotPtr{ mArr[slotIndex] };
+
+			while (slotPtr.load(std::memory_order::acquire) != nullptr);
+
+			mBackingMemory[slotIndex] = std::move(valueSpan[i]);
+			slotPtr.store(&(mBackingMemory[slotIndex]), std::memory_order::release);
+		}
+
+		if (numInsertedElements > 0)
+			mBottom.store(bottom + static_cast<std::int64_t>(numInsertedElements), std::memory_order::release);
+
+		return numInsertedElements;
+	}
+
+	template <typename T, std::size_t NumElements>
+	std::optional<T> WorkStealingDeque<T, NumElements>::TryPopBottom()
+	{
+		const std::int64_t bottom = mBottom.load(std::memory_order::relaxed) - 1;
+		mBottom.store(bottom, std::memory_order::relaxed);
+
+		// This fence makes sure that our write to mBottom is visible to thieves before we read mTop.
+		// Without it, both the owner thread and a thief could claim the last element in the deque.
+		std::atomic_thread_fence(std::memory_order::seq_cst);
+
+		std::int64_t top = mTop.load(std::memory_order::relaxed);
+
+		// If the deque is empty, then restore mBottom and return nothing.
+		if (top > bottom)
+		{
+			mBottom.store(bottom + 1, std::memory_order::relaxed);
+			return std::optional<T>{};
+		}
+
+		// If there is more than one element left, then no thief can be racing us for the
+		// element at the bottom.
+		if (top < bottom)
+			return ExtractElement(bottom);
+
+		// Otherwise, this is the last element in the deque. We need to race the thieves for it
+		// by trying to increment mTop ourselves.
+		const bool wonRace = mTop.compare_exchange_strong(top, top + 1, std::memory_order::seq_cst, std::memory_order::relaxed);
+		mBottom.store(bottom + 1, std::memory_order::relaxed);
+
+		return (wonRace ? ExtractElement(bottom) : std::optional<T>{});
+	}
+
+	template <typename T, std::size_t NumElements>
+	std::optional<T> WorkStealingDeque<T, NumElements>::TrySteal()
+	{
+		std::int64_t top = mTop.load(std::memory_order::acquire);
+		std::atomic_thread_fence(std::memory_order::seq_cst);
+		const std::int64_t bottom = mBottom.load(std::memory_order::acquire);
+
+		if (top >= bottom)
+			return std::optional<T>{};
+
+		if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order::seq_cst, std::memory_order::relaxed))
+			return std::optional<T>{};
+
+		return ExtractElement(top);
+	}
+
+	template <typename T, std::size_t NumElements>
+	bool WorkStealingDeque<T, NumElements>::IsEmpty() const
+	{
+		const std::int64_t top = mTop.load(std::memory_order::acquire);
+		const std::int64_t bottom = mBottom.load(std::memory_order::acquire);
+
+		return (top >= bottom);
+	}
+
+	template <typename T, std::size_t NumElements>
+	std::size_t WorkStealingDeque<T, NumElements>::GetSize() const
+	{
+		const std::int64_t top = mTop.load(std::memory_order::acquire);
+		const std::int64_t bottom = mBottom.load(std::memory_order::acquire);
+
+		// The owner temporarily decrements mBottom in TryPopBottom(), so bottom can briefly
+		// be less than top.
+		return (top >= bottom ? 0 : static_cast<std::size_t>(bottom - top));
+	}
+
+	template <typename T, std::size_t NumElements>
+	std::optional<T> WorkStealingDeque<T, NumElements>::ExtractElement(const std::int64_t index)
+	{
+		DequeElementPtr& slotPtr{ mArr[static_cast<std::size_t>(index % static_cast<std::int64_t>(NumElements))] };
+
+		// The owner thread always stores the element pointer before publishing the new value
+		// of mBottom, so this should never actually spin. We check anyways for correctness.
+		T* claimedElement = nullptr;
+		while ((claimedElement = slotPtr.load(std::memory_order::acquire)) == nullptr);
+
+		std::optional<T> extractedElement{ std::move(*claimedElement) };
+
+		// Only now that we have moved the element out of the backing memory can we let the
+		// owner thread re-use this slot.
+		slotPtr.store(nullptr, std::memory_order::release);
+
+		return extractedElement;
+	}
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 module;
 #include <thread>
 #include <exception>
+#include "DxDef.h"
 
 module Brawler.WorkerThread;
 import Util.Threading;
@@ -9,6 +10,7 @@ import Brawler.WorkerThreadPool;
 import Util.General;
 import Util.Coroutine;
 import Brawler.DelayedJobSubmitter;
+import Brawler.ThreadParkingLot;
 
 namespace Brawler
 {
@@ -43,6 +45,11 @@ namespace Brawler
 		return mThread.get_id();
 	}
 
+	std::uint32_t WorkerThread::GetThreadIndex() const
+	{
+		return mResources.GetThreadIndex();
+	}
+
 	void WorkerThread::KillThread()
 	{
 		mKeepGoing.store(false);
@@ -56,11 +63,20 @@ namespace Brawler
 
 	void WorkerThread::Initialize()
 	{
-		Util::Threading::LockCurrentThreadToUnassignedCore();
+		Util::Threading::LockCurrentThreadToLogicalProcessor(mPool->GetThreadPlacement(mResources.GetThreadIndex()));
 	}
 
 	void WorkerThread::ExecuteMainLoop()
 	{
+		const WorkerThreadIdlePolicy& idlePolicy{ mPool->GetIdlePolicy() };
+
+		// This is the number of consecutive failed attempts to acquire a job.
+		std::uint32_t idleIterationCount = 0;
+
+		// This is true if the thread was woken up from the ThreadParkingLot and has not
+		// executed a job since.
+		bool isAwaitingJobAfterWakeUp = false;
+
 		while (mKeepGoing.load() && mPool->IsActive())
 		{
 			try
@@ -68,10 +84,40 @@ namespace Brawler
 				const std::uint32_t previousJobQueueNotifierValue = mPool->GetCurrentJobQueueNotifierValue();
 				const bool jobExecuted = Util::Coroutine::TryExecuteJob();
 
-				if (!jobExecuted && IsWorkerThreadPoolWaitAcceptable()) [[likely]]
-					mPool->WaitForJobDispatch(previousJobQueueNotifierValue);
-				else [[unlikely]]
+				if (jobExecuted)
+				{
+					idleIterationCount = 0;
+					isAwaitingJobAfterWakeUp = false;
+
+					continue;
+				}
+
+				if (!IsWorkerThreadPoolWaitAcceptable()) [[unlikely]]
+				{
 					OnWorkerThreadPoolWaitDenied();
+					continue;
+				}
+
+				// Parking a thread is expensive, and so is waking it up again. If jobs are coming
+				// in at a steady rate, then we are better off spinning for a little while before
+				// we go to sleep.
+				++idleIterationCount;
+
+				if (idleIterationCount <= idlePolicy.SpinIterationCount)
+					YieldProcessor();
+				else if (idleIterationCount <= (idlePolicy.SpinIterationCount + idlePolicy.YieldIterationCount))
+					std::this_thread::yield();
+				else
+				{
+					if (isAwaitingJobAfterWakeUp)
+						mPool->ReportSpuriousWakeUp();
+
+					isAwaitingJobAfterWakeUp = mPool->WaitForJobDispatch(previousJobQueueNotifierValue);
+
+					// Whether we were actually parked or not, new jobs were dispatched, so we
+					// start spinning again from the beginning.
+					idleIterationCount = 0;
+				}
 			}
 			catch (...)
 			{
@@ -83,7 +129,7 @@ namespace Brawler
 
 	bool WorkerThread::IsWorkerThreadPoolWaitAcceptable() const
 	{
-		// The following list of scenarios are undesirable to perform an atomic wait in:
+		// The following list of scenarios are undesirable to park the thread in:
 
 		//   - The WorkerThread has any delayed CPU jobs to check for.
 		if (mResources.GetDelayedJobSubmitter().HasDelayedJobsToCheck()) [[unlikely]]
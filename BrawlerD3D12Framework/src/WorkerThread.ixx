@@ -26,6 +26,7 @@ export namespace Brawler
 		WorkerThread& operator=(WorkerThread&& rhs) noexcept = default;
 
 		std::thread::id GetThreadID() const;
+		std::uint32_t GetThreadIndex() const;
 		void KillThread();
 		void Join();
 
@@ -4,29 +4,66 @@ module;
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <optional>
+#include <utility>
+#include <span>
+#include <algorithm>
 
 module Brawler.WorkerThreadPool;
 import Util.Threading;
 import Brawler.WorkerThread;
+import Brawler.CPUTopology;
+import Brawler.JobTrace;
+
+namespace
+{
+	static constexpr std::uint64_t INVALID_POOL_ID = 0;
+
+	std::uint64_t CreatePoolID()
+	{
+		static std::atomic<std::uint64_t> nextPoolID{ INVALID_POOL_ID + 1 };
+		return nextPoolID.fetch_add(1, std::memory_order::relaxed);
+	}
+}
 
 namespace Brawler
 {
-	WorkerThreadPool::WorkerThreadPool(std::uint32_t numWorkerThreads) :
-		mJobQueueArr(),
-		mJobQueueNotifier(),
+	WorkerThreadPool::WorkerThreadPool(std::uint32_t numWorkerThreads, const WorkerThreadIdlePolicy& idlePolicy, const ThreadPlacementPolicy placementPolicy) :
+		mThreadPlacementArr(CPUTopology::QuerySystemTopology().CreateThreadPlacement(placementPolicy, static_cast<std::size_t>(numWorkerThreads) + 1)),
+		mNodeJobQueuesArr(),
+		mThreadJobQueuesArr(),
+		mParkingLot(numWorkerThreads + 1),
+		mIdlePolicy(idlePolicy),
 		mThreadArr(),
 		mThreadMap(),
 		mMainThreadInfo(std::this_thread::get_id()),
 		mInitialized(false),
-		mActive(true)
+		mActive(true),
+		mPoolID(CreatePoolID())
 	{
 		mThreadArr.reserve(numWorkerThreads);
 
+		// Every placement policy fills the NUMA nodes starting from the first one, so the
+		// threads are always placed on the nodes [0, numNodes).
+		const std::uint32_t numNodes = (std::ranges::max(mThreadPlacementArr, {}, &LogicalProcessorInfo::NUMANodeIndex).NUMANodeIndex + 1);
+		mNodeJobQueuesArr.reserve(numNodes);
+
+		for (std::uint32_t i = 0; i < numNodes; ++i)
+			mNodeJobQueuesArr.push_back(std::make_unique<NodeJobQueues>());
+
+		// Create the local job deques for every thread, including the main thread, before any
+		// of the worker threads are created. That way, a thread will never try to steal from
+		// a set of deques which does not yet exist.
+		mThreadJobQueuesArr.reserve(static_cast<std::size_t>(numWorkerThreads) + 1);
+
+		for (std::uint32_t i = 0; i <= numWorkerThreads; ++i)
+			mThreadJobQueuesArr.push_back(std::make_unique<ThreadJobQueues>(i, mThreadPlacementArr[i].NUMANodeIndex));
+
 		// First, lock the main thread to its own CPU core.
-		Util::Threading::LockCurrentThreadToUnassignedCore();
+		Util::Threading::LockCurrentThreadToLogicalProcessor(mThreadPlacementArr[0]);
 
-		// Now, we can create the other worker threads. They will each be atomically assigned
-		// their own core automatically.
+		// Now, we can create the other worker threads. Each one locks itself to the logical
+		// processor chosen for its thread index.
 		for (std::uint32_t i = 0; i < numWorkerThreads; ++i)
 		{
 			// We start counting the thread indices here from 1 because index 0 is reserved for
@@ -34,7 +71,7 @@ namespace Brawler
 			const std::uint32_t currThreadIndex = (i + 1);
 			
 			mThreadArr.push_back(std::make_unique<Brawler::WorkerThread>(*this, currThreadIndex));
-			mThreadMap[mThreadArr[i]->GetThreadID()] = mThreadArr[i].get();
+			mThreadMap.TryEmplace(mThreadArr[i]->GetThreadID(), mThreadArr[i].get());
 		}
 	}
 
@@ -49,8 +86,7 @@ namespace Brawler
 		for (auto& thread : mThreadArr)
 			thread->KillThread();
 
-		mJobQueueNotifier.fetch_add(1, std::memory_order::release);
-		mJobQueueNotifier.notify_all();
+		mParkingLot.UnparkAllThreads();
 
 		for (auto& thread : mThreadArr)
 			thread->Join();
@@ -65,27 +101,31 @@ namespace Brawler
 		//
 		// Linus Torvalds gave a good rant about this very subject for Linux, and I'd be surprised
 		// if the same doesn't hold on other operating systems.
-		
-		// If we cannot store the job in the queue, then we must execute it immediately. (Alternatively,
-		// we could just do a spin lock for some time to see if space opens up, but wouldn't that time
-		// spent waiting be better spent executing actual work?)
-		//
-		// We also make sure to notify every thread which is currently waiting, because if this is
-		// happening, then the threads probably aren't getting any jobs for some stupid reason.
-		if (!mJobQueueArr[std::to_underlying(job.GetPriority())].PushBack(std::move(job))) [[unlikely]]
+
+		EnqueueJobs(std::span<Job>{ &job, 1 });
+		NotifyWorkerThreads(1);
+	}
+
+	void WorkerThreadPool::DispatchJobs(const std::span<Job> jobSpan)
+	{
+		if (jobSpan.empty()) [[unlikely]]
+			return;
+
+		// The queues are separated by priority, so we enqueue each contiguous run of jobs
+		// with the same priority at once. (The jobs of a JobGroup all have the same priority,
+		// so there is typically only one such run.)
+		std::size_t runBeginIndex = 0;
+
+		for (std::size_t i = 1; i <= jobSpan.size(); ++i)
 		{
-			mJobQueueNotifier.fetch_add(1, std::memory_order::relaxed);
-			mJobQueueNotifier.notify_all();
-			
-			job.Execute();
+			if (i == jobSpan.size() || jobSpan[i].GetPriority() != jobSpan[runBeginIndex].GetPriority())
+			{
+				EnqueueJobs(jobSpan.subspan(runBeginIndex, (i - runBeginIndex)));
+				runBeginIndex = i;
+			}
 		}
-		else
-		{
-			// If we did add a job to the queue, then we only need to notify one thread.
 
-			mJobQueueNotifier.fetch_add(1, std::memory_order::relaxed);
-			mJobQueueNotifier.notify_one();
-		}
+		NotifyWorkerThreads(jobSpan.size());
 	}
 
 	bool WorkerThreadPool::IsInitialized() const
@@ -108,6 +148,12 @@ namespace Brawler
 		return mThreadArr.size();
 	}
 
+	const LogicalProcessorInfo& WorkerThreadPool::GetThreadPlacement(const std::uint32_t threadIndex) const
+	{
+		assert(threadIndex < mThreadPlacementArr.size());
+		return mThreadPlacementArr[threadIndex];
+	}
+
 	std::optional<Job> WorkerThreadPool::AcquireQueuedJob()
 	{
 		// We can reasonably expect the main thread to call this function often enough
@@ -115,13 +161,67 @@ namespace Brawler
 		if (Util::Threading::IsMainThread())
 			HandleThrownExceptions();
 		
+		ThreadJobQueues* const localQueuesPtr = GetCurrentThreadJobQueues();
+
+		// Threads which do not belong to this WorkerThreadPool have no deque of their own and
+		// no NUMA node to prefer, so they can only take jobs from the shared queues.
+		if (localQueuesPtr == nullptr) [[unlikely]]
+		{
+			for (std::int32_t i = static_cast<std::int32_t>(JobPriority::COUNT) - 1; i >= 0; --i)
+			{
+				for (auto& nodeQueuesPtr : mNodeJobQueuesArr)
+				{
+					std::optional<Job> acquiredJob{ TryAcquireNodeJob(*nodeQueuesPtr, static_cast<JobPriority>(i)) };
+
+					if (acquiredJob.has_value())
+						return acquiredJob;
+				}
+			}
+
+			return std::optional<Job>{};
+		}
+
+		ThreadJobQueues& localQueues{ *localQueuesPtr };
+
 		// Attempt to acquire jobs from the queues in order of decreasing priority.
 		for (std::int32_t i = static_cast<std::int32_t>(JobPriority::COUNT) - 1; i >= 0; --i)
 		{
-			std::optional<Job> acquiredJob{ mJobQueueArr[i].TryPop() };
+			// Our own deque is checked first. The most recently pushed job is likely to
+			// still have its data in this thread's cache.
+			std::optional<Job> acquiredJob{ localQueues.DequeArr[i].TryPopBottom() };
 
 			if (acquiredJob.has_value())
 				return acquiredJob;
+
+			const JobPriority currPriority = static_cast<JobPriority>(i);
+			acquiredJob = TryAcquireNodeJob(*(mNodeJobQueuesArr[localQueues.NUMANodeIndex]), currPriority);
+
+			if (acquiredJob.has_value())
+				return acquiredJob;
+
+			acquiredJob = TryStealJob(localQueues, currPriority, true);
+
+			if (acquiredJob.has_value())
+				return acquiredJob;
+
+			// Only once there is nothing left to do on our own NUMA node do we take jobs from
+			// other nodes. Executing a job on a remote node means that its data has to come
+			// across the interconnect, but that is still better than sitting idle.
+			if (mNodeJobQueuesArr.size() > 1) [[unlikely]]
+			{
+				for (std::size_t j = 1; j < mNodeJobQueuesArr.size(); ++j)
+				{
+					acquiredJob = TryAcquireNodeJob(*(mNodeJobQueuesArr[(localQueues.NUMANodeIndex + j) % mNodeJobQueuesArr.size()]), currPriority);
+
+					if (acquiredJob.has_value())
+						return acquiredJob;
+				}
+
+				acquiredJob = TryStealJob(localQueues, currPriority, false);
+
+				if (acquiredJob.has_value())
+					return acquiredJob;
+			}
 		}
 		
 		return std::optional<Job>{};
@@ -142,24 +242,190 @@ namespace Brawler
 
 	std::uint32_t WorkerThreadPool::GetCurrentJobQueueNotifierValue() const
 	{
-		return mJobQueueNotifier.load(std::memory_order::acquire);
+		return mParkingLot.GetWakeUpEpoch();
 	}
 
-	void WorkerThreadPool::WaitForJobDispatch(const std::uint32_t previousJobQueueNotifierValue) const
+	bool WorkerThreadPool::WaitForJobDispatch(const std::uint32_t previousJobQueueNotifierValue)
 	{
 		assert(!Util::Threading::IsMainThread() && "ERROR: WorkerThreadPool::WaitForJobDispatch() should only be called by WorkerThreads!");
 
-		mJobQueueNotifier.wait(previousJobQueueNotifierValue, std::memory_order::acquire);
+		// Every thread parks in the space corresponding to its thread index.
+		return mParkingLot.ParkCurrentThread(Util::Threading::GetThreadLocalResources().GetThreadIndex(), previousJobQueueNotifierValue);
+	}
+
+	const WorkerThreadIdlePolicy& WorkerThreadPool::GetIdlePolicy() const
+	{
+		return mIdlePolicy;
+	}
+
+	void WorkerThreadPool::ReportSpuriousWakeUp()
+	{
+		mParkingLot.RecordSpuriousWakeUp();
+	}
+
+	ThreadParkingLot::Statistics WorkerThreadPool::GetParkingLotStatistics() const
+	{
+		return mParkingLot.GetStatistics();
 	}
 
 	WorkerThread* WorkerThreadPool::GetWorkerThread(std::thread::id threadID)
 	{
-		return mThreadMap[threadID];
+		return mThreadMap.TryGet(threadID).value_or(nullptr);
 	}
 
 	const WorkerThread* WorkerThreadPool::GetWorkerThread(std::thread::id threadID) const
 	{
-		return mThreadMap.at(threadID);
+		return mThreadMap.TryGet(threadID).value_or(nullptr);
+	}
+
+	bool WorkerThreadPool::IsCurrentThreadJobDequeEmpty(const JobPriority priority)
+	{
+		// A thread which does not belong to this WorkerThreadPool sends every job which it
+		// dispatches to a shared queue, where any idle thread can pick it up immediately. For
+		// splitting decisions, that is equivalent to having an empty deque.
+		const ThreadJobQueues* const localQueuesPtr = GetCurrentThreadJobQueues();
+		return (localQueuesPtr == nullptr || localQueuesPtr->DequeArr[std::to_underlying(priority)].IsEmpty());
+	}
+
+	WorkerThreadPool::ThreadJobQueues* WorkerThreadPool::GetCurrentThreadJobQueues()
+	{
+		// This is called for every dispatched and every dequeued job, so the result of the lookup is
+		// cached in a thread_local variable. The cache is tagged with the ID of the pool which it
+		// was filled for. Pool IDs are never reused, so a stale entry left behind by a destroyed
+		// WorkerThreadPool instance can never be mistaken for an entry of this one.
+		struct CachedThreadJobQueues
+		{
+			std::uint64_t PoolID;
+			ThreadJobQueues* JobQueuesPtr;
+		};
+
+		thread_local CachedThreadJobQueues cachedJobQueues{
+			.PoolID = INVALID_POOL_ID,
+			.JobQueuesPtr = nullptr
+		};
+
+		if (cachedJobQueues.PoolID == mPoolID) [[likely]]
+			return cachedJobQueues.JobQueuesPtr;
+
+		const std::thread::id currThreadID{ std::this_thread::get_id() };
+		ThreadJobQueues* currJobQueuesPtr = nullptr;
+
+		if (currThreadID == mMainThreadInfo.ThreadID)
+			currJobQueuesPtr = mThreadJobQueuesArr[mMainThreadInfo.Resources.GetThreadIndex()].get();
+		else
+		{
+			const WorkerThread* const currWorkerThread = GetWorkerThread(currThreadID);
+
+			// Threads which do not belong to this pool are not cached. That way, the cache of
+			// such a thread remains free for a pool which it actually belongs to, and these
+			// threads rarely dispatch jobs anyways.
+			if (currWorkerThread == nullptr) [[unlikely]]
+				return nullptr;
+
+			currJobQueuesPtr = mThreadJobQueuesArr[currWorkerThread->GetThreadIndex()].get();
+		}
+
+		cachedJobQueues = CachedThreadJobQueues{
+			.PoolID = mPoolID,
+			.JobQueuesPtr = currJobQueuesPtr
+		};
+
+		return currJobQueuesPtr;
+	}
+
+	std::optional<Job> WorkerThreadPool::TryAcquireNodeJob(NodeJobQueues& nodeQueues, const JobPriority priority)
+	{
+		std::optional<Job> acquiredJob{ nodeQueues.JobQueueArr[std::to_underlying(priority)].TryPop() };
+
+		if (acquiredJob.has_value())
+			return acquiredJob;
+
+		return nodeQueues.OverflowJobQueueArr[std::to_underlying(priority)].TryPop();
+	}
+
+	std::optional<Job> WorkerThreadPool::TryStealJob(ThreadJobQueues& thiefQueues, const JobPriority priority, const bool stealFromLocalNode)
+	{
+		const std::size_t numThreads = mThreadJobQueuesArr.size();
+
+		if (numThreads < 2) [[unlikely]]
+			return std::optional<Job>{};
+
+		// Pick a random thread to start stealing from. If every thread began with the same victim,
+		// then the thieves would all contend on the same deque.
+		std::uint32_t& randomState{ thiefQueues.VictimSelectionState };
+		randomState ^= (randomState << 13);
+		randomState ^= (randomState >> 17);
+		randomState ^= (randomState << 5);
+
+		const std::size_t startIndex = (static_cast<std::size_t>(randomState) % numThreads);
+
+		for (std::size_t i = 0; i < numThreads; ++i)
+		{
+			ThreadJobQueues& victimQueues{ *(mThreadJobQueuesArr[(startIndex + i) % numThreads]) };
+
+			if (&victimQueues == &thiefQueues || (victimQueues.NUMANodeIndex == thiefQueues.NUMANodeIndex) != stealFromLocalNode)
+				continue;
+
+			std::optional<Job> stolenJob{ victimQueues.DequeArr[std::to_underlying(priority)].TrySteal() };
+
+			if (stolenJob.has_value())
+			{
+				if constexpr (Util::JobTrace::IsJobTracingEnabled())
+					Util::JobTrace::RecordEvent(JobTraceEventType::JOB_STOLEN, ((startIndex + i) % numThreads));
+
+				return stolenJob;
+			}
+		}
+
+		return std::optional<Job>{};
+	}
+
+	void WorkerThreadPool::EnqueueJobs(const std::span<Job> jobSpan)
+	{
+		// Every job in jobSpan must have the same priority.
+		const std::size_t priorityIndex = std::to_underlying(jobSpan.front().GetPriority());
+		std::span<Job> remainingJobSpan{ jobSpan };
+
+		// We first try to push the jobs into the calling thread's own deque. This avoids touching
+		// any memory shared with other threads, unless another thread later decides to steal them.
+		// Whatever does not fit goes into the shared queue of the calling thread's NUMA node.
+		//
+		// Threads which do not belong to this WorkerThreadPool have no deque of their own. Their
+		// jobs are injected directly into the shared queues of the first NUMA node, which is
+		// always populated and is also where the main thread lives.
+		ThreadJobQueues* const localQueuesPtr = GetCurrentThreadJobQueues();
+		std::uint32_t nodeIndex = 0;
+
+		if (localQueuesPtr != nullptr) [[likely]]
+		{
+			remainingJobSpan = remainingJobSpan.subspan(localQueuesPtr->DequeArr[priorityIndex].PushBottomRange(remainingJobSpan));
+
+			if constexpr (Util::JobTrace::IsJobTracingEnabled())
+				Util::JobTrace::RecordEvent(JobTraceEventType::QUEUE_DEPTH, localQueuesPtr->DequeArr[priorityIndex].GetSize());
+
+			if (remainingJobSpan.empty()) [[likely]]
+				return;
+
+			nodeIndex = localQueuesPtr->NUMANodeIndex;
+		}
+
+		NodeJobQueues& nodeQueues{ *(mNodeJobQueuesArr[nodeIndex]) };
+		remainingJobSpan = remainingJobSpan.subspan(nodeQueues.JobQueueArr[priorityIndex].PushBackRange(remainingJobSpan));
+
+		// If even the shared queue is full, then the remaining jobs go into the overflow queue. We
+		// could execute them immediately instead, but that would serialize large JobGroups on the
+		// dispatching thread, and it could recurse arbitrarily deep if a job itself dispatches
+		// more jobs. The overflow queue needs to allocate a new segment every so often, but we
+		// only ever get here when the fixed-size queues are already saturated.
+		for (auto&& job : remainingJobSpan)
+			nodeQueues.OverflowJobQueueArr[priorityIndex].PushBack(std::move(job));
+	}
+
+	void WorkerThreadPool::NotifyWorkerThreads(const std::size_t numDispatchedJobs)
+	{
+		// There is no point in waking up more threads than there are new jobs. The
+		// ThreadParkingLot also skips the wake-up entirely if no thread is parked.
+		mParkingLot.UnparkThreads(numDispatchedJobs);
 	}
 
 	void WorkerThreadPool::HandleThrownExceptions()
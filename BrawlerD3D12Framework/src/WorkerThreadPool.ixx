@@ -2,8 +2,11 @@ module;
 #include <vector>
 #include <optional>
 #include <thread>
-#include <unordered_map>
 #include <exception>
+#include <array>
+#include <memory>
+#include <span>
+#include <cstdint>
 
 export module Brawler.WorkerThreadPool;
 import Brawler.WorkerThread;
@@ -12,12 +15,19 @@ import Brawler.JobPriority;
 import Brawler.ThreadLocalResources;
 import Util.Threading;
 import Brawler.ThreadSafeQueue;
+import Brawler.WorkStealingDeque;
+import Brawler.SegmentedThreadSafeQueue;
+import Brawler.ThreadParkingLot;
+import Brawler.CPUTopology;
+import Brawler.ConcurrentHashMap;
 
 namespace Brawler
 {
 	namespace IMPL
 	{
 		static constexpr std::size_t JOB_QUEUE_SIZE = 1024;
+		static constexpr std::size_t LOCAL_JOB_DEQUE_SIZE = 256;
+		static constexpr std::size_t OVERFLOW_JOB_QUEUE_SEGMENT_SIZE = 256;
 		static constexpr std::size_t EXCEPTION_QUEUE_SIZE = 16;
 	}
 }
@@ -41,12 +51,45 @@ export namespace Brawler
 			}
 		};
 
+		struct ThreadJobQueues
+		{
+			std::array<WorkStealingDeque<Brawler::Job, IMPL::LOCAL_JOB_DEQUE_SIZE>, std::to_underlying(JobPriority::COUNT)> DequeArr;
+
+			// This is the state of the xorshift generator used to pick victims when stealing
+			// jobs. It is only ever accessed by the thread which owns this ThreadJobQueues
+			// instance.
+			std::uint32_t VictimSelectionState;
+
+			// This is the NUMA node of the logical processor which the owning thread is locked to.
+			std::uint32_t NUMANodeIndex;
+
+			ThreadJobQueues(const std::uint32_t threadIndex, const std::uint32_t numaNodeIndex) :
+				DequeArr(),
+				VictimSelectionState(threadIndex + 1),
+				NUMANodeIndex(numaNodeIndex)
+			{}
+		};
+
+		struct NodeJobQueues
+		{
+			std::array<ThreadSafeQueue<Brawler::Job, IMPL::JOB_QUEUE_SIZE>, std::to_underlying(JobPriority::COUNT)> JobQueueArr;
+
+			// If both a thread's local deque and the shared queue of its NUMA node for a given
+			// priority are full, then jobs are sent to the corresponding overflow queue. These
+			// queues can grow indefinitely, so dispatching a job never fails.
+			std::array<SegmentedThreadSafeQueue<Brawler::Job, IMPL::OVERFLOW_JOB_QUEUE_SEGMENT_SIZE>, std::to_underlying(JobPriority::COUNT)> OverflowJobQueueArr;
+		};
+
 	private:
 		friend WorkerThread* Util::Threading::GetCurrentWorkerThread();
 		friend ThreadLocalResources& Util::Threading::GetThreadLocalResources();
 
 	public:
-		explicit WorkerThreadPool(std::uint32_t numWorkerThreads = (std::thread::hardware_concurrency() - 1));
+		explicit WorkerThreadPool(
+			std::uint32_t numWorkerThreads = (std::thread::hardware_concurrency() - 1),
+			const WorkerThreadIdlePolicy& idlePolicy = WorkerThreadIdlePolicy{},
+			const ThreadPlacementPolicy placementPolicy = ThreadPlacementPolicy::PHYSICAL_CORES_FIRST
+		);
 		~WorkerThreadPool();
 
 		WorkerThreadPool(const WorkerThreadPool& rhs) = delete;
@@ -56,6 +99,20 @@ export namespace Brawler
 		WorkerThreadPool& operator=(WorkerThreadPool&& rhs) noexcept = default;
 
 		void DispatchJob(Job&& job);
+
+		/// <summary>
+		/// Dispatches every job in jobSpan to the WorkerThreadPool. This is much cheaper than
+		/// calling WorkerThreadPool::DispatchJob() once for each job: contiguous runs of jobs
+		/// with the same priority are inserted into the queues with a single publishing atomic
+		/// operation per queue, and waiting worker threads are woken up once for the entire
+		/// batch, rather than once per job.
+		/// 
+		/// Every job in jobSpan is moved from after this function returns.
+		/// </summary>
+		/// <param name="jobSpan">
+		/// - The jobs which are to be dispatched.
+		/// </param>
+		void DispatchJobs(const std::span<Job> jobSpan);
 		bool IsInitialized() const;
 		void SetInitialized();
 
@@ -65,10 +122,19 @@ export namespace Brawler
 		// Returns the number of worker threads in the pool.
 		std::size_t GetWorkerThreadCount() const;
 
+		/// <summary>
+		/// Gets the logical processor which the thread with the specified thread index is
+		/// locked to. Thread index 0 refers to the main thread.
+		/// </summary>
+		const LogicalProcessorInfo& GetThreadPlacement(const std::uint32_t threadIndex) const;
+
 		/// <summary>
 		/// Attempts to retrieve a CPU job from one of the job queues in this
 		/// WorkerThreadPool instance. The queues are searched in the order of decreasing
-		/// priority.
+		/// priority. For each priority, the calling thread first checks its own local
+		/// deque, then the shared queue of its NUMA node, and then tries to steal a job from
+		/// the local deques of the other threads on its node. Only then are the queues and
+		/// threads of other NUMA nodes checked.
 		/// </summary>
 		/// <returns>
 		/// If a CPU job was extracted from one of the queues, then the returned
@@ -77,6 +143,21 @@ export namespace Brawler
 		/// </returns>
 		std::optional<Job> AcquireQueuedJob();
 
+		/// <summary>
+		/// Checks whether or not the local job deque of the calling thread for the specified
+		/// priority is empty. If it is, then any job which the calling thread dispatches is
+		/// likely to be stolen by an idle thread soon. Like WorkStealingDeque::IsEmpty(), the
+		/// returned value is only a snapshot.
+		/// </summary>
+		/// <param name="priority">
+		/// - The priority of the deque which is to be checked.
+		/// </param>
+		/// <returns>
+		/// The function returns true if the calling thread's local job deque for the specified
+		/// priority is empty and false otherwise.
+		/// </returns>
+		bool IsCurrentThreadJobDequeEmpty(const JobPriority priority);
+
 		/// <summary>
 		/// This function is called by the WorkerThreads when they come across an uncaught
 		/// exception. Its purpose is to send them to the WorkerThreadPool's exception pointer
@@ -92,21 +173,77 @@ export namespace Brawler
 		std::uint32_t GetCurrentJobQueueNotifierValue() const;
 
 		/// <summary>
-		/// This function is called by the WorkerThreads in their main loop after they fail
-		/// to acquire a job. Internally, the corresponding thread will wait on a std::atomic
-		/// before it can continue being executed. This is more efficient than continuously
-		/// checking the queue and then yielding.
+		/// This function is called by the WorkerThreads in their main loop after they have
+		/// failed to acquire a job for long enough, as specified by the WorkerThreadIdlePolicy
+		/// of this WorkerThreadPool. Internally, the calling thread is parked in the
+		/// WorkerThreadPool's ThreadParkingLot until new jobs are dispatched. This is more
+		/// efficient than continuously checking the queue and then yielding.
 		/// </summary>
 		/// <param name="previousJobQueueNotifierValue">
 		/// - The value which the job queue notifier of this WorkerThreadPool held before
 		///   an attempt was made to execute any jobs.
 		/// </param>
-		void WaitForJobDispatch(const std::uint32_t previousJobQueueNotifierValue) const;
+		/// <returns>
+		/// The function returns true if the calling thread was actually parked and then woken
+		/// up, and false if it returned immediately because jobs were dispatched in the
+		/// meantime.
+		/// </returns>
+		bool WaitForJobDispatch(const std::uint32_t previousJobQueueNotifierValue);
+
+		const WorkerThreadIdlePolicy& GetIdlePolicy() const;
+
+		/// <summary>
+		/// This function is called by a WorkerThread if it was woken up from
+		/// WorkerThreadPool::WaitForJobDispatch(), but it failed to execute any jobs before
+		/// it had to wait again.
+		/// </summary>
+		void ReportSpuriousWakeUp();
+
+		/// <summary>
+		/// Gets statistics about how often the WorkerThreads were parked and woken up, and
+		/// how long they were parked for. This is useful for tuning the WorkerThreadIdlePolicy.
+		/// </summary>
+		ThreadParkingLot::Statistics GetParkingLotStatistics() const;
 
 	private:
 		WorkerThread* GetWorkerThread(std::thread::id threadID);
 		const WorkerThread* GetWorkerThread(std::thread::id threadID) const;
 
+		/// <summary>
+		/// Gets the ThreadJobQueues of the calling thread. Threads which are neither the main
+		/// thread nor one of the WorkerThreads of this WorkerThreadPool do not have any local
+		/// deques; for these, the function returns nullptr.
+		/// </summary>
+		ThreadJobQueues* GetCurrentThreadJobQueues();
+		std::optional<Job> TryAcquireNodeJob(NodeJobQueues& nodeQueues, const JobPriority priority);
+
+		/// <summary>
+		/// Attempts to steal a job of the specified priority from the local deque of another
+		/// thread.
+		/// </summary>
+		/// <param name="thiefQueues">
+		/// - The ThreadJobQueues of the calling thread.
+		/// </param>
+		/// <param name="priority">
+		/// - The priority of the job which is to be stolen.
+		/// </param>
+		/// <param name="stealFromLocalNode">
+		/// - If this is true, then only the threads on the same NUMA node as the calling thread
+		///   are considered. Otherwise, only the threads on other NUMA nodes are considered.
+		/// </param>
+		std::optional<Job> TryStealJob(ThreadJobQueues& thiefQueues, const JobPriority priority, const bool stealFromLocalNode);
+
+		void EnqueueJobs(const std::span<Job> jobSpan);
+
+		/// <summary>
+		/// Notifies the WorkerThreads that new jobs are available. At most numDispatchedJobs
+		/// threads are woken up, and no thread is woken up if none of them are waiting.
+		/// </summary>
+		/// <param name="numDispatchedJobs">
+		/// - The number of jobs which were just dispatched.
+		/// </param>
+		void NotifyWorkerThreads(const std::size_t numDispatchedJobs);
+
 		/// <summary>
 		/// This function is called by the main thread periodically to check for any uncaught
 		/// exceptions which the WorkerThreads encountered.
@@ -114,13 +251,37 @@ export namespace Brawler
 		void HandleThrownExceptions();
 
 	private:
-		std::array<ThreadSafeQueue<Brawler::Job, IMPL::JOB_QUEUE_SIZE>, std::to_underlying(JobPriority::COUNT)> mJobQueueArr;
-		std::atomic<std::uint32_t> mJobQueueNotifier;
+		// This is the logical processor which each thread (including the main thread) is locked
+		// to, indexed by thread index.
+		std::vector<LogicalProcessorInfo> mThreadPlacementArr;
+
+		// Each NUMA node which any thread is placed on gets its own set of shared queues. Jobs
+		// which do not fit into the local deque of the dispatching thread are sent to the queues
+		// of its node, so they are most likely to be executed by a thread on the same node,
+		// which is where the data they work on is most likely to be found.
+		std::vector<std::unique_ptr<NodeJobQueues>> mNodeJobQueuesArr;
+
+		// Each thread (including the main thread) gets its own set of work-stealing deques. These
+		// are indexed by the thread index stored in each thread's ThreadLocalResources instance.
+		std::vector<std::unique_ptr<ThreadJobQueues>> mThreadJobQueuesArr;
+
+		// Idle WorkerThreads are parked here. The wake-up epoch of the ThreadParkingLot
+		// serves as the job queue notifier value.
+		ThreadParkingLot mParkingLot;
+		WorkerThreadIdlePolicy mIdlePolicy;
 		ThreadSafeQueue<std::exception_ptr, IMPL::EXCEPTION_QUEUE_SIZE> mExceptionPtrQueue;
 		std::vector<std::unique_ptr<WorkerThread>> mThreadArr;
-		std::unordered_map<std::thread::id, WorkerThread*> mThreadMap;
+
+		// This is read from any thread (see Util::Threading::GetCurrentWorkerThread()). With a
+		// std::unordered_map, a lookup from a thread which was not a WorkerThread inserted a new
+		// element, which raced with every other lookup.
+		ConcurrentHashMap<std::thread::id, WorkerThread*> mThreadMap;
 		MainThreadInfo mMainThreadInfo;
 		std::atomic<bool> mInitialized;
 		std::atomic<bool> mActive;
+
+		// This uniquely identifies this WorkerThreadPool instance. It is used to validate the
+		// thread_local cache of GetCurrentThreadJobQueues().
+		std::uint64_t mPoolID;
 	};
 }
\ No newline at end of file
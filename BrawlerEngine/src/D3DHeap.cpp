@@ -153,7 +153,9 @@ namespace Brawler
 
 	bool D3DHeap::WouldAllocationSucceed(const Brawler::ResourceCreationInfo& creationInfo)
 	{
-		return mAllocator.Allocate(creationInfo.AllocationInfo).has_value();
+		// A trial allocation would have been counted in the allocator's statistics, so we only
+		// ask the allocator whether or not it has a large enough free block.
+		return mAllocator.WouldAllocationSucceed(creationInfo.AllocationInfo);
 	}
 
 	HRESULT D3DHeap::MakeResident()
@@ -213,4 +215,9 @@ namespace Brawler
 
 		return mHeap->GetDesc().SizeInBytes;
 	}
+
+	D3DHeapBuddyAllocator::Statistics D3DHeap::GetAllocatorStatistics() const
+	{
+		return mAllocator.GetStatistics();
+	}
 }
\ No newline at end of file
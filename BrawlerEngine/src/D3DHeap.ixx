@@ -60,8 +60,10 @@ export namespace Brawler
 		D3DHeap(const D3DHeap& rhs) = delete;
 		D3DHeap& operator=(const D3DHeap& rhs) = delete;
 
-		D3DHeap(D3DHeap&& rhs) noexcept = default;
-		D3DHeap& operator=(D3DHeap&& rhs) noexcept = default;
+		// The D3DHeapBuddyAllocator is stored inline, and it cannot be moved. (D3DHeapPool
+		// owns its D3DHeaps through std::unique_ptrs anyways.)
+		D3DHeap(D3DHeap&& rhs) noexcept = delete;
+		D3DHeap& operator=(D3DHeap&& rhs) noexcept = delete;
 
 		/// <summary>
 		/// Attempts to create the underlying ID3D12Heap for this D3DHeap instance using
@@ -109,6 +111,8 @@ export namespace Brawler
 		const D3DHeapInfo& GetHeapInfo() const;
 		std::uint64_t GetHeapSize() const;
 
+		D3DHeapBuddyAllocator::Statistics GetAllocatorStatistics() const;
+
 	private:
 		// This is a counter which keeps track of the number of times a resource stored
 		// within this heap was specified as a resource dependency during a 
@@ -0,0 +1,13 @@
+module;
+
+module Brawler.D3DHeapAllocationHandle;
+import Brawler.D3DHeapBuddyAllocator;
+
+namespace Brawler
+{
+	D3DHeapAllocationHandle::~D3DHeapAllocationHandle()
+	{
+		if (OwningAllocator != nullptr)
+			OwningAllocator->DeleteAllocation(*this);
+	}
+}
\ No newline at end of file
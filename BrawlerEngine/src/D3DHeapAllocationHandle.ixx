@@ -3,7 +3,6 @@ module;
 #include <cassert>
 
 export module Brawler.D3DHeapAllocationHandle;
-import Brawler.IMPL.D3DHeapBuddyAllocatorNode;
 
 export namespace Brawler
 {
@@ -23,49 +22,50 @@ export namespace Brawler
 		friend class D3DHeap;
 		friend class D3DHeapBuddyAllocator;
 		friend class I_GPUResource;
-		friend struct IMPL::D3DHeapBuddyAllocatorNode;
 
 	private:
 		D3DHeap* OwningHeap;
-		IMPL::D3DHeapBuddyAllocatorNode* AllocatedNode;
+		D3DHeapBuddyAllocator* OwningAllocator;
 		std::uint64_t Offset;
 		std::uint64_t Size;
 
+		// This is the level of the D3DHeapBuddyAllocator's block which was allocated. Together
+		// with the offset, it identifies the block.
+		std::uint32_t BlockLevel;
+
 	public:
 		D3DHeapAllocationHandle() :
 			OwningHeap(nullptr),
-			AllocatedNode(nullptr),
+			OwningAllocator(nullptr),
 			Offset(0),
-			Size(0)
+			Size(0),
+			BlockLevel(0)
 		{}
 
 		D3DHeapAllocationHandle(
-			IMPL::D3DHeapBuddyAllocatorNode& allocatedNode,
+			D3DHeapBuddyAllocator& owningAllocator,
 			const std::uint64_t offset,
-			const std::uint64_t size
+			const std::uint64_t size,
+			const std::uint32_t blockLevel
 		) :
 			OwningHeap(nullptr),
-			AllocatedNode(&allocatedNode),
+			OwningAllocator(&owningAllocator),
 			Offset(offset),
-			Size(size)
-		{
-			AllocatedNode->CreateReservation();
-		}
+			Size(size),
+			BlockLevel(blockLevel)
+		{}
 
-		~D3DHeapAllocationHandle()
-		{
-			if (AllocatedNode != nullptr)
-				AllocatedNode->DeleteReservation();
-		}
+		~D3DHeapAllocationHandle();
 
 		D3DHeapAllocationHandle(const D3DHeapAllocationHandle& rhs) = delete;
 		D3DHeapAllocationHandle& operator=(const D3DHeapAllocationHandle& rhs) = delete;
 
 		D3DHeapAllocationHandle(D3DHeapAllocationHandle&& rhs) noexcept :
 			OwningHeap(rhs.OwningHeap),
-			AllocatedNode(rhs.AllocatedNode),
+			OwningAllocator(rhs.OwningAllocator),
 			Offset(rhs.Offset),
-			Size(rhs.Size)
+			Size(rhs.Size),
+			BlockLevel(rhs.BlockLevel)
 		{
 			rhs = D3DHeapAllocationHandle{};
 		}
@@ -75,8 +75,8 @@ export namespace Brawler
 			OwningHeap = rhs.OwningHeap;
 			rhs.OwningHeap = nullptr;
 
-			AllocatedNode = rhs.AllocatedNode;
-			rhs.AllocatedNode = nullptr;
+			OwningAllocator = rhs.OwningAllocator;
+			rhs.OwningAllocator = nullptr;
 
 			Offset = rhs.Offset;
 			rhs.Offset = 0;
@@ -84,7 +84,15 @@ export namespace Brawler
 			Size = rhs.Size;
 			rhs.Size = 0;
 
+			BlockLevel = rhs.BlockLevel;
+			rhs.BlockLevel = 0;
+
 			return *this;
 		}
+
+		std::uint64_t GetOffset() const
+		{
+			return Offset;
+		}
 	};
 }
\ No newline at end of file
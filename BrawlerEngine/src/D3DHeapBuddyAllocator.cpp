@@ -1,8 +1,10 @@
 module;
 #include <cstdint>
 #include <cassert>
-#include <memory>
 #include <optional>
+#include <vector>
+#include <algorithm>
+#include <bit>
 #include "DxDef.h"
 
 module Brawler.D3DHeapBuddyAllocator;
@@ -10,53 +12,307 @@ import Brawler.D3DHeap;
 import Brawler.ResourceCreationInfo;
 import Brawler.D3DHeapAllocationHandle;
 import Util.Math;
-import Brawler.IMPL.D3DHeapBuddyAllocatorNode;
+
+namespace
+{
+	static constexpr std::uint64_t BITS_PER_WORD = (sizeof(std::uint64_t) * 8);
+
+	constexpr std::uint64_t GetWordCount(const std::uint64_t bitCount)
+	{
+		return ((bitCount + (BITS_PER_WORD - 1)) / BITS_PER_WORD);
+	}
+}
 
 namespace Brawler
 {
 	D3DHeapBuddyAllocator::D3DHeapBuddyAllocator() :
-		mHeadNode(nullptr),
-		mMinimumNodeSize(0)
+		mFreeBlockBitmap(),
+		mFreeBlockSummaryBitmap(),
+		mLevelInfoArr(),
+		mHeapSizeInBytes(0),
+		mRequestedBytes(0),
+		mAllocatedBytes(0),
+		mAllocationCount(0),
+		mFailedAllocationCount(0)
 	{}
 
 	void D3DHeapBuddyAllocator::Initialize(const Brawler::D3DHeap& owningHeap)
 	{
-		// Set the minimum node size to be that of the small alignment of the owningHeap, if
+		// Set the minimum block size to be that of the small alignment of the owningHeap, if
 		// it is allowed.
 		if (owningHeap.GetHeapInfo().SmallAlignment)
-			mMinimumNodeSize = *(owningHeap.GetHeapInfo().SmallAlignment);
+			Initialize(owningHeap.GetHeapSize(), *(owningHeap.GetHeapInfo().SmallAlignment));
 		else
-			mMinimumNodeSize = owningHeap.GetHeapInfo().DefaultAlignment;
+			Initialize(owningHeap.GetHeapSize(), owningHeap.GetHeapInfo().DefaultAlignment);
+	}
+
+	void D3DHeapBuddyAllocator::Initialize(const std::uint64_t heapSizeInBytes, const std::uint64_t minimumBlockSizeInBytes)
+	{
+		assert(std::has_single_bit(heapSizeInBytes) && std::has_single_bit(minimumBlockSizeInBytes) && "ERROR: The heap size and the minimum block size of a D3DHeapBuddyAllocator must both be powers of two!");
+		assert(minimumBlockSizeInBytes <= heapSizeInBytes && "ERROR: The minimum block size of a D3DHeapBuddyAllocator cannot be larger than the heap!");
+
+		mHeapSizeInBytes = heapSizeInBytes;
+
+		// Level 0 is the entire heap, and the last level contains the blocks of the minimum
+		// size.
+		const std::uint32_t levelCount = static_cast<std::uint32_t>(std::countr_zero(heapSizeInBytes) - std::countr_zero(minimumBlockSizeInBytes) + 1);
 
-		// Create the root node of the tree.
-		mHeadNode = std::make_unique<IMPL::D3DHeapBuddyAllocatorNode>(*this, owningHeap.GetHeapSize());
+		mLevelInfoArr.clear();
+		mLevelInfoArr.reserve(levelCount);
+
+		std::uint64_t bitmapWordCount = 0;
+		std::uint64_t summaryWordCount = 0;
+
+		for (std::uint32_t level = 0; level < levelCount; ++level)
+		{
+			const std::uint64_t levelBitmapWordCount = GetWordCount(std::uint64_t{ 1 } << level);
+			const std::uint64_t levelSummaryWordCount = GetWordCount(levelBitmapWordCount);
+
+			mLevelInfoArr.push_back(LevelInfo{
+				.BitmapWordOffset = static_cast<std::uint32_t>(bitmapWordCount),
+				.SummaryWordOffset = static_cast<std::uint32_t>(summaryWordCount),
+				.SummaryWordCount = static_cast<std::uint32_t>(levelSummaryWordCount),
+				.FreeBlockCount = 0
+			});
+
+			bitmapWordCount += levelBitmapWordCount;
+			summaryWordCount += levelSummaryWordCount;
+		}
+
+		mFreeBlockBitmap.assign(bitmapWordCount, 0);
+		mFreeBlockSummaryBitmap.assign(summaryWordCount, 0);
+
+		mRequestedBytes = 0;
+		mAllocatedBytes = 0;
+		mAllocationCount = 0;
+		mFailedAllocationCount = 0;
+
+		// Initially, the entire heap is a single free block.
+		SetBlockFreeStatus(0, 0, true);
 	}
 
 	std::optional<D3DHeapAllocationHandle> D3DHeapBuddyAllocator::Allocate(const D3D12_RESOURCE_ALLOCATION_INFO& allocInfo)
 	{
-		// Make sure that we are doing a properly-aligned allocation.
-		assert(Util::Math::IsAligned(allocInfo.SizeInBytes, GetMinimumNodeSize()) && "ERROR: An attempt was made to perform an unaligned allocation within a D3DHeap!");
+		assert(!mLevelInfoArr.empty() && "ERROR: An attempt was made to use a D3DHeapBuddyAllocator before it was initialized!");
 
-		if (GetLargestAvailableRegionSize() < allocInfo.SizeInBytes)
+		const std::uint64_t requiredBlockSize = GetRequiredBlockSize(allocInfo);
+
+		if (requiredBlockSize > mHeapSizeInBytes)
+		{
+			++mFailedAllocationCount;
 			return std::optional<D3DHeapAllocationHandle>{};
+		}
+
+		const std::uint32_t targetLevel = static_cast<std::uint32_t>(std::countr_zero(mHeapSizeInBytes) - std::countr_zero(requiredBlockSize));
 
-		IMPL::D3DHeapBuddyAllocatorNode* suitableNode = mHeadNode->FindSuitableNodeForReservation(allocInfo);
-		if (suitableNode == nullptr)
+		// Find the free block with the lowest offset which is at least as large as the required
+		// block size. We only need the first set bit of each level which is large enough, so
+		// this is O(log N).
+		std::optional<std::uint32_t> foundLevel{};
+		std::uint64_t foundBlockIndex = 0;
+
+		for (std::uint32_t level = 0; level <= targetLevel; ++level)
+		{
+			const std::optional<std::uint64_t> blockIndex{ FindFirstFreeBlock(level) };
+
+			if (!blockIndex.has_value())
+				continue;
+
+			if (!foundLevel.has_value() || (*blockIndex * GetBlockSize(level)) < (foundBlockIndex * GetBlockSize(*foundLevel)))
+			{
+				foundLevel = level;
+				foundBlockIndex = *blockIndex;
+			}
+		}
+
+		if (!foundLevel.has_value())
+		{
+			++mFailedAllocationCount;
 			return std::optional<D3DHeapAllocationHandle>{};
+		}
+
+		// Split the block in half until it has the required size. The left half is always the
+		// one which we keep splitting, so the right half of every split becomes a free block.
+		SetBlockFreeStatus(*foundLevel, foundBlockIndex, false);
 
-		D3DHeapAllocationHandle hAllocation{ *suitableNode, Util::Math::AlignUp(suitableNode->Offset, allocInfo.Alignment), allocInfo.SizeInBytes };
+		for (std::uint32_t level = *foundLevel + 1; level <= targetLevel; ++level)
+		{
+			foundBlockIndex *= 2;
+			SetBlockFreeStatus(level, foundBlockIndex + 1, true);
+		}
+
+		mRequestedBytes += allocInfo.SizeInBytes;
+		mAllocatedBytes += requiredBlockSize;
+		++mAllocationCount;
+
+		D3DHeapAllocationHandle hAllocation{ *this, foundBlockIndex * requiredBlockSize, allocInfo.SizeInBytes, targetLevel };
 		return std::optional<D3DHeapAllocationHandle>{ std::move(hAllocation) };
 	}
 
+	bool D3DHeapBuddyAllocator::WouldAllocationSucceed(const D3D12_RESOURCE_ALLOCATION_INFO& allocInfo) const
+	{
+		assert(!mLevelInfoArr.empty() && "ERROR: An attempt was made to use a D3DHeapBuddyAllocator before it was initialized!");
+
+		// D3DHeapBuddyAllocator::Allocate() accepts a free block from any level which is at least
+		// as large as the required block size, so the allocation succeeds exactly if the largest
+		// free block is large enough.
+		const std::uint64_t requiredBlockSize = GetRequiredBlockSize(allocInfo);
+		return (requiredBlockSize <= mHeapSizeInBytes && requiredBlockSize <= GetLargestAvailableRegionSize());
+	}
+
 	std::uint64_t D3DHeapBuddyAllocator::GetLargestAvailableRegionSize() const
 	{
-		assert(mHeadNode != nullptr && "ERROR: An attempt was made to use a D3DHeapBuddyAllocator before it was initialized!");
+		assert(!mLevelInfoArr.empty() && "ERROR: An attempt was made to use a D3DHeapBuddyAllocator before it was initialized!");
+
+		for (std::uint32_t level = 0; level < mLevelInfoArr.size(); ++level)
+		{
+			if (mLevelInfoArr[level].FreeBlockCount != 0)
+				return GetBlockSize(level);
+		}
+
+		return 0;
+	}
+
+	D3DHeapBuddyAllocator::Statistics D3DHeapBuddyAllocator::GetStatistics() const
+	{
+		assert(!mLevelInfoArr.empty() && "ERROR: An attempt was made to use a D3DHeapBuddyAllocator before it was initialized!");
+
+		Statistics statistics{
+			.HeapSizeInBytes = mHeapSizeInBytes,
+			.AllocatedBytes = mAllocatedBytes,
+			.AllocationCount = mAllocationCount,
+			.AlignmentWasteBytes = (mAllocatedBytes - mRequestedBytes),
+			.FreeBytes = 0,
+			.FreeBlockCount = 0,
+			.FreeBytesPerSizeClass{},
+			.LargestFreeBlockSizeInBytes = GetLargestAvailableRegionSize(),
+			.ExternalFragmentationRatio = 0.0f,
+			.FailedAllocationCount = mFailedAllocationCount
+		};
+
+		// Every bit which is set in the bitmaps is a maximal free block, since free buddies are
+		// always merged.
+		for (std::uint32_t level = 0; level < mLevelInfoArr.size(); ++level)
+		{
+			const std::uint64_t blockSize = GetBlockSize(level);
+			const std::uint64_t freeBlockCount = mLevelInfoArr[level].FreeBlockCount;
+
+			statistics.FreeBytes += (freeBlockCount * blockSize);
+			statistics.FreeBlockCount += freeBlockCount;
+			statistics.FreeBytesPerSizeClass[std::bit_width(blockSize) - 1] += (freeBlockCount * blockSize);
+		}
+
+		assert(statistics.AllocatedBytes + statistics.FreeBytes == statistics.HeapSizeInBytes);
+
+		if (statistics.FreeBytes != 0)
+			statistics.ExternalFragmentationRatio = (1.0f - (static_cast<float>(statistics.LargestFreeBlockSizeInBytes) / static_cast<float>(statistics.FreeBytes)));
+
+		return statistics;
+	}
+
+	void D3DHeapBuddyAllocator::DeleteAllocation(const D3DHeapAllocationHandle& hAllocation)
+	{
+		std::uint32_t level = hAllocation.BlockLevel;
+		const std::uint64_t blockSize = GetBlockSize(level);
+		std::uint64_t blockIndex = (hAllocation.Offset / blockSize);
+
+		assert(!IsBlockFree(level, blockIndex) && "ERROR: An attempt was made to delete a D3DHeapBuddyAllocator allocation twice!");
+
+		mRequestedBytes -= hAllocation.Size;
+		mAllocatedBytes -= blockSize;
+		--mAllocationCount;
+
+		// Merge the block with its buddy for as long as the buddy is free. The buddy of a block
+		// is the other half of the block which it was split from.
+		while (level > 0 && IsBlockFree(level, blockIndex ^ 1))
+		{
+			SetBlockFreeStatus(level, blockIndex ^ 1, false);
+
+			blockIndex /= 2;
+			--level;
+		}
+
+		SetBlockFreeStatus(level, blockIndex, true);
+	}
+
+	std::uint64_t D3DHeapBuddyAllocator::GetBlockSize(const std::uint32_t level) const
+	{
+		return (mHeapSizeInBytes >> level);
+	}
+
+	std::uint64_t D3DHeapBuddyAllocator::GetRequiredBlockSize(const D3D12_RESOURCE_ALLOCATION_INFO& allocInfo) const
+	{
+		// Make sure that we are doing a properly-aligned allocation.
+		assert(Util::Math::IsAligned(allocInfo.SizeInBytes, GetBlockSize(static_cast<std::uint32_t>(mLevelInfoArr.size() - 1))) && "ERROR: An attempt was made to perform an unaligned allocation within a D3DHeap!");
 
-		return mHeadNode->AvailableSizeInBytes;
+		// Every block starts at a multiple of its own size, so as long as the block is at least
+		// as large as the alignment, the allocation will be properly aligned. The size reported
+		// by the D3D12 API is always a multiple of the alignment, anyways, so this should never
+		// actually make a block larger.
+		return std::bit_ceil(std::max({ allocInfo.SizeInBytes, allocInfo.Alignment, GetBlockSize(static_cast<std::uint32_t>(mLevelInfoArr.size() - 1)) }));
 	}
 
-	std::uint64_t D3DHeapBuddyAllocator::GetMinimumNodeSize() const
+	bool D3DHeapBuddyAllocator::IsBlockFree(const std::uint32_t level, const std::uint64_t blockIndex) const
 	{
-		return mMinimumNodeSize;
+		const std::uint64_t wordIndex = mLevelInfoArr[level].BitmapWordOffset + (blockIndex / BITS_PER_WORD);
+		return ((mFreeBlockBitmap[wordIndex] >> (blockIndex % BITS_PER_WORD)) & 1);
+	}
+
+	void D3DHeapBuddyAllocator::SetBlockFreeStatus(const std::uint32_t level, const std::uint64_t blockIndex, const bool isFree)
+	{
+		assert(blockIndex < (std::uint64_t{ 1 } << level));
+		assert(IsBlockFree(level, blockIndex) != isFree);
+
+		LevelInfo& levelInfo{ mLevelInfoArr[level] };
+
+		const std::uint64_t levelWordIndex = (blockIndex / BITS_PER_WORD);
+		std::uint64_t& bitmapWord{ mFreeBlockBitmap[levelInfo.BitmapWordOffset + levelWordIndex] };
+		std::uint64_t& summaryWord{ mFreeBlockSummaryBitmap[levelInfo.SummaryWordOffset + (levelWordIndex / BITS_PER_WORD)] };
+
+		const std::uint64_t blockBit = (std::uint64_t{ 1 } << (blockIndex % BITS_PER_WORD));
+		const std::uint64_t wordBit = (std::uint64_t{ 1 } << (levelWordIndex % BITS_PER_WORD));
+
+		if (isFree)
+		{
+			bitmapWord |= blockBit;
+			summaryWord |= wordBit;
+
+			++(levelInfo.FreeBlockCount);
+		}
+		else
+		{
+			bitmapWord &= ~blockBit;
+
+			if (bitmapWord == 0)
+				summaryWord &= ~wordBit;
+
+			--(levelInfo.FreeBlockCount);
+		}
+	}
+
+	std::optional<std::uint64_t> D3DHeapBuddyAllocator::FindFirstFreeBlock(const std::uint32_t level) const
+	{
+		const LevelInfo& levelInfo{ mLevelInfoArr[level] };
+
+		if (levelInfo.FreeBlockCount == 0)
+			return std::optional<std::uint64_t>{};
+
+		for (std::uint32_t summaryWordIndex = 0; summaryWordIndex < levelInfo.SummaryWordCount; ++summaryWordIndex)
+		{
+			const std::uint64_t summaryWord = mFreeBlockSummaryBitmap[levelInfo.SummaryWordOffset + summaryWordIndex];
+
+			if (summaryWord == 0)
+				continue;
+
+			const std::uint64_t levelWordIndex = (summaryWordIndex * BITS_PER_WORD) + std::countr_zero(summaryWord);
+			const std::uint64_t bitmapWord = mFreeBlockBitmap[levelInfo.BitmapWordOffset + levelWordIndex];
+
+			assert(bitmapWord != 0);
+
+			return std::optional<std::uint64_t>{ (levelWordIndex * BITS_PER_WORD) + std::countr_zero(bitmapWord) };
+		}
+
+		assert(false && "ERROR: The free block count of a D3DHeapBuddyAllocator level did not match its bitmap!");
+		return std::optional<std::uint64_t>{};
 	}
 }
\ No newline at end of file
@@ -1,12 +1,13 @@
 module;
-#include <memory>
 #include <optional>
+#include <array>
+#include <vector>
+#include <cstdint>
 #include "DxDef.h"
 
 export module Brawler.D3DHeapBuddyAllocator;
 import Brawler.D3DHeapAllocationHandle;
 import Util.Math;
-import Brawler.IMPL.D3DHeapBuddyAllocatorNode;
 
 export namespace Brawler
 {
@@ -15,10 +16,80 @@ export namespace Brawler
 
 export namespace Brawler
 {
+	// The D3DHeapBuddyAllocator used to build a tree of heap-allocated nodes, and finding a block
+	// for an allocation meant recursively walking that tree. Now, the blocks are only described
+	// by a set of bitmaps, one for each level of the (implicit) tree. Bit i of level L is set if
+	// the i-th block of size (HeapSize >> L) is free and is not part of a larger free block.
+	// Finding a free block is thus just a matter of finding the first set bit in a few of these
+	// bitmaps, and no memory needs to be allocated after D3DHeapBuddyAllocator::Initialize()
+	// is called.
+	//
+	// Blocks are handed out with the same policy as the original tree: an allocation gets the
+	// free block with the lowest offset which is large enough, and that block is split in half
+	// until it is as small as possible. Unlike the tree, however, free buddies are merged back
+	// together when an allocation is deleted.
+
 	class D3DHeapBuddyAllocator
 	{
 	private:
-		friend struct IMPL::D3DHeapBuddyAllocatorNode;
+		friend struct D3DHeapAllocationHandle;
+
+	private:
+		struct LevelInfo
+		{
+			// This is the index of the first std::uint64_t in mFreeBlockBitmap which belongs to
+			// this level.
+			std::uint32_t BitmapWordOffset;
+
+			// This is the index of the first std::uint64_t in mFreeBlockSummaryBitmap which belongs
+			// to this level. Bit i of the summary is set if word i of the level's bitmap is not zero,
+			// so that we do not have to look at every word of the larger levels to find a free block.
+			std::uint32_t SummaryWordOffset;
+
+			std::uint32_t SummaryWordCount;
+			std::uint64_t FreeBlockCount;
+		};
+
+	public:
+		struct Statistics
+		{
+			std::uint64_t HeapSizeInBytes;
+
+			/// <summary>
+			/// The number of bytes in allocated blocks. This includes the bytes which are lost
+			/// to alignment and to rounding allocations up to the size of a block.
+			/// </summary>
+			std::uint64_t AllocatedBytes;
+			std::uint64_t AllocationCount;
+
+			/// <summary>
+			/// The number of bytes in allocated blocks which were not actually requested by the
+			/// allocations. This is the internal fragmentation of the buddy allocator.
+			/// </summary>
+			std::uint64_t AlignmentWasteBytes;
+
+			std::uint64_t FreeBytes;
+			std::uint64_t FreeBlockCount;
+
+			/// <summary>
+			/// The number of free bytes in blocks of each size. The blocks in FreeBytesPerSizeClass[i]
+			/// are in the size range [2^i, 2^(i + 1)).
+			/// </summary>
+			std::array<std::uint64_t, 64> FreeBytesPerSizeClass;
+
+			std::uint64_t LargestFreeBlockSizeInBytes;
+
+			/// <summary>
+			/// This is 1 - (LargestFreeBlockSizeInBytes / FreeBytes), or 0 if there are no free
+			/// bytes.
+			/// </summary>
+			float ExternalFragmentationRatio;
+
+			/// <summary>
+			/// The number of calls to D3DHeapBuddyAllocator::Allocate() which failed.
+			/// </summary>
+			std::uint64_t FailedAllocationCount;
+		};
 
 	public:
 		D3DHeapBuddyAllocator();
@@ -27,11 +98,27 @@ export namespace Brawler
 		D3DHeapBuddyAllocator(const D3DHeapBuddyAllocator& rhs) = delete;
 		D3DHeapBuddyAllocator& operator=(const D3DHeapBuddyAllocator& rhs) = delete;
 
-		D3DHeapBuddyAllocator(D3DHeapBuddyAllocator&& rhs) noexcept = default;
-		D3DHeapBuddyAllocator& operator=(D3DHeapBuddyAllocator&& rhs) noexcept = default;
+		// Every D3DHeapAllocationHandle stores a pointer to the D3DHeapBuddyAllocator which
+		// created it, so the allocator must never change its address.
+		D3DHeapBuddyAllocator(D3DHeapBuddyAllocator&& rhs) noexcept = delete;
+		D3DHeapBuddyAllocator& operator=(D3DHeapBuddyAllocator&& rhs) noexcept = delete;
 
 		void Initialize(const Brawler::D3DHeap& owningHeap);
 
+		/// <summary>
+		/// Initializes the D3DHeapBuddyAllocator without an owning D3DHeap. This is what
+		/// D3DHeapBuddyAllocator::Initialize(const D3DHeap&) uses internally, and it allows the
+		/// allocator to be tested without creating an ID3D12Heap.
+		/// </summary>
+		/// <param name="heapSizeInBytes">
+		/// - The size, in bytes, of the heap. This must be a power of two.
+		/// </param>
+		/// <param name="minimumBlockSizeInBytes">
+		/// - The size, in bytes, of the smallest block which can be allocated. This must be a
+		///   power of two which is no larger than heapSizeInBytes.
+		/// </param>
+		void Initialize(const std::uint64_t heapSizeInBytes, const std::uint64_t minimumBlockSizeInBytes);
+
 		/// <summary>
 		/// Attempts to reserve sizeInBytes bytes from the owning D3DHeap. The allocation will
 		/// be in a contiguous region in memory, and will be given the proper alignment.
@@ -47,27 +134,57 @@ export namespace Brawler
 		std::optional<Brawler::D3DHeapAllocationHandle> Allocate(const D3D12_RESOURCE_ALLOCATION_INFO& allocInfo);
 
 		/// <summary>
-		/// This function returns a conservative estimate of the size, in bytes, of the largest 
-		/// available contiguous memory region in the tree. 
-		/// 
-		/// Due to fragmentation and the tree-like nature of the algorithm, this may not actually 
-		/// be the largest available size, it will never return a value lower than the actual 
-		/// available size.
+		/// Checks whether or not a call to D3DHeapBuddyAllocator::Allocate() with the same allocInfo
+		/// would currently succeed. Unlike a trial allocation, this does not modify the heap, and
+		/// it is not counted in the statistics returned by D3DHeapBuddyAllocator::GetStatistics().
+		/// </summary>
+		/// <param name="allocInfo">
+		/// - The description of the allocation which is to be checked.
+		/// </param>
+		/// <returns>
+		/// The function returns true if the allocation could be made and false otherwise.
+		/// </returns>
+		bool WouldAllocationSucceed(const D3D12_RESOURCE_ALLOCATION_INFO& allocInfo) const;
+
+		/// <summary>
+		/// This function returns the size, in bytes, of the largest free block in the heap.
 		/// 
-		/// This is not necessarily a bad thing, however, since the tree structure guarantees that
-		/// if an allocation can be made, then it will be made at an aligned memory address.
+		/// Due to fragmentation and the nature of the buddy allocation algorithm, there may be
+		/// larger contiguous free regions which span several blocks. These cannot be used for
+		/// a single allocation, however, since the block structure guarantees that if an
+		/// allocation can be made, then it will be made at an aligned memory address.
 		/// </summary>
 		/// <returns>
-		/// A conservative estimate (see the description) of the size, in bytes, of the largest 
-		/// available contiguous memory region in the tree.
+		/// The size, in bytes, of the largest free block in the heap.
 		/// </returns>
 		std::uint64_t GetLargestAvailableRegionSize() const;
 
+		/// <summary>
+		/// Describes how much of the heap is reserved and how fragmented its free space is.
+		/// This only needs to look at the number of free blocks in each level, so it is cheap
+		/// enough to be called every frame.
+		/// </summary>
+		Statistics GetStatistics() const;
+
 	private:
-		std::uint64_t GetMinimumNodeSize() const;
+		void DeleteAllocation(const D3DHeapAllocationHandle& hAllocation);
+
+		std::uint64_t GetBlockSize(const std::uint32_t level) const;
+		std::uint64_t GetRequiredBlockSize(const D3D12_RESOURCE_ALLOCATION_INFO& allocInfo) const;
+
+		bool IsBlockFree(const std::uint32_t level, const std::uint64_t blockIndex) const;
+		void SetBlockFreeStatus(const std::uint32_t level, const std::uint64_t blockIndex, const bool isFree);
+
+		std::optional<std::uint64_t> FindFirstFreeBlock(const std::uint32_t level) const;
 
 	private:
-		std::unique_ptr<IMPL::D3DHeapBuddyAllocatorNode> mHeadNode;
-		std::uint64_t mMinimumNodeSize;
+		std::vector<std::uint64_t> mFreeBlockBitmap;
+		std::vector<std::uint64_t> mFreeBlockSummaryBitmap;
+		std::vector<LevelInfo> mLevelInfoArr;
+		std::uint64_t mHeapSizeInBytes;
+		std::uint64_t mRequestedBytes;
+		std::uint64_t mAllocatedBytes;
+		std::uint64_t mAllocationCount;
+		std::uint64_t mFailedAllocationCount;
 	};
 }
\ No newline at end of file
@@ -4,7 +4,7 @@ module;
 
 module Brawler.IMPL.D3DHeapBuddyAllocatorNode;
 import Util.Math;
-import Brawler.D3DHeapBuddyAllocator;
+import Brawler.IMPL.D3DHeapTreeBuddyAllocator;
 
 namespace Brawler
 {
@@ -39,11 +39,12 @@ namespace Brawler
 			return ((alignmentDifference + allocInfo.SizeInBytes <= AvailableSizeInBytes) ? this : nullptr);
 		}
 
-		void D3DHeapBuddyAllocatorNode::CreateReservation()
+		void D3DHeapBuddyAllocatorNode::CreateReservation(const std::uint64_t reservedSizeInBytes)
 		{
 			// Even if the allocation does not use all of the bytes designated to a node,
 			// we will still mark all of it as being reserved.
 			AvailableSizeInBytes = 0;
+			ReservedSizeInBytes = reservedSizeInBytes;
 			Reserved = true;
 
 			if (ParentNode != nullptr)
@@ -53,6 +54,7 @@ namespace Brawler
 		void D3DHeapBuddyAllocatorNode::DeleteReservation()
 		{
 			AvailableSizeInBytes = SizeInBytes;
+			ReservedSizeInBytes = 0;
 			Reserved = false;
 
 			if (ParentNode != nullptr)
@@ -7,7 +7,10 @@ export module Brawler.IMPL.D3DHeapBuddyAllocatorNode;
 
 export namespace Brawler
 {
-	class D3DHeapBuddyAllocator;
+	namespace IMPL
+	{
+		class D3DHeapTreeBuddyAllocator;
+	}
 }
 
 export namespace Brawler
@@ -33,17 +36,22 @@ export namespace Brawler
 			// tree structure.
 			std::uint64_t AvailableSizeInBytes;
 
+			// This is the size, in bytes, which was actually requested for the reservation of this
+			// node. The rest of the node is lost to alignment and to rounding up to a power of two.
+			std::uint64_t ReservedSizeInBytes;
+
 			bool Reserved;
 			std::unique_ptr<D3DHeapBuddyAllocatorNode> LeftChildNode;
 			std::unique_ptr<D3DHeapBuddyAllocatorNode> RightChildNode;
 			D3DHeapBuddyAllocatorNode* ParentNode;
-			const D3DHeapBuddyAllocator* const Allocator;
+			const D3DHeapTreeBuddyAllocator* const Allocator;
 
 			// Creates a D3DHeapBuddyAllocatorNode as a root node.
-			D3DHeapBuddyAllocatorNode(const D3DHeapBuddyAllocator& buddyAllocator, const std::uint64_t sizeInBytes) :
+			D3DHeapBuddyAllocatorNode(const D3DHeapTreeBuddyAllocator& buddyAllocator, const std::uint64_t sizeInBytes) :
 				Offset(0),
 				SizeInBytes(sizeInBytes),
 				AvailableSizeInBytes(sizeInBytes),
+				ReservedSizeInBytes(0),
 				Reserved(false),
 				LeftChildNode(nullptr),
 				RightChildNode(nullptr),
@@ -56,6 +64,7 @@ export namespace Brawler
 				Offset(offsetInBytes),
 				SizeInBytes((parentNode.SizeInBytes) / 2),
 				AvailableSizeInBytes(SizeInBytes),
+				ReservedSizeInBytes(0),
 				Reserved(false),
 				LeftChildNode(nullptr),
 				RightChildNode(nullptr),
@@ -64,7 +73,7 @@ export namespace Brawler
 			{}
 
 			D3DHeapBuddyAllocatorNode* FindSuitableNodeForReservation(const D3D12_RESOURCE_ALLOCATION_INFO& allocInfo);
-			void CreateReservation();
+			void CreateReservation(const std::uint64_t reservedSizeInBytes);
 			void DeleteReservation();
 
 		private:
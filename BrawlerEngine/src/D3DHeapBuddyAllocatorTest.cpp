@@ -0,0 +1,265 @@
+module;
+#include <cstdint>
+#include <cassert>
+#include <vector>
+#include <array>
+#include <optional>
+#include <random>
+#include <algorithm>
+#include <map>
+#include <iterator>
+#include "DxDef.h"
+
+module Tests.D3DHeapBuddyAllocator;
+import Brawler.D3DHeapBuddyAllocator;
+import Brawler.D3DHeapAllocationHandle;
+import Brawler.IMPL.D3DHeapTreeBuddyAllocator;
+import Brawler.IMPL.D3DHeapBuddyAllocatorNode;
+import Util.Math;
+
+namespace
+{
+	struct TestConfiguration
+	{
+		std::uint64_t HeapSizeInBytes;
+		std::uint64_t MinimumBlockSizeInBytes;
+	};
+
+	static constexpr std::array<TestConfiguration, 3> TEST_CONFIGURATION_ARR{
+		TestConfiguration{ Util::Math::MegabytesToBytes(64), Util::Math::KilobytesToBytes(4) },
+		TestConfiguration{ Util::Math::MegabytesToBytes(64), Util::Math::KilobytesToBytes(64) },
+		TestConfiguration{ Util::Math::MegabytesToBytes(16), Util::Math::KilobytesToBytes(4) }
+	};
+
+	static constexpr std::uint32_t SEEDS_PER_CONFIGURATION = 4;
+
+	// The tree-based reference implementation never merges free buddies back together, so its
+	// results only match those of the D3DHeapBuddyAllocator until the first allocation is
+	// deleted. The differential test thus only ever allocates. Each round starts with a fresh
+	// pair of allocators and ends once this many allocations in a row have failed.
+	static constexpr std::uint32_t FILL_ROUNDS_PER_SEED = 16;
+	static constexpr std::uint32_t MAX_CONSECUTIVE_FAILED_ALLOCATIONS = 64;
+
+	// Deletions, and hence the merging of blocks, are covered by a separate randomized test of
+	// the D3DHeapBuddyAllocator alone. It alternates between phases in which allocations are
+	// more likely than deletions and phases in which deletions are more likely. This way, the
+	// heap repeatedly fills up and drains, which exercises both the splitting and the merging
+	// of blocks.
+	static constexpr std::uint32_t OPERATIONS_PER_SEED = 100000;
+	static constexpr std::uint32_t OPERATIONS_PER_PHASE = 4096;
+
+	// The statistics are checked after this many operations.
+	static constexpr std::uint32_t STATISTICS_COMPARISON_INTERVAL = 256;
+
+	struct LiveAllocation
+	{
+		Brawler::D3DHeapAllocationHandle HAllocation;
+		std::uint64_t SizeInBytes;
+	};
+
+	D3D12_RESOURCE_ALLOCATION_INFO CreateRandomAllocationInfo(std::mt19937_64& rng, const TestConfiguration& config)
+	{
+		// Most resources are small buffers, but every now and then, we get a texture. The D3D12
+		// API always reports a size which is a multiple of the alignment, so we do the same.
+		std::uint64_t alignment = 0;
+		std::uint64_t maxAlignmentCount = 0;
+		const std::uint32_t resourceKind = static_cast<std::uint32_t>(rng() % 100);
+
+		if (resourceKind < 70)
+		{
+			alignment = Util::Math::KilobytesToBytes(4);
+			maxAlignmentCount = 16;
+		}
+		else if (resourceKind < 97)
+		{
+			alignment = Util::Math::KilobytesToBytes(64);
+			maxAlignmentCount = 32;
+		}
+		else
+		{
+			alignment = Util::Math::MegabytesToBytes(4);
+			maxAlignmentCount = 2;
+		}
+
+		alignment = std::max(alignment, config.MinimumBlockSizeInBytes);
+
+		return D3D12_RESOURCE_ALLOCATION_INFO{
+			.SizeInBytes = alignment * (1 + (rng() % maxAlignmentCount)),
+			.Alignment = alignment
+		};
+	}
+
+	void VerifyStatisticsMatch(const Brawler::D3DHeapBuddyAllocator& bitmapAllocator, const Brawler::IMPL::D3DHeapTreeBuddyAllocator& treeAllocator)
+	{
+		const Brawler::D3DHeapBuddyAllocator::Statistics bitmapStatistics{ bitmapAllocator.GetStatistics() };
+		const Brawler::D3DHeapBuddyAllocator::Statistics treeStatistics{ treeAllocator.GetStatistics() };
+
+		assert(bitmapAllocator.GetLargestAvailableRegionSize() == treeAllocator.GetLargestAvailableRegionSize());
+
+		assert(bitmapStatistics.HeapSizeInBytes == treeStatistics.HeapSizeInBytes);
+		assert(bitmapStatistics.AllocatedBytes == treeStatistics.AllocatedBytes);
+		assert(bitmapStatistics.AllocationCount == treeStatistics.AllocationCount);
+		assert(bitmapStatistics.AlignmentWasteBytes == treeStatistics.AlignmentWasteBytes);
+		assert(bitmapStatistics.FreeBytes == treeStatistics.FreeBytes);
+		assert(bitmapStatistics.FreeBlockCount == treeStatistics.FreeBlockCount);
+		assert(bitmapStatistics.FreeBytesPerSizeClass == treeStatistics.FreeBytesPerSizeClass);
+		assert(bitmapStatistics.LargestFreeBlockSizeInBytes == treeStatistics.LargestFreeBlockSizeInBytes);
+		assert(bitmapStatistics.ExternalFragmentationRatio == treeStatistics.ExternalFragmentationRatio);
+		assert(bitmapStatistics.FailedAllocationCount == treeStatistics.FailedAllocationCount);
+	}
+
+	void VerifyStatisticsConsistency(const Brawler::D3DHeapBuddyAllocator& bitmapAllocator, const std::vector<LiveAllocation>& liveAllocationArr)
+	{
+		const Brawler::D3DHeapBuddyAllocator::Statistics statistics{ bitmapAllocator.GetStatistics() };
+
+		std::uint64_t requestedBytes = 0;
+
+		for (const auto& liveAllocation : liveAllocationArr)
+			requestedBytes += liveAllocation.SizeInBytes;
+
+		assert(statistics.AllocationCount == liveAllocationArr.size());
+		assert(statistics.AllocatedBytes + statistics.FreeBytes == statistics.HeapSizeInBytes);
+		assert(statistics.AlignmentWasteBytes == statistics.AllocatedBytes - requestedBytes);
+		assert(statistics.LargestFreeBlockSizeInBytes == bitmapAllocator.GetLargestAvailableRegionSize());
+	}
+
+	void RunDifferentialTest(const TestConfiguration& config, const std::uint32_t seed)
+	{
+		std::mt19937_64 rng{ seed };
+
+		for (std::uint32_t round = 0; round < FILL_ROUNDS_PER_SEED; ++round)
+		{
+			Brawler::D3DHeapBuddyAllocator bitmapAllocator{};
+			bitmapAllocator.Initialize(config.HeapSizeInBytes, config.MinimumBlockSizeInBytes);
+
+			Brawler::IMPL::D3DHeapTreeBuddyAllocator treeAllocator{};
+			treeAllocator.Initialize(config.HeapSizeInBytes, config.MinimumBlockSizeInBytes);
+
+			// The nodes of the tree are deleted along with the tree itself, but the handles
+			// must be destroyed before the D3DHeapBuddyAllocator is.
+			std::vector<Brawler::D3DHeapAllocationHandle> hAllocationArr{};
+
+			std::uint32_t consecutiveFailedAllocationCount = 0;
+			std::uint32_t allocationAttemptCount = 0;
+
+			while (consecutiveFailedAllocationCount < MAX_CONSECUTIVE_FAILED_ALLOCATIONS)
+			{
+				const D3D12_RESOURCE_ALLOCATION_INFO allocInfo{ CreateRandomAllocationInfo(rng, config) };
+
+				std::optional<Brawler::D3DHeapAllocationHandle> hAllocation{ bitmapAllocator.Allocate(allocInfo) };
+				Brawler::IMPL::D3DHeapBuddyAllocatorNode* const reservedNode = treeAllocator.Allocate(allocInfo);
+
+				assert(hAllocation.has_value() == (reservedNode != nullptr) && "ERROR: The D3DHeapBuddyAllocator and the tree-based reference implementation disagreed on whether or not an allocation could be made!");
+
+				if (hAllocation.has_value())
+				{
+					assert(hAllocation->GetOffset() == Util::Math::AlignUp(reservedNode->Offset, allocInfo.Alignment) && "ERROR: The D3DHeapBuddyAllocator and the tree-based reference implementation returned different offsets for the same allocation!");
+
+					hAllocationArr.push_back(std::move(*hAllocation));
+					consecutiveFailedAllocationCount = 0;
+				}
+				else
+					++consecutiveFailedAllocationCount;
+
+				if (++allocationAttemptCount % STATISTICS_COMPARISON_INTERVAL == 0)
+					VerifyStatisticsMatch(bitmapAllocator, treeAllocator);
+			}
+
+			VerifyStatisticsMatch(bitmapAllocator, treeAllocator);
+		}
+	}
+
+	void DeleteLiveAllocation(std::vector<LiveAllocation>& liveAllocationArr, std::map<std::uint64_t, std::uint64_t>& liveRangeMap, const std::size_t index)
+	{
+		std::swap(liveAllocationArr[index], liveAllocationArr.back());
+		liveRangeMap.erase(liveAllocationArr.back().HAllocation.GetOffset());
+
+		// Destroying the D3DHeapAllocationHandle returns its block to the D3DHeapBuddyAllocator.
+		liveAllocationArr.pop_back();
+	}
+
+	void RunRandomizedTest(const TestConfiguration& config, const std::uint32_t seed)
+	{
+		Brawler::D3DHeapBuddyAllocator bitmapAllocator{};
+		bitmapAllocator.Initialize(config.HeapSizeInBytes, config.MinimumBlockSizeInBytes);
+
+		std::mt19937_64 rng{ seed };
+		std::vector<LiveAllocation> liveAllocationArr{};
+
+		// This maps the offset of every live allocation to the end of its range. It is used to
+		// check that no two live allocations ever overlap.
+		std::map<std::uint64_t, std::uint64_t> liveRangeMap{};
+
+		for (std::uint32_t i = 0; i < OPERATIONS_PER_SEED; ++i)
+		{
+			const std::uint32_t allocationPercentage = (((i / OPERATIONS_PER_PHASE) % 2 == 0) ? 65 : 35);
+
+			if (liveAllocationArr.empty() || (rng() % 100) < allocationPercentage)
+			{
+				const D3D12_RESOURCE_ALLOCATION_INFO allocInfo{ CreateRandomAllocationInfo(rng, config) };
+
+				const bool wouldAllocationSucceed = bitmapAllocator.WouldAllocationSucceed(allocInfo);
+				std::optional<Brawler::D3DHeapAllocationHandle> hAllocation{ bitmapAllocator.Allocate(allocInfo) };
+
+				assert(hAllocation.has_value() == wouldAllocationSucceed && "ERROR: D3DHeapBuddyAllocator::WouldAllocationSucceed() did not predict the result of D3DHeapBuddyAllocator::Allocate()!");
+
+				if (hAllocation.has_value())
+				{
+					const std::uint64_t offset = hAllocation->GetOffset();
+
+					assert(Util::Math::IsAligned(offset, allocInfo.Alignment));
+					assert(offset + allocInfo.SizeInBytes <= config.HeapSizeInBytes);
+
+					const auto [itr, inserted] = liveRangeMap.try_emplace(offset, offset + allocInfo.SizeInBytes);
+					assert(inserted && "ERROR: The D3DHeapBuddyAllocator returned the same offset for two live allocations!");
+
+					assert((itr == liveRangeMap.begin() || std::prev(itr)->second <= offset) && "ERROR: The D3DHeapBuddyAllocator returned overlapping allocations!");
+					assert((std::next(itr) == liveRangeMap.end() || itr->second <= std::next(itr)->first) && "ERROR: The D3DHeapBuddyAllocator returned overlapping allocations!");
+
+					liveAllocationArr.push_back(LiveAllocation{
+						.HAllocation{ std::move(*hAllocation) },
+						.SizeInBytes = allocInfo.SizeInBytes
+					});
+				}
+			}
+			else
+				DeleteLiveAllocation(liveAllocationArr, liveRangeMap, static_cast<std::size_t>(rng() % liveAllocationArr.size()));
+
+			if (i % STATISTICS_COMPARISON_INTERVAL == 0)
+				VerifyStatisticsConsistency(bitmapAllocator, liveAllocationArr);
+		}
+
+		while (!liveAllocationArr.empty())
+			DeleteLiveAllocation(liveAllocationArr, liveRangeMap, static_cast<std::size_t>(rng() % liveAllocationArr.size()));
+
+		VerifyStatisticsConsistency(bitmapAllocator, liveAllocationArr);
+
+		// Once everything has been deleted, all of the blocks should have been merged back
+		// together, so the entire heap should be available for a single allocation.
+		const D3D12_RESOURCE_ALLOCATION_INFO fullHeapAllocInfo{
+			.SizeInBytes = config.HeapSizeInBytes,
+			.Alignment = config.MinimumBlockSizeInBytes
+		};
+
+		const std::optional<Brawler::D3DHeapAllocationHandle> hFullHeapAllocation{ bitmapAllocator.Allocate(fullHeapAllocInfo) };
+		assert(hFullHeapAllocation.has_value() && hFullHeapAllocation->GetOffset() == 0 && "ERROR: The D3DHeapBuddyAllocator did not merge all of its free blocks back together!");
+	}
+}
+
+namespace Tests
+{
+	namespace D3DHeapBuddyAllocator
+	{
+		void RunD3DHeapBuddyAllocatorTests()
+		{
+			for (const auto& config : TEST_CONFIGURATION_ARR)
+			{
+				for (std::uint32_t seed = 0; seed < SEEDS_PER_CONFIGURATION; ++seed)
+				{
+					RunDifferentialTest(config, seed);
+					RunRandomizedTest(config, seed);
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+module;
+
+export module Tests.D3DHeapBuddyAllocator;
+
+export namespace Tests
+{
+	namespace D3DHeapBuddyAllocator
+	{
+		/// <summary>
+		/// Runs a randomized differential test of the bitmap-based Brawler::D3DHeapBuddyAllocator
+		/// against the original tree-based implementation (Brawler::IMPL::D3DHeapTreeBuddyAllocator).
+		/// Both allocators are given the same sequence of allocations, and every allocation must
+		/// succeed or fail in both of them, and at the same offset. Since the tree never merges
+		/// free blocks, deletions are tested separately: random allocations and deletions are
+		/// checked for overlaps and consistent statistics, and the whole heap must be available
+		/// again once everything has been deleted. Neither allocator uses an ID3D12Heap, so this
+		/// test can be run without a D3D12 device.
+		/// </summary>
+		void RunD3DHeapBuddyAllocatorTests();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+module;
+#include <cstdint>
+#include <cassert>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <bit>
+#include "DxDef.h"
+
+module Brawler.IMPL.D3DHeapTreeBuddyAllocator;
+import Util.Math;
+import Brawler.IMPL.D3DHeapBuddyAllocatorNode;
+import Brawler.D3DHeapBuddyAllocator;
+
+namespace Brawler
+{
+	namespace IMPL
+	{
+		D3DHeapTreeBuddyAllocator::D3DHeapTreeBuddyAllocator() :
+			mHeadNode(nullptr),
+			mMinimumNodeSize(0),
+			mFailedAllocationCount(0)
+		{}
+
+		void D3DHeapTreeBuddyAllocator::Initialize(const std::uint64_t heapSizeInBytes, const std::uint64_t minimumNodeSizeInBytes)
+		{
+			mMinimumNodeSize = minimumNodeSizeInBytes;
+			mFailedAllocationCount = 0;
+
+			// Create the root node of the tree.
+			mHeadNode = std::make_unique<D3DHeapBuddyAllocatorNode>(*this, heapSizeInBytes);
+		}
+
+		D3DHeapBuddyAllocatorNode* D3DHeapTreeBuddyAllocator::Allocate(const D3D12_RESOURCE_ALLOCATION_INFO& allocInfo)
+		{
+			// Make sure that we are doing a properly-aligned allocation.
+			assert(Util::Math::IsAligned(allocInfo.SizeInBytes, GetMinimumNodeSize()) && "ERROR: An attempt was made to perform an unaligned allocation within a D3DHeap!");
+
+			if (GetLargestAvailableRegionSize() < allocInfo.SizeInBytes)
+			{
+				++mFailedAllocationCount;
+				return nullptr;
+			}
+
+			D3DHeapBuddyAllocatorNode* suitableNode = mHeadNode->FindSuitableNodeForReservation(allocInfo);
+			if (suitableNode == nullptr)
+			{
+				++mFailedAllocationCount;
+				return nullptr;
+			}
+
+			suitableNode->CreateReservation(allocInfo.SizeInBytes);
+			return suitableNode;
+		}
+
+		void D3DHeapTreeBuddyAllocator::DeleteAllocation(D3DHeapBuddyAllocatorNode& reservedNode)
+		{
+			assert(reservedNode.Reserved);
+			reservedNode.DeleteReservation();
+		}
+
+		std::uint64_t D3DHeapTreeBuddyAllocator::GetLargestAvailableRegionSize() const
+		{
+			assert(mHeadNode != nullptr && "ERROR: An attempt was made to use a D3DHeapTreeBuddyAllocator before it was initialized!");
+
+			return mHeadNode->AvailableSizeInBytes;
+		}
+
+		D3DHeapBuddyAllocator::Statistics D3DHeapTreeBuddyAllocator::GetStatistics() const
+		{
+			assert(mHeadNode != nullptr && "ERROR: An attempt was made to use a D3DHeapTreeBuddyAllocator before it was initialized!");
+
+			D3DHeapBuddyAllocator::Statistics statistics{
+				.HeapSizeInBytes = mHeadNode->SizeInBytes,
+				.AllocatedBytes = 0,
+				.AllocationCount = 0,
+				.AlignmentWasteBytes = 0,
+				.FreeBytes = 0,
+				.FreeBlockCount = 0,
+				.FreeBytesPerSizeClass{},
+				.LargestFreeBlockSizeInBytes = 0,
+				.ExternalFragmentationRatio = 0.0f,
+				.FailedAllocationCount = mFailedAllocationCount
+			};
+
+			// Every byte of the heap belongs to exactly one node which is either reserved or has no
+			// children. Each free node without children is counted as a separate free block, even
+			// if its buddy is free, too, since the tree cannot use the two of them together.
+			std::vector<const D3DHeapBuddyAllocatorNode*> nodeStack{ mHeadNode.get() };
+
+			while (!nodeStack.empty())
+			{
+				const D3DHeapBuddyAllocatorNode& currNode{ *(nodeStack.back()) };
+				nodeStack.pop_back();
+
+				if (currNode.Reserved)
+				{
+					statistics.AllocatedBytes += currNode.SizeInBytes;
+					++(statistics.AllocationCount);
+					statistics.AlignmentWasteBytes += (currNode.SizeInBytes - currNode.ReservedSizeInBytes);
+				}
+				else if (currNode.LeftChildNode == nullptr)
+				{
+					statistics.FreeBytes += currNode.SizeInBytes;
+					++(statistics.FreeBlockCount);
+
+					statistics.FreeBytesPerSizeClass[std::bit_width(currNode.SizeInBytes) - 1] += currNode.SizeInBytes;
+					statistics.LargestFreeBlockSizeInBytes = std::max(statistics.LargestFreeBlockSizeInBytes, currNode.SizeInBytes);
+				}
+				else
+				{
+					nodeStack.push_back(currNode.LeftChildNode.get());
+					nodeStack.push_back(currNode.RightChildNode.get());
+				}
+			}
+
+			if (statistics.FreeBytes != 0)
+				statistics.ExternalFragmentationRatio = (1.0f - (static_cast<float>(statistics.LargestFreeBlockSizeInBytes) / static_cast<float>(statistics.FreeBytes)));
+
+			return statistics;
+		}
+
+		std::uint64_t D3DHeapTreeBuddyAllocator::GetMinimumNodeSize() const
+		{
+			return mMinimumNodeSize;
+		}
+	}
+}
\ No newline at end of file
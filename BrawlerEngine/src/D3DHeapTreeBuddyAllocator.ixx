@@ -0,0 +1,66 @@
+module;
+#include <memory>
+#include <cstdint>
+#include "DxDef.h"
+
+export module Brawler.IMPL.D3DHeapTreeBuddyAllocator;
+import Brawler.IMPL.D3DHeapBuddyAllocatorNode;
+import Brawler.D3DHeapBuddyAllocator;
+
+export namespace Brawler
+{
+	namespace IMPL
+	{
+		// This is the original implementation of the D3DHeapBuddyAllocator, which builds a tree
+		// of heap-allocated D3DHeapBuddyAllocatorNodes. It is no longer used by the D3DHeap class,
+		// but it is kept around, unchanged, as a reference implementation for the differential
+		// test in Tests.D3DHeapBuddyAllocator. Both allocators give an allocation the free block
+		// with the lowest offset which is large enough, so for the same sequence of allocations,
+		// they should always return the same offsets.
+		//
+		// Unlike the D3DHeapBuddyAllocator, the tree never merges free buddies back together once
+		// a node has been split. Thus, the two only agree until the first allocation is deleted.
+
+		class D3DHeapTreeBuddyAllocator
+		{
+		private:
+			friend struct D3DHeapBuddyAllocatorNode;
+
+		public:
+			D3DHeapTreeBuddyAllocator();
+
+			D3DHeapTreeBuddyAllocator(const D3DHeapTreeBuddyAllocator& rhs) = delete;
+			D3DHeapTreeBuddyAllocator& operator=(const D3DHeapTreeBuddyAllocator& rhs) = delete;
+
+			// Every D3DHeapBuddyAllocatorNode stores a pointer to its allocator.
+			D3DHeapTreeBuddyAllocator(D3DHeapTreeBuddyAllocator&& rhs) noexcept = delete;
+			D3DHeapTreeBuddyAllocator& operator=(D3DHeapTreeBuddyAllocator&& rhs) noexcept = delete;
+
+			void Initialize(const std::uint64_t heapSizeInBytes, const std::uint64_t minimumNodeSizeInBytes);
+
+			/// <summary>
+			/// Attempts to reserve a node for an allocation described by allocInfo.
+			/// </summary>
+			/// <returns>
+			/// If successful, then the function returns the reserved node. The allocation begins
+			/// at the node's offset aligned up to allocInfo.Alignment. Otherwise, the function
+			/// returns nullptr.
+			/// </returns>
+			D3DHeapBuddyAllocatorNode* Allocate(const D3D12_RESOURCE_ALLOCATION_INFO& allocInfo);
+
+			void DeleteAllocation(D3DHeapBuddyAllocatorNode& reservedNode);
+
+			std::uint64_t GetLargestAvailableRegionSize() const;
+
+			D3DHeapBuddyAllocator::Statistics GetStatistics() const;
+
+		private:
+			std::uint64_t GetMinimumNodeSize() const;
+
+		private:
+			std::unique_ptr<D3DHeapBuddyAllocatorNode> mHeadNode;
+			std::uint64_t mMinimumNodeSize;
+			std::uint64_t mFailedAllocationCount;
+		};
+	}
+}
\ No newline at end of file
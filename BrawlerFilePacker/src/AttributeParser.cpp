@@ -5,13 +5,17 @@ module;
 #include <string>
 #include <optional>
 #include <format>
+#include <algorithm>
+#include <functional>
 
 module Brawler.BCAInfoParsing.AttributeParser;
 import Util.General;
+import Brawler.StringHasher;
 
 namespace
 {
 	static constexpr std::string_view DO_NOT_COMPRESS_ATTRIBUTE_NAME{ "DoNotCompress" };
+	static constexpr std::string_view COMPRESSION_DICTIONARY_ATTRIBUTE_NAME{ "CompressionDictionary" };
 
 	static constexpr std::string_view TRUE_WIN32_ATTRIBUTE_VALUE{ "TRUE" };
 	static constexpr std::string_view TRUE_CXX_ATTRIBUTE_VALUE{ "true" };
@@ -21,16 +25,18 @@ namespace
 	template <typename RetType, typename... Args>
 	using FunctionPtr = Brawler::BCAInfoParsing::FunctionPtr<RetType, Args...>;
 
+	using BCAInfoResolver = Brawler::BCAInfoParsing::BCAInfoResolver;
+
 	template <bool DisableCompression>
 	static void ToggleDoNotCompress(Brawler::BCAInfo& bcaInfo)
 	{
 		bcaInfo.DoNotCompress = DisableCompression;
 	}
 	
-	static const std::unordered_map<std::string_view, FunctionPtr<bool, Brawler::BCAInfoParsing::BCAInfoParserContext&, FunctionPtr<void, Brawler::BCAInfo&>&>> attributeValueVerificationMap = [] ()
+	static const std::unordered_map<std::string_view, FunctionPtr<bool, Brawler::BCAInfoParsing::BCAInfoParserContext&, BCAInfoResolver&>> attributeValueVerificationMap = [] ()
 	{
-		std::unordered_map<std::string_view, Brawler::BCAInfoParsing::FunctionPtr<bool, Brawler::BCAInfoParsing::BCAInfoParserContext&, FunctionPtr<void, Brawler::BCAInfo&>&>> verificationMap{};
-		verificationMap[DO_NOT_COMPRESS_ATTRIBUTE_NAME] = [] (Brawler::BCAInfoParsing::BCAInfoParserContext& parserContext, FunctionPtr<void, Brawler::BCAInfo&>& bcaInfoResolverPtr)
+		std::unordered_map<std::string_view, Brawler::BCAInfoParsing::FunctionPtr<bool, Brawler::BCAInfoParsing::BCAInfoParserContext&, BCAInfoResolver&>> verificationMap{};
+		verificationMap[DO_NOT_COMPRESS_ATTRIBUTE_NAME] = [] (Brawler::BCAInfoParsing::BCAInfoParserContext& parserContext, BCAInfoResolver& bcaInfoResolverPtr)
 		{
 			if (parserContext.Expect(TRUE_WIN32_ATTRIBUTE_VALUE) || parserContext.Expect(TRUE_CXX_ATTRIBUTE_VALUE))
 			{
@@ -48,6 +54,56 @@ namespace
 			return false;
 		};
 
+		verificationMap[COMPRESSION_DICTIONARY_ATTRIBUTE_NAME] = [] (Brawler::BCAInfoParsing::BCAInfoParserContext& parserContext, BCAInfoResolver& bcaInfoResolverPtr)
+		{
+			// The value is the name of the compression dictionary group, given as a string. Every
+			// file which names the same group is compressed with the same ZSTD dictionary.
+			if (!parserContext.Expect(R"(")")) [[unlikely]]
+			{
+				parserContext.AddErrorString(LR"(SYNTAX ERROR: CompressionDictionary must be set to the name of a dictionary group, given in double quotes ('"')!)");
+				return false;
+			}
+
+			std::string groupName{};
+
+			{
+				Brawler::BCAInfoParsing::ScopedWhiteSpaceSkipToggle disableWhiteSpaceSkipping{ parserContext };
+
+				while (true)
+				{
+					const std::optional<std::uint8_t> nextChar = parserContext.Peek();
+					parserContext.Consume();
+
+					if (!nextChar.has_value()) [[unlikely]]
+					{
+						parserContext.AddErrorString(LR"(SYNTAX ERROR: A double quotes ('"') character is expected at the end of a compression dictionary group name!)");
+						return false;
+					}
+
+					if (*nextChar == '"')
+						break;
+					else
+						groupName += *nextChar;
+				}
+			}
+
+			if (groupName.empty()) [[unlikely]]
+			{
+				parserContext.AddErrorString(L"ERROR: Compression dictionary group names cannot be empty!");
+				return false;
+			}
+
+			// A hash of zero means that the file does not belong to any group.
+			const std::uint64_t groupHash = std::max<std::uint64_t>(Brawler::StringHasher{ std::string_view{ groupName } }.GetHash(), 1);
+
+			bcaInfoResolverPtr = [groupHash] (Brawler::BCAInfo& bcaInfo)
+			{
+				bcaInfo.CompressionDictionaryGroupHash = groupHash;
+			};
+
+			return true;
+		};
+
 		return verificationMap;
 	}();
 }
@@ -1,5 +1,6 @@
 module;
 #include <compare>  // What the hell? Why do I need this here?
+#include <functional>
 
 export module Brawler.BCAInfoParsing.AttributeParser;
 import Brawler.BCAInfoParsing.BCAInfoParserContext;
@@ -11,6 +12,10 @@ namespace Brawler
 	{
 		template <typename RetType, typename... Args>
 		using FunctionPtr = RetType(*)(Args...);
+
+		// Attributes with arbitrary values, such as the name of a compression dictionary group,
+		// need to capture that value, so a plain function pointer is not enough here.
+		using BCAInfoResolver = std::function<void(BCAInfo&)>;
 	}
 }
 
@@ -34,7 +39,7 @@ export namespace Brawler
 			void ResolveBCAInfo(BCAInfo& bcaInfo) const;
 
 		private:
-			FunctionPtr<void, BCAInfo&> mBCAInfoResolver;
+			BCAInfoResolver mBCAInfoResolver;
 		};
 	}
 }
\ No newline at end of file
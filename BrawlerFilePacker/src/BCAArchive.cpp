@@ -21,6 +21,7 @@ import Brawler.ZSTDContext;
 import Brawler.StringHasher;
 import Util.Win32;
 import Brawler.BCAInfoDatabase;
+import Brawler.ZSTDDictionary;
 
 namespace
 {
@@ -64,7 +65,7 @@ namespace
 	// between versions.
 
 	/// <summary>
-	/// Version Number: 1
+	/// Version Numbers: 1, 2
 	/// </summary>
 	struct VersionedBCAFileHeaderV1
 	{
@@ -103,7 +104,56 @@ namespace
 		return lhs;
 	}
 
-	using CurrentVersionedBCAFileHeader = VersionedBCAFileHeaderV1;
+	/// <summary>
+	/// Version Number: 3
+	/// </summary>
+	struct VersionedBCAFileHeaderV3
+	{
+		/// <summary>
+		/// The first byte represents the PackerSettings::BuildMode which was used when
+		/// creating the BCA file. (See VersionedBCAFileHeaderV1::BuildMode.)
+		/// </summary>
+		std::uint8_t BuildMode;
+
+		/// <summary>
+		/// The next 64 bytes are the SHA-512 hash of the data *before* compression.
+		/// </summary>
+		Brawler::SHA512Hash UncompressedDataHash;
+
+		/// <summary>
+		/// The next four bytes are the ID of the ZSTD dictionary which the data was
+		/// compressed with, or zero (0) if it was compressed without one. Since the
+		/// dictionary of a group is re-trained whenever any asset within that group
+		/// changes, an asset whose own data has not changed may still need to be
+		/// re-compressed.
+		/// </summary>
+		std::uint32_t DictionaryID;
+	};
+
+	std::ifstream& operator>>(std::ifstream& lhs, VersionedBCAFileHeaderV3& rhs)
+	{
+		lhs.read(reinterpret_cast<char*>(&(rhs.BuildMode)), sizeof(rhs.BuildMode));
+
+		std::array<std::uint8_t, Util::Engine::SHA_512_HASH_SIZE_IN_BYTES> hashByteArr{};
+		lhs.read(reinterpret_cast<char*>(hashByteArr.data()), hashByteArr.size());
+
+		rhs.UncompressedDataHash = Brawler::SHA512Hash{ std::move(hashByteArr) };
+
+		lhs.read(reinterpret_cast<char*>(&(rhs.DictionaryID)), sizeof(rhs.DictionaryID));
+
+		return lhs;
+	}
+
+	std::ofstream& operator<<(std::ofstream& lhs, const VersionedBCAFileHeaderV3& rhs)
+	{
+		lhs.write(reinterpret_cast<const char*>(&(rhs.BuildMode)), sizeof(rhs.BuildMode));
+		lhs.write(reinterpret_cast<const char*>(rhs.UncompressedDataHash.GetByteArray().data()), rhs.UncompressedDataHash.GetByteArray().size_bytes());
+		lhs.write(reinterpret_cast<const char*>(&(rhs.DictionaryID)), sizeof(rhs.DictionaryID));
+
+		return lhs;
+	}
+
+	using CurrentVersionedBCAFileHeader = VersionedBCAFileHeaderV3;
 }
 
 namespace Brawler
@@ -132,6 +182,30 @@ namespace Brawler
 		mCompressedAssetFrame = ExtractCompressedAssetFromExistingBCAArchive<VersionedBCAFileHeaderV1>(bcaFileStream);
 	}
 
+	template <>
+	void BCAArchive::TryInitializeBCAArchiveFromFile<VersionedBCAFileHeaderV3>(std::ifstream& bcaFileStream)
+	{
+		VersionedBCAFileHeaderV3 versionedBCAHeader{};
+		bcaFileStream >> versionedBCAHeader;
+
+		if (static_cast<PackerSettings::BuildMode>(versionedBCAHeader.BuildMode) != Util::Engine::GetAssetBuildMode()) [[unlikely]]
+			throw std::runtime_error{ "ERROR: There was a build mode mismatch between an existing BCA archive and the current build mode setting! (Did you set your command line arguments correctly?)" };
+
+		SHA512Hash oldBCAHash{ std::move(versionedBCAHeader.UncompressedDataHash) };
+
+		if (oldBCAHash != mMetadata.UncompressedDataHash)
+			return;
+
+		// Even if the asset itself has not changed, the data can only be re-used if it was
+		// compressed with the same dictionary.
+		const std::uint32_t currDictionaryID = (mCompressionDictionaryPtr != nullptr ? mCompressionDictionaryPtr->GetDictionaryID() : 0);
+
+		if (versionedBCAHeader.DictionaryID != currDictionaryID)
+			return;
+
+		mCompressedAssetFrame = ExtractCompressedAssetFromExistingBCAArchive<VersionedBCAFileHeaderV3>(bcaFileStream);
+	}
+
 	BCAArchive::BCAArchive(const AssetCompilerContext& context, std::filesystem::path&& assetDataPath) :
 		mAssetDataPath(std::move(assetDataPath)),
 		mBCAFilePath([&context] (const std::filesystem::path& assetPath)
@@ -159,7 +233,8 @@ namespace Brawler
 		mAssetDataBuffer(),
 		mCompressedAssetFrame(),
 		mMetadata(),
-		mBCAInfoPtr(nullptr)
+		mBCAInfoPtr(nullptr),
+		mCompressionDictionaryPtr(nullptr)
 	{
 		InitializeMetadata(context);
 		InitializeBCAInfo();
@@ -167,15 +242,45 @@ namespace Brawler
 
 	void BCAArchive::InitializeArchiveData()
 	{
+		// Assets which belong to a compression dictionary group are compressed later by
+		// the BPKFactory, once the dictionary for their group has been trained. Until then,
+		// we need to hold on to their uncompressed data.
+		if (RequiresCompressionDictionary())
+			return;
+
 		if (!mBCAInfoPtr->DoNotCompress) [[likely]]
 			InitializeArchiveDataWithCompression();
 		else [[unlikely]]
 			InitializeArchiveDataWithoutCompression();
 
-		// Free up the heap memory consumed for the original asset data, since
-		// we do not need it anymore.
-		mAssetDataBuffer.clear();
-		mAssetDataBuffer.shrink_to_fit();
+		ReleaseUncompressedAssetData();
+	}
+
+	void BCAArchive::InitializeArchiveDataWithDictionary(const ZSTDDictionary* const dictionaryPtr)
+	{
+		assert(RequiresCompressionDictionary() && "ERROR: BCAArchive::InitializeArchiveDataWithDictionary() was called for an asset which does not belong to a compression dictionary group (or which was already compressed)!");
+
+		mCompressionDictionaryPtr = dictionaryPtr;
+		InitializeArchiveDataWithCompression();
+
+		// The BPKFactory owns the dictionary, so we shouldn't keep a pointer to it around.
+		mCompressionDictionaryPtr = nullptr;
+
+		ReleaseUncompressedAssetData();
+	}
+
+	bool BCAArchive::RequiresCompressionDictionary() const
+	{
+		assert(mBCAInfoPtr != nullptr);
+
+		// Even an empty asset has a seek table, so mCompressedAssetFrame is never empty once
+		// the asset has been compressed.
+		return (!mBCAInfoPtr->DoNotCompress && mBCAInfoPtr->CompressionDictionaryGroupHash != 0 && mCompressedAssetFrame.IsEmpty());
+	}
+
+	std::span<const std::uint8_t> BCAArchive::GetUncompressedAssetData() const
+	{
+		return mAssetDataBuffer;
 	}
 
 	const std::filesystem::path& BCAArchive::GetAssetDataPath() const
@@ -270,6 +375,14 @@ namespace Brawler
 		Util::Win32::WriteFormattedConsoleMessage(std::format(L"{} -> [Compression Disabled - No .bca File Generated]", mAssetDataPath.c_str()));
 	}
 
+	void BCAArchive::ReleaseUncompressedAssetData()
+	{
+		// Free up the heap memory consumed for the original asset data, since
+		// we do not need it anymore.
+		mAssetDataBuffer.clear();
+		mAssetDataBuffer.shrink_to_fit();
+	}
+
 	void BCAArchive::TryReUsePreCompiledAsset()
 	{
 		if (!std::filesystem::exists(mBCAFilePath)) [[unlikely]]
@@ -313,9 +426,11 @@ namespace Brawler
 	{
 		// We don't immediately know the size of the compressed data. However, we
 		// can calculate it as the file size minus the size of both the common and
-		// versioned BCA header files.
+		// versioned BCA header files. We use the position of the cursor for the latter,
+		// rather than the size of the header structs, since those may contain padding
+		// which is never written to the file.
 
-		const std::size_t compressedFrameSize = std::filesystem::file_size(mBCAFilePath) - (sizeof(CommonBCAFileHeader) + sizeof(VersionedBCAHeaderType));
+		const std::size_t compressedFrameSize = std::filesystem::file_size(mBCAFilePath) - static_cast<std::size_t>(bcaFileStream.tellg());
 		std::vector<std::uint8_t> frameByteArr{};
 		frameByteArr.resize(compressedFrameSize);
 
@@ -347,11 +462,12 @@ namespace Brawler
 
 		// Write out the versioned BCA file header.
 		{
-			static_assert(std::is_same_v<CurrentVersionedBCAFileHeader, VersionedBCAFileHeaderV1>, "ERROR: The definition for CurrentVersionedBCAFileHeader within BCAArchive::CreateBCAArchive() is outdated!");
+			static_assert(std::is_same_v<CurrentVersionedBCAFileHeader, VersionedBCAFileHeaderV3>, "ERROR: The definition for CurrentVersionedBCAFileHeader within BCAArchive::CreateBCAArchive() is outdated!");
 
 			CurrentVersionedBCAFileHeader versionedBCAHeader{
 				.BuildMode = std::to_underlying(Util::Engine::GetAssetBuildMode()),
-				.UncompressedDataHash = mMetadata.UncompressedDataHash
+				.UncompressedDataHash = mMetadata.UncompressedDataHash,
+				.DictionaryID = (mCompressionDictionaryPtr != nullptr ? mCompressionDictionaryPtr->GetDictionaryID() : 0)
 			};
 
 			bcaFileStream << versionedBCAHeader;
@@ -363,7 +479,11 @@ namespace Brawler
 		// we do not need to compress the data again.
 		{
 			if (mCompressedAssetFrame.IsEmpty())
-				mCompressedAssetFrame = ZSTDFrame{ Util::Threading::GetThreadLocalResources().ZSTDContext.CompressData(mAssetDataBuffer) };
+			{
+				const ZSTDContext& zstdContext{ Util::Threading::GetThreadLocalResources().ZSTDContext };
+
+				mCompressedAssetFrame = (mCompressionDictionaryPtr != nullptr ? zstdContext.CompressData(mAssetDataBuffer, *mCompressionDictionaryPtr) : zstdContext.CompressData(mAssetDataBuffer));
+			}
 
 			bcaFileStream << mCompressedAssetFrame;
 		}
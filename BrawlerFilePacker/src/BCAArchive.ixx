@@ -2,11 +2,14 @@ module;
 #include <filesystem>
 #include <fstream>
 #include <vector>
+#include <span>
+#include <cstdint>
 
 export module Brawler.BCAArchive;
 import Brawler.BCAMetadata;
 import Brawler.ZSTDFrame;
 import Brawler.BCAInfo;
+import Brawler.ZSTDDictionary;
 
 export namespace Brawler
 {
@@ -16,6 +19,7 @@ export namespace Brawler
 namespace
 {
 	struct VersionedBCAFileHeaderV1;
+	struct VersionedBCAFileHeaderV3;
 }
 
 export namespace Brawler
@@ -25,8 +29,44 @@ export namespace Brawler
 	public:
 		explicit BCAArchive(const AssetCompilerContext& context, std::filesystem::path&& assetDataPath);
 
+		/// <summary>
+		/// Compresses the asset data, unless the asset belongs to a compression dictionary
+		/// group (see BCAInfo::CompressionDictionaryGroupHash). The dictionary for such a group
+		/// can only be trained once every asset in it has been loaded, so these assets keep
+		/// their uncompressed data around until the BPKFactory calls
+		/// BCAArchive::InitializeArchiveDataWithDictionary().
+		/// </summary>
 		void InitializeArchiveData();
 
+		/// <summary>
+		/// Compresses the asset data of an asset which belongs to a compression dictionary
+		/// group with the dictionary trained for that group.
+		/// </summary>
+		/// <param name="dictionaryPtr">
+		/// - A pointer to the dictionary which was trained for the asset's group. This can be
+		///   nullptr if no dictionary could be trained, in which case the asset is compressed
+		///   without one. The dictionary only needs to remain valid for the duration of the
+		///   call.
+		/// </param>
+		void InitializeArchiveDataWithDictionary(const ZSTDDictionary* const dictionaryPtr);
+
+		/// <summary>
+		/// Describes whether or not the asset is still waiting for the dictionary of its
+		/// compression dictionary group. If this returns true, then
+		/// BCAArchive::InitializeArchiveDataWithDictionary() must be called before the
+		/// compressed asset data can be used.
+		/// </summary>
+		bool RequiresCompressionDictionary() const;
+
+		/// <summary>
+		/// Use this function to retrieve the asset data *before* compression. This is only
+		/// available until the asset data has been compressed.
+		/// </summary>
+		/// <returns>
+		/// This function returns a std::span referring to the uncompressed asset data.
+		/// </returns>
+		std::span<const std::uint8_t> GetUncompressedAssetData() const;
+
 		/// <summary>
 		/// Use this function to retrieve the directory path for the *uncompressed*
 		/// source asset.
@@ -69,6 +109,7 @@ export namespace Brawler
 
 		void InitializeArchiveDataWithCompression();
 		void InitializeArchiveDataWithoutCompression();
+		void ReleaseUncompressedAssetData();
 
 		/// <summary>
 		/// Attempts to re-use an existing BCA archive from a previous compilation of the
@@ -121,5 +162,11 @@ export namespace Brawler
 
 		BCAMetadata mMetadata;
 		const BCAInfo* mBCAInfoPtr;
+
+		/// <summary>
+		/// This is the dictionary which the asset data is compressed with, if any. It is only
+		/// set during BCAArchive::InitializeArchiveDataWithDictionary().
+		/// </summary>
+		const ZSTDDictionary* mCompressionDictionaryPtr;
 	};
 }
\ No newline at end of file
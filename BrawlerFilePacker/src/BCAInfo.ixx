@@ -1,4 +1,5 @@
 module;
+#include <cstdint>
 #include <string_view>
 #include <filesystem>
 
@@ -13,12 +14,24 @@ export namespace Brawler
 		/// archive.
 		/// </summary>
 		bool DoNotCompress;
+
+		/// <summary>
+		/// If this is not zero, then it is the hash of the name of the compression dictionary
+		/// group which the corresponding file belongs to. The BPKFactory trains one ZSTD
+		/// dictionary for every such group from the data of its files, and then compresses
+		/// each of these files with it. This is very effective for many small, similar files,
+		/// such as vertex and index buffers.
+		/// 
+		/// This value is ignored if DoNotCompress is true.
+		/// </summary>
+		std::uint64_t CompressionDictionaryGroupHash;
 	};
 
 	constexpr std::wstring_view BCA_INFO_FILE_NAME{ L".BCAINFO" };
 
 	constexpr BCAInfo DEFAULT_BCA_INFO_VALUE{
-		.DoNotCompress = false
+		.DoNotCompress = false,
+		.CompressionDictionaryGroupHash = 0
 	};
 }
 
@@ -9,6 +9,14 @@ module;
 #include <stdexcept>
 #include <fstream>
 #include <unordered_map>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <bit>
+#include <functional>
+#include <map>
+#include <optional>
+#include <format>
 
 module Brawler.BPKFactory;
 import Brawler.BCAArchive;
@@ -17,6 +25,10 @@ import Brawler.BCAMetadata;
 import Brawler.PackerSettings;
 import Brawler.ZSTDFrame;
 import Brawler.BCAInfo;
+import Brawler.BPKTableOfContentsHash;
+import Brawler.ZSTDDictionary;
+import Brawler.JobSystem;
+import Util.Win32;
 
 namespace
 {
@@ -75,13 +87,77 @@ namespace
 		return lhs;
 	}
 
-	struct VersionedBPKFileHeaderV1
+	struct CompressionDictionaryEntryV1
+	{
+		/// <summary>
+		/// This is the offset, in bytes, from the start of the BPK file to the start
+		/// of the dictionary's data.
+		/// </summary>
+		std::uint64_t FileOffsetInBytes;
+
+		/// <summary>
+		/// This is the size, in bytes, of the dictionary's data.
+		/// </summary>
+		std::uint32_t SizeInBytes;
+
+		/// <summary>
+		/// This is the ID of the dictionary. ZSTD writes this ID into the header of every
+		/// frame which was compressed with the dictionary, so it is what the engine uses to
+		/// find the dictionary needed to decompress a given asset.
+		/// </summary>
+		std::uint32_t DictionaryID;
+	};
+
+	std::ofstream& operator<<(std::ofstream& lhs, const CompressionDictionaryEntryV1& rhs)
+	{
+		lhs.write(reinterpret_cast<const char*>(&(rhs.FileOffsetInBytes)), sizeof(rhs.FileOffsetInBytes));
+		lhs.write(reinterpret_cast<const char*>(&(rhs.SizeInBytes)), sizeof(rhs.SizeInBytes));
+		lhs.write(reinterpret_cast<const char*>(&(rhs.DictionaryID)), sizeof(rhs.DictionaryID));
+
+		return lhs;
+	}
+
+	struct VersionedBPKFileHeaderV3
 	{
 		/// <summary>
 		/// This is the size, in bytes, of the entire table of contents (ToC) for this
-		/// BPK file.
+		/// BPK file. This includes both the ToC entries and the pilot values which follow
+		/// them, as well as any padding after the pilot values and the compression
+		/// dictionary entries which follow that padding. It does *NOT* include the data
+		/// of the dictionaries themselves, which directly follows the ToC.
+		/// </summary>
+		std::uint64_t TableOfContentsSizeInBytes;
+
+		/// <summary>
+		/// This is the seed which was used to hash the FileIdentifierHash of every ToC
+		/// entry. (See Brawler.BPKTableOfContentsHash.)
+		/// </summary>
+		std::uint64_t HashSeed;
+
+		/// <summary>
+		/// This is the number of ToC entries. The ToC entries directly follow this
+		/// header, and they are stored in the order of their slot indices, rather than in
+		/// the order in which their data appears in the BPK archive.
+		/// </summary>
+		std::uint32_t TableOfContentsEntryCount;
+
+		/// <summary>
+		/// This is the number of buckets, and thus of std::uint32_t pilot values, which
+		/// directly follow the ToC entries.
 		/// </summary>
-		std::size_t TableOfContentsSizeInBytes;
+		std::uint32_t BucketCount;
+
+		/// <summary>
+		/// This is the number of compression dictionary entries, which directly follow the
+		/// padding after the pilot values.
+		/// </summary>
+		std::uint32_t DictionaryCount;
+
+		/// <summary>
+		/// This is reserved for future use, and it keeps the ToC entries 8-byte aligned.
+		/// It *MUST* be zero (0).
+		/// </summary>
+		std::uint32_t Reserved;
 
 		/// <summary>
 		/// This is a type alias for the struct representing an entry in the ToC. Every
@@ -92,70 +168,384 @@ namespace
 		using TableOfContentsEntry = TableOfContentsEntryV1;
 	};
 
-	std::ofstream& operator<<(std::ofstream& lhs, const VersionedBPKFileHeaderV1& rhs)
+	std::ofstream& operator<<(std::ofstream& lhs, const VersionedBPKFileHeaderV3& rhs)
 	{
 		lhs.write(reinterpret_cast<const char*>(&(rhs.TableOfContentsSizeInBytes)), sizeof(rhs.TableOfContentsSizeInBytes));
+		lhs.write(reinterpret_cast<const char*>(&(rhs.HashSeed)), sizeof(rhs.HashSeed));
+		lhs.write(reinterpret_cast<const char*>(&(rhs.TableOfContentsEntryCount)), sizeof(rhs.TableOfContentsEntryCount));
+		lhs.write(reinterpret_cast<const char*>(&(rhs.BucketCount)), sizeof(rhs.BucketCount));
+		lhs.write(reinterpret_cast<const char*>(&(rhs.DictionaryCount)), sizeof(rhs.DictionaryCount));
+		lhs.write(reinterpret_cast<const char*>(&(rhs.Reserved)), sizeof(rhs.Reserved));
 
 		return lhs;
 	}
 
-	using CurrentVersionedBPKFileHeader = VersionedBPKFileHeaderV1;
+	using CurrentVersionedBPKFileHeader = VersionedBPKFileHeaderV3;
+
+	// The engine maps the ToC directly into memory and reads the ToC entries and the
+	// compression dictionary entries in place, so they need to be 8-byte aligned within the
+	// BPK archive.
+	static_assert((sizeof(CommonBPKFileHeader) + sizeof(VersionedBPKFileHeaderV3)) % alignof(std::uint64_t) == 0);
+	static_assert(sizeof(TableOfContentsEntryV1) == (4 * sizeof(std::uint64_t)));
+	static_assert(sizeof(CompressionDictionaryEntryV1) == (2 * sizeof(std::uint64_t)));
+	static_assert(std::endian::native == std::endian::little, "ERROR: BPK archives are always written in little-endian byte order!");
+
+	constexpr std::size_t GetPaddedTableOfContentsEntriesSize(const std::size_t entryCount, const std::uint32_t bucketCount)
+	{
+		const std::size_t unpaddedSize = ((sizeof(TableOfContentsEntryV1) * entryCount) + (sizeof(std::uint32_t) * bucketCount));
+
+		// Pad the pilot values so that the compression dictionary entries, and the data after
+		// them, begin at an 8-byte boundary, too.
+		return (((unpaddedSize + (alignof(std::uint64_t) - 1)) / alignof(std::uint64_t)) * alignof(std::uint64_t));
+	}
+
+	constexpr std::size_t GetTableOfContentsSize(const std::size_t entryCount, const std::uint32_t bucketCount, const std::size_t dictionaryCount)
+	{
+		return (GetPaddedTableOfContentsEntriesSize(entryCount, bucketCount) + (sizeof(CompressionDictionaryEntryV1) * dictionaryCount));
+	}
 }
 
 namespace Brawler
 {
+	struct BPKTableOfContentsLayout
+	{
+		std::uint64_t HashSeed;
+
+		/// <summary>
+		/// This is the pilot value of every bucket.
+		/// </summary>
+		std::vector<std::uint32_t> PilotValueArr;
+
+		/// <summary>
+		/// SlotIndexArr[i] is the index of the ToC entry of BPKFactory::mBCAArchiveArr[i]
+		/// within the ToC.
+		/// </summary>
+		std::vector<std::uint32_t> SlotIndexArr;
+	};
+
+	BPKTableOfContentsLayout BPKFactory::CreateTableOfContentsLayout() const
+	{
+		static constexpr std::uint32_t MAX_SEED_ATTEMPT_COUNT = 64;
+
+		assert(mBCAArchiveArr.size() <= std::numeric_limits<std::uint32_t>::max() && "ERROR: A BPK archive cannot contain more than 2^32 - 1 files!");
+
+		const std::uint32_t entryCount = static_cast<std::uint32_t>(mBCAArchiveArr.size());
+		const std::uint32_t bucketCount = BPKTableOfContentsHash::GetBucketCount(entryCount);
+
+		// Group the archives by bucket. This has to be redone for every seed, but we only
+		// need to allocate memory for it once.
+		std::vector<std::uint64_t> keyHashArr(entryCount);
+		std::vector<std::uint32_t> bucketIndexArr(entryCount);
+		std::vector<std::uint32_t> bucketStartArr(bucketCount + 1);
+		std::vector<std::uint32_t> bucketArchiveIndexArr(entryCount);
+		std::vector<std::uint32_t> bucketOrderArr(bucketCount);
+		std::vector<bool> isSlotTakenArr(entryCount);
+		std::vector<std::uint32_t> bucketSlotIndexArr{};
+
+		BPKTableOfContentsLayout tocLayout{
+			.HashSeed = 0,
+			.PilotValueArr = std::vector<std::uint32_t>(bucketCount),
+			.SlotIndexArr = std::vector<std::uint32_t>(entryCount)
+		};
+
+		for (std::uint32_t seedAttempt = 0; seedAttempt < MAX_SEED_ATTEMPT_COUNT; ++seedAttempt)
+		{
+			tocLayout.HashSeed = BPKTableOfContentsHash::MixHash(seedAttempt + 1);
+
+			std::ranges::fill(bucketStartArr, 0);
+			isSlotTakenArr.assign(entryCount, false);
+
+			for (std::uint32_t i = 0; i < entryCount; ++i)
+			{
+				keyHashArr[i] = BPKTableOfContentsHash::GetKeyHash(mBCAArchiveArr[i]->GetMetadata().SourceAssetDirectoryHash, tocLayout.HashSeed);
+				bucketIndexArr[i] = BPKTableOfContentsHash::GetBucketIndex(keyHashArr[i], bucketCount);
+
+				++(bucketStartArr[bucketIndexArr[i] + 1]);
+			}
+
+			// Two different asset paths would need to have the same 64-bit key hash for
+			// this to fail, but then no pilot value could ever separate them.
+			{
+				std::vector<std::uint64_t> sortedKeyHashArr{ keyHashArr };
+				std::ranges::sort(sortedKeyHashArr);
+
+				if (std::ranges::adjacent_find(sortedKeyHashArr) != sortedKeyHashArr.end()) [[unlikely]]
+					continue;
+			}
+
+			for (std::uint32_t i = 0; i < bucketCount; ++i)
+				bucketStartArr[i + 1] += bucketStartArr[i];
+
+			{
+				std::vector<std::uint32_t> bucketInsertionIndexArr{ bucketStartArr.begin(), (bucketStartArr.end() - 1) };
+
+				for (std::uint32_t i = 0; i < entryCount; ++i)
+					bucketArchiveIndexArr[bucketInsertionIndexArr[bucketIndexArr[i]]++] = i;
+			}
+
+			// Place the largest buckets first.
+			std::iota(bucketOrderArr.begin(), bucketOrderArr.end(), 0);
+			std::ranges::stable_sort(bucketOrderArr, std::ranges::greater{}, [&bucketStartArr] (const std::uint32_t bucketIndex) { return (bucketStartArr[bucketIndex + 1] - bucketStartArr[bucketIndex]); });
+
+			bool wereAllBucketsPlaced = true;
+
+			for (const auto bucketIndex : bucketOrderArr)
+			{
+				const std::span<const std::uint32_t> bucketArchiveIndexSpan{ (bucketArchiveIndexArr.data() + bucketStartArr[bucketIndex]), (bucketStartArr[bucketIndex + 1] - bucketStartArr[bucketIndex]) };
+
+				// The buckets are sorted by size, so all of the remaining buckets are empty,
+				// too. Their pilot values are never read, so we leave them at zero.
+				if (bucketArchiveIndexSpan.empty())
+					break;
+
+				bool wasPilotValueFound = false;
+
+				// With a minimal perfect hash, the last few buckets might need to try a lot of
+				// pilot values before they find a free slot; in the worst case, that is about
+				// as many as there are ToC entries.
+				const std::uint64_t maxPilotValue = std::clamp<std::uint64_t>((static_cast<std::uint64_t>(entryCount) * 64), 1024, (static_cast<std::uint64_t>(std::numeric_limits<std::uint32_t>::max()) + 1));
+
+				for (std::uint64_t pilotValue = 0; pilotValue < maxPilotValue && !wasPilotValueFound; ++pilotValue)
+				{
+					bucketSlotIndexArr.clear();
+					wasPilotValueFound = true;
+
+					for (const auto archiveIndex : bucketArchiveIndexSpan)
+					{
+						const std::uint32_t slotIndex = BPKTableOfContentsHash::GetSlotIndex(keyHashArr[archiveIndex], static_cast<std::uint32_t>(pilotValue), entryCount);
+
+						if (isSlotTakenArr[slotIndex] || std::ranges::find(bucketSlotIndexArr, slotIndex) != bucketSlotIndexArr.end())
+						{
+							wasPilotValueFound = false;
+							break;
+						}
+
+						bucketSlotIndexArr.push_back(slotIndex);
+					}
+
+					if (wasPilotValueFound)
+					{
+						tocLayout.PilotValueArr[bucketIndex] = static_cast<std::uint32_t>(pilotValue);
+
+						for (std::size_t i = 0; i < bucketArchiveIndexSpan.size(); ++i)
+						{
+							isSlotTakenArr[bucketSlotIndexArr[i]] = true;
+							tocLayout.SlotIndexArr[bucketArchiveIndexSpan[i]] = bucketSlotIndexArr[i];
+						}
+					}
+				}
+
+				if (!wasPilotValueFound) [[unlikely]]
+				{
+					wereAllBucketsPlaced = false;
+					break;
+				}
+			}
+
+			if (wereAllBucketsPlaced)
+				return tocLayout;
+
+			std::ranges::fill(tocLayout.PilotValueArr, 0);
+		}
+
+		throw std::runtime_error{ "ERROR: A perfect hash function could not be found for the table of contents of the BPK archive!" };
+	}
+
 	template <>
-	VersionedBPKFileHeaderV1 BPKFactory::CreateVersionedBPKFileHeader() const
+	VersionedBPKFileHeaderV3 BPKFactory::CreateVersionedBPKFileHeader(const BPKTableOfContentsLayout& tocLayout) const
 	{
-		static constexpr std::size_t TOC_ENTRY_SIZE = sizeof(VersionedBPKFileHeaderV1::TableOfContentsEntry);
-		
-		return VersionedBPKFileHeaderV1{
-			.TableOfContentsSizeInBytes{TOC_ENTRY_SIZE * mBCAArchiveArr.size()}
+		const std::uint32_t bucketCount = static_cast<std::uint32_t>(tocLayout.PilotValueArr.size());
+
+		return VersionedBPKFileHeaderV3{
+			.TableOfContentsSizeInBytes{ GetTableOfContentsSize(mBCAArchiveArr.size(), bucketCount, mDictionaryArr.size()) },
+			.HashSeed{ tocLayout.HashSeed },
+			.TableOfContentsEntryCount{ static_cast<std::uint32_t>(mBCAArchiveArr.size()) },
+			.BucketCount{ bucketCount },
+			.DictionaryCount{ static_cast<std::uint32_t>(mDictionaryArr.size()) },
+			.Reserved{ 0 }
 		};
 	}
 
 	template <>
-	void BPKFactory::WriteTableOfContents<VersionedBPKFileHeaderV1>(std::ofstream& bpkFileStream) const
+	void BPKFactory::WriteTableOfContents<VersionedBPKFileHeaderV3>(std::ofstream& bpkFileStream, const BPKTableOfContentsLayout& tocLayout) const
 	{
-		const std::size_t totalTOCSize{ sizeof(VersionedBPKFileHeaderV1::TableOfContentsEntry) * mBCAArchiveArr.size() };
+		const std::size_t totalTOCSize = GetTableOfContentsSize(mBCAArchiveArr.size(), static_cast<std::uint32_t>(tocLayout.PilotValueArr.size()), mDictionaryArr.size());
+
+		// The data of the dictionaries comes directly after the ToC, and the data of the
+		// files comes after that.
+		std::uint64_t totalDictionaryDataSize = 0;
 
-		// Create and write out a ToC entry for every file which will be placed into the
-		// BPK archive.
+		for (const auto& dictionary : mDictionaryArr)
+			totalDictionaryDataSize += dictionary.GetByteArray().size_bytes();
+
+		// The file data is still written in the order of mBCAArchiveArr, but the ToC entries
+		// need to be written in the order of their slot indices. So, we create all of them
+		// before writing any of them.
 		// 
 		// TODO: Should we add padding for alignment? If so, how much?
-		std::uint64_t currFileOffset = sizeof(CommonBPKFileHeader) + sizeof(VersionedBPKFileHeaderV1) + totalTOCSize;
+		std::uint64_t currFileOffset = sizeof(CommonBPKFileHeader) + sizeof(VersionedBPKFileHeaderV3) + totalTOCSize + totalDictionaryDataSize;
+		std::vector<VersionedBPKFileHeaderV3::TableOfContentsEntry> tocEntryArr(mBCAArchiveArr.size());
 
-		for (const auto& bcaArchivePtr : mBCAArchiveArr)
+		for (std::size_t i = 0; i < mBCAArchiveArr.size(); ++i)
 		{
+			const BCAArchive& bcaArchive{ *(mBCAArchiveArr[i]) };
+
 			// Change the compressed size in the ToC entry depending on whether or not the
 			// data was actually compressed.
-			const bool isDataCompressed = !(bcaArchivePtr->GetBCAInfo().DoNotCompress);
-			const std::uint64_t compressedDataSize = (isDataCompressed ? bcaArchivePtr->GetCompressedAssetFrame().GetByteArray().size_bytes() : 0);
-			
-			VersionedBPKFileHeaderV1::TableOfContentsEntry tocEntry{
-				.FileIdentifierHash{bcaArchivePtr->GetMetadata().SourceAssetDirectoryHash},
+			const bool isDataCompressed = !(bcaArchive.GetBCAInfo().DoNotCompress);
+			const std::uint64_t compressedDataSize = (isDataCompressed ? bcaArchive.GetCompressedAssetFrame().GetByteArray().size_bytes() : 0);
+
+			VersionedBPKFileHeaderV3::TableOfContentsEntry& tocEntry{ tocEntryArr[tocLayout.SlotIndexArr[i]] };
+			tocEntry = VersionedBPKFileHeaderV3::TableOfContentsEntry{
+				.FileIdentifierHash{bcaArchive.GetMetadata().SourceAssetDirectoryHash},
 				.FileOffsetInBytes{currFileOffset},
 				.CompressedSizeInBytes{compressedDataSize},
-				.UncompressedSizeInBytes{bcaArchivePtr->GetMetadata().UncompressedSizeInBytes}
+				.UncompressedSizeInBytes{bcaArchive.GetMetadata().UncompressedSizeInBytes}
 			};
-			bpkFileStream << tocEntry;
 
 			// TODO: Should we add padding for alignment? If so, how much?
 			currFileOffset += (isDataCompressed ? tocEntry.CompressedSizeInBytes : tocEntry.UncompressedSizeInBytes);
 		}
+
+		for (const auto& tocEntry : tocEntryArr)
+			bpkFileStream << tocEntry;
+
+		bpkFileStream.write(reinterpret_cast<const char*>(tocLayout.PilotValueArr.data()), (tocLayout.PilotValueArr.size() * sizeof(std::uint32_t)));
+
+		// Write out the padding after the pilot values.
+		static constexpr std::array<char, alignof(std::uint64_t)> PADDING_ARR{};
+		const std::size_t paddingSize = (GetPaddedTableOfContentsEntriesSize(tocEntryArr.size(), static_cast<std::uint32_t>(tocLayout.PilotValueArr.size())) - (sizeof(VersionedBPKFileHeaderV3::TableOfContentsEntry) * tocEntryArr.size()) - (sizeof(std::uint32_t) * tocLayout.PilotValueArr.size()));
+
+		bpkFileStream.write(PADDING_ARR.data(), paddingSize);
+
+		// Write out the compression dictionary entries. The dictionaries' data is written
+		// in the same order.
+		std::uint64_t currDictionaryOffset = sizeof(CommonBPKFileHeader) + sizeof(VersionedBPKFileHeaderV3) + totalTOCSize;
+
+		for (const auto& dictionary : mDictionaryArr)
+		{
+			const CompressionDictionaryEntryV1 dictionaryEntry{
+				.FileOffsetInBytes{ currDictionaryOffset },
+				.SizeInBytes{ static_cast<std::uint32_t>(dictionary.GetByteArray().size_bytes()) },
+				.DictionaryID{ dictionary.GetDictionaryID() }
+			};
+
+			bpkFileStream << dictionaryEntry;
+
+			currDictionaryOffset += dictionaryEntry.SizeInBytes;
+		}
 	}
 
 	BPKFactory::BPKFactory(std::vector<std::unique_ptr<BCAArchive>>&& bcaArchiveArr) :
-		mBCAArchiveArr(std::move(bcaArchiveArr))
+		mBCAArchiveArr(std::move(bcaArchiveArr)),
+		mDictionaryArr()
 	{}
 
-	void BPKFactory::CreateBPKArchive(const AssetCompilerContext& context) const
+	void BPKFactory::CreateBPKArchive(const AssetCompilerContext& context)
 	{
+		CompressDictionaryGroups();
+
 		std::filesystem::path bpkOutputPath{ context.RootOutputDirectory / L"Compiled Packages" / L"Data.bpk" };
 
 		WriteBPKFile(bpkOutputPath);
 	}
 
+	void BPKFactory::CompressDictionaryGroups()
+	{
+		// Use a std::map so that the dictionaries are always written into the BPK archive
+		// in the same order.
+		std::map<std::uint64_t, std::vector<BCAArchive*>> dictionaryGroupMap{};
+
+		for (const auto& bcaArchivePtr : mBCAArchiveArr)
+		{
+			if (bcaArchivePtr->RequiresCompressionDictionary())
+				dictionaryGroupMap[bcaArchivePtr->GetBCAInfo().CompressionDictionaryGroupHash].push_back(bcaArchivePtr.get());
+		}
+
+		if (dictionaryGroupMap.empty())
+			return;
+
+		Util::Win32::WriteFormattedConsoleMessage(std::format(L"Training ZSTD compression dictionaries for {} asset group(s)...", dictionaryGroupMap.size()));
+
+		// The BCAArchives were added to mBCAArchiveArr in whatever order the worker threads
+		// finished them in. The samples passed to ZDICT affect the contents of the dictionary,
+		// and thus whether or not existing BCA files can be re-used, so we sort them.
+		std::vector<std::vector<BCAArchive*>> dictionaryGroupArr{};
+		dictionaryGroupArr.reserve(dictionaryGroupMap.size());
+
+		for (auto& [groupHash, bcaArchivePtrArr] : dictionaryGroupMap)
+		{
+			std::ranges::sort(bcaArchivePtrArr, std::ranges::less{}, [] (const BCAArchive* const bcaArchivePtr) { return bcaArchivePtr->GetMetadata().SourceAssetDirectoryHash; });
+			dictionaryGroupArr.push_back(std::move(bcaArchivePtrArr));
+		}
+
+		std::vector<std::optional<ZSTDDictionary>> trainedDictionaryArr(dictionaryGroupArr.size());
+
+		{
+			JobGroup dictionaryTrainingGroup{};
+			dictionaryTrainingGroup.Reserve(dictionaryGroupArr.size());
+
+			for (std::size_t i = 0; i < dictionaryGroupArr.size(); ++i)
+			{
+				dictionaryTrainingGroup.AddJob([&dictionaryGroupArr, &trainedDictionaryArr, i] ()
+				{
+					std::vector<std::span<const std::uint8_t>> assetDataSpanArr{};
+					assetDataSpanArr.reserve(dictionaryGroupArr[i].size());
+
+					for (const auto bcaArchivePtr : dictionaryGroupArr[i])
+						assetDataSpanArr.push_back(bcaArchivePtr->GetUncompressedAssetData());
+
+					trainedDictionaryArr[i] = ZSTDDictionary::TrainDictionary(assetDataSpanArr);
+				});
+			}
+
+			dictionaryTrainingGroup.ExecuteJobs();
+		}
+
+		// The engine finds the dictionary for an asset by the ID which ZSTD writes into its
+		// frame headers, so two dictionaries with the same ID cannot be told apart. The IDs
+		// are derived from the dictionaries' contents, so this is extremely unlikely.
+		for (const auto& dictionary : trainedDictionaryArr)
+		{
+			if (!dictionary.has_value())
+				continue;
+
+			for (const auto& otherDictionary : trainedDictionaryArr)
+			{
+				if (std::addressof(dictionary) != std::addressof(otherDictionary) && otherDictionary.has_value() && dictionary->GetDictionaryID() == otherDictionary->GetDictionaryID()) [[unlikely]]
+					throw std::runtime_error{ "ERROR: Two ZSTD compression dictionaries were assigned the same dictionary ID! (Try adding or removing an asset from one of the compression dictionary groups.)" };
+			}
+		}
+
+		// Now, compress every asset of every group. This is done in a single JobGroup so
+		// that small groups do not leave any threads idle.
+		{
+			std::size_t totalAssetCount = 0;
+
+			for (const auto& bcaArchivePtrArr : dictionaryGroupArr)
+				totalAssetCount += bcaArchivePtrArr.size();
+
+			JobGroup compressionGroup{};
+			compressionGroup.Reserve(totalAssetCount);
+
+			for (std::size_t i = 0; i < dictionaryGroupArr.size(); ++i)
+			{
+				const ZSTDDictionary* const dictionaryPtr = (trainedDictionaryArr[i].has_value() ? std::addressof(*(trainedDictionaryArr[i])) : nullptr);
+
+				for (const auto bcaArchivePtr : dictionaryGroupArr[i])
+					compressionGroup.AddJob([bcaArchivePtr, dictionaryPtr] () { bcaArchivePtr->InitializeArchiveDataWithDictionary(dictionaryPtr); });
+			}
+
+			compressionGroup.ExecuteJobs();
+		}
+
+		for (auto& dictionary : trainedDictionaryArr)
+		{
+			if (dictionary.has_value())
+				mDictionaryArr.push_back(std::move(*dictionary));
+		}
+	}
+
 	void BPKFactory::WriteBPKFile(const std::filesystem::path& bpkOutputPath) const
 	{
 		std::ofstream bpkFileStream{ bpkOutputPath, std::ios_base::out | std::ios_base::binary };
@@ -171,14 +561,21 @@ namespace Brawler
 			bpkFileStream << commonHeader;
 		}
 
+		const BPKTableOfContentsLayout tocLayout{ CreateTableOfContentsLayout() };
+
 		// Write out the current versioned BPK file header.
 		{
-			CurrentVersionedBPKFileHeader versionedHeader{ CreateVersionedBPKFileHeader<CurrentVersionedBPKFileHeader>() };
+			CurrentVersionedBPKFileHeader versionedHeader{ CreateVersionedBPKFileHeader<CurrentVersionedBPKFileHeader>(tocLayout) };
 			bpkFileStream << versionedHeader;
 		}
 
 		// Write out the Table of Contents (ToC).
-		WriteTableOfContents<CurrentVersionedBPKFileHeader>(bpkFileStream);
+		WriteTableOfContents<CurrentVersionedBPKFileHeader>(bpkFileStream, tocLayout);
+
+		// Write out the data of the compression dictionaries. The engine loads all of these
+		// when it opens the BPK archive.
+		for (const auto& dictionary : mDictionaryArr)
+			bpkFileStream.write(reinterpret_cast<const char*>(dictionary.GetByteArray().data()), dictionary.GetByteArray().size_bytes());
 
 		// Write out the compressed file archives.
 		for (const auto& bcaArchivePtr : mBCAArchiveArr)
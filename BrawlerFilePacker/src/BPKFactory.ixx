@@ -6,12 +6,18 @@ module;
 
 export module Brawler.BPKFactory;
 import Brawler.BCAArchive;
+import Brawler.ZSTDDictionary;
 
 export namespace Brawler
 {
 	struct AssetCompilerContext;
 }
 
+namespace Brawler
+{
+	struct BPKTableOfContentsLayout;
+}
+
 export namespace Brawler
 {
 	class BPKFactory
@@ -19,18 +25,33 @@ export namespace Brawler
 	public:
 		explicit BPKFactory(std::vector<std::unique_ptr<BCAArchive>>&& bcaArchiveArr);
 
-		void CreateBPKArchive(const AssetCompilerContext& context) const;
+		void CreateBPKArchive(const AssetCompilerContext& context);
 
 	private:
+		/// <summary>
+		/// Trains a ZSTD dictionary for every compression dictionary group (see
+		/// BCAInfo::CompressionDictionaryGroupHash) and then compresses the assets of each
+		/// group with its dictionary. The dictionaries are stored in mDictionaryArr, since
+		/// they need to be written into the BPK archive.
+		/// </summary>
+		void CompressDictionaryGroups();
+
 		void WriteBPKFile(const std::filesystem::path& bpkOutputPath) const;
 
+		/// <summary>
+		/// Decides where the ToC entry of every BCA archive is placed within the ToC. See
+		/// Brawler.BPKTableOfContentsHash for the details.
+		/// </summary>
+		BPKTableOfContentsLayout CreateTableOfContentsLayout() const;
+
 		template <typename VersionedBPKFileHeader>
-		VersionedBPKFileHeader CreateVersionedBPKFileHeader() const;
+		VersionedBPKFileHeader CreateVersionedBPKFileHeader(const BPKTableOfContentsLayout& tocLayout) const;
 
 		template <typename VersionedBPKFileHeader>
-		void WriteTableOfContents(std::ofstream& bpkFileStream) const;
+		void WriteTableOfContents(std::ofstream& bpkFileStream, const BPKTableOfContentsLayout& tocLayout) const;
 
 	private:
 		std::vector<std::unique_ptr<BCAArchive>> mBCAArchiveArr;
+		std::vector<ZSTDDictionary> mDictionaryArr;
 	};
 }
\ No newline at end of file
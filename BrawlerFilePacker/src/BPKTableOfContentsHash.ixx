@@ -0,0 +1,113 @@
+module;
+#include <cstdint>
+#include <algorithm>
+
+export module Brawler.BPKTableOfContentsHash;
+
+// Starting with version 2, the table of contents (ToC) of a BPK archive is laid out as a minimal
+// perfect hash table, so that it can be used directly from a memory-mapped view of the archive.
+// The BPKFactory of the FilePacker decides where every entry goes, and the BPKArchiveReader of
+// the engine needs to find it there again. Both of them use the functions in this module; the
+// FilePacker and the engine each have a copy of it, and these copies *MUST* be kept identical.
+//
+// The scheme is based on PTHash (Pibiri and Trani, 2021). Every key is first assigned to a
+// bucket. The FilePacker then searches, bucket by bucket, for a "pilot" value which moves all of
+// the keys in that bucket to free slots, and it writes these pilot values into the archive. A
+// lookup thus consists of hashing the key, reading one pilot value, and hashing again, without
+// any branches or probing.
+
+export namespace Brawler
+{
+	namespace BPKTableOfContentsHash
+	{
+		/// <summary>
+		/// This is the average number of keys per bucket. Larger buckets mean fewer pilot
+		/// values to store, but they make it harder for the FilePacker to find pilot values
+		/// for the last few buckets.
+		/// </summary>
+		constexpr std::uint32_t AVERAGE_BUCKET_SIZE = 3;
+
+		/// <summary>
+		/// Mixes the bits of value. This is the finalizer of SplitMix64.
+		/// </summary>
+		constexpr std::uint64_t MixHash(std::uint64_t value);
+
+		/// <summary>
+		/// Maps value to the range [0, rangeSize) without a division (Lemire, 2016).
+		/// </summary>
+		constexpr std::uint32_t FastRange(const std::uint32_t value, const std::uint32_t rangeSize);
+
+		constexpr std::uint32_t GetBucketCount(const std::uint32_t entryCount);
+
+		/// <summary>
+		/// Gets the hash from which both the bucket index and the slot index of a key are
+		/// derived.
+		/// </summary>
+		/// <param name="fileIdentifierHash">
+		/// - The FilePathHash of the file, as stored in its ToC entry.
+		/// </param>
+		/// <param name="hashSeed">
+		/// - The seed which the FilePacker chose for the BPK archive.
+		/// </param>
+		constexpr std::uint64_t GetKeyHash(const std::uint64_t fileIdentifierHash, const std::uint64_t hashSeed);
+
+		constexpr std::uint32_t GetBucketIndex(const std::uint64_t keyHash, const std::uint32_t bucketCount);
+		constexpr std::uint32_t GetSlotIndex(const std::uint64_t keyHash, const std::uint32_t pilotValue, const std::uint32_t entryCount);
+	}
+}
+
+// -----------------------------------------------------------------------------------------------
+
+namespace Brawler
+{
+	namespace BPKTableOfContentsHash
+	{
+		constexpr std::uint64_t MixHash(std::uint64_t value)
+		{
+			value ^= (value >> 30);
+			value *= 0xBF58476D1CE4E5B9;
+			value ^= (value >> 27);
+			value *= 0x94D049BB133111EB;
+			value ^= (value >> 31);
+
+			return value;
+		}
+
+		constexpr std::uint32_t FastRange(const std::uint32_t value, const std::uint32_t rangeSize)
+		{
+			return static_cast<std::uint32_t>((static_cast<std::uint64_t>(value) * rangeSize) >> 32);
+		}
+
+		constexpr std::uint32_t GetBucketCount(const std::uint32_t entryCount)
+		{
+			// We always have at least one bucket, even if the BPK archive is empty.
+			return ((entryCount / AVERAGE_BUCKET_SIZE) + 1);
+		}
+
+		constexpr std::uint64_t GetKeyHash(const std::uint64_t fileIdentifierHash, const std::uint64_t hashSeed)
+		{
+			return MixHash(fileIdentifierHash ^ hashSeed);
+		}
+
+		constexpr std::uint32_t GetBucketIndex(const std::uint64_t keyHash, const std::uint32_t bucketCount)
+		{
+			// PTHash assigns 60% of the keys to the first 30% of the buckets. The FilePacker
+			// handles the largest buckets first, while most slots are still free, which makes
+			// finding pilot values for the remaining (small) buckets much easier.
+			constexpr std::uint32_t DENSE_KEY_THRESHOLD = static_cast<std::uint32_t>(0.6 * 4294967296.0);
+
+			const std::uint32_t denseBucketCount = std::max<std::uint32_t>(((bucketCount * 3) / 10), 1);
+			const bool isDenseKey = (static_cast<std::uint32_t>(keyHash >> 32) < DENSE_KEY_THRESHOLD || denseBucketCount == bucketCount);
+
+			const std::uint32_t bucketRangeStart = (isDenseKey ? 0 : denseBucketCount);
+			const std::uint32_t bucketRangeSize = (isDenseKey ? denseBucketCount : (bucketCount - denseBucketCount));
+
+			return (bucketRangeStart + FastRange(static_cast<std::uint32_t>(keyHash), bucketRangeSize));
+		}
+
+		constexpr std::uint32_t GetSlotIndex(const std::uint64_t keyHash, const std::uint32_t pilotValue, const std::uint32_t entryCount)
+		{
+			return FastRange(static_cast<std::uint32_t>(MixHash(keyHash ^ MixHash(pilotValue)) >> 32), entryCount);
+		}
+	}
+}
\ No newline at end of file
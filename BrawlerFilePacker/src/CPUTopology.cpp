@@ -0,0 +1,277 @@
+module;
+#include <cstdint>
+#include <cassert>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <tuple>
+#include <thread>
+
+#include "Win32Def.h"
+#include <comdef.h>
+
+module Brawler.CPUTopology;
+import Util.General;
+
+namespace
+{
+	std::vector<Brawler::LogicalProcessorInfo> QueryLogicalProcessors()
+	{
+		DWORD infoBufferSize = 0;
+
+		if (!GetLogicalProcessorInformationEx(RelationAll, nullptr, &infoBufferSize) && GetLastError() != ERROR_INSUFFICIENT_BUFFER) [[unlikely]]
+			CheckHRESULT(HRESULT_FROM_WIN32(GetLastError()));
+
+		std::vector<std::byte> infoBuffer{};
+		infoBuffer.resize(infoBufferSize);
+
+		if (!GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(infoBuffer.data()), &infoBufferSize)) [[unlikely]]
+			CheckHRESULT(HRESULT_FROM_WIN32(GetLastError()));
+
+		struct NUMANodeAffinity
+		{
+			GROUP_AFFINITY Affinity;
+			std::uint32_t NodeNumber;
+		};
+
+		std::vector<Brawler::LogicalProcessorInfo> logicalProcessorArr{};
+		std::vector<NUMANodeAffinity> nodeAffinityArr{};
+		std::uint32_t currCoreIndex = 0;
+
+		// The records returned by GetLogicalProcessorInformationEx() have variable sizes, so we
+		// need to use the Size field of each record to find the next one.
+		for (std::size_t currOffset = 0; currOffset < infoBufferSize;)
+		{
+			const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& currInfo{ *reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(infoBuffer.data() + currOffset) };
+
+			switch (currInfo.Relationship)
+			{
+			case RelationProcessorCore:
+			{
+				// Every set bit in the group masks of a processor core record is one of the logical
+				// processors of that core.
+				std::uint32_t currSMTSiblingIndex = 0;
+
+				for (WORD i = 0; i < currInfo.Processor.GroupCount; ++i)
+				{
+					const GROUP_AFFINITY& currGroupAffinity{ currInfo.Processor.GroupMask[i] };
+
+					for (std::uint32_t j = 0; j < (sizeof(KAFFINITY) * 8); ++j)
+					{
+						if ((currGroupAffinity.Mask & (static_cast<KAFFINITY>(1) << j)) == 0)
+							continue;
+
+						logicalProcessorArr.push_back(Brawler::LogicalProcessorInfo{
+							.ProcessorGroup = currGroupAffinity.Group,
+							.ProcessorNumber = j,
+							.PhysicalCoreIndex = currCoreIndex,
+							.NUMANodeIndex = 0,
+							.SMTSiblingIndex = currSMTSiblingIndex++
+						});
+					}
+				}
+
+				++currCoreIndex;
+				break;
+			}
+
+			case RelationNumaNode:
+			{
+				// A NUMA node can span several processor groups on systems with more than 64
+				// logical processors, in which case there is one GROUP_AFFINITY per group in
+				// GroupMasks. Older versions of Windows leave GroupCount at zero and only ever
+				// report a single group in GroupMask (which aliases GroupMasks[0]).
+				const WORD groupCount = std::max<WORD>(currInfo.NumaNode.GroupCount, 1);
+
+				for (WORD i = 0; i < groupCount; ++i)
+				{
+					nodeAffinityArr.push_back(NUMANodeAffinity{
+						.Affinity{ currInfo.NumaNode.GroupMasks[i] },
+						.NodeNumber = currInfo.NumaNode.NodeNumber
+					});
+				}
+
+				break;
+			}
+
+			default:
+				break;
+			}
+
+			currOffset += currInfo.Size;
+		}
+
+		for (auto& logicalProcessorInfo : logicalProcessorArr)
+		{
+			for (const auto& nodeAffinity : nodeAffinityArr)
+			{
+				if (nodeAffinity.Affinity.Group == logicalProcessorInfo.ProcessorGroup && (nodeAffinity.Affinity.Mask & (static_cast<KAFFINITY>(1) << logicalProcessorInfo.ProcessorNumber)) != 0)
+				{
+					logicalProcessorInfo.NUMANodeIndex = nodeAffinity.NodeNumber;
+					break;
+				}
+			}
+		}
+
+		return logicalProcessorArr;
+	}
+
+	std::vector<Brawler::LogicalProcessorInfo> CreateFallbackLogicalProcessors()
+	{
+		const std::uint32_t logicalProcessorCount = std::max<std::uint32_t>(std::thread::hardware_concurrency(), 1);
+
+		std::vector<Brawler::LogicalProcessorInfo> logicalProcessorArr{};
+		logicalProcessorArr.reserve(logicalProcessorCount);
+
+		for (std::uint32_t i = 0; i < logicalProcessorCount; ++i)
+		{
+			// Windows puts at most 64 logical processors into each processor group.
+			static constexpr std::uint32_t MAX_PROCESSORS_PER_GROUP = (sizeof(KAFFINITY) * 8);
+
+			const std::uint16_t processorGroup = static_cast<std::uint16_t>(i / MAX_PROCESSORS_PER_GROUP);
+			const std::uint32_t processorNumber = (i % MAX_PROCESSORS_PER_GROUP);
+
+			logicalProcessorArr.push_back(Brawler::LogicalProcessorInfo{
+				.ProcessorGroup = processorGroup,
+				.ProcessorNumber = processorNumber,
+				.PhysicalCoreIndex = i,
+				.NUMANodeIndex = 0,
+				.SMTSiblingIndex = 0
+			});
+		}
+
+		return logicalProcessorArr;
+	}
+}
+
+namespace Brawler
+{
+	CPUTopology CPUTopology::QuerySystemTopology()
+	{
+		CPUTopology topology{};
+		topology.mLogicalProcessorArr = QueryLogicalProcessors();
+
+		if (topology.mLogicalProcessorArr.empty()) [[unlikely]]
+			topology.mLogicalProcessorArr = CreateFallbackLogicalProcessors();
+
+		topology.FinalizeTopology();
+
+		return topology;
+	}
+
+	std::span<const LogicalProcessorInfo> CPUTopology::GetLogicalProcessors() const
+	{
+		return std::span<const LogicalProcessorInfo>{ mLogicalProcessorArr };
+	}
+
+	std::uint32_t CPUTopology::GetPhysicalCoreCount() const
+	{
+		return mPhysicalCoreCount;
+	}
+
+	std::uint32_t CPUTopology::GetNUMANodeCount() const
+	{
+		return mNUMANodeCount;
+	}
+
+	std::vector<LogicalProcessorInfo> CPUTopology::CreateThreadPlacement(const ThreadPlacementPolicy policy, const std::size_t threadCount) const
+	{
+		// FinalizeTopology() numbers the physical cores node by node, so the cores of each node
+		// have contiguous indices. We need the index of each core *within* its node in order to
+		// interleave the nodes.
+		std::vector<std::uint32_t> firstCoreIndexArr(mNUMANodeCount, mPhysicalCoreCount);
+
+		for (const auto& logicalProcessorInfo : mLogicalProcessorArr)
+			firstCoreIndexArr[logicalProcessorInfo.NUMANodeIndex] = std::min(firstCoreIndexArr[logicalProcessorInfo.NUMANodeIndex], logicalProcessorInfo.PhysicalCoreIndex);
+
+		const auto getCoreIndexWithinNode = [&firstCoreIndexArr] (const LogicalProcessorInfo& logicalProcessorInfo)
+		{
+			return (logicalProcessorInfo.PhysicalCoreIndex - firstCoreIndexArr[logicalProcessorInfo.NUMANodeIndex]);
+		};
+
+		std::vector<LogicalProcessorInfo> orderedProcessorArr{ mLogicalProcessorArr };
+
+		switch (policy)
+		{
+		case ThreadPlacementPolicy::PHYSICAL_CORES_FIRST:
+		{
+			std::ranges::stable_sort(orderedProcessorArr, [&getCoreIndexWithinNode] (const LogicalProcessorInfo& lhs, const LogicalProcessorInfo& rhs)
+			{
+				return (std::make_tuple(lhs.SMTSiblingIndex, getCoreIndexWithinNode(lhs), lhs.NUMANodeIndex) < std::make_tuple(rhs.SMTSiblingIndex, getCoreIndexWithinNode(rhs), rhs.NUMANodeIndex));
+			});
+
+			break;
+		}
+
+		case ThreadPlacementPolicy::NUMA_LOCAL:
+		{
+			std::ranges::stable_sort(orderedProcessorArr, [&getCoreIndexWithinNode] (const LogicalProcessorInfo& lhs, const LogicalProcessorInfo& rhs)
+			{
+				return (std::make_tuple(lhs.NUMANodeIndex, lhs.SMTSiblingIndex, getCoreIndexWithinNode(lhs)) < std::make_tuple(rhs.NUMANodeIndex, rhs.SMTSiblingIndex, getCoreIndexWithinNode(rhs)));
+			});
+
+			break;
+		}
+
+		case ThreadPlacementPolicy::COMPACT:
+		{
+			// mLogicalProcessorArr is already sorted this way.
+			break;
+		}
+
+		default:
+		{
+			assert(false && "ERROR: An invalid ThreadPlacementPolicy was specified in a call to CPUTopology::CreateThreadPlacement()!");
+			break;
+		}
+		}
+
+		std::vector<LogicalProcessorInfo> threadPlacementArr{};
+		threadPlacementArr.reserve(threadCount);
+
+		for (std::size_t i = 0; i < threadCount; ++i)
+			threadPlacementArr.push_back(orderedProcessorArr[i % orderedProcessorArr.size()]);
+
+		return threadPlacementArr;
+	}
+
+	void CPUTopology::FinalizeTopology()
+	{
+		// The OS is free to number its NUMA nodes and cores however it likes, so we compact
+		// the indices into the ranges [0, mNUMANodeCount) and [0, mPhysicalCoreCount).
+		std::vector<std::uint32_t> nodeNumberArr{};
+
+		for (const auto& logicalProcessorInfo : mLogicalProcessorArr)
+			nodeNumberArr.push_back(logicalProcessorInfo.NUMANodeIndex);
+
+		std::ranges::sort(nodeNumberArr);
+		nodeNumberArr.erase(std::unique(nodeNumberArr.begin(), nodeNumberArr.end()), nodeNumberArr.end());
+
+		for (auto& logicalProcessorInfo : mLogicalProcessorArr)
+			logicalProcessorInfo.NUMANodeIndex = static_cast<std::uint32_t>(std::ranges::lower_bound(nodeNumberArr, logicalProcessorInfo.NUMANodeIndex) - nodeNumberArr.begin());
+
+		std::ranges::sort(mLogicalProcessorArr, [] (const LogicalProcessorInfo& lhs, const LogicalProcessorInfo& rhs)
+		{
+			return (std::make_tuple(lhs.NUMANodeIndex, lhs.PhysicalCoreIndex, lhs.SMTSiblingIndex) < std::make_tuple(rhs.NUMANodeIndex, rhs.PhysicalCoreIndex, rhs.SMTSiblingIndex));
+		});
+
+		// Now that the logical processors are sorted, the logical processors of each core are
+		// adjacent, and the cores of each node are adjacent, too.
+		std::uint32_t currCoreIndex = 0;
+		std::uint32_t prevSparseCoreIndex = 0;
+
+		for (std::size_t i = 0; i < mLogicalProcessorArr.size(); ++i)
+		{
+			const std::uint32_t currSparseCoreIndex = mLogicalProcessorArr[i].PhysicalCoreIndex;
+
+			if (i > 0 && currSparseCoreIndex != prevSparseCoreIndex)
+				++currCoreIndex;
+
+			mLogicalProcessorArr[i].PhysicalCoreIndex = currCoreIndex;
+			prevSparseCoreIndex = currSparseCoreIndex;
+		}
+
+		mPhysicalCoreCount = (mLogicalProcessorArr.empty() ? 0 : (currCoreIndex + 1));
+		mNUMANodeCount = static_cast<std::uint32_t>(nodeNumberArr.size());
+	}
+}
\ No newline at end of file
@@ -15,8 +15,23 @@ export namespace Brawler
 {
 	namespace PackerSettings
 	{
-		constexpr std::uint32_t TARGET_BCA_VERSION = 1;
-		constexpr std::uint32_t TARGET_BPK_VERSION = 1;
+		// Version 2 of the BCA format stores the asset data as a seekable ZSTD stream; see
+		// ZSTDContext::CompressData() for details. BCA files of version 1 contain a single
+		// monolithic frame, so they are simply re-compressed. Version 3 adds the ID of the
+		// dictionary which the asset was compressed with, if any, to the versioned header.
+		constexpr std::uint32_t TARGET_BCA_VERSION = 3;
+
+		// Version 3 of the BPK format stores the ZSTD dictionaries which its assets were
+		// compressed with; see VersionedBPKFileHeaderV3 in BPKFactory.cpp.
+		constexpr std::uint32_t TARGET_BPK_VERSION = 3;
+
+		/// <summary>
+		/// This is the amount of uncompressed data which is stored in each independent ZSTD
+		/// frame of a compressed asset. Smaller chunks allow for more parallelism and finer
+		/// partial reads at the cost of a lower compression ratio. 256KB matches the size
+		/// of the registered buffers used for io_uring reads at runtime.
+		/// </summary>
+		constexpr std::uint32_t ZSTD_CHUNK_SIZE_IN_BYTES = (1 << 18);
 
 		enum class BuildMode : std::uint8_t
 		{
@@ -1,5 +1,5 @@
 module;
-#include <mutex>
+#include <thread>
 
 #pragma warning(push)
 #pragma warning(disable: 5105)
@@ -9,51 +9,17 @@ module;
 module Util.Threading;
 import Brawler.Application;
 import Brawler.WorkerThreadPool;
-
-namespace
-{
-	struct ThreadAffinityInfo
-	{
-		KAFFINITY CurrentMask;
-		WORD CurrentProcessorGroup;
-
-		ThreadAffinityInfo() :
-			CurrentMask(1),
-			CurrentProcessorGroup(0)
-		{}
-	};
-}
+import Brawler.CPUTopology;
 
 namespace Util
 {
 	namespace Threading
 	{
-		void LockCurrentThreadToUnassignedCore()
+		void LockCurrentThreadToLogicalProcessor(const Brawler::LogicalProcessorInfo& logicalProcessorInfo)
 		{
-			static std::mutex currAffinityCritSection{};
-			static ThreadAffinityInfo currAffinityInfo{};
-
-			ThreadAffinityInfo unassignedInfo{};
-
-			{
-				std::scoped_lock<std::mutex> lk{ currAffinityCritSection };
-
-				unassignedInfo = currAffinityInfo;
-
-				currAffinityInfo.CurrentMask <<= 1;
-
-				// If we have shifted left too many times, then there are no more free cores in the
-				// current processor group.
-				if (!currAffinityInfo.CurrentMask)
-				{
-					++currAffinityInfo.CurrentProcessorGroup;
-					currAffinityInfo.CurrentMask = 1;
-				}
-			}
-
 			GROUP_AFFINITY groupAffinity{};
-			groupAffinity.Group = unassignedInfo.CurrentProcessorGroup;
-			groupAffinity.Mask = unassignedInfo.CurrentMask;
+			groupAffinity.Group = logicalProcessorInfo.ProcessorGroup;
+			groupAffinity.Mask = (static_cast<KAFFINITY>(1) << logicalProcessorInfo.ProcessorNumber);
 
 			SetThreadGroupAffinity(GetCurrentThread(), &groupAffinity, nullptr);
 		}
@@ -11,9 +11,10 @@ import Util.Coroutine;
 
 namespace Brawler
 {
-	WorkerThread::WorkerThread(WorkerThreadPool& threadPool) :
+	WorkerThread::WorkerThread(WorkerThreadPool& threadPool, const std::uint32_t threadIndex) :
 		mThread(),
 		mPool(&threadPool),
+		mThreadIndex(threadIndex),
 		mResources(),
 		mKeepGoing(true)
 	{
@@ -76,7 +77,7 @@ namespace Brawler
 
 	void WorkerThread::Initialize()
 	{
-		Util::Threading::LockCurrentThreadToUnassignedCore();
+		Util::Threading::LockCurrentThreadToLogicalProcessor(mPool->GetThreadPlacement(mThreadIndex));
 	}
 
 	void WorkerThread::ExecuteMainLoop()
@@ -1,6 +1,7 @@
 module;
 #include <thread>
 #include <atomic>
+#include <cstdint>
 
 export module Brawler.WorkerThread;
 import Brawler.Job;
@@ -17,7 +18,7 @@ export namespace Brawler
 		friend ThreadLocalResources& Util::Threading::GetThreadLocalResources();
 
 	public:
-		explicit WorkerThread(WorkerThreadPool& threadPool);
+		WorkerThread(WorkerThreadPool& threadPool, const std::uint32_t threadIndex);
 
 		WorkerThread(const WorkerThread& rhs) = delete;
 		WorkerThread& operator=(const WorkerThread& rhs) = delete;
@@ -38,6 +39,7 @@ export namespace Brawler
 	private:
 		std::thread mThread;
 		WorkerThreadPool* mPool;
+		std::uint32_t mThreadIndex;
 		ThreadLocalResources mResources;
 		std::atomic<bool> mKeepGoing;
 	};
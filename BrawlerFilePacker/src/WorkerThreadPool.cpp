@@ -11,10 +11,12 @@ import Util.Threading;
 import Brawler.Application;
 import Brawler.WorkerThread;
 import Brawler.ThreadSafeQueue;
+import Brawler.CPUTopology;
 
 namespace Brawler
 {
-	WorkerThreadPool::WorkerThreadPool(std::uint32_t numWorkerThreads) :
+	WorkerThreadPool::WorkerThreadPool(std::uint32_t numWorkerThreads, const ThreadPlacementPolicy placementPolicy) :
+		mThreadPlacementArr(CPUTopology::QuerySystemTopology().CreateThreadPlacement(placementPolicy, static_cast<std::size_t>(numWorkerThreads) + 1)),
 		mThreadArr(),
 		mThreadMap(),
 		mMainThreadInfo(std::this_thread::get_id()),
@@ -24,13 +26,15 @@ namespace Brawler
 		mThreadArr.reserve(numWorkerThreads);
 
 		// First, lock the main thread to its own CPU core.
-		Util::Threading::LockCurrentThreadToUnassignedCore();
+		Util::Threading::LockCurrentThreadToLogicalProcessor(mThreadPlacementArr[0]);
 
-		// Now, we can create the other worker threads. They will each be atomically assigned
-		// their own core automatically.
+		// Now, we can create the other worker threads. Each one locks itself to the logical
+		// processor chosen for its thread index.
 		for (std::uint32_t i = 0; i < numWorkerThreads; ++i)
 		{
-			mThreadArr.push_back(std::make_unique<Brawler::WorkerThread>(*this));
+			// We start counting the thread indices here from 1 because index 0 is reserved for
+			// the main thread.
+			mThreadArr.push_back(std::make_unique<Brawler::WorkerThread>(*this, (i + 1)));
 			mThreadMap[mThreadArr[i]->GetThreadID()] = mThreadArr[i].get();
 		}
 	}
@@ -78,6 +82,12 @@ namespace Brawler
 		return mThreadArr.size();
 	}
 
+	const LogicalProcessorInfo& WorkerThreadPool::GetThreadPlacement(const std::uint32_t threadIndex) const
+	{
+		assert(threadIndex < mThreadPlacementArr.size());
+		return mThreadPlacementArr[threadIndex];
+	}
+
 	std::optional<Job> WorkerThreadPool::AcquireQueuedJob()
 	{
 		// First, try to steal jobs from our own queue, if applicable. If we are on
@@ -4,6 +4,7 @@ module;
 #include <exception>
 #include <thread>
 #include <unordered_map>
+#include <cstdint>
 
 export module Brawler.WorkerThreadPool;
 import Brawler.WorkerThread;
@@ -11,6 +12,7 @@ import Brawler.Job;
 import Brawler.ThreadLocalResources;
 import Util.Threading;
 import Brawler.ThreadSafeQueue;
+import Brawler.CPUTopology;
 
 namespace
 {
@@ -38,7 +40,10 @@ export namespace Brawler
 		friend ThreadLocalResources& Util::Threading::GetThreadLocalResources();
 
 	public:
-		explicit WorkerThreadPool(std::uint32_t numWorkerThreads = (std::thread::hardware_concurrency() - 1));
+		explicit WorkerThreadPool(
+			std::uint32_t numWorkerThreads = (std::thread::hardware_concurrency() - 1),
+			const ThreadPlacementPolicy placementPolicy = ThreadPlacementPolicy::PHYSICAL_CORES_FIRST
+		);
 		~WorkerThreadPool();
 
 		WorkerThreadPool(const WorkerThreadPool& rhs) = delete;
@@ -57,6 +62,12 @@ export namespace Brawler
 		// Returns the number of worker threads in the pool.
 		std::size_t GetWorkerThreadCount() const;
 
+		/// <summary>
+		/// Gets the logical processor which the thread with the specified thread index is
+		/// locked to. Thread index 0 refers to the main thread.
+		/// </summary>
+		const LogicalProcessorInfo& GetThreadPlacement(const std::uint32_t threadIndex) const;
+
 		// If the current thread is a worker thread, then this function first tries to pull
 		// a job from its own queue. If that fails, or if the current thread is the main
 		// thread, then we attempt to steal jobs from other worker threads.
@@ -75,6 +86,7 @@ export namespace Brawler
 		const WorkerThread* GetWorkerThread(std::thread::id threadID) const;
 
 	private:
+		std::vector<LogicalProcessorInfo> mThreadPlacementArr;
 		std::vector<std::unique_ptr<WorkerThread>> mThreadArr;
 		std::unordered_map<std::thread::id, WorkerThread*> mThreadMap;
 		MainThreadInfo mMainThreadInfo;
@@ -1,12 +1,55 @@
 module;
 #include <span>
 #include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <bit>
+#include <type_traits>
 #include <zstd.h>
 
 module Brawler.ZSTDContext;
 import Brawler.ZSTDFrame;
+import Brawler.ZSTDDictionary;
+import Brawler.PackerSettings;
 import Util.Engine;
 
+namespace
+{
+	// Compressed assets begin with a seek table, which is stored within a ZSTD skippable frame.
+	// Decoders which know nothing about it simply skip over it, so the data remains a valid
+	// ZSTD stream. The layout of this frame must match what Brawler.AssetManagement.ZSTDSeekTable
+	// expects at runtime:
+	//
+	//   - std::uint32_t SkippableFrameMagic (SEEK_TABLE_SKIPPABLE_FRAME_MAGIC)
+	//   - std::uint32_t PayloadSizeInBytes
+	//   - std::uint32_t SeekTableMagic (SEEK_TABLE_MAGIC)
+	//   - std::uint32_t UncompressedChunkSizeInBytes
+	//   - std::uint64_t UncompressedSizeInBytes
+	//   - std::uint64_t ChunkEndOffsetArr[ChunkCount]
+	//
+	// Each entry of ChunkEndOffsetArr is the offset, relative to the end of the skippable frame,
+	// of the end of the corresponding chunk's frame. ChunkCount is UncompressedSizeInBytes divided
+	// by UncompressedChunkSizeInBytes, rounded up. All of the values are little-endian.
+	static constexpr std::uint32_t SEEK_TABLE_SKIPPABLE_FRAME_MAGIC = (ZSTD_MAGIC_SKIPPABLE_START | 0xB);
+	static constexpr std::uint32_t SEEK_TABLE_MAGIC = 0x4B535A42;  // "BZSK"
+
+	static constexpr std::size_t SKIPPABLE_FRAME_HEADER_SIZE = (sizeof(std::uint32_t) * 2);
+	static constexpr std::size_t SEEK_TABLE_PAYLOAD_HEADER_SIZE = ((sizeof(std::uint32_t) * 2) + sizeof(std::uint64_t));
+
+	template <typename T>
+		requires std::is_integral_v<T>
+	void AppendLittleEndianValue(std::vector<std::uint8_t>& byteArr, const T value)
+	{
+		static_assert(std::endian::native == std::endian::little, "ERROR: The seek table of compressed assets is written assuming a little-endian host!");
+
+		const std::size_t writeOffset = byteArr.size();
+		byteArr.resize(writeOffset + sizeof(T));
+
+		std::memcpy(byteArr.data() + writeOffset, &value, sizeof(T));
+	}
+}
+
 namespace Brawler
 {
 	ZSTDContext::ZSTDContext() :
@@ -36,30 +79,84 @@ namespace Brawler
 
 	ZSTDFrame ZSTDContext::CompressData(const std::span<std::uint8_t> byteArr) const
 	{
-		const std::size_t frameSize = ZSTD_compressBound(byteArr.size_bytes());
-		std::vector<std::uint8_t> frameByteArr{};
-		frameByteArr.resize(frameSize);
-
-		std::size_t compressionResult = ZSTD_compressCCtx(
-			mCompressionContextPtr,
-			frameByteArr.data(),
-			frameByteArr.size(),
-			byteArr.data(),
-			byteArr.size_bytes(),
-			Util::Engine::GetZSTDCompressionLevel()
-		);
-
-		if (ZSTD_isError(compressionResult)) [[unlikely]]
-			throw std::runtime_error{ std::string{ "ERROR: ZSTD failed to compress a frame with the following error: " } + std::string{ ZSTD_getErrorName(compressionResult) } };
-
-		// ZSTD_compressBound() is an upper-bound on the memory required. Usually, we don't
-		// need that much memory.
-		if (compressionResult < frameByteArr.size()) [[likely]]
+		return CompressDataIMPL(byteArr, nullptr);
+	}
+
+	ZSTDFrame ZSTDContext::CompressData(const std::span<std::uint8_t> byteArr, const ZSTDDictionary& dictionary) const
+	{
+		return CompressDataIMPL(byteArr, dictionary.GetCompressionDictionary());
+	}
+
+	ZSTDFrame ZSTDContext::CompressDataIMPL(const std::span<std::uint8_t> byteArr, const ZSTD_CDict* const compressionDictionaryPtr) const
+	{
+		static constexpr std::size_t CHUNK_SIZE_IN_BYTES = PackerSettings::ZSTD_CHUNK_SIZE_IN_BYTES;
+		const std::size_t numChunks = ((byteArr.size_bytes() + (CHUNK_SIZE_IN_BYTES - 1)) / CHUNK_SIZE_IN_BYTES);
+
+		// Every chunk is compressed into its own independent frame. We compress all of them
+		// first so that we know where each one ends before writing out the seek table.
+		std::vector<std::uint8_t> chunkByteArr{};
+		chunkByteArr.reserve(ZSTD_compressBound(byteArr.size_bytes()));
+
+		std::vector<std::uint64_t> chunkEndOffsetArr{};
+		chunkEndOffsetArr.reserve(numChunks);
+
+		std::span<const std::uint8_t> remainingDataSpan{ byteArr };
+
+		while (!remainingDataSpan.empty())
 		{
-			frameByteArr.resize(compressionResult);
-			frameByteArr.shrink_to_fit();
+			const std::span<const std::uint8_t> currChunkSpan{ remainingDataSpan.first(std::min(CHUNK_SIZE_IN_BYTES, remainingDataSpan.size_bytes())) };
+			remainingDataSpan = remainingDataSpan.subspan(currChunkSpan.size_bytes());
+
+			const std::size_t frameOffset = chunkByteArr.size();
+			chunkByteArr.resize(frameOffset + ZSTD_compressBound(currChunkSpan.size_bytes()));
+
+			// Both ZSTD_compressCCtx() and ZSTD_compress_usingCDict() write the uncompressed size
+			// into every frame header, which the runtime relies on to decompress each chunk in a
+			// single pass. The latter also writes the dictionary ID. The compression level of a
+			// ZSTD_CDict is fixed when it is created, so it is not specified here.
+			const std::size_t compressionResult = (compressionDictionaryPtr == nullptr ?
+				ZSTD_compressCCtx(
+					mCompressionContextPtr,
+					chunkByteArr.data() + frameOffset,
+					chunkByteArr.size() - frameOffset,
+					currChunkSpan.data(),
+					currChunkSpan.size_bytes(),
+					Util::Engine::GetZSTDCompressionLevel()
+				) :
+				ZSTD_compress_usingCDict(
+					mCompressionContextPtr,
+					chunkByteArr.data() + frameOffset,
+					chunkByteArr.size() - frameOffset,
+					currChunkSpan.data(),
+					currChunkSpan.size_bytes(),
+					compressionDictionaryPtr
+				));
+
+			if (ZSTD_isError(compressionResult)) [[unlikely]]
+				throw std::runtime_error{ std::string{ "ERROR: ZSTD failed to compress a frame with the following error: " } + std::string{ ZSTD_getErrorName(compressionResult) } };
+
+			// ZSTD_compressBound() is an upper-bound on the memory required. Usually, we don't
+			// need that much memory.
+			chunkByteArr.resize(frameOffset + compressionResult);
+			chunkEndOffsetArr.push_back(chunkByteArr.size());
 		}
 
+		const std::uint32_t seekTablePayloadSize = static_cast<std::uint32_t>(SEEK_TABLE_PAYLOAD_HEADER_SIZE + (chunkEndOffsetArr.size() * sizeof(std::uint64_t)));
+
+		std::vector<std::uint8_t> frameByteArr{};
+		frameByteArr.reserve(SKIPPABLE_FRAME_HEADER_SIZE + seekTablePayloadSize + chunkByteArr.size());
+
+		AppendLittleEndianValue(frameByteArr, SEEK_TABLE_SKIPPABLE_FRAME_MAGIC);
+		AppendLittleEndianValue(frameByteArr, seekTablePayloadSize);
+		AppendLittleEndianValue(frameByteArr, SEEK_TABLE_MAGIC);
+		AppendLittleEndianValue(frameByteArr, static_cast<std::uint32_t>(CHUNK_SIZE_IN_BYTES));
+		AppendLittleEndianValue(frameByteArr, static_cast<std::uint64_t>(byteArr.size_bytes()));
+
+		for (const auto chunkEndOffset : chunkEndOffsetArr)
+			AppendLittleEndianValue(frameByteArr, chunkEndOffset);
+
+		frameByteArr.insert(frameByteArr.end(), chunkByteArr.begin(), chunkByteArr.end());
+
 		return ZSTDFrame{ std::move(frameByteArr) };
 	}
 
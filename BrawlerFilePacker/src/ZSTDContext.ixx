@@ -4,6 +4,7 @@ module;
 
 export module Brawler.ZSTDContext;
 import Brawler.ZSTDFrame;
+import Brawler.ZSTDDictionary;
 
 export namespace Brawler
 {
@@ -19,9 +20,48 @@ export namespace Brawler
 		ZSTDContext(ZSTDContext&& rhs) noexcept;
 		ZSTDContext& operator=(ZSTDContext&& rhs) noexcept;
 
+		/// <summary>
+		/// Compresses byteArr into a seekable ZSTD stream. The data is split into chunks of
+		/// PackerSettings::ZSTD_CHUNK_SIZE_IN_BYTES bytes, each of which is compressed into an
+		/// independent frame, and a seek table describing where each frame ends is placed in
+		/// a skippable frame in front of them. This lets the runtime decompress the chunks in
+		/// parallel, or only decompress the chunks which overlap a given byte range.
+		/// 
+		/// The returned ZSTDFrame is still a valid ZSTD stream, so any ZSTD decoder can
+		/// decompress it in its entirety.
+		/// </summary>
+		/// <param name="byteArr">
+		/// - The uncompressed data.
+		/// </param>
+		/// <returns>
+		/// The function returns the compressed data as a ZSTDFrame.
+		/// </returns>
 		ZSTDFrame CompressData(const std::span<std::uint8_t> byteArr) const;
 
+		/// <summary>
+		/// Compresses byteArr into a seekable ZSTD stream exactly like the other overload of
+		/// ZSTDContext::CompressData(), but every chunk is compressed with the specified
+		/// dictionary. Small assets which share a lot of structure compress much better this
+		/// way, since every chunk can refer to the dictionary's contents rather than starting
+		/// from nothing.
+		/// 
+		/// ZSTD writes the ID of the dictionary into each frame header, so the runtime must
+		/// have the same dictionary available in order to decompress the data.
+		/// </summary>
+		/// <param name="byteArr">
+		/// - The uncompressed data.
+		/// </param>
+		/// <param name="dictionary">
+		/// - The dictionary which is to be used for compressing every chunk.
+		/// </param>
+		/// <returns>
+		/// The function returns the compressed data as a ZSTDFrame.
+		/// </returns>
+		ZSTDFrame CompressData(const std::span<std::uint8_t> byteArr, const ZSTDDictionary& dictionary) const;
+
 	private:
+		ZSTDFrame CompressDataIMPL(const std::span<std::uint8_t> byteArr, const ZSTD_CDict* const compressionDictionaryPtr) const;
+
 		void DeleteCompressionContext();
 
 	private:
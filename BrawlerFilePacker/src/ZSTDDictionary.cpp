@@ -0,0 +1,98 @@
+module;
+#include <vector>
+#include <span>
+#include <memory>
+#include <optional>
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <format>
+#include <stdexcept>
+#include <zstd.h>
+#include <zdict.h>
+
+module Brawler.ZSTDDictionary;
+import Brawler.PackerSettings;
+import Util.Engine;
+import Util.Win32;
+
+namespace
+{
+	// ZSTD recommends dictionaries of about 100KB, trained on roughly 100 times as much data.
+	// Training on more data than that takes much longer without improving the dictionary by
+	// much.
+	static constexpr std::size_t MAX_DICTIONARY_SIZE_IN_BYTES = (112 * 1024);
+	static constexpr std::size_t MAX_TRAINING_DATA_SIZE_IN_BYTES = (MAX_DICTIONARY_SIZE_IN_BYTES * 128);
+}
+
+namespace Brawler
+{
+	ZSTDDictionary::ZSTDDictionary(std::vector<std::uint8_t>&& dictionaryByteArr) :
+		mDictionaryByteArr(std::move(dictionaryByteArr)),
+		mCompressionDictionaryPtr(ZSTD_createCDict(mDictionaryByteArr.data(), mDictionaryByteArr.size(), Util::Engine::GetZSTDCompressionLevel())),
+		mDictionaryID(ZDICT_getDictID(mDictionaryByteArr.data(), mDictionaryByteArr.size()))
+	{
+		if (mCompressionDictionaryPtr == nullptr) [[unlikely]]
+			throw std::runtime_error{ "ERROR: ZSTD failed to create a compression dictionary (ZSTD_CDict)!" };
+	}
+
+	std::optional<ZSTDDictionary> ZSTDDictionary::TrainDictionary(const std::span<const std::span<const std::uint8_t>> assetDataSpanArr)
+	{
+		static constexpr std::size_t CHUNK_SIZE_IN_BYTES = PackerSettings::ZSTD_CHUNK_SIZE_IN_BYTES;
+
+		// ZDICT expects all of the samples to be concatenated into a single buffer.
+		std::vector<std::uint8_t> sampleByteArr{};
+		std::vector<std::size_t> sampleSizeArr{};
+
+		for (const auto assetDataSpan : assetDataSpanArr)
+		{
+			std::span<const std::uint8_t> remainingDataSpan{ assetDataSpan };
+
+			while (!remainingDataSpan.empty() && sampleByteArr.size() < MAX_TRAINING_DATA_SIZE_IN_BYTES)
+			{
+				const std::size_t sampleSize = std::min({ remainingDataSpan.size_bytes(), CHUNK_SIZE_IN_BYTES, (MAX_TRAINING_DATA_SIZE_IN_BYTES - sampleByteArr.size()) });
+
+				sampleByteArr.insert(sampleByteArr.end(), remainingDataSpan.begin(), (remainingDataSpan.begin() + sampleSize));
+				sampleSizeArr.push_back(sampleSize);
+
+				remainingDataSpan = remainingDataSpan.subspan(sampleSize);
+			}
+		}
+
+		std::vector<std::uint8_t> dictionaryByteArr{};
+		dictionaryByteArr.resize(MAX_DICTIONARY_SIZE_IN_BYTES);
+
+		const std::size_t trainingResult = ZDICT_trainFromBuffer(
+			dictionaryByteArr.data(),
+			dictionaryByteArr.size(),
+			sampleByteArr.data(),
+			sampleSizeArr.data(),
+			static_cast<unsigned int>(sampleSizeArr.size())
+		);
+
+		if (ZDICT_isError(trainingResult)) [[unlikely]]
+		{
+			Util::Win32::WriteFormattedConsoleMessage(std::format("WARNING: ZSTD failed to train a compression dictionary from {} samples with the following error: {} (The affected assets will be compressed without a dictionary.)", sampleSizeArr.size(), ZDICT_getErrorName(trainingResult)), Util::Win32::ConsoleFormat::WARNING);
+			return std::optional<ZSTDDictionary>{};
+		}
+
+		dictionaryByteArr.resize(trainingResult);
+
+		return std::optional<ZSTDDictionary>{ ZSTDDictionary{ std::move(dictionaryByteArr) } };
+	}
+
+	std::uint32_t ZSTDDictionary::GetDictionaryID() const
+	{
+		return mDictionaryID;
+	}
+
+	std::span<const std::uint8_t> ZSTDDictionary::GetByteArray() const
+	{
+		return mDictionaryByteArr;
+	}
+
+	const ZSTD_CDict* ZSTDDictionary::GetCompressionDictionary() const
+	{
+		return mCompressionDictionaryPtr.get();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+module;
+#include <vector>
+#include <span>
+#include <memory>
+#include <optional>
+#include <cstdint>
+#include <cassert>
+#include <zstd.h>
+
+export module Brawler.ZSTDDictionary;
+
+namespace Brawler
+{
+	struct CompressionDictionaryDeleter
+	{
+		void operator()(ZSTD_CDict* dictionaryPtr) const
+		{
+			if (dictionaryPtr != nullptr)
+			{
+				const std::size_t deleteResult = ZSTD_freeCDict(dictionaryPtr);
+				assert(!ZSTD_isError(deleteResult) && "ERROR: ZSTD failed to delete a compression dictionary (ZSTD_CDict)!");
+			}
+		}
+	};
+}
+
+export namespace Brawler
+{
+	class ZSTDDictionary
+	{
+	private:
+		explicit ZSTDDictionary(std::vector<std::uint8_t>&& dictionaryByteArr);
+
+	public:
+		~ZSTDDictionary() = default;
+
+		ZSTDDictionary(const ZSTDDictionary& rhs) = delete;
+		ZSTDDictionary& operator=(const ZSTDDictionary& rhs) = delete;
+
+		ZSTDDictionary(ZSTDDictionary&& rhs) noexcept = default;
+		ZSTDDictionary& operator=(ZSTDDictionary&& rhs) noexcept = default;
+
+		/// <summary>
+		/// Trains a ZSTD dictionary from the uncompressed data of a group of assets. The
+		/// dictionary is trained on the same chunks which ZSTDContext::CompressData() later
+		/// compresses independently of each other.
+		/// 
+		/// Training fails if there is too little data or if the data is too uniform for a
+		/// dictionary to be of any use. In that case, a warning is written to the console,
+		/// and the assets should simply be compressed without a dictionary.
+		/// </summary>
+		/// <param name="assetDataSpanArr">
+		/// - The uncompressed data of every asset in the group. The order of the assets affects
+		///   the contents of the dictionary, so it should be the same between builds.
+		/// </param>
+		/// <returns>
+		/// If training succeeds, then the function returns the ZSTDDictionary. Otherwise, it
+		/// returns an empty std::optional instance.
+		/// </returns>
+		static std::optional<ZSTDDictionary> TrainDictionary(const std::span<const std::span<const std::uint8_t>> assetDataSpanArr);
+
+		/// <summary>
+		/// Returns the ID of the dictionary. ZSTD writes this ID into the header of every
+		/// frame compressed with the dictionary, which is how the runtime finds the matching
+		/// dictionary for decompression. It is derived from the contents of the dictionary,
+		/// so it only changes if the dictionary itself changes.
+		/// </summary>
+		std::uint32_t GetDictionaryID() const;
+
+		std::span<const std::uint8_t> GetByteArray() const;
+
+		/// <summary>
+		/// Returns the pre-digested form of the dictionary, created for the compression level
+		/// of the current build mode. It is read-only, so any number of threads can compress
+		/// with it at the same time.
+		/// </summary>
+		const ZSTD_CDict* GetCompressionDictionary() const;
+
+	private:
+		std::vector<std::uint8_t> mDictionaryByteArr;
+		std::unique_ptr<ZSTD_CDict, CompressionDictionaryDeleter> mCompressionDictionaryPtr;
+		std::uint32_t mDictionaryID;
+	};
+}
\ No newline at end of file